@@ -0,0 +1,557 @@
+/*****************************************************************************
+* \file      apx_backend_bench_main.c
+* \author    Conny Gustafsson
+* \date      2026-10-18
+* \brief     Round-trip comparison of the msocket and io_uring server backends
+*
+* Copyright (c) 2026 Conny Gustafsson
+* Permission is hereby granted, free of charge, to any person obtaining a copy of
+* this software and associated documentation files (the "Software"), to deal in
+* the Software without restriction, including without limitation the rights to
+* use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+* the Software, and to permit persons to whom the Software is furnished to do so,
+* subject to the following conditions:
+
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+* FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+* COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+* IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+* CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+******************************************************************************/
+//////////////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////////////
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "msocket.h"
+#include "osmacro.h"
+#include "argparse.h"
+#include "pack.h"
+#include "apx/server.h"
+#include "apx/client.h"
+#include "apx/event_listener.h"
+#include "apx/extension/socket_server.h"
+#include "apx/extension/uring_server.h"
+#include "apx/util.h"
+#ifdef USE_CONFIGURATION_FILE
+#include "apx_build_cfg.h"
+#endif
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE CONSTANTS AND DATA TYPES
+//////////////////////////////////////////////////////////////////////////////
+#define APP_NAME "apx_backend_bench"
+#define CONNECT_TIMEOUT_MS 10000u
+#define RUN_TIMEOUT_MS 120000u
+#define START_RETRY_MS 100u
+#define POLL_INTERVAL_MS 10u
+#define DEFINITION_MAX_SIZE 256u
+
+//One requester/responder pair ping-pongs a sequence number through the server
+typedef struct bench_pair_tag
+{
+   MUTEX_T lock;
+   apx_client_t* requester;
+   apx_client_t* responder;
+   apx_portInstance_t* request_port;      //provide port of requester
+   apx_portInstance_t* response_port;     //require port of requester
+   apx_portInstance_t* responder_request; //require port of responder
+   apx_portInstance_t* responder_response;//provide port of responder
+   uint32_t num_connected;
+   uint32_t sequence;                     //last sequence number sent by the requester
+   uint64_t send_time;
+   uint64_t first_time;                   //when the first measured request was sent
+   uint64_t last_time;                    //when the last response was received
+   uint32_t* latency;                     //Length: m_num_round_trips
+   uint32_t num_measured;
+   bool is_done;
+} bench_pair_t;
+
+typedef struct bench_result_tag
+{
+   char const* name;
+   bool is_valid;
+   uint32_t num_measured;
+   double round_trips_per_second;
+   uint32_t p50;
+   uint32_t p90;
+   uint32_t p99;
+   uint32_t max;
+} bench_result_t;
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////////////
+#ifdef _WIN32
+static int init_wsa(void);
+#endif
+static argparse_result_t argparse_cbk(const char* short_name, const char* long_name, const char* value);
+static void print_usage(const char* arg0);
+static bool run_backend(bench_result_t* result, char const* name, uint16_t tcp_port);
+static bool create_pair(bench_pair_t* pair, char const* name, uint16_t tcp_port);
+static void destroy_pair(bench_pair_t* pair);
+static apx_client_t* create_client(bench_pair_t* pair, char const* definition, bool is_requester);
+static bool wait_for_pair(bench_pair_t* pair);
+static void send_request(bench_pair_t* pair, uint32_t sequence);
+static void print_results(bench_result_t const* results, uint32_t num_results);
+static int compare_u32(void const* a, void const* b);
+static void on_client_connected(void* arg, apx_clientConnection_t* client_connection);
+static void on_requester_port_write(void* arg, apx_portInstance_t* port_instance, uint8_t const* data, apx_size_t size);
+static void on_responder_port_write(void* arg, apx_portInstance_t* port_instance, uint8_t const* data, apx_size_t size);
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE VARIABLES
+//////////////////////////////////////////////////////////////////////////////
+/*** Argument variables ***/
+static bool m_display_help = false;
+static uint16_t m_base_port = 5600u;
+static uint32_t m_num_round_trips = 20000u;
+
+//////////////////////////////////////////////////////////////////////////////
+// PUBLIC FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Starts one server with both backends, msocket on the base port and io_uring on the next port,
+ * and measures the same request/response workload through each of them.
+ */
+int main(int argc, char** argv)
+{
+   int retval = 0;
+   uint32_t num_results = 0u;
+   bench_result_t results[2];
+   apx_server_t* server = NULL;
+   apx_socketServer_t* socket_server = NULL;
+#if APX_URING_SERVER_SUPPORTED
+   apx_uringServer_t* uring_server = NULL;
+   apx_uringServerCfg_t uring_cfg;
+   apx_error_t uring_result;
+#endif
+   argparse_result_t result = argparse_exec(argc, (const char**)argv, argparse_cbk);
+   if (result != ARGPARSE_SUCCESS)
+   {
+      print_usage(argv[0]);
+      return 1;
+   }
+   if (m_display_help)
+   {
+      print_usage(argv[0]);
+      return 0;
+   }
+#ifdef _WIN32
+   if (init_wsa() != 0)
+   {
+      int err = WSAGetLastError();
+      fprintf(stderr, "WSAStartup failed with error: %d\n", err);
+      return 1;
+   }
+#endif
+   memset(results, 0, sizeof(results));
+   server = apx_server_new();
+   if (server == NULL)
+   {
+      fprintf(stderr, "Failed to create server\n");
+      return 1;
+   }
+   apx_server_start(server);
+   socket_server = apx_socketServer_new(server);
+   if (socket_server == NULL)
+   {
+      fprintf(stderr, "Failed to create socket server\n");
+      retval = 1;
+      goto SHUTDOWN;
+   }
+   apx_socketServer_start_tcp_server(socket_server, m_base_port, NULL);
+   printf("Running %u round trips per backend\n", (unsigned)m_num_round_trips);
+   if (!run_backend(&results[num_results++], "msocket", m_base_port))
+   {
+      retval = 1;
+   }
+#if APX_URING_SERVER_SUPPORTED
+   apx_uringServerCfg_set_defaults(&uring_cfg);
+   uring_server = apx_uringServer_new(server, &uring_cfg);
+   uring_result = (uring_server != NULL) ? apx_uringServer_start(uring_server) : APX_MEM_ERROR;
+   if (uring_result == APX_NO_ERROR)
+   {
+      uring_result = apx_uringServer_start_tcp_server(uring_server, (uint16_t)(m_base_port + 1u));
+   }
+   if (uring_result == APX_NO_ERROR)
+   {
+      if (!run_backend(&results[num_results++], "io_uring", (uint16_t)(m_base_port + 1u)))
+      {
+         retval = 1;
+      }
+   }
+   else
+   {
+      //Same fallback as the uring-server extension, the kernel lacks the features it needs
+      printf("io_uring backend not available (error %d), skipped\n", (int)uring_result);
+   }
+#else
+   printf("io_uring backend not supported by this build, skipped\n");
+#endif
+   print_results(results, num_results);
+
+SHUTDOWN:
+#if APX_URING_SERVER_SUPPORTED
+   if (uring_server != NULL)
+   {
+      apx_uringServer_stop(uring_server);
+      apx_uringServer_delete(uring_server);
+   }
+#endif
+   if (socket_server != NULL)
+   {
+      apx_socketServer_stop_all(socket_server);
+      apx_socketServer_delete(socket_server);
+   }
+   apx_server_delete(server);
+#ifdef _WIN32
+   WSACleanup();
+#endif
+   return retval;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+#ifdef _WIN32
+static int init_wsa(void)
+{
+   WORD wVersionRequested;
+   WSADATA wsaData;
+   int err;
+   wVersionRequested = MAKEWORD(2, 2);
+   err = WSAStartup(wVersionRequested, &wsaData);
+   return err;
+}
+#endif
+
+static argparse_result_t argparse_cbk(const char* short_name, const char* long_name, const char* value)
+{
+   const char* name = NULL;
+   char* end = NULL;
+   long lval;
+   if (short_name != NULL)
+   {
+      name = short_name;
+   }
+   else if (long_name != NULL)
+   {
+      //Map long option names to their short equivalent
+      if (strcmp(long_name, "round-trips") == 0) name = "n";
+      else if (strcmp(long_name, "port") == 0) name = "p";
+      else if (strcmp(long_name, "help") == 0) name = "h";
+      else return ARGPARSE_NAME_ERROR;
+   }
+   else
+   {
+      return ARGPARSE_PARSE_ERROR; //No positional arguments
+   }
+   if (strcmp(name, "h") == 0)
+   {
+      m_display_help = true;
+      return ARGPARSE_SUCCESS;
+   }
+   if (strlen(name) != 1u || (strchr("np", name[0]) == NULL))
+   {
+      return ARGPARSE_NAME_ERROR;
+   }
+   if (value == NULL)
+   {
+      return ARGPARSE_NEED_VALUE;
+   }
+   lval = strtol(value, &end, 0);
+   if ((end <= value) || (lval <= 0))
+   {
+      return ARGPARSE_VALUE_ERROR;
+   }
+   if (strcmp(name, "n") == 0)
+   {
+      m_num_round_trips = (uint32_t)lval;
+   }
+   else
+   {
+      if (lval >= UINT16_MAX)
+      {
+         return ARGPARSE_VALUE_ERROR; //The io_uring backend listens on the next port
+      }
+      m_base_port = (uint16_t)lval;
+   }
+   return ARGPARSE_SUCCESS;
+}
+
+static void print_usage(const char* arg0)
+{
+   printf("%s "
+      "[-n --round-trips count] "
+      "[-p --port base_port]\n"
+      , arg0);
+}
+
+/**
+ * The first round trip only establishes routing and is not measured.
+ */
+static bool run_backend(bench_result_t* result, char const* name, uint16_t tcp_port)
+{
+   bench_pair_t pair;
+   uint64_t start_time;
+   bool is_done = false;
+   result->name = name;
+   result->is_valid = false;
+   if (!create_pair(&pair, name, tcp_port))
+   {
+      destroy_pair(&pair);
+      return false;
+   }
+   if (!wait_for_pair(&pair))
+   {
+      fprintf(stderr, "%s: timeout while waiting for connections\n", name);
+      destroy_pair(&pair);
+      return false;
+   }
+   start_time = apx_time_monotonic_ms();
+   while ((apx_time_monotonic_ms() - start_time) < RUN_TIMEOUT_MS)
+   {
+      uint32_t sequence;
+      MUTEX_LOCK(pair.lock);
+      is_done = pair.is_done;
+      sequence = pair.sequence;
+      MUTEX_UNLOCK(pair.lock);
+      if (is_done)
+      {
+         break;
+      }
+      if (sequence == 0u)
+      {
+         //Resend the first request until the responder is routed
+         send_request(&pair, 1u);
+         SLEEP(START_RETRY_MS);
+      }
+      else
+      {
+         SLEEP(POLL_INTERVAL_MS);
+      }
+   }
+   MUTEX_LOCK(pair.lock);
+   is_done = pair.is_done;
+   MUTEX_UNLOCK(pair.lock);
+   if (!is_done)
+   {
+      fprintf(stderr, "%s: timeout after %u of %u round trips\n", name, (unsigned)pair.num_measured, (unsigned)m_num_round_trips);
+      destroy_pair(&pair);
+      return false;
+   }
+   result->is_valid = true;
+   result->num_measured = pair.num_measured;
+   if (pair.num_measured > 0u)
+   {
+      uint64_t const elapsed_us = pair.last_time - pair.first_time;
+      qsort(pair.latency, pair.num_measured, sizeof(uint32_t), compare_u32);
+      result->round_trips_per_second = (elapsed_us > 0u) ? ((double)pair.num_measured * 1000000.0) / (double)elapsed_us : 0.0;
+      result->p50 = pair.latency[(pair.num_measured * 50u) / 100u];
+      result->p90 = pair.latency[(pair.num_measured * 90u) / 100u];
+      result->p99 = pair.latency[(pair.num_measured * 99u) / 100u];
+      result->max = pair.latency[pair.num_measured - 1u];
+   }
+   destroy_pair(&pair);
+   return true;
+}
+
+/**
+ * Port names include the backend name, both backends are connected to the same server.
+ */
+static bool create_pair(bench_pair_t* pair, char const* name, uint16_t tcp_port)
+{
+   char definition[DEFINITION_MAX_SIZE];
+   memset(pair, 0, sizeof(bench_pair_t));
+   MUTEX_INIT(pair->lock);
+   pair->latency = (uint32_t*)calloc(m_num_round_trips, sizeof(uint32_t));
+   if (pair->latency == NULL)
+   {
+      fprintf(stderr, "Memory allocation failed\n");
+      return false;
+   }
+   (void)snprintf(definition, sizeof(definition), "APX/1.2\nN\"BackendBench_%s_Requester\"\nP\"BackendBench_%s_rqst\"L:=0\nR\"BackendBench_%s_rsp\"L:=0\n",
+      name, name, name);
+   pair->requester = create_client(pair, definition, true);
+   (void)snprintf(definition, sizeof(definition), "APX/1.2\nN\"BackendBench_%s_Responder\"\nR\"BackendBench_%s_rqst\"L:=0\nP\"BackendBench_%s_rsp\"L:=0\n",
+      name, name, name);
+   pair->responder = create_client(pair, definition, false);
+   if ((pair->requester == NULL) || (pair->responder == NULL))
+   {
+      return false;
+   }
+   pair->request_port = apx_nodeInstance_get_provide_port(apx_client_get_last_attached_node(pair->requester), (apx_portId_t)0u);
+   pair->response_port = apx_nodeInstance_get_require_port(apx_client_get_last_attached_node(pair->requester), (apx_portId_t)0u);
+   pair->responder_request = apx_nodeInstance_get_require_port(apx_client_get_last_attached_node(pair->responder), (apx_portId_t)0u);
+   pair->responder_response = apx_nodeInstance_get_provide_port(apx_client_get_last_attached_node(pair->responder), (apx_portId_t)0u);
+   if ((apx_client_connect_tcp(pair->responder, "127.0.0.1", tcp_port) != APX_NO_ERROR) ||
+       (apx_client_connect_tcp(pair->requester, "127.0.0.1", tcp_port) != APX_NO_ERROR))
+   {
+      fprintf(stderr, "%s: failed to connect to port %u\n", name, (unsigned)tcp_port);
+      return false;
+   }
+   return true;
+}
+
+static void destroy_pair(bench_pair_t* pair)
+{
+   if (pair->requester != NULL)
+   {
+      apx_client_disconnect(pair->requester);
+      apx_client_delete(pair->requester);
+   }
+   if (pair->responder != NULL)
+   {
+      apx_client_disconnect(pair->responder);
+      apx_client_delete(pair->responder);
+   }
+   free(pair->latency);
+   MUTEX_DESTROY(pair->lock);
+}
+
+static apx_client_t* create_client(bench_pair_t* pair, char const* definition, bool is_requester)
+{
+   apx_client_t* client = apx_client_new();
+   if (client != NULL)
+   {
+      apx_clientEventListener_t handler_table;
+      apx_error_t result;
+      memset(&handler_table, 0, sizeof(handler_table));
+      handler_table.arg = pair;
+      handler_table.client_connect1 = on_client_connected;
+      handler_table.require_port_write1 = is_requester ? on_requester_port_write : on_responder_port_write;
+      apx_client_register_event_listener(client, &handler_table);
+      result = apx_client_build_node(client, definition);
+      if (result != APX_NO_ERROR)
+      {
+         fprintf(stderr, "apx_client_build_node failed with error %d\n", (int)result);
+         apx_client_delete(client);
+         client = NULL;
+      }
+   }
+   return client;
+}
+
+static bool wait_for_pair(bench_pair_t* pair)
+{
+   uint32_t elapsed_ms;
+   for (elapsed_ms = 0u; elapsed_ms < CONNECT_TIMEOUT_MS; elapsed_ms += POLL_INTERVAL_MS)
+   {
+      uint32_t num_connected;
+      MUTEX_LOCK(pair->lock);
+      num_connected = pair->num_connected;
+      MUTEX_UNLOCK(pair->lock);
+      if (num_connected >= 2u)
+      {
+         return true;
+      }
+      SLEEP(POLL_INTERVAL_MS);
+   }
+   return false;
+}
+
+static void send_request(bench_pair_t* pair, uint32_t sequence)
+{
+   uint8_t data[UINT32_SIZE];
+   packLE(data, sequence, UINT32_SIZE);
+   (void)apx_client_write_port_data_range(pair->requester, pair->request_port, 0u, data, UINT32_SIZE);
+}
+
+static void print_results(bench_result_t const* results, uint32_t num_results)
+{
+   uint32_t i;
+   printf("%-10s %12s %14s %8s %8s %8s %8s\n", "Backend", "Round trips", "Round trips/s", "p50 us", "p90 us", "p99 us", "max us");
+   for (i = 0u; i < num_results; i++)
+   {
+      bench_result_t const* result = &results[i];
+      if (result->is_valid)
+      {
+         printf("%-10s %12u %14.1f %8u %8u %8u %8u\n", result->name, (unsigned)result->num_measured, result->round_trips_per_second,
+            (unsigned)result->p50, (unsigned)result->p90, (unsigned)result->p99, (unsigned)result->max);
+      }
+      else
+      {
+         printf("%-10s %12s\n", result->name, "failed");
+      }
+   }
+}
+
+static int compare_u32(void const* a, void const* b)
+{
+   uint32_t const lhs = *(uint32_t const*)a;
+   uint32_t const rhs = *(uint32_t const*)b;
+   return (lhs > rhs) - (lhs < rhs);
+}
+
+static void on_client_connected(void* arg, apx_clientConnection_t* client_connection)
+{
+   bench_pair_t* pair = (bench_pair_t*)arg;
+   (void)client_connection;
+   MUTEX_LOCK(pair->lock);
+   pair->num_connected++;
+   MUTEX_UNLOCK(pair->lock);
+}
+
+/**
+ * Each response carries the sequence number of the request. Stale or repeated responses are ignored.
+ */
+static void on_requester_port_write(void* arg, apx_portInstance_t* port_instance, uint8_t const* data, apx_size_t size)
+{
+   bench_pair_t* pair = (bench_pair_t*)arg;
+   uint64_t const now = apx_time_monotonic_us();
+   uint32_t next_sequence = 0u;
+   if ((port_instance != pair->response_port) || (size != UINT32_SIZE))
+   {
+      return;
+   }
+   MUTEX_LOCK(pair->lock);
+   if (!pair->is_done)
+   {
+      uint32_t const sequence = (uint32_t)unpackLE(data, UINT32_SIZE);
+      if ((sequence == 1u) && (pair->sequence == 0u))
+      {
+         next_sequence = 2u;
+         pair->first_time = now;
+      }
+      else if ((sequence > 1u) && (sequence == pair->sequence))
+      {
+         pair->latency[pair->num_measured++] = (uint32_t)(now - pair->send_time);
+         pair->last_time = now;
+         if (pair->num_measured < m_num_round_trips)
+         {
+            next_sequence = sequence + 1u;
+         }
+         else
+         {
+            pair->is_done = true;
+         }
+      }
+      if (next_sequence != 0u)
+      {
+         pair->sequence = next_sequence;
+         pair->send_time = apx_time_monotonic_us();
+      }
+   }
+   MUTEX_UNLOCK(pair->lock);
+   if (next_sequence != 0u)
+   {
+      send_request(pair, next_sequence);
+   }
+}
+
+static void on_responder_port_write(void* arg, apx_portInstance_t* port_instance, uint8_t const* data, apx_size_t size)
+{
+   bench_pair_t* pair = (bench_pair_t*)arg;
+   if ((port_instance == pair->responder_request) && (size == UINT32_SIZE) && (unpackLE(data, UINT32_SIZE) != 0u))
+   {
+      (void)apx_client_write_port_data_range(pair->responder, pair->responder_response, 0u, data, UINT32_SIZE);
+   }
+}
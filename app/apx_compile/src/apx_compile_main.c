@@ -0,0 +1,317 @@
+/*****************************************************************************
+* \file      apx_compile_main.c
+* \author    Conny Gustafsson
+* \date      2026-10-18
+* \brief     Converts APX text definitions into precompiled binary definitions
+*
+* Copyright (c) 2026 Conny Gustafsson
+* Permission is hereby granted, free of charge, to any person obtaining a copy of
+* this software and associated documentation files (the "Software"), to deal in
+* the Software without restriction, including without limitation the rights to
+* use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+* the Software, and to permit persons to whom the Software is furnished to do so,
+* subject to the following conditions:
+
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+* FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+* COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+* IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+* CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+******************************************************************************/
+//////////////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////////////
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <malloc.h>
+#include <stdbool.h>
+#include "adt_str.h"
+#include "adt_bytearray.h"
+#include "apx/node_manager.h"
+#include "apx/binary_definition.h"
+#include "argparse.h"
+#include "filestream.h"
+#ifdef USE_CONFIGURATION_FILE
+#include "apx_build_cfg.h"
+#endif
+#ifdef MEM_LEAK_CHECK
+#include "CMemLeak.h"
+#endif
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE CONSTANTS AND DATA TYPES
+//////////////////////////////////////////////////////////////////////////////
+#define APP_NAME "apx_compile"
+#define OUTPUT_GROW_SIZE 4096u
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////////////
+static argparse_result_t argparse_cbk(const char *short_name, const char *long_name, const char *value);
+static adt_str_t *read_definition_file(adt_str_t *path);
+static int write_binary_file(adt_str_t *path, adt_bytearray_t *data);
+static void set_default_output_file(void);
+static int compile_definition(adt_str_t *definition_text);
+static void print_version(void);
+static void print_usage(const char *arg0);
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE VARIABLES
+//////////////////////////////////////////////////////////////////////////////
+static bool m_display_help = false;
+static bool m_display_version = false;
+static adt_str_t m_definition_file;
+static adt_str_t m_output_file;
+
+//////////////////////////////////////////////////////////////////////////////
+// PUBLIC FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+   int retval = 0;
+   argparse_result_t result;
+   adt_str_create(&m_definition_file);
+   adt_str_create(&m_output_file);
+   result = argparse_exec(argc, (const char**) argv, argparse_cbk);
+   if (result == ARGPARSE_SUCCESS)
+   {
+      if (m_display_version)
+      {
+         print_version();
+      }
+      if (m_display_help)
+      {
+         print_usage(argv[0]);
+      }
+      if (adt_str_length(&m_definition_file) == 0)
+      {
+         if (!m_display_version && !m_display_help)
+         {
+            printf("Error: No definition file given\n");
+            print_usage(argv[0]);
+            retval = 1;
+         }
+      }
+      else
+      {
+         adt_str_t *definition_text = read_definition_file(&m_definition_file);
+         if (definition_text != 0)
+         {
+            if (adt_str_length(&m_output_file) == 0)
+            {
+               set_default_output_file();
+            }
+            retval = compile_definition(definition_text);
+            adt_str_delete(definition_text);
+         }
+         else
+         {
+            fprintf(stderr, "Error: Could not read file '%s'\n", adt_str_cstr(&m_definition_file));
+            retval = 1;
+         }
+      }
+   }
+   else
+   {
+      printf("Error parsing argument (%d)\n", (int) result);
+      print_usage(argv[0]);
+      retval = 1;
+   }
+   adt_str_destroy(&m_definition_file);
+   adt_str_destroy(&m_output_file);
+   return retval;
+}
+
+#ifdef MEM_LEAK_CHECK
+void vfree(void *arg)
+{
+   free(arg);
+}
+#endif
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+static argparse_result_t argparse_cbk(const char *short_name, const char *long_name, const char *value)
+{
+   if (value == 0)
+   {
+      if ( short_name != 0 )
+      {
+         if (strcmp(short_name,"o")==0)
+         {
+            return ARGPARSE_NEED_VALUE;
+         }
+         else if( (strcmp(short_name,"h")==0) )
+         {
+            m_display_help = true;
+            return ARGPARSE_SUCCESS;
+         }
+         else
+         {
+            return ARGPARSE_NAME_ERROR;
+         }
+      }
+      else if ( (long_name != 0) )
+      {
+         if (strcmp(long_name,"output")==0)
+         {
+            return ARGPARSE_NEED_VALUE;
+         }
+         else if ( (strcmp(long_name,"help")==0) )
+         {
+            m_display_help = true;
+            return ARGPARSE_SUCCESS;
+         }
+         else if ( (strcmp(long_name,"version")==0) )
+         {
+            m_display_version = true;
+            return ARGPARSE_SUCCESS;
+         }
+         else
+         {
+            return ARGPARSE_NAME_ERROR;
+         }
+      }
+   }
+   else
+   {
+      if ( ( (short_name != 0) && (strcmp(short_name,"o")==0) ) ||
+           ( (long_name != 0) && (strcmp(long_name,"output")==0) ) )
+      {
+         adt_str_set_cstr(&m_output_file, value);
+      }
+      else if ( (short_name == 0) && (long_name == 0) )
+      {
+         adt_str_set_cstr(&m_definition_file, value);
+      }
+      else
+      {
+         return ARGPARSE_NAME_ERROR;
+      }
+   }
+   return ARGPARSE_SUCCESS;
+}
+
+/**
+ * Reads contents of text file into a string
+ */
+static adt_str_t *read_definition_file(adt_str_t *path)
+{
+   adt_bytearray_t *definition_bytes = ifstream_util_readTextFile(adt_str_cstr(path));
+   if (definition_bytes != 0)
+   {
+      adt_str_t *str = adt_str_new_bytearray(definition_bytes);
+      adt_bytearray_delete(definition_bytes);
+      return str;
+   }
+   return (adt_str_t*) 0;
+}
+
+static int write_binary_file(adt_str_t *path, adt_bytearray_t *data)
+{
+   int retval = 0;
+   FILE *fh = fopen(adt_str_cstr(path), "wb");
+   if (fh == 0)
+   {
+      return 1;
+   }
+   if (fwrite(adt_bytearray_const_data(data), 1u, (size_t) adt_bytearray_length(data), fh) != (size_t) adt_bytearray_length(data))
+   {
+      retval = 1;
+   }
+   if (fclose(fh) != 0)
+   {
+      retval = 1;
+   }
+   return retval;
+}
+
+/**
+ * Output file defaults to the definition file with its ".apx" extension replaced by ".apxb"
+ */
+static void set_default_output_file(void)
+{
+   char const *path = adt_str_cstr(&m_definition_file);
+   size_t path_len = strlen(path);
+   size_t const ext_len = strlen(APX_DEFINITION_FILE_EXT);
+   if ( (path_len >= ext_len) && (strcmp(path + (path_len - ext_len), APX_DEFINITION_FILE_EXT) == 0) )
+   {
+      path_len -= ext_len;
+   }
+   adt_str_set_bstr(&m_output_file, (const uint8_t*) path, (const uint8_t*) path + path_len);
+   adt_str_append_cstr(&m_output_file, APX_BINARY_DEFINITION_FILE_EXT);
+}
+
+static int compile_definition(adt_str_t *definition_text)
+{
+   int retval = 1;
+   apx_nodeManager_t *node_manager = apx_nodeManager_new(APX_CLIENT_MODE);
+   adt_bytearray_t *output = adt_bytearray_new(OUTPUT_GROW_SIZE);
+   if ( (node_manager == 0) || (output == 0) )
+   {
+      fprintf(stderr, "Error: Out of memory\n");
+   }
+   else
+   {
+      apx_error_t rc = apx_nodeManager_build_node(node_manager, adt_str_cstr(definition_text));
+      if (rc == APX_PARSE_ERROR)
+      {
+         fprintf(stderr, "Error: Parse error on line %d\n", (int) apx_nodeManager_get_error_line(node_manager));
+      }
+      else if (rc != APX_NO_ERROR)
+      {
+         fprintf(stderr, "Error: Failed to build node (%d)\n", (int) rc);
+      }
+      else
+      {
+         apx_nodeInstance_t *node_instance = apx_nodeManager_get_last_attached(node_manager);
+         rc = apx_binaryDefinition_write(node_instance, output);
+         if (rc != APX_NO_ERROR)
+         {
+            fprintf(stderr, "Error: Failed to create binary definition (%d)\n", (int) rc);
+         }
+         else if (write_binary_file(&m_output_file, output) != 0)
+         {
+            fprintf(stderr, "Error: Could not write file '%s'\n", adt_str_cstr(&m_output_file));
+         }
+         else
+         {
+            printf("%s: Provide-Ports: %d, Require-Ports: %d, %d bytes => %s (%d bytes)\n",
+               apx_nodeInstance_get_name(node_instance),
+               (int) apx_nodeInstance_get_num_provide_ports(node_instance),
+               (int) apx_nodeInstance_get_num_require_ports(node_instance),
+               (int) adt_str_size(definition_text),
+               adt_str_cstr(&m_output_file),
+               (int) adt_bytearray_length(output));
+            retval = 0;
+         }
+      }
+   }
+   if (node_manager != 0)
+   {
+      apx_nodeManager_delete(node_manager);
+   }
+   if (output != 0)
+   {
+      adt_bytearray_delete(output);
+   }
+   return retval;
+}
+
+static void print_version(void)
+{
+   printf("%s %s\n", APP_NAME, SW_VERSION_LITERAL);
+}
+
+static void print_usage(const char *arg0)
+{
+   printf("%s [-o --output output_file] [--version] definition_file\n"
+          "Compiles an APX text definition into its binary (%s) format\n", arg0, APX_BINARY_DEFINITION_FILE_EXT);
+}
@@ -0,0 +1,510 @@
+/*****************************************************************************
+* \file      apx_connect_bench_main.c
+* \author    Conny Gustafsson
+* \date      2026-10-18
+* \brief     Connect latency benchmark, time from connect until the initial provide port value is routed
+*
+* Copyright (c) 2026 Conny Gustafsson
+* Permission is hereby granted, free of charge, to any person obtaining a copy of
+* this software and associated documentation files (the "Software"), to deal in
+* the Software without restriction, including without limitation the rights to
+* use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+* the Software, and to permit persons to whom the Software is furnished to do so,
+* subject to the following conditions:
+
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+* FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+* COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+* IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+* CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+******************************************************************************/
+//////////////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////////////
+#include <stdio.h>
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+#include "msocket.h"
+#include "osmacro.h"
+#include "adt_str.h"
+#include "argparse.h"
+#include "pack.h"
+#include "apx/client.h"
+#include "apx/event_listener.h"
+#include "apx/util.h"
+#ifdef USE_CONFIGURATION_FILE
+#include "apx_build_cfg.h"
+#endif
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE CONSTANTS AND DATA TYPES
+//////////////////////////////////////////////////////////////////////////////
+#define APP_NAME "apx_connect_bench"
+#define CONNECT_TIMEOUT_MS 30000u
+#define SAMPLE_TIMEOUT_MS 5000u
+#define POLL_INTERVAL_MS 1u
+#define DRAIN_TIME_MS 100u
+#define DEFINITION_BUFFER_SIZE 256u
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////////////
+#ifdef _WIN32
+static int init_wsa(void);
+#endif
+static argparse_result_t argparse_cbk(const char* short_name, const char* long_name, const char* value);
+static argparse_result_t parse_option_value(const char* name, const char* value);
+static void print_usage(const char* arg0);
+static apx_client_t* create_client(const char* definition, bool is_requester);
+static apx_error_t connect_client(apx_client_t* client);
+static bool wait_for_requester(void);
+static bool run_sample(uint32_t sequence);
+static void run_benchmark(void);
+static void print_latency(const char* label, uint32_t* latency, uint32_t num_values);
+static void print_result(void);
+static int compare_u32(void const* a, void const* b);
+static void on_client_connected(void* arg, apx_clientConnection_t* client_connection);
+static void on_require_port_write(void* arg, apx_portInstance_t* port_instance, uint8_t const* data, apx_size_t size);
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE VARIABLES
+//////////////////////////////////////////////////////////////////////////////
+/*** Argument variables ***/
+static const uint16_t m_connect_port_default = 5000u;
+#ifdef _WIN32
+static const char* m_connect_address_default = "127.0.0.1";
+#else
+static const char* m_connect_address_default = "/tmp/apx_server.socket";
+#endif
+static bool m_display_help = false;
+static uint16_t m_connect_port;
+static adt_str_t* m_connect_address = (adt_str_t*)0;
+static apx_resource_type_t m_connect_resource_type = APX_RESOURCE_TYPE_UNKNOWN;
+static uint32_t m_num_samples = 100u;
+static bool m_pipelined_open = false;
+
+/*** Benchmark state ***/
+static MUTEX_T m_lock;
+static apx_client_t* m_requester = NULL;
+static apx_portInstance_t* m_requester_port = NULL;
+static bool m_is_requester_connected = false;
+static uint32_t m_current_sequence = 0u;
+static uint64_t m_connect_time = 0u;
+static bool m_is_sample_connected = false;
+static bool m_is_sample_routed = false;
+static uint32_t* m_connected_latency = NULL; //Length: m_num_samples, time until greeting was acknowledged
+static uint32_t* m_routed_latency = NULL;    //Length: m_num_samples, time until initial value reached the requester
+static uint32_t m_num_connected = 0u;
+static uint32_t m_num_routed = 0u;
+
+/*
+* Each provider gets the sequence number as init value, which also makes every definition unique.
+* That way each sample pays for a full definition transfer.
+*/
+static const char* m_provider_definition_format =
+"APX/1.2\n"
+"N\"ConnectBenchProvider\"\n"
+"P\"ConnectBench_Seq\"L:=%u\n"
+"\n";
+static const char* m_requester_definition =
+"APX/1.2\n"
+"N\"ConnectBenchRequester\"\n"
+"R\"ConnectBench_Seq\"L:=0\n"
+"\n";
+
+//////////////////////////////////////////////////////////////////////////////
+// PUBLIC FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+int main(int argc, char** argv)
+{
+   int retval = 0;
+   argparse_result_t result;
+   m_connect_port = m_connect_port_default;
+   result = argparse_exec(argc, (const char**)argv, argparse_cbk);
+   if (result != ARGPARSE_SUCCESS)
+   {
+      print_usage(argv[0]);
+      return 1;
+   }
+   if (m_display_help)
+   {
+      print_usage(argv[0]);
+      return 0;
+   }
+#ifdef _WIN32
+   if (init_wsa() != 0)
+   {
+      int err = WSAGetLastError();
+      fprintf(stderr, "WSAStartup failed with error: %d\n", err);
+      return 1;
+   }
+#endif
+   if (m_connect_resource_type == APX_RESOURCE_TYPE_UNKNOWN)
+   {
+      uint16_t dummy_port;
+      m_connect_resource_type = apx_parse_resource_name(m_connect_address_default, &m_connect_address, &dummy_port);
+      (void)dummy_port;
+      assert((m_connect_resource_type != APX_RESOURCE_TYPE_UNKNOWN) && (m_connect_resource_type != APX_RESOURCE_TYPE_ERROR));
+   }
+   MUTEX_INIT(m_lock);
+   m_connected_latency = (uint32_t*)calloc(m_num_samples, sizeof(uint32_t));
+   m_routed_latency = (uint32_t*)calloc(m_num_samples, sizeof(uint32_t));
+   if ((m_connected_latency == NULL) || (m_routed_latency == NULL))
+   {
+      fprintf(stderr, "Memory allocation failed\n");
+      retval = 1;
+      goto SHUTDOWN;
+   }
+   m_requester = create_client(m_requester_definition, true);
+   if (m_requester == NULL)
+   {
+      retval = 1;
+      goto SHUTDOWN;
+   }
+   m_requester_port = apx_nodeInstance_get_require_port(apx_client_get_last_attached_node(m_requester), (apx_portId_t)0u);
+   if (connect_client(m_requester) != APX_NO_ERROR)
+   {
+      retval = 1;
+      goto SHUTDOWN;
+   }
+   if (!wait_for_requester())
+   {
+      fprintf(stderr, "Timeout while waiting for requester to connect\n");
+      retval = 1;
+      goto SHUTDOWN;
+   }
+   run_benchmark();
+   print_result();
+
+SHUTDOWN:
+   if (m_requester != NULL)
+   {
+      apx_client_disconnect(m_requester);
+      apx_client_delete(m_requester);
+   }
+   free(m_connected_latency);
+   free(m_routed_latency);
+   MUTEX_DESTROY(m_lock);
+   if (m_connect_address != NULL)
+   {
+      adt_str_delete(m_connect_address);
+   }
+   return retval;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+#ifdef _WIN32
+static int init_wsa(void)
+{
+   WORD wVersionRequested;
+   WSADATA wsaData;
+   int err;
+   wVersionRequested = MAKEWORD(2, 2);
+   err = WSAStartup(wVersionRequested, &wsaData);
+   return err;
+}
+#endif
+
+static argparse_result_t argparse_cbk(const char* short_name, const char* long_name, const char* value)
+{
+   const char* name = NULL;
+   if (short_name != NULL)
+   {
+      name = short_name;
+   }
+   else if (long_name != NULL)
+   {
+      //Map long option names to their short equivalent
+      if (strcmp(long_name, "connect") == 0) name = "c";
+      else if (strcmp(long_name, "port") == 0) name = "p";
+      else if (strcmp(long_name, "samples") == 0) name = "s";
+      else if (strcmp(long_name, "pipelined") == 0) name = "P";
+      else if (strcmp(long_name, "help") == 0) name = "h";
+      else return ARGPARSE_NAME_ERROR;
+   }
+   else
+   {
+      return ARGPARSE_PARSE_ERROR; //No positional arguments
+   }
+   if (strcmp(name, "h") == 0)
+   {
+      m_display_help = true;
+      return ARGPARSE_SUCCESS;
+   }
+   if (strcmp(name, "P") == 0)
+   {
+      m_pipelined_open = true;
+      return ARGPARSE_SUCCESS;
+   }
+   if (strlen(name) != 1u || (strchr("cps", name[0]) == NULL))
+   {
+      return ARGPARSE_NAME_ERROR;
+   }
+   if (value == NULL)
+   {
+      return ARGPARSE_NEED_VALUE;
+   }
+   return parse_option_value(name, value);
+}
+
+static argparse_result_t parse_option_value(const char* name, const char* value)
+{
+   char* end = NULL;
+   long lval;
+   if (strcmp(name, "c") == 0)
+   {
+      if (m_connect_address != NULL) adt_str_delete(m_connect_address);
+      m_connect_resource_type = apx_parse_resource_name(value, &m_connect_address, &m_connect_port);
+      if ((m_connect_resource_type == APX_RESOURCE_TYPE_UNKNOWN) ||
+         (m_connect_resource_type == APX_RESOURCE_TYPE_ERROR))
+      {
+         return ARGPARSE_VALUE_ERROR;
+      }
+      return ARGPARSE_SUCCESS;
+   }
+   lval = strtol(value, &end, 0);
+   if ((end <= value) || (lval <= 0))
+   {
+      return ARGPARSE_VALUE_ERROR;
+   }
+   if (strcmp(name, "p") == 0)
+   {
+      if (lval > UINT16_MAX)
+      {
+         return ARGPARSE_VALUE_ERROR;
+      }
+      m_connect_port = (uint16_t)lval;
+   }
+   else
+   {
+      m_num_samples = (uint32_t)lval;
+   }
+   return ARGPARSE_SUCCESS;
+}
+
+static void print_usage(const char* arg0)
+{
+   printf("%s "
+      "[-c --connect connect_path] [-p --port connect_port] "
+      "[-s --samples count] "
+      "[-P --pipelined]\n"
+      , arg0);
+}
+
+static apx_client_t* create_client(const char* definition, bool is_requester)
+{
+   apx_client_t* client = apx_client_new();
+   if (client != NULL)
+   {
+      apx_clientEventListener_t handler_table;
+      apx_error_t result;
+      memset(&handler_table, 0, sizeof(handler_table));
+      handler_table.arg = is_requester ? (void*)&m_is_requester_connected : (void*)&m_is_sample_connected;
+      handler_table.client_connect1 = on_client_connected;
+      if (is_requester)
+      {
+         handler_table.require_port_write1 = on_require_port_write;
+      }
+      apx_client_register_event_listener(client, &handler_table);
+      result = apx_client_build_node(client, definition);
+      if (result != APX_NO_ERROR)
+      {
+         printf("apx_client_build_node failed with error %d\n", (int)result);
+         apx_client_delete(client);
+         client = NULL;
+      }
+   }
+   else
+   {
+      printf("apx_client_new failed\n");
+   }
+   return client;
+}
+
+static apx_error_t connect_client(apx_client_t* client)
+{
+   apx_error_t result = APX_NOT_IMPLEMENTED_ERROR;
+   switch (m_connect_resource_type)
+   {
+   case APX_RESOURCE_TYPE_IPV4: //fall-through
+   case APX_RESOURCE_TYPE_IPV6:
+      result = apx_client_connect_tcp(client, adt_str_cstr(m_connect_address), m_connect_port);
+      break;
+   case APX_RESOURCE_TYPE_FILE:
+#ifndef _WIN32
+      result = apx_client_connect_unix(client, adt_str_cstr(m_connect_address));
+#endif
+      break;
+   case APX_RESOURCE_TYPE_NAME:
+      if (strcmp(adt_str_cstr(m_connect_address), "localhost") == 0)
+      {
+         result = apx_client_connect_tcp(client, "127.0.0.1", m_connect_port);
+      }
+      break;
+   default:
+      break;
+   }
+   if (result != APX_NO_ERROR)
+   {
+      fprintf(stderr, "Failed to connect to \"%s\" (error %d)\n", adt_str_cstr(m_connect_address), (int)result);
+   }
+   return result;
+}
+
+static bool wait_for_requester(void)
+{
+   uint32_t elapsed_ms;
+   for (elapsed_ms = 0u; elapsed_ms < CONNECT_TIMEOUT_MS; elapsed_ms += POLL_INTERVAL_MS)
+   {
+      bool is_connected;
+      MUTEX_LOCK(m_lock);
+      is_connected = m_is_requester_connected;
+      MUTEX_UNLOCK(m_lock);
+      if (is_connected)
+      {
+         return true;
+      }
+      SLEEP(POLL_INTERVAL_MS);
+   }
+   return false;
+}
+
+/*
+* Connects a new provider and waits until its init value has been routed to the requester.
+* Returns false if the sample timed out.
+*/
+static bool run_sample(uint32_t sequence)
+{
+   char definition[DEFINITION_BUFFER_SIZE];
+   apx_client_t* provider;
+   uint32_t elapsed_ms;
+   bool is_routed = false;
+   snprintf(definition, sizeof(definition), m_provider_definition_format, (unsigned)sequence);
+   provider = create_client(definition, false);
+   if (provider == NULL)
+   {
+      return false;
+   }
+   apx_client_enable_pipelined_open(provider, m_pipelined_open);
+   MUTEX_LOCK(m_lock);
+   m_current_sequence = sequence;
+   m_is_sample_connected = false;
+   m_is_sample_routed = false;
+   m_connect_time = apx_time_monotonic_us();
+   MUTEX_UNLOCK(m_lock);
+   if (connect_client(provider) == APX_NO_ERROR)
+   {
+      for (elapsed_ms = 0u; elapsed_ms < SAMPLE_TIMEOUT_MS; elapsed_ms += POLL_INTERVAL_MS)
+      {
+         MUTEX_LOCK(m_lock);
+         is_routed = m_is_sample_routed;
+         MUTEX_UNLOCK(m_lock);
+         if (is_routed)
+         {
+            break;
+         }
+         SLEEP(POLL_INTERVAL_MS);
+      }
+   }
+   MUTEX_LOCK(m_lock);
+   m_current_sequence = 0u;
+   MUTEX_UNLOCK(m_lock);
+   apx_client_disconnect(provider);
+   apx_client_delete(provider);
+   SLEEP(DRAIN_TIME_MS); //Let the server remove the provider before the next one connects
+   return is_routed;
+}
+
+static void run_benchmark(void)
+{
+   uint32_t sequence;
+   printf("Connecting %u providers to %s (pipelined open: %s)\n", (unsigned)m_num_samples, adt_str_cstr(m_connect_address),
+      m_pipelined_open ? "yes" : "no");
+   //Sequence numbers start at 1, the requester init value 0 is never measured
+   for (sequence = 1u; sequence <= m_num_samples; sequence++)
+   {
+      if (!run_sample(sequence))
+      {
+         fprintf(stderr, "Sample %u timed out\n", (unsigned)sequence);
+      }
+   }
+}
+
+static void print_latency(const char* label, uint32_t* latency, uint32_t num_values)
+{
+   if (num_values > 0u)
+   {
+      qsort(latency, num_values, sizeof(uint32_t), compare_u32);
+      printf("%s (us): p50=%u p90=%u p99=%u max=%u\n", label,
+         (unsigned)latency[(num_values * 50u) / 100u],
+         (unsigned)latency[(num_values * 90u) / 100u],
+         (unsigned)latency[(num_values * 99u) / 100u],
+         (unsigned)latency[num_values - 1u]);
+   }
+}
+
+static void print_result(void)
+{
+   uint32_t num_connected;
+   uint32_t num_routed;
+   MUTEX_LOCK(m_lock);
+   num_connected = m_num_connected;
+   num_routed = m_num_routed;
+   MUTEX_UNLOCK(m_lock);
+   printf("Samples: %u of %u (lost: %u)\n", (unsigned)num_routed, (unsigned)m_num_samples,
+      (unsigned)(m_num_samples - num_routed));
+   print_latency("Connect to greeting acknowledge", m_connected_latency, num_connected);
+   print_latency("Connect to first routed value", m_routed_latency, num_routed);
+}
+
+static int compare_u32(void const* a, void const* b)
+{
+   uint32_t const lhs = *(uint32_t const*)a;
+   uint32_t const rhs = *(uint32_t const*)b;
+   return (lhs > rhs) - (lhs < rhs);
+}
+
+static void on_client_connected(void* arg, apx_clientConnection_t* client_connection)
+{
+   uint64_t const now = apx_time_monotonic_us();
+   (void)client_connection;
+   MUTEX_LOCK(m_lock);
+   if (arg == (void*)&m_is_requester_connected)
+   {
+      m_is_requester_connected = true;
+   }
+   else if ((m_current_sequence > 0u) && !m_is_sample_connected && (m_num_connected < m_num_samples))
+   {
+      m_is_sample_connected = true;
+      m_connected_latency[m_num_connected++] = (uint32_t)(now - m_connect_time);
+   }
+   MUTEX_UNLOCK(m_lock);
+}
+
+static void on_require_port_write(void* arg, apx_portInstance_t* port_instance, uint8_t const* data, apx_size_t size)
+{
+   uint64_t const now = apx_time_monotonic_us();
+   (void)arg;
+   if ((port_instance == m_requester_port) && (size == UINT32_SIZE))
+   {
+      uint32_t const sequence = (uint32_t)unpackLE(data, UINT32_SIZE);
+      MUTEX_LOCK(m_lock);
+      if ((sequence > 0u) && (sequence == m_current_sequence) && !m_is_sample_routed && (m_num_routed < m_num_samples))
+      {
+         m_is_sample_routed = true;
+         m_routed_latency[m_num_routed++] = (uint32_t)(now - m_connect_time);
+      }
+      MUTEX_UNLOCK(m_lock);
+   }
+}
@@ -0,0 +1,299 @@
+/*****************************************************************************
+* \file      apx_event_bench_main.c
+* \author    Conny Gustafsson
+* \date      2026-10-18
+* \brief     Event loop throughput benchmark
+*
+* Copyright (c) 2026 Conny Gustafsson
+* Permission is hereby granted, free of charge, to any person obtaining a copy of
+* this software and associated documentation files (the "Software"), to deal in
+* the Software without restriction, including without limitation the rights to
+* use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+* the Software, and to permit persons to whom the Software is furnished to do so,
+* subject to the following conditions:
+
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+* FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+* COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+* IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+* CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+******************************************************************************/
+//////////////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////////////
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifndef _WIN32
+#include <unistd.h>
+#include <sched.h>
+#endif
+#include "osmacro.h"
+#include "argparse.h"
+#include "apx/event_loop.h"
+#include "apx/util.h"
+#ifdef USE_CONFIGURATION_FILE
+#include "apx_build_cfg.h"
+#endif
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE CONSTANTS AND DATA TYPES
+//////////////////////////////////////////////////////////////////////////////
+#define APP_NAME "apx_event_bench"
+#define MAX_NUM_PRODUCERS 64u
+
+typedef struct bench_thread_tag
+{
+   THREAD_T thread;
+#ifdef _MSC_VER
+   unsigned int thread_id;
+#endif
+   uint32_t num_events; //Number of events to append (producers only)
+} bench_thread_t;
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////////////
+static argparse_result_t argparse_cbk(const char* short_name, const char* long_name, const char* value);
+static void print_usage(const char* arg0);
+static bool start_thread(bench_thread_t* bench_thread, bool is_consumer);
+static void join_thread(bench_thread_t* bench_thread);
+static THREAD_PROTO(consumer_task, arg);
+static THREAD_PROTO(producer_task, arg);
+static void on_event(void* arg, apx_event_t* event);
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE VARIABLES
+//////////////////////////////////////////////////////////////////////////////
+/*** Argument variables ***/
+static bool m_display_help = false;
+static uint32_t m_num_events = 2000000u;
+static uint32_t m_num_producers = 2u;
+static uint32_t m_queue_limit = 30000u;
+
+/*** Benchmark state ***/
+static apx_eventLoop_t m_event_loop;
+static uint32_t m_num_handled = 0u; //Only accessed by the consumer thread until it has been joined
+static uint64_t m_end_time = 0u;
+
+//////////////////////////////////////////////////////////////////////////////
+// PUBLIC FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+int main(int argc, char** argv)
+{
+   uint32_t i;
+   uint64_t start_time;
+   bench_thread_t consumer;
+   bench_thread_t producers[MAX_NUM_PRODUCERS];
+   apx_eventLoopStats_t stats;
+   double elapsed_ns;
+   argparse_result_t result = argparse_exec(argc, (const char**)argv, argparse_cbk);
+   if (result != ARGPARSE_SUCCESS)
+   {
+      print_usage(argv[0]);
+      return 1;
+   }
+   if (m_display_help)
+   {
+      print_usage(argv[0]);
+      return 0;
+   }
+   if (apx_eventLoop_create(&m_event_loop) != APX_NO_ERROR)
+   {
+      fprintf(stderr, "Failed to create event loop\n");
+      return 1;
+   }
+   memset(&consumer, 0, sizeof(consumer));
+   memset(producers, 0, sizeof(producers));
+   for (i = 0u; i < m_num_producers; i++)
+   {
+      producers[i].num_events = m_num_events / m_num_producers;
+   }
+   producers[0].num_events += m_num_events % m_num_producers;
+   printf("Sending %u events from %u producer threads to one event loop\n", (unsigned)m_num_events, (unsigned)m_num_producers);
+   start_time = apx_time_monotonic_us();
+   if (!start_thread(&consumer, true))
+   {
+      fprintf(stderr, "Failed to start consumer thread\n");
+      return 1;
+   }
+   for (i = 0u; i < m_num_producers; i++)
+   {
+      if (!start_thread(&producers[i], false))
+      {
+         fprintf(stderr, "Failed to start producer thread\n");
+         return 1;
+      }
+   }
+   for (i = 0u; i < m_num_producers; i++)
+   {
+      join_thread(&producers[i]);
+   }
+   //The consumer leaves the event loop by itself once the last event has been handled
+   join_thread(&consumer);
+   apx_eventLoop_getStats(&m_event_loop, &stats);
+   apx_eventLoop_destroy(&m_event_loop);
+
+   elapsed_ns = (double)(m_end_time - start_time) * 1000.0;
+   printf("Handled %u events in %.1f ms: %.1f ns/event\n", (unsigned)m_num_handled, elapsed_ns / 1000000.0, elapsed_ns / (double)m_num_events);
+   printf("Batches: %u (%.1f events/batch), semaphore waits: %u\n", (unsigned)stats.numBatches,
+      (stats.numBatches > 0u) ? (double)stats.numEventsProcessed / (double)stats.numBatches : 0.0, (unsigned)stats.numWakeups);
+   return 0;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+static argparse_result_t argparse_cbk(const char* short_name, const char* long_name, const char* value)
+{
+   const char* name = NULL;
+   char* end = NULL;
+   long lval;
+   if (short_name != NULL)
+   {
+      name = short_name;
+   }
+   else if (long_name != NULL)
+   {
+      //Map long option names to their short equivalent
+      if (strcmp(long_name, "events") == 0) name = "n";
+      else if (strcmp(long_name, "producers") == 0) name = "t";
+      else if (strcmp(long_name, "queue-limit") == 0) name = "q";
+      else if (strcmp(long_name, "help") == 0) name = "h";
+      else return ARGPARSE_NAME_ERROR;
+   }
+   else
+   {
+      return ARGPARSE_PARSE_ERROR; //No positional arguments
+   }
+   if (strcmp(name, "h") == 0)
+   {
+      m_display_help = true;
+      return ARGPARSE_SUCCESS;
+   }
+   if (strlen(name) != 1u || (strchr("ntq", name[0]) == NULL))
+   {
+      return ARGPARSE_NAME_ERROR;
+   }
+   if (value == NULL)
+   {
+      return ARGPARSE_NEED_VALUE;
+   }
+   lval = strtol(value, &end, 0);
+   if ((end <= value) || (lval <= 0))
+   {
+      return ARGPARSE_VALUE_ERROR;
+   }
+   if (strcmp(name, "n") == 0)
+   {
+      m_num_events = (uint32_t)lval;
+   }
+   else if (strcmp(name, "t") == 0)
+   {
+      if (lval > (long)MAX_NUM_PRODUCERS)
+      {
+         return ARGPARSE_VALUE_ERROR;
+      }
+      m_num_producers = (uint32_t)lval;
+   }
+   else
+   {
+      if (lval > UINT16_MAX)
+      {
+         return ARGPARSE_VALUE_ERROR;
+      }
+      m_queue_limit = (uint32_t)lval;
+   }
+   return ARGPARSE_SUCCESS;
+}
+
+static void print_usage(const char* arg0)
+{
+   printf("%s "
+      "[-n --events count] "
+      "[-t --producers count] "
+      "[-q --queue-limit count]\n"
+      , arg0);
+}
+
+static bool start_thread(bench_thread_t* bench_thread, bool is_consumer)
+{
+#ifdef _MSC_VER
+   if (is_consumer)
+   {
+      THREAD_CREATE(bench_thread->thread, consumer_task, bench_thread, bench_thread->thread_id);
+   }
+   else
+   {
+      THREAD_CREATE(bench_thread->thread, producer_task, bench_thread, bench_thread->thread_id);
+   }
+   return (bench_thread->thread != INVALID_HANDLE_VALUE);
+#else
+   int rc;
+   if (is_consumer)
+   {
+      rc = THREAD_CREATE(bench_thread->thread, consumer_task, bench_thread);
+   }
+   else
+   {
+      rc = THREAD_CREATE(bench_thread->thread, producer_task, bench_thread);
+   }
+   return (rc == 0);
+#endif
+}
+
+static void join_thread(bench_thread_t* bench_thread)
+{
+#ifdef _MSC_VER
+   (void)WaitForSingleObject(bench_thread->thread, INFINITE);
+   CloseHandle(bench_thread->thread);
+#else
+   void* status;
+   (void)pthread_join(bench_thread->thread, &status);
+#endif
+}
+
+static THREAD_PROTO(consumer_task, arg)
+{
+   (void)arg;
+   apx_eventLoop_run(&m_event_loop, on_event, NULL);
+   THREAD_RETURN(0);
+}
+
+static THREAD_PROTO(producer_task, arg)
+{
+   bench_thread_t* producer = (bench_thread_t*)arg;
+   apx_event_t event;
+   uint32_t i;
+   memset(&event, 0, sizeof(event));
+   for (i = 0u; i < producer->num_events; i++)
+   {
+      //The pending queue has a fixed upper bound, back off instead of overflowing it
+      while (apx_eventLoop_numPendingEvents(&m_event_loop) >= m_queue_limit)
+      {
+#ifdef _MSC_VER
+         (void)SwitchToThread();
+#else
+         (void)sched_yield();
+#endif
+      }
+      apx_eventLoop_append(&m_event_loop, &event);
+   }
+   THREAD_RETURN(0);
+}
+
+static void on_event(void* arg, apx_event_t* event)
+{
+   (void)arg;
+   (void)event;
+   if (++m_num_handled == m_num_events)
+   {
+      m_end_time = apx_time_monotonic_us();
+      apx_eventLoop_exit(&m_event_loop);
+   }
+}
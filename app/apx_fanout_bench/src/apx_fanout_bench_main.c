@@ -0,0 +1,503 @@
+/*****************************************************************************
+* \file      apx_fanout_bench_main.c
+* \author    Conny Gustafsson
+* \date      2026-10-18
+* \brief     Fan-out delivery latency benchmark
+*
+* Copyright (c) 2026 Conny Gustafsson
+* Permission is hereby granted, free of charge, to any person obtaining a copy of
+* this software and associated documentation files (the "Software"), to deal in
+* the Software without restriction, including without limitation the rights to
+* use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+* the Software, and to permit persons to whom the Software is furnished to do so,
+* subject to the following conditions:
+
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+* FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+* COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+* IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+* CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+******************************************************************************/
+//////////////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////////////
+#include <stdio.h>
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+#include "msocket.h"
+#include "osmacro.h"
+#include "adt_str.h"
+#include "argparse.h"
+#include "pack.h"
+#include "apx/client.h"
+#include "apx/event_listener.h"
+#include "apx/util.h"
+#ifdef USE_CONFIGURATION_FILE
+#include "apx_build_cfg.h"
+#endif
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE CONSTANTS AND DATA TYPES
+//////////////////////////////////////////////////////////////////////////////
+#define APP_NAME "apx_fanout_bench"
+#define CONNECT_TIMEOUT_MS 30000u
+#define POLL_INTERVAL_MS 100u
+#define DRAIN_TIME_MS 1000u
+
+typedef struct bench_requester_tag
+{
+   apx_client_t* client;
+   apx_portInstance_t* port;
+} bench_requester_t;
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////////////
+#ifdef _WIN32
+static int init_wsa(void);
+#endif
+static argparse_result_t argparse_cbk(const char* short_name, const char* long_name, const char* value);
+static argparse_result_t parse_option_value(const char* name, const char* value);
+static void print_usage(const char* arg0);
+static apx_client_t* create_client(const char* definition, void* arg, bool is_requester);
+static apx_error_t connect_client(apx_client_t* client);
+static bool wait_for_connections(uint32_t num_expected);
+static void run_benchmark(apx_client_t* provider);
+static void print_result(void);
+static int compare_u32(void const* a, void const* b);
+static void on_client_connected(void* arg, apx_clientConnection_t* client_connection);
+static void on_client_disconnected(void* arg, apx_clientConnection_t* client_connection);
+static void on_require_port_write(void* arg, apx_portInstance_t* port_instance, uint8_t const* data, apx_size_t size);
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE VARIABLES
+//////////////////////////////////////////////////////////////////////////////
+/*** Argument variables ***/
+static const uint16_t m_connect_port_default = 5000u;
+#ifdef _WIN32
+static const char* m_connect_address_default = "127.0.0.1";
+#else
+static const char* m_connect_address_default = "/tmp/apx_server.socket";
+#endif
+static bool m_display_help = false;
+static uint16_t m_connect_port;
+static adt_str_t* m_connect_address = (adt_str_t*)0;
+static apx_resource_type_t m_connect_resource_type = APX_RESOURCE_TYPE_UNKNOWN;
+static uint32_t m_num_requesters = 1000u;
+static uint32_t m_num_samples = 100u;
+static uint32_t m_interval_ms = 10u;
+
+/*** Benchmark state ***/
+static MUTEX_T m_lock;
+static uint32_t m_num_connected = 0u;
+static uint64_t* m_send_time = NULL;  //Length: m_num_samples, indexed by sequence number - 1
+static uint32_t* m_latency = NULL;    //Length: m_num_samples * m_num_requesters
+static uint32_t m_num_received = 0u;
+
+static const char* m_provider_definition =
+"APX/1.2\n"
+"N\"FanoutBenchProvider\"\n"
+"P\"FanoutBench_Seq\"L:=0\n"
+"\n";
+static const char* m_requester_definition =
+"APX/1.2\n"
+"N\"FanoutBenchRequester\"\n"
+"R\"FanoutBench_Seq\"L:=0\n"
+"\n";
+
+//////////////////////////////////////////////////////////////////////////////
+// PUBLIC FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+int main(int argc, char** argv)
+{
+   int retval = 0;
+   uint32_t i;
+   apx_client_t* provider = NULL;
+   bench_requester_t* requesters = NULL;
+   argparse_result_t result;
+   m_connect_port = m_connect_port_default;
+   result = argparse_exec(argc, (const char**)argv, argparse_cbk);
+   if (result != ARGPARSE_SUCCESS)
+   {
+      print_usage(argv[0]);
+      return 1;
+   }
+   if (m_display_help)
+   {
+      print_usage(argv[0]);
+      return 0;
+   }
+#ifdef _WIN32
+   if (init_wsa() != 0)
+   {
+      int err = WSAGetLastError();
+      fprintf(stderr, "WSAStartup failed with error: %d\n", err);
+      return 1;
+   }
+#endif
+   if (m_connect_resource_type == APX_RESOURCE_TYPE_UNKNOWN)
+   {
+      uint16_t dummy_port;
+      m_connect_resource_type = apx_parse_resource_name(m_connect_address_default, &m_connect_address, &dummy_port);
+      (void)dummy_port;
+      assert((m_connect_resource_type != APX_RESOURCE_TYPE_UNKNOWN) && (m_connect_resource_type != APX_RESOURCE_TYPE_ERROR));
+   }
+   MUTEX_INIT(m_lock);
+   m_send_time = (uint64_t*)calloc(m_num_samples, sizeof(uint64_t));
+   m_latency = (uint32_t*)calloc((size_t)m_num_samples * m_num_requesters, sizeof(uint32_t));
+   requesters = (bench_requester_t*)calloc(m_num_requesters, sizeof(bench_requester_t));
+   if ((m_send_time == NULL) || (m_latency == NULL) || (requesters == NULL))
+   {
+      fprintf(stderr, "Memory allocation failed\n");
+      retval = 1;
+      goto SHUTDOWN;
+   }
+   //Each client uses one socket, make sure the file descriptor limit (ulimit -n) allows m_num_requesters + 1
+   printf("Connecting 1 provider and %u requesters to %s\n", (unsigned)m_num_requesters, adt_str_cstr(m_connect_address));
+   provider = create_client(m_provider_definition, NULL, false);
+   if ((provider == NULL) || (connect_client(provider) != APX_NO_ERROR))
+   {
+      retval = 1;
+      goto SHUTDOWN;
+   }
+   for (i = 0u; i < m_num_requesters; i++)
+   {
+      requesters[i].client = create_client(m_requester_definition, &requesters[i], true);
+      if (requesters[i].client == NULL)
+      {
+         retval = 1;
+         goto SHUTDOWN;
+      }
+      requesters[i].port = apx_nodeInstance_get_require_port(apx_client_get_last_attached_node(requesters[i].client), (apx_portId_t)0u);
+      if (connect_client(requesters[i].client) != APX_NO_ERROR)
+      {
+         retval = 1;
+         goto SHUTDOWN;
+      }
+   }
+   if (!wait_for_connections(m_num_requesters + 1u))
+   {
+      fprintf(stderr, "Timeout while waiting for connections\n");
+      retval = 1;
+      goto SHUTDOWN;
+   }
+   SLEEP(DRAIN_TIME_MS); //Let the server finish routing the initial port data
+   run_benchmark(provider);
+   SLEEP(DRAIN_TIME_MS);
+   print_result();
+
+SHUTDOWN:
+   if (requesters != NULL)
+   {
+      for (i = 0u; i < m_num_requesters; i++)
+      {
+         if (requesters[i].client != NULL)
+         {
+            apx_client_disconnect(requesters[i].client);
+            apx_client_delete(requesters[i].client);
+         }
+      }
+      free(requesters);
+   }
+   if (provider != NULL)
+   {
+      apx_client_disconnect(provider);
+      apx_client_delete(provider);
+   }
+   free(m_send_time);
+   free(m_latency);
+   MUTEX_DESTROY(m_lock);
+   if (m_connect_address != NULL)
+   {
+      adt_str_delete(m_connect_address);
+   }
+   return retval;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+#ifdef _WIN32
+static int init_wsa(void)
+{
+   WORD wVersionRequested;
+   WSADATA wsaData;
+   int err;
+   wVersionRequested = MAKEWORD(2, 2);
+   err = WSAStartup(wVersionRequested, &wsaData);
+   return err;
+}
+#endif
+
+static argparse_result_t argparse_cbk(const char* short_name, const char* long_name, const char* value)
+{
+   const char* name = NULL;
+   if (short_name != NULL)
+   {
+      name = short_name;
+   }
+   else if (long_name != NULL)
+   {
+      //Map long option names to their short equivalent
+      if (strcmp(long_name, "connect") == 0) name = "c";
+      else if (strcmp(long_name, "port") == 0) name = "p";
+      else if (strcmp(long_name, "requesters") == 0) name = "n";
+      else if (strcmp(long_name, "samples") == 0) name = "s";
+      else if (strcmp(long_name, "interval") == 0) name = "i";
+      else if (strcmp(long_name, "help") == 0) name = "h";
+      else return ARGPARSE_NAME_ERROR;
+   }
+   else
+   {
+      return ARGPARSE_PARSE_ERROR; //No positional arguments
+   }
+   if (strcmp(name, "h") == 0)
+   {
+      m_display_help = true;
+      return ARGPARSE_SUCCESS;
+   }
+   if (strlen(name) != 1u || (strchr("cpnsi", name[0]) == NULL))
+   {
+      return ARGPARSE_NAME_ERROR;
+   }
+   if (value == NULL)
+   {
+      return ARGPARSE_NEED_VALUE;
+   }
+   return parse_option_value(name, value);
+}
+
+static argparse_result_t parse_option_value(const char* name, const char* value)
+{
+   char* end = NULL;
+   long lval;
+   if (strcmp(name, "c") == 0)
+   {
+      if (m_connect_address != NULL) adt_str_delete(m_connect_address);
+      m_connect_resource_type = apx_parse_resource_name(value, &m_connect_address, &m_connect_port);
+      if ((m_connect_resource_type == APX_RESOURCE_TYPE_UNKNOWN) ||
+         (m_connect_resource_type == APX_RESOURCE_TYPE_ERROR))
+      {
+         return ARGPARSE_VALUE_ERROR;
+      }
+      return ARGPARSE_SUCCESS;
+   }
+   lval = strtol(value, &end, 0);
+   if ((end <= value) || (lval <= 0))
+   {
+      return ARGPARSE_VALUE_ERROR;
+   }
+   if (strcmp(name, "p") == 0)
+   {
+      if (lval > UINT16_MAX)
+      {
+         return ARGPARSE_VALUE_ERROR;
+      }
+      m_connect_port = (uint16_t)lval;
+   }
+   else if (strcmp(name, "n") == 0)
+   {
+      m_num_requesters = (uint32_t)lval;
+   }
+   else if (strcmp(name, "s") == 0)
+   {
+      m_num_samples = (uint32_t)lval;
+   }
+   else
+   {
+      m_interval_ms = (uint32_t)lval;
+   }
+   return ARGPARSE_SUCCESS;
+}
+
+static void print_usage(const char* arg0)
+{
+   printf("%s "
+      "[-c --connect connect_path] [-p --port connect_port] "
+      "[-n --requesters count] "
+      "[-s --samples count] "
+      "[-i --interval milliseconds]\n"
+      , arg0);
+}
+
+static apx_client_t* create_client(const char* definition, void* arg, bool is_requester)
+{
+   apx_client_t* client = apx_client_new();
+   if (client != NULL)
+   {
+      apx_clientEventListener_t handler_table;
+      apx_error_t result;
+      memset(&handler_table, 0, sizeof(handler_table));
+      handler_table.arg = arg;
+      handler_table.client_connect1 = on_client_connected;
+      handler_table.client_disconnect1 = on_client_disconnected;
+      if (is_requester)
+      {
+         handler_table.require_port_write1 = on_require_port_write;
+      }
+      apx_client_register_event_listener(client, &handler_table);
+      result = apx_client_build_node(client, definition);
+      if (result != APX_NO_ERROR)
+      {
+         printf("apx_client_build_node failed with error %d\n", (int)result);
+         apx_client_delete(client);
+         client = NULL;
+      }
+   }
+   else
+   {
+      printf("apx_client_new failed\n");
+   }
+   return client;
+}
+
+static apx_error_t connect_client(apx_client_t* client)
+{
+   apx_error_t result = APX_NOT_IMPLEMENTED_ERROR;
+   switch (m_connect_resource_type)
+   {
+   case APX_RESOURCE_TYPE_IPV4: //fall-through
+   case APX_RESOURCE_TYPE_IPV6:
+      result = apx_client_connect_tcp(client, adt_str_cstr(m_connect_address), m_connect_port);
+      break;
+   case APX_RESOURCE_TYPE_FILE:
+#ifndef _WIN32
+      result = apx_client_connect_unix(client, adt_str_cstr(m_connect_address));
+#endif
+      break;
+   case APX_RESOURCE_TYPE_NAME:
+      if (strcmp(adt_str_cstr(m_connect_address), "localhost") == 0)
+      {
+         result = apx_client_connect_tcp(client, "127.0.0.1", m_connect_port);
+      }
+      break;
+   default:
+      break;
+   }
+   if (result != APX_NO_ERROR)
+   {
+      fprintf(stderr, "Failed to connect to \"%s\" (error %d)\n", adt_str_cstr(m_connect_address), (int)result);
+   }
+   return result;
+}
+
+static bool wait_for_connections(uint32_t num_expected)
+{
+   uint32_t elapsed_ms;
+   for (elapsed_ms = 0u; elapsed_ms < CONNECT_TIMEOUT_MS; elapsed_ms += POLL_INTERVAL_MS)
+   {
+      uint32_t num_connected;
+      MUTEX_LOCK(m_lock);
+      num_connected = m_num_connected;
+      MUTEX_UNLOCK(m_lock);
+      if (num_connected >= num_expected)
+      {
+         return true;
+      }
+      SLEEP(POLL_INTERVAL_MS);
+   }
+   return false;
+}
+
+static void run_benchmark(apx_client_t* provider)
+{
+   uint32_t sequence;
+   dtl_sv_t* sv = dtl_sv_new();
+   apx_portInstance_t* port = apx_nodeInstance_get_provide_port(apx_client_get_last_attached_node(provider), (apx_portId_t)0u);
+   assert(sv != NULL);
+   assert(port != NULL);
+   printf("Sending %u samples with %u ms interval\n", (unsigned)m_num_samples, (unsigned)m_interval_ms);
+   //Sequence numbers start at 1, the init value 0 is never measured
+   for (sequence = 1u; sequence <= m_num_samples; sequence++)
+   {
+      apx_error_t result;
+      dtl_sv_set_u32(sv, sequence);
+      MUTEX_LOCK(m_lock);
+      m_send_time[sequence - 1u] = apx_time_monotonic_us();
+      MUTEX_UNLOCK(m_lock);
+      result = apx_client_write_port_data(provider, port, (dtl_dv_t*)sv);
+      if (result != APX_NO_ERROR)
+      {
+         fprintf(stderr, "apx_client_write_port_data failed with error %d\n", (int)result);
+         break;
+      }
+      SLEEP(m_interval_ms);
+   }
+   dtl_dv_dec_ref((dtl_dv_t*)sv);
+}
+
+static void print_result(void)
+{
+   uint32_t num_received;
+   uint64_t const num_expected = (uint64_t)m_num_samples * m_num_requesters;
+   MUTEX_LOCK(m_lock);
+   num_received = m_num_received;
+   MUTEX_UNLOCK(m_lock);
+   printf("Deliveries: %u of %llu (lost: %llu)\n", (unsigned)num_received, (unsigned long long)num_expected,
+      (unsigned long long)(num_expected - num_received));
+   if (num_received > 0u)
+   {
+      qsort(m_latency, num_received, sizeof(uint32_t), compare_u32);
+      printf("Latency (us): p50=%u p90=%u p99=%u max=%u\n",
+         (unsigned)m_latency[(num_received * 50u) / 100u],
+         (unsigned)m_latency[(num_received * 90u) / 100u],
+         (unsigned)m_latency[(num_received * 99u) / 100u],
+         (unsigned)m_latency[num_received - 1u]);
+   }
+}
+
+static int compare_u32(void const* a, void const* b)
+{
+   uint32_t const lhs = *(uint32_t const*)a;
+   uint32_t const rhs = *(uint32_t const*)b;
+   return (lhs > rhs) - (lhs < rhs);
+}
+
+static void on_client_connected(void* arg, apx_clientConnection_t* client_connection)
+{
+   (void)arg;
+   (void)client_connection;
+   MUTEX_LOCK(m_lock);
+   m_num_connected++;
+   MUTEX_UNLOCK(m_lock);
+}
+
+static void on_client_disconnected(void* arg, apx_clientConnection_t* client_connection)
+{
+   (void)arg;
+   (void)client_connection;
+   MUTEX_LOCK(m_lock);
+   if (m_num_connected > 0u)
+   {
+      m_num_connected--;
+   }
+   MUTEX_UNLOCK(m_lock);
+}
+
+static void on_require_port_write(void* arg, apx_portInstance_t* port_instance, uint8_t const* data, apx_size_t size)
+{
+   bench_requester_t* requester = (bench_requester_t*)arg;
+   uint64_t const now = apx_time_monotonic_us();
+   if ((requester != NULL) && (port_instance == requester->port) && (size == UINT32_SIZE))
+   {
+      uint32_t const sequence = (uint32_t)unpackLE(data, UINT32_SIZE);
+      if ((sequence > 0u) && (sequence <= m_num_samples))
+      {
+         MUTEX_LOCK(m_lock);
+         if (m_num_received < (m_num_samples * m_num_requesters))
+         {
+            m_latency[m_num_received++] = (uint32_t)(now - m_send_time[sequence - 1u]);
+         }
+         MUTEX_UNLOCK(m_lock);
+      }
+   }
+}
@@ -28,6 +28,8 @@
 //////////////////////////////////////////////////////////////////////////////
 #include "extensions_cfg.h"
 #include "apx/extension/socket_server_extension.h"
+#include "apx/extension/uring_server_extension.h"
+#include "apx/extension/bridge_extension.h"
 //#include "apx_serverTextLogExtension.h"
 
 //////////////////////////////////////////////////////////////////////////////
@@ -51,7 +53,17 @@ apx_error_t register_apx_server_extensions(apx_server_t* server, dtl_hv_t* confi
         return result;
      }
   */
-   result = apx_socketServerExtension_register(server, dtl_hv_get_cstr(config, APX_SOCKET_SERVER_EXT_CFG_KEY));
+   result = apx_uringServerExtension_register(server, dtl_hv_get_cstr(config, APX_URING_SERVER_EXT_CFG_KEY));
+   if (result == APX_NOT_IMPLEMENTED_ERROR)
+   {
+      //io_uring server is disabled or not supported, use the msocket based server
+      result = apx_socketServerExtension_register(server, dtl_hv_get_cstr(config, APX_SOCKET_SERVER_EXT_CFG_KEY));
+   }
+   if (result != APX_NO_ERROR)
+   {
+      return result;
+   }
+   result = apx_bridgeExtension_register(server, dtl_hv_get_cstr(config, APX_BRIDGE_EXT_CFG_KEY));
    if (result != APX_NO_ERROR)
    {
       return result;
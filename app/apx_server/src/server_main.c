@@ -50,6 +50,11 @@ void signal_handler(int signum);
 #endif
 static void printUsage(char *name);
 static apx_error_t load_config_file(const char *filename, dtl_hv_t **hv);
+static apx_error_t configure_routing(apx_server_t *server, dtl_hv_t *server_cfg);
+static apx_error_t configure_fanout(apx_server_t *server, dtl_hv_t *server_cfg);
+static apx_error_t configure_change_only_routing(apx_server_t *server, dtl_hv_t *server_cfg);
+static apx_error_t configure_node_cache(apx_server_t *server, dtl_hv_t *server_cfg);
+static apx_error_t configure_compression(apx_server_t *server, dtl_hv_t *server_cfg);
 #ifdef _WIN32
 static int init_wsa(void);
 #endif
@@ -124,7 +129,36 @@ int main(int argc, char **argv)
    apx_server_create(&m_server);
    if (server_config != 0)
    {
-      dtl_dv_t *extension_config = (dtl_dv_t*) 0;
+      dtl_dv_t *extension_config;
+      dtl_dv_t *tmp = dtl_hv_get_cstr(server_config, "server");
+      if ( (tmp != 0) && (dtl_dv_type(tmp) == DTL_DV_HASH) )
+      {
+         result = configure_routing(&m_server, (dtl_hv_t*) tmp);
+         if (result != APX_NO_ERROR)
+         {
+            fprintf(stderr, "Invalid routing configuration (error %d)\n", (int) result);
+         }
+         result = configure_fanout(&m_server, (dtl_hv_t*) tmp);
+         if (result != APX_NO_ERROR)
+         {
+            fprintf(stderr, "Invalid fan-out configuration (error %d)\n", (int) result);
+         }
+         result = configure_change_only_routing(&m_server, (dtl_hv_t*) tmp);
+         if (result != APX_NO_ERROR)
+         {
+            fprintf(stderr, "Invalid change-only routing configuration (error %d)\n", (int) result);
+         }
+         result = configure_node_cache(&m_server, (dtl_hv_t*) tmp);
+         if (result != APX_NO_ERROR)
+         {
+            fprintf(stderr, "Invalid node cache configuration (error %d)\n", (int) result);
+         }
+         result = configure_compression(&m_server, (dtl_hv_t*) tmp);
+         if (result != APX_NO_ERROR)
+         {
+            fprintf(stderr, "Invalid compression configuration (error %d)\n", (int) result);
+         }
+      }
       extension_config = dtl_hv_get_cstr(server_config, "extension");
       if ( (extension_config != 0) && (dtl_dv_type(extension_config) == DTL_DV_HASH) )
       {
@@ -228,6 +262,194 @@ static apx_error_t load_config_file(const char *filename, dtl_hv_t **hv)
    return APX_INVALID_ARGUMENT_ERROR;
 }
 
+/**
+ * "routing-shards": 4, "routing-shard-pinning": [{"signature": "\"VehicleSpeed\"S", "shard": 1}]
+ * Data is routed on the connection threads when routing-shards is missing or 0.
+ */
+static apx_error_t configure_routing(apx_server_t *server, dtl_hv_t *server_cfg)
+{
+   apx_error_t result;
+   bool ok;
+   uint32_t num_shards;
+   int32_t i;
+   int32_t num_pins;
+   dtl_av_t *av_pinning;
+   dtl_sv_t *sv_shards = (dtl_sv_t*) dtl_hv_get_cstr(server_cfg, "routing-shards");
+   if (sv_shards == 0)
+   {
+      return APX_NO_ERROR;
+   }
+   num_shards = dtl_sv_to_u32(sv_shards, &ok);
+   if (!ok)
+   {
+      return APX_VALUE_TYPE_ERROR;
+   }
+   if (num_shards == 0u)
+   {
+      return APX_NO_ERROR;
+   }
+   result = apx_server_enable_routing_shards(server, num_shards);
+   if (result != APX_NO_ERROR)
+   {
+      return result;
+   }
+   av_pinning = (dtl_av_t*) dtl_hv_get_cstr(server_cfg, "routing-shard-pinning");
+   if (av_pinning == 0)
+   {
+      return APX_NO_ERROR;
+   }
+   if (dtl_dv_type((dtl_dv_t*) av_pinning) != DTL_DV_ARRAY)
+   {
+      return APX_VALUE_TYPE_ERROR;
+   }
+   num_pins = dtl_av_length(av_pinning);
+   for (i = 0; i < num_pins; i++)
+   {
+      const char *signature;
+      uint32_t shard_id;
+      dtl_sv_t *sv_signature;
+      dtl_sv_t *sv_shard;
+      dtl_hv_t *hv_pin = (dtl_hv_t*) dtl_av_value(av_pinning, i);
+      if ( (hv_pin == 0) || (dtl_dv_type((dtl_dv_t*) hv_pin) != DTL_DV_HASH) )
+      {
+         return APX_VALUE_TYPE_ERROR;
+      }
+      sv_signature = (dtl_sv_t*) dtl_hv_get_cstr(hv_pin, "signature");
+      sv_shard = (dtl_sv_t*) dtl_hv_get_cstr(hv_pin, "shard");
+      if ( (sv_signature == 0) || (sv_shard == 0) )
+      {
+         return APX_MISSING_KEY_ERROR;
+      }
+      signature = dtl_sv_to_cstr(sv_signature, &ok);
+      if (!ok)
+      {
+         return APX_VALUE_TYPE_ERROR;
+      }
+      shard_id = dtl_sv_to_u32(sv_shard, &ok);
+      if (!ok)
+      {
+         return APX_VALUE_TYPE_ERROR;
+      }
+      result = apx_server_pin_routing_signature(server, signature, shard_id);
+      if (result != APX_NO_ERROR)
+      {
+         return result;
+      }
+   }
+   return APX_NO_ERROR;
+}
+
+/**
+ * "fanout-workers": 4, "fanout-threshold": 64
+ * Connectors are always processed by the routing thread when fanout-workers is missing or 0.
+ */
+static apx_error_t configure_fanout(apx_server_t *server, dtl_hv_t *server_cfg)
+{
+   bool ok;
+   uint32_t num_workers;
+   int32_t threshold = APX_FANOUT_POOL_DEFAULT_THRESHOLD;
+   dtl_sv_t *sv_threshold;
+   dtl_sv_t *sv_workers = (dtl_sv_t*) dtl_hv_get_cstr(server_cfg, "fanout-workers");
+   if (sv_workers == 0)
+   {
+      return APX_NO_ERROR;
+   }
+   num_workers = dtl_sv_to_u32(sv_workers, &ok);
+   if (!ok)
+   {
+      return APX_VALUE_TYPE_ERROR;
+   }
+   if (num_workers == 0u)
+   {
+      return APX_NO_ERROR;
+   }
+   sv_threshold = (dtl_sv_t*) dtl_hv_get_cstr(server_cfg, "fanout-threshold");
+   if (sv_threshold != 0)
+   {
+      threshold = dtl_sv_to_i32(sv_threshold, &ok);
+      if (!ok)
+      {
+         return APX_VALUE_TYPE_ERROR;
+      }
+   }
+   return apx_server_enable_parallel_fanout(server, num_workers, threshold);
+}
+
+/**
+ * "change-only-routing": true
+ * Every provide port write is routed when change-only-routing is missing or false.
+ */
+static apx_error_t configure_change_only_routing(apx_server_t *server, dtl_hv_t *server_cfg)
+{
+   bool ok;
+   bool enabled;
+   dtl_sv_t *sv_change_only = (dtl_sv_t*) dtl_hv_get_cstr(server_cfg, "change-only-routing");
+   if (sv_change_only == 0)
+   {
+      return APX_NO_ERROR;
+   }
+   enabled = dtl_sv_to_bool(sv_change_only, &ok);
+   if (!ok)
+   {
+      return APX_VALUE_TYPE_ERROR;
+   }
+   apx_server_set_change_only_routing(server, enabled);
+   return APX_NO_ERROR;
+}
+
+/**
+ * "apx-cache-enabled": true, "apx-cache-max-size": 4194304
+ * The node cache is enabled with its default size limit when apx-cache-enabled is missing.
+ */
+static apx_error_t configure_node_cache(apx_server_t *server, dtl_hv_t *server_cfg)
+{
+   bool ok;
+   bool enabled = true;
+   uint32_t max_size = 0u;
+   dtl_sv_t *sv_max_size;
+   dtl_sv_t *sv_enabled = (dtl_sv_t*) dtl_hv_get_cstr(server_cfg, "apx-cache-enabled");
+   if (sv_enabled != 0)
+   {
+      enabled = dtl_sv_to_bool(sv_enabled, &ok);
+      if (!ok)
+      {
+         return APX_VALUE_TYPE_ERROR;
+      }
+   }
+   sv_max_size = (dtl_sv_t*) dtl_hv_get_cstr(server_cfg, "apx-cache-max-size");
+   if (sv_max_size != 0)
+   {
+      max_size = dtl_sv_to_u32(sv_max_size, &ok);
+      if (!ok)
+      {
+         return APX_VALUE_TYPE_ERROR;
+      }
+   }
+   apx_server_configure_node_cache(server, enabled, (apx_size_t) max_size);
+   return APX_NO_ERROR;
+}
+
+/**
+ * "compression-threshold": 256
+ * Clients offering LZ4 compression are refused when compression-threshold is missing or 0.
+ */
+static apx_error_t configure_compression(apx_server_t *server, dtl_hv_t *server_cfg)
+{
+   bool ok;
+   uint32_t threshold;
+   dtl_sv_t *sv_threshold = (dtl_sv_t*) dtl_hv_get_cstr(server_cfg, "compression-threshold");
+   if (sv_threshold == 0)
+   {
+      return APX_NO_ERROR;
+   }
+   threshold = dtl_sv_to_u32(sv_threshold, &ok);
+   if (!ok)
+   {
+      return APX_VALUE_TYPE_ERROR;
+   }
+   apx_server_enable_compression(server, threshold);
+   return APX_NO_ERROR;
+}
 
 #ifdef _WIN32
 static int init_wsa(void)
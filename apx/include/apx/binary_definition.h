@@ -0,0 +1,126 @@
+/*****************************************************************************
+* \file      binary_definition.h
+* \author    Conny Gustafsson
+* \date      2026-10-18
+* \brief     Compact binary format of precompiled node definitions
+*
+* Copyright (c) 2026 Conny Gustafsson
+* Permission is hereby granted, free of charge, to any person obtaining a copy of
+* this software and associated documentation files (the "Software"), to deal in
+* the Software without restriction, including without limitation the rights to
+* use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+* the Software, and to permit persons to whom the Software is furnished to do so,
+* subject to the following conditions:
+
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+* FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+* COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+* IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+* CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+******************************************************************************/
+#ifndef APX_BINARY_DEFINITION_H
+#define APX_BINARY_DEFINITION_H
+
+//////////////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////////////
+#include <stdint.h>
+#include <stdbool.h>
+#include "apx/types.h"
+#include "apx/error.h"
+#include "apx/remotefile.h"
+#include "adt_bytearray.h"
+
+//////////////////////////////////////////////////////////////////////////////
+// PUBLIC CONSTANTS AND DATA TYPES
+//////////////////////////////////////////////////////////////////////////////
+//forward declarations
+struct apx_nodeInstance_tag;
+
+/*
+* Layout of a binary definition (".apxb"). All integers are little endian.
+*
+* Header:
+*   magic (4 bytes), major version (1 byte), minor version (1 byte), reserved (2 bytes)
+*   SHA-256 digest of the text definition it was compiled from (32 bytes)
+*   number of types, number of provide ports, number of require ports (u32 each)
+*   provide port init data size, require port init data size (u32 each)
+* Node name (string)
+* Type table: one data signature string per type, referenced by index from the port table.
+*   Signatures are not normalized, dynamic arrays keep their maximum length.
+* Provide port init data, require port init data
+* Port table: all provide ports followed by all require ports. Each entry is
+*   name (string), type index (u32), min update interval (u32), flags (u8),
+*   pack program size (u32) and bytes, unpack program size (u32) and bytes (0 for provide ports)
+*
+* A string is its length (u16) followed by its characters and a null-terminator.
+*/
+#define APX_BINARY_DEFINITION_MAGIC_SIZE    4u
+#define APX_BINARY_DEFINITION_MAJOR_VERSION 1u
+#define APX_BINARY_DEFINITION_MINOR_VERSION 0u
+#define APX_BINARY_DEFINITION_HEADER_SIZE   (APX_BINARY_DEFINITION_MAGIC_SIZE + 4u + RMF_SHA256_SIZE + 5u * UINT32_SIZE)
+
+#define APX_BINARY_PORT_FLAG_HIGH_PRIORITY  0x01u
+
+typedef struct apx_binaryDefinitionPort_tag
+{
+   char const* name;
+   char const* data_signature;
+   uint8_t const* pack_program;
+   uint32_t pack_program_size;
+   uint8_t const* unpack_program;
+   uint32_t unpack_program_size;
+   uint32_t min_update_interval;
+   bool is_high_priority;
+} apx_binaryDefinitionPort_t;
+
+/*
+* Reads a binary definition in place. Strings and programs point into the buffer given to create
+* which must outlive the reader.
+*/
+typedef struct apx_binaryDefinitionReader_tag
+{
+   uint8_t const* next;
+   uint8_t const* end;
+   uint8_t const* source_digest;
+   char const* node_name;
+   char const** types; //Length: num_types
+   uint8_t const* provide_port_init_data;
+   uint8_t const* require_port_init_data;
+   uint32_t num_types;
+   uint32_t num_provide_ports;
+   uint32_t num_require_ports;
+   uint32_t provide_port_init_data_size;
+   uint32_t require_port_init_data_size;
+   uint32_t num_ports_read;
+} apx_binaryDefinitionReader_t;
+
+//////////////////////////////////////////////////////////////////////////////
+// PUBLIC FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////////////
+
+/*
+* Returns true when data starts with the binary definition magic.
+* A text definition can never start with the first magic byte which makes it possible to tell
+* the formats apart before the magic has been received in full.
+*/
+bool apx_binaryDefinition_is_binary(uint8_t const* data, apx_size_t size);
+/*
+* Appends node_instance in binary format to output. The node instance must have been built from
+* its text definition since the type table is generated from the data elements of its ports.
+*/
+apx_error_t apx_binaryDefinition_write(struct apx_nodeInstance_tag const* node_instance, adt_bytearray_t* output);
+
+apx_error_t apx_binaryDefinitionReader_create(apx_binaryDefinitionReader_t* self, uint8_t const* data, apx_size_t size);
+void apx_binaryDefinitionReader_destroy(apx_binaryDefinitionReader_t* self);
+/*
+* Reads the next entry of the port table. Provide ports are returned before require ports.
+*/
+apx_error_t apx_binaryDefinitionReader_next_port(apx_binaryDefinitionReader_t* self, apx_binaryDefinitionPort_t* port);
+
+#endif //APX_BINARY_DEFINITION_H
@@ -0,0 +1,81 @@
+/*****************************************************************************
+* \file      capabilities.h
+* \author    Conny Gustafsson
+* \date      2026-10-18
+* \brief     Optional protocol features negotiated in the RMF greeting
+*
+* Copyright (c) 2026 Conny Gustafsson
+* Permission is hereby granted, free of charge, to any person obtaining a copy of
+* this software and associated documentation files (the "Software"), to deal in
+* the Software without restriction, including without limitation the rights to
+* use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+* the Software, and to permit persons to whom the Software is furnished to do so,
+* subject to the following conditions:
+
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+* FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+* COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+* IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+* CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+******************************************************************************/
+#ifndef APX_CAPABILITIES_H
+#define APX_CAPABILITIES_H
+
+//////////////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////////////
+#include <stdint.h>
+#include <stdbool.h>
+#include "apx/types.h"
+
+//////////////////////////////////////////////////////////////////////////////
+// PUBLIC CONSTANTS AND DATA TYPES
+//////////////////////////////////////////////////////////////////////////////
+#define APX_CAPABILITY_COMPRESSION   0x00000001u //Messages may be sent as RMF_CMD_COMPRESSED_MSG
+#define APX_CAPABILITY_DYNAMIC_FILE  0x00000002u //Port data files may be published using dynamic file types
+#define APX_CAPABILITY_STREAM_FILE   0x00000004u //Files of type RMF_FILE_TYPE_STREAM are understood
+#define APX_CAPABILITY_PIPELINED_OPEN 0x00000008u //Client sends definition and provide port data right after publishing, without open request
+#define APX_CAPABILITY_PARTIAL_WRITE 0x00000010u //Port data may be written as a byte range inside a port
+#define APX_CAPABILITY_DEFAULT_FLAGS (APX_CAPABILITY_DYNAMIC_FILE | APX_CAPABILITY_STREAM_FILE | APX_CAPABILITY_PARTIAL_WRITE)
+
+/*
+* Optional protocol features and limits exchanged in the greeting.
+* The client announces its own set in the greeting. Servers that understand it reply with the
+* agreed set after the acknowledge. Peers that predate the negotiation never announce anything
+* and only the baseline protocol is used with them.
+*/
+typedef struct apx_capabilities_tag
+{
+   uint32_t flags;
+   uint32_t max_message_size; //Largest message (address + payload) accepted. 0 means no limit
+   uint32_t receive_buffer_size; //0 when not known
+   bool is_announced; //Set when the peer sent any capability header
+} apx_capabilities_t;
+
+//////////////////////////////////////////////////////////////////////////////
+// PUBLIC FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////////////
+void apx_capabilities_create(apx_capabilities_t* self, uint32_t flags, uint32_t max_message_size, uint32_t receive_buffer_size);
+bool apx_capabilities_has(apx_capabilities_t const* self, uint32_t flags);
+/*
+* Flags both sides support and the smaller of the message size limits.
+* receive_buffer_size is taken from peer. Gives the baseline protocol when peer did not announce anything.
+*/
+void apx_capabilities_agree(apx_capabilities_t* self, apx_capabilities_t const* local, apx_capabilities_t const* peer);
+/*
+* Writes capability header lines into buf. Returns number of characters written (excluding null-terminator)
+* or 0 if they did not fit in buf_size bytes.
+*/
+int32_t apx_capabilities_write_header(apx_capabilities_t const* self, char* buf, int32_t buf_size);
+/*
+* Parses one header line (without line ending). Returns false if the line is not a capability header.
+* Unknown feature names are ignored.
+*/
+bool apx_capabilities_parse_header_line(apx_capabilities_t* self, char const* begin, char const* end);
+
+#endif //APX_CAPABILITIES_H
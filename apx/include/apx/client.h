@@ -73,6 +73,8 @@ typedef struct apx_client_tag
    struct apx_vm_tag *vm; //strong refence
    MUTEX_T lock;
    MUTEX_T event_listener_lock;
+   uint32_t compression_threshold; //0 when compression is not offered to the server
+   bool is_pipelined_open; //Offer to send definition and provide port data without waiting for the server to open them
    bool is_connected;
 } apx_client_t;
 
@@ -107,8 +109,11 @@ int32_t apx_client_get_num_attached_nodes(apx_client_t *self);
 int32_t apx_client_get_num_event_listeners(apx_client_t *self);
 void apx_client_attach_connection(apx_client_t *self, apx_clientConnection_t *connection);
 apx_clientConnection_t *apx_client_get_connection(apx_client_t *self);
+void apx_client_enable_compression(apx_client_t *self, uint32_t threshold);
+void apx_client_enable_pipelined_open(apx_client_t *self, bool enabled);
 
 apx_error_t apx_client_build_node(apx_client_t *self, const char *definition_text);
+apx_error_t apx_client_build_node_from_binary(apx_client_t *self, const uint8_t *definition_data, uint32_t definition_size);
 int32_t apx_client_get_error_line(apx_client_t *self);
 apx_nodeInstance_t *apx_client_get_last_attached_node(apx_client_t *self);
 struct apx_fileManager_tag *apx_client_get_file_manager(apx_client_t *self);
@@ -121,6 +126,7 @@ apx_portInstance_t* apx_client_get_require_port_instance_by_id(apx_client_t *sel
 
 /*** Port Data Write API ***/
 apx_error_t apx_client_write_port_data(apx_client_t *self, apx_portInstance_t* port_instance, const dtl_dv_t *value);
+apx_error_t apx_client_write_port_data_range(apx_client_t *self, apx_portInstance_t* port_instance, uint32_t offset, const uint8_t *data, uint32_t size);
 //apx_error_t apx_client_writePortData_u8(apx_client_t *self, void *portHandle, uint8_t value);
 //apx_error_t apx_client_writePortData_u16(apx_client_t *self, void *portHandle, uint16_t value);
 //apx_error_t apx_client_writePortData_u32(apx_client_t *self, void *portHandle, uint32_t value);
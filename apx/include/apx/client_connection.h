@@ -43,6 +43,8 @@ typedef struct apx_clientConnection_tag
    struct apx_client_tag *client;
    bool is_greeting_accepted;
    apx_error_t last_error;
+   uint32_t compression_threshold; //Compression is offered in greeting when non-zero
+   bool is_pipelined_open; //Pipelined open is offered in greeting when true
 }apx_clientConnection_t;
 
 //////////////////////////////////////////////////////////////////////////////
@@ -60,6 +62,8 @@ void apx_clientConnection_require_port_data_written(apx_clientConnection_t* self
 apx_error_t apx_clientConnection_attach_node_instance(apx_clientConnection_t* self, apx_nodeInstance_t* node_instance);
 int apx_clientConnection_on_data_received(apx_clientConnection_t* self, uint8_t const* data, apx_size_t data_size, apx_size_t* parse_len);
 void apx_clientConnection_set_client(apx_clientConnection_t* self, struct apx_client_tag* client);
+void apx_clientConnection_set_compression_threshold(apx_clientConnection_t* self, uint32_t threshold);
+void apx_clientConnection_set_pipelined_open(apx_clientConnection_t* self, bool enabled);
 
 // ClientConnection API
 apx_fileManager_t *apx_clientConnection_get_file_manager(apx_clientConnection_t *self);
@@ -46,6 +46,11 @@ typedef uint8_t apx_cmdType_t;
 #define APX_CMD_CLOSE_REMOTE_FILE     ((apx_cmdType_t) 6u)
 #define APX_CMD_SEND_LOCAL_CONST_DATA ((apx_cmdType_t) 7u)
 #define APX_CMD_SEND_LOCAL_DATA       ((apx_cmdType_t) 8u)
+#define APX_CMD_APPLY_LOCAL_DATA      ((apx_cmdType_t) 9u)
+#define APX_CMD_SEND_LOCAL_SNAPSHOT   ((apx_cmdType_t) 10u)
+#define APX_CMD_DRAIN_QUEUED_DATA     ((apx_cmdType_t) 11u)
+#define APX_CMD_SEND_STREAM_RECORD    ((apx_cmdType_t) 12u)
+#define APX_CMD_OPEN_STREAM           ((apx_cmdType_t) 13u)
 
 typedef struct apx_command_tag
 {
@@ -57,6 +62,7 @@ typedef struct apx_command_tag
       uint8_t data[APX_SMALL_DATA_SIZE]; //port data (when port data length is small)
    } data3;
    void *data4; //generic pointer value
+   uint64_t queued_at_us; //set by the file manager worker when the command is queued
 } apx_command_t;
 
 
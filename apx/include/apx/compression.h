@@ -0,0 +1,78 @@
+/*****************************************************************************
+* \file      compression.h
+* \author    Conny Gustafsson
+* \date      2026-10-18
+* \brief     Fast LZ4 block compression of RMF messages
+*
+* Copyright (c) 2026 Conny Gustafsson
+* Permission is hereby granted, free of charge, to any person obtaining a copy of
+* this software and associated documentation files (the "Software"), to deal in
+* the Software without restriction, including without limitation the rights to
+* use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+* the Software, and to permit persons to whom the Software is furnished to do so,
+* subject to the following conditions:
+
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+* FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+* COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+* IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+* CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+******************************************************************************/
+#ifndef APX_COMPRESSION_H
+#define APX_COMPRESSION_H
+
+//////////////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////////////
+#include <stdint.h>
+#include <stdbool.h>
+#include "apx/types.h"
+#include "apx/error.h"
+
+//////////////////////////////////////////////////////////////////////////////
+// PUBLIC CONSTANTS AND DATA TYPES
+//////////////////////////////////////////////////////////////////////////////
+#define APX_COMPRESSION_DEFAULT_THRESHOLD 256u //Messages smaller than this are always sent uncompressed
+#define APX_COMPRESSION_MIN_THRESHOLD 32u
+#define APX_COMPRESSION_MAX_RATIO 255u //An LZ4 block never decodes to more than 255 times its own size
+
+/*
+* CPU time versus saved bytes. Time values are measured in microseconds.
+*/
+typedef struct apx_compressionStats_tag
+{
+   uint64_t num_compressed; //messages sent compressed
+   uint64_t num_incompressible; //messages above threshold that did not get smaller and were sent uncompressed
+   uint64_t bytes_before_compression; //includes incompressible messages
+   uint64_t bytes_after_compression; //includes incompressible messages
+   uint64_t compress_time_us;
+   uint64_t num_decompressed;
+   uint64_t bytes_decompressed; //uncompressed size of received messages
+   uint64_t decompress_time_us;
+} apx_compressionStats_t;
+
+//////////////////////////////////////////////////////////////////////////////
+// PUBLIC FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////////////
+
+/*
+* Compresses src into dest using the LZ4 block format.
+* Returns number of bytes written to dest or 0 if the compressed data does not fit in dest_size bytes.
+* Pass dest_size smaller than src_size to only accept output that actually saves bytes.
+* stats is optional.
+*/
+apx_size_t apx_compression_compress(uint8_t* dest, apx_size_t dest_size, uint8_t const* src, apx_size_t src_size, apx_compressionStats_t* stats);
+/*
+* Decompresses an LZ4 block. The block must decode to exactly dest_size bytes.
+* stats is optional.
+*/
+apx_error_t apx_compression_decompress(uint8_t* dest, apx_size_t dest_size, uint8_t const* src, apx_size_t src_size, apx_compressionStats_t* stats);
+void apx_compressionStats_create(apx_compressionStats_t* self);
+void apx_compressionStats_add(apx_compressionStats_t* self, apx_compressionStats_t const* other);
+
+#endif //APX_COMPRESSION_H
@@ -63,6 +63,8 @@ typedef void (apx_nodeFileOpenNotifyFunc)(void *arg, apx_nodeInstance_t * node_i
 typedef void (apx_portConnectorChangeCreateNotifyFunc)(void *arg, apx_nodeInstance_t * node_instance, apx_portType_t portType);
 typedef void (apx_nodeCreatedFunc)(void* arg, apx_nodeInstance_t* node_instance);
 typedef void (apx_requirePortWriteNotificationFunc)(void* arg, apx_portInstance_t* port_instance, uint8_t const* data, apx_size_t size);
+typedef int32_t (apx_greetingHeaderWriteFunc)(void* arg, char* buf, int32_t buf_size);
+typedef void (apx_greetingHeaderNotificationFunc)(void* arg, char const* header_line);
 
 typedef struct apx_connectionBaseVTable_tag
 {
@@ -72,6 +74,8 @@ typedef struct apx_connectionBaseVTable_tag
    apx_nodeCreatedFunc* node_created_notification;
    apx_portConnectorChangeCreateNotifyFunc* port_connector_change_notify;
    apx_requirePortWriteNotificationFunc* require_port_write_notification;
+   apx_greetingHeaderWriteFunc* greeting_header_write; //Client mode: appends transport specific lines to greeting
+   apx_greetingHeaderNotificationFunc* greeting_header_notification; //Server mode: called for each line in received greeting
 } apx_connectionBaseVTable_t;
 
 typedef struct apx_connectionBase_tag
@@ -91,6 +95,7 @@ typedef struct apx_connectionBase_tag
    uint32_t total_bytes_sent;
    uint32_t connection_id;
    apx_size_t num_header_size; //UINT16_SIZE or UINT32_SIZE
+   apx_capabilities_t local_capabilities; //Announced in greeting. Transports fill in their buffer sizes
    apx_mode_t mode;
    bool event_loop_thread_valid;
 #ifdef _WIN32
@@ -119,6 +124,9 @@ apx_error_t apx_connectionBase_message_received(apx_connectionBase_t *self, cons
 uint16_t apx_connectionBase_get_num_pending_events(apx_connectionBase_t *self);
 uint16_t apx_connectionBase_get_num_pending_worker_commands(apx_connectionBase_t *self);
 void apx_connectionBase_set_connection_id(apx_connectionBase_t* self, uint32_t connection_id);
+void apx_connectionBase_set_local_capabilities(apx_connectionBase_t* self, apx_capabilities_t const* capabilities);
+void apx_connectionBase_get_local_capabilities(apx_connectionBase_t const* self, apx_capabilities_t* capabilities);
+void apx_connectionBase_get_capabilities(apx_connectionBase_t* self, apx_capabilities_t* capabilities);
 
 //uint8_t *apx_connectionBase_alloc(apx_connectionBase_t *self, size_t size);
 //void apx_connectionBase_free(apx_connectionBase_t *self, uint8_t *ptr, size_t size);
@@ -127,6 +135,8 @@ void apx_connectionBase_set_connection_id(apx_connectionBase_t* self, uint32_t c
 //Virtual function call-points
 void apx_connectionBase_node_created_notification(apx_connectionBase_t const* self, apx_nodeInstance_t* node_instance);
 void apx_connectionBase_require_port_write_notification(apx_connectionBase_t const* self, apx_portInstance_t* port_instance, uint8_t const* raw_data, apx_size_t data_size);
+int32_t apx_connectionBase_greeting_header_write(apx_connectionBase_t const* self, char* buf, int32_t buf_size);
+void apx_connectionBase_greeting_header_notification(apx_connectionBase_t const* self, char const* header_line);
 
 /*** Internal Callback API ***/
 
@@ -49,6 +49,7 @@ typedef struct apx_connectionInterface_tag
    void (*transmit_end)(void* arg); //Unlocks transmit resource
    apx_connection_transmit_data_message_func* transmit_data_message; //Message that is written into the remotefile address space
    apx_connection_transmit_direct_message_func* transmit_direct_message; //Message that is written outside the remotefile address space
+   int32_t(*transmit_flush_deadline)(void* arg); //Optional. Returns microseconds until buffered data must be flushed, negative value when nothing is buffered
 
    // Notification callbacks
    apx_error_t (*remote_file_published_notification)(void* arg, apx_file_t* file);
@@ -73,6 +73,7 @@ void apx_connectionManager_attach(apx_connectionManager_t *self, apx_serverConne
 void apx_connectionManager_detach(apx_connectionManager_t *self, apx_serverConnection_t *connection);
 apx_serverConnection_t* apx_connectionManager_get_last_connection(apx_connectionManager_t const* self);
 uint32_t apx_connectionManager_get_num_connections(apx_connectionManager_t *self);
+void apx_connectionManager_get_compression_stats(apx_connectionManager_t *self, apx_compressionStats_t *stats);
 #ifdef UNIT_TEST
 void apx_connectionManager_run(apx_connectionManager_t *self);
 #endif
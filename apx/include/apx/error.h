@@ -89,6 +89,8 @@ typedef int32_t apx_error_t;
 #define APX_TOO_MANY_REFERENCES_ERROR          75
 #define APX_INDEX_ERROR                        76
 #define APX_SEMAPHORE_ERROR                    77
+#define APX_SHARED_MEMORY_ERROR                78
+#define APX_COMPRESSION_ERROR                  79
 
 //////////////////////////////////////////////////////////////////////////////
 // GLOBAL FUNCTION PROTOTYPES
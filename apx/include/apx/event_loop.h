@@ -51,12 +51,24 @@
 //////////////////////////////////////////////////////////////////////////////
 //forward declarations
 
+//Maximum number of events removed from the queue in a single lock acquisition
+#define APX_EVENT_LOOP_BATCH_SIZE 32
+
+typedef struct apx_eventLoopStats_tag
+{
+   uint32_t numEventsProcessed; //total number of events given to the event handler
+   uint32_t numBatches;         //number of times the queue was drained (one lock acquisition per batch)
+   uint32_t numWakeups;         //number of times the consumer had to wait on the semaphore
+} apx_eventLoopStats_t;
+
 typedef struct apx_eventLoop_tag
 {
    SPINLOCK_T lock;
    SEMAPHORE_T semaphore;
    adt_rbfh_t pendingEvents;
+   apx_eventLoopStats_t stats;
    bool exitFlag;
+   bool isConsumerWaiting; //protected by lock. When false, producers do not need to post the semaphore
 } apx_eventLoop_t;
 
 
@@ -73,6 +85,7 @@ void apx_eventLoop_append(apx_eventLoop_t *self, apx_event_t *event);
 void apx_eventLoop_run(apx_eventLoop_t *self, apx_eventHandlerFunc_t *eventHandler, void *eventHandlerArg);
 void apx_eventLoop_exit(apx_eventLoop_t *self);
 uint16_t apx_eventLoop_numPendingEvents(apx_eventLoop_t *self);
+void apx_eventLoop_getStats(apx_eventLoop_t *self, apx_eventLoopStats_t *stats);
 #ifdef UNIT_TEST
 void apx_eventLoop_runAll(apx_eventLoop_t *self, apx_eventHandlerFunc_t *eventHandler, void *eventHandlerArg);
 #endif
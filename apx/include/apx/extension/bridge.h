@@ -0,0 +1,157 @@
+/*****************************************************************************
+* \file      bridge.h
+* \author    Conny Gustafsson
+* \date      2026-10-18
+* \brief     Bridge between APX servers
+*
+* Copyright (c) 2026 Conny Gustafsson
+* Permission is hereby granted, free of charge, to any person obtaining a copy of
+* this software and associated documentation files (the "Software"), to deal in
+* the Software without restriction, including without limitation the rights to
+* use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+* the Software, and to permit persons to whom the Software is furnished to do so,
+* subject to the following conditions:
+
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+* FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+* COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+* IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+* CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+******************************************************************************/
+#ifndef APX_BRIDGE_H
+#define APX_BRIDGE_H
+
+//////////////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////////////
+#include <stdint.h>
+#include <stdbool.h>
+#include "apx/error.h"
+#include "apx/types.h"
+#include "apx/client.h"
+#include "apx/port_signature_map.h"
+#include "adt_ary.h"
+#include "adt_hash.h"
+#include "adt_str.h"
+#include "osmacro.h"
+
+//////////////////////////////////////////////////////////////////////////////
+// PUBLIC CONSTANTS AND DATA TYPES
+//////////////////////////////////////////////////////////////////////////////
+#define APX_BRIDGE_NODE_PREFIX "Bridge_" //Requesters in nodes with this prefix never cause a signature to be imported
+#define APX_BRIDGE_DEFAULT_POLL_INTERVAL_MS 100u
+#define APX_BRIDGE_DEFAULT_UNSUBSCRIBE_DELAY_MS 5000u
+#define APX_BRIDGE_LOCAL_ADDRESS "127.0.0.1"
+
+struct apx_server_tag;
+struct apx_bridge_tag;
+
+/*
+* One port signature imported from a peer server.
+* The latest value received from the peer is kept until the signature is exported as a provide port in the local server.
+*/
+typedef struct apx_bridgePort_tag
+{
+   char *port_signature;             //strong reference, "Name"DataSignature
+   uint8_t *value;                   //strong reference, latest value received from the peer
+   apx_size_t value_size;
+   apx_nodeInstance_t *export_node;  //weak reference, local provider node that carries this port (NULL until exported)
+   uint32_t export_offset;           //provide port offset inside export_node
+   bool is_exported;                 //true once a local provide port has been reserved for this port
+   bool is_imported;                 //true while a require port in one of the link imports carries this port
+   bool is_wanted;                   //false when the last bridge cycle found no local requester or found a local provider
+} apx_bridgePort_t;
+
+//A require port node published to a peer, one is added each time new signatures are imported
+typedef struct apx_bridgeImport_tag
+{
+   char *node_name;                  //strong reference
+   adt_ary_t ports;                  //weak references to apx_bridgePort_t, indexed by require port id
+} apx_bridgeImport_t;
+
+/*
+* Connection to one peer server. All imported signatures share the single RMF connection of the link client.
+* Nodes can not be removed from a client, so the client is replaced when the link drops and to unsubscribe
+* signatures that are no longer wanted. The peer server removes the old import nodes with the old connection.
+*/
+typedef struct apx_bridgeLink_tag
+{
+   struct apx_bridge_tag *parent;
+   apx_client_t *client;             //strong reference, connection to the peer server
+   char *address;                    //strong reference
+   uint16_t tcp_port;
+   adt_hash_t ports;                 //strong references to apx_bridgePort_t, keyed by port signature
+   adt_ary_t imports;                //strong references to apx_bridgeImport_t
+   adt_ary_t pending_exports;        //weak references to apx_bridgePort_t with a value but no local provide port yet
+   void *listener_handle;
+   uint64_t unused_since_ms;         //when the link first had an import that is no longer wanted
+   bool has_unused_imports;
+   bool is_connect_attempted;
+   bool is_dropped;                  //set when the connection to the peer is lost
+} apx_bridgeLink_t;
+
+/*
+* Bridges the local apx_server to one or more peer servers.
+* Signatures that have local requesters but no local provider are imported from each peer, and only those
+* signatures cross the link. Values from the first peer that delivers a signature are provided to the local server
+* by proxy nodes built on a local client connection, so routing inside each server is left unchanged.
+* When a local provider appears for an exported signature, the proxy nodes are rebuilt on a new local connection
+* without that signature so the local server never has two providers for it.
+*/
+typedef struct apx_bridge_tag
+{
+   struct apx_server_tag *server;    //weak reference
+   apx_client_t *local_client;       //strong reference, connection to the local server
+   char *name;                       //strong reference, used in proxy node names
+   char *local_address;              //strong reference
+   uint16_t local_tcp_port;
+   adt_ary_t links;                  //strong references to apx_bridgeLink_t
+   adt_hash_t exported;              //weak references to apx_bridgePort_t, keyed by port signature
+   uint32_t num_export_nodes;
+   uint32_t poll_interval_ms;
+   uint32_t unsubscribe_delay_ms;    //how long a link keeps imports that are no longer wanted
+   void *local_listener_handle;
+   MUTEX_T lock;                     //protects port values, import and export state
+   THREAD_T worker_thread;
+   bool is_worker_valid;
+   bool is_running;
+   bool is_local_connect_attempted;
+   bool is_local_dropped;            //set when the connection to the local server is lost
+#ifdef _WIN32
+   unsigned int thread_id;
+#endif
+} apx_bridge_t;
+
+//////////////////////////////////////////////////////////////////////////////
+// PUBLIC FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////////////
+apx_error_t apx_bridge_create(apx_bridge_t *self, struct apx_server_tag *server, char const *name);
+void apx_bridge_destroy(apx_bridge_t *self);
+apx_bridge_t *apx_bridge_new(struct apx_server_tag *server, char const *name);
+void apx_bridge_delete(apx_bridge_t *self);
+apx_error_t apx_bridge_set_local_endpoint(apx_bridge_t *self, char const *address, uint16_t tcp_port);
+void apx_bridge_set_poll_interval(apx_bridge_t *self, uint32_t poll_interval_ms);
+void apx_bridge_set_unsubscribe_delay(apx_bridge_t *self, uint32_t unsubscribe_delay_ms);
+apx_bridgeLink_t *apx_bridge_add_peer(apx_bridge_t *self, char const *address, uint16_t tcp_port);
+int32_t apx_bridge_num_links(apx_bridge_t *self);
+apx_bridgeLink_t *apx_bridge_get_link(apx_bridge_t *self, int32_t index);
+apx_client_t *apx_bridge_get_local_client(apx_bridge_t *self);
+apx_error_t apx_bridge_start(apx_bridge_t *self);
+void apx_bridge_stop(apx_bridge_t *self);
+apx_error_t apx_bridge_run(apx_bridge_t *self);
+
+apx_error_t apx_bridgeLink_import_signatures(apx_bridgeLink_t *self, adt_ary_t const *signatures);
+int32_t apx_bridgeLink_num_imported_signatures(apx_bridgeLink_t *self);
+void apx_bridgeLink_require_port_written(apx_bridgeLink_t *self, apx_portInstance_t *port_instance, uint8_t const *data, apx_size_t size);
+void apx_bridgeLink_disconnected(apx_bridgeLink_t *self);
+apx_error_t apx_bridge_export_pending_ports(apx_bridge_t *self);
+
+int32_t apx_bridge_collect_unresolved_signatures(apx_portSignatureMap_t *map, adt_ary_t *signatures);
+adt_str_t *apx_bridge_create_definition(char const *node_name, char port_type, adt_ary_t const *ports);
+
+#endif //APX_BRIDGE_H
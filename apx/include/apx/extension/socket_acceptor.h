@@ -0,0 +1,102 @@
+/*****************************************************************************
+* \file      socket_acceptor.h
+* \author    Conny Gustafsson
+* \date      2026-10-18
+* \brief     Multi-threaded TCP acceptor using SO_REUSEPORT
+*
+* Copyright (c) 2026 Conny Gustafsson
+* Permission is hereby granted, free of charge, to any person obtaining a copy of
+* this software and associated documentation files (the "Software"), to deal in
+* the Software without restriction, including without limitation the rights to
+* use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+* the Software, and to permit persons to whom the Software is furnished to do so,
+* subject to the following conditions:
+
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+* FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+* COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+* IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+* CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+******************************************************************************/
+#ifndef APX_SOCKET_ACCEPTOR_H
+#define APX_SOCKET_ACCEPTOR_H
+
+//////////////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////////////
+#include <stdint.h>
+#include <stdbool.h>
+#include "apx/error.h"
+#include "osmacro.h"
+
+//////////////////////////////////////////////////////////////////////////////
+// PUBLIC CONSTANTS AND DATA TYPES
+//////////////////////////////////////////////////////////////////////////////
+#if defined(__linux__) && !defined(_WIN32)
+# include <sys/socket.h>
+# ifdef SO_REUSEPORT
+#  define APX_SOCKET_ACCEPTOR_SUPPORTED 1
+# endif
+#endif
+#ifndef APX_SOCKET_ACCEPTOR_SUPPORTED
+# define APX_SOCKET_ACCEPTOR_SUPPORTED 0
+#endif
+
+#define APX_SOCKET_ACCEPTOR_MAX_THREADS 64
+#define APX_SOCKET_ACCEPTOR_QUEUE_SIZE 1024 //accepted sockets waiting for a setup thread
+
+//Called on a setup thread with a newly accepted socket. The handler takes ownership of fd.
+typedef void (apx_socketAcceptorHandlerFunc)(void *arg, int fd);
+
+struct apx_socketAcceptor_tag;
+
+typedef struct apx_socketAcceptorThread_tag
+{
+   struct apx_socketAcceptor_tag *parent;
+   int listen_fd;
+   THREAD_T accept_thread;
+   THREAD_T setup_thread;
+} apx_socketAcceptorThread_t;
+
+/*
+* Listens on one TCP port with several sockets bound using SO_REUSEPORT. The kernel spreads incoming
+* connections over the sockets, each served by its own accept thread. Accept threads only accept, connection
+* objects are constructed by a separate pool of setup threads so a burst of reconnects does not stall accept.
+*/
+typedef struct apx_socketAcceptor_tag
+{
+   apx_socketAcceptorHandlerFunc *handler;
+   void *handler_arg;
+   apx_socketAcceptorThread_t threads[APX_SOCKET_ACCEPTOR_MAX_THREADS];
+   int queue[APX_SOCKET_ACCEPTOR_QUEUE_SIZE];
+   uint32_t queue_head;
+   uint32_t queue_tail;
+   uint32_t num_threads;
+   uint32_t num_accepted;
+   uint16_t tcp_port;
+   MUTEX_T queue_lock;
+   SEMAPHORE_T queue_items;
+   SEMAPHORE_T queue_space;
+   bool is_running;
+} apx_socketAcceptor_t;
+
+//////////////////////////////////////////////////////////////////////////////
+// PUBLIC FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////////////
+#if APX_SOCKET_ACCEPTOR_SUPPORTED
+void apx_socketAcceptor_create(apx_socketAcceptor_t *self, apx_socketAcceptorHandlerFunc *handler, void *handler_arg);
+void apx_socketAcceptor_destroy(apx_socketAcceptor_t *self);
+apx_socketAcceptor_t* apx_socketAcceptor_new(apx_socketAcceptorHandlerFunc *handler, void *handler_arg);
+void apx_socketAcceptor_delete(apx_socketAcceptor_t *self);
+apx_error_t apx_socketAcceptor_start(apx_socketAcceptor_t *self, uint16_t tcp_port, uint32_t num_threads);
+void apx_socketAcceptor_stop(apx_socketAcceptor_t *self);
+uint16_t apx_socketAcceptor_get_port(apx_socketAcceptor_t const *self);
+uint32_t apx_socketAcceptor_get_num_accepted(apx_socketAcceptor_t *self);
+#endif
+
+#endif //APX_SOCKET_ACCEPTOR_H
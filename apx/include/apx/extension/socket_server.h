@@ -36,6 +36,8 @@
 #include "msocket_server.h"
 #include "testsocket.h"
 #include "dtl_type.h"
+#include "apx/extension/socket_server_connection.h"
+#include "apx/extension/socket_acceptor.h"
 
 //////////////////////////////////////////////////////////////////////////////
 // PUBLIC CONSTANTS AND DATA TYPES
@@ -52,6 +54,13 @@ typedef struct apx_socketServer_tag
    struct apx_server_tag *parent; //parent server
    char *tcp_connection_tag; //Optional tag to set on new TCP connections
    char *unix_connection_tag; //Optional tag to set on new Unix socket connections
+   apx_socketBatchingCfg_t tcp_batching; //Transmit batching policy for new TCP connections
+   apx_socketBatchingCfg_t unix_batching; //Transmit batching policy for new Unix socket connections
+   bool unix_shm_transport; //Accept shared memory transport offered by Unix socket clients
+   uint32_t num_tcp_acceptors; //More than one uses SO_REUSEPORT listeners instead of tcp_server
+#if APX_SOCKET_ACCEPTOR_SUPPORTED
+   apx_socketAcceptor_t *tcp_acceptor;
+#endif
    bool is_tcp_server_started;
    bool is_unix_server_started;
 } apx_socketServer_t;
@@ -73,6 +82,10 @@ void apx_socketServer_stop_unix_server(apx_socketServer_t *self);
 #endif
 void apx_socketServer_stop_all(apx_socketServer_t *self);
 void apx_socketServer_stop_tcp_server(apx_socketServer_t *self);
+void apx_socketServer_set_tcp_batching(apx_socketServer_t *self, apx_socketBatchingCfg_t const *cfg);
+void apx_socketServer_set_unix_batching(apx_socketServer_t *self, apx_socketBatchingCfg_t const *cfg);
+void apx_socketServer_set_unix_shm_transport(apx_socketServer_t *self, bool enable);
+void apx_socketServer_set_tcp_acceptors(apx_socketServer_t *self, uint32_t num_acceptors);
 #ifdef UNIT_TEST
 void apx_socketServer_accept_testsocket(apx_socketServer_t *self, testsocket_t *sock);
 #endif
@@ -32,6 +32,7 @@
 //////////////////////////////////////////////////////////////////////////////
 #include "adt_bytearray.h"
 #include "apx/server_connection.h"
+#include "apx/shm_transport.h"
 
 //////////////////////////////////////////////////////////////////////////////
 // PUBLIC CONSTANTS AND DATA TYPES
@@ -43,15 +44,37 @@
 #endif
 SOCKET_TYPE; //this is a forward declaration of the declared type just above
 
+//Transmit batching policy. Can be set per connection class (TCP or UNIX socket) in the server configuration
+typedef struct apx_socketBatchingCfg_tag
+{
+   apx_size_t max_pending_bytes; //flush as soon as this many bytes are buffered. 0 means full send buffer
+   uint32_t max_pending_us; //longest time data may remain buffered after the worker finished its queue. 0 means flush immediately
+   bool tcp_nodelay; //sets TCP_NODELAY on the socket when connection starts
+   bool tcp_cork; //corks socket while a batch is being written in several parts, uncorks on final flush (Linux only)
+} apx_socketBatchingCfg_t;
+
 typedef struct apx_socketServerConnection_tag
 {
    apx_serverConnection_t base;
    apx_nodeManager_t node_manager;
-   adt_bytearray_t send_buffer;
+   adt_bytearray_t send_buffer; //allocated once in create, kept for the lifetime of the connection
+   adt_bytearray_t unsent_buffer; //data the socket did not accept (short write or EAGAIN), sent before anything else
    apx_size_t default_buffer_size;
    apx_size_t pending_bytes;
+   uint64_t total_bytes_copied; //number of bytes memcpy'd into send_buffer
+   uint64_t total_bytes_written; //number of bytes given to the socket layer
+   uint64_t pending_since_us; //time when first byte currently in send_buffer was written
+   apx_socketBatchingCfg_t batching;
+   bool is_corked;
+   bool is_tcp; //false for UNIX domain sockets, which ignore tcp_nodelay and tcp_cork
+   bool is_send_failed; //socket write failed, the connection is being closed
+   bool is_shm_enabled; //accept shared memory offered by client in greeting
+   apx_shmTransport_t* shm_transport; //when not NULL, all data is exchanged through shared memory instead of the socket
    SOCKET_TYPE *socket_object;
    MUTEX_T lock;
+#ifdef UNIT_TEST
+   int32_t write_limit; //see apx_socketServerConnection_set_write_limit
+#endif
 }apx_socketServerConnection_t;
 
 //////////////////////////////////////////////////////////////////////////////
@@ -65,6 +88,10 @@ void apx_socketServerConnection_delete(apx_socketServerConnection_t *self);
 void apx_socketServerConnection_vdelete(void *arg);
 void apx_socketServerConnection_vstart(void *arg);
 void apx_socketServerConnection_vclose(void *arg);
+void apx_socketServerConnection_set_batching(apx_socketServerConnection_t* self, apx_socketBatchingCfg_t const* cfg);
+void apx_socketBatchingCfg_set_defaults(apx_socketBatchingCfg_t* cfg);
+void apx_socketServerConnection_enable_shm_transport(apx_socketServerConnection_t* self, bool enable);
+bool apx_socketServerConnection_is_shm_transport_active(apx_socketServerConnection_t const* self);
 
 // ConnectionInterface API
 int32_t apx_socketServerConnection_vtransmit_max_bytes_avaiable(void* arg);
@@ -73,8 +100,16 @@ void apx_socketServerConnection_vtransmit_begin(void* arg);
 void apx_socketServerConnection_vtransmit_end(void* arg);
 apx_error_t apx_socketServerConnection_vtransmit_data_message(void* arg, uint32_t write_address, bool more_bit, uint8_t const* msg_data, int32_t msg_size, int32_t* bytes_available);
 apx_error_t apx_socketServerConnection_vtransmit_direct_message(void* arg, uint8_t const* msg_data, int32_t msg_size, int32_t* bytes_available);
+int32_t apx_socketServerConnection_vtransmit_flush_deadline(void* arg);
+
+// Statistics
+uint64_t apx_socketServerConnection_get_total_bytes_copied(apx_socketServerConnection_t* self);
+uint64_t apx_socketServerConnection_get_total_bytes_written(apx_socketServerConnection_t* self);
+double apx_socketServerConnection_get_copy_ratio(apx_socketServerConnection_t* self);
+apx_size_t apx_socketServerConnection_get_unsent_bytes(apx_socketServerConnection_t* self);
 #ifdef UNIT_TEST
 void apx_socketServerConnection_run(apx_socketServerConnection_t* self);
+void apx_socketServerConnection_set_write_limit(apx_socketServerConnection_t* self, int32_t write_limit);
 #endif
 
 #undef SOCKET_TYPE
@@ -0,0 +1,114 @@
+/*****************************************************************************
+* \file      uring.h
+* \author    Conny Gustafsson
+* \date      2026-10-18
+* \brief     Minimal io_uring wrapper used by the io_uring socket server extension
+*
+* Copyright (c) 2026 Conny Gustafsson
+* Permission is hereby granted, free of charge, to any person obtaining a copy of
+* this software and associated documentation files (the "Software"), to deal in
+* the Software without restriction, including without limitation the rights to
+* use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+* the Software, and to permit persons to whom the Software is furnished to do so,
+* subject to the following conditions:
+
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+* FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+* COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+* IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+* CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+******************************************************************************/
+#ifndef APX_URING_H
+#define APX_URING_H
+
+//////////////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////////////
+#include "apx/types.h"
+#include "apx/error.h"
+
+//////////////////////////////////////////////////////////////////////////////
+// PUBLIC CONSTANTS AND DATA TYPES
+//////////////////////////////////////////////////////////////////////////////
+#if defined(__linux__) && defined(APX_HAVE_IO_URING)
+#define APX_URING_SUPPORTED 1 //Build headers have buffer rings and multishot accept/recv (5.19+). Kernel support is checked at runtime by apx_uring_probe
+#else
+#define APX_URING_SUPPORTED 0
+#endif
+
+#define APX_URING_MAX_BUFFER_COUNT 32768u
+
+//Forward declarations
+struct io_uring_sqe;
+struct io_uring_cqe;
+struct io_uring_buf_ring;
+
+typedef struct apx_uringCompletion_tag
+{
+   uint64_t user_data;
+   int32_t res; //result of operation, negative errno on failure
+   uint32_t flags;
+} apx_uringCompletion_t;
+
+/*
+* Submission side is not thread-safe. Callers serialize the prep/submit calls among themselves.
+* Completions and provided buffers must be handled by a single thread.
+*/
+typedef struct apx_uring_tag
+{
+   int ring_fd;
+   //Submission queue
+   uint32_t* sq_head;
+   uint32_t* sq_tail;
+   uint32_t sq_mask;
+   uint32_t sq_entries;
+   uint32_t sq_local_tail; //SQEs prepared but not yet published to kernel
+   struct io_uring_sqe* sqes;
+   //Completion queue
+   uint32_t* cq_head;
+   uint32_t* cq_tail;
+   uint32_t cq_mask;
+   struct io_uring_cqe* cqes;
+   void* ring_memory;
+   size_t ring_memory_size;
+   size_t sqes_size;
+   //Provided receive buffers
+   struct io_uring_buf_ring* buf_ring;
+   size_t buf_ring_size;
+   uint8_t* buf_memory;
+   uint32_t buf_count;
+   uint32_t buf_size;
+   uint16_t buf_group;
+   uint16_t buf_tail;
+} apx_uring_t;
+
+//////////////////////////////////////////////////////////////////////////////
+// PUBLIC FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////////////
+apx_error_t apx_uring_create(apx_uring_t* self, uint32_t entries);
+void apx_uring_destroy(apx_uring_t* self);
+apx_error_t apx_uring_probe(void);
+
+apx_error_t apx_uring_register_buffers(apx_uring_t* self, uint16_t group_id, uint32_t count, uint32_t size);
+uint8_t* apx_uring_get_buffer(apx_uring_t const* self, uint16_t buffer_id);
+void apx_uring_recycle_buffer(apx_uring_t* self, uint16_t buffer_id);
+
+bool apx_uring_prep_multishot_accept(apx_uring_t* self, int fd, uint64_t user_data);
+bool apx_uring_prep_multishot_recv(apx_uring_t* self, int fd, uint64_t user_data);
+bool apx_uring_prep_send(apx_uring_t* self, int fd, uint8_t const* data, uint32_t size, uint64_t user_data, bool link_next);
+bool apx_uring_prep_nop(apx_uring_t* self, uint64_t user_data);
+uint32_t apx_uring_sq_space_left(apx_uring_t const* self);
+void apx_uring_publish(apx_uring_t* self);
+int apx_uring_submit(apx_uring_t* self);
+int apx_uring_submit_and_wait(apx_uring_t* self, uint32_t wait_nr);
+uint32_t apx_uring_peek_completions(apx_uring_t* self, apx_uringCompletion_t* completions, uint32_t max_count);
+
+bool apx_uringCompletion_has_more(apx_uringCompletion_t const* self);
+bool apx_uringCompletion_get_buffer_id(apx_uringCompletion_t const* self, uint16_t* buffer_id);
+
+#endif //APX_URING_H
@@ -0,0 +1,111 @@
+/*****************************************************************************
+* \file      uring_server.h
+* \author    Conny Gustafsson
+* \date      2026-10-18
+* \brief     Socket server based on io_uring (TCP+UNIX)
+*
+* Copyright (c) 2026 Conny Gustafsson
+* Permission is hereby granted, free of charge, to any person obtaining a copy of
+* this software and associated documentation files (the "Software"), to deal in
+* the Software without restriction, including without limitation the rights to
+* use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+* the Software, and to permit persons to whom the Software is furnished to do so,
+* subject to the following conditions:
+
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+* FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+* COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+* IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+* CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+******************************************************************************/
+#ifndef APX_URING_SERVER_H
+#define APX_URING_SERVER_H
+
+//////////////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////////////
+#include "apx/types.h"
+#include "apx/error.h"
+#include "apx/extension/uring.h"
+#include "apx/extension/uring_server_connection.h"
+#include "osmacro.h"
+
+//////////////////////////////////////////////////////////////////////////////
+// PUBLIC CONSTANTS AND DATA TYPES
+//////////////////////////////////////////////////////////////////////////////
+//Forward declarations
+struct apx_server_tag;
+
+#define APX_URING_SERVER_LABEL "URING"
+
+typedef struct apx_uringServerCfg_tag
+{
+   uint32_t queue_depth; //number of submission queue entries
+   uint32_t buffer_count; //number of provided receive buffers shared by all connections, power of two
+   uint32_t buffer_size; //size of each receive buffer
+   uint32_t max_connections;
+   apx_size_t send_block_size; //outgoing messages are collected into blocks of this size before being submitted
+   bool tcp_nodelay;
+} apx_uringServerCfg_t;
+
+#if APX_URING_SERVER_SUPPORTED
+typedef struct apx_uringServerSlot_tag
+{
+   apx_uringServerConnection_t* connection;
+   uint32_t generation;
+} apx_uringServerSlot_t;
+
+/*
+* One thread waits for completions of all connections. Receive completions from many connections are
+* handled in the same wakeup, and the receive buffers are returned to the kernel without system calls.
+* Connection worker threads submit their send chains directly.
+*/
+typedef struct apx_uringServer_tag
+{
+   apx_uring_t ring;
+   apx_uringServerCfg_t cfg;
+   struct apx_server_tag* parent;
+   apx_uringServerSlot_t* slots;
+   uint32_t next_slot;
+   uint32_t num_sends_in_flight;
+   int tcp_listen_fd;
+   int unix_listen_fd;
+   uint16_t tcp_port;
+   char* unix_server_file;
+   MUTEX_T submit_lock; //serializes SQE preparation between io_uring thread and connection worker threads
+   MUTEX_T connection_lock; //protects slots and ownership of in-flight send blocks
+   THREAD_T thread;
+   bool is_running;
+   bool is_thread_valid;
+   bool is_ring_valid;
+} apx_uringServer_t;
+#endif
+
+//////////////////////////////////////////////////////////////////////////////
+// PUBLIC FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////////////
+void apx_uringServerCfg_set_defaults(apx_uringServerCfg_t* cfg);
+#if APX_URING_SERVER_SUPPORTED
+void apx_uringServer_create(apx_uringServer_t* self, struct apx_server_tag* apx_server, apx_uringServerCfg_t const* cfg);
+void apx_uringServer_destroy(apx_uringServer_t* self);
+apx_uringServer_t* apx_uringServer_new(struct apx_server_tag* apx_server, apx_uringServerCfg_t const* cfg);
+void apx_uringServer_delete(apx_uringServer_t* self);
+
+apx_error_t apx_uringServer_start(apx_uringServer_t* self);
+apx_error_t apx_uringServer_start_tcp_server(apx_uringServer_t* self, uint16_t tcp_port);
+apx_error_t apx_uringServer_start_unix_server(apx_uringServer_t* self, char const* file_path);
+void apx_uringServer_stop(apx_uringServer_t* self);
+
+//Used by apx_uringServerConnection_t
+apx_error_t apx_uringServer_arm_receive(apx_uringServer_t* self, apx_uringServerConnection_t* connection);
+apx_error_t apx_uringServer_submit_sends(apx_uringServer_t* self, int fd, apx_uringSendBlock_t* first, uint32_t num_blocks);
+void apx_uringServer_remove_connection(apx_uringServer_t* self, apx_uringServerConnection_t* connection);
+bool apx_uringServer_is_event_thread(apx_uringServer_t* self);
+#endif
+
+#endif //APX_URING_SERVER_H
@@ -0,0 +1,120 @@
+/*****************************************************************************
+* \file      uring_server_connection.h
+* \author    Conny Gustafsson
+* \date      2026-10-18
+* \brief     Server connection using the io_uring socket server
+*
+* Copyright (c) 2026 Conny Gustafsson
+* Permission is hereby granted, free of charge, to any person obtaining a copy of
+* this software and associated documentation files (the "Software"), to deal in
+* the Software without restriction, including without limitation the rights to
+* use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+* the Software, and to permit persons to whom the Software is furnished to do so,
+* subject to the following conditions:
+
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+* FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+* COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+* IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+* CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+******************************************************************************/
+#ifndef APX_URING_SERVER_CONNECTION_H
+#define APX_URING_SERVER_CONNECTION_H
+
+//////////////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////////////
+#include "adt_bytearray.h"
+#include "apx/server_connection.h"
+#include "apx/extension/uring.h"
+#include "osmacro.h"
+
+//////////////////////////////////////////////////////////////////////////////
+// PUBLIC CONSTANTS AND DATA TYPES
+//////////////////////////////////////////////////////////////////////////////
+#if APX_URING_SUPPORTED && !defined(UNIT_TEST)
+#define APX_URING_SERVER_SUPPORTED 1
+#else
+#define APX_URING_SERVER_SUPPORTED 0
+#endif
+
+#if APX_URING_SERVER_SUPPORTED
+//Forward declarations
+struct apx_uringServer_tag;
+struct apx_uringServerConnection_tag;
+
+//Memory given to the kernel in a send request. Must stay valid until the send has completed.
+typedef struct apx_uringSendBlock_tag
+{
+   struct apx_uringSendBlock_tag* next;
+   struct apx_uringServerConnection_tag* owner; //NULL once the connection was destroyed while the send was in flight
+   uint8_t* data;
+   apx_size_t size;
+   apx_size_t capacity;
+} apx_uringSendBlock_t;
+
+typedef struct apx_uringServerConnection_tag
+{
+   apx_serverConnection_t base;
+   apx_nodeManager_t node_manager;
+   struct apx_uringServer_tag* server; //NULL after server has stopped
+   adt_bytearray_t receive_buffer; //incomplete message continuing in next receive buffer
+   apx_uringSendBlock_t* current_block; //filled by worker thread between transmit_begin and transmit_end
+   apx_uringSendBlock_t* queued_first; //complete blocks waiting for previous send chain to finish
+   apx_uringSendBlock_t* queued_last;
+   apx_uringSendBlock_t* in_flight_first; //blocks owned by the kernel, completed in list order
+   apx_uringSendBlock_t* in_flight_last;
+   apx_uringSendBlock_t* free_blocks;
+   apx_size_t block_size;
+   apx_size_t buffered_bytes; //bytes in queued and in-flight blocks
+   apx_size_t max_buffered_bytes;
+   uint64_t total_bytes_written;
+   uint32_t num_free_blocks;
+   uint32_t slot; //index in server connection table
+   uint32_t generation; //tells completions for an earlier connection in the same slot apart
+   int fd;
+   bool is_disconnected; //disconnect has been reported to server
+   bool is_send_failed;
+   bool is_writer_waiting;
+   SEMAPHORE_T send_semaphore; //posted when a waiting writer can continue
+   MUTEX_T lock; //held by worker thread from transmit_begin to transmit_end
+   MUTEX_T send_lock; //protects send block lists, taken by both worker thread and io_uring thread
+} apx_uringServerConnection_t;
+
+//////////////////////////////////////////////////////////////////////////////
+// PUBLIC FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////////////
+apx_error_t apx_uringServerConnection_create(apx_uringServerConnection_t* self, struct apx_uringServer_tag* server, int fd, apx_size_t block_size);
+void apx_uringServerConnection_destroy(apx_uringServerConnection_t* self);
+void apx_uringServerConnection_vdestroy(void* arg);
+apx_uringServerConnection_t* apx_uringServerConnection_new(struct apx_uringServer_tag* server, int fd, apx_size_t block_size);
+void apx_uringServerConnection_delete(apx_uringServerConnection_t* self);
+void apx_uringServerConnection_vdelete(void* arg);
+void apx_uringServerConnection_vstart(void* arg);
+void apx_uringServerConnection_vclose(void* arg);
+
+//Called by server from io_uring thread
+bool apx_uringServerConnection_on_data_received(apx_uringServerConnection_t* self, uint8_t const* data, apx_size_t data_size);
+void apx_uringServerConnection_on_disconnected(apx_uringServerConnection_t* self);
+void apx_uringServerConnection_on_send_complete(apx_uringServerConnection_t* self, apx_uringSendBlock_t* block, int32_t result);
+void apx_uringServerConnection_release_in_flight(apx_uringServerConnection_t* self);
+void apx_uringServerConnection_on_server_stopped(apx_uringServerConnection_t* self);
+
+// ConnectionInterface API
+int32_t apx_uringServerConnection_vtransmit_max_bytes_avaiable(void* arg);
+int32_t apx_uringServerConnection_vtransmit_current_bytes_avaiable(void* arg);
+void apx_uringServerConnection_vtransmit_begin(void* arg);
+void apx_uringServerConnection_vtransmit_end(void* arg);
+apx_error_t apx_uringServerConnection_vtransmit_data_message(void* arg, uint32_t write_address, bool more_bit, uint8_t const* msg_data, int32_t msg_size, int32_t* bytes_available);
+apx_error_t apx_uringServerConnection_vtransmit_direct_message(void* arg, uint8_t const* msg_data, int32_t msg_size, int32_t* bytes_available);
+
+// Statistics
+uint64_t apx_uringServerConnection_get_total_bytes_written(apx_uringServerConnection_t* self);
+#endif
+
+#endif //APX_URING_SERVER_CONNECTION_H
@@ -0,0 +1,49 @@
+/*****************************************************************************
+* \file      uring_server_extension.h
+* \author    Conny Gustafsson
+* \date      2026-10-18
+* \brief     APX io_uring socket server extension (TCP+UNIX)
+*
+* Copyright (c) 2026 Conny Gustafsson
+* Permission is hereby granted, free of charge, to any person obtaining a copy of
+* this software and associated documentation files (the "Software"), to deal in
+* the Software without restriction, including without limitation the rights to
+* use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+* the Software, and to permit persons to whom the Software is furnished to do so,
+* subject to the following conditions:
+
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+* FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+* COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+* IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+* CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+******************************************************************************/
+#ifndef APX_URING_SERVER_EXTENSION_H
+#define APX_URING_SERVER_EXTENSION_H
+
+//////////////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////////////
+#include "apx/server_extension.h"
+
+//////////////////////////////////////////////////////////////////////////////
+// PUBLIC CONSTANTS AND DATA TYPES
+//////////////////////////////////////////////////////////////////////////////
+#define APX_URING_SERVER_EXT_CFG_KEY "uring-server"
+
+//////////////////////////////////////////////////////////////////////////////
+// PUBLIC FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////////////
+/**
+ * Registers the io_uring socket server when it is enabled in config.
+ * Returns APX_NOT_IMPLEMENTED_ERROR when the extension is disabled or when the platform or running kernel
+ * lacks the io_uring features it needs. The caller is then expected to register the socket server extension instead.
+ */
+apx_error_t apx_uringServerExtension_register(struct apx_server_tag *apx_server, dtl_dv_t *config);
+
+#endif //APX_URING_SERVER_EXTENSION_H
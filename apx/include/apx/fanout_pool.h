@@ -0,0 +1,113 @@
+/*****************************************************************************
+* \file      fanout_pool.h
+* \author    Conny Gustafsson
+* \date      2026-10-18
+* \brief     Parallel fan-out worker pool
+*
+* Copyright (c) 2026 Conny Gustafsson
+* Permission is hereby granted, free of charge, to any person obtaining a copy of
+* this software and associated documentation files (the "Software"), to deal in
+* the Software without restriction, including without limitation the rights to
+* use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+* the Software, and to permit persons to whom the Software is furnished to do so,
+* subject to the following conditions:
+
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+* FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+* COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+* IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+* CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+******************************************************************************/
+#ifndef APX_FANOUT_POOL_H
+#define APX_FANOUT_POOL_H
+
+//////////////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////////////
+#include <stdint.h>
+#include <stdbool.h>
+#include "apx/error.h"
+#ifdef _WIN32
+# ifndef WIN32_LEAN_AND_MEAN
+# define WIN32_LEAN_AND_MEAN
+# endif
+# include <Windows.h>
+#else
+# include <pthread.h>
+# include <semaphore.h>
+#endif
+#include "osmacro.h"
+
+//////////////////////////////////////////////////////////////////////////////
+// PUBLIC CONSTANTS AND DATA TYPES
+//////////////////////////////////////////////////////////////////////////////
+#define APX_FANOUT_POOL_MAX_WORKERS 32u
+#define APX_FANOUT_POOL_DEFAULT_THRESHOLD 64
+
+struct apx_fanoutPool_tag;
+
+//Processes items in the range [begin, end)
+typedef apx_error_t (apx_fanoutFunc_t)(void* arg, int32_t begin, int32_t end);
+
+typedef struct apx_fanoutWorker_tag
+{
+   struct apx_fanoutPool_tag* parent;
+   THREAD_T thread;
+   SEMAPHORE_T start_semaphore;
+   int32_t begin;
+   int32_t end;
+   bool is_thread_valid;
+#ifdef _WIN32
+   unsigned int thread_id;
+#endif
+} apx_fanoutWorker_t;
+
+typedef struct apx_fanoutPoolStats_tag
+{
+   uint32_t num_parallel_runs;     //number of runs split across the workers
+   uint32_t num_sequential_runs;   //number of runs below the threshold or made while the pool was busy
+} apx_fanoutPoolStats_t;
+
+/*
+* Splits a large item range into slices that are processed in parallel by the calling thread and the workers.
+* A run returns once every slice is done (completion barrier), so two runs made by the same thread never overlap.
+* Only one run uses the workers at a time, a run made while the pool is busy is processed by its calling thread.
+*/
+typedef struct apx_fanoutPool_tag
+{
+   apx_fanoutWorker_t* workers; //Length: num_workers
+   uint32_t num_workers;
+   int32_t threshold;           //runs with fewer items than this are processed by the calling thread
+   apx_fanoutFunc_t* func;      //function of the active run
+   void* arg;                   //argument of the active run
+   SPINLOCK_T lock;             //protects is_busy, num_pending, exit_flag and stats
+   SEMAPHORE_T done_semaphore;
+   uint32_t num_pending;        //slices not yet finished by the workers
+   apx_error_t result;          //first error reported by a slice of the active run
+   apx_fanoutPoolStats_t stats;
+   bool is_busy;
+   bool exit_flag;
+} apx_fanoutPool_t;
+
+//////////////////////////////////////////////////////////////////////////////
+// PUBLIC FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////////////
+apx_error_t apx_fanoutPool_create(apx_fanoutPool_t* self, uint32_t num_workers, int32_t threshold);
+void apx_fanoutPool_destroy(apx_fanoutPool_t* self);
+apx_fanoutPool_t* apx_fanoutPool_new(uint32_t num_workers, int32_t threshold);
+void apx_fanoutPool_delete(apx_fanoutPool_t* self);
+int32_t apx_fanoutPool_get_threshold(apx_fanoutPool_t const* self);
+uint32_t apx_fanoutPool_num_workers(apx_fanoutPool_t const* self);
+apx_error_t apx_fanoutPool_run(apx_fanoutPool_t* self, int32_t num_items, apx_fanoutFunc_t* func, void* arg);
+void apx_fanoutPool_get_stats(apx_fanoutPool_t* self, apx_fanoutPoolStats_t* stats);
+#ifndef UNIT_TEST
+apx_error_t apx_fanoutPool_start(apx_fanoutPool_t* self);
+void apx_fanoutPool_stop(apx_fanoutPool_t* self);
+#endif
+
+#endif //APX_FANOUT_POOL_H
@@ -33,6 +33,7 @@
 #include "apx/error.h"
 #include "apx/file_info.h"
 #include "apx/event_listener.h"
+#include "apx/stream_buffer.h"
 #include "adt_list.h"
 
 #ifndef APX_EMBEDDED
@@ -56,6 +57,7 @@ struct apx_file_tag;
 struct apx_fileManager_tag;
 
 typedef apx_error_t (apx_file_open_close_notify_func)(void *arg, struct apx_file_tag *file);
+//For stream files, offset is the sequence number of the record and src is the record data following the sequence number
 typedef apx_error_t (apx_file_write_notify_func)(void *arg, struct apx_file_tag *file, uint32_t offset, const uint8_t *src, uint32_t len);
 typedef apx_error_t (apx_file_read_const_data_func)(void *arg, struct apx_file_tag *file, uint32_t offset, uint8_t *dest, uint32_t len);
 
@@ -65,6 +67,7 @@ typedef struct apx_fileNotificationHandler_tag
    apx_file_open_close_notify_func *open_notify; //Notifies file owner that the file was openened on remote end (used for local files)
    apx_file_open_close_notify_func* close_notify; //Notifies file owner that the file was closed on remote end (used for local files)
    apx_file_write_notify_func *write_notify; //Notifies file owner that the file has just been written to (used for remote files)
+   apx_file_write_notify_func *local_write_notify; //Lets file owner apply new data to a local file just before it is sent (used for local files)
 } apx_fileNotificationHandler_t;
 
 typedef struct apx_file_tag
@@ -78,6 +81,13 @@ typedef struct apx_file_tag
    struct apx_fileManager_tag *file_manager;
    adt_list_t event_listeners; //strong references to apx_fileEventListener2_t
    MUTEX_T lock;
+   //Stream files (RMF_FILE_TYPE_STREAM)
+   uint32_t stream_retention; //local files: number of records kept for a reader that opens the file later
+   apx_streamBuffer_t* stream_buffer; //local files: created on first write, only accessed by the file manager worker
+   uint32_t next_stream_sequence; //remote files: sequence number expected in the next record
+   uint32_t num_lost_stream_records; //remote files: records skipped by the writer due to retention limit
+   //Remote files written by a pipelining peer before this side opened them
+   uint8_t* early_data; //File sized buffer followed by a bitmap of written bytes, created on first early write
 } apx_file_t;
 
 //////////////////////////////////////////////////////////////////////////////
@@ -114,9 +124,22 @@ bool apx_file_address_in_range(const apx_file_t* self, uint32_t address);
 rmf_fileInfo_t const* apx_file_get_file_info(const apx_file_t* self);
 rmf_fileInfo_t* apx_file_clone_file_info(const apx_file_t* self);
 rmf_digestType_t apx_file_get_digest_type(apx_file_t const* self);
+rmf_fileType_t apx_file_get_rmf_file_type(apx_file_t const* self);
+void apx_file_set_rmf_file_type(apx_file_t* self, rmf_fileType_t file_type);
+bool apx_file_is_dynamic(apx_file_t const* self);
+bool apx_file_is_stream(apx_file_t const* self);
+void apx_file_set_stream_retention(apx_file_t* self, uint32_t retention);
+uint32_t apx_file_get_stream_retention(apx_file_t const* self);
+apx_streamBuffer_t* apx_file_get_stream_buffer(apx_file_t* self);
+uint32_t apx_file_get_num_lost_stream_records(apx_file_t* self);
+apx_error_t apx_file_buffer_early_write(apx_file_t* self, uint32_t offset, const uint8_t* src, uint32_t len);
+bool apx_file_has_early_data(apx_file_t* self);
+uint8_t* apx_file_take_early_data(apx_file_t* self);
+uint32_t apx_file_next_early_data_range(apx_file_t const* self, uint8_t const* early_data, uint32_t* offset);
 uint8_t const* apx_file_get_digest_data(const apx_file_t* self);
 apx_error_t apx_file_open_notify(apx_file_t* self);
 apx_error_t apx_file_write_notify(apx_file_t* self, uint32_t offset, const uint8_t* src, uint32_t len);
+apx_error_t apx_file_local_write_notify(apx_file_t* self, uint32_t offset, const uint8_t* src, uint32_t len);
 
 //global functions
 char const* apx_file_type_to_extension(apx_fileType_t file_type);
@@ -72,6 +72,7 @@ uint8_t const* rmf_fileInfo_digest_data(rmf_fileInfo_t const* self);
 apx_error_t rmf_fileInfo_assign(rmf_fileInfo_t *self, const rmf_fileInfo_t *other);
 rmf_fileInfo_t* rmf_fileInfo_clone(const rmf_fileInfo_t *other);
 void rmf_fileInfo_set_address(rmf_fileInfo_t *self, uint32_t address);
+void rmf_fileInfo_set_rmf_file_type(rmf_fileInfo_t* self, rmf_fileType_t file_type);
 bool rmf_fileInfo_is_remote_address(rmf_fileInfo_t const* self);
 bool rmf_fileInfo_name_ends_with(rmf_fileInfo_t const* self, const char* suffix);
 char *rmf_fileInfo_base_name(rmf_fileInfo_t const* self);
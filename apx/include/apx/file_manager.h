@@ -73,10 +73,22 @@ apx_file_t* apx_fileManager_find_remote_file_by_name(apx_fileManager_t* self, ch
 apx_error_t apx_fileManager_message_received(apx_fileManager_t* self, uint8_t const* msg_data, apx_size_t msg_len);
 apx_error_t apx_fileManager_send_local_const_data(apx_fileManager_t* self, uint32_t address, uint8_t const* data, apx_size_t size);
 apx_error_t apx_fileManager_send_local_data(apx_fileManager_t* self, uint32_t address, uint8_t* data, apx_size_t size); //file_manager takes ownership of data when called
+apx_error_t apx_fileManager_apply_local_data(apx_fileManager_t* self, uint32_t address, uint8_t* data, apx_size_t size); //file_manager takes ownership of data when called
+apx_error_t apx_fileManager_send_priority_data(apx_fileManager_t* self, uint32_t address, uint8_t* data, apx_size_t size); //file_manager takes ownership of data when called
+apx_error_t apx_fileManager_apply_priority_data(apx_fileManager_t* self, uint32_t address, uint8_t* data, apx_size_t size); //file_manager takes ownership of data when called
+apx_error_t apx_fileManager_send_local_snapshot(apx_fileManager_t* self, uint32_t address, uint8_t* data, apx_size_t size); //file_manager takes ownership of data when called
+apx_error_t apx_fileManager_drain_queued_data(apx_fileManager_t* self, uint32_t address, apx_queuedPortRing_t* ring);
+apx_error_t apx_fileManager_write_stream(apx_fileManager_t* self, uint32_t address, uint8_t const* data, apx_size_t size);
 apx_error_t apx_fileManager_send_open_file_request(apx_fileManager_t* self, uint32_t address);
 apx_error_t apx_fileManager_send_error_code(apx_fileManager_t* self, apx_error_t error_code);
 uint16_t apx_fileManager_get_num_pending_worker_commands(apx_fileManager_t* self);
+void apx_fileManager_get_transmit_latency(apx_fileManager_t* self, apx_transmitLane_t lane, apx_latencyHistogram_t* histogram);
 void apx_fileManager_set_connection_id(apx_fileManager_t* self, uint32_t connection_id);
+void apx_fileManager_set_compression_threshold(apx_fileManager_t* self, uint32_t threshold);
+uint32_t apx_fileManager_get_compression_threshold(apx_fileManager_t* self);
+void apx_fileManager_get_compression_stats(apx_fileManager_t* self, apx_compressionStats_t* stats);
+void apx_fileManager_set_capabilities(apx_fileManager_t* self, apx_capabilities_t const* local, apx_capabilities_t const* peer);
+void apx_fileManager_get_capabilities(apx_fileManager_t* self, apx_capabilities_t* capabilities);
 #ifdef UNIT_TEST
 bool apx_fileManager_run(apx_fileManager_t* self);
 #endif
@@ -43,6 +43,8 @@ typedef struct apx_fileManagerReceiver_tag
    apx_size_t buf_size;
    apx_size_t buf_pos;
    uint32_t start_address;
+   uint64_t total_bytes_direct; //Bytes delivered straight from the caller's buffer
+   uint64_t total_bytes_copied; //Bytes copied into buf_data for reassembly
 } apx_fileManagerReceiver_t;
 
 typedef struct apx_fileManagerReceptionResult_tag
@@ -63,5 +65,7 @@ void apx_fileManagerReceiver_reset(apx_fileManagerReceiver_t *self);
 apx_error_t apx_fileManagerReceiver_reserve(apx_fileManagerReceiver_t *self, apx_size_t size);
 apx_size_t apx_fileManagerReceiver_buffer_size(apx_fileManagerReceiver_t const* self);
 apx_error_t apx_fileManagerReceiver_write(apx_fileManagerReceiver_t *self, apx_fileManagerReceptionResult_t *result, uint32_t address, uint8_t const* data, apx_size_t size, bool more_bit);
+uint64_t apx_fileManagerReceiver_get_total_bytes_direct(apx_fileManagerReceiver_t const* self);
+uint64_t apx_fileManagerReceiver_get_total_bytes_copied(apx_fileManagerReceiver_t const* self);
 
 #endif //APX_FILEMANAGER_RECEIVER_H
@@ -32,6 +32,8 @@
 #include "apx/file_map.h"
 #include "apx/allocator.h"
 #include "apx/connection_interface.h"
+#include "apx/compression.h"
+#include "apx/capabilities.h"
 #ifdef _WIN32
 # ifndef WIN32_LEAN_AND_MEAN
 # define WIN32_LEAN_AND_MEAN
@@ -54,6 +56,10 @@ typedef struct apx_fileManagerShared_tag
    bool is_connected;
    apx_connectionInterface_t parent_connection;
    apx_allocator_t* allocator;
+   uint32_t compression_threshold; //0 unless compression was negotiated in the greeting
+   apx_compressionStats_t compression_stats;
+   apx_capabilities_t local_capabilities; //what this side announced in the greeting
+   apx_capabilities_t capabilities; //agreed with peer
    MUTEX_T lock;
 } apx_fileManagerShared_t;
 
@@ -79,6 +85,13 @@ void apx_fileManagerShared_disconnected(apx_fileManagerShared_t *self);
 bool apx_fileManagerShared_is_connected(apx_fileManagerShared_t *self);
 apx_connectionInterface_t const* apx_fileManagerShared_connection(apx_fileManagerShared_t const* self);
 apx_allocator_t* apx_fileManagerShared_allocator(apx_fileManagerShared_t const* self);
+void apx_fileManagerShared_set_compression_threshold(apx_fileManagerShared_t* self, uint32_t threshold);
+uint32_t apx_fileManagerShared_get_compression_threshold(apx_fileManagerShared_t* self);
+void apx_fileManagerShared_add_compression_stats(apx_fileManagerShared_t* self, apx_compressionStats_t const* stats);
+void apx_fileManagerShared_get_compression_stats(apx_fileManagerShared_t* self, apx_compressionStats_t* stats);
+void apx_fileManagerShared_set_capabilities(apx_fileManagerShared_t* self, apx_capabilities_t const* local, apx_capabilities_t const* peer);
+void apx_fileManagerShared_get_capabilities(apx_fileManagerShared_t* self, apx_capabilities_t* capabilities);
+void apx_fileManagerShared_get_local_capabilities(apx_fileManagerShared_t* self, apx_capabilities_t* capabilities);
 
 
 #endif //APX_FILE_MANAGER_SHARED_H
@@ -36,6 +36,8 @@
 #include "apx/event.h"
 #include "apx/command.h"
 #include "apx/file_info.h"
+#include "apx/latency_histogram.h"
+#include "apx/queued_port_ring.h"
 #ifndef ADT_RBFS_ENABLE
 #define ADT_RBFS_ENABLE 1
 #endif
@@ -49,6 +51,21 @@
 //////////////////////////////////////////////////////////////////////////////
 //forward declaration
 
+typedef uint8_t apx_transmitLane_t;
+#define APX_TRANSMIT_LANE_NORMAL ((apx_transmitLane_t) 0u)
+#define APX_TRANSMIT_LANE_HIGH   ((apx_transmitLane_t) 1u)
+#define APX_NUM_TRANSMIT_LANES   2u
+
+//Write that is larger than the transmit buffer. It is streamed as more-bit fragments directly from the source buffer.
+typedef struct apx_fragmentedWrite_tag
+{
+   uint8_t const* data; //NULL when no fragmented write is in progress
+   uint8_t* owned_data; //freed when write is complete (NULL for constant data)
+   uint32_t address;
+   uint32_t size;
+   uint32_t offset; //number of bytes sent so far
+} apx_fragmentedWrite_t;
+
 typedef struct apx_fileManagerWorker_tag
 {
    apx_fileManagerShared_t *shared; //weak reference
@@ -57,8 +74,14 @@ typedef struct apx_fileManagerWorker_tag
    THREAD_T worker_thread; //local transmit thread
    SEMAPHORE_T semaphore; //queue semaphore
    adt_rbfh_t queue; //pending actions
+   adt_rbfh_t priority_queue; //pending data of high priority ports. Always processed before queue and before the next fragment.
+   uint16_t num_queued_snapshots; //protected by queue_lock. While non-zero, high priority data is placed in queue so it can't overtake a file snapshot.
    bool worker_thread_valid; //is worker_thread handle valid (required to support both Windows and Linux)
    apx_mode_t mode; //server or client mode?
+   apx_fragmentedWrite_t fragmented_write; //only accessed from worker thread
+   uint8_t* compression_buffer; //only accessed from worker thread, grows to largest compressed message
+   uint32_t compression_buffer_size;
+   apx_latencyHistogram_t lane_latency[APX_NUM_TRANSMIT_LANES]; //time from queued to processed, protected by mutex
 #ifdef _WIN32
    unsigned int worker_thread_id;
 #endif
@@ -74,6 +97,7 @@ typedef struct apx_fileManagerWorker_tag
 apx_error_t apx_fileManagerWorker_create(apx_fileManagerWorker_t *self, apx_fileManagerShared_t *shared, apx_mode_t mode);
 void apx_fileManagerWorker_destroy(apx_fileManagerWorker_t *self);
 uint16_t apx_fileManagerWorker_num_pending_commands(apx_fileManagerWorker_t* self);
+void apx_fileManagerWorker_get_latency(apx_fileManagerWorker_t* self, apx_transmitLane_t lane, apx_latencyHistogram_t* histogram);
 #ifdef UNIT_TEST
 bool apx_fileManagerWorker_run(apx_fileManagerWorker_t* self);
 #else
@@ -86,6 +110,13 @@ apx_error_t apx_fileManagerWorker_preare_acknowledge(apx_fileManagerWorker_t* se
 apx_error_t apx_fileManagerWorker_prepare_publish_local_file(apx_fileManagerWorker_t* self, rmf_fileInfo_t* file_info); //ownership is taken of the file_info object
 apx_error_t apx_fileManagerWorker_prepare_send_local_const_data(apx_fileManagerWorker_t* self, uint32_t address, uint8_t const* data, uint32_t size);
 apx_error_t apx_fileManagerWorker_prepare_send_local_data(apx_fileManagerWorker_t* self, uint32_t address, uint8_t* data, uint32_t size);
+apx_error_t apx_fileManagerWorker_prepare_apply_local_data(apx_fileManagerWorker_t* self, uint32_t address, uint8_t* data, uint32_t size);
+apx_error_t apx_fileManagerWorker_prepare_send_priority_data(apx_fileManagerWorker_t* self, uint32_t address, uint8_t* data, uint32_t size);
+apx_error_t apx_fileManagerWorker_prepare_apply_priority_data(apx_fileManagerWorker_t* self, uint32_t address, uint8_t* data, uint32_t size);
+apx_error_t apx_fileManagerWorker_prepare_send_local_snapshot(apx_fileManagerWorker_t* self, uint32_t address, uint8_t* data, uint32_t size);
+apx_error_t apx_fileManagerWorker_prepare_drain_queued_data(apx_fileManagerWorker_t* self, uint32_t address, apx_queuedPortRing_t* ring);
+apx_error_t apx_fileManagerWorker_prepare_send_stream_record(apx_fileManagerWorker_t* self, uint32_t address, uint8_t* record, uint32_t size);
+apx_error_t apx_fileManagerWorker_prepare_open_stream(apx_fileManagerWorker_t* self, uint32_t address);
 apx_error_t apx_fileManagerWorker_prepare_send_open_file_request(apx_fileManagerWorker_t* self, uint32_t address);
 
 #endif //APX_FILE_MANAGER_WORKER_H
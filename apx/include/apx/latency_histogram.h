@@ -0,0 +1,60 @@
+/*****************************************************************************
+* \file      latency_histogram.h
+* \author    Conny Gustafsson
+* \date      2026-10-18
+* \brief     Log2 latency histogram
+*
+* Copyright (c) 2026 Conny Gustafsson
+* Permission is hereby granted, free of charge, to any person obtaining a copy of
+* this software and associated documentation files (the "Software"), to deal in
+* the Software without restriction, including without limitation the rights to
+* use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+* the Software, and to permit persons to whom the Software is furnished to do so,
+* subject to the following conditions:
+
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+* FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+* COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+* IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+* CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+******************************************************************************/
+#ifndef APX_LATENCY_HISTOGRAM_H
+#define APX_LATENCY_HISTOGRAM_H
+
+//////////////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////////////
+#include <stdint.h>
+
+//////////////////////////////////////////////////////////////////////////////
+// PUBLIC CONSTANTS AND DATA TYPES
+//////////////////////////////////////////////////////////////////////////////
+#define APX_LATENCY_HISTOGRAM_NUM_BUCKETS 33u
+
+/*
+* Log2 histogram of latencies in microseconds. Bucket 0 counts zero latencies, bucket N (N>0) counts latencies
+* in the range [2^(N-1), 2^N). Percentiles are therefore accurate within a factor of two, which is enough to
+* compare lanes and spot outliers while keeping the cost of adding a sample constant.
+*/
+typedef struct apx_latencyHistogram_tag
+{
+   uint32_t buckets[APX_LATENCY_HISTOGRAM_NUM_BUCKETS];
+   uint32_t num_samples;
+   uint32_t max_us;
+} apx_latencyHistogram_t;
+
+//////////////////////////////////////////////////////////////////////////////
+// PUBLIC FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////////////
+void apx_latencyHistogram_create(apx_latencyHistogram_t* self);
+void apx_latencyHistogram_add(apx_latencyHistogram_t* self, uint32_t latency_us);
+uint32_t apx_latencyHistogram_num_samples(apx_latencyHistogram_t const* self);
+uint32_t apx_latencyHistogram_max(apx_latencyHistogram_t const* self);
+uint32_t apx_latencyHistogram_percentile(apx_latencyHistogram_t const* self, uint32_t percent);
+
+#endif //APX_LATENCY_HISTOGRAM_H
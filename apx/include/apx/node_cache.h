@@ -29,14 +29,45 @@
 //////////////////////////////////////////////////////////////////////////////
 // INCLUDES
 //////////////////////////////////////////////////////////////////////////////
+#include <stdint.h>
+#include <stdbool.h>
+#ifdef _WIN32
+# ifndef WIN32_LEAN_AND_MEAN
+# define WIN32_LEAN_AND_MEAN
+# endif
+#include <Windows.h>
+#else
+#include <pthread.h>
+#endif
 #include "apx/types.h"
+#include "apx/error.h"
+#include "apx/remotefile.h"
+#include "adt_ary.h"
+#include "osmacro.h"
 
 //////////////////////////////////////////////////////////////////////////////
 // PUBLIC CONSTANTS AND DATA TYPES
 //////////////////////////////////////////////////////////////////////////////
+#define APX_NODE_CACHE_DEFAULT_MAX_SIZE (4u * 1024u * 1024u) //Total number of definition bytes kept in the cache
+
+typedef struct apx_nodeCacheEntry_tag
+{
+   uint8_t digest[RMF_SHA256_SIZE];
+   uint8_t* definition_data;
+   apx_size_t definition_size;
+} apx_nodeCacheEntry_t;
+
+/*
+* Level 1 cache of node definitions, keyed by SHA-256 digest of the definition text.
+* Shared by all connections of a server. Least recently used definitions are evicted first.
+*/
 typedef struct apx_nodeCache_tag
 {
+   adt_ary_t entries; //strong references to apx_nodeCacheEntry_t, least recently used first
+   apx_size_t total_size;
+   apx_size_t max_size;
    apx_mode_t mode;
+   MUTEX_T lock;
 } apx_nodeCache_t;
 
 //////////////////////////////////////////////////////////////////////////////
@@ -46,5 +77,16 @@ void apx_nodeCache_create(apx_nodeCache_t* self, apx_mode_t mode);
 void apx_nodeCache_destroy(apx_nodeCache_t* self);
 apx_nodeCache_t* apx_nodeCache_new(apx_mode_t mode);
 void apx_nodeCache_delete(apx_nodeCache_t* self);
+void apx_nodeCache_set_max_size(apx_nodeCache_t* self, apx_size_t max_size);
+apx_size_t apx_nodeCache_length(apx_nodeCache_t* self);
+/*
+* Stores a copy of the definition data. The digest is calculated here, never taken from the peer.
+*/
+apx_error_t apx_nodeCache_insert(apx_nodeCache_t* self, uint8_t const* definition_data, apx_size_t definition_size);
+bool apx_nodeCache_contains(apx_nodeCache_t* self, uint8_t const* digest, apx_size_t definition_size);
+/*
+* Returns a copy of the cached definition (caller frees it) or NULL when digest and size have no match.
+*/
+uint8_t* apx_nodeCache_take_definition_copy(apx_nodeCache_t* self, uint8_t const* digest, apx_size_t definition_size);
 
 #endif //APX_FILE_CACHE_H
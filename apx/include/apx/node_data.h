@@ -107,6 +107,7 @@ apx_error_t apx_nodeData_create_require_port_data(apx_nodeData_t* self, apx_size
 apx_error_t apx_nodeData_write_definition_data(apx_nodeData_t* self, apx_size_t offset, uint8_t const* src, apx_size_t size);
 apx_error_t apx_nodeData_write_provide_port_data(apx_nodeData_t* self, apx_size_t offset, uint8_t const* src, apx_size_t size);
 apx_error_t apx_nodeData_read_provide_port_data(apx_nodeData_t* self, apx_size_t offset, uint8_t* dest, apx_size_t size);
+apx_error_t apx_nodeData_update_provide_port_data(apx_nodeData_t* self, apx_size_t offset, uint8_t const* src, apx_size_t size, bool* is_changed);
 apx_error_t apx_nodeData_write_require_port_data(apx_nodeData_t* self, apx_size_t offset, uint8_t const* src, apx_size_t size);
 apx_error_t apx_nodeData_read_require_port_data(apx_nodeData_t* self, apx_size_t offset, uint8_t* dest, apx_size_t size);
 uint8_t const* apx_nodeData_get_definition_data(apx_nodeData_t const* self);
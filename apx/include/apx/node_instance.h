@@ -61,6 +61,13 @@ struct apx_nodeManager_tag;
 struct apx_fileManager_tag;
 struct apx_server_tag;
 
+typedef struct apx_nodeInstanceRoutingStats_tag
+{
+   uint64_t num_routed_bytes;        //provide port bytes routed to connectors
+   uint64_t num_suppressed_bytes;    //provide port bytes not routed since the value did not change (change-only routing)
+   uint32_t num_suppressed_values;   //number of provide port values not routed since the value did not change
+} apx_nodeInstanceRoutingStats_t;
+
 typedef struct apx_nodeInstance_tag
 {
    char* name;
@@ -90,6 +97,8 @@ typedef struct apx_nodeInstance_tag
    apx_file_t* definition_file; //Weak reference
    apx_file_t* provide_port_data_file; //Weak reference
    apx_file_t* require_port_data_file; //Weak reference
+   bool change_only_routing; //Only used in APX_SERVER_MODE. Provide port values identical to the stored value are not routed.
+   apx_nodeInstanceRoutingStats_t routing_stats; //Only used in APX_SERVER_MODE. Protected by lock.
    MUTEX_T lock;
 } apx_nodeInstance_t;
 
@@ -131,6 +140,7 @@ apx_nodeData_t* apx_nodeInstance_get_node_data(apx_nodeInstance_t const* self);
 bool apx_nodeInstance_has_node_data(apx_nodeInstance_t const* self);
 apx_size_t apx_nodeInstance_get_definition_size(apx_nodeInstance_t const* self);
 uint8_t const* apx_nodeInstance_get_definition_data(apx_nodeInstance_t const* self);
+char const* apx_nodeInstance_get_definition_file_extension(apx_nodeInstance_t const* self);
 apx_error_t apx_nodeInstance_create_data_element_list(apx_nodeInstance_t* self, adt_ary_t* data_element_list);
 apx_error_t apx_nodeInstance_create_computation_lists(apx_nodeInstance_t* self, adt_ary_t* computation_lists);
 apx_error_t apx_nodeInstance_create_byte_port_map(apx_nodeInstance_t* self);
@@ -150,12 +160,13 @@ apx_error_t apx_nodeInstance_attach_to_file_manager(apx_nodeInstance_t* self, st
 apx_error_t apx_nodeInstance_remote_file_published_notification(apx_nodeInstance_t* self, apx_file_t* file);
 void apx_nodeInstance_set_server(apx_nodeInstance_t* self, struct apx_server_tag* server);
 apx_portInstance_t* apx_nodeInstance_find_port_by_name(apx_nodeInstance_t const* self, char const* name);
-apx_error_t apx_nodeInstance_write_provide_port_data(apx_nodeInstance_t* self, apx_size_t offset, uint8_t* data, apx_size_t size);
+apx_error_t apx_nodeInstance_write_provide_port_data(apx_nodeInstance_t* self, apx_size_t offset, uint8_t const* data, apx_size_t size);
 
 // FileNotificationHandler API
 apx_error_t apx_nodeInstance_vfile_open_notify(void* arg, apx_file_t* file);
 apx_error_t apx_nodeInstance_vfile_close_notify(void* arg, apx_file_t* file);
 apx_error_t apx_nodeInstance_vfile_write_notify(void* arg, apx_file_t* file, uint32_t offset, uint8_t const* data, apx_size_t size);
+apx_error_t apx_nodeInstance_vfile_local_write_notify(void* arg, apx_file_t* file, uint32_t offset, uint8_t const* data, apx_size_t size);
 
 // Port Connector Change API
 apx_portConnectorChangeTable_t* apx_nodeInstance_get_require_port_connector_changes(apx_nodeInstance_t* self, bool auto_create);
@@ -168,12 +179,19 @@ apx_error_t apx_nodeInstance_handle_require_ports_disconnected(apx_nodeInstance_
 apx_error_t apx_nodeInstance_handle_require_port_connected_to_provide_port(apx_portInstance_t* require_port, apx_portInstance_t* provide_port);
 apx_error_t apx_nodeInstance_handle_provide_port_connected_to_require_port(apx_portInstance_t* provide_port, apx_portInstance_t* require_port);
 apx_error_t apx_nodeInstance_handle_require_port_disconnected_from_provide_port(apx_portInstance_t* require_port, apx_portInstance_t* provide_port);
+apx_error_t apx_nodeInstance_route_provide_port_data(apx_portInstance_t* provide_port, uint8_t const* data, apx_size_t size);
+void apx_nodeInstance_set_change_only_routing(apx_nodeInstance_t* self, bool enabled);
+bool apx_nodeInstance_is_change_only_routing(apx_nodeInstance_t const* self);
+void apx_nodeInstance_get_routing_stats(apx_nodeInstance_t* self, apx_nodeInstanceRoutingStats_t* stats);
+uint32_t apx_nodeInstance_get_num_queue_overflows(apx_nodeInstance_t* self);
+apx_error_t apx_nodeInstance_deliver_require_port_data(apx_portInstance_t* require_port, uint8_t const* data, apx_size_t size);
 //apx_error_t apx_nodeInstance_send_require_port_data_to_file_manager(apx_nodeInstance_t* self);
 
 //apx_error_t apx_nodeInstance_route_provide_port_data_change_to_receivers(apx_nodeInstance_t* self, const uint8_t* src, uint32_t offset, apx_size_t len);
 
 // ConnectorTable API
 apx_error_t apx_nodeInstance_build_connector_table(apx_nodeInstance_t* self);
+apx_error_t apx_nodeInstance_create_require_port_queues(apx_nodeInstance_t* self);
 void apx_nodeInstance_lock_port_connector_table(apx_nodeInstance_t* self);
 void apx_nodeInstance_unlock_port_connector_table(apx_nodeInstance_t* self);
 apx_portConnectorList_t* apx_nodeInstance_get_connectors_on_provide_port(apx_nodeInstance_t* self, apx_portId_t port_id);
@@ -34,6 +34,7 @@
 #include "apx/compiler.h"
 #include "apx/error.h"
 #include "apx/file_info.h"
+#include "apx/node_cache.h"
 #include "adt_hash.h"
 
 
@@ -62,6 +63,9 @@ typedef struct apx_nodeManager_tag
    apx_nodeInstance_t *last_attached; //weak reference
    apx_mode_t mode;
    struct apx_connectionBase_tag* parent_connection; //Weak reference
+   apx_nodeCache_t* node_cache; //Weak reference. Server mode only, NULL when definitions are always downloaded
+   apx_nodeInstance_t* streaming_node_instance; //Weak reference. Node whose definition is being parsed while it arrives
+   apx_size_t streamed_size; //Number of definition bytes written to parser so far
    MUTEX_T lock; //locking mechanism
 } apx_nodeManager_t;
 
@@ -75,10 +79,13 @@ void apx_nodeManager_delete(apx_nodeManager_t *self);
 
 //client-side API (ALso used for unit tests)
 apx_error_t apx_nodeManager_build_node(apx_nodeManager_t* self, char const* definition_text);
+apx_error_t apx_nodeManager_build_node_from_binary(apx_nodeManager_t* self, uint8_t const* definition_data, apx_size_t definition_size);
 
 //server-side API
 apx_error_t apx_nodeManager_init_node_from_file_info(apx_nodeManager_t* self, rmf_fileInfo_t const* file_info, bool* file_open_request);
 apx_error_t apx_nodeManager_build_node_from_data(apx_nodeManager_t* self, apx_nodeInstance_t* node_instance);
+void apx_nodeManager_set_node_cache(apx_nodeManager_t* self, apx_nodeCache_t* node_cache);
+apx_nodeCache_t* apx_nodeManager_get_node_cache(apx_nodeManager_t const* self);
 
 //common API
 struct apx_nodeInstance_tag* apx_nodeManager_get_last_attached(apx_nodeManager_t const* self);
@@ -82,6 +82,13 @@ apx_error_t apx_parser_get_last_error(apx_parser_t *self);
 int32_t apx_parser_get_error_line(apx_parser_t *self);
 apx_error_t apx_parser_parse_cstr(apx_parser_t *self, const char *apx_text);
 apx_error_t apx_parser_parse_bstr(apx_parser_t* self, uint8_t const* begin, uint8_t const* end);
+/*
+* Incremental parsing. Text can be written in chunks of any size, lines split between writes are joined by the stream.
+* The node is finalized by apx_parser_end, after that it can be taken using apx_parser_take_last_node.
+*/
+void apx_parser_begin(apx_parser_t* self);
+apx_error_t apx_parser_write(apx_parser_t* self, uint8_t const* begin, uint8_t const* end);
+apx_error_t apx_parser_end(apx_parser_t* self);
 
 
 #endif //APX_PARSER_H
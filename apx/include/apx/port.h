@@ -74,6 +74,8 @@ apx_error_t apx_port_derive_proper_init_value(apx_port_t* self);
 bool apx_port_is_queued(apx_port_t* self);
 bool apx_port_is_parameter(apx_port_t* self);
 uint32_t apx_port_get_queue_length(apx_port_t* self);
+uint32_t apx_port_get_min_update_interval(apx_port_t* self);
+bool apx_port_is_high_priority(apx_port_t* self);
 apx_error_t apx_port_flatten_data_element(apx_port_t* self);
 const char* apx_port_get_name(apx_port_t const* self);
 apx_portType_t apx_port_get_port_type(apx_port_t const* self);
@@ -41,6 +41,8 @@ typedef struct apx_portAttributes_tag
 {
    bool is_parameter;
    uint32_t queue_length;
+   uint32_t min_update_interval; //Milliseconds, 0 means every value is delivered (require ports only)
+   bool is_high_priority; //Data is transmitted ahead of bulk data on the same connection
    dtl_dv_t *init_value;
 } apx_portAttributes_t;
 
@@ -57,6 +59,10 @@ bool apx_portAttributes_is_parameter(apx_portAttributes_t* self);
 bool apx_portAttributes_is_queued(apx_portAttributes_t* self);
 void apx_portAttributes_set_queue_length(apx_portAttributes_t* self, uint32_t queue_length);
 uint32_t apx_portAttributes_get_queue_length(apx_portAttributes_t* self);
+void apx_portAttributes_set_min_update_interval(apx_portAttributes_t* self, uint32_t interval_ms);
+uint32_t apx_portAttributes_get_min_update_interval(apx_portAttributes_t* self);
+void apx_portAttributes_set_high_priority(apx_portAttributes_t* self);
+bool apx_portAttributes_is_high_priority(apx_portAttributes_t* self);
 bool apx_portAttributes_has_init_value(apx_portAttributes_t* self);
 dtl_dv_t* apx_portAttributes_get_init_value(apx_portAttributes_t* self);
 void apx_portAttributes_set_init_value(apx_portAttributes_t* self, dtl_dv_t* init_value);
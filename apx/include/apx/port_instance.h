@@ -33,12 +33,14 @@
 #include "apx/computation.h"
 #include "apx/data_element.h"
 #include "apx/error.h"
+#include "apx/queued_port_ring.h"
 
 //////////////////////////////////////////////////////////////////////////////
 // PUBLIC CONSTANTS AND DATA TYPES
 //////////////////////////////////////////////////////////////////////////////
 //forward declarations
 struct apx_nodeInstance_tag;
+struct apx_rateLimitedPort_tag;
 
 typedef struct apx_portInstance_tag
 {
@@ -56,8 +58,15 @@ typedef struct apx_portInstance_tag
    uint32_t queue_length;
    uint32_t element_size; //Only used when m_queue_length > 0
    bool has_dynamic_data; //True if data_element has dynamic arrays anywhere in its definition
+   uint32_t dynamic_length_size; //Non-zero when the whole port value is one dynamic array, size of its length header
+   uint32_t dynamic_element_size; //Only used when dynamic_length_size > 0
    apx_computationList_t const* computation_list; //Weak reference (ownership is managed by parent node_instance)
    char* port_signature; //Only used in APX_SERVER_MODE
+   uint32_t routing_shard; //Only used in APX_SERVER_MODE when data routing is sharded (see apx_routingEngine_t)
+   uint32_t min_update_interval; //Only used in APX_SERVER_MODE for require ports. Milliseconds, 0 means no rate limiting.
+   struct apx_rateLimitedPort_tag* rate_limit; //Only used in APX_SERVER_MODE. Owned by apx_rateLimiter_t.
+   bool is_high_priority; //Data of this port uses the high priority transmit lane
+   apx_queuedPortRing_t* queue_ring; //Only used in APX_SERVER_MODE for queued require ports. Strong reference.
 } apx_portInstance_t;
 
 //////////////////////////////////////////////////////////////////////////////
@@ -78,7 +87,16 @@ uint32_t apx_portInstance_data_offset(apx_portInstance_t const* self);
 uint32_t apx_portInstance_data_size(apx_portInstance_t const* self);
 uint32_t apx_portInstance_queue_length(apx_portInstance_t const* self);
 uint32_t apx_portInstance_element_size(apx_portInstance_t const* self);
+void apx_portInstance_set_min_update_interval(apx_portInstance_t* self, uint32_t interval_ms);
+uint32_t apx_portInstance_min_update_interval(apx_portInstance_t const* self);
+void apx_portInstance_set_high_priority(apx_portInstance_t* self, bool is_high_priority);
+bool apx_portInstance_is_high_priority(apx_portInstance_t const* self);
+apx_error_t apx_portInstance_create_queue_ring(apx_portInstance_t* self);
+apx_queuedPortRing_t* apx_portInstance_get_queue_ring(apx_portInstance_t const* self);
 bool apx_portInstance_has_dynamic_data(apx_portInstance_t const* self);
+bool apx_portInstance_is_dynamic_array(apx_portInstance_t const* self);
+uint32_t apx_portInstance_dynamic_length_size(apx_portInstance_t const* self);
+apx_size_t apx_portInstance_current_data_size(apx_portInstance_t const* self, uint8_t const* data, apx_size_t size);
 apx_program_t const* apx_portInstance_pack_program(apx_portInstance_t* self);
 apx_program_t const* apx_portInstance_unpack_program(apx_portInstance_t* self);
 void apx_portInstance_set_effective_element(apx_portInstance_t* self, apx_dataElement_t* data_element);
@@ -91,6 +109,7 @@ apx_computation_t const* apx_portInstance_get_computation(apx_portInstance_t* se
 int32_t apx_portInstance_get_computation_list_length(apx_portInstance_t* self);
 apx_computationListId_t apx_portInstance_get_computation_list_id(apx_portInstance_t* self);
 apx_error_t apx_port_instance_create_port_signature(apx_portInstance_t* self);
+apx_error_t apx_portInstance_set_port_signature(apx_portInstance_t* self, char const* data_signature);
 char const* apx_portInstance_get_port_signature(apx_portInstance_t const* self, bool *has_dynamic_data);
 
 #endif //APX_GUARD_H
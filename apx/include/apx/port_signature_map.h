@@ -54,6 +54,7 @@ void apx_portSignatureMap_delete(apx_portSignatureMap_t *self);
 
 apx_portSignatureMapEntry_t *apx_portSignatureMap_find(apx_portSignatureMap_t *self, const char *portSignature);
 int32_t apx_portSignatureMap_length(apx_portSignatureMap_t *self);
+int32_t apx_portSignatureMap_values(apx_portSignatureMap_t *self, adt_ary_t *entries);
 apx_error_t apx_portSignatureMap_connect_provide_ports(apx_portSignatureMap_t *self, struct apx_nodeInstance_tag *node_instance);
 apx_error_t apx_portSignatureMap_connect_require_ports(apx_portSignatureMap_t *self, struct apx_nodeInstance_tag *node_instance);
 apx_error_t apx_portSignatureMap_disconnect_provide_ports(apx_portSignatureMap_t *self, struct apx_nodeInstance_tag *node_instance);
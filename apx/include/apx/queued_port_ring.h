@@ -0,0 +1,78 @@
+/*****************************************************************************
+* \file      queued_port_ring.h
+* \author    Conny Gustafsson
+* \date      2026-10-18
+* \brief     Ring buffer for queued port elements routed by the server
+*
+* Copyright (c) 2026 Conny Gustafsson
+* Permission is hereby granted, free of charge, to any person obtaining a copy of
+* this software and associated documentation files (the "Software"), to deal in
+* the Software without restriction, including without limitation the rights to
+* use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+* the Software, and to permit persons to whom the Software is furnished to do so,
+* subject to the following conditions:
+
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+* FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+* COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+* IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+* CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+******************************************************************************/
+#ifndef APX_QUEUED_PORT_RING_H
+#define APX_QUEUED_PORT_RING_H
+
+//////////////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////////////
+#include <stdint.h>
+#include <stdbool.h>
+#include "apx/types.h"
+#include "apx/error.h"
+
+//////////////////////////////////////////////////////////////////////////////
+// PUBLIC CONSTANTS AND DATA TYPES
+//////////////////////////////////////////////////////////////////////////////
+#define APX_QUEUED_PORT_RING_DEPTH 4u //Ring holds at least this many full port queues
+
+/*
+* Bounded single-producer/single-consumer ring of queued port elements. The producer is the thread routing
+* provide port data, the consumer is the file manager worker of the require port connection.
+* Positions are free-running element counters, the element index is position & (capacity-1).
+* Elements that don't fit are dropped and counted, elements already in the ring are never overwritten.
+*/
+typedef struct apx_queuedPortRing_tag
+{
+   uint8_t* elements; //Length: capacity * element_size
+   uint32_t capacity; //number of elements, power of two
+   uint32_t element_size;
+   uint32_t queue_length; //max number of elements in one delivered batch
+   uint32_t length_size; //size of the length header of the queued data encoding
+   volatile uint32_t write_pos; //written by producer
+   volatile uint32_t read_pos; //written by consumer
+   volatile uint32_t num_overflows; //number of dropped elements, written by producer
+   volatile uint32_t drain_pending; //1 while the consumer has been asked to drain the ring
+} apx_queuedPortRing_t;
+
+//////////////////////////////////////////////////////////////////////////////
+// PUBLIC FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////////////
+apx_error_t apx_queuedPortRing_create(apx_queuedPortRing_t* self, uint32_t element_size, uint32_t queue_length);
+void apx_queuedPortRing_destroy(apx_queuedPortRing_t* self);
+apx_queuedPortRing_t* apx_queuedPortRing_new(uint32_t element_size, uint32_t queue_length);
+void apx_queuedPortRing_delete(apx_queuedPortRing_t* self);
+apx_size_t apx_queuedPortRing_batch_size(apx_queuedPortRing_t const* self);
+uint32_t apx_queuedPortRing_num_overflows(apx_queuedPortRing_t* self);
+//Producer API
+apx_error_t apx_queuedPortRing_push(apx_queuedPortRing_t* self, uint8_t const* data, apx_size_t size, uint32_t* num_dropped, bool* needs_drain);
+void apx_queuedPortRing_cancel_drain(apx_queuedPortRing_t* self);
+//Consumer API
+void apx_queuedPortRing_begin_drain(apx_queuedPortRing_t* self);
+uint32_t apx_queuedPortRing_num_elements(apx_queuedPortRing_t* self);
+uint32_t apx_queuedPortRing_pop_batch(apx_queuedPortRing_t* self, uint8_t* buffer);
+
+#endif //APX_QUEUED_PORT_RING_H
@@ -0,0 +1,122 @@
+/*****************************************************************************
+* \file      rate_limiter.h
+* \author    Conny Gustafsson
+* \date      2026-10-18
+* \brief     Per-require-port update rate limiter
+*
+* Copyright (c) 2026 Conny Gustafsson
+* Permission is hereby granted, free of charge, to any person obtaining a copy of
+* this software and associated documentation files (the "Software"), to deal in
+* the Software without restriction, including without limitation the rights to
+* use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+* the Software, and to permit persons to whom the Software is furnished to do so,
+* subject to the following conditions:
+
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+* FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+* COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+* IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+* CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+******************************************************************************/
+#ifndef APX_RATE_LIMITER_H
+#define APX_RATE_LIMITER_H
+
+//////////////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////////////
+#include <stdint.h>
+#include <stdbool.h>
+#include "apx/error.h"
+#include "apx/types.h"
+#include "apx/timer_wheel.h"
+#include "apx/port_instance.h"
+#ifdef _WIN32
+# ifndef WIN32_LEAN_AND_MEAN
+# define WIN32_LEAN_AND_MEAN
+# endif
+# include <Windows.h>
+#else
+# include <pthread.h>
+# include <semaphore.h>
+#endif
+#include "osmacro.h"
+
+//////////////////////////////////////////////////////////////////////////////
+// PUBLIC CONSTANTS AND DATA TYPES
+//////////////////////////////////////////////////////////////////////////////
+#define APX_RATE_LIMITER_DEFAULT_TICK_MS 5u
+#define APX_RATE_LIMITER_NUM_SLOTS 512u
+
+//forward declarations
+struct apx_nodeInstance_tag;
+
+/*
+* Rate limiting state of one require port. Created on the first routed value.
+*/
+typedef struct apx_rateLimitedPort_tag
+{
+   apx_timerWheelEntry_t timer; //Must be the first member
+   struct apx_rateLimitedPort_tag* next_port;
+   struct apx_rateLimitedPort_tag* prev_port;
+   apx_portInstance_t* require_port; //Weak reference
+   uint8_t* pending_data; //Length: data_size. Latest value not yet delivered.
+   apx_size_t data_size;
+   apx_size_t pending_size; //Values of dynamic array ports can be shorter than data_size
+   uint64_t last_delivery_ms;
+   bool has_pending;
+   bool has_delivered;
+} apx_rateLimitedPort_t;
+
+typedef struct apx_rateLimiterStats_tag
+{
+   uint32_t num_forwarded; //values delivered immediately since the interval had already expired
+   uint32_t num_deferred;  //values delivered by the timer when the interval expired
+   uint32_t num_dropped;   //intermediate values replaced by a newer value before they were delivered
+} apx_rateLimiterStats_t;
+
+/*
+* Holds back values routed to require ports that have a minimum update interval and delivers
+* the latest value when the interval expires. One timer wheel is shared by all connections.
+*/
+typedef struct apx_rateLimiter_tag
+{
+   apx_timerWheel_t timer_wheel;
+   apx_rateLimitedPort_t* ports; //List of all port states (strong references)
+   uint32_t tick_ms;
+   apx_rateLimiterStats_t stats;
+   MUTEX_T lock; //Protects all members except the thread handle
+   SEMAPHORE_T wakeup_semaphore; //Posted when the wheel goes from empty to non-empty
+   THREAD_T thread;
+   bool is_thread_valid;
+   bool exit_flag;
+#ifdef UNIT_TEST
+   uint64_t test_time_ms;
+#endif
+#ifdef _WIN32
+   unsigned int thread_id;
+#endif
+} apx_rateLimiter_t;
+
+//////////////////////////////////////////////////////////////////////////////
+// PUBLIC FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////////////
+apx_error_t apx_rateLimiter_create(apx_rateLimiter_t* self, uint32_t tick_ms);
+void apx_rateLimiter_destroy(apx_rateLimiter_t* self);
+apx_rateLimiter_t* apx_rateLimiter_new(uint32_t tick_ms);
+void apx_rateLimiter_delete(apx_rateLimiter_t* self);
+apx_error_t apx_rateLimiter_submit(apx_rateLimiter_t* self, apx_portInstance_t* require_port, uint8_t const* data, apx_size_t size);
+void apx_rateLimiter_remove_node(apx_rateLimiter_t* self, struct apx_nodeInstance_tag* node_instance);
+void apx_rateLimiter_get_stats(apx_rateLimiter_t* self, apx_rateLimiterStats_t* stats);
+#ifdef UNIT_TEST
+void apx_rateLimiter_advance_time(apx_rateLimiter_t* self, uint32_t elapsed_ms);
+#else
+apx_error_t apx_rateLimiter_start(apx_rateLimiter_t* self);
+void apx_rateLimiter_stop(apx_rateLimiter_t* self);
+#endif
+
+#endif //APX_RATE_LIMITER_H
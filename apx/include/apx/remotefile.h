@@ -77,6 +77,7 @@ typedef uint8_t rmf_digestType_t;
 #define RMF_MAX_FILE_NAME_SIZE     255u
 #define RMF_FILE_INFO_HEADER_SIZE  48u
 #define RMF_FILE_NAME_MAX_SIZE     RMF_MAX_FILE_NAME_SIZE
+#define RMF_STREAM_SEQUENCE_SIZE   UINT32_SIZE //Each write to a stream file begins with the sequence number of the record
 
 #define RMF_CMD_ACK_MSG            ((uint32_t) 0u)
 #define RMF_CMD_NACK_MSG           ((uint32_t) 1u)
@@ -85,10 +86,12 @@ typedef uint8_t rmf_digestType_t;
 #define RMF_CMD_REVOKE_FILE_MSG    ((uint32_t) 4u)
 #define RMF_CMD_OPEN_FILE_MSG      ((uint32_t) 10u)
 #define RMF_CMD_CLOSE_FILE_MSG     ((uint32_t) 11u)
+#define RMF_CMD_COMPRESSED_MSG     ((uint32_t) 12u) //Wraps one compressed data message (see rmf_encode_compressed_msg_header)
 
 #define RMF_FILE_OPEN_CMD_SIZE     UINT32_SIZE
 #define RMF_FILE_CLOSE_CMD_SIZE    UINT32_SIZE
 #define RMF_CMD_TYPE_SIZE          UINT32_SIZE
+#define RMF_COMPRESSED_MSG_HEADER_MAX_SIZE (RMF_CMD_TYPE_SIZE + RMF_HIGH_ADDR_SIZE + UINT32_SIZE)
 
 
 #define RMF_U16_FILE_TYPE_FIXED     ((uint16_t) 0u)
@@ -105,9 +108,13 @@ typedef uint8_t rmf_digestType_t;
 #define RMF_NUMHEADER_SIZE_32  UINT32_SIZE
 #define RMF_NUMHEADER_SIZE_DEFAULT RMF_NUMHEADER_SIZE_32
 
-#define RMF_GREETING_MAX_LEN 127
+#define RMF_GREETING_MAX_LEN 255
 #define RMF_GREETING_START "RMFP/1.0\n"
 #define RMF_NUMHEADER_FORMAT_HDR "NumHeader-Format:"
+#define RMF_SHARED_MEMORY_HDR "Shared-Memory:" //Name of shared memory region offered by client (local connections only)
+#define RMF_CAPABILITIES_HDR "Capabilities:" //Comma-separated feature names. Client offers, server replies with agreed set after the acknowledge
+#define RMF_MAX_MESSAGE_SIZE_HDR "Max-Message-Size:"
+#define RMF_RECEIVE_BUFFER_SIZE_HDR "Receive-Buffer-Size:"
 
 apx_size_t rmf_needed_encoding_size(uint32_t address);
 apx_size_t rmf_address_encode(uint8_t* buf, apx_size_t buf_size, uint32_t address, bool more_bit);
@@ -115,6 +122,8 @@ apx_size_t rmf_address_decode(uint8_t const* begin, uint8_t const* end, uint32_t
 apx_size_t rmf_encode_open_file_cmd(uint8_t* buf, apx_size_t buf_size, uint32_t address);
 apx_size_t rmf_encode_acknowledge_cmd(uint8_t* buf, apx_size_t buf_size);
 apx_size_t rmf_decode_cmd_type(uint8_t const* begin, uint8_t const* end, uint32_t* cmd_type);
+apx_size_t rmf_encode_compressed_msg_header(uint8_t* buf, apx_size_t buf_size, uint32_t address, bool more_bit, uint32_t uncompressed_size);
+apx_size_t rmf_decode_compressed_msg_header(uint8_t const* begin, uint8_t const* end, uint32_t* address, bool* more_bit, uint32_t* uncompressed_size);
 
 
 
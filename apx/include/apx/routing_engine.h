@@ -0,0 +1,129 @@
+/*****************************************************************************
+* \file      routing_engine.h
+* \author    Conny Gustafsson
+* \date      2026-10-18
+* \brief     Sharded data routing engine
+*
+* Copyright (c) 2026 Conny Gustafsson
+* Permission is hereby granted, free of charge, to any person obtaining a copy of
+* this software and associated documentation files (the "Software"), to deal in
+* the Software without restriction, including without limitation the rights to
+* use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+* the Software, and to permit persons to whom the Software is furnished to do so,
+* subject to the following conditions:
+
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+* FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+* COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+* IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+* CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+******************************************************************************/
+#ifndef APX_ROUTING_ENGINE_H
+#define APX_ROUTING_ENGINE_H
+
+//////////////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////////////
+#include "apx/types.h"
+#include "apx/error.h"
+#include "apx/port_instance.h"
+#ifdef _WIN32
+# ifndef WIN32_LEAN_AND_MEAN
+# define WIN32_LEAN_AND_MEAN
+# endif
+# include <Windows.h>
+#else
+# include <pthread.h>
+# include <semaphore.h>
+#endif
+#include "osmacro.h"
+#include "adt_hash.h"
+
+//////////////////////////////////////////////////////////////////////////////
+// PUBLIC CONSTANTS AND DATA TYPES
+//////////////////////////////////////////////////////////////////////////////
+#define APX_ROUTING_ENGINE_MAX_SHARDS 64u
+
+//forward declarations
+struct apx_nodeInstance_tag;
+
+/*
+* One provide port value waiting to be routed to the requesters of its port.
+* Data is copied into the same allocation as the record. A record without provide_port is a flush marker.
+*/
+typedef struct apx_routingUpdate_tag
+{
+   struct apx_routingUpdate_tag* next;
+   apx_portInstance_t* provide_port; //weak reference
+   uint8_t* data; //points into the same allocation
+   apx_size_t data_size;
+   SEMAPHORE_T* flush_semaphore; //only used by flush markers
+} apx_routingUpdate_t;
+
+typedef struct apx_routingShardStats_tag
+{
+   uint32_t num_updates; //total number of provide port values routed by this shard
+   uint32_t num_batches; //number of times the queue was drained (one lock acquisition per batch)
+   uint32_t num_wakeups; //number of times the shard thread had to wait on the semaphore
+} apx_routingShardStats_t;
+
+/*
+* A routing shard owns all port signatures that hash (or are pinned) to it and routes their values on its own thread.
+* Producers append to the queue under a spinlock that is held only for the pointer update, the shard thread
+* removes the entire queue in one go.
+*/
+typedef struct apx_routingShard_tag
+{
+   apx_routingUpdate_t* head;
+   apx_routingUpdate_t* tail;
+   SPINLOCK_T lock;
+   SEMAPHORE_T semaphore;
+   THREAD_T thread;
+   apx_routingShardStats_t stats;
+   uint32_t shard_id;
+   bool is_thread_valid;
+   bool is_consumer_waiting; //protected by lock. When false, producers do not need to post the semaphore
+   bool exit_flag;
+#ifdef _WIN32
+   unsigned int thread_id;
+#endif
+} apx_routingShard_t;
+
+/*
+* Partitions data routing into a fixed number of shards, selected by port signature.
+* All values of one signature are routed by the same shard, so updates of each provide port are applied in order.
+*/
+typedef struct apx_routingEngine_tag
+{
+   apx_routingShard_t* shards; //Length: num_shards
+   uint32_t num_shards;
+   adt_hash_t pinned_signatures; //shard_id + 1 stored as pointer value, keyed by port signature
+} apx_routingEngine_t;
+
+//////////////////////////////////////////////////////////////////////////////
+// PUBLIC FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////////////
+apx_error_t apx_routingEngine_create(apx_routingEngine_t* self, uint32_t num_shards);
+void apx_routingEngine_destroy(apx_routingEngine_t* self);
+apx_routingEngine_t* apx_routingEngine_new(uint32_t num_shards);
+void apx_routingEngine_delete(apx_routingEngine_t* self);
+uint32_t apx_routingEngine_num_shards(apx_routingEngine_t const* self);
+apx_error_t apx_routingEngine_pin_signature(apx_routingEngine_t* self, char const* port_signature, uint32_t shard_id);
+uint32_t apx_routingEngine_shard_of(apx_routingEngine_t* self, char const* port_signature);
+void apx_routingEngine_assign_shards(apx_routingEngine_t* self, struct apx_nodeInstance_tag* node_instance);
+apx_error_t apx_routingEngine_post(apx_routingEngine_t* self, apx_portInstance_t* provide_port, uint8_t const* data, apx_size_t size);
+void apx_routingEngine_flush(apx_routingEngine_t* self);
+void apx_routingEngine_get_shard_stats(apx_routingEngine_t* self, uint32_t shard_id, apx_routingShardStats_t* stats);
+#ifdef UNIT_TEST
+int32_t apx_routingEngine_run(apx_routingEngine_t* self);
+#else
+apx_error_t apx_routingEngine_start(apx_routingEngine_t* self);
+void apx_routingEngine_stop(apx_routingEngine_t* self);
+#endif
+
+#endif //APX_ROUTING_ENGINE_H
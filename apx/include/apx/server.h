@@ -44,6 +44,10 @@
 #include "apx/event_loop.h"
 #include "apx/node_instance.h"
 #include "apx/port_connector_change_table.h"
+#include "apx/routing_engine.h"
+#include "apx/fanout_pool.h"
+#include "apx/rate_limiter.h"
+#include "apx/node_cache.h"
 #include "soa.h"
 #include "adt_str.h"
 #include "adt_ary.h"
@@ -72,6 +76,13 @@ typedef struct apx_server_tag
                                                //2. Synchronize data routing
                                                //3. Controlling access to the global port_signature_map.
    MUTEX_T event_listener_lock;
+   apx_routingEngine_t *routing_engine;        //Strong reference. NULL when data is routed directly on the connection threads.
+   apx_fanoutPool_t *fanout_pool;              //Strong reference. NULL when connectors of a provide port are always processed by a single thread.
+   apx_rateLimiter_t *rate_limiter;            //Strong reference. Holds back values for require ports with a minimum update interval.
+   bool change_only_routing;                   //When true, provide port values identical to the previous value are not routed (all nodes)
+   uint32_t compression_threshold;             //0 when clients offering compression are refused
+   apx_nodeCache_t node_cache;                 //Definitions seen on any connection, keyed by digest
+   bool is_node_cache_enabled;                 //When false, definitions are always downloaded from the client
 #ifdef _WIN32
    unsigned int thread_id;
 #endif
@@ -108,6 +119,20 @@ apx_error_t apx_server_process_provide_port_connector_changes(apx_server_t *self
 apx_error_t apx_server_insert_modified_node_instance(apx_server_t *self, apx_nodeInstance_t *node_instance);
 adt_ary_t *apx_server_get_modified_node_instance(const apx_server_t *self);
 void apx_server_clear_port_connector_changes(apx_server_t *self);
+apx_error_t apx_server_enable_routing_shards(apx_server_t *self, uint32_t num_shards);
+apx_error_t apx_server_pin_routing_signature(apx_server_t *self, const char *port_signature, uint32_t shard_id);
+apx_routingEngine_t *apx_server_get_routing_engine(apx_server_t const *self);
+void apx_server_flush_routing(apx_server_t *self);
+apx_error_t apx_server_enable_parallel_fanout(apx_server_t *self, uint32_t num_workers, int32_t threshold);
+apx_fanoutPool_t *apx_server_get_fanout_pool(apx_server_t const *self);
+void apx_server_set_change_only_routing(apx_server_t *self, bool enabled);
+bool apx_server_is_change_only_routing(apx_server_t const *self);
+apx_rateLimiter_t *apx_server_get_rate_limiter(apx_server_t const *self);
+void apx_server_enable_compression(apx_server_t *self, uint32_t threshold);
+uint32_t apx_server_get_compression_threshold(apx_server_t const *self);
+void apx_server_get_compression_stats(apx_server_t *self, apx_compressionStats_t *stats);
+void apx_server_configure_node_cache(apx_server_t *self, bool enabled, apx_size_t max_size);
+apx_nodeCache_t *apx_server_get_node_cache(apx_server_t *self);
 
 
 #ifdef UNIT_TEST
@@ -84,9 +84,12 @@ void apx_serverTestConnection_clear_log(apx_serverTestConnection_t* self);
 apx_fileManager_t* apx_serverTestConnection_get_file_manager(apx_serverTestConnection_t* self);
 apx_nodeManager_t* apx_serverTestConnection_get_node_manager(apx_serverTestConnection_t* self);
 apx_error_t apx_serverTestConnection_send_greeting_header(apx_serverTestConnection_t* self);
+apx_error_t apx_serverTestConnection_send_greeting_header_with_lines(apx_serverTestConnection_t* self, char const* header_lines);
 apx_error_t apx_serverTestConnection_request_open_local_file(apx_serverTestConnection_t* self, char const* file_name);
 apx_error_t apx_serverTestConnection_publish_remote_file(apx_serverTestConnection_t* self, uint32_t address, char const* file_name, apx_size_t file_size);
+apx_error_t apx_serverTestConnection_publish_remote_file_with_digest(apx_serverTestConnection_t* self, uint32_t address, char const* file_name, apx_size_t file_size, uint8_t const* digest_data);
 apx_error_t apx_serverTestConnection_write_remote_data(apx_serverTestConnection_t* self, uint32_t address, uint8_t const* payload_data, apx_size_t payload_size);
+apx_error_t apx_serverTestConnection_write_remote_fragment(apx_serverTestConnection_t* self, uint32_t address, uint8_t const* payload_data, apx_size_t payload_size, bool more_bit);
 apx_nodeInstance_t* apx_serverTestConnection_find_node(apx_serverTestConnection_t* self, char const* name);
 apx_error_t apx_serverTestConnection_build_node(apx_serverTestConnection_t* self, char const* definition_text);
 void apx_serverTestConnection_run(apx_serverTestConnection_t* self);
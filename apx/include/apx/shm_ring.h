@@ -0,0 +1,108 @@
+/*****************************************************************************
+* \file      shm_ring.h
+* \author    Conny Gustafsson
+* \date      2026-10-18
+* \brief     Single-producer/single-consumer ring buffer placed in shared memory
+*
+* Copyright (c) 2026 Conny Gustafsson
+* Permission is hereby granted, free of charge, to any person obtaining a copy of
+* this software and associated documentation files (the "Software"), to deal in
+* the Software without restriction, including without limitation the rights to
+* use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+* the Software, and to permit persons to whom the Software is furnished to do so,
+* subject to the following conditions:
+
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+* FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+* COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+* IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+* CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+******************************************************************************/
+#ifndef APX_SHM_RING_H
+#define APX_SHM_RING_H
+
+//////////////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////////////
+#include "apx/types.h"
+#include "apx/error.h"
+
+//////////////////////////////////////////////////////////////////////////////
+// PUBLIC CONSTANTS AND DATA TYPES
+//////////////////////////////////////////////////////////////////////////////
+#define APX_SHM_RING_MAGIC 0x41505852u //"APXR"
+#define APX_SHM_RING_ALIGNMENT 8u
+#define APX_SHM_RING_RECORD_HEADER_SIZE 8u //Record length followed by padding
+#define APX_SHM_RING_MIN_CAPACITY 1024u
+#define APX_SHM_RING_CACHE_LINE_SIZE 64u
+
+/*
+* Control block at the start of the ring memory. Producer and consumer fields are kept on separate
+* cache lines. Positions are free-running byte counters, the offset into data is position & (capacity-1).
+* data_seq and space_seq are futex words, incremented on every publish/release.
+*/
+typedef struct apx_shmRingHeader_tag
+{
+   uint32_t magic;
+   uint32_t capacity; //size of data area in bytes, power of two
+   volatile uint32_t is_closed;
+   uint8_t reserved1[APX_SHM_RING_CACHE_LINE_SIZE - 3 * sizeof(uint32_t)];
+   //written by producer
+   volatile uint32_t write_pos;
+   volatile uint32_t data_seq;
+   volatile uint32_t producer_waiting;
+   uint8_t reserved2[APX_SHM_RING_CACHE_LINE_SIZE - 3 * sizeof(uint32_t)];
+   //written by consumer
+   volatile uint32_t read_pos;
+   volatile uint32_t space_seq;
+   volatile uint32_t consumer_waiting;
+   uint8_t reserved3[APX_SHM_RING_CACHE_LINE_SIZE - 3 * sizeof(uint32_t)];
+} apx_shmRingHeader_t;
+
+/*
+* Process-local view of a ring. Data is exchanged in records. The producer appends messages into an open
+* record using reserve and publishes all records written since last commit in one go. The consumer
+* sees each record as one contiguous block of bytes.
+*/
+typedef struct apx_shmRing_tag
+{
+   apx_shmRingHeader_t* header;
+   uint8_t* data;
+   uint32_t capacity;
+   //producer state
+   uint32_t tx_pos; //end of data written but not yet published
+   uint32_t record_pos; //position of length field of open record
+   uint32_t cached_read_pos; //last seen consumer position, avoids touching the consumer cache line on every reserve
+   bool is_record_open;
+   //consumer state
+   uint32_t rx_pos; //read position. Kept locally since the shared copy can be modified by the producer process
+   uint32_t rx_record_size; //size of record returned by last peek, including header and padding
+   bool is_corrupt; //positions or record lengths written by the other process were found to be invalid
+} apx_shmRing_t;
+
+//////////////////////////////////////////////////////////////////////////////
+// PUBLIC FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////////////
+apx_size_t apx_shmRing_memory_size(uint32_t capacity);
+apx_error_t apx_shmRing_init(apx_shmRing_t* self, void* memory, uint32_t capacity);
+apx_error_t apx_shmRing_attach(apx_shmRing_t* self, void* memory, apx_size_t memory_size);
+uint32_t apx_shmRing_max_record_size(apx_shmRing_t const* self);
+//Producer API
+uint8_t* apx_shmRing_reserve(apx_shmRing_t* self, uint32_t size);
+void apx_shmRing_commit(apx_shmRing_t* self);
+bool apx_shmRing_wait_writable(apx_shmRing_t* self, uint32_t size, uint32_t timeout_ms);
+//Consumer API
+uint8_t const* apx_shmRing_peek(apx_shmRing_t* self, uint32_t* size);
+void apx_shmRing_release(apx_shmRing_t* self);
+bool apx_shmRing_wait_readable(apx_shmRing_t* self, uint32_t timeout_ms);
+//Shared API
+void apx_shmRing_close(apx_shmRing_t* self);
+bool apx_shmRing_is_closed(apx_shmRing_t const* self);
+bool apx_shmRing_is_corrupt(apx_shmRing_t const* self);
+
+#endif //APX_SHM_RING_H
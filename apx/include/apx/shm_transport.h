@@ -0,0 +1,113 @@
+/*****************************************************************************
+* \file      shm_transport.h
+* \author    Conny Gustafsson
+* \date      2026-10-18
+* \brief     Shared-memory transport for connections between processes on the same host
+*
+* Copyright (c) 2026 Conny Gustafsson
+* Permission is hereby granted, free of charge, to any person obtaining a copy of
+* this software and associated documentation files (the "Software"), to deal in
+* the Software without restriction, including without limitation the rights to
+* use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+* the Software, and to permit persons to whom the Software is furnished to do so,
+* subject to the following conditions:
+
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+* FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+* COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+* IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+* CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+******************************************************************************/
+#ifndef APX_SHM_TRANSPORT_H
+#define APX_SHM_TRANSPORT_H
+
+//////////////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////////////
+#include "apx/types.h"
+#include "apx/error.h"
+#include "apx/shm_ring.h"
+#include "osmacro.h"
+
+//////////////////////////////////////////////////////////////////////////////
+// PUBLIC CONSTANTS AND DATA TYPES
+//////////////////////////////////////////////////////////////////////////////
+#if defined(__linux__) && !defined(UNIT_TEST)
+#define APX_SHM_TRANSPORT_SUPPORTED 1 //Named regions (shm_open) and futex wakeups are available
+#else
+#define APX_SHM_TRANSPORT_SUPPORTED 0
+#endif
+
+#define APX_SHM_TRANSPORT_DEFAULT_RING_SIZE 1048576u //1MB in each direction
+#define APX_SHM_TRANSPORT_MAX_RING_SIZE 16777216u //Largest region a server accepts is 16MB in each direction
+#define APX_SHM_TRANSPORT_NAME_MAX_LEN 64
+#define APX_SHM_TRANSPORT_NAME_PREFIX "/apx-"
+
+//Same signature as the msocket data handler so connections can reuse their socket data callback
+typedef int8_t (apx_shmTransportDataFunc)(void* arg, const uint8_t* data, uint32_t data_size, uint32_t* parse_size);
+
+/*
+* Two rings in one memory region. The first ring carries data from client to server and the second from
+* server to client. Each transmit batch (transmit_begin/transmit_end) becomes one ring record containing
+* complete RMF messages, so the receiver can parse records in-place.
+*/
+typedef struct apx_shmTransport_tag
+{
+   apx_shmRing_t tx_ring;
+   apx_shmRing_t rx_ring;
+   uint8_t* memory;
+   apx_size_t memory_size;
+   apx_shmTransportDataFunc* data_handler;
+   void* handler_arg;
+   uint64_t total_bytes_written;
+   uint64_t total_bytes_received;
+   char name[APX_SHM_TRANSPORT_NAME_MAX_LEN]; //name of shared memory object, empty when not named
+   int fd;
+   bool is_mapped; //memory is mapped by this object
+   bool is_name_linked; //shared memory object name exists and is owned by this object
+   bool reader_thread_valid;
+   THREAD_T reader_thread;
+} apx_shmTransport_t;
+
+//////////////////////////////////////////////////////////////////////////////
+// PUBLIC FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////////////
+void apx_shmTransport_create(apx_shmTransport_t* self);
+void apx_shmTransport_destroy(apx_shmTransport_t* self);
+apx_shmTransport_t* apx_shmTransport_new(void);
+void apx_shmTransport_delete(apx_shmTransport_t* self);
+
+apx_size_t apx_shmTransport_memory_size(uint32_t ring_capacity);
+bool apx_shmTransport_is_valid_region_name(char const* name);
+bool apx_shmTransport_is_valid_region_size(apx_size_t memory_size);
+apx_error_t apx_shmTransport_attach_memory(apx_shmTransport_t* self, void* memory, apx_size_t memory_size, apx_mode_t mode, bool initialize);
+#if APX_SHM_TRANSPORT_SUPPORTED
+apx_error_t apx_shmTransport_create_region(apx_shmTransport_t* self, uint32_t ring_capacity);
+apx_error_t apx_shmTransport_open_region(apx_shmTransport_t* self, char const* name);
+void apx_shmTransport_unlink_region(apx_shmTransport_t* self);
+#endif
+char const* apx_shmTransport_get_name(apx_shmTransport_t const* self);
+
+void apx_shmTransport_set_handler(apx_shmTransport_t* self, apx_shmTransportDataFunc* data_handler, void* arg);
+apx_error_t apx_shmTransport_start(apx_shmTransport_t* self);
+void apx_shmTransport_stop(apx_shmTransport_t* self);
+
+//Transmit API. Caller provides mutual exclusion between transmit calls (same as for socket connections)
+int32_t apx_shmTransport_max_message_size(apx_shmTransport_t const* self);
+apx_error_t apx_shmTransport_write_data_message(apx_shmTransport_t* self, uint32_t write_address, bool more_bit, uint8_t const* msg_data, int32_t msg_size);
+apx_error_t apx_shmTransport_write_direct_message(apx_shmTransport_t* self, uint8_t const* msg_data, int32_t msg_size);
+void apx_shmTransport_flush(apx_shmTransport_t* self);
+
+uint64_t apx_shmTransport_get_total_bytes_written(apx_shmTransport_t const* self);
+uint64_t apx_shmTransport_get_total_bytes_received(apx_shmTransport_t const* self);
+
+#ifdef UNIT_TEST
+apx_error_t apx_shmTransport_run(apx_shmTransport_t* self);
+#endif
+
+#endif //APX_SHM_TRANSPORT_H
@@ -31,6 +31,7 @@
 //////////////////////////////////////////////////////////////////////////////
 #include "adt_bytearray.h"
 #include "apx/client_connection.h"
+#include "apx/shm_transport.h"
 
 //////////////////////////////////////////////////////////////////////////////
 // PUBLIC CONSTANTS AND DATA TYPES
@@ -49,6 +50,9 @@ typedef struct apx_clientSocketConnection_tag
    apx_size_t default_buffer_size;
    apx_size_t pending_bytes;
    SOCKET_TYPE *socket_object;
+   apx_shmTransport_t* shm_transport; //shared memory offered to server, used for all traffic once is_shm_active is set
+   bool is_shm_enabled; //offer shared memory when connecting through UNIX socket
+   bool is_shm_active;
    MUTEX_T lock;
 }apx_clientSocketConnection_t;
 
@@ -59,6 +63,8 @@ apx_error_t apx_clientSocketConnection_create(apx_clientSocketConnection_t *self
 void apx_clientSocketConnection_destroy(apx_clientSocketConnection_t *self);
 void apx_clientSocketConnection_vdestroy(void *arg);
 apx_clientSocketConnection_t *apx_clientSocketConnection_new(SOCKET_TYPE * socket_object);
+void apx_clientSocketConnection_enable_shm_transport(apx_clientSocketConnection_t *self, bool enable);
+bool apx_clientSocketConnection_is_shm_transport_active(apx_clientSocketConnection_t *self);
 
 #ifndef UNIT_TEST
 apx_error_t apx_clientConnection_tcp_connect(apx_clientSocketConnection_t *self, const char *address, uint16_t port);
@@ -0,0 +1,78 @@
+/*****************************************************************************
+* \file      stream_buffer.h
+* \author    Conny Gustafsson
+* \date      2026-10-18
+* \brief     Retention buffer for records written to RMF stream files
+*
+* Copyright (c) 2026 Conny Gustafsson
+* Permission is hereby granted, free of charge, to any person obtaining a copy of
+* this software and associated documentation files (the "Software"), to deal in
+* the Software without restriction, including without limitation the rights to
+* use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+* the Software, and to permit persons to whom the Software is furnished to do so,
+* subject to the following conditions:
+
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+* FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+* COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+* IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+* CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+******************************************************************************/
+#ifndef APX_STREAM_BUFFER_H
+#define APX_STREAM_BUFFER_H
+
+//////////////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////////////
+#include <stdint.h>
+#include <stdbool.h>
+#include "apx/types.h"
+#include "apx/error.h"
+
+//////////////////////////////////////////////////////////////////////////////
+// PUBLIC CONSTANTS AND DATA TYPES
+//////////////////////////////////////////////////////////////////////////////
+#define APX_STREAM_DEFAULT_RETENTION 64u //Number of records kept for readers that open a stream file late
+
+typedef struct apx_streamRecord_tag
+{
+   uint8_t* data; //Starts with the sequence number (RMF_STREAM_SEQUENCE_SIZE bytes) followed by the record data
+   uint32_t size; //Including the sequence number
+} apx_streamRecord_t;
+
+/*
+* The most recent records written to a local stream file. Records are numbered in write order, when the buffer
+* is full the oldest record is evicted. Only accessed by the file manager worker of the connection.
+*/
+typedef struct apx_streamBuffer_tag
+{
+   apx_streamRecord_t* records; //Length: retention
+   uint32_t retention;
+   uint32_t num_records;
+   uint32_t first_index; //index of the oldest record
+   uint32_t next_sequence;
+   uint32_t num_evicted;
+   bool is_active; //true once retained records have been sent to the reader, new records are then sent right away
+} apx_streamBuffer_t;
+
+//////////////////////////////////////////////////////////////////////////////
+// PUBLIC FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////////////
+apx_error_t apx_streamBuffer_create(apx_streamBuffer_t* self, uint32_t retention);
+void apx_streamBuffer_destroy(apx_streamBuffer_t* self);
+apx_streamBuffer_t* apx_streamBuffer_new(uint32_t retention);
+void apx_streamBuffer_delete(apx_streamBuffer_t* self);
+uint32_t apx_streamBuffer_push(apx_streamBuffer_t* self, uint8_t* record, uint32_t size);
+uint32_t apx_streamBuffer_length(apx_streamBuffer_t const* self);
+apx_streamRecord_t const* apx_streamBuffer_get(apx_streamBuffer_t const* self, uint32_t index);
+uint32_t apx_streamBuffer_next_sequence(apx_streamBuffer_t const* self);
+uint32_t apx_streamBuffer_num_evicted(apx_streamBuffer_t const* self);
+void apx_streamBuffer_set_active(apx_streamBuffer_t* self, bool is_active);
+bool apx_streamBuffer_is_active(apx_streamBuffer_t const* self);
+
+#endif //APX_STREAM_BUFFER_H
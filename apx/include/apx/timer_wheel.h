@@ -0,0 +1,78 @@
+/*****************************************************************************
+* \file      timer_wheel.h
+* \author    Conny Gustafsson
+* \date      2026-10-18
+* \brief     Hashed timer wheel
+*
+* Copyright (c) 2026 Conny Gustafsson
+* Permission is hereby granted, free of charge, to any person obtaining a copy of
+* this software and associated documentation files (the "Software"), to deal in
+* the Software without restriction, including without limitation the rights to
+* use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+* the Software, and to permit persons to whom the Software is furnished to do so,
+* subject to the following conditions:
+
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+* FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+* COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+* IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+* CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+******************************************************************************/
+#ifndef APX_TIMER_WHEEL_H
+#define APX_TIMER_WHEEL_H
+
+//////////////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////////////
+#include <stdint.h>
+#include <stdbool.h>
+#include "apx/error.h"
+
+//////////////////////////////////////////////////////////////////////////////
+// PUBLIC CONSTANTS AND DATA TYPES
+//////////////////////////////////////////////////////////////////////////////
+
+/*
+* Intrusive timer entry. Embed it in the object that owns the timer.
+*/
+typedef struct apx_timerWheelEntry_tag
+{
+   struct apx_timerWheelEntry_tag* next;
+   struct apx_timerWheelEntry_tag* prev;
+   uint64_t expire_tick;
+   bool is_scheduled;
+} apx_timerWheelEntry_t;
+
+/*
+* Hashed timer wheel. An entry that expires at tick T is stored in slot T % num_slots.
+* Scheduling and cancelling is O(1), advancing visits at most num_slots slots.
+* The wheel has no lock of its own, the owner must serialize all calls.
+*/
+typedef struct apx_timerWheel_tag
+{
+   apx_timerWheelEntry_t* slots; //Length: num_slots. Each slot is the sentinel of a circular list.
+   uint32_t num_slots;
+   uint32_t num_scheduled;
+   uint64_t current_tick;
+} apx_timerWheel_t;
+
+//////////////////////////////////////////////////////////////////////////////
+// PUBLIC FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////////////
+apx_error_t apx_timerWheel_create(apx_timerWheel_t* self, uint32_t num_slots);
+void apx_timerWheel_destroy(apx_timerWheel_t* self);
+apx_timerWheel_t* apx_timerWheel_new(uint32_t num_slots);
+void apx_timerWheel_delete(apx_timerWheel_t* self);
+void apx_timerWheelEntry_create(apx_timerWheelEntry_t* entry);
+void apx_timerWheel_schedule(apx_timerWheel_t* self, apx_timerWheelEntry_t* entry, uint64_t expire_tick);
+void apx_timerWheel_cancel(apx_timerWheel_t* self, apx_timerWheelEntry_t* entry);
+apx_timerWheelEntry_t* apx_timerWheel_advance(apx_timerWheel_t* self, uint64_t now_tick);
+uint64_t apx_timerWheel_current_tick(apx_timerWheel_t const* self);
+uint32_t apx_timerWheel_num_scheduled(apx_timerWheel_t const* self);
+
+#endif //APX_TIMER_WHEEL_H
@@ -91,7 +91,7 @@ typedef struct apx_dataWriteCmd_tag
 
 typedef uint8_t apx_fileType_t;
 #define APX_UNKNOWN_FILE_TYPE             ((apx_fileType_t) 0u)
-#define APX_DEFINITION_FILE_TYPE          ((apx_fileType_t) 1u) //".apx"
+#define APX_DEFINITION_FILE_TYPE          ((apx_fileType_t) 1u) //".apx" or ".apxb"
 #define APX_PROVIDE_PORT_DATA_FILE_TYPE   ((apx_fileType_t) 2u) //".out"
 #define APX_REQUIRE_PORT_DATA_FILE_TYPE   ((apx_fileType_t) 3u) //".in"
 #define APX_PROVIDE_PORT_COUNT_FILE_TYPE  ((apx_fileType_t) 4u) //".cout"
@@ -105,6 +105,7 @@ typedef uint8_t apx_fileType_t;
 #define APX_PROVIDE_PORT_COUNT_EXT ".cout"
 #define APX_REQUIRE_PORT_COUNT_EXT ".cin"
 #define APX_DEFINITION_FILE_EXT   ".apx"
+#define APX_BINARY_DEFINITION_FILE_EXT ".apxb" //Precompiled definition, see apx/binary_definition.h
 
 
 
@@ -242,6 +243,8 @@ typedef uint8_t apx_attributeParseType_t;
 #define APX_ATTRIBUTE_PARSE_TYPE_INIT_VALUE       ((apx_attributeParseType_t) 3u)
 #define APX_ATTRIBUTE_PARSE_TYPE_PARAMETER        ((apx_attributeParseType_t) 4u)
 #define APX_ATTRIBUTE_PARSE_TYPE_QUEUE_LENGTH     ((apx_attributeParseType_t) 5u)
+#define APX_ATTRIBUTE_PARSE_TYPE_UPDATE_INTERVAL  ((apx_attributeParseType_t) 6u)
+#define APX_ATTRIBUTE_PARSE_TYPE_HIGH_PRIORITY    ((apx_attributeParseType_t) 7u)
 
 typedef uint8_t apx_argumentType_t;
 #define APX_ARGUMENT_TYPE_INVALID         ((apx_argumentType_t) 0u)
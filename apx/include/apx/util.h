@@ -48,6 +48,11 @@ void apx_fprint_hex_bytes(FILE *file, int32_t maxColumns, const uint8_t *dataBuf
 
 apx_resource_type_t apx_parse_resource_name(const char *text, adt_str_t **address, uint16_t *port);
 apx_error_t convert_from_adt_to_apx_error(adt_error_t error_code);
+/*
+* Monotonic clock for measuring intervals. The starting point is unspecified.
+*/
+uint64_t apx_time_monotonic_us(void);
+uint64_t apx_time_monotonic_ms(void);
 
 
 #endif //APX_UTIL_H
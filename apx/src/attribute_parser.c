@@ -491,6 +491,12 @@ static uint8_t const* apx_attributeParser_parse_single_port_attribute(apx_attrib
    case 'Q':
       attribute_type = APX_ATTRIBUTE_PARSE_TYPE_QUEUE_LENGTH;
       break;
+   case 'I':
+      attribute_type = APX_ATTRIBUTE_PARSE_TYPE_UPDATE_INTERVAL;
+      break;
+   case 'H':
+      attribute_type = APX_ATTRIBUTE_PARSE_TYPE_HIGH_PRIORITY;
+      break;
    default:
       attribute_type = APX_ATTRIBUTE_PARSE_TYPE_NONE;
    }
@@ -509,6 +515,13 @@ static uint8_t const* apx_attributeParser_parse_single_port_attribute(apx_attrib
       case APX_ATTRIBUTE_PARSE_TYPE_QUEUE_LENGTH:
          result = apx_attributeParser_parse_array_length(next + 1, end, &attr->queue_length);
          break;
+      case APX_ATTRIBUTE_PARSE_TYPE_UPDATE_INTERVAL:
+         result = apx_attributeParser_parse_array_length(next + 1, end, &attr->min_update_interval);
+         break;
+      case APX_ATTRIBUTE_PARSE_TYPE_HIGH_PRIORITY:
+         result = next + 1;
+         attr->is_high_priority = true;
+         break;
       default:
          apx_attributeParser_set_error(self, APX_INTERNAL_ERROR, NULL);
          return NULL;
@@ -0,0 +1,523 @@
+/*****************************************************************************
+* \file      binary_definition.c
+* \author    Conny Gustafsson
+* \date      2026-10-18
+* \brief     Compact binary format of precompiled node definitions
+*
+* Copyright (c) 2026 Conny Gustafsson
+* Permission is hereby granted, free of charge, to any person obtaining a copy of
+* this software and associated documentation files (the "Software"), to deal in
+* the Software without restriction, including without limitation the rights to
+* use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+* the Software, and to permit persons to whom the Software is furnished to do so,
+* subject to the following conditions:
+
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+* FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+* COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+* IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+* CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+******************************************************************************/
+//////////////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////////////
+#include <malloc.h>
+#include <string.h>
+#include <assert.h>
+#include "apx/binary_definition.h"
+#include "apx/node_instance.h"
+#include "apx/util.h"
+#include "adt_ary.h"
+#include "adt_hash.h"
+#include "adt_str.h"
+#include "pack.h"
+#include "sha256.h"
+#ifdef MEM_LEAK_CHECK
+#include "CMemLeak.h"
+#endif
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE CONSTANTS AND DATA TYPES
+//////////////////////////////////////////////////////////////////////////////
+#define MIN_STRING_SIZE (UINT16_SIZE + 1u)
+#define MIN_PORT_SIZE (MIN_STRING_SIZE + 4u * UINT32_SIZE + UINT8_SIZE)
+#define MAX_STRING_LENGTH 0xFFFFu
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////////////
+static apx_error_t create_type_table(apx_nodeInstance_t const* node_instance, adt_ary_t* types, uint32_t* port_types);
+static apx_error_t assign_type_index(apx_portInstance_t* port_instance, adt_ary_t* types, adt_hash_t* type_map, uint32_t* type_index);
+static apx_error_t write_header(apx_nodeInstance_t const* node_instance, uint32_t num_types, adt_bytearray_t* output);
+static apx_error_t write_port(apx_portInstance_t* port_instance, uint32_t type_index, adt_bytearray_t* output);
+static apx_error_t write_program(apx_program_t const* program, adt_bytearray_t* output);
+static apx_error_t write_uint(adt_bytearray_t* output, uint32_t value, uint8_t size);
+static apx_error_t write_string(adt_bytearray_t* output, char const* str);
+static apx_error_t read_string(apx_binaryDefinitionReader_t* self, char const** str);
+static apx_error_t read_bytes(apx_binaryDefinitionReader_t* self, uint8_t const** data, uint32_t size);
+static apx_error_t read_uint32(apx_binaryDefinitionReader_t* self, uint32_t* value);
+
+//////////////////////////////////////////////////////////////////////////////
+// PUBLIC VARIABLES
+//////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE VARIABLES
+//////////////////////////////////////////////////////////////////////////////
+static uint8_t const m_magic[APX_BINARY_DEFINITION_MAGIC_SIZE] = { 0x89u, 'A', 'P', 'X' };
+
+//////////////////////////////////////////////////////////////////////////////
+// PUBLIC FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+bool apx_binaryDefinition_is_binary(uint8_t const* data, apx_size_t size)
+{
+   if ( (data != NULL) && (size > 0u) )
+   {
+      apx_size_t const compare_size = (size < APX_BINARY_DEFINITION_MAGIC_SIZE) ? size : APX_BINARY_DEFINITION_MAGIC_SIZE;
+      return memcmp(data, m_magic, compare_size) == 0;
+   }
+   return false;
+}
+
+apx_error_t apx_binaryDefinition_write(apx_nodeInstance_t const* node_instance, adt_bytearray_t* output)
+{
+   if ( (node_instance != NULL) && (output != NULL) )
+   {
+      apx_size_t const num_provide_ports = apx_nodeInstance_get_num_provide_ports(node_instance);
+      apx_size_t const num_require_ports = apx_nodeInstance_get_num_require_ports(node_instance);
+      apx_size_t const num_ports = num_provide_ports + num_require_ports;
+      uint32_t* port_types = NULL;
+      adt_ary_t types;
+      apx_error_t result = APX_NO_ERROR;
+      if (num_ports > 0u)
+      {
+         port_types = (uint32_t*)malloc(num_ports * sizeof(uint32_t));
+         if (port_types == NULL)
+         {
+            return APX_MEM_ERROR;
+         }
+      }
+      adt_ary_create(&types, adt_str_vdelete);
+      result = create_type_table(node_instance, &types, port_types);
+      if (result == APX_NO_ERROR)
+      {
+         result = write_header(node_instance, (uint32_t)adt_ary_length(&types), output);
+      }
+      if (result == APX_NO_ERROR)
+      {
+         int32_t i;
+         int32_t const num_types = adt_ary_length(&types);
+         for (i = 0; (i < num_types) && (result == APX_NO_ERROR); i++)
+         {
+            result = write_string(output, adt_str_cstr((adt_str_t*)adt_ary_value(&types, i)));
+         }
+      }
+      if (result == APX_NO_ERROR)
+      {
+         apx_size_t const provide_port_init_data_size = apx_nodeInstance_get_provide_port_init_data_size(node_instance);
+         apx_size_t const require_port_init_data_size = apx_nodeInstance_get_require_port_init_data_size(node_instance);
+         if (provide_port_init_data_size > 0u)
+         {
+            result = convert_from_adt_to_apx_error(adt_bytearray_append(output,
+               apx_nodeInstance_get_provide_port_init_data(node_instance), (uint32_t)provide_port_init_data_size));
+         }
+         if ( (result == APX_NO_ERROR) && (require_port_init_data_size > 0u) )
+         {
+            result = convert_from_adt_to_apx_error(adt_bytearray_append(output,
+               apx_nodeInstance_get_require_port_init_data(node_instance), (uint32_t)require_port_init_data_size));
+         }
+      }
+      if (result == APX_NO_ERROR)
+      {
+         apx_size_t port_id;
+         for (port_id = 0u; (port_id < num_provide_ports) && (result == APX_NO_ERROR); port_id++)
+         {
+            result = write_port(apx_nodeInstance_get_provide_port(node_instance, port_id), port_types[port_id], output);
+         }
+         for (port_id = 0u; (port_id < num_require_ports) && (result == APX_NO_ERROR); port_id++)
+         {
+            result = write_port(apx_nodeInstance_get_require_port(node_instance, port_id), port_types[num_provide_ports + port_id], output);
+         }
+      }
+      adt_ary_destroy(&types);
+      if (port_types != NULL)
+      {
+         free(port_types);
+      }
+      return result;
+   }
+   return APX_INVALID_ARGUMENT_ERROR;
+}
+
+apx_error_t apx_binaryDefinitionReader_create(apx_binaryDefinitionReader_t* self, uint8_t const* data, apx_size_t size)
+{
+   if ( (self != NULL) && (data != NULL) )
+   {
+      apx_error_t result;
+      uint32_t i;
+      memset(self, 0, sizeof(apx_binaryDefinitionReader_t));
+      if (size < APX_BINARY_DEFINITION_HEADER_SIZE)
+      {
+         return APX_UNEXPECTED_END_ERROR;
+      }
+      if (memcmp(data, m_magic, APX_BINARY_DEFINITION_MAGIC_SIZE) != 0)
+      {
+         return APX_INVALID_HEADER_ERROR;
+      }
+      if (data[APX_BINARY_DEFINITION_MAGIC_SIZE] != APX_BINARY_DEFINITION_MAJOR_VERSION)
+      {
+         return APX_VERSION_ERROR;
+      }
+      self->next = data + APX_BINARY_DEFINITION_MAGIC_SIZE + 4u;
+      self->end = data + size;
+      self->source_digest = self->next;
+      self->next += RMF_SHA256_SIZE;
+      (void)read_uint32(self, &self->num_types);
+      (void)read_uint32(self, &self->num_provide_ports);
+      (void)read_uint32(self, &self->num_require_ports);
+      (void)read_uint32(self, &self->provide_port_init_data_size);
+      (void)read_uint32(self, &self->require_port_init_data_size);
+      result = read_string(self, &self->node_name);
+      if (result != APX_NO_ERROR)
+      {
+         return result;
+      }
+      //Guards against allocating memory for a type table that cannot possibly fit in the remaining data
+      if (self->num_types > ((uint32_t)(self->end - self->next) / MIN_STRING_SIZE))
+      {
+         return APX_UNEXPECTED_END_ERROR;
+      }
+      if (self->num_types > 0u)
+      {
+         self->types = (char const**)malloc(self->num_types * sizeof(char const*));
+         if (self->types == NULL)
+         {
+            return APX_MEM_ERROR;
+         }
+      }
+      for (i = 0u; i < self->num_types; i++)
+      {
+         result = read_string(self, &self->types[i]);
+         if (result != APX_NO_ERROR)
+         {
+            apx_binaryDefinitionReader_destroy(self);
+            return result;
+         }
+      }
+      result = read_bytes(self, &self->provide_port_init_data, self->provide_port_init_data_size);
+      if (result == APX_NO_ERROR)
+      {
+         result = read_bytes(self, &self->require_port_init_data, self->require_port_init_data_size);
+      }
+      if (result == APX_NO_ERROR)
+      {
+         //Same guard for the port instances created from the port table
+         uint64_t const num_ports = (uint64_t)self->num_provide_ports + (uint64_t)self->num_require_ports;
+         uint32_t const remaining_size = (uint32_t)(self->end - self->next);
+         if (num_ports > (uint64_t)(remaining_size / MIN_PORT_SIZE))
+         {
+            result = APX_UNEXPECTED_END_ERROR;
+         }
+         else if ( (num_ports == 0u) && (remaining_size > 0u) )
+         {
+            result = APX_STRAY_CHARACTERS_AFTER_PARSE_ERROR;
+         }
+      }
+      if (result != APX_NO_ERROR)
+      {
+         apx_binaryDefinitionReader_destroy(self);
+      }
+      return result;
+   }
+   return APX_INVALID_ARGUMENT_ERROR;
+}
+
+void apx_binaryDefinitionReader_destroy(apx_binaryDefinitionReader_t* self)
+{
+   if (self != NULL)
+   {
+      if (self->types != NULL)
+      {
+         free((void*)self->types);
+         self->types = NULL;
+      }
+   }
+}
+
+apx_error_t apx_binaryDefinitionReader_next_port(apx_binaryDefinitionReader_t* self, apx_binaryDefinitionPort_t* port)
+{
+   if ( (self != NULL) && (port != NULL) )
+   {
+      apx_error_t result;
+      uint32_t type_index = 0u;
+      uint8_t const* flags = NULL;
+      if (self->num_ports_read >= (self->num_provide_ports + self->num_require_ports))
+      {
+         return APX_INDEX_ERROR;
+      }
+      result = read_string(self, &port->name);
+      if (result == APX_NO_ERROR)
+      {
+         result = read_uint32(self, &type_index);
+      }
+      if (result == APX_NO_ERROR)
+      {
+         result = read_uint32(self, &port->min_update_interval);
+      }
+      if (result == APX_NO_ERROR)
+      {
+         result = read_bytes(self, &flags, UINT8_SIZE);
+      }
+      if (result == APX_NO_ERROR)
+      {
+         result = read_uint32(self, &port->pack_program_size);
+      }
+      if (result == APX_NO_ERROR)
+      {
+         result = read_bytes(self, &port->pack_program, port->pack_program_size);
+      }
+      if (result == APX_NO_ERROR)
+      {
+         result = read_uint32(self, &port->unpack_program_size);
+      }
+      if (result == APX_NO_ERROR)
+      {
+         result = read_bytes(self, &port->unpack_program, port->unpack_program_size);
+      }
+      if (result != APX_NO_ERROR)
+      {
+         return result;
+      }
+      if (type_index >= self->num_types)
+      {
+         return APX_INDEX_ERROR;
+      }
+      port->data_signature = self->types[type_index];
+      port->is_high_priority = ((*flags) & APX_BINARY_PORT_FLAG_HIGH_PRIORITY) != 0u;
+      self->num_ports_read++;
+      if ( (self->num_ports_read == (self->num_provide_ports + self->num_require_ports)) && (self->next != self->end) )
+      {
+         return APX_STRAY_CHARACTERS_AFTER_PARSE_ERROR;
+      }
+      return APX_NO_ERROR;
+   }
+   return APX_INVALID_ARGUMENT_ERROR;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Ports sharing the same data signature share one entry in the type table.
+ * port_types receives the type index of each provide port followed by each require port.
+ */
+static apx_error_t create_type_table(apx_nodeInstance_t const* node_instance, adt_ary_t* types, uint32_t* port_types)
+{
+   apx_size_t const num_provide_ports = apx_nodeInstance_get_num_provide_ports(node_instance);
+   apx_size_t const num_require_ports = apx_nodeInstance_get_num_require_ports(node_instance);
+   apx_size_t port_id;
+   apx_error_t result = APX_NO_ERROR;
+   adt_hash_t type_map; //Values are type index + 1, cast to void*
+   adt_hash_create(&type_map, NULL);
+   for (port_id = 0u; (port_id < num_provide_ports) && (result == APX_NO_ERROR); port_id++)
+   {
+      result = assign_type_index(apx_nodeInstance_get_provide_port(node_instance, port_id), types, &type_map, &port_types[port_id]);
+   }
+   for (port_id = 0u; (port_id < num_require_ports) && (result == APX_NO_ERROR); port_id++)
+   {
+      result = assign_type_index(apx_nodeInstance_get_require_port(node_instance, port_id), types, &type_map, &port_types[num_provide_ports + port_id]);
+   }
+   adt_hash_destroy(&type_map);
+   return result;
+}
+
+static apx_error_t assign_type_index(apx_portInstance_t* port_instance, adt_ary_t* types, adt_hash_t* type_map, uint32_t* type_index)
+{
+   apx_dataElement_t* data_element = apx_portInstance_get_effective_element(port_instance);
+   adt_str_t* data_signature;
+   void* value;
+   if (data_element == NULL)
+   {
+      return APX_NULL_PTR_ERROR;
+   }
+   //Not normalized, the server needs the length of dynamic arrays to check the programs against the signature
+   data_signature = apx_dataElement_to_string(data_element, false);
+   if (data_signature == NULL)
+   {
+      return APX_MEM_ERROR;
+   }
+   value = adt_hash_value(type_map, adt_str_cstr(data_signature));
+   if (value != NULL)
+   {
+      *type_index = (uint32_t)((uintptr_t)value - 1u);
+      adt_str_delete(data_signature);
+   }
+   else
+   {
+      apx_error_t result;
+      *type_index = (uint32_t)adt_ary_length(types);
+      result = convert_from_adt_to_apx_error(adt_hash_set(type_map, adt_str_cstr(data_signature), (void*)((uintptr_t)(*type_index) + 1u)));
+      if (result != APX_NO_ERROR)
+      {
+         adt_str_delete(data_signature);
+         return result;
+      }
+      result = convert_from_adt_to_apx_error(adt_ary_push(types, data_signature));
+      if (result != APX_NO_ERROR)
+      {
+         adt_str_delete(data_signature);
+      }
+      return result;
+   }
+   return APX_NO_ERROR;
+}
+
+static apx_error_t write_header(apx_nodeInstance_t const* node_instance, uint32_t num_types, adt_bytearray_t* output)
+{
+   uint8_t header[APX_BINARY_DEFINITION_HEADER_SIZE];
+   uint8_t* next = &header[0];
+   apx_error_t result;
+   memcpy(next, m_magic, APX_BINARY_DEFINITION_MAGIC_SIZE);
+   next += APX_BINARY_DEFINITION_MAGIC_SIZE;
+   *next++ = (uint8_t)APX_BINARY_DEFINITION_MAJOR_VERSION;
+   *next++ = (uint8_t)APX_BINARY_DEFINITION_MINOR_VERSION;
+   *next++ = 0u;
+   *next++ = 0u;
+   //The text definition remains the source of truth, its digest ties the binary to the text it was compiled from
+   sha256_calc(next, apx_nodeInstance_get_definition_data(node_instance), (size_t)apx_nodeInstance_get_definition_size(node_instance));
+   next += RMF_SHA256_SIZE;
+   packLE(next, num_types, (uint8_t)UINT32_SIZE);
+   next += UINT32_SIZE;
+   packLE(next, (uint32_t)apx_nodeInstance_get_num_provide_ports(node_instance), (uint8_t)UINT32_SIZE);
+   next += UINT32_SIZE;
+   packLE(next, (uint32_t)apx_nodeInstance_get_num_require_ports(node_instance), (uint8_t)UINT32_SIZE);
+   next += UINT32_SIZE;
+   packLE(next, (uint32_t)apx_nodeInstance_get_provide_port_init_data_size(node_instance), (uint8_t)UINT32_SIZE);
+   next += UINT32_SIZE;
+   packLE(next, (uint32_t)apx_nodeInstance_get_require_port_init_data_size(node_instance), (uint8_t)UINT32_SIZE);
+   next += UINT32_SIZE;
+   assert(next == &header[APX_BINARY_DEFINITION_HEADER_SIZE]);
+   result = convert_from_adt_to_apx_error(adt_bytearray_append(output, &header[0], (uint32_t)sizeof(header)));
+   if (result == APX_NO_ERROR)
+   {
+      result = write_string(output, apx_nodeInstance_get_name(node_instance));
+   }
+   return result;
+}
+
+static apx_error_t write_port(apx_portInstance_t* port_instance, uint32_t type_index, adt_bytearray_t* output)
+{
+   uint8_t const flags = apx_portInstance_is_high_priority(port_instance) ? APX_BINARY_PORT_FLAG_HIGH_PRIORITY : 0u;
+   apx_error_t result = write_string(output, apx_portInstance_name(port_instance));
+   if (result == APX_NO_ERROR)
+   {
+      result = write_uint(output, type_index, (uint8_t)UINT32_SIZE);
+   }
+   if (result == APX_NO_ERROR)
+   {
+      result = write_uint(output, apx_portInstance_min_update_interval(port_instance), (uint8_t)UINT32_SIZE);
+   }
+   if (result == APX_NO_ERROR)
+   {
+      result = write_uint(output, flags, (uint8_t)UINT8_SIZE);
+   }
+   if (result == APX_NO_ERROR)
+   {
+      result = write_program(apx_portInstance_pack_program(port_instance), output);
+   }
+   if (result == APX_NO_ERROR)
+   {
+      result = write_program(apx_portInstance_unpack_program(port_instance), output);
+   }
+   return result;
+}
+
+static apx_error_t write_program(apx_program_t const* program, adt_bytearray_t* output)
+{
+   uint32_t const program_size = (program != NULL) ? adt_bytearray_length(program) : 0u;
+   apx_error_t result = write_uint(output, program_size, (uint8_t)UINT32_SIZE);
+   if ( (result == APX_NO_ERROR) && (program_size > 0u) )
+   {
+      result = convert_from_adt_to_apx_error(adt_bytearray_append(output, adt_bytearray_const_data(program), program_size));
+   }
+   return result;
+}
+
+static apx_error_t write_uint(adt_bytearray_t* output, uint32_t value, uint8_t size)
+{
+   uint8_t buf[UINT32_SIZE];
+   packLE(&buf[0], value, size);
+   return convert_from_adt_to_apx_error(adt_bytearray_append(output, &buf[0], (uint32_t)size));
+}
+
+static apx_error_t write_string(adt_bytearray_t* output, char const* str)
+{
+   size_t const length = (str != NULL) ? strlen(str) : 0u;
+   apx_error_t result;
+   if (length > MAX_STRING_LENGTH)
+   {
+      return APX_NAME_TOO_LONG_ERROR;
+   }
+   result = write_uint(output, (uint32_t)length, (uint8_t)UINT16_SIZE);
+   if ( (result == APX_NO_ERROR) && (length > 0u) )
+   {
+      result = convert_from_adt_to_apx_error(adt_bytearray_append(output, (uint8_t const*)str, (uint32_t)length));
+   }
+   if (result == APX_NO_ERROR)
+   {
+      result = convert_from_adt_to_apx_error(adt_bytearray_push(output, 0u));
+   }
+   return result;
+}
+
+static apx_error_t read_string(apx_binaryDefinitionReader_t* self, char const** str)
+{
+   uint8_t const* length_data = NULL;
+   uint8_t const* data = NULL;
+   uint32_t length;
+   apx_error_t result = read_bytes(self, &length_data, UINT16_SIZE);
+   if (result != APX_NO_ERROR)
+   {
+      return result;
+   }
+   length = unpackLE(length_data, (uint8_t)UINT16_SIZE);
+   result = read_bytes(self, &data, length + 1u);
+   if (result != APX_NO_ERROR)
+   {
+      return result;
+   }
+   if (data[length] != 0u)
+   {
+      return APX_INVALID_FILE_ERROR;
+   }
+   *str = (char const*)data;
+   return APX_NO_ERROR;
+}
+
+static apx_error_t read_bytes(apx_binaryDefinitionReader_t* self, uint8_t const** data, uint32_t size)
+{
+   if (size > (uint32_t)(self->end - self->next))
+   {
+      return APX_UNEXPECTED_END_ERROR;
+   }
+   *data = (size > 0u) ? self->next : NULL;
+   self->next += size;
+   return APX_NO_ERROR;
+}
+
+static apx_error_t read_uint32(apx_binaryDefinitionReader_t* self, uint32_t* value)
+{
+   uint8_t const* data = NULL;
+   apx_error_t result = read_bytes(self, &data, UINT32_SIZE);
+   if (result == APX_NO_ERROR)
+   {
+      *value = unpackLE(data, (uint8_t)UINT32_SIZE);
+   }
+   return result;
+}
@@ -0,0 +1,267 @@
+/*****************************************************************************
+* \file      capabilities.c
+* \author    Conny Gustafsson
+* \date      2026-10-18
+* \brief     Optional protocol features negotiated in the RMF greeting
+*
+* Copyright (c) 2026 Conny Gustafsson
+* Permission is hereby granted, free of charge, to any person obtaining a copy of
+* this software and associated documentation files (the "Software"), to deal in
+* the Software without restriction, including without limitation the rights to
+* use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+* the Software, and to permit persons to whom the Software is furnished to do so,
+* subject to the following conditions:
+
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+* FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+* COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+* IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+* CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+******************************************************************************/
+//////////////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////////////
+#include <stdio.h>
+#include <string.h>
+#include "apx/capabilities.h"
+#include "apx/remotefile.h"
+#ifdef MEM_LEAK_CHECK
+#include "CMemLeak.h"
+#endif
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE CONSTANTS AND DATA TYPES
+//////////////////////////////////////////////////////////////////////////////
+#define NUM_FEATURE_NAMES 5u
+#define MAX_LINE_LEN 127
+
+typedef struct feature_name_tag
+{
+   uint32_t flag;
+   char const* name;
+} feature_name_t;
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////////////
+static char const* match_prefix(char const* begin, char const* end, char const* prefix);
+static bool parse_uint32(char const* begin, char const* end, uint32_t* value);
+static uint32_t parse_feature_names(char const* begin, char const* end);
+static uint32_t min_limit(uint32_t a, uint32_t b);
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE VARIABLES
+//////////////////////////////////////////////////////////////////////////////
+static feature_name_t const m_feature_names[NUM_FEATURE_NAMES] =
+{
+   {APX_CAPABILITY_COMPRESSION, "lz4"},
+   {APX_CAPABILITY_DYNAMIC_FILE, "dynamic-file"},
+   {APX_CAPABILITY_STREAM_FILE, "stream-file"},
+   {APX_CAPABILITY_PIPELINED_OPEN, "pipelined-open"},
+   {APX_CAPABILITY_PARTIAL_WRITE, "partial-write"}
+};
+
+//////////////////////////////////////////////////////////////////////////////
+// PUBLIC FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+void apx_capabilities_create(apx_capabilities_t* self, uint32_t flags, uint32_t max_message_size, uint32_t receive_buffer_size)
+{
+   if (self != NULL)
+   {
+      self->flags = flags;
+      self->max_message_size = max_message_size;
+      self->receive_buffer_size = receive_buffer_size;
+      self->is_announced = false;
+   }
+}
+
+bool apx_capabilities_has(apx_capabilities_t const* self, uint32_t flags)
+{
+   if (self != NULL)
+   {
+      return (self->flags & flags) == flags;
+   }
+   return false;
+}
+
+void apx_capabilities_agree(apx_capabilities_t* self, apx_capabilities_t const* local, apx_capabilities_t const* peer)
+{
+   if ( (self != NULL) && (local != NULL) && (peer != NULL) )
+   {
+      if (peer->is_announced)
+      {
+         self->flags = local->flags & peer->flags;
+         self->max_message_size = min_limit(local->max_message_size, peer->max_message_size);
+         self->receive_buffer_size = peer->receive_buffer_size;
+         self->is_announced = true;
+      }
+      else
+      {
+         apx_capabilities_create(self, 0u, 0u, 0u);
+      }
+   }
+}
+
+int32_t apx_capabilities_write_header(apx_capabilities_t const* self, char* buf, int32_t buf_size)
+{
+   if ( (self != NULL) && (buf != NULL) && (buf_size > 0) )
+   {
+      char tmp[MAX_LINE_LEN * 3 + 1];
+      char* p = &tmp[0];
+      char const* separator = "";
+      uint32_t i;
+      int32_t length;
+      //The line is sent even when no flags are set, it tells the peer that we understand the negotiation
+      p += sprintf(p, "%s", RMF_CAPABILITIES_HDR);
+      for (i = 0u; i < NUM_FEATURE_NAMES; i++)
+      {
+         if ((self->flags & m_feature_names[i].flag) != 0u)
+         {
+            p += sprintf(p, "%s%s", separator, m_feature_names[i].name);
+            separator = ",";
+         }
+      }
+      *p++ = '\n';
+      if (self->max_message_size > 0u)
+      {
+         p += sprintf(p, "%s%u\n", RMF_MAX_MESSAGE_SIZE_HDR, (unsigned int)self->max_message_size);
+      }
+      if (self->receive_buffer_size > 0u)
+      {
+         p += sprintf(p, "%s%u\n", RMF_RECEIVE_BUFFER_SIZE_HDR, (unsigned int)self->receive_buffer_size);
+      }
+      length = (int32_t)(p - tmp);
+      if (length < buf_size)
+      {
+         memcpy(buf, tmp, (size_t)length);
+         buf[length] = '\0';
+         return length;
+      }
+   }
+   return 0;
+}
+
+bool apx_capabilities_parse_header_line(apx_capabilities_t* self, char const* begin, char const* end)
+{
+   if ( (self != NULL) && (begin != NULL) && (end != NULL) && (begin <= end) )
+   {
+      char const* value;
+      uint32_t number = 0u;
+      value = match_prefix(begin, end, RMF_CAPABILITIES_HDR);
+      if (value != NULL)
+      {
+         self->flags = parse_feature_names(value, end);
+         self->is_announced = true;
+         return true;
+      }
+      value = match_prefix(begin, end, RMF_MAX_MESSAGE_SIZE_HDR);
+      if (value != NULL)
+      {
+         if (parse_uint32(value, end, &number))
+         {
+            self->max_message_size = number;
+            self->is_announced = true;
+         }
+         return true;
+      }
+      value = match_prefix(begin, end, RMF_RECEIVE_BUFFER_SIZE_HDR);
+      if (value != NULL)
+      {
+         if (parse_uint32(value, end, &number))
+         {
+            self->receive_buffer_size = number;
+            self->is_announced = true;
+         }
+         return true;
+      }
+   }
+   return false;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+static char const* match_prefix(char const* begin, char const* end, char const* prefix)
+{
+   size_t const prefix_len = strlen(prefix);
+   if ( ((size_t)(end - begin) >= prefix_len) && (memcmp(begin, prefix, prefix_len) == 0) )
+   {
+      return begin + prefix_len;
+   }
+   return NULL;
+}
+
+/**
+ * Accepts decimal numbers only. Values that do not fit in 32 bits are rejected.
+ */
+static bool parse_uint32(char const* begin, char const* end, uint32_t* value)
+{
+   uint64_t result = 0u;
+   if (begin == end)
+   {
+      return false;
+   }
+   while (begin < end)
+   {
+      if ( (*begin < '0') || (*begin > '9') )
+      {
+         return false;
+      }
+      result = result * 10u + (uint64_t)(*begin - '0');
+      if (result > UINT32_MAX)
+      {
+         return false;
+      }
+      begin++;
+   }
+   *value = (uint32_t)result;
+   return true;
+}
+
+static uint32_t parse_feature_names(char const* begin, char const* end)
+{
+   uint32_t flags = 0u;
+   while (begin < end)
+   {
+      char const* name_end = (char const*)memchr(begin, ',', (size_t)(end - begin));
+      uint32_t i;
+      if (name_end == NULL)
+      {
+         name_end = end;
+      }
+      for (i = 0u; i < NUM_FEATURE_NAMES; i++)
+      {
+         size_t const name_len = strlen(m_feature_names[i].name);
+         if ( ((size_t)(name_end - begin) == name_len) && (memcmp(begin, m_feature_names[i].name, name_len) == 0) )
+         {
+            flags |= m_feature_names[i].flag;
+            break;
+         }
+      }
+      begin = (name_end < end) ? name_end + 1 : end;
+   }
+   return flags;
+}
+
+/**
+ * Smaller of two limits where 0 means unlimited.
+ */
+static uint32_t min_limit(uint32_t a, uint32_t b)
+{
+   if (a == 0u)
+   {
+      return b;
+   }
+   if (b == 0u)
+   {
+      return a;
+   }
+   return (a < b) ? a : b;
+}
@@ -66,6 +66,10 @@ static void apx_client_trigger_connected_event_on_listeners(apx_client_t *self,
 static void apx_client_trigger_disconnected_event_on_listeners(apx_client_t *self, apx_clientConnection_t *connection);
 static void apx_client_trigger_port_write_event_on_listeners(apx_client_t* self, apx_clientConnection_t* connection, apx_portInstance_t* port_instance, uint8_t const* data, apx_size_t size);
 static void apx_client_attach_local_nodes_to_connection(apx_client_t *self);
+static apx_error_t apx_client_attach_node_to_connection(apx_client_t* self, apx_nodeInstance_t* node_instance);
+static apx_error_t apx_client_publish_local_file(apx_fileManager_t* file_manager, char const* node_name, char const* extension);
+static bool apx_client_is_partial_write_agreed(apx_client_t* self);
+static apx_error_t apx_client_write_complete_port_value(apx_portInstance_t* port_instance, uint32_t offset, const uint8_t* data, uint32_t size);
 
 //////////////////////////////////////////////////////////////////////////////
 // GLOBAL VARIABLES
@@ -91,6 +95,8 @@ apx_error_t apx_client_create(apx_client_t *self)
       self->connection = (apx_clientConnection_t*) NULL;
       self->vm = (apx_vm_t*) NULL;
       self->node_manager = apx_nodeManager_new(APX_CLIENT_MODE);
+      self->compression_threshold = 0u;
+      self->is_pipelined_open = false;
       self->is_connected = false;
       MUTEX_INIT(self->lock);
       MUTEX_INIT(self->event_listener_lock);
@@ -319,6 +325,8 @@ void apx_client_attach_connection(apx_client_t *self, apx_clientConnection_t *co
    {
       self->connection = connection;
       apx_clientConnection_set_client(connection, self);
+      apx_clientConnection_set_compression_threshold(connection, self->compression_threshold);
+      apx_clientConnection_set_pipelined_open(connection, self->is_pipelined_open);
       apx_clientConnection_attach_node_manager(connection, self->node_manager);
       apx_client_attach_local_nodes_to_connection(self); //TODO: This should not be necessary as an explicit step.
                                                          // Merge functionality with call to to apx_clientConnection_attach_node_manager
@@ -334,11 +342,68 @@ apx_clientConnection_t *apx_client_get_connection(apx_client_t *self)
    return (apx_clientConnection_t*) 0;
 }
 
+/**
+ * Offers message compression to the server in the greeting. Messages of at least threshold bytes are compressed
+ * once the server has accepted. Use APX_COMPRESSION_DEFAULT_THRESHOLD unless the link has other needs.
+ * Must be called before connecting. 0 disables compression.
+ */
+void apx_client_enable_compression(apx_client_t *self, uint32_t threshold)
+{
+   if (self != NULL)
+   {
+      if ( (threshold > 0u) && (threshold < APX_COMPRESSION_MIN_THRESHOLD) )
+      {
+         threshold = APX_COMPRESSION_MIN_THRESHOLD;
+      }
+      self->compression_threshold = threshold;
+      if (self->connection != NULL)
+      {
+         apx_clientConnection_set_compression_threshold(self->connection, threshold);
+      }
+   }
+}
+
+/**
+ * Offers a pipelined handshake in the greeting. Once the server has accepted, definition and provide port data
+ * are sent right after being published instead of waiting for the server to open each file.
+ * Must be called before connecting.
+ */
+void apx_client_enable_pipelined_open(apx_client_t *self, bool enabled)
+{
+   if (self != NULL)
+   {
+      self->is_pipelined_open = enabled;
+      if (self->connection != NULL)
+      {
+         apx_clientConnection_set_pipelined_open(self->connection, enabled);
+      }
+   }
+}
+
 apx_error_t apx_client_build_node(apx_client_t *self, const char *definition_text)
 {
    if (self != NULL && definition_text != 0)
    {
-      return apx_nodeManager_build_node(self->node_manager, definition_text);
+      apx_error_t result = apx_nodeManager_build_node(self->node_manager, definition_text);
+      if ( (result == APX_NO_ERROR) && (self->connection != NULL) )
+      {
+         result = apx_client_attach_node_to_connection(self, apx_nodeManager_get_last_attached(self->node_manager));
+      }
+      return result;
+   }
+   return APX_INVALID_ARGUMENT_ERROR;
+}
+
+apx_error_t apx_client_build_node_from_binary(apx_client_t *self, const uint8_t *definition_data, uint32_t definition_size)
+{
+   if (self != NULL && definition_data != 0)
+   {
+      apx_error_t result = apx_nodeManager_build_node_from_binary(self->node_manager, definition_data, (apx_size_t)definition_size);
+      if ( (result == APX_NO_ERROR) && (self->connection != NULL) )
+      {
+         result = apx_client_attach_node_to_connection(self, apx_nodeManager_get_last_attached(self->node_manager));
+      }
+      return result;
    }
    return APX_INVALID_ARGUMENT_ERROR;
 }
@@ -509,6 +574,37 @@ apx_error_t apx_client_write_port_data(apx_client_t* self, apx_portInstance_t* p
    return APX_INVALID_ARGUMENT_ERROR;
 }
 
+/**
+ * Writes already packed bytes to a byte range of a provide port, offset is relative to the start of the port data.
+ * Only the written range is sent and routed, which makes it cheap to update a single element of a large record or array.
+ */
+apx_error_t apx_client_write_port_data_range(apx_client_t* self, apx_portInstance_t* port_instance, uint32_t offset, const uint8_t* data, uint32_t size)
+{
+   if ((self != NULL) && (port_instance != NULL) && (data != NULL) && (size > 0u))
+   {
+      uint32_t const data_size = apx_portInstance_data_size(port_instance);
+      if (apx_portInstance_port_type(port_instance) != APX_PROVIDE_PORT)
+      {
+         return APX_INVALID_PORT_HANDLE_ERROR;
+      }
+      if (apx_portInstance_queue_length(port_instance) > 0u)
+      {
+         return APX_UNSUPPORTED_ERROR;
+      }
+      if ( (offset >= data_size) || (size > (data_size - offset)) )
+      {
+         return APX_VALUE_LENGTH_ERROR;
+      }
+      //A range at the start of a dynamic array would be taken as a new (shorter) array value
+      if ( !apx_client_is_partial_write_agreed(self) || apx_portInstance_is_dynamic_array(port_instance) )
+      {
+         return apx_client_write_complete_port_value(port_instance, offset, data, size);
+      }
+      return apx_nodeInstance_write_provide_port_data(apx_portInstance_parent(port_instance), apx_portInstance_data_offset(port_instance) + offset, data, size);
+   }
+   return APX_INVALID_ARGUMENT_ERROR;
+}
+
 apx_error_t apx_client_read_port_data(apx_client_t* self, apx_portInstance_t* port_instance, dtl_dv_t** dv)
 {
    if ((self != NULL) && (port_instance != NULL) && (dv != NULL))
@@ -704,3 +800,106 @@ static void apx_client_attach_local_nodes_to_connection(apx_client_t *self)
       }
    }
 }
+
+/**
+ * Attaches a node that was built after the connection was attached.
+ * When the greeting has already been accepted the node files are published right away,
+ * otherwise they are published together with all other local files once the greeting is accepted.
+ */
+static apx_error_t apx_client_attach_node_to_connection(apx_client_t* self, apx_nodeInstance_t* node_instance)
+{
+   apx_error_t result;
+   assert(node_instance != NULL);
+   result = apx_clientConnection_attach_node_instance(self->connection, node_instance);
+   if ( (result == APX_NO_ERROR) && self->connection->is_greeting_accepted)
+   {
+      apx_fileManager_t* file_manager = &self->connection->base.file_manager;
+      char const* node_name = apx_nodeInstance_get_name(node_instance);
+      result = apx_client_publish_local_file(file_manager, node_name, apx_nodeInstance_get_definition_file_extension(node_instance));
+      if ( (result == APX_NO_ERROR) && apx_nodeInstance_has_provide_port_data(node_instance))
+      {
+         result = apx_client_publish_local_file(file_manager, node_name, APX_PROVIDE_PORT_DATA_EXT);
+      }
+   }
+   return result;
+}
+
+static bool apx_client_is_partial_write_agreed(apx_client_t* self)
+{
+   apx_capabilities_t capabilities;
+   apx_fileManager_t* file_manager;
+   if (self->connection == NULL)
+   {
+      return false;
+   }
+   file_manager = apx_clientConnection_get_file_manager(self->connection);
+   if (file_manager == NULL)
+   {
+      return false;
+   }
+   apx_fileManager_get_capabilities(file_manager, &capabilities);
+   return apx_capabilities_has(&capabilities, APX_CAPABILITY_PARTIAL_WRITE);
+}
+
+/**
+ * Merges the byte range into the current port value and writes the complete value.
+ */
+static apx_error_t apx_client_write_complete_port_value(apx_portInstance_t* port_instance, uint32_t offset, const uint8_t* data, uint32_t size)
+{
+   uint8_t stack_buffer[MAX_STACK_BUFFER_SIZE];
+   apx_error_t result;
+   uint8_t* value_buffer;
+   apx_nodeInstance_t* parent = apx_portInstance_parent(port_instance);
+   apx_nodeData_t* node_data = apx_nodeInstance_get_node_data(parent);
+   uint32_t const data_size = apx_portInstance_data_size(port_instance);
+   uint32_t const port_offset = apx_portInstance_data_offset(port_instance);
+   if (node_data == NULL)
+   {
+      return APX_NULL_PTR_ERROR;
+   }
+   if (data_size > MAX_STACK_BUFFER_SIZE)
+   {
+      value_buffer = (uint8_t*)malloc(data_size);
+      if (value_buffer == NULL)
+      {
+         return APX_MEM_ERROR;
+      }
+   }
+   else
+   {
+      value_buffer = &stack_buffer[0];
+   }
+   result = apx_nodeData_read_provide_port_data(node_data, port_offset, value_buffer, data_size);
+   if (result == APX_NO_ERROR)
+   {
+      memcpy(&value_buffer[offset], data, size);
+      result = apx_nodeInstance_write_provide_port_data(parent, port_offset, value_buffer, data_size);
+   }
+   if (value_buffer != &stack_buffer[0])
+   {
+      free(value_buffer);
+   }
+   return result;
+}
+
+static apx_error_t apx_client_publish_local_file(apx_fileManager_t* file_manager, char const* node_name, char const* extension)
+{
+   apx_error_t result = APX_FILE_NOT_FOUND_ERROR;
+   apx_file_t* file;
+   size_t const name_size = strlen(node_name);
+   size_t const extension_size = strlen(extension);
+   char* file_name = (char*)malloc(name_size + extension_size + 1u);
+   if (file_name == NULL)
+   {
+      return APX_MEM_ERROR;
+   }
+   memcpy(file_name, node_name, name_size);
+   memcpy(file_name + name_size, extension, extension_size + 1u);
+   file = apx_fileManager_find_local_file_by_name(file_manager, file_name);
+   if (file != NULL)
+   {
+      result = apx_fileManager_publish_local_file(file_manager, apx_file_get_file_info(file));
+   }
+   free(file_name);
+   return result;
+}
@@ -55,7 +55,9 @@ static apx_error_t remote_file_published_notification(apx_clientConnection_t* se
 static apx_error_t process_new_require_port_data_file(apx_clientConnection_t* self, apx_file_t* file);
 static apx_error_t remote_file_write_notification(apx_clientConnection_t* self, apx_file_t* file, uint32_t offset, uint8_t const* data, apx_size_t size);
 static uint8_t const* parse_message(apx_clientConnection_t* self, uint8_t const* begin, uint8_t const* end, apx_error_t* error_code);
-static bool is_greeting_accepted(uint8_t const* msg_data, apx_size_t msg_size, apx_error_t* error_code);
+static bool is_greeting_accepted(uint8_t const* msg_data, apx_size_t msg_size, uint8_t const** header_lines, apx_error_t* error_code);
+static void process_acknowledge_header_lines(apx_clientConnection_t* self, uint8_t const* begin, uint8_t const* end);
+static void get_local_capabilities(apx_clientConnection_t* self, apx_capabilities_t* capabilities);
 
 //////////////////////////////////////////////////////////////////////////////
 // PRIVATE VARIABLES
@@ -79,6 +81,8 @@ apx_error_t apx_clientConnection_create(apx_clientConnection_t* self, apx_connec
       self->is_greeting_accepted = false;
       self->client = NULL;
       self->last_error = APX_NO_ERROR;
+      self->compression_threshold = 0u;
+      self->is_pipelined_open = false;
       //apx_connectionBase_setEventHandler(&self->base, apx_clientConnection_defaultEventHandler, (void*) self);
       return error_code;
    }
@@ -204,6 +208,28 @@ void apx_clientConnection_set_client(apx_clientConnection_t* self, struct apx_cl
    }
 }
 
+/**
+ * Compression is offered in the next greeting when threshold is non-zero. It is only used if the server accepts.
+ */
+void apx_clientConnection_set_compression_threshold(apx_clientConnection_t* self, uint32_t threshold)
+{
+   if (self != NULL)
+   {
+      self->compression_threshold = threshold;
+   }
+}
+
+/**
+ * Pipelined open is offered in the next greeting when enabled. It is only used if the server accepts.
+ */
+void apx_clientConnection_set_pipelined_open(apx_clientConnection_t* self, bool enabled)
+{
+   if (self != NULL)
+   {
+      self->is_pipelined_open = enabled;
+   }
+}
+
 int apx_clientConnection_on_data_received(apx_clientConnection_t* self, uint8_t const* data, apx_size_t data_size, apx_size_t* parse_len)
 {
    if ( (self != NULL) && (data != NULL) && (data_size > 0u) && (parse_len != NULL))
@@ -295,11 +321,18 @@ static void send_greeting_header(apx_clientConnection_t* self)
    int32_t greeting_size;
    apx_connectionInterface_t const* connection;
    int num_header_format = 32;
+   apx_capabilities_t local_capabilities;
    char greeting[RMF_GREETING_MAX_LEN];
    char* p = &greeting[0];
    strcpy(greeting, RMF_GREETING_START);
    p += strlen(greeting);
-   p += sprintf(p, "%s%d\n\n", RMF_NUMHEADER_FORMAT_HDR, num_header_format);
+   p += sprintf(p, "%s%d\n", RMF_NUMHEADER_FORMAT_HDR, num_header_format);
+   get_local_capabilities(self, &local_capabilities);
+   p += apx_capabilities_write_header(&local_capabilities, p, (int32_t)(sizeof(greeting) - (p - greeting)) - 2);
+   //Leave room for the empty line that ends the header
+   p += apx_connectionBase_greeting_header_write(&self->base, p, (int32_t)(sizeof(greeting) - (p - greeting)) - 2);
+   *p++ = '\n';
+   *p = '\0';
    greeting_size = (int32_t)(p - greeting);
    connection = apx_connectionBase_get_connection(&self->base);
    if (connection != NULL)
@@ -401,8 +434,10 @@ static uint8_t const* parse_message(apx_clientConnection_t* self, uint8_t const*
             }
             else
             {
-               if (is_greeting_accepted(msg_data, msg_size, error_code))
+               uint8_t const* header_lines = NULL;
+               if (is_greeting_accepted(msg_data, msg_size, &header_lines, error_code))
                {
+                  process_acknowledge_header_lines(self, header_lines, msg_end);
                   apx_clientConnection_greeting_header_accepted_notification(self);
                }
                else
@@ -426,7 +461,7 @@ static uint8_t const* parse_message(apx_clientConnection_t* self, uint8_t const*
    return msg_end;
 }
 
-static bool is_greeting_accepted(uint8_t const* msg_data, apx_size_t msg_size, apx_error_t* error_code)
+static bool is_greeting_accepted(uint8_t const* msg_data, apx_size_t msg_size, uint8_t const** header_lines, apx_error_t* error_code)
 {
    uint32_t address;
    bool more_bit = false;
@@ -438,6 +473,7 @@ static bool is_greeting_accepted(uint8_t const* msg_data, apx_size_t msg_size, a
       apx_size_t decode_size = rmf_decode_cmd_type(msg_data + header_size, msg_end, &cmd_type);
       if ((decode_size == RMF_CMD_TYPE_SIZE) && (cmd_type ==RMF_CMD_ACK_MSG))
       {
+         *header_lines = msg_data + header_size + decode_size;
          return true;
       }
    }
@@ -448,3 +484,42 @@ static bool is_greeting_accepted(uint8_t const* msg_data, apx_size_t msg_size, a
    return false;
 }
 
+/**
+ * Newer servers append header lines to the greeting acknowledge, telling which capabilities were agreed.
+ * Nothing is agreed when they are missing.
+ */
+static void process_acknowledge_header_lines(apx_clientConnection_t* self, uint8_t const* begin, uint8_t const* end)
+{
+   apx_capabilities_t local_capabilities;
+   apx_capabilities_t peer_capabilities;
+   apx_capabilities_t capabilities;
+   apx_capabilities_create(&peer_capabilities, 0u, 0u, 0u);
+   while (begin < end)
+   {
+      uint8_t const* line_end = (uint8_t const*)memchr(begin, '\n', (size_t)(end - begin));
+      if (line_end == NULL)
+      {
+         break;
+      }
+      (void)apx_capabilities_parse_header_line(&peer_capabilities, (char const*)begin, (char const*)line_end);
+      begin = line_end + 1;
+   }
+   get_local_capabilities(self, &local_capabilities);
+   apx_fileManager_set_capabilities(&self->base.file_manager, &local_capabilities, &peer_capabilities);
+   apx_fileManager_get_capabilities(&self->base.file_manager, &capabilities);
+   apx_fileManager_set_compression_threshold(&self->base.file_manager, apx_capabilities_has(&capabilities, APX_CAPABILITY_COMPRESSION) ? self->compression_threshold : 0u);
+}
+
+static void get_local_capabilities(apx_clientConnection_t* self, apx_capabilities_t* capabilities)
+{
+   apx_connectionBase_get_local_capabilities(&self->base, capabilities);
+   if (self->compression_threshold > 0u)
+   {
+      capabilities->flags |= APX_CAPABILITY_COMPRESSION;
+   }
+   if (self->is_pipelined_open)
+   {
+      capabilities->flags |= APX_CAPABILITY_PIPELINED_OPEN;
+   }
+}
+
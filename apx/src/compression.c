@@ -0,0 +1,354 @@
+/*****************************************************************************
+* \file      compression.c
+* \author    Conny Gustafsson
+* \date      2026-10-18
+* \brief     Fast LZ4 block compression of RMF messages
+*
+* Copyright (c) 2026 Conny Gustafsson
+* Permission is hereby granted, free of charge, to any person obtaining a copy of
+* this software and associated documentation files (the "Software"), to deal in
+* the Software without restriction, including without limitation the rights to
+* use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+* the Software, and to permit persons to whom the Software is furnished to do so,
+* subject to the following conditions:
+
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+* FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+* COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+* IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+* CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+******************************************************************************/
+//////////////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////////////
+#include <stddef.h>
+#include <string.h>
+#include "apx/compression.h"
+#include "apx/util.h"
+#ifdef MEM_LEAK_CHECK
+#include "CMemLeak.h"
+#endif
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE CONSTANTS AND DATA TYPES
+//////////////////////////////////////////////////////////////////////////////
+//LZ4 block format
+#define MIN_MATCH 4u
+#define LAST_LITERALS 5u //last 5 bytes of a block are always literals
+#define MATCH_FIND_LIMIT 12u //last match must start at least 12 bytes before end of block
+#define MAX_OFFSET 65535u
+#define RUN_MASK 15u
+#define ML_MASK 15u
+#define HASH_LOG 12u
+#define HASH_SIZE (1u << HASH_LOG)
+#define SKIP_TRIGGER 6u //search step grows by one for every 64 bytes without a match
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////////////
+static uint32_t read_u32(uint8_t const* p);
+static uint32_t hash_sequence(uint32_t sequence);
+static uint8_t* write_length(uint8_t* op, uint8_t const* op_end, apx_size_t length);
+static uint8_t* write_sequence(uint8_t* op, uint8_t const* op_end, uint8_t const* literals, apx_size_t num_literals, apx_size_t offset, apx_size_t match_length);
+static uint8_t const* read_length(uint8_t const* ip, uint8_t const* ip_end, apx_size_t* length);
+static apx_error_t decompress_block(uint8_t* dest, apx_size_t dest_size, uint8_t const* src, apx_size_t src_size);
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE VARIABLES
+//////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////
+// PUBLIC FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+apx_size_t apx_compression_compress(uint8_t* dest, apx_size_t dest_size, uint8_t const* src, apx_size_t src_size, apx_compressionStats_t* stats)
+{
+   uint32_t table[HASH_SIZE]; //position of last seen 4-byte sequence for each hash value
+   uint64_t start_time;
+   uint8_t* op;
+   uint8_t const* op_end;
+   apx_size_t ip = 0u;
+   apx_size_t anchor = 0u;
+   apx_size_t result = 0u;
+   if ( (dest == NULL) || (src == NULL) )
+   {
+      return 0u;
+   }
+   start_time = (stats != NULL) ? apx_time_monotonic_us() : 0u;
+   op = dest;
+   op_end = dest + dest_size;
+   memset(table, 0, sizeof(table));
+   if (src_size > MATCH_FIND_LIMIT)
+   {
+      apx_size_t const match_limit = src_size - MATCH_FIND_LIMIT;
+      apx_size_t const match_end_limit = src_size - LAST_LITERALS;
+      while ( (ip < match_limit) && (op != NULL) )
+      {
+         uint32_t const sequence = read_u32(src + ip);
+         uint32_t const hash = hash_sequence(sequence);
+         apx_size_t ref = table[hash];
+         table[hash] = (uint32_t)ip;
+         if ( (ref < ip) && ((ip - ref) <= MAX_OFFSET) && (read_u32(src + ref) == sequence) )
+         {
+            apx_size_t match_length = MIN_MATCH;
+            while ( ((ip + match_length) < match_end_limit) && (src[ref + match_length] == src[ip + match_length]) )
+            {
+               match_length++;
+            }
+            while ( (ip > anchor) && (ref > 0u) && (src[ip - 1u] == src[ref - 1u]) )
+            {
+               ip--;
+               ref--;
+               match_length++;
+            }
+            op = write_sequence(op, op_end, src + anchor, ip - anchor, ip - ref, match_length);
+            ip += match_length;
+            anchor = ip;
+         }
+         else
+         {
+            ip += 1u + ((ip - anchor) >> SKIP_TRIGGER);
+         }
+      }
+   }
+   if (op != NULL)
+   {
+      op = write_sequence(op, op_end, src + anchor, src_size - anchor, 0u, 0u);
+   }
+   if (op != NULL)
+   {
+      result = (apx_size_t)(op - dest);
+   }
+   if (stats != NULL)
+   {
+      stats->bytes_before_compression += src_size;
+      if (result > 0u)
+      {
+         stats->num_compressed++;
+         stats->bytes_after_compression += result;
+      }
+      else
+      {
+         stats->num_incompressible++;
+         stats->bytes_after_compression += src_size;
+      }
+      stats->compress_time_us += apx_time_monotonic_us() - start_time;
+   }
+   return result;
+}
+
+apx_error_t apx_compression_decompress(uint8_t* dest, apx_size_t dest_size, uint8_t const* src, apx_size_t src_size, apx_compressionStats_t* stats)
+{
+   if ( (dest != NULL) && (src != NULL) )
+   {
+      uint64_t const start_time = (stats != NULL) ? apx_time_monotonic_us() : 0u;
+      apx_error_t const retval = decompress_block(dest, dest_size, src, src_size);
+      if ( (stats != NULL) && (retval == APX_NO_ERROR) )
+      {
+         stats->num_decompressed++;
+         stats->bytes_decompressed += dest_size;
+         stats->decompress_time_us += apx_time_monotonic_us() - start_time;
+      }
+      return retval;
+   }
+   return APX_INVALID_ARGUMENT_ERROR;
+}
+
+void apx_compressionStats_create(apx_compressionStats_t* self)
+{
+   if (self != NULL)
+   {
+      memset(self, 0, sizeof(apx_compressionStats_t));
+   }
+}
+
+void apx_compressionStats_add(apx_compressionStats_t* self, apx_compressionStats_t const* other)
+{
+   if ( (self != NULL) && (other != NULL) )
+   {
+      self->num_compressed += other->num_compressed;
+      self->num_incompressible += other->num_incompressible;
+      self->bytes_before_compression += other->bytes_before_compression;
+      self->bytes_after_compression += other->bytes_after_compression;
+      self->compress_time_us += other->compress_time_us;
+      self->num_decompressed += other->num_decompressed;
+      self->bytes_decompressed += other->bytes_decompressed;
+      self->decompress_time_us += other->decompress_time_us;
+   }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+static uint32_t read_u32(uint8_t const* p)
+{
+   uint32_t value;
+   memcpy(&value, p, sizeof(value));
+   return value;
+}
+
+static uint32_t hash_sequence(uint32_t sequence)
+{
+   return (sequence * 2654435761u) >> (32u - HASH_LOG);
+}
+
+/**
+ * Writes the extra length bytes that follow a token nibble of 15.
+ */
+static uint8_t* write_length(uint8_t* op, uint8_t const* op_end, apx_size_t length)
+{
+   while (length >= 255u)
+   {
+      if (op >= op_end)
+      {
+         return NULL;
+      }
+      *op++ = 255u;
+      length -= 255u;
+   }
+   if (op >= op_end)
+   {
+      return NULL;
+   }
+   *op++ = (uint8_t)length;
+   return op;
+}
+
+/**
+ * Writes one sequence. A match_length of 0 writes the literals-only sequence that ends the block.
+ * Returns NULL when dest is full.
+ */
+static uint8_t* write_sequence(uint8_t* op, uint8_t const* op_end, uint8_t const* literals, apx_size_t num_literals, apx_size_t offset, apx_size_t match_length)
+{
+   uint8_t* token = op;
+   if (op >= op_end)
+   {
+      return NULL;
+   }
+   op++;
+   *token = (uint8_t)(((num_literals >= RUN_MASK) ? RUN_MASK : num_literals) << 4);
+   if (num_literals >= RUN_MASK)
+   {
+      op = write_length(op, op_end, num_literals - RUN_MASK);
+      if (op == NULL)
+      {
+         return NULL;
+      }
+   }
+   if ((apx_size_t)(op_end - op) < num_literals)
+   {
+      return NULL;
+   }
+   memcpy(op, literals, num_literals);
+   op += num_literals;
+   if (match_length > 0u)
+   {
+      apx_size_t const length_code = match_length - MIN_MATCH;
+      if ((op_end - op) < (ptrdiff_t)UINT16_SIZE)
+      {
+         return NULL;
+      }
+      *op++ = (uint8_t)offset;
+      *op++ = (uint8_t)(offset >> 8);
+      *token |= (uint8_t)((length_code >= ML_MASK) ? ML_MASK : length_code);
+      if (length_code >= ML_MASK)
+      {
+         op = write_length(op, op_end, length_code - ML_MASK);
+      }
+   }
+   return op;
+}
+
+static uint8_t const* read_length(uint8_t const* ip, uint8_t const* ip_end, apx_size_t* length)
+{
+   uint8_t value;
+   do
+   {
+      if ( (ip >= ip_end) || (*length > (APX_MAX_FILE_SIZE)) )
+      {
+         return NULL;
+      }
+      value = *ip++;
+      *length += value;
+   } while (value == 255u);
+   return ip;
+}
+
+static apx_error_t decompress_block(uint8_t* dest, apx_size_t dest_size, uint8_t const* src, apx_size_t src_size)
+{
+   uint8_t const* ip = src;
+   uint8_t const* const ip_end = src + src_size;
+   uint8_t* op = dest;
+   uint8_t* const op_end = dest + dest_size;
+   while (ip < ip_end)
+   {
+      uint8_t const token = *ip++;
+      apx_size_t num_literals = (apx_size_t)(token >> 4);
+      apx_size_t match_length = (apx_size_t)(token & ML_MASK);
+      apx_size_t offset;
+      if (num_literals == RUN_MASK)
+      {
+         ip = read_length(ip, ip_end, &num_literals);
+         if (ip == NULL)
+         {
+            return APX_COMPRESSION_ERROR;
+         }
+      }
+      if ( (num_literals > (apx_size_t)(ip_end - ip)) || (num_literals > (apx_size_t)(op_end - op)) )
+      {
+         return APX_COMPRESSION_ERROR;
+      }
+      memcpy(op, ip, num_literals);
+      op += num_literals;
+      ip += num_literals;
+      if (ip == ip_end)
+      {
+         break; //last sequence has no match
+      }
+      if ((ip_end - ip) < (ptrdiff_t)UINT16_SIZE)
+      {
+         return APX_COMPRESSION_ERROR;
+      }
+      offset = (apx_size_t)ip[0] | ((apx_size_t)ip[1] << 8);
+      ip += UINT16_SIZE;
+      if ( (offset == 0u) || (offset > (apx_size_t)(op - dest)) )
+      {
+         return APX_COMPRESSION_ERROR;
+      }
+      if (match_length == ML_MASK)
+      {
+         ip = read_length(ip, ip_end, &match_length);
+         if (ip == NULL)
+         {
+            return APX_COMPRESSION_ERROR;
+         }
+      }
+      match_length += MIN_MATCH;
+      if (match_length > (apx_size_t)(op_end - op))
+      {
+         return APX_COMPRESSION_ERROR;
+      }
+      if (offset >= match_length)
+      {
+         memcpy(op, op - offset, match_length);
+         op += match_length;
+      }
+      else
+      {
+         //Overlapping copy repeats the last offset bytes
+         uint8_t const* match = op - offset;
+         while (match_length > 0u)
+         {
+            *op++ = *match++;
+            match_length--;
+         }
+      }
+   }
+   return (op == op_end) ? APX_NO_ERROR : APX_COMPRESSION_ERROR;
+}
@@ -114,6 +114,7 @@ apx_error_t apx_connectionBase_create(apx_connectionBase_t *self, apx_mode_t mod
       self->total_bytes_sent = 0u;
       self->connection_id = APX_INVALID_CONNECTION_ID;
       self->num_header_size = UINT32_SIZE;
+      apx_capabilities_create(&self->local_capabilities, APX_CAPABILITY_DEFAULT_FLAGS, 0u, 0u);
       self->mode = mode;
       self->event_loop_thread_valid = false;
 #ifdef _WIN32
@@ -305,6 +306,37 @@ void apx_connectionBase_set_connection_id(apx_connectionBase_t* self, uint32_t c
    }
 }
 
+/**
+ * Sets what is announced in the next greeting.
+ */
+void apx_connectionBase_set_local_capabilities(apx_connectionBase_t* self, apx_capabilities_t const* capabilities)
+{
+   if ( (self != NULL) && (capabilities != NULL) )
+   {
+      memcpy(&self->local_capabilities, capabilities, sizeof(apx_capabilities_t));
+   }
+}
+
+void apx_connectionBase_get_local_capabilities(apx_connectionBase_t const* self, apx_capabilities_t* capabilities)
+{
+   if ( (self != NULL) && (capabilities != NULL) )
+   {
+      memcpy(capabilities, &self->local_capabilities, sizeof(apx_capabilities_t));
+   }
+}
+
+/**
+ * Capabilities agreed with the peer. Only the baseline protocol is agreed while not connected or when the
+ * peer predates capability negotiation.
+ */
+void apx_connectionBase_get_capabilities(apx_connectionBase_t* self, apx_capabilities_t* capabilities)
+{
+   if (self != NULL)
+   {
+      apx_fileManager_get_capabilities(&self->file_manager, capabilities);
+   }
+}
+
 //Virtual function call-points
 
 void apx_connectionBase_node_created_notification(apx_connectionBase_t const* self, apx_nodeInstance_t* node_instance)
@@ -329,6 +361,32 @@ void apx_connectionBase_require_port_write_notification(apx_connectionBase_t con
    }
 }
 
+/**
+ * Lets the derived connection add its own header lines to the greeting. Returns number of characters written.
+ */
+int32_t apx_connectionBase_greeting_header_write(apx_connectionBase_t const* self, char* buf, int32_t buf_size)
+{
+   if ((self != NULL) && (buf != NULL) && (buf_size > 0))
+   {
+      if ((self->vtable.greeting_header_write != NULL))
+      {
+         return self->vtable.greeting_header_write((void*)self, buf, buf_size);
+      }
+   }
+   return 0;
+}
+
+void apx_connectionBase_greeting_header_notification(apx_connectionBase_t const* self, char const* header_line)
+{
+   if ((self != NULL) && (header_line != NULL))
+   {
+      if ((self->vtable.greeting_header_notification != NULL))
+      {
+         self->vtable.greeting_header_notification((void*)self, header_line);
+      }
+   }
+}
+
 
 
 /*** Internal Callback API ***/
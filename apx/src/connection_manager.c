@@ -170,6 +170,26 @@ uint32_t apx_connectionManager_get_num_connections(apx_connectionManager_t *self
    return 0;
 }
 
+void apx_connectionManager_get_compression_stats(apx_connectionManager_t *self, apx_compressionStats_t *stats)
+{
+   if ( (self != 0) && (stats != 0) )
+   {
+      adt_list_elem_t *iter;
+      apx_compressionStats_create(stats);
+      SPINLOCK_ENTER(self->lock);
+      iter = adt_list_iter_first(&self->active_connections);
+      while (iter != 0)
+      {
+         apx_serverConnection_t *connection = (apx_serverConnection_t*) iter->pItem;
+         apx_compressionStats_t connection_stats;
+         apx_fileManager_get_compression_stats(&connection->base.file_manager, &connection_stats);
+         apx_compressionStats_add(stats, &connection_stats);
+         iter = adt_list_iter_next(iter);
+      }
+      SPINLOCK_LEAVE(self->lock);
+   }
+}
+
 
 #ifdef UNIT_TEST
 #define APX_SERVER_RUN_CYCLES 10
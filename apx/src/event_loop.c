@@ -28,6 +28,7 @@
 //////////////////////////////////////////////////////////////////////////////
 #include <malloc.h>
 #include <assert.h>
+#include <string.h>
 #include "apx/event_loop.h"
 #include "apx/event.h"
 #include "apx/logging.h"
@@ -45,6 +46,8 @@
 // PRIVATE FUNCTION PROTOTYPES
 //////////////////////////////////////////////////////////////////////////////
 static void apx_eventLoop_processEvent(apx_eventLoop_t *self, apx_event_t *event, apx_eventHandlerFunc_t *eventHandler, void *eventHandlerArg);
+static uint32_t apx_eventLoop_removeBatch(apx_eventLoop_t *self, apx_event_t *batch);
+static void apx_eventLoop_processBatch(apx_eventLoop_t *self, apx_event_t *batch, uint32_t numEvents, apx_eventHandlerFunc_t *eventHandler, void *eventHandlerArg);
 
 //////////////////////////////////////////////////////////////////////////////
 // PUBLIC FUNCTIONS
@@ -59,6 +62,8 @@ apx_error_t apx_eventLoop_create(apx_eventLoop_t *self)
          return APX_MEM_ERROR;
       }
       self->exitFlag = false;
+      self->isConsumerWaiting = false;
+      memset(&self->stats, 0, sizeof(apx_eventLoopStats_t));
       SPINLOCK_INIT(self->lock);
       SEMAPHORE_CREATE(self->semaphore);
       return APX_NO_ERROR;
@@ -99,13 +104,28 @@ void apx_eventLoop_delete(apx_eventLoop_t *self)
    }
 }
 
+/**
+ * Appends event to the queue. The semaphore is only posted when the consumer thread is blocked (or about to block) on it.
+ * While the consumer is busy processing a batch it will see the new event the next time it drains the queue.
+ */
 void apx_eventLoop_append(apx_eventLoop_t *self, apx_event_t *event)
 {
+   bool wakeConsumer = false;
    SPINLOCK_ENTER(self->lock);
    adt_rbfh_insert(&self->pendingEvents, (const uint8_t*) event);
+   if (self->isConsumerWaiting)
+   {
+      self->isConsumerWaiting = false;
+      wakeConsumer = true;
+   }
    SPINLOCK_LEAVE(self->lock);
 #ifndef UNIT_TEST
-   SEMAPHORE_POST(self->semaphore);
+   if (wakeConsumer)
+   {
+      SEMAPHORE_POST(self->semaphore);
+   }
+#else
+   (void)wakeConsumer;
 #endif
 }
 
@@ -121,32 +141,42 @@ void apx_eventLoop_exit(apx_eventLoop_t *self)
 }
 
 /**
- * Executes events in an infinite loop. This function will only return when self->exitFlag is set to true
+ * Executes events in an infinite loop. This function will only return when self->exitFlag is set to true.
+ * All pending events (up to APX_EVENT_LOOP_BATCH_SIZE) are removed under a single lock acquisition and then processed
+ * outside the lock. The consumer only waits on the semaphore when the queue was found empty.
  */
 void apx_eventLoop_run(apx_eventLoop_t *self, apx_eventHandlerFunc_t *eventHandler, void *eventHandlerArg)
 {
+   apx_event_t batch[APX_EVENT_LOOP_BATCH_SIZE];
    bool exitFlag = false;
    while(exitFlag == false)
    {
-      apx_event_t event;
-#ifdef _MSC_VER
-      DWORD result = WaitForSingleObject(self->semaphore, INFINITE);
-      if (result == WAIT_OBJECT_0)
-#else
-      int result = sem_wait(&self->semaphore);
-      if (result == 0)
-#endif
+      uint32_t numEvents = 0u;
+      SPINLOCK_ENTER(self->lock);
+      exitFlag = self->exitFlag;
+      if (exitFlag == false)
       {
-         SPINLOCK_ENTER(self->lock);
-         exitFlag = self->exitFlag;
-         if (exitFlag == false)
+         numEvents = apx_eventLoop_removeBatch(self, &batch[0]);
+         if (numEvents == 0u)
          {
-            adt_rbfh_remove(&self->pendingEvents,(uint8_t*) &event);
+            self->isConsumerWaiting = true;
+            self->stats.numWakeups++;
          }
-         SPINLOCK_LEAVE(self->lock);
-         if (exitFlag == false)
+      }
+      SPINLOCK_LEAVE(self->lock);
+      if (exitFlag == false)
+      {
+         if (numEvents > 0u)
          {
-            apx_eventLoop_processEvent(self, &event, eventHandler, eventHandlerArg);
+            apx_eventLoop_processBatch(self, &batch[0], numEvents, eventHandler, eventHandlerArg);
+         }
+         else
+         {
+#ifdef _MSC_VER
+            (void)WaitForSingleObject(self->semaphore, INFINITE);
+#else
+            (void)sem_wait(&self->semaphore);
+#endif
          }
       }
    }
@@ -161,7 +191,15 @@ uint16_t apx_eventLoop_numPendingEvents(apx_eventLoop_t *self)
    return 0;
 }
 
-
+void apx_eventLoop_getStats(apx_eventLoop_t *self, apx_eventLoopStats_t *stats)
+{
+   if ( (self != 0) && (stats != 0) )
+   {
+      SPINLOCK_ENTER(self->lock);
+      memcpy(stats, &self->stats, sizeof(apx_eventLoopStats_t));
+      SPINLOCK_LEAVE(self->lock);
+   }
+}
 
 #ifdef UNIT_TEST
 /**
@@ -169,13 +207,13 @@ uint16_t apx_eventLoop_numPendingEvents(apx_eventLoop_t *self)
  */
 void apx_eventLoop_runAll(apx_eventLoop_t *self, apx_eventHandlerFunc_t *eventHandler, void *eventHandlerArg)
 {
+   apx_event_t batch[APX_EVENT_LOOP_BATCH_SIZE];
    while(true)
    {
-      apx_event_t event;
-      uint8_t rc = adt_rbfh_remove(&self->pendingEvents,(uint8_t*) &event);
-      if (rc == BUF_E_OK)
+      uint32_t numEvents = apx_eventLoop_removeBatch(self, &batch[0]);
+      if (numEvents > 0u)
       {
-         apx_eventLoop_processEvent(self, &event, eventHandler, eventHandlerArg);
+         apx_eventLoop_processBatch(self, &batch[0], numEvents, eventHandler, eventHandlerArg);
       }
       else
       {
@@ -198,3 +236,35 @@ static void apx_eventLoop_processEvent(apx_eventLoop_t *self, apx_event_t *event
       eventHandler(eventHandlerArg, event);
    }
 }
+
+/**
+ * Moves up to APX_EVENT_LOOP_BATCH_SIZE events from the pending queue into batch.
+ * In threaded mode the caller must hold self->lock.
+ */
+static uint32_t apx_eventLoop_removeBatch(apx_eventLoop_t *self, apx_event_t *batch)
+{
+   uint32_t numEvents = 0u;
+   while (numEvents < APX_EVENT_LOOP_BATCH_SIZE)
+   {
+      if (adt_rbfh_remove(&self->pendingEvents, (uint8_t*) &batch[numEvents]) != BUF_E_OK)
+      {
+         break;
+      }
+      numEvents++;
+   }
+   if (numEvents > 0u)
+   {
+      self->stats.numBatches++;
+      self->stats.numEventsProcessed += numEvents;
+   }
+   return numEvents;
+}
+
+static void apx_eventLoop_processBatch(apx_eventLoop_t *self, apx_event_t *batch, uint32_t numEvents, apx_eventHandlerFunc_t *eventHandler, void *eventHandlerArg)
+{
+   uint32_t i;
+   for (i = 0u; i < numEvents; i++)
+   {
+      apx_eventLoop_processEvent(self, &batch[i], eventHandler, eventHandlerArg);
+   }
+}
@@ -0,0 +1,1216 @@
+/*****************************************************************************
+* \file      bridge.c
+* \author    Conny Gustafsson
+* \date      2026-10-18
+* \brief     Bridge between APX servers
+*
+* Copyright (c) 2026 Conny Gustafsson
+* Permission is hereby granted, free of charge, to any person obtaining a copy of
+* this software and associated documentation files (the "Software"), to deal in
+* the Software without restriction, including without limitation the rights to
+* use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+* the Software, and to permit persons to whom the Software is furnished to do so,
+* subject to the following conditions:
+
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+* FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+* COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+* IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+* CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+******************************************************************************/
+//////////////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////////////
+#include <malloc.h>
+#include <string.h>
+#include <stdio.h>
+#include <assert.h>
+#include "apx/extension/bridge.h"
+#include "apx/server.h"
+#include "apx/node_instance.h"
+#include "apx/port_instance.h"
+#include "apx/util.h"
+#ifndef UNIT_TEST
+#include "apx/socket_client_connection.h"
+#endif
+#include "adt_list.h"
+#ifdef MEM_LEAK_CHECK
+#include "CMemLeak.h"
+#endif
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE CONSTANTS AND DATA TYPES
+//////////////////////////////////////////////////////////////////////////////
+#define NODE_NAME_MAX_SIZE 128u
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////////////
+static apx_bridgePort_t* apx_bridgePort_new(char const* port_signature);
+static void apx_bridgePort_delete(apx_bridgePort_t* self);
+static void apx_bridgePort_vdelete(void* arg);
+static apx_error_t apx_bridgePort_set_value(apx_bridgePort_t* self, uint8_t const* data, apx_size_t size);
+static apx_bridgeImport_t* apx_bridgeImport_new(char const* node_name);
+static void apx_bridgeImport_delete(apx_bridgeImport_t* self);
+static void apx_bridgeImport_vdelete(void* arg);
+static apx_bridgeLink_t* apx_bridgeLink_new(apx_bridge_t* parent, char const* address, uint16_t tcp_port);
+static void apx_bridgeLink_delete(apx_bridgeLink_t* self);
+static void apx_bridgeLink_vdelete(void* arg);
+static void* apx_bridgeLink_register_listener(apx_bridgeLink_t* self, apx_client_t* client);
+static apx_error_t apx_bridgeLink_update(apx_bridgeLink_t* self, adt_ary_t const* signatures, adt_hash_t const* wanted);
+static apx_error_t apx_bridgeLink_reset(apx_bridgeLink_t* self);
+static bool apx_bridgeLink_is_ready(apx_bridgeLink_t* self);
+static apx_bridgeImport_t* apx_bridgeLink_find_import(apx_bridgeLink_t* self, char const* node_name);
+static void apx_bridgeLink_vrequire_port_write(void* arg, apx_portInstance_t* port_instance, uint8_t const* data, apx_size_t size);
+static void apx_bridgeLink_vdisconnected(void* arg, struct apx_clientConnection_tag* connection);
+static void* apx_bridge_register_local_listener(apx_bridge_t* self, apx_client_t* client);
+static apx_error_t apx_bridge_reset_local_client(apx_bridge_t* self);
+static void apx_bridge_vlocal_disconnected(void* arg, struct apx_clientConnection_tag* connection);
+static bool has_local_requester(apx_portSignatureMapEntry_t* entry);
+static bool has_local_provider(apx_portSignatureMapEntry_t* entry);
+static bool is_locally_provided(apx_portSignatureMap_t* map, adt_ary_t const* ports);
+static bool is_bridge_node(apx_nodeInstance_t* node_instance);
+static bool has_same_port_name(adt_ary_t const* ports, char const* port_signature);
+static bool port_name_equals(char const* signature1, char const* signature2);
+static void make_node_name(char* buf, char const* bridge_name, char const* kind, uint32_t number);
+#ifndef UNIT_TEST
+static void connect_client(apx_client_t* client, bool* is_connect_attempted, char const* address, uint16_t tcp_port);
+static apx_error_t apx_bridge_start_thread(apx_bridge_t* self);
+static void apx_bridge_stop_thread(apx_bridge_t* self);
+static THREAD_PROTO(worker_task, arg);
+#endif
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE VARIABLES
+//////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////
+// PUBLIC FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+apx_error_t apx_bridge_create(apx_bridge_t* self, struct apx_server_tag* server, char const* name)
+{
+   if ( (self != NULL) && (server != NULL) && (name != NULL) )
+   {
+      self->server = server;
+      self->name = STRDUP(name);
+      self->local_address = STRDUP(APX_BRIDGE_LOCAL_ADDRESS);
+      self->local_client = apx_client_new();
+      if ( (self->name == NULL) || (self->local_address == NULL) || (self->local_client == NULL) )
+      {
+         if (self->name != NULL) free(self->name);
+         if (self->local_address != NULL) free(self->local_address);
+         if (self->local_client != NULL) apx_client_delete(self->local_client);
+         return APX_MEM_ERROR;
+      }
+      self->local_tcp_port = 0u;
+      adt_ary_create(&self->links, apx_bridgeLink_vdelete);
+      adt_hash_create(&self->exported, NULL);
+      self->num_export_nodes = 0u;
+      self->poll_interval_ms = APX_BRIDGE_DEFAULT_POLL_INTERVAL_MS;
+      self->unsubscribe_delay_ms = APX_BRIDGE_DEFAULT_UNSUBSCRIBE_DELAY_MS;
+      self->is_worker_valid = false;
+      self->is_running = false;
+      self->is_local_connect_attempted = false;
+      self->is_local_dropped = false;
+      MUTEX_INIT(self->lock);
+      self->local_listener_handle = apx_bridge_register_local_listener(self, self->local_client);
+      return APX_NO_ERROR;
+   }
+   return APX_INVALID_ARGUMENT_ERROR;
+}
+
+void apx_bridge_destroy(apx_bridge_t* self)
+{
+   if (self != NULL)
+   {
+      apx_bridge_stop(self);
+      //Links are deleted first, their clients deliver values into ports owned by the links
+      adt_ary_destroy(&self->links);
+      apx_client_disconnect(self->local_client);
+      apx_client_delete(self->local_client);
+      adt_hash_destroy(&self->exported);
+      free(self->name);
+      free(self->local_address);
+      MUTEX_DESTROY(self->lock);
+   }
+}
+
+apx_bridge_t* apx_bridge_new(struct apx_server_tag* server, char const* name)
+{
+   apx_bridge_t* self = (apx_bridge_t*)malloc(sizeof(apx_bridge_t));
+   if (self != NULL)
+   {
+      apx_error_t result = apx_bridge_create(self, server, name);
+      if (result != APX_NO_ERROR)
+      {
+         free(self);
+         self = NULL;
+      }
+   }
+   return self;
+}
+
+void apx_bridge_delete(apx_bridge_t* self)
+{
+   if (self != NULL)
+   {
+      apx_bridge_destroy(self);
+      free(self);
+   }
+}
+
+apx_error_t apx_bridge_set_local_endpoint(apx_bridge_t* self, char const* address, uint16_t tcp_port)
+{
+   if ( (self != NULL) && (address != NULL) )
+   {
+      char* local_address = STRDUP(address);
+      if (local_address == NULL)
+      {
+         return APX_MEM_ERROR;
+      }
+      free(self->local_address);
+      self->local_address = local_address;
+      self->local_tcp_port = tcp_port;
+      return APX_NO_ERROR;
+   }
+   return APX_INVALID_ARGUMENT_ERROR;
+}
+
+void apx_bridge_set_poll_interval(apx_bridge_t* self, uint32_t poll_interval_ms)
+{
+   if ( (self != NULL) && (poll_interval_ms > 0u) )
+   {
+      self->poll_interval_ms = poll_interval_ms;
+   }
+}
+
+/**
+ * Sets how long a link keeps imported signatures that no longer have a local requester before it unsubscribes them.
+ */
+void apx_bridge_set_unsubscribe_delay(apx_bridge_t* self, uint32_t unsubscribe_delay_ms)
+{
+   if (self != NULL)
+   {
+      self->unsubscribe_delay_ms = unsubscribe_delay_ms;
+   }
+}
+
+apx_bridgeLink_t* apx_bridge_add_peer(apx_bridge_t* self, char const* address, uint16_t tcp_port)
+{
+   if ( (self != NULL) && (address != NULL) && (!self->is_running) )
+   {
+      apx_bridgeLink_t* link = apx_bridgeLink_new(self, address, tcp_port);
+      if (link != NULL)
+      {
+         if (adt_ary_push(&self->links, link) != ADT_NO_ERROR)
+         {
+            apx_bridgeLink_delete(link);
+            link = NULL;
+         }
+      }
+      return link;
+   }
+   return NULL;
+}
+
+int32_t apx_bridge_num_links(apx_bridge_t* self)
+{
+   if (self != NULL)
+   {
+      return adt_ary_length(&self->links);
+   }
+   return -1;
+}
+
+apx_bridgeLink_t* apx_bridge_get_link(apx_bridge_t* self, int32_t index)
+{
+   if (self != NULL)
+   {
+      return (apx_bridgeLink_t*)adt_ary_value(&self->links, index);
+   }
+   return NULL;
+}
+
+apx_client_t* apx_bridge_get_local_client(apx_bridge_t* self)
+{
+   if (self != NULL)
+   {
+      return self->local_client;
+   }
+   return NULL;
+}
+
+apx_error_t apx_bridge_start(apx_bridge_t* self)
+{
+   if (self != NULL)
+   {
+#ifndef UNIT_TEST
+      if (!self->is_running)
+      {
+         self->is_running = true;
+         return apx_bridge_start_thread(self);
+      }
+#endif
+      return APX_NO_ERROR;
+   }
+   return APX_INVALID_ARGUMENT_ERROR;
+}
+
+void apx_bridge_stop(apx_bridge_t* self)
+{
+   if (self != NULL)
+   {
+#ifndef UNIT_TEST
+      if (self->is_running)
+      {
+         MUTEX_LOCK(self->lock);
+         self->is_running = false;
+         MUTEX_UNLOCK(self->lock);
+         apx_bridge_stop_thread(self);
+      }
+#endif
+   }
+}
+
+/**
+ * Runs one bridge cycle: signatures that are requested but not provided in the local server are imported from every
+ * peer and imports that are no longer wanted are unsubscribed. Dropped connections are replaced, as is the local
+ * connection when a local provider has appeared for an exported signature. Values that arrived since the last cycle
+ * for not yet exported signatures are then provided to the local server.
+ */
+apx_error_t apx_bridge_run(apx_bridge_t* self)
+{
+   if (self != NULL)
+   {
+      apx_error_t result = APX_NO_ERROR;
+      int32_t i;
+      int32_t num_links;
+      bool is_local_reset_needed;
+      adt_ary_t signatures;
+      adt_ary_t exported_ports;
+      adt_hash_t wanted;
+      adt_ary_create(&signatures, free);
+      adt_ary_create(&exported_ports, NULL);
+      adt_hash_create(&wanted, NULL);
+      //Exported ports are only deleted by this thread, they stay valid until the local client is replaced
+      MUTEX_LOCK(self->lock);
+      (void)adt_hash_values(&self->exported, &exported_ports);
+      is_local_reset_needed = self->is_local_dropped;
+      MUTEX_UNLOCK(self->lock);
+      apx_server_take_global_lock(self->server);
+      (void)apx_bridge_collect_unresolved_signatures(&self->server->port_signature_map, &signatures);
+      if (is_locally_provided(&self->server->port_signature_map, &exported_ports))
+      {
+         is_local_reset_needed = true;
+      }
+      apx_server_release_global_lock(self->server);
+      for (i = 0; i < adt_ary_length(&signatures); i++)
+      {
+         char* port_signature = (char*)adt_ary_value(&signatures, i);
+         (void)adt_hash_set(&wanted, port_signature, port_signature);
+      }
+      if (is_local_reset_needed)
+      {
+         result = apx_bridge_reset_local_client(self);
+      }
+      num_links = adt_ary_length(&self->links);
+      for (i = 0; i < num_links; i++)
+      {
+         apx_bridgeLink_t* link = (apx_bridgeLink_t*)adt_ary_value(&self->links, i);
+         apx_error_t link_result = apx_bridgeLink_update(link, &signatures, &wanted);
+         if (link_result != APX_NO_ERROR)
+         {
+            result = link_result;
+         }
+      }
+      adt_hash_destroy(&wanted);
+      adt_ary_destroy(&exported_ports);
+      adt_ary_destroy(&signatures);
+      if (result == APX_NO_ERROR)
+      {
+         result = apx_bridge_export_pending_ports(self);
+      }
+      return result;
+   }
+   return APX_INVALID_ARGUMENT_ERROR;
+}
+
+/**
+ * Publishes one require port node to the peer with all signatures not currently imported on this link.
+ * The node stays subscribed until the link client is replaced by apx_bridge_run.
+ */
+apx_error_t apx_bridgeLink_import_signatures(apx_bridgeLink_t* self, adt_ary_t const* signatures)
+{
+   if ( (self != NULL) && (signatures != NULL) )
+   {
+      apx_error_t result = APX_NO_ERROR;
+      apx_bridgeImport_t* import;
+      adt_str_t* definition;
+      char node_name[NODE_NAME_MAX_SIZE];
+      int32_t i;
+      int32_t num_signatures = adt_ary_length(signatures);
+      adt_ary_t new_ports;
+      adt_ary_create(&new_ports, NULL);
+      for (i = 0; i < num_signatures; i++)
+      {
+         char const* port_signature = (char const*)adt_ary_value(signatures, i);
+         apx_bridgePort_t* port = (apx_bridgePort_t*)adt_hash_value(&self->ports, port_signature);
+         //Port names must be unique within a node, a name clash is imported in a later node
+         if ( ( (port == NULL) || (!port->is_imported) ) && (!has_same_port_name(&new_ports, port_signature)) )
+         {
+            //An exported port is kept when the link client is replaced, its local provide port is reused
+            if (port == NULL)
+            {
+               port = apx_bridgePort_new(port_signature);
+               if (port == NULL)
+               {
+                  result = APX_MEM_ERROR;
+                  break;
+               }
+               result = convert_from_adt_to_apx_error(adt_hash_set(&self->ports, port_signature, port));
+               if (result != APX_NO_ERROR)
+               {
+                  apx_bridgePort_delete(port);
+                  break;
+               }
+            }
+            result = convert_from_adt_to_apx_error(adt_ary_push(&new_ports, port));
+            if (result != APX_NO_ERROR)
+            {
+               break;
+            }
+         }
+      }
+      if ( (result != APX_NO_ERROR) || (adt_ary_length(&new_ports) == 0) )
+      {
+         adt_ary_destroy(&new_ports);
+         return result;
+      }
+      make_node_name(node_name, self->parent->name, "Import", (uint32_t)adt_ary_length(&self->imports) + 1u);
+      import = apx_bridgeImport_new(node_name);
+      definition = apx_bridge_create_definition(node_name, 'R', &new_ports);
+      if ( (import == NULL) || (definition == NULL) )
+      {
+         if (import != NULL) apx_bridgeImport_delete(import);
+         if (definition != NULL) adt_str_delete(definition);
+         adt_ary_destroy(&new_ports);
+         return APX_MEM_ERROR;
+      }
+      for (i = 0; i < adt_ary_length(&new_ports); i++)
+      {
+         (void)adt_ary_push(&import->ports, adt_ary_value(&new_ports, i));
+      }
+      adt_ary_destroy(&new_ports);
+      //Register the import before building it, values may arrive as soon as the node is published
+      MUTEX_LOCK(self->parent->lock);
+      result = convert_from_adt_to_apx_error(adt_ary_push(&self->imports, import));
+      if (result == APX_NO_ERROR)
+      {
+         for (i = 0; i < adt_ary_length(&import->ports); i++)
+         {
+            apx_bridgePort_t* port = (apx_bridgePort_t*)adt_ary_value(&import->ports, i);
+            port->is_imported = true;
+            port->is_wanted = true;
+         }
+      }
+      MUTEX_UNLOCK(self->parent->lock);
+      if (result != APX_NO_ERROR)
+      {
+         apx_bridgeImport_delete(import);
+      }
+      else
+      {
+         result = apx_client_build_node(self->client, adt_str_cstr(definition));
+      }
+      adt_str_delete(definition);
+      return result;
+   }
+   return APX_INVALID_ARGUMENT_ERROR;
+}
+
+int32_t apx_bridgeLink_num_imported_signatures(apx_bridgeLink_t* self)
+{
+   if (self != NULL)
+   {
+      int32_t i;
+      int32_t num_imported = 0;
+      adt_ary_t ports;
+      adt_ary_create(&ports, NULL);
+      (void)adt_hash_values(&self->ports, &ports);
+      for (i = 0; i < adt_ary_length(&ports); i++)
+      {
+         apx_bridgePort_t const* port = (apx_bridgePort_t const*)adt_ary_value(&ports, i);
+         if (port->is_imported)
+         {
+            num_imported++;
+         }
+      }
+      adt_ary_destroy(&ports);
+      return num_imported;
+   }
+   return -1;
+}
+
+/**
+ * Called when the peer writes a require port in one of the import nodes of this link.
+ * The value is forwarded to the local proxy port if there is one, otherwise it is kept until the port is exported.
+ */
+void apx_bridgeLink_require_port_written(apx_bridgeLink_t* self, apx_portInstance_t* port_instance, uint8_t const* data, apx_size_t size)
+{
+   if ( (self != NULL) && (port_instance != NULL) && (data != NULL) )
+   {
+      apx_bridge_t* parent = self->parent;
+      apx_bridgeImport_t* import;
+      char const* node_name = apx_nodeInstance_get_name(apx_portInstance_parent(port_instance));
+      MUTEX_LOCK(parent->lock);
+      import = apx_bridgeLink_find_import(self, node_name);
+      if (import != NULL)
+      {
+         apx_bridgePort_t* port = (apx_bridgePort_t*)adt_ary_value(&import->ports, (int32_t)apx_portInstance_port_id(port_instance));
+         if ( (port != NULL) && (apx_bridgePort_set_value(port, data, size) == APX_NO_ERROR) )
+         {
+            if (port->export_node != NULL)
+            {
+               //A file that is not yet opened by the server picks up the value when it is opened
+               (void)apx_nodeInstance_write_provide_port_data(port->export_node, port->export_offset, port->value, port->value_size);
+            }
+            else if ( (!port->is_exported) && (adt_hash_value(&parent->exported, port->port_signature) == NULL) )
+            {
+               (void)adt_ary_push_unique(&self->pending_exports, port);
+            }
+         }
+      }
+      MUTEX_UNLOCK(parent->lock);
+   }
+}
+
+/**
+ * Called when the connection to the peer is lost. The next bridge cycle replaces the link client.
+ */
+void apx_bridgeLink_disconnected(apx_bridgeLink_t* self)
+{
+   if (self != NULL)
+   {
+      MUTEX_LOCK(self->parent->lock);
+      self->is_dropped = true;
+      MUTEX_UNLOCK(self->parent->lock);
+   }
+}
+
+/**
+ * Builds one provider node on the local client for all signatures that have received a value from a peer and
+ * that no other link has exported yet. The first link to deliver a signature owns its export.
+ */
+apx_error_t apx_bridge_export_pending_ports(apx_bridge_t* self)
+{
+   if (self != NULL)
+   {
+      apx_error_t result = APX_NO_ERROR;
+      apx_nodeInstance_t* node_instance = NULL;
+      adt_ary_t batch;
+      adt_str_t* definition = NULL;
+      char node_name[NODE_NAME_MAX_SIZE];
+      int32_t i;
+      int32_t num_links;
+      adt_ary_create(&batch, NULL);
+      MUTEX_LOCK(self->lock);
+      num_links = adt_ary_length(&self->links);
+      for (i = 0; i < num_links; i++)
+      {
+         apx_bridgeLink_t* link = (apx_bridgeLink_t*)adt_ary_value(&self->links, i);
+         adt_ary_t remaining;
+         int32_t j;
+         adt_ary_create(&remaining, NULL);
+         for (j = 0; j < adt_ary_length(&link->pending_exports); j++)
+         {
+            apx_bridgePort_t* port = (apx_bridgePort_t*)adt_ary_value(&link->pending_exports, j);
+            if ( (!port->is_wanted) || (adt_hash_value(&self->exported, port->port_signature) != NULL) )
+            {
+               continue; //No longer requested, provided locally or already provided by another link
+            }
+            if (has_same_port_name(&batch, port->port_signature))
+            {
+               (void)adt_ary_push(&remaining, port);
+               continue;
+            }
+            if (adt_hash_set(&self->exported, port->port_signature, port) == ADT_NO_ERROR)
+            {
+               port->is_exported = true;
+               (void)adt_ary_push(&batch, port);
+            }
+            else
+            {
+               (void)adt_ary_push(&remaining, port);
+            }
+         }
+         adt_ary_clear(&link->pending_exports);
+         for (j = 0; j < adt_ary_length(&remaining); j++)
+         {
+            (void)adt_ary_push(&link->pending_exports, adt_ary_value(&remaining, j));
+         }
+         adt_ary_destroy(&remaining);
+      }
+      if (adt_ary_length(&batch) > 0)
+      {
+         make_node_name(node_name, self->name, "Export", ++self->num_export_nodes);
+         definition = apx_bridge_create_definition(node_name, 'P', &batch);
+      }
+      MUTEX_UNLOCK(self->lock);
+      if (adt_ary_length(&batch) == 0)
+      {
+         adt_ary_destroy(&batch);
+         return APX_NO_ERROR;
+      }
+      if (definition == NULL)
+      {
+         result = APX_MEM_ERROR;
+      }
+      else
+      {
+         result = apx_client_build_node(self->local_client, adt_str_cstr(definition));
+         adt_str_delete(definition);
+         if (result == APX_NO_ERROR)
+         {
+            node_instance = apx_client_get_last_attached_node(self->local_client);
+         }
+      }
+      MUTEX_LOCK(self->lock);
+      for (i = 0; i < adt_ary_length(&batch); i++)
+      {
+         apx_bridgePort_t* port = (apx_bridgePort_t*)adt_ary_value(&batch, i);
+         apx_portInstance_t* port_instance = (node_instance != NULL) ? apx_nodeInstance_get_provide_port(node_instance, (apx_portId_t)i) : NULL;
+         if (port_instance != NULL)
+         {
+            port->export_node = node_instance;
+            port->export_offset = apx_portInstance_data_offset(port_instance);
+            (void)apx_nodeInstance_write_provide_port_data(node_instance, port->export_offset, port->value, port->value_size);
+         }
+         else
+         {
+            //Leave the signature unclaimed, the next value received from any peer retries the export
+            (void)adt_hash_remove(&self->exported, port->port_signature);
+            port->is_exported = false;
+         }
+      }
+      MUTEX_UNLOCK(self->lock);
+      adt_ary_destroy(&batch);
+      return result;
+   }
+   return APX_INVALID_ARGUMENT_ERROR;
+}
+
+/**
+ * Appends (as strong references) the signatures of all map entries that have at least one requester and no provider
+ * outside of bridge nodes. The caller must hold the server global lock.
+ */
+int32_t apx_bridge_collect_unresolved_signatures(apx_portSignatureMap_t* map, adt_ary_t* signatures)
+{
+   if ( (map != NULL) && (signatures != NULL) )
+   {
+      int32_t i;
+      int32_t num_entries;
+      int32_t num_collected = 0;
+      adt_ary_t entries;
+      adt_ary_create(&entries, NULL);
+      num_entries = apx_portSignatureMap_values(map, &entries);
+      for (i = 0; i < num_entries; i++)
+      {
+         apx_portSignatureMapEntry_t* entry = (apx_portSignatureMapEntry_t*)adt_ary_value(&entries, i);
+         if ( (!has_local_provider(entry)) && has_local_requester(entry) )
+         {
+            bool has_dynamic_data;
+            char const* port_signature = apx_portInstance_get_port_signature(apx_portSignatureMapEntry_get_first_requester(entry), &has_dynamic_data);
+            if (port_signature != NULL)
+            {
+               char* copy = STRDUP(port_signature);
+               if ( (copy == NULL) || (adt_ary_push(signatures, copy) != ADT_NO_ERROR) )
+               {
+                  if (copy != NULL) free(copy);
+                  num_collected = -1;
+                  break;
+               }
+               num_collected++;
+            }
+         }
+      }
+      adt_ary_destroy(&entries);
+      return num_collected;
+   }
+   return -1;
+}
+
+/**
+ * Creates APX definition text for a node with one port per bridge port.
+ * port_type is 'R' for require ports or 'P' for provide ports.
+ */
+adt_str_t* apx_bridge_create_definition(char const* node_name, char port_type, adt_ary_t const* ports)
+{
+   if ( (node_name != NULL) && (ports != NULL) && ( (port_type == 'R') || (port_type == 'P') ) )
+   {
+      adt_str_t* str = adt_str_new();
+      if (str != NULL)
+      {
+         int32_t i;
+         adt_error_t rc = adt_str_append_cstr(str, "APX/1.2\nN\"");
+         if (rc == ADT_NO_ERROR) rc = adt_str_append_cstr(str, node_name);
+         if (rc == ADT_NO_ERROR) rc = adt_str_append_cstr(str, "\"\n");
+         for (i = 0; (i < adt_ary_length(ports)) && (rc == ADT_NO_ERROR); i++)
+         {
+            apx_bridgePort_t const* port = (apx_bridgePort_t const*)adt_ary_value(ports, i);
+            rc = adt_str_push(str, port_type);
+            if (rc == ADT_NO_ERROR) rc = adt_str_append_cstr(str, port->port_signature);
+            if (rc == ADT_NO_ERROR) rc = adt_str_push(str, '\n');
+         }
+         if (rc != ADT_NO_ERROR)
+         {
+            adt_str_delete(str);
+            str = NULL;
+         }
+      }
+      return str;
+   }
+   return NULL;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+static apx_bridgePort_t* apx_bridgePort_new(char const* port_signature)
+{
+   apx_bridgePort_t* self = (apx_bridgePort_t*)malloc(sizeof(apx_bridgePort_t));
+   if (self != NULL)
+   {
+      self->port_signature = STRDUP(port_signature);
+      if (self->port_signature == NULL)
+      {
+         free(self);
+         return NULL;
+      }
+      self->value = NULL;
+      self->value_size = 0u;
+      self->export_node = NULL;
+      self->export_offset = 0u;
+      self->is_exported = false;
+      self->is_imported = false;
+      self->is_wanted = false;
+   }
+   return self;
+}
+
+static void apx_bridgePort_delete(apx_bridgePort_t* self)
+{
+   if (self != NULL)
+   {
+      free(self->port_signature);
+      if (self->value != NULL)
+      {
+         free(self->value);
+      }
+      free(self);
+   }
+}
+
+static void apx_bridgePort_vdelete(void* arg)
+{
+   apx_bridgePort_delete((apx_bridgePort_t*)arg);
+}
+
+static apx_error_t apx_bridgePort_set_value(apx_bridgePort_t* self, uint8_t const* data, apx_size_t size)
+{
+   if (size != self->value_size)
+   {
+      uint8_t* value = (uint8_t*)realloc(self->value, size);
+      if ( (value == NULL) && (size > 0u) )
+      {
+         return APX_MEM_ERROR;
+      }
+      self->value = value;
+      self->value_size = size;
+   }
+   if (size > 0u)
+   {
+      memcpy(self->value, data, size);
+   }
+   return APX_NO_ERROR;
+}
+
+static apx_bridgeImport_t* apx_bridgeImport_new(char const* node_name)
+{
+   apx_bridgeImport_t* self = (apx_bridgeImport_t*)malloc(sizeof(apx_bridgeImport_t));
+   if (self != NULL)
+   {
+      self->node_name = STRDUP(node_name);
+      if (self->node_name == NULL)
+      {
+         free(self);
+         return NULL;
+      }
+      adt_ary_create(&self->ports, NULL);
+   }
+   return self;
+}
+
+static void apx_bridgeImport_delete(apx_bridgeImport_t* self)
+{
+   if (self != NULL)
+   {
+      adt_ary_destroy(&self->ports);
+      free(self->node_name);
+      free(self);
+   }
+}
+
+static void apx_bridgeImport_vdelete(void* arg)
+{
+   apx_bridgeImport_delete((apx_bridgeImport_t*)arg);
+}
+
+static apx_bridgeLink_t* apx_bridgeLink_new(apx_bridge_t* parent, char const* address, uint16_t tcp_port)
+{
+   apx_bridgeLink_t* self = (apx_bridgeLink_t*)malloc(sizeof(apx_bridgeLink_t));
+   if (self != NULL)
+   {
+      self->parent = parent;
+      self->tcp_port = tcp_port;
+      self->unused_since_ms = 0u;
+      self->has_unused_imports = false;
+      self->is_connect_attempted = false;
+      self->is_dropped = false;
+      self->address = STRDUP(address);
+      self->client = apx_client_new();
+      if ( (self->address == NULL) || (self->client == NULL) )
+      {
+         if (self->address != NULL) free(self->address);
+         if (self->client != NULL) apx_client_delete(self->client);
+         free(self);
+         return NULL;
+      }
+      adt_hash_create(&self->ports, apx_bridgePort_vdelete);
+      adt_ary_create(&self->imports, apx_bridgeImport_vdelete);
+      adt_ary_create(&self->pending_exports, NULL);
+      self->listener_handle = apx_bridgeLink_register_listener(self, self->client);
+   }
+   return self;
+}
+
+static void apx_bridgeLink_delete(apx_bridgeLink_t* self)
+{
+   if (self != NULL)
+   {
+      apx_client_disconnect(self->client);
+      apx_client_delete(self->client);
+      adt_ary_destroy(&self->pending_exports);
+      adt_ary_destroy(&self->imports);
+      adt_hash_destroy(&self->ports);
+      free(self->address);
+      free(self);
+   }
+}
+
+static void apx_bridgeLink_vdelete(void* arg)
+{
+   apx_bridgeLink_delete((apx_bridgeLink_t*)arg);
+}
+
+static void* apx_bridgeLink_register_listener(apx_bridgeLink_t* self, apx_client_t* client)
+{
+   apx_clientEventListener_t listener;
+   memset(&listener, 0, sizeof(listener));
+   listener.arg = (void*)self;
+   listener.client_disconnect1 = apx_bridgeLink_vdisconnected;
+   listener.require_port_write1 = apx_bridgeLink_vrequire_port_write;
+   return apx_client_register_event_listener(client, &listener);
+}
+
+/**
+ * Marks which ports are still wanted and queues wanted values that lack a local provide port for export.
+ * Replaces the link client when the connection was dropped or when imports have been unused for the unsubscribe
+ * delay. Wanted signatures are then imported on the (possibly new) client.
+ */
+static apx_error_t apx_bridgeLink_update(apx_bridgeLink_t* self, adt_ary_t const* signatures, adt_hash_t const* wanted)
+{
+   apx_bridge_t* parent = self->parent;
+   uint64_t now = apx_time_monotonic_ms();
+   bool is_reset_needed;
+   bool has_unused_imports = false;
+   int32_t i;
+   adt_ary_t ports;
+   adt_ary_create(&ports, NULL);
+   MUTEX_LOCK(parent->lock);
+   (void)adt_hash_values(&self->ports, &ports);
+   for (i = 0; i < adt_ary_length(&ports); i++)
+   {
+      apx_bridgePort_t* port = (apx_bridgePort_t*)adt_ary_value(&ports, i);
+      port->is_wanted = (adt_hash_value(wanted, port->port_signature) != NULL);
+      if (port->is_imported && (!port->is_wanted))
+      {
+         has_unused_imports = true;
+      }
+      else if (port->is_imported && (!port->is_exported) && (port->value != NULL))
+      {
+         //Offer the last value for export again, the local client may have been replaced
+         (void)adt_ary_push_unique(&self->pending_exports, port);
+      }
+   }
+   if (!has_unused_imports)
+   {
+      self->has_unused_imports = false;
+   }
+   else if (!self->has_unused_imports)
+   {
+      self->has_unused_imports = true;
+      self->unused_since_ms = now;
+   }
+   is_reset_needed = self->is_dropped || (self->has_unused_imports && ((now - self->unused_since_ms) >= parent->unsubscribe_delay_ms));
+   MUTEX_UNLOCK(parent->lock);
+   adt_ary_destroy(&ports);
+   if (is_reset_needed)
+   {
+      apx_error_t result = apx_bridgeLink_reset(self);
+      if (result != APX_NO_ERROR)
+      {
+         return result;
+      }
+   }
+   if (apx_bridgeLink_is_ready(self))
+   {
+      return apx_bridgeLink_import_signatures(self, signatures);
+   }
+   return APX_NO_ERROR;
+}
+
+/**
+ * Replaces the link client. Nodes can not be removed from a client, the peer server removes the old import nodes
+ * when the old connection closes. Exported ports keep their local provide port and are imported again if they are
+ * still wanted, all other ports are deleted.
+ */
+static apx_error_t apx_bridgeLink_reset(apx_bridgeLink_t* self)
+{
+   apx_bridge_t* parent = self->parent;
+   apx_client_t* old_client;
+   void* old_listener_handle;
+   int32_t i;
+   adt_ary_t ports;
+   apx_client_t* client = apx_client_new();
+   if (client == NULL)
+   {
+      return APX_MEM_ERROR;
+   }
+   adt_ary_create(&ports, NULL);
+   old_listener_handle = self->listener_handle;
+   self->listener_handle = apx_bridgeLink_register_listener(self, client);
+   MUTEX_LOCK(parent->lock);
+   old_client = self->client;
+   self->client = client;
+   (void)adt_hash_values(&self->ports, &ports);
+   for (i = 0; i < adt_ary_length(&ports); i++)
+   {
+      apx_bridgePort_t* port = (apx_bridgePort_t*)adt_ary_value(&ports, i);
+      if (port->is_exported)
+      {
+         port->is_imported = false;
+      }
+      else
+      {
+         (void)adt_hash_remove(&self->ports, port->port_signature);
+         apx_bridgePort_delete(port);
+      }
+   }
+   adt_ary_destroy(&self->imports);
+   adt_ary_create(&self->imports, apx_bridgeImport_vdelete);
+   adt_ary_clear(&self->pending_exports);
+   self->has_unused_imports = false;
+   self->is_dropped = false;
+   self->is_connect_attempted = false;
+   MUTEX_UNLOCK(parent->lock);
+   adt_ary_destroy(&ports);
+   apx_client_unregister_event_listener(old_client, old_listener_handle);
+   apx_client_disconnect(old_client);
+   apx_client_delete(old_client);
+   return APX_NO_ERROR;
+}
+
+/**
+ * Nodes built before the connection is attached are published when the connection is established.
+ * Once a connection is attached, wait for the greeting to be accepted so new nodes are published right away.
+ */
+static bool apx_bridgeLink_is_ready(apx_bridgeLink_t* self)
+{
+   apx_clientConnection_t* connection = apx_client_get_connection(self->client);
+   return (connection == NULL) || connection->is_greeting_accepted;
+}
+
+static apx_bridgeImport_t* apx_bridgeLink_find_import(apx_bridgeLink_t* self, char const* node_name)
+{
+   int32_t i;
+   int32_t num_imports = adt_ary_length(&self->imports);
+   for (i = 0; i < num_imports; i++)
+   {
+      apx_bridgeImport_t* import = (apx_bridgeImport_t*)adt_ary_value(&self->imports, i);
+      if (strcmp(import->node_name, node_name) == 0)
+      {
+         return import;
+      }
+   }
+   return NULL;
+}
+
+static void apx_bridgeLink_vrequire_port_write(void* arg, apx_portInstance_t* port_instance, uint8_t const* data, apx_size_t size)
+{
+   apx_bridgeLink_require_port_written((apx_bridgeLink_t*)arg, port_instance, data, size);
+}
+
+static void apx_bridgeLink_vdisconnected(void* arg, struct apx_clientConnection_tag* connection)
+{
+   (void)connection;
+   apx_bridgeLink_disconnected((apx_bridgeLink_t*)arg);
+}
+
+static void* apx_bridge_register_local_listener(apx_bridge_t* self, apx_client_t* client)
+{
+   apx_clientEventListener_t listener;
+   memset(&listener, 0, sizeof(listener));
+   listener.arg = (void*)self;
+   listener.client_disconnect1 = apx_bridge_vlocal_disconnected;
+   return apx_client_register_event_listener(client, &listener);
+}
+
+/**
+ * Replaces the local client and with it all export nodes. Imported ports are exported again on the new client by
+ * the next link update if they are still wanted, ports that are no longer imported by their link are deleted.
+ */
+static apx_error_t apx_bridge_reset_local_client(apx_bridge_t* self)
+{
+   apx_client_t* old_client;
+   void* old_listener_handle;
+   int32_t i;
+   apx_client_t* client = apx_client_new();
+   if (client == NULL)
+   {
+      return APX_MEM_ERROR;
+   }
+   old_listener_handle = self->local_listener_handle;
+   self->local_listener_handle = apx_bridge_register_local_listener(self, client);
+   MUTEX_LOCK(self->lock);
+   old_client = self->local_client;
+   self->local_client = client;
+   for (i = 0; i < adt_ary_length(&self->links); i++)
+   {
+      apx_bridgeLink_t* link = (apx_bridgeLink_t*)adt_ary_value(&self->links, i);
+      int32_t j;
+      adt_ary_t ports;
+      adt_ary_create(&ports, NULL);
+      (void)adt_hash_values(&link->ports, &ports);
+      for (j = 0; j < adt_ary_length(&ports); j++)
+      {
+         apx_bridgePort_t* port = (apx_bridgePort_t*)adt_ary_value(&ports, j);
+         port->export_node = NULL;
+         port->export_offset = 0u;
+         port->is_exported = false;
+         if (!port->is_imported)
+         {
+            (void)adt_hash_remove(&link->ports, port->port_signature);
+            apx_bridgePort_delete(port);
+         }
+      }
+      adt_ary_destroy(&ports);
+   }
+   adt_hash_destroy(&self->exported);
+   adt_hash_create(&self->exported, NULL);
+   self->is_local_dropped = false;
+   self->is_local_connect_attempted = false;
+   MUTEX_UNLOCK(self->lock);
+   apx_client_unregister_event_listener(old_client, old_listener_handle);
+   apx_client_disconnect(old_client);
+   apx_client_delete(old_client);
+   return APX_NO_ERROR;
+}
+
+static void apx_bridge_vlocal_disconnected(void* arg, struct apx_clientConnection_tag* connection)
+{
+   apx_bridge_t* self = (apx_bridge_t*)arg;
+   (void)connection;
+   MUTEX_LOCK(self->lock);
+   self->is_local_dropped = true;
+   MUTEX_UNLOCK(self->lock);
+}
+
+static bool has_local_requester(apx_portSignatureMapEntry_t* entry)
+{
+   adt_list_elem_t* iter = adt_list_iter_first(&entry->require_ports);
+   while (iter != NULL)
+   {
+      apx_portInstance_t* port_instance = (apx_portInstance_t*)iter->pItem;
+      if (!is_bridge_node(apx_portInstance_parent(port_instance)))
+      {
+         return true;
+      }
+      iter = adt_list_iter_next(iter);
+   }
+   return false;
+}
+
+static bool has_local_provider(apx_portSignatureMapEntry_t* entry)
+{
+   adt_list_elem_t* iter = adt_list_iter_first(&entry->provide_ports);
+   while (iter != NULL)
+   {
+      apx_portInstance_t* port_instance = (apx_portInstance_t*)iter->pItem;
+      if (!is_bridge_node(apx_portInstance_parent(port_instance)))
+      {
+         return true;
+      }
+      iter = adt_list_iter_next(iter);
+   }
+   return false;
+}
+
+/**
+ * Returns true when any of the ports has a provider outside of bridge nodes. The caller must hold the server global lock.
+ */
+static bool is_locally_provided(apx_portSignatureMap_t* map, adt_ary_t const* ports)
+{
+   int32_t i;
+   for (i = 0; i < adt_ary_length(ports); i++)
+   {
+      apx_bridgePort_t const* port = (apx_bridgePort_t const*)adt_ary_value(ports, i);
+      apx_portSignatureMapEntry_t* entry = apx_portSignatureMap_find(map, port->port_signature);
+      if ( (entry != NULL) && has_local_provider(entry) )
+      {
+         return true;
+      }
+   }
+   return false;
+}
+
+static bool is_bridge_node(apx_nodeInstance_t* node_instance)
+{
+   char const* name = apx_nodeInstance_get_name(node_instance);
+   return (name != NULL) && (strncmp(name, APX_BRIDGE_NODE_PREFIX, strlen(APX_BRIDGE_NODE_PREFIX)) == 0);
+}
+
+static bool has_same_port_name(adt_ary_t const* ports, char const* port_signature)
+{
+   int32_t i;
+   for (i = 0; i < adt_ary_length(ports); i++)
+   {
+      apx_bridgePort_t const* port = (apx_bridgePort_t const*)adt_ary_value(ports, i);
+      if (port_name_equals(port->port_signature, port_signature))
+      {
+         return true;
+      }
+   }
+   return false;
+}
+
+/**
+ * Port signatures start with the quoted port name.
+ */
+static bool port_name_equals(char const* signature1, char const* signature2)
+{
+   char const* end1 = strchr(signature1 + 1, '"');
+   char const* end2 = strchr(signature2 + 1, '"');
+   if ( (end1 == NULL) || (end2 == NULL) || ((end1 - signature1) != (end2 - signature2)) )
+   {
+      return false;
+   }
+   return memcmp(signature1, signature2, (size_t)(end1 - signature1)) == 0;
+}
+
+static void make_node_name(char* buf, char const* bridge_name, char const* kind, uint32_t number)
+{
+   (void)snprintf(buf, NODE_NAME_MAX_SIZE, "%s%s_%s%u", APX_BRIDGE_NODE_PREFIX, bridge_name, kind, (unsigned int)number);
+}
+
+#ifndef UNIT_TEST
+/**
+ * The first attempt creates the client socket connection. Later attempts reuse it after a failed connect.
+ */
+static void connect_client(apx_client_t* client, bool* is_connect_attempted, char const* address, uint16_t tcp_port)
+{
+   if (!*is_connect_attempted)
+   {
+      *is_connect_attempted = true;
+      (void)apx_client_connect_tcp(client, address, tcp_port);
+   }
+   else
+   {
+      apx_clientSocketConnection_t* connection = (apx_clientSocketConnection_t*)apx_client_get_connection(client);
+      if ( (connection != NULL) && (connection->socket_object == NULL) )
+      {
+         (void)apx_clientConnection_tcp_connect(connection, address, tcp_port);
+      }
+   }
+}
+
+static apx_error_t apx_bridge_start_thread(apx_bridge_t* self)
+{
+   self->is_worker_valid = true;
+#ifdef _MSC_VER
+   THREAD_CREATE(self->worker_thread, worker_task, self, self->thread_id);
+   if (self->worker_thread == INVALID_HANDLE_VALUE)
+   {
+      self->is_worker_valid = false;
+      self->is_running = false;
+      return APX_THREAD_CREATE_ERROR;
+   }
+#else
+   if (THREAD_CREATE(self->worker_thread, worker_task, self) != 0)
+   {
+      self->is_worker_valid = false;
+      self->is_running = false;
+      return APX_THREAD_CREATE_ERROR;
+   }
+#endif
+   return APX_NO_ERROR;
+}
+
+static void apx_bridge_stop_thread(apx_bridge_t* self)
+{
+   if (self->is_worker_valid)
+   {
+#ifdef _MSC_VER
+      (void)WaitForSingleObject(self->worker_thread, INFINITE);
+      CloseHandle(self->worker_thread);
+      self->worker_thread = INVALID_HANDLE_VALUE;
+#else
+      (void)pthread_join(self->worker_thread, NULL);
+#endif
+      self->is_worker_valid = false;
+   }
+}
+
+static THREAD_PROTO(worker_task, arg)
+{
+   apx_bridge_t* self = (apx_bridge_t*)arg;
+   if (self != NULL)
+   {
+      for (;;)
+      {
+         int32_t i;
+         bool is_running;
+         MUTEX_LOCK(self->lock);
+         is_running = self->is_running;
+         MUTEX_UNLOCK(self->lock);
+         if (!is_running)
+         {
+            break;
+         }
+         connect_client(self->local_client, &self->is_local_connect_attempted, self->local_address, self->local_tcp_port);
+         for (i = 0; i < adt_ary_length(&self->links); i++)
+         {
+            apx_bridgeLink_t* link = (apx_bridgeLink_t*)adt_ary_value(&self->links, i);
+            connect_client(link->client, &link->is_connect_attempted, link->address, link->tcp_port);
+         }
+         (void)apx_bridge_run(self);
+         SLEEP(self->poll_interval_ms);
+      }
+   }
+   THREAD_RETURN(0);
+}
+#endif
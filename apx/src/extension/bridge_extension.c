@@ -0,0 +1,247 @@
+/*****************************************************************************
+* \file      bridge_extension.c
+* \author    Conny Gustafsson
+* \date      2026-10-18
+* \brief     Bridge server extension
+*
+* Copyright (c) 2026 Conny Gustafsson
+* Permission is hereby granted, free of charge, to any person obtaining a copy of
+* this software and associated documentation files (the "Software"), to deal in
+* the Software without restriction, including without limitation the rights to
+* use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+* the Software, and to permit persons to whom the Software is furnished to do so,
+* subject to the following conditions:
+
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+* FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+* COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+* IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+* CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+******************************************************************************/
+//////////////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////////////
+#include <stdint.h>
+#include "apx/extension/bridge_extension.h"
+#include "apx/extension/bridge.h"
+#include "apx/server.h"
+#ifdef MEM_LEAK_CHECK
+#include "CMemLeak.h"
+#endif
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE CONSTANTS AND DATA TYPES
+//////////////////////////////////////////////////////////////////////////////
+#define APX_BRIDGE_LABEL "BRIDGE"
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////////////
+static bool apx_bridgeExtension_is_enabled(dtl_dv_t *config);
+static apx_error_t apx_bridgeExtension_init(struct apx_server_tag *apx_server, dtl_dv_t *config);
+static void apx_bridgeExtension_shutdown(void);
+static apx_error_t apx_bridgeExtension_configure(apx_bridge_t *bridge, dtl_hv_t *cfg);
+static apx_error_t apx_bridgeExtension_read_port(dtl_hv_t *hv, const char *key, uint16_t *tcp_port);
+static apx_error_t apx_bridgeExtension_add_peers(apx_bridge_t *bridge, dtl_dv_t *dv);
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE VARIABLES
+//////////////////////////////////////////////////////////////////////////////
+static apx_bridge_t *m_instance = (apx_bridge_t*) 0; //singleton
+
+//////////////////////////////////////////////////////////////////////////////
+// PUBLIC FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+apx_error_t apx_bridgeExtension_register(struct apx_server_tag *apx_server, dtl_dv_t *config)
+{
+   if (apx_bridgeExtension_is_enabled(config))
+   {
+      apx_serverExtensionHandler_t handler = {apx_bridgeExtension_init, apx_bridgeExtension_shutdown};
+      return apx_server_add_extension(apx_server, APX_BRIDGE_LABEL, &handler, config);
+   }
+   return APX_NO_ERROR;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+static bool apx_bridgeExtension_is_enabled(dtl_dv_t *config)
+{
+   if ( (config != 0) && (dtl_dv_type(config) == DTL_DV_HASH) )
+   {
+      dtl_sv_t *sv_enabled = (dtl_sv_t*) dtl_hv_get_cstr((dtl_hv_t*) config, "extension-enabled");
+      if (sv_enabled != 0)
+      {
+         bool conversion_ok;
+         bool enabled = dtl_sv_to_bool(sv_enabled, &conversion_ok);
+         return conversion_ok && enabled;
+      }
+   }
+   return false;
+}
+
+static apx_error_t apx_bridgeExtension_init(struct apx_server_tag *apx_server, dtl_dv_t *config)
+{
+   if (m_instance == 0)
+   {
+      apx_error_t result;
+      const char *name = APX_BRIDGE_DEFAULT_NAME;
+      dtl_sv_t *sv_name = (dtl_sv_t*) dtl_hv_get_cstr((dtl_hv_t*) config, "name");
+      if (sv_name != 0)
+      {
+         bool conversion_ok;
+         name = dtl_sv_to_cstr(sv_name, &conversion_ok);
+         if (!conversion_ok)
+         {
+            return APX_VALUE_TYPE_ERROR;
+         }
+      }
+      m_instance = apx_bridge_new(apx_server, name);
+      if (m_instance == 0)
+      {
+         return APX_MEM_ERROR;
+      }
+      result = apx_bridgeExtension_configure(m_instance, (dtl_hv_t*) config);
+      if (result == APX_NO_ERROR)
+      {
+         result = apx_bridge_start(m_instance);
+      }
+      if (result != APX_NO_ERROR)
+      {
+         apx_bridgeExtension_shutdown();
+         return result;
+      }
+   }
+   return APX_NO_ERROR;
+}
+
+static void apx_bridgeExtension_shutdown(void)
+{
+   if (m_instance != 0)
+   {
+      apx_bridge_delete(m_instance);
+      m_instance = (apx_bridge_t*) 0;
+   }
+}
+
+/**
+ * Example:
+ * "bridge": {"extension-enabled": true, "name": "ServerA", "local-port": 5000, "poll-interval-ms": 100,
+ *            "unsubscribe-delay-ms": 5000, "peers": [{"address": "127.0.0.1", "tcp-port": 5001}]}
+ */
+static apx_error_t apx_bridgeExtension_configure(apx_bridge_t *bridge, dtl_hv_t *cfg)
+{
+   apx_error_t result;
+   uint16_t local_port = 0u;
+   dtl_sv_t *sv_local_address = (dtl_sv_t*) dtl_hv_get_cstr(cfg, "local-address");
+   dtl_sv_t *sv_poll_interval = (dtl_sv_t*) dtl_hv_get_cstr(cfg, "poll-interval-ms");
+   dtl_sv_t *sv_unsubscribe_delay = (dtl_sv_t*) dtl_hv_get_cstr(cfg, "unsubscribe-delay-ms");
+   const char *local_address = APX_BRIDGE_LOCAL_ADDRESS;
+   bool conversion_ok;
+
+   result = apx_bridgeExtension_read_port(cfg, "local-port", &local_port);
+   if (result != APX_NO_ERROR)
+   {
+      return result;
+   }
+   if (sv_local_address != 0)
+   {
+      local_address = dtl_sv_to_cstr(sv_local_address, &conversion_ok);
+      if (!conversion_ok)
+      {
+         return APX_VALUE_TYPE_ERROR;
+      }
+   }
+   result = apx_bridge_set_local_endpoint(bridge, local_address, local_port);
+   if (result != APX_NO_ERROR)
+   {
+      return result;
+   }
+   if (sv_poll_interval != 0)
+   {
+      uint32_t poll_interval_ms = dtl_sv_to_u32(sv_poll_interval, &conversion_ok);
+      if (!conversion_ok)
+      {
+         return APX_VALUE_TYPE_ERROR;
+      }
+      apx_bridge_set_poll_interval(bridge, poll_interval_ms);
+   }
+   if (sv_unsubscribe_delay != 0)
+   {
+      uint32_t unsubscribe_delay_ms = dtl_sv_to_u32(sv_unsubscribe_delay, &conversion_ok);
+      if (!conversion_ok)
+      {
+         return APX_VALUE_TYPE_ERROR;
+      }
+      apx_bridge_set_unsubscribe_delay(bridge, unsubscribe_delay_ms);
+   }
+   return apx_bridgeExtension_add_peers(bridge, dtl_hv_get_cstr(cfg, "peers"));
+}
+
+static apx_error_t apx_bridgeExtension_read_port(dtl_hv_t *hv, const char *key, uint16_t *tcp_port)
+{
+   dtl_sv_t *sv = (dtl_sv_t*) dtl_hv_get_cstr(hv, key);
+   if (sv != 0)
+   {
+      bool conversion_ok;
+      uint32_t value = dtl_sv_to_u32(sv, &conversion_ok);
+      if (conversion_ok && (value > 0u) && (value <= UINT16_MAX))
+      {
+         *tcp_port = (uint16_t) value;
+         return APX_NO_ERROR;
+      }
+      return APX_VALUE_TYPE_ERROR;
+   }
+   return APX_MISSING_KEY_ERROR;
+}
+
+static apx_error_t apx_bridgeExtension_add_peers(apx_bridge_t *bridge, dtl_dv_t *dv)
+{
+   int32_t i;
+   int32_t num_peers;
+   if ( (dv == 0) || (dtl_dv_type(dv) != DTL_DV_ARRAY) )
+   {
+      return APX_MISSING_KEY_ERROR;
+   }
+   num_peers = dtl_av_length((dtl_av_t*) dv);
+   for (i = 0; i < num_peers; i++)
+   {
+      apx_error_t result;
+      dtl_hv_t *hv_peer = (dtl_hv_t*) dtl_av_value((dtl_av_t*) dv, i);
+      dtl_sv_t *sv_address;
+      const char *address;
+      uint16_t tcp_port = 0u;
+      bool conversion_ok;
+      if ( (hv_peer == 0) || (dtl_dv_type((dtl_dv_t*) hv_peer) != DTL_DV_HASH) )
+      {
+         return APX_VALUE_TYPE_ERROR;
+      }
+      sv_address = (dtl_sv_t*) dtl_hv_get_cstr(hv_peer, "address");
+      if (sv_address == 0)
+      {
+         return APX_MISSING_KEY_ERROR;
+      }
+      address = dtl_sv_to_cstr(sv_address, &conversion_ok);
+      if (!conversion_ok)
+      {
+         return APX_VALUE_TYPE_ERROR;
+      }
+      result = apx_bridgeExtension_read_port(hv_peer, "tcp-port", &tcp_port);
+      if (result != APX_NO_ERROR)
+      {
+         return result;
+      }
+      if (apx_bridge_add_peer(bridge, address, tcp_port) == 0)
+      {
+         return APX_MEM_ERROR;
+      }
+   }
+   return APX_NO_ERROR;
+}
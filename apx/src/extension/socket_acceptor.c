@@ -0,0 +1,359 @@
+/*****************************************************************************
+* \file      socket_acceptor.c
+* \author    Conny Gustafsson
+* \date      2026-10-18
+* \brief     Multi-threaded TCP acceptor using SO_REUSEPORT
+*
+* Copyright (c) 2026 Conny Gustafsson
+* Permission is hereby granted, free of charge, to any person obtaining a copy of
+* this software and associated documentation files (the "Software"), to deal in
+* the Software without restriction, including without limitation the rights to
+* use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+* the Software, and to permit persons to whom the Software is furnished to do so,
+* subject to the following conditions:
+
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+* FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+* COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+* IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+* CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+******************************************************************************/
+//////////////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////////////
+#include <malloc.h>
+#include <string.h>
+#include "apx/extension/socket_acceptor.h"
+#if APX_SOCKET_ACCEPTOR_SUPPORTED
+#include <errno.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#endif
+#ifdef MEM_LEAK_CHECK
+#include "CMemLeak.h"
+#endif
+
+#if APX_SOCKET_ACCEPTOR_SUPPORTED
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE CONSTANTS AND DATA TYPES
+//////////////////////////////////////////////////////////////////////////////
+#define STOP_REQUEST (-1) //queued once per setup thread on stop
+#define OUT_OF_RESOURCES_DELAY_MS 10
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////////////
+static THREAD_PROTO(accept_task, arg);
+static THREAD_PROTO(setup_task, arg);
+static int open_listen_socket(uint16_t tcp_port);
+static void push_socket(apx_socketAcceptor_t *self, int fd);
+static int pop_socket(apx_socketAcceptor_t *self);
+static bool is_running(apx_socketAcceptor_t *self);
+static void close_listen_sockets(apx_socketAcceptor_t *self);
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE VARIABLES
+//////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////
+// PUBLIC FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+void apx_socketAcceptor_create(apx_socketAcceptor_t *self, apx_socketAcceptorHandlerFunc *handler, void *handler_arg)
+{
+   if (self != 0)
+   {
+      uint32_t i;
+      self->handler = handler;
+      self->handler_arg = handler_arg;
+      for (i = 0u; i < APX_SOCKET_ACCEPTOR_MAX_THREADS; i++)
+      {
+         self->threads[i].parent = self;
+         self->threads[i].listen_fd = -1;
+      }
+      self->queue_head = 0u;
+      self->queue_tail = 0u;
+      self->num_threads = 0u;
+      self->num_accepted = 0u;
+      self->tcp_port = 0u;
+      self->is_running = false;
+      MUTEX_INIT(self->queue_lock);
+      SEMAPHORE_CREATE(self->queue_items);
+      (void)sem_init(&self->queue_space, 0, APX_SOCKET_ACCEPTOR_QUEUE_SIZE);
+   }
+}
+
+void apx_socketAcceptor_destroy(apx_socketAcceptor_t *self)
+{
+   if (self != 0)
+   {
+      apx_socketAcceptor_stop(self);
+      SEMAPHORE_DESTROY(self->queue_space);
+      SEMAPHORE_DESTROY(self->queue_items);
+      MUTEX_DESTROY(self->queue_lock);
+   }
+}
+
+apx_socketAcceptor_t* apx_socketAcceptor_new(apx_socketAcceptorHandlerFunc *handler, void *handler_arg)
+{
+   apx_socketAcceptor_t *self = (apx_socketAcceptor_t*) malloc(sizeof(apx_socketAcceptor_t));
+   if (self != 0)
+   {
+      apx_socketAcceptor_create(self, handler, handler_arg);
+   }
+   return self;
+}
+
+void apx_socketAcceptor_delete(apx_socketAcceptor_t *self)
+{
+   if (self != 0)
+   {
+      apx_socketAcceptor_destroy(self);
+      free(self);
+   }
+}
+
+/**
+ * Binds num_threads listening sockets to tcp_port and starts one accept thread and one setup thread per socket.
+ * When tcp_port is 0 the first socket gets an ephemeral port which the others then share.
+ */
+apx_error_t apx_socketAcceptor_start(apx_socketAcceptor_t *self, uint16_t tcp_port, uint32_t num_threads)
+{
+   if ( (self != 0) && (self->handler != 0) && (num_threads > 0u) && (num_threads <= APX_SOCKET_ACCEPTOR_MAX_THREADS) && (!self->is_running) )
+   {
+      uint32_t i;
+      for (i = 0u; i < num_threads; i++)
+      {
+         self->threads[i].listen_fd = open_listen_socket(tcp_port);
+         if (self->threads[i].listen_fd < 0)
+         {
+            close_listen_sockets(self);
+            return APX_CONNECTION_ERROR;
+         }
+         if (tcp_port == 0u)
+         {
+            struct sockaddr_in addr;
+            socklen_t addr_len = (socklen_t)sizeof(addr);
+            if (getsockname(self->threads[i].listen_fd, (struct sockaddr*) &addr, &addr_len) != 0)
+            {
+               close_listen_sockets(self);
+               return APX_CONNECTION_ERROR;
+            }
+            tcp_port = ntohs(addr.sin_port);
+         }
+      }
+      self->tcp_port = tcp_port;
+      self->is_running = true;
+      for (i = 0u; i < num_threads; i++)
+      {
+         apx_socketAcceptorThread_t *thread = &self->threads[i];
+         if (THREAD_CREATE(thread->setup_thread, setup_task, self) != 0)
+         {
+            break;
+         }
+         if (THREAD_CREATE(thread->accept_thread, accept_task, thread) != 0)
+         {
+            push_socket(self, STOP_REQUEST);
+            (void)pthread_join(thread->setup_thread, NULL);
+            break;
+         }
+         self->num_threads++;
+      }
+      if (self->num_threads != num_threads)
+      {
+         apx_socketAcceptor_stop(self);
+         return APX_THREAD_CREATE_ERROR;
+      }
+      return APX_NO_ERROR;
+   }
+   return APX_INVALID_ARGUMENT_ERROR;
+}
+
+/**
+ * Stops accepting. Sockets already accepted but not yet given to the handler are closed.
+ */
+void apx_socketAcceptor_stop(apx_socketAcceptor_t *self)
+{
+   if (self != 0)
+   {
+      uint32_t i;
+      MUTEX_LOCK(self->queue_lock);
+      self->is_running = false;
+      MUTEX_UNLOCK(self->queue_lock);
+      for (i = 0u; i < self->num_threads; i++)
+      {
+         //Makes the blocking accept call return
+         (void)shutdown(self->threads[i].listen_fd, SHUT_RDWR);
+      }
+      for (i = 0u; i < self->num_threads; i++)
+      {
+         (void)pthread_join(self->threads[i].accept_thread, NULL);
+      }
+      for (i = 0u; i < self->num_threads; i++)
+      {
+         push_socket(self, STOP_REQUEST);
+      }
+      for (i = 0u; i < self->num_threads; i++)
+      {
+         (void)pthread_join(self->threads[i].setup_thread, NULL);
+      }
+      self->num_threads = 0u;
+      close_listen_sockets(self);
+      while (self->queue_head != self->queue_tail)
+      {
+         int fd = pop_socket(self);
+         if (fd >= 0)
+         {
+            close(fd);
+         }
+      }
+   }
+}
+
+uint16_t apx_socketAcceptor_get_port(apx_socketAcceptor_t const *self)
+{
+   if (self != 0)
+   {
+      return self->tcp_port;
+   }
+   return 0u;
+}
+
+uint32_t apx_socketAcceptor_get_num_accepted(apx_socketAcceptor_t *self)
+{
+   uint32_t retval = 0u;
+   if (self != 0)
+   {
+      MUTEX_LOCK(self->queue_lock);
+      retval = self->num_accepted;
+      MUTEX_UNLOCK(self->queue_lock);
+   }
+   return retval;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+static THREAD_PROTO(accept_task, arg)
+{
+   apx_socketAcceptorThread_t *thread = (apx_socketAcceptorThread_t*) arg;
+   apx_socketAcceptor_t *self = thread->parent;
+   while (is_running(self))
+   {
+      int fd = accept(thread->listen_fd, NULL, NULL);
+      if (fd >= 0)
+      {
+         push_socket(self, fd);
+      }
+      else if ( (errno == EMFILE) || (errno == ENFILE) || (errno == ENOBUFS) || (errno == ENOMEM) )
+      {
+         //Wait for connection cleanup to release some resources
+         SLEEP(OUT_OF_RESOURCES_DELAY_MS);
+      }
+      else if ( (errno != EINTR) && (errno != ECONNABORTED) )
+      {
+         break; //listening socket was shut down
+      }
+   }
+   THREAD_RETURN(0);
+}
+
+static THREAD_PROTO(setup_task, arg)
+{
+   apx_socketAcceptor_t *self = (apx_socketAcceptor_t*) arg;
+   for (;;)
+   {
+      int fd = pop_socket(self);
+      if (fd == STOP_REQUEST)
+      {
+         break;
+      }
+      self->handler(self->handler_arg, fd);
+   }
+   THREAD_RETURN(0);
+}
+
+static int open_listen_socket(uint16_t tcp_port)
+{
+   struct sockaddr_in addr;
+   int flag = 1;
+   int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+   if (fd < 0)
+   {
+      return -1;
+   }
+   memset(&addr, 0, sizeof(addr));
+   addr.sin_family = AF_INET;
+   addr.sin_addr.s_addr = htonl(INADDR_ANY);
+   addr.sin_port = htons(tcp_port);
+   if ( (setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &flag, (socklen_t)sizeof(flag)) != 0) ||
+        (setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &flag, (socklen_t)sizeof(flag)) != 0) ||
+        (bind(fd, (struct sockaddr*) &addr, (socklen_t)sizeof(addr)) != 0) ||
+        (listen(fd, SOMAXCONN) != 0) )
+   {
+      close(fd);
+      return -1;
+   }
+   return fd;
+}
+
+/**
+ * Blocks while the queue is full. The kernel then keeps new connections in the listen backlog.
+ */
+static void push_socket(apx_socketAcceptor_t *self, int fd)
+{
+   while (sem_wait(&self->queue_space) != 0)
+   {
+   }
+   MUTEX_LOCK(self->queue_lock);
+   self->queue[self->queue_tail] = fd;
+   self->queue_tail = (self->queue_tail + 1u) % APX_SOCKET_ACCEPTOR_QUEUE_SIZE;
+   if (fd != STOP_REQUEST)
+   {
+      self->num_accepted++;
+   }
+   MUTEX_UNLOCK(self->queue_lock);
+   SEMAPHORE_POST(self->queue_items);
+}
+
+static int pop_socket(apx_socketAcceptor_t *self)
+{
+   int fd;
+   while (sem_wait(&self->queue_items) != 0)
+   {
+   }
+   MUTEX_LOCK(self->queue_lock);
+   fd = self->queue[self->queue_head];
+   self->queue_head = (self->queue_head + 1u) % APX_SOCKET_ACCEPTOR_QUEUE_SIZE;
+   MUTEX_UNLOCK(self->queue_lock);
+   SEMAPHORE_POST(self->queue_space);
+   return fd;
+}
+
+static bool is_running(apx_socketAcceptor_t *self)
+{
+   bool retval;
+   MUTEX_LOCK(self->queue_lock);
+   retval = self->is_running;
+   MUTEX_UNLOCK(self->queue_lock);
+   return retval;
+}
+
+static void close_listen_sockets(apx_socketAcceptor_t *self)
+{
+   uint32_t i;
+   for (i = 0u; i < APX_SOCKET_ACCEPTOR_MAX_THREADS; i++)
+   {
+      if (self->threads[i].listen_fd >= 0)
+      {
+         close(self->threads[i].listen_fd);
+         self->threads[i].listen_fd = -1;
+      }
+   }
+}
+
+#endif //APX_SOCKET_ACCEPTOR_SUPPORTED
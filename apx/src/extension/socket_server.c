@@ -34,6 +34,9 @@
 #include "apx/extension/socket_server.h"
 #include "apx/server.h"
 #include "apx/extension/socket_server_connection.h"
+#if APX_SOCKET_ACCEPTOR_SUPPORTED && !defined(UNIT_TEST)
+#include <unistd.h>
+#endif
 #ifdef MEM_LEAK_CHECK
 #include "CMemLeak.h"
 #endif
@@ -65,6 +68,9 @@ struct msocket_server_tag;
 // PRIVATE FUNCTION PROTOTYPES
 //////////////////////////////////////////////////////////////////////////////
 static void apx_socketServer_tcp_accept(void *arg, struct msocket_server_tag *srv, SOCKET_TYPE *sock);
+#if APX_SOCKET_ACCEPTOR_SUPPORTED && !defined(UNIT_TEST)
+static void apx_socketServer_tcp_accept_fd(void *arg, int fd);
+#endif
 #if !defined(UNIT_TEST) && !defined(_WIN32)
 static void apx_socketServer_unix_accept(void *arg, struct msocket_server_tag *srv, SOCKET_TYPE *sock);
 #endif
@@ -87,6 +93,13 @@ void apx_socketServer_create(apx_socketServer_t *self, struct apx_server_tag *ap
       self->is_unix_server_started = false;
       self->tcp_connection_tag = (char*) 0;
       self->unix_connection_tag = (char*) 0;
+      apx_socketBatchingCfg_set_defaults(&self->tcp_batching);
+      apx_socketBatchingCfg_set_defaults(&self->unix_batching);
+      self->unix_shm_transport = false;
+      self->num_tcp_acceptors = 1u;
+#if APX_SOCKET_ACCEPTOR_SUPPORTED
+      self->tcp_acceptor = (apx_socketAcceptor_t*) 0;
+#endif
    }
 }
 
@@ -139,6 +152,21 @@ void apx_socketServer_start_tcp_server(apx_socketServer_t *self, uint16_t tcp_po
       {
          self->tcp_connection_tag = STRDUP(tag);
       }
+#if APX_SOCKET_ACCEPTOR_SUPPORTED && !defined(UNIT_TEST)
+      if (self->num_tcp_acceptors > 1u)
+      {
+         self->tcp_acceptor = apx_socketAcceptor_new(apx_socketServer_tcp_accept_fd, (void*) self);
+         if ( (self->tcp_acceptor != 0) && (apx_socketAcceptor_start(self->tcp_acceptor, self->tcp_port, self->num_tcp_acceptors) == APX_NO_ERROR) )
+         {
+            self->is_tcp_server_started = true;
+            printf("Listening on TCP port %d (%d acceptor threads)\n", (int) self->tcp_port, (int) self->num_tcp_acceptors);
+            return;
+         }
+         //Fall back to single accept thread
+         apx_socketAcceptor_delete(self->tcp_acceptor);
+         self->tcp_acceptor = (apx_socketAcceptor_t*) 0;
+      }
+#endif
       memset(&server_handler,0,sizeof(server_handler));
 #ifndef UNIT_TEST
       server_handler.tcp_accept = apx_socketServer_tcp_accept;
@@ -198,7 +226,19 @@ void apx_socketServer_stop_tcp_server(apx_socketServer_t *self)
 {
    if ( (self != 0) && (self->is_tcp_server_started) )
    {
+#if APX_SOCKET_ACCEPTOR_SUPPORTED
+      if (self->tcp_acceptor != 0)
+      {
+         apx_socketAcceptor_delete(self->tcp_acceptor);
+         self->tcp_acceptor = (apx_socketAcceptor_t*) 0;
+      }
+      else
+      {
+         msocket_server_destroy(&self->tcp_server);
+      }
+#else
       msocket_server_destroy(&self->tcp_server);
+#endif
       self->is_tcp_server_started = false;
    }
 }
@@ -216,6 +256,46 @@ void apx_socketServer_stop_unix_server(apx_socketServer_t *self)
 }
 #endif
 
+void apx_socketServer_set_tcp_batching(apx_socketServer_t *self, apx_socketBatchingCfg_t const *cfg)
+{
+   if ( (self != 0) && (cfg != 0) )
+   {
+      memcpy(&self->tcp_batching, cfg, sizeof(apx_socketBatchingCfg_t));
+   }
+}
+
+void apx_socketServer_set_unix_batching(apx_socketServer_t *self, apx_socketBatchingCfg_t const *cfg)
+{
+   if ( (self != 0) && (cfg != 0) )
+   {
+      memcpy(&self->unix_batching, cfg, sizeof(apx_socketBatchingCfg_t));
+   }
+}
+
+void apx_socketServer_set_unix_shm_transport(apx_socketServer_t *self, bool enable)
+{
+   if (self != 0)
+   {
+      self->unix_shm_transport = enable;
+   }
+}
+
+void apx_socketServer_set_tcp_acceptors(apx_socketServer_t *self, uint32_t num_acceptors)
+{
+   if (self != 0)
+   {
+      if (num_acceptors == 0u)
+      {
+         num_acceptors = 1u;
+      }
+      else if (num_acceptors > APX_SOCKET_ACCEPTOR_MAX_THREADS)
+      {
+         num_acceptors = APX_SOCKET_ACCEPTOR_MAX_THREADS;
+      }
+      self->num_tcp_acceptors = num_acceptors;
+   }
+}
+
 #ifdef UNIT_TEST
 void apx_socketServer_accept_testsocket(apx_socketServer_t *self, testsocket_t *sock)
 {
@@ -240,6 +320,7 @@ static void apx_socketServer_tcp_accept(void *arg, struct msocket_server_tag *sr
       ///TODO: Add support for connection tag
       if (new_connection != NULL)
       {
+         apx_socketServerConnection_set_batching(new_connection, &self->tcp_batching);
          apx_server_accept_connection(self->parent, (apx_serverConnection_t*)new_connection);
       }
       else
@@ -250,6 +331,24 @@ static void apx_socketServer_tcp_accept(void *arg, struct msocket_server_tag *sr
    }
 }
 
+#if APX_SOCKET_ACCEPTOR_SUPPORTED && !defined(UNIT_TEST)
+/**
+ * Runs on a setup thread of tcp_acceptor. Wraps the accepted socket the same way msocket_server does.
+ */
+static void apx_socketServer_tcp_accept_fd(void *arg, int fd)
+{
+   msocket_t *sock = msocket_new(AF_INET);
+   if (sock == 0)
+   {
+      close(fd);
+      return;
+   }
+   sock->tcpsockfd = fd;
+   sock->state = MSOCKET_STATE_ESTABLISHED;
+   apx_socketServer_tcp_accept(arg, (struct msocket_server_tag*) 0, sock);
+}
+#endif
+
 #if !defined(UNIT_TEST) && !defined(_WIN32)
 static void apx_socketServer_unix_accept(void *arg, struct msocket_server_tag *srv, SOCKET_TYPE *sock)
 {
@@ -263,6 +362,8 @@ static void apx_socketServer_unix_accept(void *arg, struct msocket_server_tag *s
       ///TODO: Add support for connection tag
       if (new_connection != 0)
       {
+         apx_socketServerConnection_set_batching(new_connection, &self->unix_batching);
+         apx_socketServerConnection_enable_shm_transport(new_connection, self->unix_shm_transport);
          apx_server_accept_connection(self->parent, (apx_serverConnection_t*)new_connection);
       }
       else
@@ -43,11 +43,19 @@
 #else
 #include "msocket.h"
 #endif
+#if !defined(UNIT_TEST) && !defined(_WIN32)
+#include <sys/uio.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#endif
 #include "apx/extension/socket_server_connection.h"
 #include "apx/file_manager.h"
 #include "apx/numheader.h"
 #include "bstr.h"
 #include "apx/server.h"
+#include "apx/remotefile.h"
+#include "apx/util.h"
 #ifdef MEM_LEAK_CHECK
 #include "CMemLeak.h"
 #endif
@@ -57,6 +65,11 @@
 // PRIVATE CONSTANTS AND DATA TYPES
 //////////////////////////////////////////////////////////////////////////////
 #define SEND_BUFFER_GROW_SIZE 4096 //4KB
+#define SEND_ZERO_COPY_MIN_SIZE 512 //Payloads of this size or larger are not copied into send_buffer
+#define MAX_SEND_SEGMENTS 4
+#define SEND_BACKLOG_MAX_SIZE 4194304 //4MB, a peer that falls further behind than this is disconnected
+#define SEND_RETRY_INTERVAL_US 1000 //how often the worker retries sending data the socket did not accept
+#define SOCKET_RECEIVE_BUFFER_SIZE 262144 //256KB, lets most messages arrive whole so they can be parsed without reassembly
 //#define MAX_DEBUG_BYTES 100
 //#define MAX_DEBUG_MSG_SIZE 400
 //#define HEX_DATA_LEN 3u
@@ -77,6 +90,24 @@
 #define SOCKET_OBJECT_CLOSE(x) msocket_close(x)
 #endif
 
+#if !defined(UNIT_TEST) && !defined(_WIN32)
+#define SOCKET_HAS_SENDMSG 1
+#else
+#define SOCKET_HAS_SENDMSG 0
+#endif
+
+#ifdef MSG_NOSIGNAL
+#define SOCKET_SEND_FLAGS MSG_NOSIGNAL
+#else
+#define SOCKET_SEND_FLAGS 0 //SIGPIPE is instead suppressed with SO_NOSIGPIPE where available
+#endif
+
+typedef struct send_segment_tag
+{
+   uint8_t const* data;
+   apx_size_t size;
+} send_segment_t;
+
 
 //////////////////////////////////////////////////////////////////////////////
 // PRIVATE FUNCTION PROTOTYPES
@@ -91,6 +122,12 @@ static int8_t socket_data_notification(void* arg, const uint8_t* data, uint32_t
 //APX BaseConnection API
 static void connection_close(apx_socketServerConnection_t* self);
 static void connection_start(apx_socketServerConnection_t* self);
+static void connection_greeting_header_notification(apx_socketServerConnection_t* self, char const* header_line);
+static void connection_vgreeting_header_notification(void* arg, char const* header_line);
+#if APX_SHM_TRANSPORT_SUPPORTED
+static void connection_open_shm_transport(apx_socketServerConnection_t* self, char const* name);
+#endif
+static void connection_close_shm_transport(apx_socketServerConnection_t* self);
 
 // ConnectionInterface API
 static int32_t connection_transmit_max_bytes_avaiable(apx_socketServerConnection_t* self);
@@ -100,6 +137,23 @@ static void connection_transmit_end(apx_socketServerConnection_t* self);
 static apx_error_t connection_transmit_data_message(apx_socketServerConnection_t* self, uint32_t write_address, bool more_bit, uint8_t const* msg_data, int32_t msg_size, int32_t* bytes_available);
 static apx_error_t connection_transmit_direct_message(apx_socketServerConnection_t* self, uint8_t const* msg_data, int32_t msg_size, int32_t* bytes_available);
 static void connection_send_packet(apx_socketServerConnection_t* self);
+static apx_error_t connection_send_with_external_payload(apx_socketServerConnection_t* self, uint8_t const* header, apx_size_t header_size, uint8_t const* payload, apx_size_t payload_size);
+static void connection_append_to_send_buffer(apx_socketServerConnection_t* self, uint8_t const* data, apx_size_t size);
+static int connection_send_segments(apx_socketServerConnection_t* self, send_segment_t const* segments, int num_segments);
+static int connection_send_unsent(apx_socketServerConnection_t* self);
+static int connection_keep_unsent(apx_socketServerConnection_t* self, uint8_t const* data, apx_size_t size);
+static void connection_count_bytes_written(apx_socketServerConnection_t* self, apx_size_t size);
+static void connection_on_send_error(apx_socketServerConnection_t* self);
+static int32_t socket_write_segments(apx_socketServerConnection_t* self, send_segment_t const* segments, int num_segments);
+static int32_t connection_transmit_flush_deadline(apx_socketServerConnection_t* self);
+static void connection_flush_before_end(apx_socketServerConnection_t* self);
+static bool connection_is_flush_deadline_expired(apx_socketServerConnection_t* self);
+static void connection_set_cork(apx_socketServerConnection_t* self, bool enable);
+static void connection_apply_socket_options(apx_socketServerConnection_t* self);
+#if !defined(UNIT_TEST)
+static bool socket_is_tcp(apx_socketServerConnection_t* self);
+static bool socket_set_option(apx_socketServerConnection_t* self, int level, int name, int value);
+#endif
 
 
 //////////////////////////////////////////////////////////////////////////////
@@ -118,19 +172,42 @@ apx_error_t apx_socketServerConnection_create(apx_socketServerConnection_t *self
       MUTEX_INIT(self->lock);
       self->default_buffer_size = SEND_BUFFER_GROW_SIZE;
       self->pending_bytes = 0u;
+      self->total_bytes_copied = 0u;
+      self->total_bytes_written = 0u;
+      self->pending_since_us = 0u;
+      self->is_corked = false;
+      self->is_tcp = false;
+      self->is_send_failed = false;
+      self->is_shm_enabled = false;
+#ifdef UNIT_TEST
+      self->write_limit = -1;
+#endif
+      self->shm_transport = NULL;
+      apx_socketBatchingCfg_set_defaults(&self->batching);
       apx_connectionBaseVTable_create(&base_connection_vtable,
          apx_socketServerConnection_vdestroy,
          apx_socketServerConnection_vstart,
          apx_socketServerConnection_vclose);
+      base_connection_vtable.greeting_header_notification = connection_vgreeting_header_notification;
       create_connection_interface_vtable(self, &connection_interface);
       apx_error_t retval = apx_serverConnection_create(&self->base, &base_connection_vtable, &connection_interface);
       if (retval == APX_NO_ERROR)
       {
          adt_bytearray_create(&self->send_buffer, SEND_BUFFER_GROW_SIZE);
+         adt_bytearray_create(&self->unsent_buffer, SEND_BUFFER_GROW_SIZE);
+         if (adt_bytearray_resize(&self->send_buffer, self->default_buffer_size) != ADT_NO_ERROR)
+         {
+            apx_serverConnection_destroy(&self->base);
+            adt_bytearray_destroy(&self->send_buffer);
+            adt_bytearray_destroy(&self->unsent_buffer);
+            MUTEX_DESTROY(self->lock);
+            return APX_MEM_ERROR;
+         }
          register_msocket_handler(self, socket_object);
       }
       if (retval == APX_NO_ERROR)
       {
+         self->base.base.local_capabilities.receive_buffer_size = SOCKET_RECEIVE_BUFFER_SIZE;
          apx_nodeManager_create(&self->node_manager, APX_SERVER_MODE);
          apx_serverConnection_attach_node_manager(&self->base, &self->node_manager);
       }
@@ -143,8 +220,14 @@ void apx_socketServerConnection_destroy(apx_socketServerConnection_t *self)
 {
    if (self != NULL)
    {
+      if (self->shm_transport != NULL)
+      {
+         apx_shmTransport_stop(self->shm_transport);
+      }
       apx_serverConnection_destroy(&self->base);
+      connection_close_shm_transport(self);
       adt_bytearray_destroy(&self->send_buffer);
+      adt_bytearray_destroy(&self->unsent_buffer);
       apx_nodeManager_destroy(&self->node_manager);
       SOCKET_DELETE(self->socket_object);
       MUTEX_DESTROY(self->lock);
@@ -199,6 +282,50 @@ void apx_socketServerConnection_vclose(void *arg)
    connection_close((apx_socketServerConnection_t*) arg);
 }
 
+void apx_socketServerConnection_set_batching(apx_socketServerConnection_t* self, apx_socketBatchingCfg_t const* cfg)
+{
+   if ( (self != NULL) && (cfg != NULL) )
+   {
+      memcpy(&self->batching, cfg, sizeof(apx_socketBatchingCfg_t));
+      if ( (self->batching.max_pending_bytes == 0u) || (self->batching.max_pending_bytes > self->default_buffer_size) )
+      {
+         self->batching.max_pending_bytes = self->default_buffer_size;
+      }
+   }
+}
+
+void apx_socketBatchingCfg_set_defaults(apx_socketBatchingCfg_t* cfg)
+{
+   if (cfg != NULL)
+   {
+      cfg->max_pending_bytes = SEND_BUFFER_GROW_SIZE;
+      cfg->max_pending_us = 0u;
+      cfg->tcp_nodelay = false;
+      cfg->tcp_cork = false;
+   }
+}
+
+/**
+ * Allows the client to move the connection over to shared memory (see RMF_SHARED_MEMORY_HDR).
+ * Only meaningful for UNIX socket connections since the client must run on the same host.
+ */
+void apx_socketServerConnection_enable_shm_transport(apx_socketServerConnection_t* self, bool enable)
+{
+   if (self != NULL)
+   {
+      self->is_shm_enabled = enable;
+   }
+}
+
+bool apx_socketServerConnection_is_shm_transport_active(apx_socketServerConnection_t const* self)
+{
+   if (self != NULL)
+   {
+      return self->shm_transport != NULL;
+   }
+   return false;
+}
+
 // ConnectionInterface API
 int32_t apx_socketServerConnection_vtransmit_max_bytes_avaiable(void* arg)
 {
@@ -230,7 +357,68 @@ apx_error_t apx_socketServerConnection_vtransmit_direct_message(void* arg, uint8
    return connection_transmit_direct_message((apx_socketServerConnection_t*)arg, msg_data, msg_size, bytes_available);
 }
 
+int32_t apx_socketServerConnection_vtransmit_flush_deadline(void* arg)
+{
+   return connection_transmit_flush_deadline((apx_socketServerConnection_t*)arg);
+}
+
+// Statistics
+uint64_t apx_socketServerConnection_get_total_bytes_copied(apx_socketServerConnection_t* self)
+{
+   if (self != NULL)
+   {
+      return self->total_bytes_copied;
+   }
+   return 0u;
+}
+
+uint64_t apx_socketServerConnection_get_total_bytes_written(apx_socketServerConnection_t* self)
+{
+   if (self != NULL)
+   {
+      return self->total_bytes_written;
+   }
+   return 0u;
+}
+
+/**
+ * Returns number of bytes copied into the send buffer per byte written to the socket.
+ * A value of 1.0 means every byte was copied once, 0.0 means everything was sent directly from the caller's buffers.
+ */
+double apx_socketServerConnection_get_copy_ratio(apx_socketServerConnection_t* self)
+{
+   if ( (self != NULL) && (self->total_bytes_written > 0u) )
+   {
+      return ((double)self->total_bytes_copied) / ((double)self->total_bytes_written);
+   }
+   return 0.0;
+}
+
+/**
+ * Returns number of bytes the socket has not yet accepted. They are sent before any new data.
+ */
+apx_size_t apx_socketServerConnection_get_unsent_bytes(apx_socketServerConnection_t* self)
+{
+   if (self != NULL)
+   {
+      return (apx_size_t)adt_bytearray_length(&self->unsent_buffer);
+   }
+   return 0u;
+}
+
 #ifdef UNIT_TEST
+/**
+ * Makes the test socket accept at most write_limit more bytes, as if its send buffer then became full (EAGAIN).
+ * A negative value removes the limit.
+ */
+void apx_socketServerConnection_set_write_limit(apx_socketServerConnection_t* self, int32_t write_limit)
+{
+   if (self != NULL)
+   {
+      self->write_limit = write_limit;
+   }
+}
+
 void apx_socketServerConnection_run(apx_socketServerConnection_t* self)
 {
    if (self != NULL)
@@ -264,6 +452,7 @@ static void create_connection_interface_vtable(apx_socketServerConnection_t* sel
    interface->transmit_end = apx_socketServerConnection_vtransmit_end;
    interface->transmit_data_message = apx_socketServerConnection_vtransmit_data_message;
    interface->transmit_direct_message = apx_socketServerConnection_vtransmit_direct_message;
+   interface->transmit_flush_deadline = apx_socketServerConnection_vtransmit_flush_deadline;
 }
 
 //msocket API
@@ -276,6 +465,10 @@ static void socket_disconnected_notification(void* arg)
    if (self != NULL)
    {
       assert(self->base.parent != NULL);
+      if (self->shm_transport != NULL)
+      {
+         apx_shmTransport_stop(self->shm_transport);
+      }
       apx_server_detach_connection(self->base.parent, &self->base);
    }
 }
@@ -300,14 +493,79 @@ static void connection_start(apx_socketServerConnection_t* self)
 {
    assert(self->socket_object != NULL);
    apx_serverConnection_start(&self->base);
+   connection_apply_socket_options(self);
    SOCKET_START_IO(self->socket_object);
 }
 
+static void connection_greeting_header_notification(apx_socketServerConnection_t* self, char const* header_line)
+{
+#if APX_SHM_TRANSPORT_SUPPORTED
+   size_t const prefix_len = strlen(RMF_SHARED_MEMORY_HDR);
+   if ( self->is_shm_enabled && (self->shm_transport == NULL) && (strncmp(header_line, RMF_SHARED_MEMORY_HDR, prefix_len) == 0) )
+   {
+      connection_open_shm_transport(self, header_line + prefix_len);
+   }
+#else
+   (void)self;
+   (void)header_line;
+#endif
+}
+
+static void connection_vgreeting_header_notification(void* arg, char const* header_line)
+{
+   connection_greeting_header_notification((apx_socketServerConnection_t*)arg, header_line);
+}
+
+#if APX_SHM_TRANSPORT_SUPPORTED
+/**
+ * Attaches to the shared memory region created by the client. Once attached, the greeting acknowledge
+ * and everything after it is sent through shared memory. The client interprets data arriving on the socket
+ * instead as the server declining, so any failure here simply leaves the connection on the socket.
+ */
+static void connection_open_shm_transport(apx_socketServerConnection_t* self, char const* name)
+{
+   apx_shmTransport_t* transport = apx_shmTransport_new();
+   if (transport != NULL)
+   {
+      apx_error_t result = apx_shmTransport_open_region(transport, name);
+      if (result == APX_NO_ERROR)
+      {
+         apx_shmTransport_set_handler(transport, socket_data_notification, (void*)self);
+         result = apx_shmTransport_start(transport);
+      }
+      if (result != APX_NO_ERROR)
+      {
+         apx_shmTransport_delete(transport);
+         return;
+      }
+      MUTEX_LOCK(self->lock);
+      self->shm_transport = transport;
+      MUTEX_UNLOCK(self->lock);
+#if APX_DEBUG_ENABLE
+      printf("[SOCKET-SERVER-CONNECTION] Using shared memory transport \"%s\"\n", name);
+#endif
+   }
+}
+#endif
+
+static void connection_close_shm_transport(apx_socketServerConnection_t* self)
+{
+   if (self->shm_transport != NULL)
+   {
+      apx_shmTransport_delete(self->shm_transport);
+      self->shm_transport = NULL;
+   }
+}
+
 // ConnectionInterface API
 static int32_t connection_transmit_max_bytes_avaiable(apx_socketServerConnection_t* self)
 {
    if (self != NULL)
    {
+      if (self->shm_transport != NULL)
+      {
+         return apx_shmTransport_max_message_size(self->shm_transport);
+      }
       return (int32_t)self->default_buffer_size;
    }
    return -1;
@@ -327,11 +585,6 @@ static void connection_transmit_begin(apx_socketServerConnection_t* self)
    if (self != NULL)
    {
       MUTEX_LOCK(self->lock);
-      if (adt_bytearray_length(&self->send_buffer) < self->default_buffer_size)
-      {
-         adt_bytearray_resize(&self->send_buffer, self->default_buffer_size);
-      }
-      self->pending_bytes = 0u;
       assert((adt_bytearray_length(&self->send_buffer) >= self->default_buffer_size));
    }
 }
@@ -340,9 +593,13 @@ static void connection_transmit_end(apx_socketServerConnection_t* self)
 {
    if (self != NULL)
    {
-      if (self->pending_bytes > 0u)
+      if (self->shm_transport != NULL)
       {
-         connection_send_packet(self);
+         apx_shmTransport_flush(self->shm_transport);
+      }
+      else
+      {
+         connection_flush_before_end(self);
       }
       MUTEX_UNLOCK(self->lock);
    }
@@ -354,6 +611,11 @@ static apx_error_t connection_transmit_data_message(apx_socketServerConnection_t
    {
       uint8_t header[NUMHEADER32_LONG_SIZE + RMF_HIGH_ADDR_SIZE];
       apx_size_t const address_size = rmf_needed_encoding_size(write_address);
+      if (self->shm_transport != NULL)
+      {
+         *bytes_available = apx_shmTransport_max_message_size(self->shm_transport);
+         return apx_shmTransport_write_data_message(self->shm_transport, write_address, more_bit, msg_data, msg_size);
+      }
       apx_size_t const payload_size = address_size + msg_size;
       if (payload_size > self->default_buffer_size)
       {
@@ -363,17 +625,28 @@ static apx_error_t connection_transmit_data_message(apx_socketServerConnection_t
       assert(header1_size > 0);
       apx_size_t const header2_size = rmf_address_encode(header + header1_size, sizeof(header) - header1_size, write_address, more_bit);
       assert(header2_size == address_size);
-      apx_size_t const bytes_to_send = header1_size + header2_size + payload_size;
+      apx_size_t const header_size = header1_size + header2_size;
+      if (msg_size >= SEND_ZERO_COPY_MIN_SIZE)
+      {
+         apx_error_t const retval = connection_send_with_external_payload(self, header, header_size, msg_data, (apx_size_t)msg_size);
+         *bytes_available = (int32_t)(((apx_size_t)adt_bytearray_length(&self->send_buffer)) - self->pending_bytes);
+         return retval;
+      }
+      apx_size_t const bytes_to_send = header_size + msg_size;
       apx_size_t const buffer_available = ((apx_size_t)adt_bytearray_length(&self->send_buffer)) - self->pending_bytes;
       if (bytes_to_send > buffer_available)
       {
+         connection_set_cork(self, true);
          connection_send_packet(self);
          assert(self->pending_bytes == 0u);
       }
-      memcpy(adt_bytearray_data(&self->send_buffer) + self->pending_bytes, header, header1_size + header2_size);
-      self->pending_bytes += (header1_size + header2_size);
-      memcpy(adt_bytearray_data(&self->send_buffer) + self->pending_bytes, msg_data, msg_size);
-      self->pending_bytes += msg_size;
+      connection_append_to_send_buffer(self, header, header_size);
+      connection_append_to_send_buffer(self, msg_data, (apx_size_t)msg_size);
+      if ( (self->pending_bytes >= self->batching.max_pending_bytes) || connection_is_flush_deadline_expired(self) )
+      {
+         connection_set_cork(self, true);
+         connection_send_packet(self);
+      }
       *bytes_available = (int32_t)(((apx_size_t)adt_bytearray_length(&self->send_buffer)) - self->pending_bytes);
       return APX_NO_ERROR;
    }
@@ -385,22 +658,37 @@ static apx_error_t connection_transmit_direct_message(apx_socketServerConnection
    if (self != NULL)
    {
       uint8_t  header[NUMHEADER32_LONG_SIZE];
+      if (self->shm_transport != NULL)
+      {
+         *bytes_available = apx_shmTransport_max_message_size(self->shm_transport);
+         return apx_shmTransport_write_direct_message(self->shm_transport, msg_data, msg_size);
+      }
       if (msg_size > ((int32_t)self->default_buffer_size))
       {
          return APX_MSG_TOO_LARGE_ERROR;
       }
       apx_size_t const header_size = numheader_encode32(header, sizeof(header), msg_size);
+      if (msg_size >= SEND_ZERO_COPY_MIN_SIZE)
+      {
+         apx_error_t const retval = connection_send_with_external_payload(self, header, header_size, msg_data, (apx_size_t)msg_size);
+         *bytes_available = (int32_t)(((apx_size_t)adt_bytearray_length(&self->send_buffer)) - self->pending_bytes);
+         return retval;
+      }
       apx_size_t const bytes_to_send = header_size + msg_size;
       apx_size_t const buffer_available = ((apx_size_t)adt_bytearray_length(&self->send_buffer)) - self->pending_bytes;
       if (bytes_to_send > buffer_available)
       {
+         connection_set_cork(self, true);
          connection_send_packet(self);
          assert(self->pending_bytes == 0u);
       }
-      memcpy(adt_bytearray_data(&self->send_buffer), header, header_size);
-      self->pending_bytes += header_size;
-      memcpy(adt_bytearray_data(&self->send_buffer) + self->pending_bytes, msg_data, msg_size);
-      self->pending_bytes += msg_size;
+      connection_append_to_send_buffer(self, header, header_size);
+      connection_append_to_send_buffer(self, msg_data, (apx_size_t)msg_size);
+      if ( (self->pending_bytes >= self->batching.max_pending_bytes) || connection_is_flush_deadline_expired(self) )
+      {
+         connection_set_cork(self, true);
+         connection_send_packet(self);
+      }
       *bytes_available = (int32_t)(((apx_size_t)adt_bytearray_length(&self->send_buffer)) - self->pending_bytes);
       return APX_NO_ERROR;
    }
@@ -411,12 +699,380 @@ static void connection_send_packet(apx_socketServerConnection_t* self)
 {
    if ((self->socket_object != NULL) && (self->pending_bytes > 0u))
    {
-      uint8_t const* data = adt_bytearray_const_data(&self->send_buffer);
+      send_segment_t segment;
+      segment.data = adt_bytearray_const_data(&self->send_buffer);
+      segment.size = self->pending_bytes;
 #if APX_DEBUG_ENABLE
       printf("[SOCKET-SERVER-CONNECTION] Sending %d bytes\n", (int)self->pending_bytes);
 #endif
-      SOCKET_SEND(self->socket_object, data, (uint32_t)self->pending_bytes);
-      adt_bytearray_clear(&self->send_buffer);
+      (void)connection_send_segments(self, &segment, 1);
       self->pending_bytes = 0u;
    }
-}
\ No newline at end of file
+}
+
+/**
+ * Sends what is currently pending in send_buffer followed by header and payload using a single gather write.
+ * The payload is never copied. Since the payload buffer is owned by the caller the data must be sent before returning.
+ */
+static apx_error_t connection_send_with_external_payload(apx_socketServerConnection_t* self, uint8_t const* header, apx_size_t header_size, uint8_t const* payload, apx_size_t payload_size)
+{
+   send_segment_t segments[MAX_SEND_SEGMENTS];
+   int num_segments = 0;
+   if (self->socket_object == NULL)
+   {
+      return APX_NULL_PTR_ERROR;
+   }
+   if (self->pending_bytes > 0u)
+   {
+      segments[num_segments].data = adt_bytearray_const_data(&self->send_buffer);
+      segments[num_segments++].size = self->pending_bytes;
+   }
+   connection_set_cork(self, true);
+   segments[num_segments].data = header;
+   segments[num_segments++].size = header_size;
+   segments[num_segments].data = payload;
+   segments[num_segments++].size = payload_size;
+#if APX_DEBUG_ENABLE
+   printf("[SOCKET-SERVER-CONNECTION] Sending %d bytes (%d bytes from external payload)\n", (int)(self->pending_bytes + header_size + payload_size), (int)payload_size);
+#endif
+   self->pending_bytes = 0u;
+   if (connection_send_segments(self, &segments[0], num_segments) < 0)
+   {
+      return APX_TRANSMIT_ERROR;
+   }
+   return APX_NO_ERROR;
+}
+
+static void connection_append_to_send_buffer(apx_socketServerConnection_t* self, uint8_t const* data, apx_size_t size)
+{
+   assert(self->pending_bytes + size <= (apx_size_t)adt_bytearray_length(&self->send_buffer));
+   if ( (self->pending_bytes == 0u) && (self->batching.max_pending_us > 0u) )
+   {
+      self->pending_since_us = apx_time_monotonic_us();
+   }
+   memcpy(adt_bytearray_data(&self->send_buffer) + self->pending_bytes, data, size);
+   self->pending_bytes += size;
+   self->total_bytes_copied += size;
+}
+
+/**
+ * Writes all segments to the socket, preceded by whatever the socket did not accept earlier.
+ * What the socket does not accept now (short write or EAGAIN) is copied to unsent_buffer and retried by the
+ * worker, which keeps calling transmit_begin/transmit_end as long as transmit_flush_deadline says so.
+ * Returns 0 on success (including data kept for later), -1 when the connection can no longer be written to.
+ */
+static int connection_send_segments(apx_socketServerConnection_t* self, send_segment_t const* segments, int num_segments)
+{
+   send_segment_t remaining[MAX_SEND_SEGMENTS];
+   int first = 0;
+   int num_remaining = 0;
+   int i;
+   assert(num_segments <= MAX_SEND_SEGMENTS);
+   if (self->is_send_failed || (connection_send_unsent(self) < 0))
+   {
+      return -1;
+   }
+   for (i = 0; i < num_segments; i++)
+   {
+      if (segments[i].size > 0u)
+      {
+         remaining[num_remaining++] = segments[i];
+      }
+   }
+   //New data must not overtake data already waiting in unsent_buffer
+   if (adt_bytearray_length(&self->unsent_buffer) == 0u)
+   {
+      while (first < num_remaining)
+      {
+         int32_t result = socket_write_segments(self, &remaining[first], num_remaining - first);
+         if (result < 0)
+         {
+            connection_on_send_error(self);
+            return -1;
+         }
+         else if (result == 0)
+         {
+            break;
+         }
+         connection_count_bytes_written(self, (apx_size_t)result);
+         while ( (first < num_remaining) && (((apx_size_t)result) >= remaining[first].size) )
+         {
+            result -= (int32_t)remaining[first].size;
+            first++;
+         }
+         if (first < num_remaining)
+         {
+            remaining[first].data += result;
+            remaining[first].size -= (apx_size_t)result;
+         }
+      }
+   }
+   for (i = first; i < num_remaining; i++)
+   {
+      if (connection_keep_unsent(self, remaining[i].data, remaining[i].size) < 0)
+      {
+         return -1;
+      }
+   }
+   return 0;
+}
+
+/**
+ * Writes as much of unsent_buffer as the socket accepts. Returns 0 on success (even when data remains), -1 on error.
+ */
+static int connection_send_unsent(apx_socketServerConnection_t* self)
+{
+   while (adt_bytearray_length(&self->unsent_buffer) > 0u)
+   {
+      send_segment_t segment;
+      int32_t result;
+      segment.data = adt_bytearray_const_data(&self->unsent_buffer);
+      segment.size = (apx_size_t)adt_bytearray_length(&self->unsent_buffer);
+      result = socket_write_segments(self, &segment, 1);
+      if (result < 0)
+      {
+         connection_on_send_error(self);
+         return -1;
+      }
+      else if (result == 0)
+      {
+         break;
+      }
+      connection_count_bytes_written(self, (apx_size_t)result);
+      if (((apx_size_t)result) == segment.size)
+      {
+         adt_bytearray_clear(&self->unsent_buffer);
+      }
+      else
+      {
+         adt_bytearray_trimLeft(&self->unsent_buffer, segment.data + result);
+      }
+   }
+   return 0;
+}
+
+static int connection_keep_unsent(apx_socketServerConnection_t* self, uint8_t const* data, apx_size_t size)
+{
+   if ( (adt_bytearray_length(&self->unsent_buffer) + size > SEND_BACKLOG_MAX_SIZE) ||
+        (adt_bytearray_append(&self->unsent_buffer, data, (uint32_t)size) != ADT_NO_ERROR) )
+   {
+#if APX_DEBUG_ENABLE
+      printf("[SOCKET-SERVER-CONNECTION] Peer is not reading, closing connection\n");
+#endif
+      connection_on_send_error(self);
+      return -1;
+   }
+   self->total_bytes_copied += size;
+   return 0;
+}
+
+static void connection_count_bytes_written(apx_socketServerConnection_t* self, apx_size_t size)
+{
+   self->total_bytes_written += size;
+   self->base.base.total_bytes_sent += (uint32_t)size;
+}
+
+/**
+ * Part of a message may already have been written, so nothing sent after this point could be parsed by the peer.
+ */
+static void connection_on_send_error(apx_socketServerConnection_t* self)
+{
+   self->is_send_failed = true;
+   adt_bytearray_clear(&self->unsent_buffer);
+   SOCKET_OBJECT_CLOSE(self->socket_object);
+}
+
+/**
+ * Gives segments to the socket in a single call without ever raising SIGPIPE.
+ * Returns number of bytes accepted, 0 when the socket cannot accept anything right now or -1 on error.
+ */
+static int32_t socket_write_segments(apx_socketServerConnection_t* self, send_segment_t const* segments, int num_segments)
+{
+#if SOCKET_HAS_SENDMSG
+   struct iovec iov[MAX_SEND_SEGMENTS];
+   struct msghdr msg;
+   int i;
+   assert(num_segments <= MAX_SEND_SEGMENTS);
+   for (i = 0; i < num_segments; i++)
+   {
+      iov[i].iov_base = (void*)segments[i].data;
+      iov[i].iov_len = (size_t)segments[i].size;
+   }
+   memset(&msg, 0, sizeof(msg));
+   msg.msg_iov = &iov[0];
+   msg.msg_iovlen = (size_t)num_segments;
+   for (;;)
+   {
+      ssize_t result = sendmsg(self->socket_object->tcpsockfd, &msg, SOCKET_SEND_FLAGS);
+      if (result >= 0)
+      {
+         return (int32_t)result;
+      }
+      else if (errno == EINTR)
+      {
+         continue;
+      }
+      else if ( (errno == EAGAIN) || (errno == EWOULDBLOCK) )
+      {
+         return 0;
+      }
+      return -1;
+   }
+#else
+   int32_t total_size = 0;
+   int i;
+   for (i = 0; i < num_segments; i++)
+   {
+      apx_size_t size = segments[i].size;
+# ifdef UNIT_TEST
+      if ( (self->write_limit >= 0) && (((apx_size_t)(total_size)) + size > (apx_size_t)self->write_limit) )
+      {
+         size = (apx_size_t)(self->write_limit - total_size);
+      }
+# endif
+      if ( (size > 0u) && (SOCKET_SEND(self->socket_object, segments[i].data, (uint32_t)size) < 0) )
+      {
+         return -1;
+      }
+      total_size += (int32_t)size;
+      if (size < segments[i].size)
+      {
+         break;
+      }
+   }
+# ifdef UNIT_TEST
+   if (self->write_limit >= 0)
+   {
+      self->write_limit -= total_size;
+   }
+# endif
+   return total_size;
+#endif
+}
+
+/**
+ * Returns number of microseconds until buffered data must be flushed or -1 if nothing is held back.
+ * Only called from the file manager worker thread, which is also the only thread modifying pending_bytes.
+ */
+static int32_t connection_transmit_flush_deadline(apx_socketServerConnection_t* self)
+{
+   if ( (self != NULL) && (!self->is_send_failed) && (adt_bytearray_length(&self->unsent_buffer) > 0u) )
+   {
+      return SEND_RETRY_INTERVAL_US;
+   }
+   if ( (self != NULL) && (self->pending_bytes > 0u) && (self->batching.max_pending_us > 0u) )
+   {
+      uint64_t const elapsed = apx_time_monotonic_us() - self->pending_since_us;
+      if (elapsed >= self->batching.max_pending_us)
+      {
+         return 0;
+      }
+      return (int32_t)(self->batching.max_pending_us - elapsed);
+   }
+   return -1;
+}
+
+/**
+ * Called at the end of each worker cycle. Pending data is held back (up to max_pending_us) to be merged with
+ * data from the next cycle. The worker calls transmit_begin/transmit_end again when the deadline expires.
+ */
+static void connection_flush_before_end(apx_socketServerConnection_t* self)
+{
+   if ( (self->pending_bytes > 0u) &&
+        ( (self->batching.max_pending_us == 0u) || connection_is_flush_deadline_expired(self) ) )
+   {
+      connection_send_packet(self);
+   }
+   else if ( (!self->is_send_failed) && (adt_bytearray_length(&self->unsent_buffer) > 0u) )
+   {
+      (void)connection_send_unsent(self);
+   }
+   if ( (self->pending_bytes == 0u) && (adt_bytearray_length(&self->unsent_buffer) == 0u) )
+   {
+      connection_set_cork(self, false);
+   }
+}
+
+static bool connection_is_flush_deadline_expired(apx_socketServerConnection_t* self)
+{
+   if ( (self->pending_bytes > 0u) && (self->batching.max_pending_us > 0u) )
+   {
+      return (apx_time_monotonic_us() - self->pending_since_us) >= self->batching.max_pending_us;
+   }
+   return false;
+}
+
+/**
+ * With tcp_cork enabled the socket is corked before data is written in the middle of a batch
+ * and uncorked after the final flush so the kernel can send full segments.
+ * Cork is turned off for the rest of the connection if the socket refuses the option.
+ */
+static void connection_set_cork(apx_socketServerConnection_t* self, bool enable)
+{
+   if ( (!self->batching.tcp_cork) || (self->is_corked == enable) )
+   {
+      return;
+   }
+#if !defined(UNIT_TEST) && !defined(_WIN32) && defined(TCP_CORK)
+   if ( (!self->is_tcp) || (!socket_set_option(self, IPPROTO_TCP, TCP_CORK, enable ? 1 : 0)) )
+   {
+      self->batching.tcp_cork = false;
+      self->is_corked = false;
+      return;
+   }
+#endif
+   self->is_corked = enable;
+}
+
+static void connection_apply_socket_options(apx_socketServerConnection_t* self)
+{
+#if !defined(UNIT_TEST)
+   self->is_tcp = socket_is_tcp(self);
+   (void)socket_set_option(self, SOL_SOCKET, SO_RCVBUF, SOCKET_RECEIVE_BUFFER_SIZE);
+# if !defined(MSG_NOSIGNAL) && defined(SO_NOSIGPIPE)
+   (void)socket_set_option(self, SOL_SOCKET, SO_NOSIGPIPE, 1);
+# endif
+   if (self->batching.tcp_nodelay && self->is_tcp)
+   {
+      (void)socket_set_option(self, IPPROTO_TCP, TCP_NODELAY, 1);
+   }
+#else
+   (void)self;
+#endif
+}
+
+#if !defined(UNIT_TEST)
+/**
+ * The server accepts both TCP and UNIX domain connections. TCP level options are only applied to the former.
+ */
+static bool socket_is_tcp(apx_socketServerConnection_t* self)
+{
+   struct sockaddr_storage address;
+# ifdef _WIN32
+   int address_len = (int)sizeof(address);
+# else
+   socklen_t address_len = (socklen_t)sizeof(address);
+# endif
+   memset(&address, 0, sizeof(address));
+   if (getsockname(self->socket_object->tcpsockfd, (struct sockaddr*)&address, &address_len) != 0)
+   {
+      return false;
+   }
+   return (address.ss_family == AF_INET) || (address.ss_family == AF_INET6);
+}
+
+/**
+ * Sets an integer socket option. Returns false if the socket refused it.
+ */
+static bool socket_set_option(apx_socketServerConnection_t* self, int level, int name, int value)
+{
+   if (setsockopt(self->socket_object->tcpsockfd, level, name, (char const*)&value, (int)sizeof(value)) != 0)
+   {
+#if APX_DEBUG_ENABLE
+      printf("[SOCKET-SERVER-CONNECTION] Failed to set socket option %d (errno %d)\n", name, errno);
+#endif
+      return false;
+   }
+   return true;
+}
+#endif
@@ -45,6 +45,7 @@
 static apx_error_t apx_socketServerExtension_init(struct apx_server_tag *apx_server, dtl_dv_t *config);
 static void apx_socketServerExtension_shutdown(void);
 static apx_error_t apx_socketServerExtension_configure(apx_socketServer_t *server, dtl_hv_t *cfg);
+static apx_error_t apx_socketServerExtension_configure_batching(dtl_dv_t *dv, apx_socketBatchingCfg_t *batching);
 
 
 //////////////////////////////////////////////////////////////////////////////
@@ -118,6 +119,10 @@ static apx_error_t apx_socketServerExtension_configure(apx_socketServer_t *serve
 #endif
    dtl_sv_t *sv_tcp_tag;
    dtl_sv_t *sv_unix_tag;
+   dtl_dv_t *dv_tcp_batching;
+   dtl_dv_t *dv_unix_batching;
+   dtl_sv_t *sv_unix_shm_transport;
+   dtl_sv_t *sv_tcp_acceptors;
    bool conversion_ok;
 
    (void)server;
@@ -127,6 +132,48 @@ static apx_error_t apx_socketServerExtension_configure(apx_socketServer_t *serve
 #endif
    sv_tcp_tag = (dtl_sv_t*) dtl_hv_get_cstr(cfg, "tcp-tag");
    sv_unix_tag = (dtl_sv_t*) dtl_hv_get_cstr(cfg, "unix-tag");
+   dv_tcp_batching = dtl_hv_get_cstr(cfg, "tcp-batching");
+   dv_unix_batching = dtl_hv_get_cstr(cfg, "unix-batching");
+   sv_unix_shm_transport = (dtl_sv_t*) dtl_hv_get_cstr(cfg, "unix-shm-transport");
+   sv_tcp_acceptors = (dtl_sv_t*) dtl_hv_get_cstr(cfg, "tcp-acceptors");
+   if (dv_tcp_batching != 0)
+   {
+      apx_socketBatchingCfg_t batching;
+      apx_error_t result = apx_socketServerExtension_configure_batching(dv_tcp_batching, &batching);
+      if (result != APX_NO_ERROR)
+      {
+         return result;
+      }
+      apx_socketServer_set_tcp_batching(m_instance, &batching);
+   }
+   if (dv_unix_batching != 0)
+   {
+      apx_socketBatchingCfg_t batching;
+      apx_error_t result = apx_socketServerExtension_configure_batching(dv_unix_batching, &batching);
+      if (result != APX_NO_ERROR)
+      {
+         return result;
+      }
+      apx_socketServer_set_unix_batching(m_instance, &batching);
+   }
+   if (sv_unix_shm_transport != 0)
+   {
+      bool enable = dtl_sv_to_bool(sv_unix_shm_transport, &conversion_ok);
+      if (!conversion_ok)
+      {
+         return APX_VALUE_TYPE_ERROR;
+      }
+      apx_socketServer_set_unix_shm_transport(m_instance, enable);
+   }
+   if (sv_tcp_acceptors != 0)
+   {
+      uint32_t num_acceptors = dtl_sv_to_u32(sv_tcp_acceptors, &conversion_ok);
+      if (!conversion_ok)
+      {
+         return APX_VALUE_TYPE_ERROR;
+      }
+      apx_socketServer_set_tcp_acceptors(m_instance, num_acceptors);
+   }
    if (sv_tcp_port != 0)
    {
       uint16_t tcp_port = (uint16_t) dtl_sv_to_u32(sv_tcp_port, &conversion_ok);
@@ -163,3 +210,56 @@ static apx_error_t apx_socketServerExtension_configure(apx_socketServer_t *serve
    return APX_NO_ERROR;
 }
 
+/**
+ * Reads transmit batching policy. Example:
+ * "tcp-batching": {"max-pending-bytes": 1400, "max-pending-us": 500, "tcp-nodelay": true, "tcp-cork": false}
+ */
+static apx_error_t apx_socketServerExtension_configure_batching(dtl_dv_t *dv, apx_socketBatchingCfg_t *batching)
+{
+   dtl_hv_t *hv;
+   dtl_sv_t *sv;
+   bool conversion_ok;
+   if (dtl_dv_type(dv) != DTL_DV_HASH)
+   {
+      return APX_VALUE_TYPE_ERROR;
+   }
+   hv = (dtl_hv_t*) dv;
+   apx_socketBatchingCfg_set_defaults(batching);
+   sv = (dtl_sv_t*) dtl_hv_get_cstr(hv, "max-pending-bytes");
+   if (sv != 0)
+   {
+      batching->max_pending_bytes = (apx_size_t) dtl_sv_to_u32(sv, &conversion_ok);
+      if (!conversion_ok)
+      {
+         return APX_VALUE_TYPE_ERROR;
+      }
+   }
+   sv = (dtl_sv_t*) dtl_hv_get_cstr(hv, "max-pending-us");
+   if (sv != 0)
+   {
+      batching->max_pending_us = dtl_sv_to_u32(sv, &conversion_ok);
+      if (!conversion_ok)
+      {
+         return APX_VALUE_TYPE_ERROR;
+      }
+   }
+   sv = (dtl_sv_t*) dtl_hv_get_cstr(hv, "tcp-nodelay");
+   if (sv != 0)
+   {
+      batching->tcp_nodelay = dtl_sv_to_bool(sv, &conversion_ok);
+      if (!conversion_ok)
+      {
+         return APX_VALUE_TYPE_ERROR;
+      }
+   }
+   sv = (dtl_sv_t*) dtl_hv_get_cstr(hv, "tcp-cork");
+   if (sv != 0)
+   {
+      batching->tcp_cork = dtl_sv_to_bool(sv, &conversion_ok);
+      if (!conversion_ok)
+      {
+         return APX_VALUE_TYPE_ERROR;
+      }
+   }
+   return APX_NO_ERROR;
+}
@@ -0,0 +1,569 @@
+/*****************************************************************************
+* \file      uring.c
+* \author    Conny Gustafsson
+* \date      2026-10-18
+* \brief     Minimal io_uring wrapper used by the io_uring socket server extension
+*
+* Copyright (c) 2026 Conny Gustafsson
+* Permission is hereby granted, free of charge, to any person obtaining a copy of
+* this software and associated documentation files (the "Software"), to deal in
+* the Software without restriction, including without limitation the rights to
+* use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+* the Software, and to permit persons to whom the Software is furnished to do so,
+* subject to the following conditions:
+
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+* FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+* COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+* IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+* CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+******************************************************************************/
+//////////////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////////////
+#include <string.h>
+#include <stdlib.h>
+#include <assert.h>
+#include "apx/extension/uring.h"
+#if APX_URING_SUPPORTED
+#include <errno.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+#endif
+#ifdef MEM_LEAK_CHECK
+#include "CMemLeak.h"
+#endif
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE CONSTANTS AND DATA TYPES
+//////////////////////////////////////////////////////////////////////////////
+#define PROBE_RING_ENTRIES 8u
+#define PROBE_BUFFER_COUNT 2u
+#define PROBE_BUFFER_SIZE 64u
+#define PROBE_USER_DATA_RECV 1u
+#define PROBE_USER_DATA_SEND 2u
+#define PROBE_USER_DATA_NOP 3u
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////////////
+#if APX_URING_SUPPORTED
+static struct io_uring_sqe* get_sqe(apx_uring_t* self);
+static void publish_sqes(apx_uring_t* self);
+static int enter(apx_uring_t* self, uint32_t wait_nr, uint32_t flags);
+static void add_buffer(apx_uring_t* self, uint16_t buffer_id);
+static bool check_probe_completions(apx_uringCompletion_t const* completions, uint32_t num_completions);
+#endif
+
+//////////////////////////////////////////////////////////////////////////////
+// PUBLIC FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+#if APX_URING_SUPPORTED
+
+/**
+ * Sets up a ring with room for entries submissions and four times as many completions.
+ * Receive completions from many connections can then be collected before the CQ overflows.
+ */
+apx_error_t apx_uring_create(apx_uring_t* self, uint32_t entries)
+{
+   if ( (self != NULL) && (entries > 0u) )
+   {
+      struct io_uring_params params;
+      uint8_t* ring_memory;
+      size_t sq_ring_size;
+      size_t cq_ring_size;
+      uint32_t i;
+      uint32_t* sq_array;
+      memset(self, 0, sizeof(apx_uring_t));
+      memset(&params, 0, sizeof(params));
+      params.flags = IORING_SETUP_CQSIZE;
+      params.cq_entries = entries * 4u;
+      self->ring_fd = (int) syscall(__NR_io_uring_setup, entries, &params);
+      if (self->ring_fd < 0)
+      {
+         self->ring_fd = -1;
+         return APX_NOT_IMPLEMENTED_ERROR;
+      }
+      if ( (params.features & IORING_FEAT_SINGLE_MMAP) == 0u)
+      {
+         close(self->ring_fd);
+         self->ring_fd = -1;
+         return APX_NOT_IMPLEMENTED_ERROR;
+      }
+      sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+      cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+      self->ring_memory_size = (sq_ring_size > cq_ring_size) ? sq_ring_size : cq_ring_size;
+      self->ring_memory = mmap(NULL, self->ring_memory_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, self->ring_fd, IORING_OFF_SQ_RING);
+      if (self->ring_memory == MAP_FAILED)
+      {
+         self->ring_memory = NULL;
+         apx_uring_destroy(self);
+         return APX_MEM_ERROR;
+      }
+      self->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+      self->sqes = (struct io_uring_sqe*) mmap(NULL, self->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, self->ring_fd, IORING_OFF_SQES);
+      if (self->sqes == MAP_FAILED)
+      {
+         self->sqes = NULL;
+         apx_uring_destroy(self);
+         return APX_MEM_ERROR;
+      }
+      ring_memory = (uint8_t*) self->ring_memory;
+      self->sq_head = (uint32_t*) (ring_memory + params.sq_off.head);
+      self->sq_tail = (uint32_t*) (ring_memory + params.sq_off.tail);
+      self->sq_mask = *(uint32_t*) (ring_memory + params.sq_off.ring_mask);
+      self->sq_entries = params.sq_entries;
+      self->sq_local_tail = *self->sq_tail;
+      sq_array = (uint32_t*) (ring_memory + params.sq_off.array);
+      for (i = 0u; i < self->sq_entries; i++)
+      {
+         sq_array[i] = i; //SQE slots are always used in ring order
+      }
+      self->cq_head = (uint32_t*) (ring_memory + params.cq_off.head);
+      self->cq_tail = (uint32_t*) (ring_memory + params.cq_off.tail);
+      self->cq_mask = *(uint32_t*) (ring_memory + params.cq_off.ring_mask);
+      self->cqes = (struct io_uring_cqe*) (ring_memory + params.cq_off.cqes);
+      return APX_NO_ERROR;
+   }
+   return APX_INVALID_ARGUMENT_ERROR;
+}
+
+void apx_uring_destroy(apx_uring_t* self)
+{
+   if (self != NULL)
+   {
+      if (self->ring_fd >= 0)
+      {
+         close(self->ring_fd); //also unregisters the buffer ring
+         self->ring_fd = -1;
+      }
+      if (self->sqes != NULL)
+      {
+         munmap(self->sqes, self->sqes_size);
+         self->sqes = NULL;
+      }
+      if (self->ring_memory != NULL)
+      {
+         munmap(self->ring_memory, self->ring_memory_size);
+         self->ring_memory = NULL;
+      }
+      if (self->buf_ring != NULL)
+      {
+         munmap(self->buf_ring, self->buf_ring_size);
+         self->buf_ring = NULL;
+      }
+      if (self->buf_memory != NULL)
+      {
+         free(self->buf_memory);
+         self->buf_memory = NULL;
+      }
+   }
+}
+
+/**
+ * Checks that the running kernel supports every feature used by the io_uring server:
+ * multishot receive into a provided buffer ring (Linux 6.0) and linked sends.
+ * Multishot accept is older (Linux 5.19) and therefore covered by the same check.
+ * Returns APX_NO_ERROR when supported, APX_NOT_IMPLEMENTED_ERROR otherwise.
+ */
+apx_error_t apx_uring_probe(void)
+{
+   apx_uring_t ring;
+   apx_error_t result;
+   int sv[2];
+   result = apx_uring_create(&ring, PROBE_RING_ENTRIES);
+   if (result != APX_NO_ERROR)
+   {
+      return APX_NOT_IMPLEMENTED_ERROR;
+   }
+   result = apx_uring_register_buffers(&ring, 0u, PROBE_BUFFER_COUNT, PROBE_BUFFER_SIZE);
+   if (result == APX_NO_ERROR)
+   {
+      if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv) != 0)
+      {
+         result = APX_NOT_IMPLEMENTED_ERROR;
+      }
+      else
+      {
+         static uint8_t const probe_data[1] = { 0x55 };
+         apx_uringCompletion_t completions[PROBE_RING_ENTRIES];
+         uint32_t num_completions = 0u;
+         (void)apx_uring_prep_multishot_recv(&ring, sv[0], PROBE_USER_DATA_RECV);
+         (void)apx_uring_prep_send(&ring, sv[1], &probe_data[0], (uint32_t) sizeof(probe_data), PROBE_USER_DATA_SEND, true);
+         (void)apx_uring_prep_nop(&ring, PROBE_USER_DATA_NOP);
+         if (apx_uring_submit(&ring) == 3)
+         {
+            int attempts;
+            for (attempts = 0; (attempts < 3) && (num_completions < 3u); attempts++)
+            {
+               if (apx_uring_submit_and_wait(&ring, 1u) < 0)
+               {
+                  break;
+               }
+               num_completions += apx_uring_peek_completions(&ring, &completions[num_completions], PROBE_RING_ENTRIES - num_completions);
+            }
+         }
+         if (!check_probe_completions(&completions[0], num_completions))
+         {
+            result = APX_NOT_IMPLEMENTED_ERROR;
+         }
+         close(sv[0]);
+         close(sv[1]);
+      }
+   }
+   else
+   {
+      result = APX_NOT_IMPLEMENTED_ERROR;
+   }
+   apx_uring_destroy(&ring);
+   return result;
+}
+
+/**
+ * Registers count buffers of size bytes each as provided buffer group group_id.
+ * Receives armed with apx_uring_prep_multishot_recv pick buffers from this group.
+ * count must be a power of two.
+ */
+apx_error_t apx_uring_register_buffers(apx_uring_t* self, uint16_t group_id, uint32_t count, uint32_t size)
+{
+   if ( (self != NULL) && (self->buf_ring == NULL) && (count > 0u) && (count <= APX_URING_MAX_BUFFER_COUNT) &&
+        ((count & (count - 1u)) == 0u) && (size > 0u) )
+   {
+      struct io_uring_buf_reg reg;
+      uint32_t i;
+      self->buf_ring_size = count * sizeof(struct io_uring_buf);
+      self->buf_ring = (struct io_uring_buf_ring*) mmap(NULL, self->buf_ring_size, PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_PRIVATE, -1, 0);
+      if (self->buf_ring == MAP_FAILED)
+      {
+         self->buf_ring = NULL;
+         return APX_MEM_ERROR;
+      }
+      self->buf_memory = (uint8_t*) malloc(((size_t)count) * size);
+      if (self->buf_memory == NULL)
+      {
+         munmap(self->buf_ring, self->buf_ring_size);
+         self->buf_ring = NULL;
+         return APX_MEM_ERROR;
+      }
+      memset(&reg, 0, sizeof(reg));
+      reg.ring_addr = (uint64_t)(uintptr_t) self->buf_ring;
+      reg.ring_entries = count;
+      reg.bgid = group_id;
+      if (syscall(__NR_io_uring_register, self->ring_fd, IORING_REGISTER_PBUF_RING, &reg, 1) != 0)
+      {
+         munmap(self->buf_ring, self->buf_ring_size);
+         self->buf_ring = NULL;
+         free(self->buf_memory);
+         self->buf_memory = NULL;
+         return APX_NOT_IMPLEMENTED_ERROR;
+      }
+      self->buf_count = count;
+      self->buf_size = size;
+      self->buf_group = group_id;
+      self->buf_tail = 0u;
+      for (i = 0u; i < count; i++)
+      {
+         add_buffer(self, (uint16_t) i);
+      }
+      __atomic_store_n(&self->buf_ring->tail, self->buf_tail, __ATOMIC_RELEASE);
+      return APX_NO_ERROR;
+   }
+   return APX_INVALID_ARGUMENT_ERROR;
+}
+
+uint8_t* apx_uring_get_buffer(apx_uring_t const* self, uint16_t buffer_id)
+{
+   if ( (self != NULL) && (buffer_id < self->buf_count) )
+   {
+      return self->buf_memory + ((size_t)buffer_id) * self->buf_size;
+   }
+   return NULL;
+}
+
+/**
+ * Gives a buffer received in a completion back to the kernel.
+ */
+void apx_uring_recycle_buffer(apx_uring_t* self, uint16_t buffer_id)
+{
+   if ( (self != NULL) && (buffer_id < self->buf_count) )
+   {
+      add_buffer(self, buffer_id);
+      __atomic_store_n(&self->buf_ring->tail, self->buf_tail, __ATOMIC_RELEASE);
+   }
+}
+
+/**
+ * Arms one accept request that completes once for every new connection on the listening socket fd.
+ */
+bool apx_uring_prep_multishot_accept(apx_uring_t* self, int fd, uint64_t user_data)
+{
+   struct io_uring_sqe* sqe = get_sqe(self);
+   if (sqe != NULL)
+   {
+      sqe->opcode = IORING_OP_ACCEPT;
+      sqe->fd = fd;
+      sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+      sqe->accept_flags = SOCK_CLOEXEC;
+      sqe->user_data = user_data;
+      return true;
+   }
+   return false;
+}
+
+/**
+ * Arms one receive request that completes every time data arrives on fd. Data is placed in buffers from
+ * the registered buffer group, the buffer ID is found in the completion flags.
+ */
+bool apx_uring_prep_multishot_recv(apx_uring_t* self, int fd, uint64_t user_data)
+{
+   struct io_uring_sqe* sqe = get_sqe(self);
+   if (sqe != NULL)
+   {
+      sqe->opcode = IORING_OP_RECV;
+      sqe->fd = fd;
+      sqe->ioprio = IORING_RECV_MULTISHOT;
+      sqe->flags = IOSQE_BUFFER_SELECT;
+      sqe->buf_group = self->buf_group;
+      sqe->user_data = user_data;
+      return true;
+   }
+   return false;
+}
+
+/**
+ * Prepares a send of the full buffer. With link_next set, the next prepared SQE does not start until this
+ * send has completed. A send that cannot be completed in full breaks the chain and the remaining
+ * sends in the chain complete with -ECANCELED.
+ */
+bool apx_uring_prep_send(apx_uring_t* self, int fd, uint8_t const* data, uint32_t size, uint64_t user_data, bool link_next)
+{
+   struct io_uring_sqe* sqe = get_sqe(self);
+   if (sqe != NULL)
+   {
+      sqe->opcode = IORING_OP_SEND;
+      sqe->fd = fd;
+      sqe->addr = (uint64_t)(uintptr_t) data;
+      sqe->len = size;
+      sqe->msg_flags = MSG_WAITALL | MSG_NOSIGNAL;
+      sqe->flags = link_next ? IOSQE_IO_LINK : 0u;
+      sqe->user_data = user_data;
+      return true;
+   }
+   return false;
+}
+
+bool apx_uring_prep_nop(apx_uring_t* self, uint64_t user_data)
+{
+   struct io_uring_sqe* sqe = get_sqe(self);
+   if (sqe != NULL)
+   {
+      sqe->opcode = IORING_OP_NOP;
+      sqe->user_data = user_data;
+      return true;
+   }
+   return false;
+}
+
+uint32_t apx_uring_sq_space_left(apx_uring_t const* self)
+{
+   if (self != NULL)
+   {
+      uint32_t const head = __atomic_load_n(self->sq_head, __ATOMIC_ACQUIRE);
+      return self->sq_entries - (self->sq_local_tail - head);
+   }
+   return 0u;
+}
+
+/**
+ * Makes prepared SQEs visible to the kernel without a system call.
+ * They are submitted by the next apx_uring_submit or apx_uring_submit_and_wait call from any thread.
+ */
+void apx_uring_publish(apx_uring_t* self)
+{
+   if (self != NULL)
+   {
+      publish_sqes(self);
+   }
+}
+
+/**
+ * Publishes prepared SQEs and submits them without waiting.
+ * Returns number of submitted SQEs or negative errno.
+ */
+int apx_uring_submit(apx_uring_t* self)
+{
+   if (self != NULL)
+   {
+      publish_sqes(self);
+      return enter(self, 0u, 0u);
+   }
+   return -EINVAL;
+}
+
+/**
+ * Submits published SQEs and waits for at least wait_nr completions in the same system call.
+ * Reads only the shared SQ tail, so it may be called while another thread is preparing SQEs.
+ */
+int apx_uring_submit_and_wait(apx_uring_t* self, uint32_t wait_nr)
+{
+   if (self != NULL)
+   {
+      return enter(self, wait_nr, IORING_ENTER_GETEVENTS);
+   }
+   return -EINVAL;
+}
+
+/**
+ * Copies up to max_count completions and frees their slots in the completion queue.
+ */
+uint32_t apx_uring_peek_completions(apx_uring_t* self, apx_uringCompletion_t* completions, uint32_t max_count)
+{
+   uint32_t count = 0u;
+   if ( (self != NULL) && (completions != NULL) )
+   {
+      uint32_t head = *self->cq_head;
+      uint32_t const tail = __atomic_load_n(self->cq_tail, __ATOMIC_ACQUIRE);
+      while ( (head != tail) && (count < max_count) )
+      {
+         struct io_uring_cqe const* cqe = &self->cqes[head & self->cq_mask];
+         completions[count].user_data = cqe->user_data;
+         completions[count].res = cqe->res;
+         completions[count].flags = cqe->flags;
+         count++;
+         head++;
+      }
+      __atomic_store_n(self->cq_head, head, __ATOMIC_RELEASE);
+   }
+   return count;
+}
+
+bool apx_uringCompletion_has_more(apx_uringCompletion_t const* self)
+{
+   return (self != NULL) && ((self->flags & IORING_CQE_F_MORE) != 0u);
+}
+
+bool apx_uringCompletion_get_buffer_id(apx_uringCompletion_t const* self, uint16_t* buffer_id)
+{
+   if ( (self != NULL) && (buffer_id != NULL) && ((self->flags & IORING_CQE_F_BUFFER) != 0u) )
+   {
+      *buffer_id = (uint16_t) (self->flags >> IORING_CQE_BUFFER_SHIFT);
+      return true;
+   }
+   return false;
+}
+
+#else
+
+apx_error_t apx_uring_create(apx_uring_t* self, uint32_t entries)
+{
+   (void)entries;
+   if (self != NULL)
+   {
+      memset(self, 0, sizeof(apx_uring_t));
+      self->ring_fd = -1;
+      return APX_NOT_IMPLEMENTED_ERROR;
+   }
+   return APX_INVALID_ARGUMENT_ERROR;
+}
+
+void apx_uring_destroy(apx_uring_t* self)
+{
+   (void)self;
+}
+
+apx_error_t apx_uring_probe(void)
+{
+   return APX_NOT_IMPLEMENTED_ERROR;
+}
+
+#endif
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+#if APX_URING_SUPPORTED
+
+static struct io_uring_sqe* get_sqe(apx_uring_t* self)
+{
+   if (self != NULL)
+   {
+      uint32_t const head = __atomic_load_n(self->sq_head, __ATOMIC_ACQUIRE);
+      if ( (self->sq_local_tail - head) < self->sq_entries)
+      {
+         struct io_uring_sqe* sqe = &self->sqes[self->sq_local_tail & self->sq_mask];
+         self->sq_local_tail++;
+         memset(sqe, 0, sizeof(struct io_uring_sqe));
+         return sqe;
+      }
+   }
+   return NULL;
+}
+
+static void publish_sqes(apx_uring_t* self)
+{
+   __atomic_store_n(self->sq_tail, self->sq_local_tail, __ATOMIC_RELEASE);
+}
+
+static int enter(apx_uring_t* self, uint32_t wait_nr, uint32_t flags)
+{
+   for (;;)
+   {
+      uint32_t const to_submit = __atomic_load_n(self->sq_tail, __ATOMIC_ACQUIRE) - __atomic_load_n(self->sq_head, __ATOMIC_ACQUIRE);
+      long result = syscall(__NR_io_uring_enter, self->ring_fd, to_submit, wait_nr, flags, NULL, 0);
+      if (result >= 0)
+      {
+         return (int) result;
+      }
+      if (errno != EINTR)
+      {
+         return -errno;
+      }
+   }
+}
+
+static void add_buffer(apx_uring_t* self, uint16_t buffer_id)
+{
+   struct io_uring_buf* buf = &self->buf_ring->bufs[self->buf_tail & (self->buf_count - 1u)];
+   buf->addr = (uint64_t)(uintptr_t) (self->buf_memory + ((size_t)buffer_id) * self->buf_size);
+   buf->len = self->buf_size;
+   buf->bid = buffer_id;
+   self->buf_tail++;
+}
+
+static bool check_probe_completions(apx_uringCompletion_t const* completions, uint32_t num_completions)
+{
+   bool recv_ok = false;
+   bool send_ok = false;
+   bool nop_ok = false;
+   uint32_t i;
+   for (i = 0u; i < num_completions; i++)
+   {
+      uint16_t buffer_id;
+      switch (completions[i].user_data)
+      {
+      case PROBE_USER_DATA_RECV:
+         recv_ok = (completions[i].res == 1) && apx_uringCompletion_has_more(&completions[i]) &&
+            apx_uringCompletion_get_buffer_id(&completions[i], &buffer_id);
+         break;
+      case PROBE_USER_DATA_SEND:
+         send_ok = (completions[i].res == 1);
+         break;
+      case PROBE_USER_DATA_NOP:
+         nop_ok = (completions[i].res == 0);
+         break;
+      default:
+         break;
+      }
+   }
+   return recv_ok && send_ok && nop_ok;
+}
+
+#endif
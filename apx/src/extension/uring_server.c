@@ -0,0 +1,701 @@
+/*****************************************************************************
+* \file      uring_server.c
+* \author    Conny Gustafsson
+* \date      2026-10-18
+* \brief     Socket server based on io_uring (TCP+UNIX)
+*
+* Copyright (c) 2026 Conny Gustafsson
+* Permission is hereby granted, free of charge, to any person obtaining a copy of
+* this software and associated documentation files (the "Software"), to deal in
+* the Software without restriction, including without limitation the rights to
+* use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+* the Software, and to permit persons to whom the Software is furnished to do so,
+* subject to the following conditions:
+
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+* FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+* COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+* IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+* CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+******************************************************************************/
+//////////////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////////////
+#include <malloc.h>
+#include <string.h>
+#include <assert.h>
+#include <stdio.h>
+#include "apx/extension/uring_server.h"
+#include "apx/cfg.h"
+#if APX_URING_SERVER_SUPPORTED
+#include <errno.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include "apx/server.h"
+#endif
+#ifdef MEM_LEAK_CHECK
+#include "CMemLeak.h"
+#endif
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE CONSTANTS AND DATA TYPES
+//////////////////////////////////////////////////////////////////////////////
+#define DEFAULT_QUEUE_DEPTH 256u
+#define DEFAULT_BUFFER_COUNT 256u
+#define DEFAULT_BUFFER_SIZE 16384u //16KB
+#define DEFAULT_SEND_BLOCK_SIZE 4096u //4KB, same as send buffer of socket server connection
+
+#if APX_URING_SERVER_SUPPORTED
+//The low bits of user_data tell the kind of request. Send requests store the address of the send block in the remaining bits.
+#define USER_DATA_KIND_MASK 7u
+#define USER_DATA_KIND_SEND 1u
+#define USER_DATA_KIND_ACCEPT_TCP 2u
+#define USER_DATA_KIND_ACCEPT_UNIX 3u
+#define USER_DATA_KIND_RECV 4u
+#define USER_DATA_KIND_WAKEUP 5u
+#define USER_DATA_SLOT_SHIFT 3u
+#define USER_DATA_SLOT_MASK 0x1FFFFFFFu
+#define USER_DATA_GENERATION_SHIFT 32u
+#define BUFFER_GROUP_ID 0u
+#define MAX_COMPLETIONS_PER_WAKEUP 256u
+#define SHUTDOWN_DRAIN_TIMEOUT_MS 1000
+#endif
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////////////
+#if APX_URING_SERVER_SUPPORTED
+static THREAD_PROTO(event_thread, arg);
+static void event_loop_main(apx_uringServer_t* self);
+static void drain_sends(apx_uringServer_t* self, apx_uringCompletion_t* completions);
+static uint32_t process_completions(apx_uringServer_t* self, apx_uringCompletion_t* completions);
+static void handle_accept(apx_uringServer_t* self, apx_uringCompletion_t const* completion, bool is_unix);
+static void handle_receive(apx_uringServer_t* self, apx_uringCompletion_t const* completion);
+static void handle_send(apx_uringServer_t* self, apx_uringCompletion_t const* completion);
+static void accept_connection(apx_uringServer_t* self, int fd, bool is_unix);
+static apx_uringServerConnection_t* find_connection(apx_uringServer_t* self, uint64_t user_data);
+static bool assign_slot(apx_uringServer_t* self, apx_uringServerConnection_t* connection);
+static apx_error_t arm_accept(apx_uringServer_t* self, int fd, uint64_t user_data);
+static void flush_submissions(apx_uringServer_t* self);
+static bool is_running(apx_uringServer_t* self);
+static void close_listen_socket(int* fd);
+#endif
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE VARIABLES
+//////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////
+// PUBLIC FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+void apx_uringServerCfg_set_defaults(apx_uringServerCfg_t* cfg)
+{
+   if (cfg != NULL)
+   {
+      cfg->queue_depth = DEFAULT_QUEUE_DEPTH;
+      cfg->buffer_count = DEFAULT_BUFFER_COUNT;
+      cfg->buffer_size = DEFAULT_BUFFER_SIZE;
+      cfg->max_connections = APX_SERVER_MAX_CONCURRENT_CONNECTIONS;
+      cfg->send_block_size = DEFAULT_SEND_BLOCK_SIZE;
+      cfg->tcp_nodelay = false;
+   }
+}
+
+#if APX_URING_SERVER_SUPPORTED
+void apx_uringServer_create(apx_uringServer_t* self, struct apx_server_tag* apx_server, apx_uringServerCfg_t const* cfg)
+{
+   if (self != NULL)
+   {
+      memset(&self->ring, 0, sizeof(self->ring));
+      self->ring.ring_fd = -1;
+      if (cfg != NULL)
+      {
+         memcpy(&self->cfg, cfg, sizeof(apx_uringServerCfg_t));
+      }
+      else
+      {
+         apx_uringServerCfg_set_defaults(&self->cfg);
+      }
+      self->parent = apx_server;
+      self->slots = (apx_uringServerSlot_t*) 0;
+      self->next_slot = 0u;
+      self->num_sends_in_flight = 0u;
+      self->tcp_listen_fd = -1;
+      self->unix_listen_fd = -1;
+      self->tcp_port = 0u;
+      self->unix_server_file = (char*) 0;
+      self->is_running = false;
+      self->is_thread_valid = false;
+      self->is_ring_valid = false;
+      MUTEX_INIT(self->submit_lock);
+      MUTEX_INIT(self->connection_lock);
+   }
+}
+
+void apx_uringServer_destroy(apx_uringServer_t* self)
+{
+   if (self != NULL)
+   {
+      apx_uringServer_stop(self);
+      if (self->slots != NULL)
+      {
+         free(self->slots);
+      }
+      if (self->unix_server_file != NULL)
+      {
+         free(self->unix_server_file);
+      }
+      MUTEX_DESTROY(self->connection_lock);
+      MUTEX_DESTROY(self->submit_lock);
+   }
+}
+
+apx_uringServer_t* apx_uringServer_new(struct apx_server_tag* apx_server, apx_uringServerCfg_t const* cfg)
+{
+   apx_uringServer_t* self = (apx_uringServer_t*) malloc(sizeof(apx_uringServer_t));
+   if (self != NULL)
+   {
+      apx_uringServer_create(self, apx_server, cfg);
+   }
+   return self;
+}
+
+void apx_uringServer_delete(apx_uringServer_t* self)
+{
+   if (self != NULL)
+   {
+      apx_uringServer_destroy(self);
+      free(self);
+   }
+}
+
+/**
+ * Sets up the ring with its shared receive buffers and starts the event thread.
+ */
+apx_error_t apx_uringServer_start(apx_uringServer_t* self)
+{
+   if ( (self != NULL) && (!self->is_ring_valid) )
+   {
+      apx_error_t result;
+      int rc;
+      if ( (self->cfg.max_connections == 0u) || (self->cfg.max_connections > USER_DATA_SLOT_MASK) || (self->cfg.send_block_size == 0u) )
+      {
+         return APX_INVALID_ARGUMENT_ERROR;
+      }
+      result = apx_uring_create(&self->ring, self->cfg.queue_depth);
+      if (result != APX_NO_ERROR)
+      {
+         return result;
+      }
+      result = apx_uring_register_buffers(&self->ring, BUFFER_GROUP_ID, self->cfg.buffer_count, self->cfg.buffer_size);
+      if (result == APX_NO_ERROR)
+      {
+         self->slots = (apx_uringServerSlot_t*) calloc(self->cfg.max_connections, sizeof(apx_uringServerSlot_t));
+         if (self->slots == NULL)
+         {
+            result = APX_MEM_ERROR;
+         }
+      }
+      if (result != APX_NO_ERROR)
+      {
+         apx_uring_destroy(&self->ring);
+         return result;
+      }
+      self->is_ring_valid = true;
+      self->is_running = true;
+      rc = THREAD_CREATE(self->thread, event_thread, self);
+      if (rc != 0)
+      {
+         self->is_running = false;
+         return APX_THREAD_CREATE_ERROR;
+      }
+      self->is_thread_valid = true;
+      return APX_NO_ERROR;
+   }
+   return APX_INVALID_ARGUMENT_ERROR;
+}
+
+apx_error_t apx_uringServer_start_tcp_server(apx_uringServer_t* self, uint16_t tcp_port)
+{
+   if ( (self != NULL) && self->is_thread_valid && (self->tcp_listen_fd < 0) )
+   {
+      struct sockaddr_in addr;
+      int flag = 1;
+      int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+      if (fd < 0)
+      {
+         return APX_CONNECTION_ERROR;
+      }
+      (void)setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &flag, (socklen_t)sizeof(flag));
+      memset(&addr, 0, sizeof(addr));
+      addr.sin_family = AF_INET;
+      addr.sin_addr.s_addr = htonl(INADDR_ANY);
+      addr.sin_port = htons(tcp_port);
+      if ( (bind(fd, (struct sockaddr*) &addr, (socklen_t)sizeof(addr)) != 0) || (listen(fd, SOMAXCONN) != 0) )
+      {
+         close(fd);
+         return APX_CONNECTION_ERROR;
+      }
+      self->tcp_port = tcp_port;
+      self->tcp_listen_fd = fd;
+      printf("Listening on TCP port %d (io_uring)\n", (int) self->tcp_port);
+      return arm_accept(self, fd, USER_DATA_KIND_ACCEPT_TCP);
+   }
+   return APX_INVALID_ARGUMENT_ERROR;
+}
+
+apx_error_t apx_uringServer_start_unix_server(apx_uringServer_t* self, char const* file_path)
+{
+   if ( (self != NULL) && (file_path != NULL) && self->is_thread_valid && (self->unix_listen_fd < 0) )
+   {
+      struct sockaddr_un addr;
+      int fd;
+      if (strlen(file_path) >= sizeof(addr.sun_path))
+      {
+         return APX_INVALID_ARGUMENT_ERROR;
+      }
+      fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+      if (fd < 0)
+      {
+         return APX_CONNECTION_ERROR;
+      }
+      memset(&addr, 0, sizeof(addr));
+      addr.sun_family = AF_UNIX;
+      strcpy(addr.sun_path, file_path);
+      (void)unlink(file_path); //left behind by a previous server that was not shut down properly
+      if ( (bind(fd, (struct sockaddr*) &addr, (socklen_t)sizeof(addr)) != 0) || (listen(fd, SOMAXCONN) != 0) )
+      {
+         close(fd);
+         return APX_CONNECTION_ERROR;
+      }
+      self->unix_server_file = STRDUP(file_path);
+      self->unix_listen_fd = fd;
+      printf("Listening on UNIX socket %s (io_uring)\n", self->unix_server_file);
+      return arm_accept(self, fd, USER_DATA_KIND_ACCEPT_UNIX);
+   }
+   return APX_INVALID_ARGUMENT_ERROR;
+}
+
+/**
+ * Stops accepting connections and shuts down the sockets of all active connections.
+ * The event thread keeps running until all sends in flight have completed, after that the ring is destroyed.
+ * Connection objects are owned by the APX server and are destroyed later. They no longer refer to this server.
+ */
+void apx_uringServer_stop(apx_uringServer_t* self)
+{
+   if (self != NULL)
+   {
+      if (self->is_thread_valid)
+      {
+         uint32_t i;
+         void* status;
+         close_listen_socket(&self->tcp_listen_fd);
+         close_listen_socket(&self->unix_listen_fd);
+         if (self->unix_server_file != NULL)
+         {
+            (void)unlink(self->unix_server_file);
+         }
+         MUTEX_LOCK(self->connection_lock);
+         for (i = 0u; i < self->cfg.max_connections; i++)
+         {
+            if (self->slots[i].connection != NULL)
+            {
+               apx_uringServerConnection_on_server_stopped(self->slots[i].connection);
+            }
+         }
+         MUTEX_UNLOCK(self->connection_lock);
+         __atomic_store_n(&self->is_running, false, __ATOMIC_RELEASE);
+         MUTEX_LOCK(self->submit_lock);
+         if (!apx_uring_prep_nop(&self->ring, USER_DATA_KIND_WAKEUP))
+         {
+            (void)apx_uring_submit(&self->ring);
+            (void)apx_uring_prep_nop(&self->ring, USER_DATA_KIND_WAKEUP);
+         }
+         (void)apx_uring_submit(&self->ring);
+         MUTEX_UNLOCK(self->submit_lock);
+         (void)pthread_join(self->thread, &status);
+         self->is_thread_valid = false;
+         MUTEX_LOCK(self->connection_lock);
+         for (i = 0u; i < self->cfg.max_connections; i++)
+         {
+            self->slots[i].connection = NULL;
+         }
+         MUTEX_UNLOCK(self->connection_lock);
+      }
+      if (self->is_ring_valid)
+      {
+         apx_uring_destroy(&self->ring);
+         self->is_ring_valid = false;
+      }
+   }
+}
+
+/**
+ * Arms the multishot receive of a newly started connection.
+ * Called from the event thread while the connection is being accepted.
+ */
+apx_error_t apx_uringServer_arm_receive(apx_uringServer_t* self, apx_uringServerConnection_t* connection)
+{
+   if ( (self != NULL) && (connection != NULL) )
+   {
+      uint64_t const user_data = (((uint64_t)connection->generation) << USER_DATA_GENERATION_SHIFT) |
+         (((uint64_t)connection->slot) << USER_DATA_SLOT_SHIFT) | USER_DATA_KIND_RECV;
+      bool is_prepared;
+      MUTEX_LOCK(self->submit_lock);
+      is_prepared = apx_uring_prep_multishot_recv(&self->ring, connection->fd, user_data);
+      if (!is_prepared)
+      {
+         (void)apx_uring_submit(&self->ring);
+         is_prepared = apx_uring_prep_multishot_recv(&self->ring, connection->fd, user_data);
+      }
+      if (is_prepared)
+      {
+         flush_submissions(self);
+      }
+      MUTEX_UNLOCK(self->submit_lock);
+      return is_prepared ? APX_NO_ERROR : APX_BUFFER_FULL_ERROR;
+   }
+   return APX_INVALID_ARGUMENT_ERROR;
+}
+
+/**
+ * Submits num_blocks send blocks as one chain of linked sends. Either the whole chain is prepared or nothing is.
+ * Chains started from the event thread (when the previous chain completes) are only published, they are
+ * submitted together with other connections' requests when the event thread waits for the next completions.
+ */
+apx_error_t apx_uringServer_submit_sends(apx_uringServer_t* self, int fd, apx_uringSendBlock_t* first, uint32_t num_blocks)
+{
+   if ( (self != NULL) && (first != NULL) && (num_blocks > 0u) )
+   {
+      apx_uringSendBlock_t* block;
+      MUTEX_LOCK(self->submit_lock);
+      if (apx_uring_sq_space_left(&self->ring) < num_blocks)
+      {
+         (void)apx_uring_submit(&self->ring);
+         if (apx_uring_sq_space_left(&self->ring) < num_blocks)
+         {
+            MUTEX_UNLOCK(self->submit_lock);
+            return APX_BUFFER_FULL_ERROR;
+         }
+      }
+      for (block = first; block != NULL; block = block->next)
+      {
+         uint64_t const user_data = ((uint64_t)(uintptr_t)block) | USER_DATA_KIND_SEND;
+         assert((((uintptr_t)block) & USER_DATA_KIND_MASK) == 0u);
+         (void)apx_uring_prep_send(&self->ring, fd, block->data, (uint32_t)block->size, user_data, block->next != NULL);
+      }
+      (void)__atomic_add_fetch(&self->num_sends_in_flight, num_blocks, __ATOMIC_RELAXED);
+      flush_submissions(self);
+      MUTEX_UNLOCK(self->submit_lock);
+      return APX_NO_ERROR;
+   }
+   return APX_INVALID_ARGUMENT_ERROR;
+}
+
+bool apx_uringServer_is_event_thread(apx_uringServer_t* self)
+{
+   if (self != NULL)
+   {
+      return self->is_thread_valid && (pthread_equal(pthread_self(), self->thread) != 0);
+   }
+   return false;
+}
+
+/**
+ * Called when a connection is destroyed. Completions that arrive later for the same slot are ignored.
+ */
+void apx_uringServer_remove_connection(apx_uringServer_t* self, apx_uringServerConnection_t* connection)
+{
+   if ( (self != NULL) && (connection != NULL) )
+   {
+      MUTEX_LOCK(self->connection_lock);
+      if ( (self->slots != NULL) && (connection->slot < self->cfg.max_connections) && (self->slots[connection->slot].connection == connection) )
+      {
+         self->slots[connection->slot].connection = NULL;
+      }
+      apx_uringServerConnection_release_in_flight(connection);
+      MUTEX_UNLOCK(self->connection_lock);
+   }
+}
+#endif
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+#if APX_URING_SERVER_SUPPORTED
+static THREAD_PROTO(event_thread, arg)
+{
+   if (arg != NULL)
+   {
+      event_loop_main((apx_uringServer_t*) arg);
+   }
+   THREAD_RETURN(0);
+}
+
+/**
+ * Waits for completions and handles all that are ready in one go. Requests prepared while handling them
+ * (re-armed receives, new send chains) are submitted by the same system call that waits for the next completions.
+ */
+static void event_loop_main(apx_uringServer_t* self)
+{
+   apx_uringCompletion_t* completions = (apx_uringCompletion_t*) malloc(MAX_COMPLETIONS_PER_WAKEUP * sizeof(apx_uringCompletion_t));
+   if (completions == NULL)
+   {
+      return;
+   }
+   while (is_running(self))
+   {
+      int const result = apx_uring_submit_and_wait(&self->ring, 1u);
+      if ( (result < 0) && (result != -EBUSY) && (result != -EAGAIN) )
+      {
+         fprintf(stderr, "[URING-SERVER] io_uring_enter failed (%d)\n", result);
+         break;
+      }
+      while (process_completions(self, completions) == MAX_COMPLETIONS_PER_WAKEUP)
+      {
+      }
+   }
+   drain_sends(self, completions);
+   free(completions);
+}
+
+/**
+ * The kernel may still read from send blocks in flight. Their memory is only freed once the sends have completed.
+ */
+static void drain_sends(apx_uringServer_t* self, apx_uringCompletion_t* completions)
+{
+   int elapsed_ms = 0;
+   while ( (__atomic_load_n(&self->num_sends_in_flight, __ATOMIC_RELAXED) > 0u) && (elapsed_ms < SHUTDOWN_DRAIN_TIMEOUT_MS) )
+   {
+      (void)apx_uring_submit(&self->ring);
+      if (process_completions(self, completions) == 0u)
+      {
+         SLEEP(1);
+         elapsed_ms++;
+      }
+   }
+}
+
+static uint32_t process_completions(apx_uringServer_t* self, apx_uringCompletion_t* completions)
+{
+   uint32_t i;
+   uint32_t const num_completions = apx_uring_peek_completions(&self->ring, completions, MAX_COMPLETIONS_PER_WAKEUP);
+   for (i = 0u; i < num_completions; i++)
+   {
+      switch (completions[i].user_data & USER_DATA_KIND_MASK)
+      {
+      case USER_DATA_KIND_SEND:
+         handle_send(self, &completions[i]);
+         break;
+      case USER_DATA_KIND_RECV:
+         handle_receive(self, &completions[i]);
+         break;
+      case USER_DATA_KIND_ACCEPT_TCP:
+         handle_accept(self, &completions[i], false);
+         break;
+      case USER_DATA_KIND_ACCEPT_UNIX:
+         handle_accept(self, &completions[i], true);
+         break;
+      default:
+         break;
+      }
+   }
+   return num_completions;
+}
+
+static void handle_accept(apx_uringServer_t* self, apx_uringCompletion_t const* completion, bool is_unix)
+{
+   if (completion->res >= 0)
+   {
+      if (is_running(self))
+      {
+         accept_connection(self, completion->res, is_unix);
+      }
+      else
+      {
+         close(completion->res);
+      }
+   }
+   if ( (!apx_uringCompletion_has_more(completion)) && is_running(self) )
+   {
+      int const listen_fd = is_unix ? self->unix_listen_fd : self->tcp_listen_fd;
+      if (listen_fd >= 0)
+      {
+         (void)arm_accept(self, listen_fd, completion->user_data);
+      }
+   }
+}
+
+static void handle_receive(apx_uringServer_t* self, apx_uringCompletion_t const* completion)
+{
+   uint16_t buffer_id = 0u;
+   bool const has_buffer = apx_uringCompletion_get_buffer_id(completion, &buffer_id);
+   apx_uringServerConnection_t* connection;
+   MUTEX_LOCK(self->connection_lock);
+   connection = find_connection(self, completion->user_data);
+   if ( (connection != NULL) && is_running(self) )
+   {
+      if (completion->res > 0)
+      {
+         assert(has_buffer);
+         if (!apx_uringServerConnection_on_data_received(connection, apx_uring_get_buffer(&self->ring, buffer_id), (apx_size_t)completion->res))
+         {
+            //Parse error. Disconnect is reported when the receive completes with end-of-file
+            (void)shutdown(connection->fd, SHUT_RDWR);
+         }
+      }
+      if ( (completion->res > 0) || (completion->res == -ENOBUFS) )
+      {
+         if (!apx_uringCompletion_has_more(completion))
+         {
+            //Kernel stopped the multishot request, for example when it ran out of receive buffers
+            (void)apx_uringServer_arm_receive(self, connection);
+         }
+      }
+      else
+      {
+         apx_uringServerConnection_on_disconnected(connection);
+      }
+   }
+   MUTEX_UNLOCK(self->connection_lock);
+   if (has_buffer)
+   {
+      apx_uring_recycle_buffer(&self->ring, buffer_id);
+   }
+}
+
+static void handle_send(apx_uringServer_t* self, apx_uringCompletion_t const* completion)
+{
+   apx_uringSendBlock_t* block = (apx_uringSendBlock_t*)(uintptr_t)(completion->user_data & ~((uint64_t)USER_DATA_KIND_MASK));
+   (void)__atomic_sub_fetch(&self->num_sends_in_flight, 1u, __ATOMIC_RELAXED);
+   MUTEX_LOCK(self->connection_lock);
+   if (block->owner != NULL)
+   {
+      apx_uringServerConnection_on_send_complete(block->owner, block, completion->res);
+   }
+   else
+   {
+      free(block);
+   }
+   MUTEX_UNLOCK(self->connection_lock);
+}
+
+static void accept_connection(apx_uringServer_t* self, int fd, bool is_unix)
+{
+   apx_uringServerConnection_t* new_connection;
+#if APX_DEBUG_ENABLE
+   printf("[URING-SERVER] New %s connection\n", is_unix ? "UNIX" : "TCP");
+#endif
+   if ( (!is_unix) && self->cfg.tcp_nodelay)
+   {
+      int flag = 1;
+      (void)setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &flag, (socklen_t)sizeof(flag));
+   }
+   new_connection = apx_uringServerConnection_new(self, fd, self->cfg.send_block_size);
+   if (new_connection == NULL)
+   {
+      close(fd);
+      return;
+   }
+   if (!assign_slot(self, new_connection))
+   {
+      apx_uringServerConnection_delete(new_connection);
+      return;
+   }
+   apx_server_accept_connection(self->parent, (apx_serverConnection_t*)new_connection);
+}
+
+static apx_uringServerConnection_t* find_connection(apx_uringServer_t* self, uint64_t user_data)
+{
+   uint32_t const slot = (uint32_t)((user_data >> USER_DATA_SLOT_SHIFT) & USER_DATA_SLOT_MASK);
+   uint32_t const generation = (uint32_t)(user_data >> USER_DATA_GENERATION_SHIFT);
+   if ( (slot < self->cfg.max_connections) && (self->slots[slot].generation == generation) )
+   {
+      return self->slots[slot].connection;
+   }
+   return (apx_uringServerConnection_t*) 0;
+}
+
+static bool assign_slot(apx_uringServer_t* self, apx_uringServerConnection_t* connection)
+{
+   uint32_t i;
+   bool is_assigned = false;
+   MUTEX_LOCK(self->connection_lock);
+   for (i = 0u; i < self->cfg.max_connections; i++)
+   {
+      uint32_t const slot = (self->next_slot + i) % self->cfg.max_connections;
+      if (self->slots[slot].connection == NULL)
+      {
+         self->slots[slot].connection = connection;
+         self->slots[slot].generation++;
+         connection->slot = slot;
+         connection->generation = self->slots[slot].generation;
+         self->next_slot = (slot + 1u) % self->cfg.max_connections;
+         is_assigned = true;
+         break;
+      }
+   }
+   MUTEX_UNLOCK(self->connection_lock);
+   return is_assigned;
+}
+
+static apx_error_t arm_accept(apx_uringServer_t* self, int fd, uint64_t user_data)
+{
+   bool is_prepared;
+   MUTEX_LOCK(self->submit_lock);
+   is_prepared = apx_uring_prep_multishot_accept(&self->ring, fd, user_data);
+   if (!is_prepared)
+   {
+      (void)apx_uring_submit(&self->ring);
+      is_prepared = apx_uring_prep_multishot_accept(&self->ring, fd, user_data);
+   }
+   if (is_prepared)
+   {
+      flush_submissions(self);
+   }
+   MUTEX_UNLOCK(self->submit_lock);
+   return is_prepared ? APX_NO_ERROR : APX_BUFFER_FULL_ERROR;
+}
+
+/**
+ * The event thread only publishes its requests since it submits them when it waits for completions.
+ * Other threads submit right away. Must be called with submit_lock held.
+ */
+static void flush_submissions(apx_uringServer_t* self)
+{
+   if (apx_uringServer_is_event_thread(self))
+   {
+      apx_uring_publish(&self->ring);
+   }
+   else
+   {
+      (void)apx_uring_submit(&self->ring);
+   }
+}
+
+static bool is_running(apx_uringServer_t* self)
+{
+   return __atomic_load_n(&self->is_running, __ATOMIC_ACQUIRE);
+}
+
+/**
+ * shutdown also ends the multishot accept armed on the socket, which close alone would not do.
+ */
+static void close_listen_socket(int* fd)
+{
+   if (*fd >= 0)
+   {
+      (void)shutdown(*fd, SHUT_RDWR);
+      close(*fd);
+      *fd = -1;
+   }
+}
+#endif
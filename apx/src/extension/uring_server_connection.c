@@ -0,0 +1,717 @@
+/*****************************************************************************
+* \file      uring_server_connection.c
+* \author    Conny Gustafsson
+* \date      2026-10-18
+* \brief     Server connection using the io_uring socket server
+*
+* Copyright (c) 2026 Conny Gustafsson
+* Permission is hereby granted, free of charge, to any person obtaining a copy of
+* this software and associated documentation files (the "Software"), to deal in
+* the Software without restriction, including without limitation the rights to
+* use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+* the Software, and to permit persons to whom the Software is furnished to do so,
+* subject to the following conditions:
+
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+* FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+* COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+* IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+* CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+******************************************************************************/
+//////////////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////////////
+#include <malloc.h>
+#include <string.h>
+#include <assert.h>
+#include <stdio.h> //Debug only
+#include "apx/extension/uring_server_connection.h"
+#if APX_URING_SERVER_SUPPORTED
+#include <unistd.h>
+#include <sys/socket.h>
+#include "apx/extension/uring_server.h"
+#include "apx/numheader.h"
+#include "apx/remotefile.h"
+#include "apx/server.h"
+#endif
+#ifdef MEM_LEAK_CHECK
+#include "CMemLeak.h"
+#endif
+
+#if APX_URING_SERVER_SUPPORTED
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE CONSTANTS AND DATA TYPES
+//////////////////////////////////////////////////////////////////////////////
+#define RECEIVE_BUFFER_GROW_SIZE 4096 //4KB
+#define MAX_LINKED_SENDS 16u //Longest chain of linked sends submitted at once
+#define MAX_FREE_BLOCKS 4u //Send blocks kept for reuse
+#define MAX_BUFFERED_BLOCKS 64u //Worker thread waits when more than this many blocks are queued or in flight
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////////////
+static void create_connection_interface_vtable(apx_uringServerConnection_t* self, apx_connectionInterface_t* interface);
+
+//APX BaseConnection API
+static void connection_close(apx_uringServerConnection_t* self);
+static void connection_start(apx_uringServerConnection_t* self);
+
+// ConnectionInterface API
+static int32_t connection_transmit_max_bytes_avaiable(apx_uringServerConnection_t* self);
+static int32_t connection_transmit_current_bytes_avaiable(apx_uringServerConnection_t* self);
+static void connection_transmit_begin(apx_uringServerConnection_t* self);
+static void connection_transmit_end(apx_uringServerConnection_t* self);
+static apx_error_t connection_transmit_data_message(apx_uringServerConnection_t* self, uint32_t write_address, bool more_bit, uint8_t const* msg_data, int32_t msg_size, int32_t* bytes_available);
+static apx_error_t connection_transmit_direct_message(apx_uringServerConnection_t* self, uint8_t const* msg_data, int32_t msg_size, int32_t* bytes_available);
+static apx_error_t connection_append_message(apx_uringServerConnection_t* self, uint8_t const* header, apx_size_t header_size, uint8_t const* msg_data, apx_size_t msg_size, int32_t* bytes_available);
+
+//Send blocks
+static apx_uringSendBlock_t* get_send_block(apx_uringServerConnection_t* self);
+static void release_send_block(apx_uringServerConnection_t* self, apx_uringSendBlock_t* block);
+static void free_send_blocks(apx_uringSendBlock_t* first);
+static apx_error_t queue_current_block(apx_uringServerConnection_t* self);
+static void start_sends(apx_uringServerConnection_t* self);
+static void discard_queued_blocks(apx_uringServerConnection_t* self);
+static void fail_send(apx_uringServerConnection_t* self);
+static void wake_writer(apx_uringServerConnection_t* self);
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE VARIABLES
+//////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////
+// PUBLIC FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+apx_error_t apx_uringServerConnection_create(apx_uringServerConnection_t* self, struct apx_uringServer_tag* server, int fd, apx_size_t block_size)
+{
+   if ( (self != NULL) && (server != NULL) && (fd >= 0) && (block_size > 0u) )
+   {
+      apx_connectionBaseVTable_t base_connection_vtable;
+      apx_connectionInterface_t connection_interface;
+      apx_error_t retval;
+      self->server = server;
+      self->fd = fd;
+      self->current_block = NULL;
+      self->queued_first = NULL;
+      self->queued_last = NULL;
+      self->in_flight_first = NULL;
+      self->in_flight_last = NULL;
+      self->free_blocks = NULL;
+      self->num_free_blocks = 0u;
+      self->block_size = block_size;
+      self->buffered_bytes = 0u;
+      self->max_buffered_bytes = block_size * MAX_BUFFERED_BLOCKS;
+      self->total_bytes_written = 0u;
+      self->slot = 0u;
+      self->generation = 0u;
+      self->is_disconnected = false;
+      self->is_send_failed = false;
+      self->is_writer_waiting = false;
+      apx_connectionBaseVTable_create(&base_connection_vtable,
+         apx_uringServerConnection_vdestroy,
+         apx_uringServerConnection_vstart,
+         apx_uringServerConnection_vclose);
+      create_connection_interface_vtable(self, &connection_interface);
+      retval = apx_serverConnection_create(&self->base, &base_connection_vtable, &connection_interface);
+      if (retval != APX_NO_ERROR)
+      {
+         return retval;
+      }
+      MUTEX_INIT(self->lock);
+      MUTEX_INIT(self->send_lock);
+      SEMAPHORE_CREATE(self->send_semaphore);
+      adt_bytearray_create(&self->receive_buffer, RECEIVE_BUFFER_GROW_SIZE);
+      apx_nodeManager_create(&self->node_manager, APX_SERVER_MODE);
+      apx_serverConnection_attach_node_manager(&self->base, &self->node_manager);
+      return APX_NO_ERROR;
+   }
+   return APX_INVALID_ARGUMENT_ERROR;
+}
+
+void apx_uringServerConnection_destroy(apx_uringServerConnection_t* self)
+{
+   if (self != NULL)
+   {
+      //Makes sends still in flight fail quickly
+      (void)shutdown(self->fd, SHUT_RDWR);
+      if (self->server != NULL)
+      {
+         apx_uringServer_remove_connection(self->server, self);
+      }
+      apx_serverConnection_destroy(&self->base);
+      close(self->fd);
+      if (self->current_block != NULL)
+      {
+         free(self->current_block);
+      }
+      free_send_blocks(self->queued_first);
+      free_send_blocks(self->free_blocks);
+      //Blocks still in flight here belong to a server that gave up waiting for them during shutdown. They are leaked on purpose.
+      adt_bytearray_destroy(&self->receive_buffer);
+      apx_nodeManager_destroy(&self->node_manager);
+      SEMAPHORE_DESTROY(self->send_semaphore);
+      MUTEX_DESTROY(self->send_lock);
+      MUTEX_DESTROY(self->lock);
+   }
+}
+
+void apx_uringServerConnection_vdestroy(void* arg)
+{
+   apx_uringServerConnection_destroy((apx_uringServerConnection_t*) arg);
+}
+
+apx_uringServerConnection_t* apx_uringServerConnection_new(struct apx_uringServer_tag* server, int fd, apx_size_t block_size)
+{
+   apx_uringServerConnection_t* self = (apx_uringServerConnection_t*) malloc(sizeof(apx_uringServerConnection_t));
+   if (self != NULL)
+   {
+      apx_error_t result = apx_uringServerConnection_create(self, server, fd, block_size);
+      if (result != APX_NO_ERROR)
+      {
+         free(self);
+         self = (apx_uringServerConnection_t*)NULL;
+      }
+   }
+   return self;
+}
+
+void apx_uringServerConnection_delete(apx_uringServerConnection_t* self)
+{
+   if (self != NULL)
+   {
+      apx_uringServerConnection_destroy(self);
+      free(self);
+   }
+}
+
+void apx_uringServerConnection_vdelete(void* arg)
+{
+   apx_uringServerConnection_delete((apx_uringServerConnection_t*) arg);
+}
+
+void apx_uringServerConnection_vstart(void* arg)
+{
+   connection_start((apx_uringServerConnection_t*) arg);
+}
+
+void apx_uringServerConnection_vclose(void* arg)
+{
+   connection_close((apx_uringServerConnection_t*) arg);
+}
+
+/**
+ * Parses data from one receive buffer. The buffer is given back to the kernel when this returns, so an
+ * incomplete message at the end is copied to receive_buffer where the rest of it will be appended.
+ * Returns false on parse error.
+ */
+bool apx_uringServerConnection_on_data_received(apx_uringServerConnection_t* self, uint8_t const* data, apx_size_t data_size)
+{
+   if ( (self != NULL) && (data != NULL) && (data_size > 0u) )
+   {
+      apx_size_t parse_len = 0u;
+      if (adt_bytearray_length(&self->receive_buffer) == 0u)
+      {
+         if (apx_serverConnection_on_data_received(&self->base, data, data_size, &parse_len) != 0)
+         {
+            return false;
+         }
+         if (parse_len < data_size)
+         {
+            if (adt_bytearray_append(&self->receive_buffer, data + parse_len, (uint32_t)(data_size - parse_len)) != 0)
+            {
+               return false;
+            }
+         }
+      }
+      else
+      {
+         apx_size_t pending_size;
+         if (adt_bytearray_append(&self->receive_buffer, data, (uint32_t)data_size) != 0)
+         {
+            return false;
+         }
+         pending_size = (apx_size_t)adt_bytearray_length(&self->receive_buffer);
+         if (apx_serverConnection_on_data_received(&self->base, adt_bytearray_const_data(&self->receive_buffer), pending_size, &parse_len) != 0)
+         {
+            return false;
+         }
+         if (parse_len == pending_size)
+         {
+            adt_bytearray_clear(&self->receive_buffer);
+         }
+         else if (parse_len > 0u)
+         {
+            adt_bytearray_trimLeft(&self->receive_buffer, adt_bytearray_data(&self->receive_buffer) + parse_len);
+         }
+      }
+      return true;
+   }
+   return false;
+}
+
+void apx_uringServerConnection_on_disconnected(apx_uringServerConnection_t* self)
+{
+#if APX_DEBUG_ENABLE
+   printf("[URING-SERVER] Client disconnected\n");
+#endif
+   if ( (self != NULL) && (!self->is_disconnected) )
+   {
+      assert(self->base.parent != NULL);
+      self->is_disconnected = true;
+      apx_server_detach_connection(self->base.parent, &self->base);
+   }
+}
+
+/**
+ * Called for each completed send. Linked sends complete in the order they were submitted, so block is
+ * always the first in-flight block. The next chain is submitted once the current one has completed.
+ */
+void apx_uringServerConnection_on_send_complete(apx_uringServerConnection_t* self, apx_uringSendBlock_t* block, int32_t result)
+{
+   if ( (self != NULL) && (block != NULL) )
+   {
+      MUTEX_LOCK(self->send_lock);
+      assert(block == self->in_flight_first);
+      self->in_flight_first = block->next;
+      if (self->in_flight_first == NULL)
+      {
+         self->in_flight_last = NULL;
+      }
+      self->buffered_bytes -= block->size;
+      if ( (result < 0) || (((apx_size_t)result) != block->size) )
+      {
+         if (!self->is_send_failed)
+         {
+            fail_send(self);
+         }
+      }
+      else
+      {
+         self->total_bytes_written += block->size;
+         self->base.base.total_bytes_sent += (uint32_t)block->size;
+      }
+      release_send_block(self, block);
+      if (self->in_flight_first == NULL)
+      {
+         start_sends(self);
+      }
+      wake_writer(self);
+      MUTEX_UNLOCK(self->send_lock);
+   }
+}
+
+/**
+ * Hands over blocks still in flight to the server, which frees them as their sends complete.
+ * Called by server while removing the connection.
+ */
+void apx_uringServerConnection_release_in_flight(apx_uringServerConnection_t* self)
+{
+   if (self != NULL)
+   {
+      apx_uringSendBlock_t* block;
+      MUTEX_LOCK(self->send_lock);
+      for (block = self->in_flight_first; block != NULL; block = block->next)
+      {
+         block->owner = NULL;
+      }
+      self->in_flight_first = NULL;
+      self->in_flight_last = NULL;
+      self->server = NULL;
+      if (!self->is_send_failed)
+      {
+         fail_send(self);
+      }
+      wake_writer(self);
+      MUTEX_UNLOCK(self->send_lock);
+   }
+}
+
+void apx_uringServerConnection_on_server_stopped(apx_uringServerConnection_t* self)
+{
+   if (self != NULL)
+   {
+      MUTEX_LOCK(self->send_lock);
+      self->server = NULL;
+      if (!self->is_send_failed)
+      {
+         fail_send(self);
+      }
+      MUTEX_UNLOCK(self->send_lock);
+   }
+}
+
+// ConnectionInterface API
+int32_t apx_uringServerConnection_vtransmit_max_bytes_avaiable(void* arg)
+{
+   return connection_transmit_max_bytes_avaiable((apx_uringServerConnection_t*)arg);
+}
+
+int32_t apx_uringServerConnection_vtransmit_current_bytes_avaiable(void* arg)
+{
+   return connection_transmit_current_bytes_avaiable((apx_uringServerConnection_t*)arg);
+}
+
+void apx_uringServerConnection_vtransmit_begin(void* arg)
+{
+   connection_transmit_begin((apx_uringServerConnection_t*)arg);
+}
+
+void apx_uringServerConnection_vtransmit_end(void* arg)
+{
+   connection_transmit_end((apx_uringServerConnection_t*)arg);
+}
+
+apx_error_t apx_uringServerConnection_vtransmit_data_message(void* arg, uint32_t write_address, bool more_bit, uint8_t const* msg_data, int32_t msg_size, int32_t* bytes_available)
+{
+   return connection_transmit_data_message((apx_uringServerConnection_t*)arg, write_address, more_bit, msg_data, msg_size, bytes_available);
+}
+
+apx_error_t apx_uringServerConnection_vtransmit_direct_message(void* arg, uint8_t const* msg_data, int32_t msg_size, int32_t* bytes_available)
+{
+   return connection_transmit_direct_message((apx_uringServerConnection_t*)arg, msg_data, msg_size, bytes_available);
+}
+
+// Statistics
+uint64_t apx_uringServerConnection_get_total_bytes_written(apx_uringServerConnection_t* self)
+{
+   if (self != NULL)
+   {
+      return self->total_bytes_written;
+   }
+   return 0u;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+static void create_connection_interface_vtable(apx_uringServerConnection_t* self, apx_connectionInterface_t* interface)
+{
+   memset(interface, 0, sizeof(apx_connectionInterface_t));
+   interface->arg = (void*)self;
+   interface->transmit_max_buffer_size = apx_uringServerConnection_vtransmit_max_bytes_avaiable;
+   interface->transmit_current_bytes_avaiable = apx_uringServerConnection_vtransmit_current_bytes_avaiable;
+   interface->transmit_begin = apx_uringServerConnection_vtransmit_begin;
+   interface->transmit_end = apx_uringServerConnection_vtransmit_end;
+   interface->transmit_data_message = apx_uringServerConnection_vtransmit_data_message;
+   interface->transmit_direct_message = apx_uringServerConnection_vtransmit_direct_message;
+}
+
+//APX BaseConnection API
+static void connection_close(apx_uringServerConnection_t* self)
+{
+   if (self != NULL)
+   {
+      //The pending receive completes with end-of-file which reports the disconnect
+      (void)shutdown(self->fd, SHUT_RDWR);
+   }
+}
+
+static void connection_start(apx_uringServerConnection_t* self)
+{
+   apx_serverConnection_start(&self->base);
+   if ( (self->server == NULL) || (apx_uringServer_arm_receive(self->server, self) != APX_NO_ERROR) )
+   {
+      connection_close(self);
+   }
+}
+
+// ConnectionInterface API
+static int32_t connection_transmit_max_bytes_avaiable(apx_uringServerConnection_t* self)
+{
+   if (self != NULL)
+   {
+      return (int32_t)self->block_size;
+   }
+   return -1;
+}
+
+static int32_t connection_transmit_current_bytes_avaiable(apx_uringServerConnection_t* self)
+{
+   if (self != NULL)
+   {
+      if (self->current_block != NULL)
+      {
+         return (int32_t)(self->current_block->capacity - self->current_block->size);
+      }
+      return (int32_t)self->block_size;
+   }
+   return -1;
+}
+
+static void connection_transmit_begin(apx_uringServerConnection_t* self)
+{
+   if (self != NULL)
+   {
+      MUTEX_LOCK(self->lock);
+   }
+}
+
+static void connection_transmit_end(apx_uringServerConnection_t* self)
+{
+   if (self != NULL)
+   {
+      if ( (self->current_block != NULL) && (self->current_block->size > 0u) )
+      {
+         (void)queue_current_block(self);
+      }
+      MUTEX_UNLOCK(self->lock);
+   }
+}
+
+static apx_error_t connection_transmit_data_message(apx_uringServerConnection_t* self, uint32_t write_address, bool more_bit, uint8_t const* msg_data, int32_t msg_size, int32_t* bytes_available)
+{
+   if ( (self != NULL) && (msg_size >= 0) )
+   {
+      uint8_t header[NUMHEADER32_LONG_SIZE + RMF_HIGH_ADDR_SIZE];
+      apx_size_t const address_size = rmf_needed_encoding_size(write_address);
+      apx_size_t const header1_size = numheader_encode32(header, sizeof(header), address_size + (apx_size_t)msg_size);
+      assert(header1_size > 0);
+      apx_size_t const header2_size = rmf_address_encode(header + header1_size, sizeof(header) - header1_size, write_address, more_bit);
+      assert(header2_size == address_size);
+      return connection_append_message(self, header, header1_size + header2_size, msg_data, (apx_size_t)msg_size, bytes_available);
+   }
+   return APX_INVALID_ARGUMENT_ERROR;
+}
+
+static apx_error_t connection_transmit_direct_message(apx_uringServerConnection_t* self, uint8_t const* msg_data, int32_t msg_size, int32_t* bytes_available)
+{
+   if ( (self != NULL) && (msg_size >= 0) )
+   {
+      uint8_t header[NUMHEADER32_LONG_SIZE];
+      apx_size_t const header_size = numheader_encode32(header, sizeof(header), (apx_size_t)msg_size);
+      assert(header_size > 0);
+      return connection_append_message(self, header, header_size, msg_data, (apx_size_t)msg_size, bytes_available);
+   }
+   return APX_INVALID_ARGUMENT_ERROR;
+}
+
+/**
+ * Copies header and message into current send block. The payload must be copied since the kernel
+ * reads it after this function has returned. A full block is queued for sending right away.
+ */
+static apx_error_t connection_append_message(apx_uringServerConnection_t* self, uint8_t const* header, apx_size_t header_size, uint8_t const* msg_data, apx_size_t msg_size, int32_t* bytes_available)
+{
+   apx_size_t const message_size = header_size + msg_size;
+   apx_uringSendBlock_t* block;
+   if (message_size > self->block_size)
+   {
+      return APX_MSG_TOO_LARGE_ERROR;
+   }
+   if ( (self->current_block != NULL) && (self->current_block->size + message_size > self->current_block->capacity) )
+   {
+      apx_error_t const result = queue_current_block(self);
+      if (result != APX_NO_ERROR)
+      {
+         return result;
+      }
+   }
+   if (self->current_block == NULL)
+   {
+      self->current_block = get_send_block(self);
+      if (self->current_block == NULL)
+      {
+         return APX_MEM_ERROR;
+      }
+   }
+   block = self->current_block;
+   memcpy(block->data + block->size, header, header_size);
+   memcpy(block->data + block->size + header_size, msg_data, msg_size);
+   block->size += message_size;
+   *bytes_available = (int32_t)(block->capacity - block->size);
+   return APX_NO_ERROR;
+}
+
+//Send blocks
+static apx_uringSendBlock_t* get_send_block(apx_uringServerConnection_t* self)
+{
+   apx_uringSendBlock_t* block;
+   MUTEX_LOCK(self->send_lock);
+   block = self->free_blocks;
+   if (block != NULL)
+   {
+      self->free_blocks = block->next;
+      self->num_free_blocks--;
+   }
+   MUTEX_UNLOCK(self->send_lock);
+   if (block == NULL)
+   {
+      block = (apx_uringSendBlock_t*) malloc(sizeof(apx_uringSendBlock_t) + self->block_size);
+      if (block == NULL)
+      {
+         return NULL;
+      }
+      block->data = (uint8_t*) (block + 1);
+      block->capacity = self->block_size;
+   }
+   block->next = NULL;
+   block->owner = self;
+   block->size = 0u;
+   return block;
+}
+
+/**
+ * Must be called with send_lock held.
+ */
+static void release_send_block(apx_uringServerConnection_t* self, apx_uringSendBlock_t* block)
+{
+   if (self->num_free_blocks < MAX_FREE_BLOCKS)
+   {
+      block->next = self->free_blocks;
+      self->free_blocks = block;
+      self->num_free_blocks++;
+   }
+   else
+   {
+      free(block);
+   }
+}
+
+static void free_send_blocks(apx_uringSendBlock_t* first)
+{
+   while (first != NULL)
+   {
+      apx_uringSendBlock_t* next = first->next;
+      free(first);
+      first = next;
+   }
+}
+
+/**
+ * Moves current block to the send queue. Waits while too much data is already queued or in flight,
+ * which gives the same back-pressure on the worker thread as a blocking socket.
+ */
+static apx_error_t queue_current_block(apx_uringServerConnection_t* self)
+{
+   apx_error_t result = APX_NO_ERROR;
+   apx_uringSendBlock_t* block = self->current_block;
+   self->current_block = NULL;
+   MUTEX_LOCK(self->send_lock);
+   if (self->is_send_failed)
+   {
+      release_send_block(self, block);
+      result = APX_NOT_CONNECTED_ERROR;
+   }
+   else
+   {
+      if (self->queued_last == NULL)
+      {
+         self->queued_first = block;
+      }
+      else
+      {
+         self->queued_last->next = block;
+      }
+      self->queued_last = block;
+      self->buffered_bytes += block->size;
+      start_sends(self);
+      //The event thread must not wait for completions that only it can process
+      while ( (!self->is_send_failed) && (self->buffered_bytes > self->max_buffered_bytes) &&
+         (self->server != NULL) && (!apx_uringServer_is_event_thread(self->server)) )
+      {
+         self->is_writer_waiting = true;
+         MUTEX_UNLOCK(self->send_lock);
+         (void)sem_wait(&self->send_semaphore);
+         MUTEX_LOCK(self->send_lock);
+      }
+      if (self->is_send_failed)
+      {
+         result = APX_NOT_CONNECTED_ERROR;
+      }
+   }
+   MUTEX_UNLOCK(self->send_lock);
+   return result;
+}
+
+/**
+ * Submits queued blocks as one chain of linked sends unless a chain is already in flight.
+ * Must be called with send_lock held.
+ */
+static void start_sends(apx_uringServerConnection_t* self)
+{
+   if ( self->is_send_failed || (self->server == NULL) )
+   {
+      discard_queued_blocks(self);
+   }
+   else if ( (self->in_flight_first == NULL) && (self->queued_first != NULL) )
+   {
+      apx_uringSendBlock_t* last = self->queued_first;
+      uint32_t num_blocks = 1u;
+      while ( (last->next != NULL) && (num_blocks < MAX_LINKED_SENDS) )
+      {
+         last = last->next;
+         num_blocks++;
+      }
+      self->in_flight_first = self->queued_first;
+      self->in_flight_last = last;
+      self->queued_first = last->next;
+      if (self->queued_first == NULL)
+      {
+         self->queued_last = NULL;
+      }
+      last->next = NULL;
+      if (apx_uringServer_submit_sends(self->server, self->fd, self->in_flight_first, num_blocks) != APX_NO_ERROR)
+      {
+         //Nothing was submitted, blocks are still ours
+         apx_uringSendBlock_t* block = self->in_flight_first;
+         self->in_flight_first = NULL;
+         self->in_flight_last = NULL;
+         while (block != NULL)
+         {
+            apx_uringSendBlock_t* next = block->next;
+            self->buffered_bytes -= block->size;
+            release_send_block(self, block);
+            block = next;
+         }
+         fail_send(self);
+      }
+   }
+}
+
+/**
+ * Must be called with send_lock held.
+ */
+static void discard_queued_blocks(apx_uringServerConnection_t* self)
+{
+   apx_uringSendBlock_t* block = self->queued_first;
+   while (block != NULL)
+   {
+      apx_uringSendBlock_t* next = block->next;
+      self->buffered_bytes -= block->size;
+      release_send_block(self, block);
+      block = next;
+   }
+   self->queued_first = NULL;
+   self->queued_last = NULL;
+}
+
+/**
+ * Stops all further sending. Shutting down the socket also ends the pending receive, which reports the disconnect.
+ * Must be called with send_lock held.
+ */
+static void fail_send(apx_uringServerConnection_t* self)
+{
+   self->is_send_failed = true;
+   (void)shutdown(self->fd, SHUT_RDWR);
+   discard_queued_blocks(self);
+   wake_writer(self);
+}
+
+/**
+ * Must be called with send_lock held.
+ */
+static void wake_writer(apx_uringServerConnection_t* self)
+{
+   if ( self->is_writer_waiting && (self->is_send_failed || (self->buffered_bytes <= self->max_buffered_bytes)) )
+   {
+      self->is_writer_waiting = false;
+      SEMAPHORE_POST(self->send_semaphore);
+   }
+}
+
+#endif //APX_URING_SERVER_SUPPORTED
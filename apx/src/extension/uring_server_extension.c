@@ -0,0 +1,230 @@
+/*****************************************************************************
+* \file      uring_server_extension.c
+* \author    Conny Gustafsson
+* \date      2026-10-18
+* \brief     APX io_uring socket server extension (TCP+UNIX)
+*
+* Copyright (c) 2026 Conny Gustafsson
+* Permission is hereby granted, free of charge, to any person obtaining a copy of
+* this software and associated documentation files (the "Software"), to deal in
+* the Software without restriction, including without limitation the rights to
+* use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+* the Software, and to permit persons to whom the Software is furnished to do so,
+* subject to the following conditions:
+
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+* FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+* COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+* IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+* CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+******************************************************************************/
+//////////////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////////////
+#include <stdio.h>
+#include <string.h>
+#include "apx/extension/uring_server_extension.h"
+#include "apx/extension/uring_server.h"
+#include "apx/extension/socket_server_extension.h"
+#include "apx/server.h"
+#ifdef MEM_LEAK_CHECK
+#include "CMemLeak.h"
+#endif
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////////////
+static bool apx_uringServerExtension_is_enabled(dtl_dv_t *config);
+#if APX_URING_SERVER_SUPPORTED
+static apx_error_t apx_uringServerExtension_init(struct apx_server_tag *apx_server, dtl_dv_t *config);
+static void apx_uringServerExtension_shutdown(void);
+static apx_error_t apx_uringServerExtension_read_cfg(dtl_hv_t *hv, apx_uringServerCfg_t *cfg);
+static apx_error_t apx_uringServerExtension_read_u32(dtl_hv_t *hv, const char *key, uint32_t *value);
+static apx_error_t apx_uringServerExtension_start_listeners(apx_uringServer_t *server, dtl_hv_t *hv);
+#endif
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE VARIABLES
+//////////////////////////////////////////////////////////////////////////////
+#if APX_URING_SERVER_SUPPORTED
+static apx_uringServer_t *m_instance = (apx_uringServer_t*) 0; //singleton
+#endif
+
+//////////////////////////////////////////////////////////////////////////////
+// PUBLIC FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+apx_error_t apx_uringServerExtension_register(struct apx_server_tag *apx_server, dtl_dv_t *config)
+{
+   if (!apx_uringServerExtension_is_enabled(config))
+   {
+      return APX_NOT_IMPLEMENTED_ERROR;
+   }
+#if APX_URING_SERVER_SUPPORTED
+   if (apx_uring_probe() == APX_NO_ERROR)
+   {
+      apx_serverExtensionHandler_t handler = {apx_uringServerExtension_init, apx_uringServerExtension_shutdown};
+      return apx_server_add_extension(apx_server, APX_URING_SERVER_LABEL, &handler, config);
+   }
+#else
+   (void)apx_server;
+#endif
+   printf("io_uring is not supported, falling back to socket server\n");
+   return APX_NOT_IMPLEMENTED_ERROR;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+static bool apx_uringServerExtension_is_enabled(dtl_dv_t *config)
+{
+   if ( (config != 0) && (dtl_dv_type(config) == DTL_DV_HASH) )
+   {
+      dtl_sv_t *sv_enabled = (dtl_sv_t*) dtl_hv_get_cstr((dtl_hv_t*) config, "extension-enabled");
+      if (sv_enabled != 0)
+      {
+         bool conversion_ok;
+         bool enabled = dtl_sv_to_bool(sv_enabled, &conversion_ok);
+         return conversion_ok && enabled;
+      }
+   }
+   return false;
+}
+
+#if APX_URING_SERVER_SUPPORTED
+static apx_error_t apx_uringServerExtension_init(struct apx_server_tag *apx_server, dtl_dv_t *config)
+{
+   if (m_instance == 0)
+   {
+      apx_uringServerCfg_t cfg;
+      apx_error_t result;
+      apx_uringServerCfg_set_defaults(&cfg);
+      result = apx_uringServerExtension_read_cfg((dtl_hv_t*) config, &cfg);
+      if (result != APX_NO_ERROR)
+      {
+         return result;
+      }
+      m_instance = apx_uringServer_new(apx_server, &cfg);
+      if (m_instance == 0)
+      {
+         return APX_MEM_ERROR;
+      }
+      result = apx_uringServer_start(m_instance);
+      if (result == APX_NO_ERROR)
+      {
+         result = apx_uringServerExtension_start_listeners(m_instance, (dtl_hv_t*) config);
+      }
+      if (result != APX_NO_ERROR)
+      {
+         apx_uringServerExtension_shutdown();
+         return result;
+      }
+   }
+   return APX_NO_ERROR;
+}
+
+static void apx_uringServerExtension_shutdown(void)
+{
+   if (m_instance != 0)
+   {
+      apx_uringServer_stop(m_instance);
+      apx_uringServer_delete(m_instance);
+      m_instance = (apx_uringServer_t*) 0;
+   }
+}
+
+/**
+ * Example:
+ * "uring-server": {"extension-enabled": true, "tcp-port": 5000, "unix-file": "/tmp/apx_server.socket",
+ *                  "queue-depth": 256, "buffer-count": 256, "buffer-size": 16384, "send-block-size": 4096, "tcp-nodelay": true}
+ */
+static apx_error_t apx_uringServerExtension_read_cfg(dtl_hv_t *hv, apx_uringServerCfg_t *cfg)
+{
+   apx_error_t result;
+   uint32_t send_block_size = (uint32_t) cfg->send_block_size;
+   dtl_sv_t *sv;
+   result = apx_uringServerExtension_read_u32(hv, "queue-depth", &cfg->queue_depth);
+   if (result == APX_NO_ERROR)
+   {
+      result = apx_uringServerExtension_read_u32(hv, "buffer-count", &cfg->buffer_count);
+   }
+   if (result == APX_NO_ERROR)
+   {
+      result = apx_uringServerExtension_read_u32(hv, "buffer-size", &cfg->buffer_size);
+   }
+   if (result == APX_NO_ERROR)
+   {
+      result = apx_uringServerExtension_read_u32(hv, "max-connections", &cfg->max_connections);
+   }
+   if (result == APX_NO_ERROR)
+   {
+      result = apx_uringServerExtension_read_u32(hv, "send-block-size", &send_block_size);
+      cfg->send_block_size = (apx_size_t) send_block_size;
+   }
+   if (result != APX_NO_ERROR)
+   {
+      return result;
+   }
+   sv = (dtl_sv_t*) dtl_hv_get_cstr(hv, "tcp-nodelay");
+   if (sv != 0)
+   {
+      bool conversion_ok;
+      cfg->tcp_nodelay = dtl_sv_to_bool(sv, &conversion_ok);
+      if (!conversion_ok)
+      {
+         return APX_VALUE_TYPE_ERROR;
+      }
+   }
+   return APX_NO_ERROR;
+}
+
+static apx_error_t apx_uringServerExtension_read_u32(dtl_hv_t *hv, const char *key, uint32_t *value)
+{
+   dtl_sv_t *sv = (dtl_sv_t*) dtl_hv_get_cstr(hv, key);
+   if (sv != 0)
+   {
+      bool conversion_ok;
+      uint32_t tmp = dtl_sv_to_u32(sv, &conversion_ok);
+      if (!conversion_ok)
+      {
+         return APX_VALUE_TYPE_ERROR;
+      }
+      *value = tmp;
+   }
+   return APX_NO_ERROR;
+}
+
+static apx_error_t apx_uringServerExtension_start_listeners(apx_uringServer_t *server, dtl_hv_t *hv)
+{
+   dtl_sv_t *sv_tcp_port = (dtl_sv_t*) dtl_hv_get_cstr(hv, "tcp-port");
+   dtl_sv_t *sv_unix_file = (dtl_sv_t*) dtl_hv_get_cstr(hv, "unix-file");
+   bool conversion_ok;
+   if (sv_tcp_port != 0)
+   {
+      uint16_t tcp_port = (uint16_t) dtl_sv_to_u32(sv_tcp_port, &conversion_ok);
+      if (conversion_ok && (tcp_port >= TCP_USER_PORT_BEGIN) && (tcp_port <= TCP_USER_PORT_END) )
+      {
+         apx_error_t result = apx_uringServer_start_tcp_server(server, tcp_port);
+         if (result != APX_NO_ERROR)
+         {
+            return result;
+         }
+      }
+   }
+   if (sv_unix_file != 0)
+   {
+      const char *unix_file_path = dtl_sv_to_cstr(sv_unix_file, &conversion_ok);
+      if (conversion_ok && (strlen(unix_file_path) > 0) )
+      {
+         return apx_uringServer_start_unix_server(server, unix_file_path);
+      }
+   }
+   return APX_NO_ERROR;
+}
+#endif
@@ -0,0 +1,390 @@
+/*****************************************************************************
+* \file      fanout_pool.c
+* \author    Conny Gustafsson
+* \date      2026-10-18
+* \brief     Parallel fan-out worker pool
+*
+* Copyright (c) 2026 Conny Gustafsson
+* Permission is hereby granted, free of charge, to any person obtaining a copy of
+* this software and associated documentation files (the "Software"), to deal in
+* the Software without restriction, including without limitation the rights to
+* use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+* the Software, and to permit persons to whom the Software is furnished to do so,
+* subject to the following conditions:
+
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+* FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+* COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+* IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+* CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+******************************************************************************/
+//////////////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////////////
+#include <assert.h>
+#include <string.h>
+#include <malloc.h>
+#ifdef _WIN32
+#include <process.h>
+#endif
+#include "apx/fanout_pool.h"
+#ifdef MEM_LEAK_CHECK
+#include "CMemLeak.h"
+#endif
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE CONSTANTS AND DATA TYPES
+//////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////////////
+static void slice_range(int32_t num_items, uint32_t num_slices, uint32_t slice_id, int32_t* begin, int32_t* end);
+static bool slice_done(apx_fanoutPool_t* self, apx_error_t result);
+#ifndef UNIT_TEST
+static void wait_semaphore(SEMAPHORE_T* semaphore);
+static THREAD_PROTO(worker_task, arg);
+#endif
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE VARIABLES
+//////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////
+// PUBLIC FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+apx_error_t apx_fanoutPool_create(apx_fanoutPool_t* self, uint32_t num_workers, int32_t threshold)
+{
+   if ( (self != NULL) && (num_workers > 0u) && (num_workers <= APX_FANOUT_POOL_MAX_WORKERS) && (threshold > 1) )
+   {
+      uint32_t i;
+      memset(self, 0, sizeof(apx_fanoutPool_t));
+      self->result = APX_NO_ERROR;
+      self->workers = (apx_fanoutWorker_t*)malloc(num_workers * sizeof(apx_fanoutWorker_t));
+      if (self->workers == NULL)
+      {
+         return APX_MEM_ERROR;
+      }
+      memset(self->workers, 0, num_workers * sizeof(apx_fanoutWorker_t));
+      self->num_workers = num_workers;
+      self->threshold = threshold;
+      for (i = 0u; i < num_workers; i++)
+      {
+         self->workers[i].parent = self;
+         SEMAPHORE_CREATE(self->workers[i].start_semaphore);
+      }
+      SPINLOCK_INIT(self->lock);
+      SEMAPHORE_CREATE(self->done_semaphore);
+      return APX_NO_ERROR;
+   }
+   return APX_INVALID_ARGUMENT_ERROR;
+}
+
+void apx_fanoutPool_destroy(apx_fanoutPool_t* self)
+{
+   if (self != NULL)
+   {
+      uint32_t i;
+#ifndef UNIT_TEST
+      apx_fanoutPool_stop(self);
+#endif
+      for (i = 0u; i < self->num_workers; i++)
+      {
+         SEMAPHORE_DESTROY(self->workers[i].start_semaphore);
+      }
+      free(self->workers);
+      self->workers = NULL;
+      self->num_workers = 0u;
+      SPINLOCK_DESTROY(self->lock);
+      SEMAPHORE_DESTROY(self->done_semaphore);
+   }
+}
+
+apx_fanoutPool_t* apx_fanoutPool_new(uint32_t num_workers, int32_t threshold)
+{
+   apx_fanoutPool_t* self = (apx_fanoutPool_t*)malloc(sizeof(apx_fanoutPool_t));
+   if (self != NULL)
+   {
+      apx_error_t result = apx_fanoutPool_create(self, num_workers, threshold);
+      if (result != APX_NO_ERROR)
+      {
+         free(self);
+         self = NULL;
+      }
+   }
+   return self;
+}
+
+void apx_fanoutPool_delete(apx_fanoutPool_t* self)
+{
+   if (self != NULL)
+   {
+      apx_fanoutPool_destroy(self);
+      free(self);
+   }
+}
+
+int32_t apx_fanoutPool_get_threshold(apx_fanoutPool_t const* self)
+{
+   if (self != NULL)
+   {
+      return self->threshold;
+   }
+   return 0;
+}
+
+uint32_t apx_fanoutPool_num_workers(apx_fanoutPool_t const* self)
+{
+   if (self != NULL)
+   {
+      return self->num_workers;
+   }
+   return 0u;
+}
+
+/**
+ * Calls func for all items in [0, num_items) and returns when all of them are done.
+ * The range is split across the workers when num_items reaches the threshold and no other run is using them.
+ * func must be safe to call concurrently for disjoint ranges. Returns the first error reported by func.
+ */
+apx_error_t apx_fanoutPool_run(apx_fanoutPool_t* self, int32_t num_items, apx_fanoutFunc_t* func, void* arg)
+{
+   bool is_parallel = false;
+   uint32_t num_slices;
+   uint32_t i;
+   int32_t begin;
+   int32_t end;
+   apx_error_t result;
+   if ( (self == NULL) || (func == NULL) || (num_items < 0) )
+   {
+      return APX_INVALID_ARGUMENT_ERROR;
+   }
+   if (num_items >= self->threshold)
+   {
+      SPINLOCK_ENTER(self->lock);
+      if ( (!self->is_busy) && (!self->exit_flag) )
+      {
+         self->is_busy = true;
+         is_parallel = true;
+      }
+      SPINLOCK_LEAVE(self->lock);
+   }
+   if (!is_parallel)
+   {
+      result = func(arg, 0, num_items);
+      SPINLOCK_ENTER(self->lock);
+      self->stats.num_sequential_runs++;
+      SPINLOCK_LEAVE(self->lock);
+      return result;
+   }
+   //Slice 0 is processed by the calling thread, slice i + 1 by worker i
+   num_slices = self->num_workers + 1u;
+   if ((uint32_t)num_items < num_slices)
+   {
+      num_slices = (uint32_t)num_items;
+   }
+   self->func = func;
+   self->arg = arg;
+   self->result = APX_NO_ERROR;
+   self->num_pending = num_slices - 1u;
+   for (i = 1u; i < num_slices; i++)
+   {
+      apx_fanoutWorker_t* worker = &self->workers[i - 1u];
+      slice_range(num_items, num_slices, i, &worker->begin, &worker->end);
+#ifndef UNIT_TEST
+      if (worker->is_thread_valid)
+      {
+         SEMAPHORE_POST(worker->start_semaphore);
+         continue;
+      }
+#endif
+      (void)slice_done(self, func(arg, worker->begin, worker->end));
+   }
+   slice_range(num_items, num_slices, 0u, &begin, &end);
+   result = func(arg, begin, end);
+#ifndef UNIT_TEST
+   for (;;)
+   {
+      uint32_t num_pending;
+      SPINLOCK_ENTER(self->lock);
+      num_pending = self->num_pending;
+      SPINLOCK_LEAVE(self->lock);
+      if (num_pending == 0u)
+      {
+         break;
+      }
+      wait_semaphore(&self->done_semaphore);
+   }
+#endif
+   SPINLOCK_ENTER(self->lock);
+   assert(self->num_pending == 0u);
+   if (result == APX_NO_ERROR)
+   {
+      result = self->result;
+   }
+   self->func = NULL;
+   self->arg = NULL;
+   self->is_busy = false;
+   self->stats.num_parallel_runs++;
+   SPINLOCK_LEAVE(self->lock);
+   return result;
+}
+
+void apx_fanoutPool_get_stats(apx_fanoutPool_t* self, apx_fanoutPoolStats_t* stats)
+{
+   if ( (self != NULL) && (stats != NULL) )
+   {
+      SPINLOCK_ENTER(self->lock);
+      memcpy(stats, &self->stats, sizeof(apx_fanoutPoolStats_t));
+      SPINLOCK_LEAVE(self->lock);
+   }
+}
+
+#ifndef UNIT_TEST
+apx_error_t apx_fanoutPool_start(apx_fanoutPool_t* self)
+{
+   if (self != NULL)
+   {
+      uint32_t i;
+      self->exit_flag = false;
+      for (i = 0u; i < self->num_workers; i++)
+      {
+         apx_fanoutWorker_t* worker = &self->workers[i];
+         if (worker->is_thread_valid == false)
+         {
+            worker->is_thread_valid = true;
+#ifdef _MSC_VER
+            THREAD_CREATE(worker->thread, worker_task, worker, worker->thread_id);
+            if (worker->thread == INVALID_HANDLE_VALUE)
+            {
+               worker->is_thread_valid = false;
+               apx_fanoutPool_stop(self);
+               return APX_THREAD_CREATE_ERROR;
+            }
+#else
+            int rc = THREAD_CREATE(worker->thread, worker_task, worker);
+            if (rc != 0)
+            {
+               worker->is_thread_valid = false;
+               apx_fanoutPool_stop(self);
+               return APX_THREAD_CREATE_ERROR;
+            }
+#endif
+         }
+      }
+      return APX_NO_ERROR;
+   }
+   return APX_INVALID_ARGUMENT_ERROR;
+}
+
+/**
+ * Stops all worker threads. Must not be called while a run is in progress.
+ */
+void apx_fanoutPool_stop(apx_fanoutPool_t* self)
+{
+   if (self != NULL)
+   {
+      uint32_t i;
+      SPINLOCK_ENTER(self->lock);
+      self->exit_flag = true;
+      SPINLOCK_LEAVE(self->lock);
+      for (i = 0u; i < self->num_workers; i++)
+      {
+         apx_fanoutWorker_t* worker = &self->workers[i];
+         if (worker->is_thread_valid)
+         {
+            SEMAPHORE_POST(worker->start_semaphore);
+#ifdef _MSC_VER
+            (void)WaitForSingleObject(worker->thread, 5000);
+            CloseHandle(worker->thread);
+            worker->thread = INVALID_HANDLE_VALUE;
+#else
+            if (pthread_equal(pthread_self(), worker->thread) == 0)
+            {
+               void* status;
+               (void)pthread_join(worker->thread, &status);
+            }
+#endif
+            worker->is_thread_valid = false;
+         }
+      }
+   }
+}
+#endif
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Splits [0, num_items) into num_slices contiguous ranges whose lengths differ by at most one.
+ */
+static void slice_range(int32_t num_items, uint32_t num_slices, uint32_t slice_id, int32_t* begin, int32_t* end)
+{
+   int32_t const base_length = num_items / (int32_t)num_slices;
+   int32_t const remainder = num_items % (int32_t)num_slices;
+   int32_t const id = (int32_t)slice_id;
+   *begin = (id * base_length) + ((id < remainder) ? id : remainder);
+   *end = *begin + base_length + ((id < remainder) ? 1 : 0);
+}
+
+/**
+ * Records the result of one worker slice. Returns true when it was the last pending slice.
+ */
+static bool slice_done(apx_fanoutPool_t* self, apx_error_t result)
+{
+   bool is_last;
+   SPINLOCK_ENTER(self->lock);
+   if ( (result != APX_NO_ERROR) && (self->result == APX_NO_ERROR) )
+   {
+      self->result = result;
+   }
+   self->num_pending--;
+   is_last = (self->num_pending == 0u);
+   SPINLOCK_LEAVE(self->lock);
+   return is_last;
+}
+
+#ifndef UNIT_TEST
+static void wait_semaphore(SEMAPHORE_T* semaphore)
+{
+#ifdef _MSC_VER
+   (void)WaitForSingleObject(*semaphore, INFINITE);
+#else
+   (void)sem_wait(semaphore);
+#endif
+}
+
+static THREAD_PROTO(worker_task, arg)
+{
+   apx_fanoutWorker_t* self = (apx_fanoutWorker_t*)arg;
+   if (self != NULL)
+   {
+      apx_fanoutPool_t* pool = self->parent;
+      for (;;)
+      {
+         bool exit_flag;
+         bool is_last;
+         wait_semaphore(&self->start_semaphore);
+         SPINLOCK_ENTER(pool->lock);
+         exit_flag = pool->exit_flag;
+         SPINLOCK_LEAVE(pool->lock);
+         if (exit_flag)
+         {
+            break;
+         }
+         is_last = slice_done(pool, pool->func(pool->arg, self->begin, self->end));
+         if (is_last)
+         {
+            SEMAPHORE_POST(pool->done_semaphore);
+         }
+      }
+   }
+   THREAD_RETURN(0);
+}
+#endif
@@ -35,6 +35,7 @@
 #include "apx/event_listener.h"
 #include "apx/node_data.h"
 #include "apx/file_manager.h"
+#include "pack.h"
 #ifdef MEM_LEAK_CHECK
 #include "CMemLeak.h"
 #endif
@@ -42,6 +43,10 @@
 //////////////////////////////////////////////////////////////////////////////
 // PRIVATE CONSTANTS AND DATA TYPES
 //////////////////////////////////////////////////////////////////////////////
+//Early data keeps one bit per file byte telling whether the byte has been written
+#define EARLY_DATA_MASK_SIZE(file_size) (((size_t)(file_size) + 7u) / 8u)
+#define SET_EARLY_DATA_WRITTEN(mask, offset) ((mask)[(offset) >> 3] |= (uint8_t)(1u << ((offset) & 7u)))
+#define IS_EARLY_DATA_WRITTEN(mask, offset) (((mask)[(offset) >> 3] & (1u << ((offset) & 7u))) != 0u)
 
 //////////////////////////////////////////////////////////////////////////////
 // PRIVATE FUNCTION PROTOTYPES
@@ -50,6 +55,7 @@
 static void apx_file_calc_file_type(apx_file_t *self);
 static void apx_file_lock(apx_file_t *self);
 static void apx_file_unlock(apx_file_t *self);
+static apx_error_t apx_file_stream_write_notify(apx_file_t* self, uint32_t offset, const uint8_t* src, uint32_t len);
 //////////////////////////////////////////////////////////////////////////////
 // PUBLIC VARIABLES
 //////////////////////////////////////////////////////////////////////////////
@@ -72,6 +78,11 @@ apx_error_t apx_file_create(apx_file_t* self, const rmf_fileInfo_t* file_info)
       self->file_manager = (apx_fileManager_t*) NULL;
       self->apx_file_type = APX_UNKNOWN_FILE_TYPE;
       memset(&self->notification_handler, 0, sizeof(apx_fileNotificationHandler_t));
+      self->stream_retention = APX_STREAM_DEFAULT_RETENTION;
+      self->stream_buffer = (apx_streamBuffer_t*) NULL;
+      self->next_stream_sequence = 0u;
+      self->num_lost_stream_records = 0u;
+      self->early_data = (uint8_t*) NULL;
       adt_list_create(&self->event_listeners, apx_fileEventListener_vdelete);
       retval = rmf_fileInfo_create_copy(&self->file_info, file_info);
       if (retval == APX_NO_ERROR)
@@ -90,6 +101,11 @@ void apx_file_destroy(apx_file_t *self)
    {
       rmf_fileInfo_destroy(&self->file_info);
       adt_list_destroy(&self->event_listeners);
+      apx_streamBuffer_delete(self->stream_buffer);
+      if (self->early_data != NULL)
+      {
+         free(self->early_data);
+      }
       MUTEX_DESTROY(self->lock);
    }
 }
@@ -360,6 +376,192 @@ rmf_digestType_t apx_file_get_digest_type(apx_file_t const* self)
    return RMF_DIGEST_TYPE_NONE;
 }
 
+rmf_fileType_t apx_file_get_rmf_file_type(apx_file_t const* self)
+{
+   if (self != NULL)
+   {
+      return rmf_fileInfo_rmf_file_type(&self->file_info);
+   }
+   return RMF_FILE_TYPE_FIXED;
+}
+
+void apx_file_set_rmf_file_type(apx_file_t* self, rmf_fileType_t file_type)
+{
+   if (self != NULL)
+   {
+      rmf_fileInfo_set_rmf_file_type(&self->file_info, file_type);
+   }
+}
+
+/**
+ * Returns true for files where writes to dynamic array ports only carry the elements in use (RMF_FILE_TYPE_DYNAMIC8/16/32)
+ */
+bool apx_file_is_dynamic(apx_file_t const* self)
+{
+   rmf_fileType_t const file_type = apx_file_get_rmf_file_type(self);
+   return ( (file_type == RMF_FILE_TYPE_DYNAMIC8) || (file_type == RMF_FILE_TYPE_DYNAMIC16) || (file_type == RMF_FILE_TYPE_DYNAMIC32) );
+}
+
+bool apx_file_is_stream(apx_file_t const* self)
+{
+   return apx_file_get_rmf_file_type(self) == RMF_FILE_TYPE_STREAM;
+}
+
+/**
+ * Sets the number of records a local stream file keeps for a reader that opens the file after they were written.
+ * Must be called before the first record is written.
+ */
+void apx_file_set_stream_retention(apx_file_t* self, uint32_t retention)
+{
+   if ( (self != NULL) && (retention > 0u) )
+   {
+      self->stream_retention = retention;
+   }
+}
+
+uint32_t apx_file_get_stream_retention(apx_file_t const* self)
+{
+   if (self != NULL)
+   {
+      return self->stream_retention;
+   }
+   return 0u;
+}
+
+/**
+ * Returns the retention buffer of a local stream file, the buffer is created on first call.
+ * Only the file manager worker may call this function.
+ */
+apx_streamBuffer_t* apx_file_get_stream_buffer(apx_file_t* self)
+{
+   if ( (self != NULL) && apx_file_is_stream(self) )
+   {
+      if (self->stream_buffer == NULL)
+      {
+         self->stream_buffer = apx_streamBuffer_new(self->stream_retention);
+      }
+      return self->stream_buffer;
+   }
+   return NULL;
+}
+
+uint32_t apx_file_get_num_lost_stream_records(apx_file_t* self)
+{
+   uint32_t retval = 0u;
+   if (self != NULL)
+   {
+      apx_file_lock(self);
+      retval = self->num_lost_stream_records;
+      apx_file_unlock(self);
+   }
+   return retval;
+}
+
+/**
+ * Keeps data written to a fixed remote file before it was opened.
+ * Written bytes are tracked so that only those are delivered later, leaving the rest of the file untouched.
+ */
+apx_error_t apx_file_buffer_early_write(apx_file_t* self, uint32_t offset, const uint8_t* src, uint32_t len)
+{
+   if ( (self != NULL) && (src != NULL) && (len > 0u) )
+   {
+      apx_error_t retval = APX_NO_ERROR;
+      uint32_t const file_size = rmf_fileInfo_size(&self->file_info);
+      if ( (apx_file_get_rmf_file_type(self) != RMF_FILE_TYPE_FIXED) || (offset > file_size) || (len > (file_size - offset)) )
+      {
+         return APX_INVALID_WRITE_ERROR;
+      }
+      apx_file_lock(self);
+      if (self->early_data == NULL)
+      {
+         size_t const alloc_size = (size_t)file_size + EARLY_DATA_MASK_SIZE(file_size);
+         self->early_data = (uint8_t*)malloc(alloc_size);
+         if (self->early_data == NULL)
+         {
+            retval = APX_MEM_ERROR;
+         }
+         else
+         {
+            memset(self->early_data, 0, alloc_size);
+         }
+      }
+      if (retval == APX_NO_ERROR)
+      {
+         uint8_t* mask = self->early_data + file_size;
+         uint32_t const end = offset + len;
+         uint32_t i;
+         memcpy(&self->early_data[offset], src, len);
+         for (i = offset; i < end; i++)
+         {
+            SET_EARLY_DATA_WRITTEN(mask, i);
+         }
+      }
+      apx_file_unlock(self);
+      return retval;
+   }
+   return APX_INVALID_ARGUMENT_ERROR;
+}
+
+bool apx_file_has_early_data(apx_file_t* self)
+{
+   bool retval = false;
+   if (self != NULL)
+   {
+      apx_file_lock(self);
+      retval = (self->early_data != NULL);
+      apx_file_unlock(self);
+   }
+   return retval;
+}
+
+/**
+ * Returns buffered early data and clears it. Caller frees the returned buffer.
+ * Data is placed at its file offset, use apx_file_next_early_data_range to find the parts that were written.
+ */
+uint8_t* apx_file_take_early_data(apx_file_t* self)
+{
+   uint8_t* retval = (uint8_t*) NULL;
+   if (self != NULL)
+   {
+      apx_file_lock(self);
+      retval = self->early_data;
+      self->early_data = (uint8_t*) NULL;
+      apx_file_unlock(self);
+   }
+   return retval;
+}
+
+/**
+ * Finds next range of early_data (from apx_file_take_early_data) that was written, starting the search at *offset.
+ * On return *offset holds the start of the range. Returns length of the range, or 0 when there are no more ranges.
+ */
+uint32_t apx_file_next_early_data_range(apx_file_t const* self, uint8_t const* early_data, uint32_t* offset)
+{
+   if ( (self != NULL) && (early_data != NULL) && (offset != NULL) )
+   {
+      uint32_t const file_size = rmf_fileInfo_size(&self->file_info);
+      uint8_t const* mask = early_data + file_size;
+      uint32_t begin = *offset;
+      uint32_t end;
+      while ( (begin < file_size) && (!IS_EARLY_DATA_WRITTEN(mask, begin)) )
+      {
+         begin++;
+      }
+      if (begin >= file_size)
+      {
+         return 0u;
+      }
+      end = begin + 1u;
+      while ( (end < file_size) && IS_EARLY_DATA_WRITTEN(mask, end) )
+      {
+         end++;
+      }
+      *offset = begin;
+      return end - begin;
+   }
+   return 0u;
+}
+
 uint8_t const* apx_file_get_digest_data(const apx_file_t* self)
 {
    if (self != NULL)
@@ -395,6 +597,10 @@ apx_error_t apx_file_write_notify(apx_file_t* self, uint32_t offset, const uint8
 {
    if (self != 0)
    {
+      if (apx_file_is_stream(self))
+      {
+         return apx_file_stream_write_notify(self, offset, src, len);
+      }
       apx_file_lock(self);
       if (!self->has_first_write)
       {
@@ -410,6 +616,19 @@ apx_error_t apx_file_write_notify(apx_file_t* self, uint32_t offset, const uint8
    return APX_INVALID_ARGUMENT_ERROR;
 }
 
+apx_error_t apx_file_local_write_notify(apx_file_t* self, uint32_t offset, const uint8_t* src, uint32_t len)
+{
+   if (self != 0)
+   {
+      if (self->notification_handler.local_write_notify != 0)
+      {
+         return self->notification_handler.local_write_notify(self->notification_handler.arg, self, offset, src, len);
+      }
+      return APX_INVALID_WRITE_HANDLER_ERROR;
+   }
+   return APX_INVALID_ARGUMENT_ERROR;
+}
+
 //global functions
 char const* apx_file_type_to_extension(apx_fileType_t file_type)
 {
@@ -446,7 +665,8 @@ bool apx_file_less_than(const apx_file_t* a, const apx_file_t* b)
 
 static void apx_file_calc_file_type(apx_file_t *self)
 {
-   if (rmf_fileInfo_name_ends_with(&self->file_info, APX_DEFINITION_FILE_EXT))
+   if (rmf_fileInfo_name_ends_with(&self->file_info, APX_DEFINITION_FILE_EXT) ||
+      rmf_fileInfo_name_ends_with(&self->file_info, APX_BINARY_DEFINITION_FILE_EXT))
    {
       self->apx_file_type = APX_DEFINITION_FILE_TYPE;
    }
@@ -488,3 +708,40 @@ static void apx_file_unlock(apx_file_t *self)
    }
 }
 
+/**
+ * Each write to a stream file carries one record starting with its sequence number.
+ * Records older than the expected sequence number (duplicates) are ignored. Gaps in the sequence mean the writer
+ * evicted records before they could be sent, these are counted as lost.
+ */
+static apx_error_t apx_file_stream_write_notify(apx_file_t* self, uint32_t offset, const uint8_t* src, uint32_t len)
+{
+   uint32_t sequence;
+   if ( (offset != 0u) || (src == NULL) || (len < RMF_STREAM_SEQUENCE_SIZE) )
+   {
+      return APX_INVALID_WRITE_ERROR;
+   }
+   sequence = (uint32_t)unpackLE(src, (uint8_t)RMF_STREAM_SEQUENCE_SIZE);
+   apx_file_lock(self);
+   if (!self->has_first_write)
+   {
+      self->has_first_write = true;
+   }
+   else
+   {
+      int32_t const distance = (int32_t)(sequence - self->next_stream_sequence);
+      if (distance < 0)
+      {
+         apx_file_unlock(self);
+         return APX_NO_ERROR;
+      }
+      self->num_lost_stream_records += (uint32_t)distance;
+   }
+   self->next_stream_sequence = sequence + 1u;
+   apx_file_unlock(self);
+   if (self->notification_handler.write_notify != 0)
+   {
+      return self->notification_handler.write_notify(self->notification_handler.arg, self, sequence, src + RMF_STREAM_SEQUENCE_SIZE, len - RMF_STREAM_SEQUENCE_SIZE);
+   }
+   return APX_INVALID_WRITE_HANDLER_ERROR;
+}
+
@@ -253,6 +253,14 @@ void rmf_fileInfo_set_address(rmf_fileInfo_t *self, uint32_t address)
    }
 }
 
+void rmf_fileInfo_set_rmf_file_type(rmf_fileInfo_t* self, rmf_fileType_t file_type)
+{
+   if (self != NULL)
+   {
+      self->rmf_file_type = file_type;
+   }
+}
+
 bool rmf_fileInfo_is_remote_address(rmf_fileInfo_t const* self)
 {
    if (self != 0)
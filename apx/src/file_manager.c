@@ -27,6 +27,7 @@
 // INCLUDES
 //////////////////////////////////////////////////////////////////////////////
 #include <string.h>
+#include <malloc.h>
 #include <assert.h>
 #include <stdio.h> //DEBUG only
 #include "apx/connection_base.h"
@@ -45,12 +46,21 @@
 // PRIVATE FUNCTION PROTOTYPES
 //////////////////////////////////////////////////////////////////////////////
 static void publish_local_files(apx_fileManager_t* self);
+static apx_error_t write_message(apx_fileManager_t* self, uint32_t address, uint8_t const* data, apx_size_t size, bool more_bit);
 static apx_error_t process_message(apx_fileManager_t* self, uint32_t address, uint8_t const* data, apx_size_t size);
 static apx_error_t process_command_message(apx_fileManager_t* self, uint8_t const* data, apx_size_t size);
+static apx_error_t process_compressed_message(apx_fileManager_t* self, uint8_t const* data, apx_size_t size);
+static apx_size_t max_uncompressed_size(apx_fileManager_t* self, uint32_t address, apx_size_t compressed_size);
 static apx_error_t process_file_write_message(apx_fileManager_t* self, uint32_t address, uint8_t const* data, apx_size_t size);
 static apx_error_t process_open_file_request(apx_fileManager_t* self, uint32_t start_address);
 static apx_error_t process_close_file_request(apx_fileManager_t* self, uint32_t start_address);
 static apx_error_t process_remote_file_published(apx_fileManager_t* self, rmf_fileInfo_t const* file_info);
+static apx_error_t verify_local_file_is_open(apx_fileManager_t* self, uint32_t address);
+static bool is_pipelined_file(apx_fileManager_t* self, apx_file_t* file);
+static bool is_streamed_fragment(apx_fileManager_t* self, uint32_t address, bool more_bit);
+static apx_error_t open_pipelined_local_file(apx_fileManager_t* self, uint32_t address, apx_fileType_t file_type);
+static apx_error_t deliver_early_data(apx_fileManager_t* self, apx_file_t* file);
+static apx_error_t apply_capabilities_to_local_file(apx_fileManager_t* self, apx_file_t* file);
 
 //////////////////////////////////////////////////////////////////////////////
 // PRIVATE VARIABLES
@@ -167,11 +177,28 @@ apx_error_t apx_fileManager_publish_local_file(apx_fileManager_t* self, rmf_file
    if ((self != NULL) && (file_info != NULL))
    {
       apx_error_t retval = APX_MEM_ERROR;
-      rmf_fileInfo_t* cloned_info = rmf_fileInfo_clone(file_info);
+      uint32_t const address = rmf_fileInfo_address(file_info);
+      rmf_fileInfo_t* cloned_info;
+      apx_file_t* file = apx_fileManagerShared_find_file_by_address(&self->shared, address);
+      if (file != NULL)
+      {
+         retval = apply_capabilities_to_local_file(self, file);
+         if (retval != APX_NO_ERROR)
+         {
+            return retval;
+         }
+         file_info = apx_file_get_file_info(file);
+      }
+      cloned_info = rmf_fileInfo_clone(file_info);
+      retval = APX_MEM_ERROR;
       if (cloned_info != NULL)
       {
          retval = apx_fileManagerWorker_prepare_publish_local_file(&self->worker, cloned_info);
       }
+      if ( (retval == APX_NO_ERROR) && (file != NULL) )
+      {
+         retval = open_pipelined_local_file(self, address, apx_file_get_apx_file_type(file));
+      }
       return retval;
    }
    return APX_INVALID_ARGUMENT_ERROR;
@@ -213,28 +240,10 @@ apx_error_t apx_fileManager_message_received(apx_fileManager_t* self, uint8_t co
       apx_size_t const header_size = rmf_address_decode(msg_data, msg_data + msg_len, &address, &more_bit);
       if (header_size > 0)
       {
-         apx_error_t error_code;
-         apx_fileManagerReceptionResult_t result;
          assert(msg_len >= header_size);
-         error_code = apx_fileManagerReceiver_write(&self->receiver, &result, address, msg_data + header_size, msg_len - header_size, more_bit);
-         if (error_code != APX_NO_ERROR)
-         {
-            return error_code;
-         }
-         else if (result.is_complete)
-         {
-            return process_message(self, result.address, result.data, result.size);
-         }
-         else
-         {
-            //Wait for more data to arrive
-         }
+         return write_message(self, address, msg_data + header_size, msg_len - header_size, more_bit);
       }
-      else
-      {
-         return APX_INVALID_MSG_ERROR;
-      }
-      return APX_NO_ERROR;
+      return APX_INVALID_MSG_ERROR;
    }
    return APX_INVALID_ARGUMENT_ERROR;
 }
@@ -275,10 +284,154 @@ apx_error_t apx_fileManager_send_local_data(apx_fileManager_t* self, uint32_t ad
    return APX_INVALID_ARGUMENT_ERROR;
 }
 
+/**
+ * Same as apx_fileManager_send_local_data but the file owner is first notified (local_write_notify) from the worker thread.
+ * This lets the owner of the file apply the data on the thread of this connection instead of the calling thread.
+ */
+apx_error_t apx_fileManager_apply_local_data(apx_fileManager_t* self, uint32_t address, uint8_t* data, apx_size_t size)
+{
+   if (self != NULL && data != NULL)
+   {
+      apx_file_t* file = apx_fileManagerShared_find_file_by_address(&self->shared, address);
+      if (file == NULL)
+      {
+         return APX_FILE_NOT_FOUND_ERROR;
+      }
+      if (!apx_file_is_open(file))
+      {
+         return APX_FILE_NOT_OPEN_ERROR;
+      }
+      return apx_fileManagerWorker_prepare_apply_local_data(&self->worker, address, data, (uint32_t)size);
+   }
+   return APX_INVALID_ARGUMENT_ERROR;
+}
+
+/**
+ * Same as apx_fileManager_send_local_data but sent ahead of any bulk data queued for this connection.
+ */
+apx_error_t apx_fileManager_send_priority_data(apx_fileManager_t* self, uint32_t address, uint8_t* data, apx_size_t size)
+{
+   if (self != NULL && data != NULL)
+   {
+      apx_error_t retval = verify_local_file_is_open(self, address);
+      if (retval != APX_NO_ERROR)
+      {
+         return retval;
+      }
+      return apx_fileManagerWorker_prepare_send_priority_data(&self->worker, address, data, (uint32_t)size);
+   }
+   return APX_INVALID_ARGUMENT_ERROR;
+}
+
+/**
+ * Same as apx_fileManager_apply_local_data but sent ahead of any bulk data queued for this connection.
+ */
+apx_error_t apx_fileManager_apply_priority_data(apx_fileManager_t* self, uint32_t address, uint8_t* data, apx_size_t size)
+{
+   if (self != NULL && data != NULL)
+   {
+      apx_error_t retval = verify_local_file_is_open(self, address);
+      if (retval != APX_NO_ERROR)
+      {
+         return retval;
+      }
+      return apx_fileManagerWorker_prepare_apply_priority_data(&self->worker, address, data, (uint32_t)size);
+   }
+   return APX_INVALID_ARGUMENT_ERROR;
+}
+
+/**
+ * Sends a copy of the entire file content. Priority data for the same file can't overtake it.
+ */
+apx_error_t apx_fileManager_send_local_snapshot(apx_fileManager_t* self, uint32_t address, uint8_t* data, apx_size_t size)
+{
+   if (self != NULL && data != NULL)
+   {
+      apx_error_t retval = verify_local_file_is_open(self, address);
+      if (retval != APX_NO_ERROR)
+      {
+         return retval;
+      }
+      return apx_fileManagerWorker_prepare_send_local_snapshot(&self->worker, address, data, (uint32_t)size);
+   }
+   return APX_INVALID_ARGUMENT_ERROR;
+}
+
+/**
+ * Lets the worker thread apply and send the elements waiting in a queued port ring. The elements are written
+ * to address in batches using the queued data encoding.
+ */
+apx_error_t apx_fileManager_drain_queued_data(apx_fileManager_t* self, uint32_t address, apx_queuedPortRing_t* ring)
+{
+   if (self != NULL && ring != NULL)
+   {
+      apx_error_t retval = verify_local_file_is_open(self, address);
+      if (retval != APX_NO_ERROR)
+      {
+         return retval;
+      }
+      return apx_fileManagerWorker_prepare_drain_queued_data(&self->worker, address, ring);
+   }
+   return APX_INVALID_ARGUMENT_ERROR;
+}
+
+/**
+ * Appends one record to a local stream file. Records are sent in the order they were written, records written
+ * before the remote side opens the file are kept up to the retention limit of the file.
+ * The record data is copied, the file doesn't need to be open.
+ */
+apx_error_t apx_fileManager_write_stream(apx_fileManager_t* self, uint32_t address, uint8_t const* data, apx_size_t size)
+{
+   if ( (self != NULL) && ( (data != NULL) || (size == 0u) ) )
+   {
+      uint8_t* record;
+      apx_error_t retval;
+      apx_file_t* file = apx_fileManagerShared_find_file_by_address(&self->shared, address);
+      if (file == NULL)
+      {
+         return APX_FILE_NOT_FOUND_ERROR;
+      }
+      if (!apx_file_is_stream(file))
+      {
+         return APX_INVALID_FILE_ERROR;
+      }
+      if ( (size + RMF_STREAM_SEQUENCE_SIZE) > apx_file_get_size(file) )
+      {
+         return APX_VALUE_LENGTH_ERROR;
+      }
+      record = (uint8_t*)malloc(size + RMF_STREAM_SEQUENCE_SIZE);
+      if (record == NULL)
+      {
+         return APX_MEM_ERROR;
+      }
+      memset(record, 0, RMF_STREAM_SEQUENCE_SIZE);
+      if (size > 0u)
+      {
+         memcpy(record + RMF_STREAM_SEQUENCE_SIZE, data, size);
+      }
+      retval = apx_fileManagerWorker_prepare_send_stream_record(&self->worker, address, record, (uint32_t)(size + RMF_STREAM_SEQUENCE_SIZE));
+      if (retval != APX_NO_ERROR)
+      {
+         free(record);
+      }
+      return retval;
+   }
+   return APX_INVALID_ARGUMENT_ERROR;
+}
+
+/**
+ * Files the client sends without waiting (see is_pipelined_file) are not requested.
+ * Data that already arrived for the file is delivered instead.
+ */
 apx_error_t apx_fileManager_send_open_file_request(apx_fileManager_t* self, uint32_t address)
 {
    if (self != NULL)
    {
+      apx_file_t* file = apx_fileManagerShared_find_file_by_address(&self->shared, address | RMF_REMOTE_ADDRESS_BIT);
+      if ( (file != NULL) && is_pipelined_file(self, file) )
+      {
+         return deliver_early_data(self, file);
+      }
       return apx_fileManagerWorker_prepare_send_open_file_request(&self->worker, address);
    }
    return APX_INVALID_ARGUMENT_ERROR;
@@ -304,6 +457,14 @@ uint16_t apx_fileManager_get_num_pending_worker_commands(apx_fileManager_t* self
    return 0u;
 }
 
+void apx_fileManager_get_transmit_latency(apx_fileManager_t* self, apx_transmitLane_t lane, apx_latencyHistogram_t* histogram)
+{
+   if (self != NULL)
+   {
+      apx_fileManagerWorker_get_latency(&self->worker, lane, histogram);
+   }
+}
+
 void apx_fileManager_set_connection_id(apx_fileManager_t* self, uint32_t connection_id)
 {
    if (self != NULL)
@@ -312,6 +473,58 @@ void apx_fileManager_set_connection_id(apx_fileManager_t* self, uint32_t connect
    }
 }
 
+/**
+ * Called by the connection when compression has been agreed in the greeting.
+ * Outgoing messages of at least threshold bytes are then sent compressed. 0 disables compression.
+ */
+void apx_fileManager_set_compression_threshold(apx_fileManager_t* self, uint32_t threshold)
+{
+   if (self != NULL)
+   {
+      apx_fileManagerShared_set_compression_threshold(&self->shared, threshold);
+   }
+}
+
+uint32_t apx_fileManager_get_compression_threshold(apx_fileManager_t* self)
+{
+   if (self != NULL)
+   {
+      return apx_fileManagerShared_get_compression_threshold(&self->shared);
+   }
+   return 0u;
+}
+
+void apx_fileManager_get_compression_stats(apx_fileManager_t* self, apx_compressionStats_t* stats)
+{
+   if (self != NULL)
+   {
+      apx_fileManagerShared_get_compression_stats(&self->shared, stats);
+   }
+}
+
+/**
+ * Called by the connection once the greeting has been processed. Must happen before the acknowledge is sent
+ * since the server replies with the agreed set.
+ */
+void apx_fileManager_set_capabilities(apx_fileManager_t* self, apx_capabilities_t const* local, apx_capabilities_t const* peer)
+{
+   if (self != NULL)
+   {
+      apx_fileManagerShared_set_capabilities(&self->shared, local, peer);
+   }
+}
+
+/**
+ * Capabilities agreed with the peer of this connection.
+ */
+void apx_fileManager_get_capabilities(apx_fileManager_t* self, apx_capabilities_t* capabilities)
+{
+   if (self != NULL)
+   {
+      apx_fileManagerShared_get_capabilities(&self->shared, capabilities);
+   }
+}
+
 #ifdef UNIT_TEST
 bool apx_fileManager_run(apx_fileManager_t* self)
 {
@@ -335,11 +548,34 @@ static void publish_local_files(apx_fileManager_t* self)
    adt_ary_t local_file_list;
    int32_t i;
    int32_t num_files;
+   uint32_t* addresses;
    adt_ary_create(&local_file_list, NULL);
    num_files = apx_fileManagerShared_copy_local_file_info(&self->shared, &local_file_list);
+   addresses = (num_files > 0) ? (uint32_t*)malloc(sizeof(uint32_t) * (size_t)num_files) : NULL;
    for (i=0; i < num_files; i++)
    {
       rmf_fileInfo_t* file_info = (rmf_fileInfo_t*) adt_ary_value(&local_file_list, i);
+      if (addresses != NULL)
+      {
+         addresses[i] = (file_info != NULL) ? rmf_fileInfo_address(file_info) : RMF_INVALID_ADDRESS;
+      }
+      if (file_info != NULL)
+      {
+         apx_file_t* file = apx_fileManagerShared_find_file_by_address(&self->shared, rmf_fileInfo_address(file_info));
+         if (file != NULL)
+         {
+            if (apply_capabilities_to_local_file(self, file) != APX_NO_ERROR)
+            {
+               rmf_fileInfo_delete(file_info);
+               if (addresses != NULL)
+               {
+                  addresses[i] = RMF_INVALID_ADDRESS;
+               }
+               continue;
+            }
+            rmf_fileInfo_set_rmf_file_type(file_info, apx_file_get_rmf_file_type(file));
+         }
+      }
       if (file_info != NULL)
       {
          //Worker takes memory ownership of file_info
@@ -350,9 +586,46 @@ static void publish_local_files(apx_fileManager_t* self)
          }
       }
    }
+   if (addresses != NULL)
+   {
+      //Definitions go first so the server can parse them before provide port data arrives
+      for (i = 0; i < num_files; i++)
+      {
+         (void)open_pipelined_local_file(self, addresses[i], APX_DEFINITION_FILE_TYPE);
+      }
+      for (i = 0; i < num_files; i++)
+      {
+         (void)open_pipelined_local_file(self, addresses[i], APX_PROVIDE_PORT_DATA_FILE_TYPE);
+      }
+      free(addresses);
+   }
    adt_ary_destroy(&local_file_list);
 }
 
+static apx_error_t write_message(apx_fileManager_t* self, uint32_t address, uint8_t const* data, apx_size_t size, bool more_bit)
+{
+   apx_fileManagerReceptionResult_t result;
+   if (is_streamed_fragment(self, address, more_bit))
+   {
+      //Written to the file at its own address, no reassembly needed
+      return process_message(self, address, data, size);
+   }
+   apx_error_t const error_code = apx_fileManagerReceiver_write(&self->receiver, &result, address, data, size, more_bit);
+   if (error_code != APX_NO_ERROR)
+   {
+      return error_code;
+   }
+   else if (result.is_complete)
+   {
+      return process_message(self, result.address, result.data, result.size);
+   }
+   else
+   {
+      //Wait for more data to arrive
+   }
+   return APX_NO_ERROR;
+}
+
 static apx_error_t process_message(apx_fileManager_t* self, uint32_t address, uint8_t const* data, apx_size_t size)
 {
    if (address == RMF_CMD_AREA_START_ADDRESS)
@@ -424,12 +697,96 @@ static apx_error_t process_command_message(apx_fileManager_t* self, uint8_t cons
          retval = APX_INVALID_MSG_ERROR;
       }
       break;
+   case RMF_CMD_COMPRESSED_MSG:
+      retval = process_compressed_message(self, data, size);
+      break;
    default:
       retval = APX_UNSUPPORTED_ERROR;
    }
    return retval;
 }
 
+/**
+ * Restores the original message and passes it through the receiver so that compressed fragments are reassembled as usual.
+ */
+static apx_error_t process_compressed_message(apx_fileManager_t* self, uint8_t const* data, apx_size_t size)
+{
+   uint32_t address = RMF_INVALID_ADDRESS;
+   bool more_bit = false;
+   uint32_t uncompressed_size = 0u;
+   apx_size_t const header_size = rmf_decode_compressed_msg_header(data, data + size, &address, &more_bit, &uncompressed_size);
+   apx_compressionStats_t stats;
+   apx_error_t retval;
+   uint8_t* buffer;
+   if ( (header_size == 0u) || (uncompressed_size == 0u) ||
+        (uncompressed_size > max_uncompressed_size(self, address, size - header_size)) )
+   {
+      return APX_INVALID_MSG_ERROR;
+   }
+   buffer = (uint8_t*)malloc(uncompressed_size);
+   if (buffer == NULL)
+   {
+      return APX_MEM_ERROR;
+   }
+   apx_compressionStats_create(&stats);
+   retval = apx_compression_decompress(buffer, uncompressed_size, data + header_size, size - header_size, &stats);
+   if (retval == APX_NO_ERROR)
+   {
+      apx_fileManagerShared_add_compression_stats(&self->shared, &stats);
+      retval = write_message(self, address, buffer, uncompressed_size, more_bit);
+   }
+   free(buffer);
+   return retval;
+}
+
+/**
+ * The uncompressed size is announced by the peer. Before allocating, it is limited by what the block can decode to,
+ * the agreed message size limit and what the target can hold.
+ */
+static apx_size_t max_uncompressed_size(apx_fileManager_t* self, uint32_t address, apx_size_t compressed_size)
+{
+   apx_capabilities_t capabilities;
+   apx_size_t retval = APX_MAX_FILE_SIZE;
+   if (compressed_size < (apx_size_t)(APX_MAX_FILE_SIZE / APX_COMPRESSION_MAX_RATIO))
+   {
+      retval = compressed_size * APX_COMPRESSION_MAX_RATIO;
+   }
+   apx_fileManagerShared_get_capabilities(&self->shared, &capabilities);
+   if ( (capabilities.max_message_size > RMF_HIGH_ADDR_SIZE) && ((capabilities.max_message_size - RMF_HIGH_ADDR_SIZE) < retval) )
+   {
+      retval = (apx_size_t)(capabilities.max_message_size - RMF_HIGH_ADDR_SIZE);
+   }
+   if (address == RMF_CMD_AREA_START_ADDRESS)
+   {
+      if (RMF_CMD_AREA_SIZE < retval)
+      {
+         retval = RMF_CMD_AREA_SIZE;
+      }
+   }
+   else if (address < RMF_CMD_AREA_START_ADDRESS)
+   {
+      apx_file_t* file = apx_fileManagerShared_find_file_by_address(&self->shared, address | RMF_HIGH_ADDR_BIT);
+      if (file == NULL)
+      {
+         return 0u;
+      }
+      //Stream records are not placed inside the file range
+      if (!apx_file_is_stream(file))
+      {
+         uint32_t const end_address = apx_file_get_end_address_without_flags(file);
+         if ( (end_address - address) < retval )
+         {
+            retval = (apx_size_t)(end_address - address);
+         }
+      }
+   }
+   else
+   {
+      return 0u;
+   }
+   return retval;
+}
+
 static apx_error_t process_file_write_message(apx_fileManager_t* self, uint32_t address, uint8_t const* data, apx_size_t size)
 {
    apx_file_t *file = apx_fileManagerShared_find_file_by_address(&self->shared, address | RMF_HIGH_ADDR_BIT);
@@ -437,8 +794,16 @@ static apx_error_t process_file_write_message(apx_fileManager_t* self, uint32_t
    {
       return APX_INVALID_WRITE_ERROR;
    }
+   uint32_t const start_address = apx_file_get_address_without_flags(file);
+   assert(start_address <= address);
+   uint32_t const offset = address - start_address;
    if (!apx_file_is_open(file))
    {
+      if ( (apx_file_get_apx_file_type(file) == APX_PROVIDE_PORT_DATA_FILE_TYPE) && is_pipelined_file(self, file) )
+      {
+         //Client sent provide port data before the node was built, keep it until the file is opened
+         return apx_file_buffer_early_write(file, offset, data, (uint32_t)size);
+      }
       //Ignore writes on closed files
       return APX_NO_ERROR;
    }
@@ -447,9 +812,6 @@ static apx_error_t process_file_write_message(apx_fileManager_t* self, uint32_t
    {
       return APX_NULL_PTR_ERROR;
    }
-   uint32_t const start_address = apx_file_get_address_without_flags(file);
-   assert(start_address <= address);
-   uint32_t const offset = address - start_address;
    return connection->remote_file_write_notification(connection->arg, file, offset, data, size);
 }
 
@@ -462,6 +824,10 @@ static apx_error_t process_open_file_request(apx_fileManager_t* self, uint32_t s
    }
    apx_file_open(file);
    apx_file_open_notify(file);
+   if (apx_file_is_stream(file))
+   {
+      return apx_fileManagerWorker_prepare_open_stream(&self->worker, start_address);
+   }
    return APX_NO_ERROR;
 }
 
@@ -474,7 +840,17 @@ static apx_error_t process_close_file_request(apx_fileManager_t* self, uint32_t
 
 static apx_error_t process_remote_file_published(apx_fileManager_t* self, rmf_fileInfo_t const* file_info)
 {
-   apx_file_t* file = apx_fileManagerShared_create_remote_file(&self->shared, file_info);
+   apx_file_t* file;
+   if (rmf_fileInfo_rmf_file_type(file_info) == RMF_FILE_TYPE_STREAM)
+   {
+      apx_capabilities_t capabilities;
+      apx_fileManagerShared_get_capabilities(&self->shared, &capabilities);
+      if (!apx_capabilities_has(&capabilities, APX_CAPABILITY_STREAM_FILE))
+      {
+         return APX_UNSUPPORTED_ERROR;
+      }
+   }
+   file = apx_fileManagerShared_create_remote_file(&self->shared, file_info);
    if (file == NULL)
    {
       return APX_FILE_CREATE_ERROR;
@@ -488,3 +864,109 @@ static apx_error_t process_remote_file_published(apx_fileManager_t* self, rmf_fi
    assert(connection->remote_file_published_notification != NULL);
    return connection->remote_file_published_notification(connection->arg, file);
 }
+
+/**
+ * When APX_CAPABILITY_PIPELINED_OPEN is agreed, fixed definition and provide port data files are
+ * sent by the client right after they are published. The server never requests them.
+ */
+static bool is_pipelined_file(apx_fileManager_t* self, apx_file_t* file)
+{
+   apx_capabilities_t capabilities;
+   apx_fileType_t const file_type = apx_file_get_apx_file_type(file);
+   if ( (apx_file_get_rmf_file_type(file) != RMF_FILE_TYPE_FIXED) ||
+        ( (file_type != APX_DEFINITION_FILE_TYPE) && (file_type != APX_PROVIDE_PORT_DATA_FILE_TYPE) ) )
+   {
+      return false;
+   }
+   apx_fileManagerShared_get_capabilities(&self->shared, &capabilities);
+   return apx_capabilities_has(&capabilities, APX_CAPABILITY_PIPELINED_OPEN);
+}
+
+/**
+ * Client side. Opens the local file as if the server had requested it, which queues its data right behind the publish.
+ */
+static apx_error_t open_pipelined_local_file(apx_fileManager_t* self, uint32_t address, apx_fileType_t file_type)
+{
+   apx_file_t* file = apx_fileManagerShared_find_file_by_address(&self->shared, address);
+   if ( (file != NULL) && apx_file_is_local(file) && (apx_file_get_apx_file_type(file) == file_type) &&
+        !apx_file_is_open(file) && is_pipelined_file(self, file) )
+   {
+      return process_open_file_request(self, address);
+   }
+   return APX_NO_ERROR;
+}
+
+static apx_error_t deliver_early_data(apx_fileManager_t* self, apx_file_t* file)
+{
+   apx_error_t retval = APX_NO_ERROR;
+   uint8_t* early_data = apx_file_take_early_data(file);
+   if (early_data != NULL)
+   {
+      apx_connectionInterface_t const* connection = apx_fileManagerShared_connection(&self->shared);
+      if (connection == NULL)
+      {
+         retval = APX_NULL_PTR_ERROR;
+      }
+      else
+      {
+         //Only the written ranges are delivered, bytes in between keep their current (init) values
+         uint32_t offset = 0u;
+         uint32_t len;
+         while ( (retval == APX_NO_ERROR) && ((len = apx_file_next_early_data_range(file, early_data, &offset)) > 0u) )
+         {
+            retval = connection->remote_file_write_notification(connection->arg, file, offset, &early_data[offset], (apx_size_t)len);
+            offset += len;
+         }
+      }
+      free(early_data);
+   }
+   return retval;
+}
+
+/**
+ * Fragments of remote definition files bypass reassembly so the node manager can parse the definition while it arrives.
+ * Only done when no other fragmented write is being reassembled.
+ */
+static bool is_streamed_fragment(apx_fileManager_t* self, uint32_t address, bool more_bit)
+{
+   apx_file_t* file;
+   if ( (!more_bit) || (address >= RMF_CMD_AREA_START_ADDRESS) || (self->receiver.start_address != RMF_INVALID_ADDRESS) )
+   {
+      return false;
+   }
+   file = apx_fileManagerShared_find_file_by_address(&self->shared, address | RMF_HIGH_ADDR_BIT);
+   return (file != NULL) && (apx_file_get_apx_file_type(file) == APX_DEFINITION_FILE_TYPE) && apx_file_is_open(file);
+}
+
+static apx_error_t verify_local_file_is_open(apx_fileManager_t* self, uint32_t address)
+{
+   apx_file_t* file = apx_fileManagerShared_find_file_by_address(&self->shared, address);
+   if (file == NULL)
+   {
+      return APX_FILE_NOT_FOUND_ERROR;
+   }
+   if (!apx_file_is_open(file))
+   {
+      return APX_FILE_NOT_OPEN_ERROR;
+   }
+   return APX_NO_ERROR;
+}
+
+/**
+ * Port data files with dynamic array ports fall back to fixed files when the peer did not agree to APX_CAPABILITY_DYNAMIC_FILE.
+ * Stream files have no such fallback and are not published to peers without APX_CAPABILITY_STREAM_FILE.
+ */
+static apx_error_t apply_capabilities_to_local_file(apx_fileManager_t* self, apx_file_t* file)
+{
+   apx_capabilities_t capabilities;
+   apx_fileManagerShared_get_capabilities(&self->shared, &capabilities);
+   if (apx_file_is_dynamic(file) && !apx_capabilities_has(&capabilities, APX_CAPABILITY_DYNAMIC_FILE))
+   {
+      apx_file_set_rmf_file_type(file, RMF_FILE_TYPE_FIXED);
+   }
+   else if (apx_file_is_stream(file) && !apx_capabilities_has(&capabilities, APX_CAPABILITY_STREAM_FILE))
+   {
+      return APX_UNSUPPORTED_ERROR;
+   }
+   return APX_NO_ERROR;
+}
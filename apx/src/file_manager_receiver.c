@@ -45,6 +45,8 @@
 static apx_error_t start_new_reception(apx_fileManagerReceiver_t* self, apx_fileManagerReceptionResult_t* result, uint32_t address, uint8_t const* data, apx_size_t size, bool more_bit);
 static apx_error_t continue_reception(apx_fileManagerReceiver_t* self, apx_fileManagerReceptionResult_t* result, uint32_t address, uint8_t const* data, apx_size_t size, bool more_bit);
 static void process_more_bit(apx_fileManagerReceiver_t* self, apx_fileManagerReceptionResult_t* result, bool more_bit);
+static apx_error_t grow_buffer(apx_fileManagerReceiver_t* self, apx_size_t required_size);
+static void deliver_direct(apx_fileManagerReceiver_t* self, apx_fileManagerReceptionResult_t* result, uint32_t address, uint8_t const* data, apx_size_t size);
 
 //////////////////////////////////////////////////////////////////////////////
 // PUBLIC VARIABLES
@@ -66,6 +68,8 @@ apx_error_t apx_fileManagerReceiver_create(apx_fileManagerReceiver_t* self)
       self->buf_size = 0u;
       self->buf_pos = 0u;
       self->start_address = RMF_INVALID_ADDRESS;
+      self->total_bytes_direct = 0u;
+      self->total_bytes_copied = 0u;
       return apx_fileManagerReceiver_reserve(self, RMF_CMD_AREA_SIZE);
    }
    return APX_INVALID_ARGUMENT_ERROR;
@@ -158,6 +162,24 @@ apx_error_t apx_fileManagerReceiver_write(apx_fileManagerReceiver_t* self, apx_f
    return APX_INVALID_ARGUMENT_ERROR;
 }
 
+uint64_t apx_fileManagerReceiver_get_total_bytes_direct(apx_fileManagerReceiver_t const* self)
+{
+   if (self != NULL)
+   {
+      return self->total_bytes_direct;
+   }
+   return 0u;
+}
+
+uint64_t apx_fileManagerReceiver_get_total_bytes_copied(apx_fileManagerReceiver_t const* self)
+{
+   if (self != NULL)
+   {
+      return self->total_bytes_copied;
+   }
+   return 0u;
+}
+
 //////////////////////////////////////////////////////////////////////////////
 // PRIVATE FUNCTIONS
 //////////////////////////////////////////////////////////////////////////////
@@ -166,11 +188,16 @@ static apx_error_t start_new_reception(apx_fileManagerReceiver_t* self, apx_file
 {
    assert(data != NULL);
    apx_error_t retval = APX_NO_ERROR;
-   if ( (self->buf_size == 0u) || (self->buf_data == NULL))
+   if (!more_bit)
+   {
+      //Unfragmented message. Deliver it directly from the caller's buffer without copying.
+      deliver_direct(self, result, address, data, size);
+   }
+   else if ( (self->buf_size == 0u) || (self->buf_data == NULL))
    {
       retval = APX_MISSING_BUFFER_ERROR;
    }
-   else if (size > self->buf_size)
+   else if ( (size > self->buf_size) && (apx_fileManagerReceiver_reserve(self, size) != APX_NO_ERROR) )
    {
       retval = APX_BUFFER_FULL_ERROR;
    }
@@ -180,6 +207,7 @@ static apx_error_t start_new_reception(apx_fileManagerReceiver_t* self, apx_file
       {
          memcpy(self->buf_data, data, size);
          self->buf_pos = size;
+         self->total_bytes_copied += size;
       }
       self->start_address = address;
       process_more_bit(self, result, more_bit);
@@ -195,6 +223,13 @@ static apx_error_t continue_reception(apx_fileManagerReceiver_t* self, apx_fileM
    uint32_t expected_address = (self->start_address + (uint32_t)self->buf_pos);
    if (expected_address != address)
    {
+      if (!more_bit)
+      {
+         //Unfragmented message interleaved between fragments of another write. Deliver it as is,
+         //even when it writes to bytes already received as part of the fragmented write.
+         deliver_direct(self, result, address, data, size);
+         return APX_NO_ERROR;
+      }
       retval = APX_INVALID_ADDRESS_ERROR;
    }
    if (retval == APX_NO_ERROR)
@@ -203,7 +238,7 @@ static apx_error_t continue_reception(apx_fileManagerReceiver_t* self, apx_fileM
       {
          retval = APX_MISSING_BUFFER_ERROR;
       }
-      else if ((self->buf_pos + size) > self->buf_size)
+      else if ( ((self->buf_pos + size) > self->buf_size) && (grow_buffer(self, self->buf_pos + size) != APX_NO_ERROR) )
       {
          retval = APX_BUFFER_FULL_ERROR;
       }
@@ -213,6 +248,7 @@ static apx_error_t continue_reception(apx_fileManagerReceiver_t* self, apx_fileM
          {
             memcpy(self->buf_data + self->buf_pos, data, size);
             self->buf_pos += size;
+            self->total_bytes_copied += size;
          }
          process_more_bit(self, result, more_bit);
          retval = APX_NO_ERROR;
@@ -231,4 +267,42 @@ static void process_more_bit(apx_fileManagerReceiver_t* self, apx_fileManagerRec
       result->size = self->buf_pos;
       apx_fileManagerReceiver_reset(self);
    }
-}
\ No newline at end of file
+}
+
+/**
+ * Grows the reception buffer while keeping already received fragments.
+ */
+static apx_error_t grow_buffer(apx_fileManagerReceiver_t* self, apx_size_t required_size)
+{
+   uint8_t* new_data;
+   apx_size_t new_size = self->buf_size * 2u;
+   if (required_size > APX_MAX_FILE_SIZE)
+   {
+      return APX_FILE_TOO_LARGE_ERROR;
+   }
+   if (new_size < required_size)
+   {
+      new_size = required_size;
+   }
+   if (new_size > APX_MAX_FILE_SIZE)
+   {
+      new_size = APX_MAX_FILE_SIZE;
+   }
+   new_data = (uint8_t*)realloc(self->buf_data, new_size);
+   if (new_data == NULL)
+   {
+      return APX_MEM_ERROR;
+   }
+   self->buf_data = new_data;
+   self->buf_size = new_size;
+   return APX_NO_ERROR;
+}
+
+static void deliver_direct(apx_fileManagerReceiver_t* self, apx_fileManagerReceptionResult_t* result, uint32_t address, uint8_t const* data, apx_size_t size)
+{
+   result->is_complete = true;
+   result->address = address;
+   result->data = data;
+   result->size = size;
+   self->total_bytes_direct += size;
+}
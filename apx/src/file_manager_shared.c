@@ -60,6 +60,10 @@ void apx_fileManagerShared_create(apx_fileManagerShared_t* self, apx_connectionI
       self->connection_id = APX_INVALID_CONNECTION_ID;
       self->is_connected = false;
       self->allocator = allocator;
+      self->compression_threshold = 0u;
+      apx_compressionStats_create(&self->compression_stats);
+      apx_capabilities_create(&self->local_capabilities, 0u, 0u, 0u);
+      apx_capabilities_create(&self->capabilities, 0u, 0u, 0u);
       apx_fileMap_create(&self->local_file_map, false);
       apx_fileMap_create(&self->remote_file_map, true);
       MUTEX_INIT(self->lock);
@@ -248,6 +252,8 @@ void apx_fileManagerShared_disconnected(apx_fileManagerShared_t* self)
    {
       MUTEX_LOCK(self->lock);
       self->is_connected = false;
+      self->compression_threshold = 0u; //renegotiated on next connect
+      apx_capabilities_create(&self->capabilities, 0u, 0u, 0u);
       MUTEX_UNLOCK(self->lock);
 #if APX_DEBUG_ENABLE
       printf("[FILE-MANAGER %u] Disabled transmit handler\n", (unsigned int) self->connection_id);
@@ -287,6 +293,86 @@ apx_allocator_t* apx_fileManagerShared_allocator(apx_fileManagerShared_t const*
    return NULL;
 }
 
+/**
+ * Messages of at least threshold bytes are sent compressed. 0 disables compression.
+ */
+void apx_fileManagerShared_set_compression_threshold(apx_fileManagerShared_t* self, uint32_t threshold)
+{
+   if (self != NULL)
+   {
+      MUTEX_LOCK(self->lock);
+      self->compression_threshold = threshold;
+      MUTEX_UNLOCK(self->lock);
+   }
+}
+
+uint32_t apx_fileManagerShared_get_compression_threshold(apx_fileManagerShared_t* self)
+{
+   if (self != NULL)
+   {
+      uint32_t retval;
+      MUTEX_LOCK(self->lock);
+      retval = self->compression_threshold;
+      MUTEX_UNLOCK(self->lock);
+      return retval;
+   }
+   return 0u;
+}
+
+void apx_fileManagerShared_add_compression_stats(apx_fileManagerShared_t* self, apx_compressionStats_t const* stats)
+{
+   if ( (self != NULL) && (stats != NULL) )
+   {
+      MUTEX_LOCK(self->lock);
+      apx_compressionStats_add(&self->compression_stats, stats);
+      MUTEX_UNLOCK(self->lock);
+   }
+}
+
+void apx_fileManagerShared_get_compression_stats(apx_fileManagerShared_t* self, apx_compressionStats_t* stats)
+{
+   if ( (self != NULL) && (stats != NULL) )
+   {
+      MUTEX_LOCK(self->lock);
+      memcpy(stats, &self->compression_stats, sizeof(apx_compressionStats_t));
+      MUTEX_UNLOCK(self->lock);
+   }
+}
+
+/**
+ * Stores what this side announced and agrees on the common set with what the peer announced.
+ */
+void apx_fileManagerShared_set_capabilities(apx_fileManagerShared_t* self, apx_capabilities_t const* local, apx_capabilities_t const* peer)
+{
+   if ( (self != NULL) && (local != NULL) && (peer != NULL) )
+   {
+      MUTEX_LOCK(self->lock);
+      memcpy(&self->local_capabilities, local, sizeof(apx_capabilities_t));
+      apx_capabilities_agree(&self->capabilities, local, peer);
+      MUTEX_UNLOCK(self->lock);
+   }
+}
+
+void apx_fileManagerShared_get_capabilities(apx_fileManagerShared_t* self, apx_capabilities_t* capabilities)
+{
+   if ( (self != NULL) && (capabilities != NULL) )
+   {
+      MUTEX_LOCK(self->lock);
+      memcpy(capabilities, &self->capabilities, sizeof(apx_capabilities_t));
+      MUTEX_UNLOCK(self->lock);
+   }
+}
+
+void apx_fileManagerShared_get_local_capabilities(apx_fileManagerShared_t* self, apx_capabilities_t* capabilities)
+{
+   if ( (self != NULL) && (capabilities != NULL) )
+   {
+      MUTEX_LOCK(self->lock);
+      memcpy(capabilities, &self->local_capabilities, sizeof(apx_capabilities_t));
+      MUTEX_UNLOCK(self->lock);
+   }
+}
+
 
 //////////////////////////////////////////////////////////////////////////////
 // PRIVATE FUNCTIONS
@@ -31,8 +31,13 @@
 #include <malloc.h>
 #ifdef _WIN32
 #include <process.h>
+#else
+#include <errno.h>
 #endif
+#include <time.h>
 #include "apx/file_manager_worker.h"
+#include "apx/numheader.h"
+#include "apx/util.h"
 #ifdef MEM_LEAK_CHECK
 #include "CMemLeak.h"
 #endif
@@ -48,20 +53,44 @@
 #define DYN_STATIC static
 #endif
 */
+#define WORKER_WAIT_ERROR   -1
+#define WORKER_WAIT_TIMEOUT 0
+#define WORKER_WAIT_OK      1
 //////////////////////////////////////////////////////////////////////////////
 // PRIVATE FUNCTION PROTOTYPES
 //////////////////////////////////////////////////////////////////////////////
+static apx_error_t insert_command(apx_fileManagerWorker_t* self, apx_command_t* cmd, apx_transmitLane_t lane);
+static bool remove_next_command(apx_fileManagerWorker_t* self, apx_command_t* cmd, apx_transmitLane_t* lane);
+static bool has_priority_command(apx_fileManagerWorker_t* self);
+static bool process_queued_commands(apx_fileManagerWorker_t* self);
+static void record_latency(apx_fileManagerWorker_t* self, apx_transmitLane_t lane, apx_command_t const* cmd);
 static bool process_single_command(apx_fileManagerWorker_t* self, apx_command_t const* cmd);
 static apx_error_t run_send_acknowledge(apx_fileManagerWorker_t* self);
 static apx_error_t run_publish_local_file(apx_fileManagerWorker_t* self, rmf_fileInfo_t* file);
 static apx_error_t run_send_local_const_data(apx_fileManagerWorker_t* self, uint32_t address, uint8_t const* data, uint32_t size);
 static apx_error_t run_send_local_data(apx_fileManagerWorker_t* self, uint32_t address, uint8_t* data, uint32_t size);
+static apx_error_t run_apply_local_data(apx_fileManagerWorker_t* self, uint32_t address, uint8_t* data, uint32_t size);
+static apx_error_t run_drain_queued_data(apx_fileManagerWorker_t* self, uint32_t address, apx_queuedPortRing_t* ring);
+static apx_error_t run_send_stream_record(apx_fileManagerWorker_t* self, uint32_t address, uint8_t* record, uint32_t size);
+static apx_error_t run_open_stream(apx_fileManagerWorker_t* self, uint32_t address);
+static apx_error_t send_stream_record_copy(apx_fileManagerWorker_t* self, uint32_t address, apx_streamRecord_t const* record);
+static apx_error_t send_data(apx_fileManagerWorker_t* self, uint32_t address, uint8_t const* data, uint32_t size, uint8_t* owned_data);
+static apx_error_t transmit_data(apx_fileManagerWorker_t* self, apx_connectionInterface_t const* connection, uint32_t address, bool more_bit, uint8_t const* data, uint32_t size);
+static apx_size_t compress_message(apx_fileManagerWorker_t* self, uint32_t address, bool more_bit, uint8_t const* data, uint32_t size);
+static int32_t get_max_fragment_size(apx_fileManagerWorker_t* self, apx_connectionInterface_t const* connection);
+static bool is_fragmented_write_active(apx_fileManagerWorker_t const* self);
+static apx_error_t send_next_fragment(apx_fileManagerWorker_t* self);
+static void finish_fragmented_write(apx_fileManagerWorker_t* self);
+static void resolve_overlap_with_fragmented_write(apx_fileManagerWorker_t* self, uint32_t address, uint8_t const* data, uint32_t size);
+static void clear_fragmented_write(apx_fileManagerWorker_t* self);
 static apx_error_t run_open_remote_file(apx_fileManagerWorker_t* self, uint32_t address);
 static apx_error_t apx_fileManagerWorker_process_ringbuffer_error(adt_buf_err_t error_code);
 #ifndef UNIT_TEST
 static apx_error_t start_worker_thread(apx_fileManagerWorker_t* self);
 static apx_error_t stop_worker_thread(apx_fileManagerWorker_t* self);
 static THREAD_PROTO(worker_main, arg);
+static int wait_for_command(apx_fileManagerWorker_t* self, int32_t timeout_us);
+static int32_t get_flush_deadline(apx_connectionInterface_t const* connection);
 #endif
 
 //////////////////////////////////////////////////////////////////////////////
@@ -76,14 +105,29 @@ apx_error_t apx_fileManagerWorker_create(apx_fileManagerWorker_t* self, apx_file
 {
    if (self != NULL)
    {
+      apx_transmitLane_t lane;
       adt_buf_err_t buf_result = adt_rbfh_create(&self->queue, (uint8_t) APX_COMMAND_SIZE);
       if (buf_result != BUF_E_OK)
       {
          return APX_MEM_ERROR;
       }
+      buf_result = adt_rbfh_create(&self->priority_queue, (uint8_t) APX_COMMAND_SIZE);
+      if (buf_result != BUF_E_OK)
+      {
+         adt_rbfh_destroy(&self->queue);
+         return APX_MEM_ERROR;
+      }
+      self->num_queued_snapshots = 0u;
+      for (lane = 0u; lane < APX_NUM_TRANSMIT_LANES; lane++)
+      {
+         apx_latencyHistogram_create(&self->lane_latency[lane]);
+      }
       self->mode = mode;
       self->shared = shared;
       self->worker_thread_valid = false;
+      memset(&self->fragmented_write, 0, sizeof(apx_fragmentedWrite_t));
+      self->compression_buffer = NULL;
+      self->compression_buffer_size = 0u;
       MUTEX_INIT(self->mutex);
       (void)SPINLOCK_INIT(self->queue_lock);
       SEMAPHORE_CREATE(self->semaphore);
@@ -108,10 +152,16 @@ void apx_fileManagerWorker_destroy(apx_fileManagerWorker_t *self)
          stop_worker_thread(self);
 #endif
       }
+      clear_fragmented_write(self);
+      if (self->compression_buffer != NULL)
+      {
+         free(self->compression_buffer);
+      }
       MUTEX_DESTROY(self->mutex);
       SPINLOCK_DESTROY(self->queue_lock);
       SEMAPHORE_DESTROY(self->semaphore);
       adt_rbfh_destroy(&self->queue);
+      adt_rbfh_destroy(&self->priority_queue);
    }
 }
 
@@ -121,46 +171,46 @@ uint16_t apx_fileManagerWorker_num_pending_commands(apx_fileManagerWorker_t* sel
    {
       uint16_t retval;
       SPINLOCK_ENTER(self->queue_lock);
-      retval = adt_rbfh_length(&self->queue);
+      retval = (uint16_t)(adt_rbfh_length(&self->queue) + adt_rbfh_length(&self->priority_queue));
       SPINLOCK_LEAVE(self->queue_lock);
       return retval;
    }
    return 0u;
 }
 
+/**
+ * Copies the queueing latency histogram of a lane. Latency is measured from when a command is queued until the
+ * worker starts processing it.
+ */
+void apx_fileManagerWorker_get_latency(apx_fileManagerWorker_t* self, apx_transmitLane_t lane, apx_latencyHistogram_t* histogram)
+{
+   if ( (self != NULL) && (lane < APX_NUM_TRANSMIT_LANES) && (histogram != NULL) )
+   {
+      MUTEX_LOCK(self->mutex);
+      memcpy(histogram, &self->lane_latency[lane], sizeof(apx_latencyHistogram_t));
+      MUTEX_UNLOCK(self->mutex);
+   }
+}
+
 #ifdef UNIT_TEST
 bool apx_fileManagerWorker_run(apx_fileManagerWorker_t* self)
 {
    if (self != NULL)
    {
+      bool result;
       apx_connectionInterface_t const* connection = apx_fileManagerShared_connection(self->shared);
       if ( connection != NULL )
       {
          assert(connection->transmit_begin != NULL);
          connection->transmit_begin(connection->arg);
       }
-      while (adt_rbfh_length(&self->queue) > 0)
-      {
-         apx_command_t cmd;
-         bool result;
-         adt_rbfh_remove(&self->queue, (uint8_t*)&cmd);
-         result = process_single_command(self, &cmd);
-         if (!result)
-         {
-            if (connection != NULL)
-            {
-               assert(connection->transmit_end != NULL);
-               connection->transmit_end(connection->arg);
-            }
-            return result;
-         }
-      }
+      result = process_queued_commands(self);
       if (connection != NULL)
       {
          assert(connection->transmit_end != NULL);
          connection->transmit_end(connection->arg);
       }
-      return true;
+      return result;
    }
    return false;
 }
@@ -190,15 +240,8 @@ apx_error_t apx_fileManagerWorker_preare_acknowledge(apx_fileManagerWorker_t* se
 {
    if (self != NULL)
    {
-      adt_buf_err_t rc;
-      apx_command_t cmd = { APX_CMD_SEND_ACKNOWLEDGE, 0, 0, {0}, 0 };
-      SPINLOCK_ENTER(self->queue_lock);
-      rc = adt_rbfh_insert(&self->queue, (const uint8_t*)&cmd);
-      SPINLOCK_LEAVE(self->queue_lock);
-#ifndef UNIT_TEST
-      SEMAPHORE_POST(self->semaphore);
-#endif
-      return apx_fileManagerWorker_process_ringbuffer_error(rc);
+      apx_command_t cmd = { APX_CMD_SEND_ACKNOWLEDGE, 0, 0, {0}, 0, 0u };
+      return insert_command(self, &cmd, APX_TRANSMIT_LANE_NORMAL);
    }
    return APX_INVALID_ARGUMENT_ERROR;
 }
@@ -207,16 +250,9 @@ apx_error_t apx_fileManagerWorker_prepare_publish_local_file(apx_fileManagerWork
 {
    if (self != NULL)
    {
-      adt_buf_err_t rc;
-      apx_command_t cmd = { APX_CMD_PUBLISH_LOCAL_FILE, 0, 0, {0}, 0 };
+      apx_command_t cmd = { APX_CMD_PUBLISH_LOCAL_FILE, 0, 0, {0}, 0, 0u };
       cmd.data3.ptr = (void*)file_info;
-      SPINLOCK_ENTER(self->queue_lock);
-      rc = adt_rbfh_insert(&self->queue, (const uint8_t*)&cmd);
-      SPINLOCK_LEAVE(self->queue_lock);
-#ifndef UNIT_TEST
-      SEMAPHORE_POST(self->semaphore);
-#endif
-      return apx_fileManagerWorker_process_ringbuffer_error(rc);
+      return insert_command(self, &cmd, APX_TRANSMIT_LANE_NORMAL);
    }
    return APX_INVALID_ARGUMENT_ERROR;
 }
@@ -225,16 +261,9 @@ apx_error_t apx_fileManagerWorker_prepare_send_local_const_data(apx_fileManagerW
 {
    if (self != NULL)
    {
-      adt_buf_err_t rc;
       apx_command_t cmd;
       apx_build_command_with_ptr(&cmd, APX_CMD_SEND_LOCAL_CONST_DATA, address, size, (void*) data, NULL);
-      SPINLOCK_ENTER(self->queue_lock);
-      rc = adt_rbfh_insert(&self->queue, (const uint8_t*)&cmd);
-      SPINLOCK_LEAVE(self->queue_lock);
-#ifndef UNIT_TEST
-      SEMAPHORE_POST(self->semaphore);
-#endif
-      return apx_fileManagerWorker_process_ringbuffer_error(rc);
+      return insert_command(self, &cmd, APX_TRANSMIT_LANE_NORMAL);
    }
    return APX_INVALID_ARGUMENT_ERROR;
 }
@@ -243,16 +272,20 @@ apx_error_t apx_fileManagerWorker_prepare_send_local_data(apx_fileManagerWorker_
 {
    if (self != NULL)
    {
-      adt_buf_err_t rc;
       apx_command_t cmd;
       apx_build_command_with_ptr(&cmd, APX_CMD_SEND_LOCAL_DATA, address, size, data, NULL); //TODO: Implement small data support
-      SPINLOCK_ENTER(self->queue_lock);
-      rc = adt_rbfh_insert(&self->queue, (const uint8_t*)&cmd);
-      SPINLOCK_LEAVE(self->queue_lock);
-#ifndef UNIT_TEST
-      SEMAPHORE_POST(self->semaphore);
-#endif
-      return apx_fileManagerWorker_process_ringbuffer_error(rc);
+      return insert_command(self, &cmd, APX_TRANSMIT_LANE_NORMAL);
+   }
+   return APX_INVALID_ARGUMENT_ERROR;
+}
+
+apx_error_t apx_fileManagerWorker_prepare_apply_local_data(apx_fileManagerWorker_t* self, uint32_t address, uint8_t* data, uint32_t size)
+{
+   if (self != NULL)
+   {
+      apx_command_t cmd;
+      apx_build_command_with_ptr(&cmd, APX_CMD_APPLY_LOCAL_DATA, address, size, data, NULL);
+      return insert_command(self, &cmd, APX_TRANSMIT_LANE_NORMAL);
    }
    return APX_INVALID_ARGUMENT_ERROR;
 }
@@ -261,16 +294,97 @@ apx_error_t apx_fileManagerWorker_prepare_send_open_file_request(apx_fileManager
 {
    if (self != NULL)
    {
-      adt_buf_err_t rc;
-      apx_command_t cmd = { APX_CMD_OPEN_REMOTE_FILE, 0, 0, {0}, 0 };
+      apx_command_t cmd = { APX_CMD_OPEN_REMOTE_FILE, 0, 0, {0}, 0, 0u };
       cmd.data1 = address;
-      SPINLOCK_ENTER(self->queue_lock);
-      rc = adt_rbfh_insert(&self->queue, (const uint8_t*)&cmd);
-      SPINLOCK_LEAVE(self->queue_lock);
-#ifndef UNIT_TEST
-      SEMAPHORE_POST(self->semaphore);
-#endif
-      return apx_fileManagerWorker_process_ringbuffer_error(rc);
+      return insert_command(self, &cmd, APX_TRANSMIT_LANE_NORMAL);
+   }
+   return APX_INVALID_ARGUMENT_ERROR;
+}
+
+/**
+ * Same as apx_fileManagerWorker_prepare_send_local_data but the data is queued in the high priority lane
+ */
+apx_error_t apx_fileManagerWorker_prepare_send_priority_data(apx_fileManagerWorker_t* self, uint32_t address, uint8_t* data, uint32_t size)
+{
+   if (self != NULL)
+   {
+      apx_command_t cmd;
+      apx_build_command_with_ptr(&cmd, APX_CMD_SEND_LOCAL_DATA, address, size, data, NULL);
+      return insert_command(self, &cmd, APX_TRANSMIT_LANE_HIGH);
+   }
+   return APX_INVALID_ARGUMENT_ERROR;
+}
+
+/**
+ * Same as apx_fileManagerWorker_prepare_apply_local_data but the data is queued in the high priority lane
+ */
+apx_error_t apx_fileManagerWorker_prepare_apply_priority_data(apx_fileManagerWorker_t* self, uint32_t address, uint8_t* data, uint32_t size)
+{
+   if (self != NULL)
+   {
+      apx_command_t cmd;
+      apx_build_command_with_ptr(&cmd, APX_CMD_APPLY_LOCAL_DATA, address, size, data, NULL);
+      return insert_command(self, &cmd, APX_TRANSMIT_LANE_HIGH);
+   }
+   return APX_INVALID_ARGUMENT_ERROR;
+}
+
+/**
+ * Sends a copy of an entire file. High priority data queued after the snapshot is kept behind it,
+ * otherwise the snapshot could overwrite a newer value on the receiving side.
+ */
+apx_error_t apx_fileManagerWorker_prepare_send_local_snapshot(apx_fileManagerWorker_t* self, uint32_t address, uint8_t* data, uint32_t size)
+{
+   if (self != NULL)
+   {
+      apx_command_t cmd;
+      apx_build_command_with_ptr(&cmd, APX_CMD_SEND_LOCAL_SNAPSHOT, address, size, data, NULL);
+      return insert_command(self, &cmd, APX_TRANSMIT_LANE_NORMAL);
+   }
+   return APX_INVALID_ARGUMENT_ERROR;
+}
+
+/**
+ * Asks the worker to move all elements of a queued require port ring into the file at address.
+ * The ring is not owned by the command, it is only accessed while the file is still attached.
+ */
+apx_error_t apx_fileManagerWorker_prepare_drain_queued_data(apx_fileManagerWorker_t* self, uint32_t address, apx_queuedPortRing_t* ring)
+{
+   if ( (self != NULL) && (ring != NULL) )
+   {
+      apx_command_t cmd;
+      apx_build_command_with_ptr(&cmd, APX_CMD_DRAIN_QUEUED_DATA, address, 0u, (void*)ring, NULL);
+      return insert_command(self, &cmd, APX_TRANSMIT_LANE_NORMAL);
+   }
+   return APX_INVALID_ARGUMENT_ERROR;
+}
+
+/**
+ * Appends a record to the stream file at address. The worker takes ownership of record, its first
+ * RMF_STREAM_SEQUENCE_SIZE bytes are reserved for the sequence number.
+ */
+apx_error_t apx_fileManagerWorker_prepare_send_stream_record(apx_fileManagerWorker_t* self, uint32_t address, uint8_t* record, uint32_t size)
+{
+   if ( (self != NULL) && (record != NULL) && (size >= RMF_STREAM_SEQUENCE_SIZE) )
+   {
+      apx_command_t cmd;
+      apx_build_command_with_ptr(&cmd, APX_CMD_SEND_STREAM_RECORD, address, size, record, NULL);
+      return insert_command(self, &cmd, APX_TRANSMIT_LANE_NORMAL);
+   }
+   return APX_INVALID_ARGUMENT_ERROR;
+}
+
+/**
+ * Sends the retained records of a stream file that was just opened by the remote side.
+ * Records appended after this command are sent as they arrive.
+ */
+apx_error_t apx_fileManagerWorker_prepare_open_stream(apx_fileManagerWorker_t* self, uint32_t address)
+{
+   if (self != NULL)
+   {
+      apx_command_t cmd;
+      apx_build_command_with_ptr(&cmd, APX_CMD_OPEN_STREAM, address, 0u, NULL, NULL);
+      return insert_command(self, &cmd, APX_TRANSMIT_LANE_NORMAL);
    }
    return APX_INVALID_ARGUMENT_ERROR;
 }
@@ -280,6 +394,110 @@ apx_error_t apx_fileManagerWorker_prepare_send_open_file_request(apx_fileManager
 // PRIVATE FUNCTIONS
 //////////////////////////////////////////////////////////////////////////////
 
+static apx_error_t insert_command(apx_fileManagerWorker_t* self, apx_command_t* cmd, apx_transmitLane_t lane)
+{
+   adt_buf_err_t rc;
+   cmd->queued_at_us = apx_time_monotonic_us();
+   SPINLOCK_ENTER(self->queue_lock);
+   if ( (lane == APX_TRANSMIT_LANE_HIGH) && (self->num_queued_snapshots == 0u) )
+   {
+      rc = adt_rbfh_insert(&self->priority_queue, (const uint8_t*)cmd);
+   }
+   else
+   {
+      rc = adt_rbfh_insert(&self->queue, (const uint8_t*)cmd);
+      if ( (rc == BUF_E_OK) && (cmd->cmd_type == APX_CMD_SEND_LOCAL_SNAPSHOT) )
+      {
+         self->num_queued_snapshots++;
+      }
+   }
+   SPINLOCK_LEAVE(self->queue_lock);
+#ifndef UNIT_TEST
+   SEMAPHORE_POST(self->semaphore);
+#endif
+   return apx_fileManagerWorker_process_ringbuffer_error(rc);
+}
+
+/**
+ * Removes the next command to process, high priority lane first. Returns false when both lanes are empty.
+ */
+static bool remove_next_command(apx_fileManagerWorker_t* self, apx_command_t* cmd, apx_transmitLane_t* lane)
+{
+   bool retval = true;
+   SPINLOCK_ENTER(self->queue_lock);
+   if (adt_rbfh_length(&self->priority_queue) > 0)
+   {
+      adt_rbfh_remove(&self->priority_queue, (uint8_t*)cmd);
+      *lane = APX_TRANSMIT_LANE_HIGH;
+   }
+   else if (adt_rbfh_length(&self->queue) > 0)
+   {
+      adt_rbfh_remove(&self->queue, (uint8_t*)cmd);
+      *lane = APX_TRANSMIT_LANE_NORMAL;
+      if (cmd->cmd_type == APX_CMD_SEND_LOCAL_SNAPSHOT)
+      {
+         //The snapshot is processed before anything else is removed, priority data may bypass the queue again
+         assert(self->num_queued_snapshots > 0u);
+         self->num_queued_snapshots--;
+      }
+   }
+   else
+   {
+      retval = false;
+   }
+   SPINLOCK_LEAVE(self->queue_lock);
+   return retval;
+}
+
+static bool has_priority_command(apx_fileManagerWorker_t* self)
+{
+   bool retval;
+   SPINLOCK_ENTER(self->queue_lock);
+   retval = adt_rbfh_length(&self->priority_queue) > 0;
+   SPINLOCK_LEAVE(self->queue_lock);
+   return retval;
+}
+
+/**
+ * Processes commands until both lanes are empty and no fragmented write remains.
+ * Interleave: at most one fragment of a large write between each command, but never while high priority commands are waiting.
+ * Returns false when the exit command was processed.
+ */
+static bool process_queued_commands(apx_fileManagerWorker_t* self)
+{
+   for (;;)
+   {
+      apx_command_t cmd;
+      apx_transmitLane_t lane = APX_TRANSMIT_LANE_NORMAL;
+      if (remove_next_command(self, &cmd, &lane))
+      {
+         record_latency(self, lane, &cmd);
+         if (!process_single_command(self, &cmd))
+         {
+            return false;
+         }
+      }
+      else if (!is_fragmented_write_active(self))
+      {
+         break;
+      }
+      if ( is_fragmented_write_active(self) && (!has_priority_command(self)) )
+      {
+         (void)send_next_fragment(self);
+      }
+   }
+   return true;
+}
+
+static void record_latency(apx_fileManagerWorker_t* self, apx_transmitLane_t lane, apx_command_t const* cmd)
+{
+   uint64_t const elapsed_us = apx_time_monotonic_us() - cmd->queued_at_us;
+   uint32_t const latency_us = (elapsed_us > UINT32_MAX) ? UINT32_MAX : (uint32_t)elapsed_us;
+   MUTEX_LOCK(self->mutex);
+   apx_latencyHistogram_add(&self->lane_latency[lane], latency_us);
+   MUTEX_UNLOCK(self->mutex);
+}
+
 static bool process_single_command(apx_fileManagerWorker_t* self, apx_command_t const* cmd)
 {
    apx_error_t result = APX_NO_ERROR;
@@ -315,6 +533,21 @@ static bool process_single_command(apx_fileManagerWorker_t* self, apx_command_t
    case APX_CMD_SEND_LOCAL_DATA:
       result = run_send_local_data(self, cmd->data1, (uint8_t*)cmd->data3.ptr, cmd->data2);
       break;
+   case APX_CMD_APPLY_LOCAL_DATA:
+      result = run_apply_local_data(self, cmd->data1, (uint8_t*)cmd->data3.ptr, cmd->data2);
+      break;
+   case APX_CMD_SEND_LOCAL_SNAPSHOT:
+      result = run_send_local_data(self, cmd->data1, (uint8_t*)cmd->data3.ptr, cmd->data2);
+      break;
+   case APX_CMD_DRAIN_QUEUED_DATA:
+      result = run_drain_queued_data(self, cmd->data1, (apx_queuedPortRing_t*)cmd->data3.ptr);
+      break;
+   case APX_CMD_SEND_STREAM_RECORD:
+      result = run_send_stream_record(self, cmd->data1, (uint8_t*)cmd->data3.ptr, cmd->data2);
+      break;
+   case APX_CMD_OPEN_STREAM:
+      result = run_open_stream(self, cmd->data1);
+      break;
    default:
       return false;
    }
@@ -327,9 +560,19 @@ static bool process_single_command(apx_fileManagerWorker_t* self, apx_command_t
 
 static apx_error_t run_send_acknowledge(apx_fileManagerWorker_t* self)
 {
-   uint8_t buffer[RMF_CMD_TYPE_SIZE];
-   apx_size_t const encoded_size = rmf_encode_acknowledge_cmd(buffer, (apx_size_t)sizeof(buffer));
+   uint8_t buffer[RMF_CMD_TYPE_SIZE + RMF_GREETING_MAX_LEN];
+   apx_size_t encoded_size = rmf_encode_acknowledge_cmd(buffer, (apx_size_t)sizeof(buffer));
    apx_error_t retval = APX_NO_ERROR;
+   apx_capabilities_t capabilities;
+   apx_fileManagerShared_get_capabilities(self->shared, &capabilities);
+   if ( (encoded_size > 0u) && capabilities.is_announced )
+   {
+      //Header lines after the acknowledge tell the client what was agreed. Older clients ignore them.
+      apx_capabilities_t local_capabilities;
+      apx_fileManagerShared_get_local_capabilities(self->shared, &local_capabilities);
+      capabilities.receive_buffer_size = local_capabilities.receive_buffer_size;
+      encoded_size += (apx_size_t)apx_capabilities_write_header(&capabilities, (char*)&buffer[encoded_size], (int32_t)(sizeof(buffer) - encoded_size));
+   }
    if (encoded_size == 0u)
    {
       retval = APX_BUFFER_BOUNDARY_ERROR;
@@ -377,36 +620,357 @@ static apx_error_t run_publish_local_file(apx_fileManagerWorker_t* self, rmf_fil
 }
 
 static apx_error_t run_send_local_const_data(apx_fileManagerWorker_t* self, uint32_t address, uint8_t const* data, uint32_t size)
+{
+   return send_data(self, address, data, size, NULL);
+}
+
+static apx_error_t run_send_local_data(apx_fileManagerWorker_t* self, uint32_t address, uint8_t* data, uint32_t size)
+{
+   return send_data(self, address, data, size, data);
+}
+
+/**
+ * Lets the file owner apply data that was routed to this connection before it is sent.
+ * Data is dropped if the file was closed after the command was queued.
+ */
+static apx_error_t run_apply_local_data(apx_fileManagerWorker_t* self, uint32_t address, uint8_t* data, uint32_t size)
+{
+   apx_error_t retval;
+   apx_file_t* file = apx_fileManagerShared_find_file_by_address(self->shared, address);
+   if (file == NULL)
+   {
+      free(data);
+      return APX_FILE_NOT_FOUND_ERROR;
+   }
+   retval = apx_file_local_write_notify(file, address - apx_file_get_address_without_flags(file), data, size);
+   if ( (retval == APX_NO_ERROR) && (!apx_file_is_open(file)) )
+   {
+      retval = APX_FILE_NOT_OPEN_ERROR;
+   }
+   if (retval != APX_NO_ERROR)
+   {
+      free(data);
+      return retval;
+   }
+   return send_data(self, address, data, size, data);
+}
+
+/**
+ * Applies and sends the elements waiting in the ring, one batch of at most queue length elements per write.
+ * Elements pushed while the batches are sent trigger another drain command.
+ */
+static apx_error_t run_drain_queued_data(apx_fileManagerWorker_t* self, uint32_t address, apx_queuedPortRing_t* ring)
+{
+   apx_size_t batch_size;
+   apx_file_t* file = apx_fileManagerShared_find_file_by_address(self->shared, address);
+   if (file == NULL)
+   {
+      return APX_FILE_NOT_FOUND_ERROR; //The ring was destroyed together with the file owner
+   }
+   apx_queuedPortRing_begin_drain(ring);
+   batch_size = apx_queuedPortRing_batch_size(ring);
+   while (apx_queuedPortRing_num_elements(ring) > 0u)
+   {
+      apx_error_t result;
+      uint8_t* data = (uint8_t*)malloc(batch_size);
+      if (data == NULL)
+      {
+         return APX_MEM_ERROR;
+      }
+      (void)apx_queuedPortRing_pop_batch(ring, data);
+      result = apx_file_local_write_notify(file, address - apx_file_get_address_without_flags(file), data, (uint32_t)batch_size);
+      if ( (result == APX_NO_ERROR) && (!apx_file_is_open(file)) )
+      {
+         result = APX_FILE_NOT_OPEN_ERROR;
+      }
+      if (result == APX_NO_ERROR)
+      {
+         result = send_data(self, address, data, (uint32_t)batch_size, data);
+      }
+      else
+      {
+         free(data);
+      }
+      if (result != APX_NO_ERROR)
+      {
+         return result;
+      }
+   }
+   return APX_NO_ERROR;
+}
+
+/**
+ * Stores the record in the retention buffer of the stream file, the oldest record is evicted when the buffer is full.
+ * The record is sent right away once the retained records have been sent to the reader (see run_open_stream).
+ */
+static apx_error_t run_send_stream_record(apx_fileManagerWorker_t* self, uint32_t address, uint8_t* record, uint32_t size)
+{
+   apx_streamBuffer_t* stream_buffer;
+   apx_file_t* file = apx_fileManagerShared_find_file_by_address(self->shared, address);
+   if (file == NULL)
+   {
+      free(record);
+      return APX_FILE_NOT_FOUND_ERROR;
+   }
+   stream_buffer = apx_file_get_stream_buffer(file);
+   if (stream_buffer == NULL)
+   {
+      free(record);
+      return APX_MEM_ERROR;
+   }
+   (void)apx_streamBuffer_push(stream_buffer, record, size);
+   if ( apx_streamBuffer_is_active(stream_buffer) && apx_file_is_open(file) )
+   {
+      return send_stream_record_copy(self, address, apx_streamBuffer_get(stream_buffer, apx_streamBuffer_length(stream_buffer) - 1u));
+   }
+   return APX_NO_ERROR;
+}
+
+/**
+ * Sends all retained records, oldest first. Since the worker processes commands in order, each record is sent exactly once.
+ */
+static apx_error_t run_open_stream(apx_fileManagerWorker_t* self, uint32_t address)
+{
+   uint32_t i;
+   apx_streamBuffer_t* stream_buffer;
+   apx_file_t* file = apx_fileManagerShared_find_file_by_address(self->shared, address);
+   if (file == NULL)
+   {
+      return APX_FILE_NOT_FOUND_ERROR;
+   }
+   stream_buffer = apx_file_get_stream_buffer(file);
+   if (stream_buffer == NULL)
+   {
+      return APX_MEM_ERROR;
+   }
+   for (i = 0u; i < apx_streamBuffer_length(stream_buffer); i++)
+   {
+      apx_error_t const result = send_stream_record_copy(self, address, apx_streamBuffer_get(stream_buffer, i));
+      if (result != APX_NO_ERROR)
+      {
+         return result;
+      }
+   }
+   apx_streamBuffer_set_active(stream_buffer, true);
+   return APX_NO_ERROR;
+}
+
+/**
+ * The retention buffer keeps the original record, the copy is owned by the (possibly fragmented) write.
+ */
+static apx_error_t send_stream_record_copy(apx_fileManagerWorker_t* self, uint32_t address, apx_streamRecord_t const* record)
+{
+   uint8_t* data = (uint8_t*)malloc(record->size);
+   if (data == NULL)
+   {
+      return APX_MEM_ERROR;
+   }
+   memcpy(data, record->data, record->size);
+   return send_data(self, address, data, record->size, data);
+}
+
+/**
+ * Sends data in a single message when it fits in the transmit buffer. Larger writes are split into
+ * more-bit fragments which the worker loop sends one at a time between other commands (see send_next_fragment).
+ * owned_data is freed once the data has been sent.
+ */
+static apx_error_t send_data(apx_fileManagerWorker_t* self, uint32_t address, uint8_t const* data, uint32_t size, uint8_t* owned_data)
 {
    apx_connectionInterface_t const* connection = apx_fileManagerShared_connection(self->shared);
    apx_error_t retval = APX_NO_ERROR;
    if (connection != NULL)
    {
-      int32_t bytes_available = 0;
-      retval = connection->transmit_data_message(connection->arg, address, false, data, (int32_t)size, &bytes_available);
+      int32_t const max_fragment_size = get_max_fragment_size(self, connection);
+      if ( (max_fragment_size <= 0) || (size <= (uint32_t)max_fragment_size) )
+      {
+         if (is_fragmented_write_active(self))
+         {
+            resolve_overlap_with_fragmented_write(self, address, data, size);
+         }
+         retval = transmit_data(self, connection, address, false, data, size);
+      }
+      else
+      {
+         //Only one fragmented write can be in progress at any time since the receiver reassembles one message at a time
+         finish_fragmented_write(self);
+         self->fragmented_write.data = data;
+         self->fragmented_write.owned_data = owned_data;
+         self->fragmented_write.address = address;
+         self->fragmented_write.size = size;
+         self->fragmented_write.offset = 0u;
+         return APX_NO_ERROR;
+      }
    }
    else
    {
       retval = APX_NOT_CONNECTED_ERROR;
    }
+   if (owned_data != NULL)
+   {
+      free(owned_data);
+   }
    return retval;
 }
 
-static apx_error_t run_send_local_data(apx_fileManagerWorker_t* self, uint32_t address, uint8_t* data, uint32_t size)
+/**
+ * Sends one data message. Once compression has been negotiated, messages of at least the threshold size are
+ * sent as compressed messages to the command area whenever that saves bytes on the wire.
+ */
+static apx_error_t transmit_data(apx_fileManagerWorker_t* self, apx_connectionInterface_t const* connection, uint32_t address, bool more_bit, uint8_t const* data, uint32_t size)
+{
+   int32_t bytes_available = 0;
+   uint32_t const threshold = apx_fileManagerShared_get_compression_threshold(self->shared);
+   if ( (threshold > 0u) && (size >= threshold) )
+   {
+      apx_size_t const compressed_size = compress_message(self, address, more_bit, data, size);
+      if (compressed_size > 0u)
+      {
+         return connection->transmit_data_message(connection->arg, RMF_CMD_AREA_START_ADDRESS, false, self->compression_buffer, (int32_t)compressed_size, &bytes_available);
+      }
+   }
+   return connection->transmit_data_message(connection->arg, address, more_bit, data, (int32_t)size, &bytes_available);
+}
+
+/**
+ * Encodes the compressed message into compression_buffer.
+ * Returns its size or 0 if the message is better sent uncompressed.
+ */
+static apx_size_t compress_message(apx_fileManagerWorker_t* self, uint32_t address, bool more_bit, uint8_t const* data, uint32_t size)
 {
+   apx_compressionStats_t stats;
+   apx_size_t header_size;
+   apx_size_t compressed_size;
+   //The compressed message is addressed to the command area, it must still be smaller on the wire than the original
+   uint32_t const original_size = (uint32_t)rmf_needed_encoding_size(address) + size;
+   uint32_t const overhead = RMF_HIGH_ADDR_SIZE + RMF_COMPRESSED_MSG_HEADER_MAX_SIZE;
+   if (original_size <= overhead + 1u)
+   {
+      return 0u;
+   }
+   if (self->compression_buffer_size < original_size)
+   {
+      uint8_t* buffer = (uint8_t*)realloc(self->compression_buffer, original_size);
+      if (buffer == NULL)
+      {
+         return 0u;
+      }
+      self->compression_buffer = buffer;
+      self->compression_buffer_size = original_size;
+   }
+   header_size = rmf_encode_compressed_msg_header(self->compression_buffer, RMF_COMPRESSED_MSG_HEADER_MAX_SIZE, address, more_bit, size);
+   if (header_size == 0u)
+   {
+      return 0u;
+   }
+   apx_compressionStats_create(&stats);
+   compressed_size = apx_compression_compress(self->compression_buffer + header_size, original_size - overhead - 1u, data, size, &stats);
+   apx_fileManagerShared_add_compression_stats(self->shared, &stats);
+   return (compressed_size > 0u) ? (header_size + compressed_size) : 0u;
+}
+
+/**
+ * Largest number of data bytes that fits in one message, leaving room for message and address headers.
+ * Also respects the max message size agreed with the peer.
+ * Returns 0 if neither the connection nor the peer reports a limit.
+ */
+static int32_t get_max_fragment_size(apx_fileManagerWorker_t* self, apx_connectionInterface_t const* connection)
+{
+   int32_t retval = 0;
+   apx_capabilities_t capabilities;
+   if (connection->transmit_max_buffer_size != NULL)
+   {
+      int32_t const max_buffer_size = connection->transmit_max_buffer_size(connection->arg);
+      int32_t const overhead = (int32_t)(NUMHEADER32_LONG_SIZE + RMF_HIGH_ADDR_SIZE);
+      if (max_buffer_size > overhead)
+      {
+         retval = max_buffer_size - overhead;
+      }
+   }
+   apx_fileManagerShared_get_capabilities(self->shared, &capabilities);
+   if ( (capabilities.max_message_size > RMF_HIGH_ADDR_SIZE) && (capabilities.max_message_size <= (uint32_t)INT32_MAX) )
+   {
+      int32_t const limit = (int32_t)(capabilities.max_message_size - RMF_HIGH_ADDR_SIZE);
+      if ( (retval == 0) || (limit < retval) )
+      {
+         retval = limit;
+      }
+   }
+   return retval;
+}
+
+static bool is_fragmented_write_active(apx_fileManagerWorker_t const* self)
+{
+   return self->fragmented_write.data != NULL;
+}
+
+static apx_error_t send_next_fragment(apx_fileManagerWorker_t* self)
+{
+   apx_fragmentedWrite_t* write = &self->fragmented_write;
    apx_connectionInterface_t const* connection = apx_fileManagerShared_connection(self->shared);
-   apx_error_t retval = APX_NO_ERROR;
+   apx_error_t retval = APX_NOT_CONNECTED_ERROR;
+   assert(write->data != NULL);
    if (connection != NULL)
    {
-      int32_t bytes_available = 0;
-      retval = connection->transmit_data_message(connection->arg, address, false, data, (int32_t)size, &bytes_available);
+      uint32_t const remaining = write->size - write->offset;
+      uint32_t const max_fragment_size = (uint32_t)get_max_fragment_size(self, connection);
+      uint32_t const fragment_size = (remaining > max_fragment_size) ? max_fragment_size : remaining;
+      bool const more_bit = (write->offset + fragment_size) < write->size;
+      retval = transmit_data(self, connection, write->address + write->offset, more_bit, write->data + write->offset, fragment_size);
+      if (retval == APX_NO_ERROR)
+      {
+         write->offset += fragment_size;
+         if (!more_bit)
+         {
+            clear_fragmented_write(self);
+         }
+         return APX_NO_ERROR;
+      }
    }
-   else
+   clear_fragmented_write(self);
+   return retval;
+}
+
+static void finish_fragmented_write(apx_fileManagerWorker_t* self)
+{
+   while (is_fragmented_write_active(self))
    {
-      retval = APX_NOT_CONNECTED_ERROR;
+      (void)send_next_fragment(self);
    }
-   free(data);
-   return retval;
+}
+
+/**
+ * A small write sent between fragments arrives before the remaining fragments. Where it overlaps bytes not yet sent,
+ * those fragments would overwrite it with older data. A write the worker owns (snapshot) is patched with the newer
+ * bytes, constant data is instead sent to completion before the small write.
+ */
+static void resolve_overlap_with_fragmented_write(apx_fileManagerWorker_t* self, uint32_t address, uint8_t const* data, uint32_t size)
+{
+   apx_fragmentedWrite_t* write = &self->fragmented_write;
+   uint32_t const unsent_begin = write->address + write->offset;
+   uint32_t const unsent_end = write->address + write->size;
+   uint32_t const overlap_begin = (address > unsent_begin) ? address : unsent_begin;
+   uint32_t const overlap_end = ((address + size) < unsent_end) ? (address + size) : unsent_end;
+   if (overlap_begin < overlap_end)
+   {
+      if (write->owned_data != NULL)
+      {
+         assert(write->owned_data == write->data);
+         memcpy(write->owned_data + (overlap_begin - write->address), data + (overlap_begin - address), overlap_end - overlap_begin);
+      }
+      else
+      {
+         finish_fragmented_write(self);
+      }
+   }
+}
+
+static void clear_fragmented_write(apx_fileManagerWorker_t* self)
+{
+   if (self->fragmented_write.owned_data != NULL)
+   {
+      free(self->fragmented_write.owned_data);
+   }
+   memset(&self->fragmented_write, 0, sizeof(apx_fragmentedWrite_t));
 }
 
 static apx_error_t run_open_remote_file(apx_fileManagerWorker_t* self, uint32_t address)
@@ -481,7 +1045,7 @@ static apx_error_t stop_worker_thread(apx_fileManagerWorker_t* self)
 #ifdef _WIN32
       DWORD result;
 #endif
-      apx_command_t cmd = { APX_CMD_EXIT, 0, 0, {0}, NULL };
+      apx_command_t cmd = { APX_CMD_EXIT, 0, 0, {0}, NULL, 0u };
       SPINLOCK_ENTER(self->queue_lock);
       adt_rbfh_insert(&self->queue, (const uint8_t*)&cmd);
       SPINLOCK_LEAVE(self->queue_lock);
@@ -531,49 +1095,24 @@ static THREAD_PROTO(worker_main, arg)
       while (is_running)
       {
          apx_connectionInterface_t const* connection = apx_fileManagerShared_connection(self->shared);
-
-#ifdef _WIN32
-         DWORD result = WaitForSingleObject(self->semaphore, INFINITE);
-         if (result == WAIT_OBJECT_0)
-#else
-
-         int result = sem_wait(&self->semaphore);
-         if (result == 0)
-#endif
+         int result = wait_for_command(self, get_flush_deadline(connection));
+         if (result == WORKER_WAIT_TIMEOUT)
+         {
+            //Connection is holding buffered data whose flush deadline has now expired
+            assert(connection != NULL);
+            connection->transmit_begin(connection->arg);
+            connection->transmit_end(connection->arg);
+         }
+         else if (result == WORKER_WAIT_OK)
          {
-            uint16_t queue_length = 0u;
-            SPINLOCK_ENTER(self->queue_lock);
-            queue_length = adt_rbfh_length(&self->queue);
-            SPINLOCK_LEAVE(self->queue_lock);
-            if (queue_length > 0)
+            if (apx_fileManagerWorker_num_pending_commands(self) > 0u)
             {
                if (connection != NULL)
                {
                   assert(connection->transmit_begin != NULL);
                   connection->transmit_begin(connection->arg);
                }
-               while (queue_length > 0)
-               {
-                  apx_command_t cmd;
-                  bool rc;
-                  SPINLOCK_ENTER(self->queue_lock);
-                  adt_rbfh_remove(&self->queue, (uint8_t*)&cmd);
-                  SPINLOCK_LEAVE(self->queue_lock);
-                  rc = process_single_command(self, &cmd);
-                  if (!rc)
-                  {
-                     if (connection != NULL)
-                     {
-                        assert(connection->transmit_end != NULL);
-                        connection->transmit_end(connection->arg);
-                     }
-                     is_running = false;
-                     break;
-                  }
-                  SPINLOCK_ENTER(self->queue_lock);
-                  queue_length = adt_rbfh_length(&self->queue);
-                  SPINLOCK_LEAVE(self->queue_lock);
-               }
+               is_running = process_queued_commands(self);
                if (connection != NULL)
                {
                   assert(connection->transmit_end != NULL);
@@ -589,4 +1128,60 @@ static THREAD_PROTO(worker_main, arg)
    }
    THREAD_RETURN(APX_NO_ERROR);
 }
+
+/**
+ * Waits for the next command to arrive. A negative timeout_us means wait forever.
+ */
+static int wait_for_command(apx_fileManagerWorker_t* self, int32_t timeout_us)
+{
+#ifdef _WIN32
+   DWORD const timeout_ms = (timeout_us < 0) ? INFINITE : (DWORD)((timeout_us + 999) / 1000);
+   DWORD result = WaitForSingleObject(self->semaphore, timeout_ms);
+   if (result == WAIT_OBJECT_0)
+   {
+      return WORKER_WAIT_OK;
+   }
+   else if (result == WAIT_TIMEOUT)
+   {
+      return WORKER_WAIT_TIMEOUT;
+   }
+   return WORKER_WAIT_ERROR;
+#else
+   int result;
+   if (timeout_us < 0)
+   {
+      result = sem_wait(&self->semaphore);
+   }
+   else
+   {
+      struct timespec deadline;
+      clock_gettime(CLOCK_REALTIME, &deadline);
+      deadline.tv_sec += (time_t)(timeout_us / 1000000);
+      deadline.tv_nsec += (long)(timeout_us % 1000000) * 1000;
+      if (deadline.tv_nsec >= 1000000000L)
+      {
+         deadline.tv_sec++;
+         deadline.tv_nsec -= 1000000000L;
+      }
+      do
+      {
+         result = sem_timedwait(&self->semaphore, &deadline);
+      } while ( (result != 0) && (errno == EINTR) );
+      if ( (result != 0) && (errno == ETIMEDOUT) )
+      {
+         return WORKER_WAIT_TIMEOUT;
+      }
+   }
+   return (result == 0) ? WORKER_WAIT_OK : WORKER_WAIT_ERROR;
+#endif
+}
+
+static int32_t get_flush_deadline(apx_connectionInterface_t const* connection)
+{
+   if ( (connection != NULL) && (connection->transmit_flush_deadline != NULL) )
+   {
+      return connection->transmit_flush_deadline(connection->arg);
+   }
+   return -1;
+}
 #endif //UNIT_TEST
\ No newline at end of file
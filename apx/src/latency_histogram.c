@@ -0,0 +1,153 @@
+/*****************************************************************************
+* \file      latency_histogram.c
+* \author    Conny Gustafsson
+* \date      2026-10-18
+* \brief     Log2 latency histogram
+*
+* Copyright (c) 2026 Conny Gustafsson
+* Permission is hereby granted, free of charge, to any person obtaining a copy of
+* this software and associated documentation files (the "Software"), to deal in
+* the Software without restriction, including without limitation the rights to
+* use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+* the Software, and to permit persons to whom the Software is furnished to do so,
+* subject to the following conditions:
+
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+* FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+* COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+* IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+* CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+******************************************************************************/
+//////////////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////////////
+#include <string.h>
+#include "apx/latency_histogram.h"
+#ifdef MEM_LEAK_CHECK
+#include "CMemLeak.h"
+#endif
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE CONSTANTS AND DATA TYPES
+//////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////////////
+static uint32_t bucket_index(uint32_t latency_us);
+static uint32_t bucket_upper_bound(uint32_t index);
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE VARIABLES
+//////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////
+// PUBLIC FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+void apx_latencyHistogram_create(apx_latencyHistogram_t* self)
+{
+   if (self != NULL)
+   {
+      memset(self, 0, sizeof(apx_latencyHistogram_t));
+   }
+}
+
+void apx_latencyHistogram_add(apx_latencyHistogram_t* self, uint32_t latency_us)
+{
+   if (self != NULL)
+   {
+      self->buckets[bucket_index(latency_us)]++;
+      self->num_samples++;
+      if (latency_us > self->max_us)
+      {
+         self->max_us = latency_us;
+      }
+   }
+}
+
+uint32_t apx_latencyHistogram_num_samples(apx_latencyHistogram_t const* self)
+{
+   if (self != NULL)
+   {
+      return self->num_samples;
+   }
+   return 0u;
+}
+
+uint32_t apx_latencyHistogram_max(apx_latencyHistogram_t const* self)
+{
+   if (self != NULL)
+   {
+      return self->max_us;
+   }
+   return 0u;
+}
+
+/**
+ * Returns an upper bound of the given percentile (0-100) in microseconds. Returns 0 when there are no samples.
+ */
+uint32_t apx_latencyHistogram_percentile(apx_latencyHistogram_t const* self, uint32_t percent)
+{
+   if ( (self != NULL) && (self->num_samples > 0u) )
+   {
+      uint64_t target;
+      uint64_t count = 0u;
+      uint32_t i;
+      if (percent > 100u)
+      {
+         percent = 100u;
+      }
+      target = (((uint64_t)self->num_samples * percent) + 99u) / 100u;
+      if (target == 0u)
+      {
+         target = 1u;
+      }
+      for (i = 0u; i < APX_LATENCY_HISTOGRAM_NUM_BUCKETS; i++)
+      {
+         count += self->buckets[i];
+         if (count >= target)
+         {
+            uint32_t const upper_bound = bucket_upper_bound(i);
+            return (upper_bound < self->max_us) ? upper_bound : self->max_us;
+         }
+      }
+      return self->max_us;
+   }
+   return 0u;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+/*
+* Number of significant bits in latency_us
+*/
+static uint32_t bucket_index(uint32_t latency_us)
+{
+   uint32_t index = 0u;
+   while (latency_us != 0u)
+   {
+      index++;
+      latency_us >>= 1;
+   }
+   return index;
+}
+
+static uint32_t bucket_upper_bound(uint32_t index)
+{
+   if (index == 0u)
+   {
+      return 0u;
+   }
+   if (index >= 32u)
+   {
+      return UINT32_MAX;
+   }
+   return (((uint32_t)1u) << index) - 1u;
+}
@@ -1,5 +1,5 @@
 /*****************************************************************************
-* \file      file_cache.c
+* \file      node_cache.c
 * \author    Conny Gustafsson
 * \date      2018-08-03
 * \brief     Handles locally cached .apx files
@@ -26,7 +26,14 @@
 //////////////////////////////////////////////////////////////////////////////
 // INCLUDES
 //////////////////////////////////////////////////////////////////////////////
+#include <malloc.h>
+#include <string.h>
+#include <assert.h>
 #include "apx/node_cache.h"
+#include "sha256.h"
+#ifdef MEM_LEAK_CHECK
+#include "CMemLeak.h"
+#endif
 
 //////////////////////////////////////////////////////////////////////////////
 // PRIVATE CONSTANTS AND DATA TYPES
@@ -35,6 +42,11 @@
 //////////////////////////////////////////////////////////////////////////////
 // PRIVATE FUNCTION PROTOTYPES
 //////////////////////////////////////////////////////////////////////////////
+static apx_nodeCacheEntry_t* entry_new(uint8_t const* digest, uint8_t const* definition_data, apx_size_t definition_size);
+static void entry_delete(apx_nodeCacheEntry_t* entry);
+static apx_nodeCacheEntry_t* find_entry(apx_nodeCache_t* self, uint8_t const* digest, apx_size_t definition_size);
+static void touch_entry(apx_nodeCache_t* self, apx_nodeCacheEntry_t* entry);
+static void evict_entries(apx_nodeCache_t* self, apx_size_t required_size);
 
 //////////////////////////////////////////////////////////////////////////////
 // PUBLIC VARIABLES
@@ -49,28 +61,219 @@
 //////////////////////////////////////////////////////////////////////////////
 void apx_nodeCache_create(apx_nodeCache_t* self, apx_mode_t mode)
 {
-   (void)self;
-   (void)mode;
+   if (self != NULL)
+   {
+      adt_ary_create(&self->entries, NULL);
+      self->total_size = 0u;
+      self->max_size = APX_NODE_CACHE_DEFAULT_MAX_SIZE;
+      self->mode = mode;
+      MUTEX_INIT(self->lock);
+   }
 }
 
 void apx_nodeCache_destroy(apx_nodeCache_t* self)
 {
-   (void)self;
+   if (self != NULL)
+   {
+      int32_t i;
+      int32_t const num_entries = adt_ary_length(&self->entries);
+      for (i = 0; i < num_entries; i++)
+      {
+         entry_delete((apx_nodeCacheEntry_t*)adt_ary_value(&self->entries, i));
+      }
+      adt_ary_destroy(&self->entries);
+      MUTEX_DESTROY(self->lock);
+   }
 }
 
 apx_nodeCache_t* apx_nodeCache_new(apx_mode_t mode)
 {
-   (void)mode;
-   return NULL;
+   apx_nodeCache_t* self = (apx_nodeCache_t*)malloc(sizeof(apx_nodeCache_t));
+   if (self != NULL)
+   {
+      apx_nodeCache_create(self, mode);
+   }
+   return self;
 }
 
 void apx_nodeCache_delete(apx_nodeCache_t* self)
 {
-   (void)self;
+   if (self != NULL)
+   {
+      apx_nodeCache_destroy(self);
+      free(self);
+   }
+}
+
+void apx_nodeCache_set_max_size(apx_nodeCache_t* self, apx_size_t max_size)
+{
+   if (self != NULL)
+   {
+      MUTEX_LOCK(self->lock);
+      self->max_size = max_size;
+      evict_entries(self, 0u);
+      MUTEX_UNLOCK(self->lock);
+   }
+}
+
+apx_size_t apx_nodeCache_length(apx_nodeCache_t* self)
+{
+   apx_size_t retval = 0u;
+   if (self != NULL)
+   {
+      MUTEX_LOCK(self->lock);
+      retval = (apx_size_t)adt_ary_length(&self->entries);
+      MUTEX_UNLOCK(self->lock);
+   }
+   return retval;
+}
+
+apx_error_t apx_nodeCache_insert(apx_nodeCache_t* self, uint8_t const* definition_data, apx_size_t definition_size)
+{
+   if ((self != NULL) && (definition_data != NULL) && (definition_size > 0u))
+   {
+      apx_error_t retval = APX_NO_ERROR;
+      apx_nodeCacheEntry_t* entry;
+      uint8_t digest[RMF_SHA256_SIZE];
+      sha256_calc(&digest[0], definition_data, (size_t)definition_size);
+      MUTEX_LOCK(self->lock);
+      entry = find_entry(self, &digest[0], definition_size);
+      if (entry != NULL)
+      {
+         touch_entry(self, entry);
+      }
+      else if (definition_size <= self->max_size)
+      {
+         evict_entries(self, definition_size);
+         entry = entry_new(&digest[0], definition_data, definition_size);
+         if (entry == NULL)
+         {
+            retval = APX_MEM_ERROR;
+         }
+         else if (adt_ary_push(&self->entries, entry) != ADT_NO_ERROR)
+         {
+            entry_delete(entry);
+            retval = APX_MEM_ERROR;
+         }
+         else
+         {
+            self->total_size += definition_size;
+         }
+      }
+      else
+      {
+         //Definitions larger than the cache itself are never stored
+      }
+      MUTEX_UNLOCK(self->lock);
+      return retval;
+   }
+   return APX_INVALID_ARGUMENT_ERROR;
+}
+
+bool apx_nodeCache_contains(apx_nodeCache_t* self, uint8_t const* digest, apx_size_t definition_size)
+{
+   bool retval = false;
+   if ((self != NULL) && (digest != NULL))
+   {
+      MUTEX_LOCK(self->lock);
+      retval = (find_entry(self, digest, definition_size) != NULL);
+      MUTEX_UNLOCK(self->lock);
+   }
+   return retval;
+}
+
+uint8_t* apx_nodeCache_take_definition_copy(apx_nodeCache_t* self, uint8_t const* digest, apx_size_t definition_size)
+{
+   uint8_t* retval = NULL;
+   if ((self != NULL) && (digest != NULL) && (definition_size > 0u))
+   {
+      apx_nodeCacheEntry_t* entry;
+      MUTEX_LOCK(self->lock);
+      entry = find_entry(self, digest, definition_size);
+      if (entry != NULL)
+      {
+         retval = (uint8_t*)malloc(definition_size);
+         if (retval != NULL)
+         {
+            memcpy(retval, entry->definition_data, definition_size);
+            touch_entry(self, entry);
+         }
+      }
+      MUTEX_UNLOCK(self->lock);
+   }
+   return retval;
 }
 
 //////////////////////////////////////////////////////////////////////////////
 // PRIVATE FUNCTIONS
 //////////////////////////////////////////////////////////////////////////////
 
+static apx_nodeCacheEntry_t* entry_new(uint8_t const* digest, uint8_t const* definition_data, apx_size_t definition_size)
+{
+   apx_nodeCacheEntry_t* entry = (apx_nodeCacheEntry_t*)malloc(sizeof(apx_nodeCacheEntry_t));
+   if (entry != NULL)
+   {
+      entry->definition_data = (uint8_t*)malloc(definition_size);
+      if (entry->definition_data == NULL)
+      {
+         free(entry);
+         return NULL;
+      }
+      memcpy(entry->digest, digest, RMF_SHA256_SIZE);
+      memcpy(entry->definition_data, definition_data, definition_size);
+      entry->definition_size = definition_size;
+   }
+   return entry;
+}
+
+static void entry_delete(apx_nodeCacheEntry_t* entry)
+{
+   if (entry != NULL)
+   {
+      free(entry->definition_data);
+      free(entry);
+   }
+}
 
+/**
+ * Must be called while holding the lock.
+ */
+static apx_nodeCacheEntry_t* find_entry(apx_nodeCache_t* self, uint8_t const* digest, apx_size_t definition_size)
+{
+   int32_t i;
+   int32_t const num_entries = adt_ary_length(&self->entries);
+   for (i = num_entries - 1; i >= 0; i--)
+   {
+      apx_nodeCacheEntry_t* entry = (apx_nodeCacheEntry_t*)adt_ary_value(&self->entries, i);
+      assert(entry != NULL);
+      if ((entry->definition_size == definition_size) && (memcmp(entry->digest, digest, RMF_SHA256_SIZE) == 0))
+      {
+         return entry;
+      }
+   }
+   return NULL;
+}
+
+/**
+ * Moves entry to the most recently used end. Must be called while holding the lock.
+ */
+static void touch_entry(apx_nodeCache_t* self, apx_nodeCacheEntry_t* entry)
+{
+   adt_ary_remove(&self->entries, entry);
+   (void)adt_ary_push(&self->entries, entry);
+}
+
+/**
+ * Evicts least recently used entries until required_size more bytes fits. Must be called while holding the lock.
+ */
+static void evict_entries(apx_nodeCache_t* self, apx_size_t required_size)
+{
+   while ((adt_ary_length(&self->entries) > 0) && (self->total_size + required_size > self->max_size))
+   {
+      apx_nodeCacheEntry_t* entry = (apx_nodeCacheEntry_t*)adt_ary_value(&self->entries, 0);
+      assert(entry != NULL);
+      adt_ary_remove(&self->entries, entry);
+      self->total_size -= entry->definition_size;
+      entry_delete(entry);
+   }
+}
@@ -330,6 +330,31 @@ apx_error_t apx_nodeData_write_provide_port_data(apx_nodeData_t* self, apx_size_
    return APX_INVALID_ARGUMENT_ERROR;
 }
 
+/**
+ * Same as apx_nodeData_write_provide_port_data but leaves the buffer untouched and sets is_changed to false
+ * when the stored bytes are already identical to src.
+ */
+apx_error_t apx_nodeData_update_provide_port_data(apx_nodeData_t* self, apx_size_t offset, uint8_t const* src, apx_size_t size, bool* is_changed)
+{
+   if ( (self != NULL) && (is_changed != NULL) )
+   {
+      MUTEX_LOCK(self->lock);
+      if (((size_t)offset + size) > self->provide_port_data_size)
+      {
+         MUTEX_UNLOCK(self->lock);
+         return APX_INVALID_ARGUMENT_ERROR;
+      }
+      *is_changed = (memcmp(self->provide_port_data + offset, src, size) != 0);
+      if (*is_changed)
+      {
+         memcpy(self->provide_port_data + offset, src, size);
+      }
+      MUTEX_UNLOCK(self->lock);
+      return APX_NO_ERROR;
+   }
+   return APX_INVALID_ARGUMENT_ERROR;
+}
+
 apx_error_t apx_nodeData_read_provide_port_data(apx_nodeData_t* self, apx_size_t offset, uint8_t* dest, apx_size_t size)
 {
    if (self != NULL)
@@ -35,6 +35,7 @@
 #include "apx/node_manager.h"
 #include "apx/server.h"
 #include "apx/util.h"
+#include "apx/binary_definition.h"
 #include "sha256.h"
 
 #ifdef MEM_LEAK_CHECK
@@ -47,6 +48,19 @@
 //////////////////////////////////////////////////////////////////////////////
 #define STACK_DATA_BUF_SIZE 256 //Bytes to allocate on stack before attempting malloc
 
+//One provide port value being routed to a list of connectors, shared by all fan-out slices
+typedef struct apx_connectorFanout_tag
+{
+   apx_portConnectorList_t* port_connectors;
+   apx_size_t provide_port_data_size;
+   apx_size_t value_size; //Shorter than provide_port_data_size for values of dynamic array ports and partial writes
+   apx_size_t data_offset; //Byte offset of provide_data within the port, non-zero for partial writes
+   bool is_partial; //provide_data only covers the byte range [data_offset, data_offset + value_size) of the port
+   apx_portInstance_t* provide_port;
+   uint8_t const* provide_data;
+   apx_rateLimiter_t* rate_limiter; //NULL when require ports are always written directly
+} apx_connectorFanout_t;
+
 //////////////////////////////////////////////////////////////////////////////
 // PRIVATE FUNCTION PROTOTYPES
 //////////////////////////////////////////////////////////////////////////////
@@ -54,6 +68,7 @@ static apx_error_t calc_init_data_size(apx_portInstance_t* port_list, apx_size_t
 static apx_error_t create_definition_file_info(apx_nodeInstance_t* self, rmf_fileInfo_t* file_info);
 static apx_error_t create_provide_port_data_file_info(apx_nodeInstance_t* self, rmf_fileInfo_t* file_info);
 static apx_error_t create_require_port_data_file_info(apx_nodeInstance_t* self, rmf_fileInfo_t* file_info);
+static rmf_fileType_t get_port_data_file_type(apx_portInstance_t const* port_list, apx_size_t num_ports);
 static apx_error_t file_open_notify(apx_nodeInstance_t* self, apx_file_t *file);
 static apx_error_t send_definition_data_to_file_manager(apx_nodeInstance_t* self, apx_fileManager_t* file_manager, uint32_t address);
 static apx_error_t send_provide_port_data_to_file_manager(apx_nodeInstance_t* self, apx_fileManager_t* file_manager, uint32_t address);
@@ -70,12 +85,23 @@ static apx_error_t request_remote_provide_port_data(apx_nodeInstance_t* self, ap
 static apx_error_t request_remote_require_port_data(apx_nodeInstance_t* self, apx_file_t* file);
 static apx_error_t connect_require_ports_to_server(apx_nodeInstance_t* self);
 static apx_error_t remove_provide_port_connector(apx_nodeInstance_t* self, apx_portId_t provide_port_id, apx_portInstance_t* require_port);
-static apx_error_t route_provide_port_data_change_to_receivers(apx_nodeInstance_t* self, uint32_t provide_data_offset, const uint8_t* provide_data, apx_size_t provide_data_size);
+static apx_error_t route_provide_port_data_change_to_receivers(apx_nodeInstance_t* self, uint32_t provide_data_offset, const uint8_t* provide_data, apx_size_t provide_data_size, bool change_only);
+static apx_error_t route_provide_port_data_to_connectors(apx_nodeInstance_t* self, apx_portInstance_t* provide_port, apx_size_t data_offset, const uint8_t* provide_data, apx_size_t value_size);
+static apx_error_t route_provide_port_data_to_connector_range(void* arg, int32_t begin, int32_t end);
+static apx_error_t post_complete_provide_port_value(apx_portInstance_t* provide_port, apx_routingEngine_t* routing_engine, apx_rateLimiter_t* rate_limiter, apx_portInstance_t* require_port);
 static apx_error_t route_provide_port_data_to_require_port(apx_portInstance_t* provide_port, apx_portInstance_t* require_port, bool do_remote_routing);
-static apx_error_t remote_route_require_port_data(apx_nodeInstance_t* self, uint32_t offset, uint8_t const* data, apx_size_t size);
+static apx_error_t remote_route_require_port_data(apx_nodeInstance_t* self, uint32_t offset, uint8_t const* data, apx_size_t size, bool is_high_priority);
+static apx_error_t post_require_port_data(apx_nodeInstance_t* self, uint32_t offset, uint8_t const* data, apx_size_t size, bool is_high_priority);
+static apx_size_t require_port_transmit_size(apx_nodeInstance_t* self, apx_file_t* file, uint32_t offset, apx_size_t size);
+static bool is_partial_write_agreed(apx_nodeInstance_t* self);
+static apx_error_t post_require_port_queued_data(apx_portInstance_t* require_port, uint8_t const* data, apx_size_t size);
+static apx_error_t file_local_write_notify(apx_nodeInstance_t* self, apx_file_t* file, uint32_t offset, const uint8_t* data, apx_size_t size);
 static apx_error_t remote_route_provide_port_data(apx_nodeInstance_t* self, uint32_t offset, uint8_t const* data, apx_size_t size);
-static apx_error_t remote_route_data_to_file(apx_file_t* file, uint32_t offset, uint8_t const* data, apx_size_t size);
+static apx_error_t remote_route_data_to_file(apx_file_t* file, uint32_t offset, uint8_t const* data, apx_size_t size, bool is_high_priority);
+static apx_portInstance_t* find_port_by_offset(apx_portInstance_t* port_list, apx_size_t num_ports, uint32_t offset);
 static apx_error_t trigger_require_port_write_callbacks(apx_nodeInstance_t* self, uint32_t offset, const uint8_t* data, apx_size_t size);
+static apx_error_t trigger_require_port_write_callback_from_node_data(apx_nodeInstance_t* self, apx_portInstance_t* port_instance);
+static bool is_valid_port_value(apx_portInstance_t const* port, uint8_t const* data, apx_size_t size);
 
 //////////////////////////////////////////////////////////////////////////////
 // PRIVATE VARIABLES
@@ -117,6 +143,7 @@ void apx_nodeInstance_create(apx_nodeInstance_t* self, apx_mode_t mode, char con
       self->definition_file = NULL;
       self->provide_port_data_file = NULL;
       self->require_port_data_file = NULL;
+      self->change_only_routing = false;
       MUTEX_INIT(self->lock);
    }
 }
@@ -126,6 +153,10 @@ void apx_nodeInstance_destroy(apx_nodeInstance_t *self)
    if (self != 0)
    {
 
+      if (self->server != NULL)
+      {
+         apx_rateLimiter_remove_node(apx_server_get_rate_limiter(self->server), self);
+      }
       if (self->name != NULL) free(self->name);
       if (self->connector_table != NULL)
       {
@@ -345,6 +376,8 @@ apx_error_t apx_nodeInstance_alloc_port_instance_memory(apx_nodeInstance_t* self
          {
             return APX_MEM_ERROR;
          }
+         //Ports not yet created when building the node fails must be safe to destroy
+         memset(self->provide_ports, 0, num_provide_ports * sizeof(apx_portInstance_t));
       }
       if (num_require_ports > 0u)
       {
@@ -353,6 +386,7 @@ apx_error_t apx_nodeInstance_alloc_port_instance_memory(apx_nodeInstance_t* self
          {
             return APX_MEM_ERROR;
          }
+         memset(self->require_ports, 0, num_require_ports * sizeof(apx_portInstance_t));
       }
    }
    return APX_NO_ERROR;
@@ -635,6 +669,18 @@ apx_bytePortMap_t const* apx_nodeInstance_get_byte_port_map(apx_nodeInstance_t c
    return NULL;
 }
 
+/**
+ * Precompiled definitions are published using their own file extension
+ */
+char const* apx_nodeInstance_get_definition_file_extension(apx_nodeInstance_t const* self)
+{
+   if (apx_binaryDefinition_is_binary(apx_nodeInstance_get_definition_data(self), apx_nodeInstance_get_definition_size(self)))
+   {
+      return APX_BINARY_DEFINITION_FILE_EXT;
+   }
+   return APX_DEFINITION_FILE_EXT;
+}
+
 apx_dataState_t apx_nodeInstance_get_definition_data_state(apx_nodeInstance_t const* self)
 {
    if (self != NULL)
@@ -783,6 +829,14 @@ apx_error_t apx_nodeInstance_remote_file_published_notification(apx_nodeInstance
          set_file_notification_handler(self, file);
          retval = request_remote_require_port_data(self, file);
          break;
+      case APX_PROVIDE_PORT_DATA_FILE_TYPE:
+         //Node was built before its provide port data file was published (definition taken from node cache)
+         if ((self->mode == APX_SERVER_MODE) && (self->provide_port_data_state == APX_DATA_STATE_WAITING_FILE_INFO))
+         {
+            set_file_notification_handler(self, file);
+            retval = request_remote_provide_port_data(self, file);
+         }
+         break;
       default:
          retval = APX_NOT_IMPLEMENTED_ERROR;
       }
@@ -799,7 +853,7 @@ void apx_nodeInstance_set_server(apx_nodeInstance_t* self, struct apx_server_tag
    }
 }
 
-apx_error_t apx_nodeInstance_write_provide_port_data(apx_nodeInstance_t* self, apx_size_t offset, uint8_t* data, apx_size_t size)
+apx_error_t apx_nodeInstance_write_provide_port_data(apx_nodeInstance_t* self, apx_size_t offset, uint8_t const* data, apx_size_t size)
 {
    if (self != NULL)
    {
@@ -827,6 +881,11 @@ apx_error_t apx_nodeInstance_vfile_write_notify(void* arg, apx_file_t* file, uin
    return file_write_notify((apx_nodeInstance_t*)arg, file, offset, data, size);
 }
 
+apx_error_t apx_nodeInstance_vfile_local_write_notify(void* arg, apx_file_t* file, uint32_t offset, uint8_t const* data, apx_size_t size)
+{
+   return file_local_write_notify((apx_nodeInstance_t*)arg, file, offset, data, size);
+}
+
 // Port Connector Change API
 apx_portConnectorChangeTable_t* apx_nodeInstance_get_require_port_connector_changes(apx_nodeInstance_t* self, bool auto_create)
 {
@@ -996,6 +1055,100 @@ apx_error_t apx_nodeInstance_handle_require_port_disconnected_from_provide_port(
    return APX_NO_ERROR;
 }
 
+/**
+ * Routes one provide port value to all require ports currently connected to it.
+ * Used by the routing engine, the value is not written into the provide port data of the node.
+ */
+apx_error_t apx_nodeInstance_route_provide_port_data(apx_portInstance_t* provide_port, uint8_t const* data, apx_size_t size)
+{
+   if ( (provide_port != NULL) && (provide_port->parent != NULL) && (data != NULL) )
+   {
+      apx_error_t retval;
+      apx_nodeInstance_t* provide_node = provide_port->parent;
+      if (!is_valid_port_value(provide_port, data, size))
+      {
+         return APX_VALUE_LENGTH_ERROR;
+      }
+      MUTEX_LOCK(provide_node->lock);
+      if (provide_node->connector_table != NULL)
+      {
+         retval = route_provide_port_data_to_connectors(provide_node, provide_port, 0u, data, size);
+      }
+      else
+      {
+         retval = APX_NULL_PTR_ERROR;
+      }
+      MUTEX_UNLOCK(provide_node->lock);
+      return retval;
+   }
+   return APX_INVALID_ARGUMENT_ERROR;
+}
+
+void apx_nodeInstance_set_change_only_routing(apx_nodeInstance_t* self, bool enabled)
+{
+   if (self != NULL)
+   {
+      MUTEX_LOCK(self->lock);
+      self->change_only_routing = enabled;
+      MUTEX_UNLOCK(self->lock);
+   }
+}
+
+/**
+ * Returns true when change-only routing is enabled for this node or for the entire server
+ */
+bool apx_nodeInstance_is_change_only_routing(apx_nodeInstance_t const* self)
+{
+   if (self != NULL)
+   {
+      return self->change_only_routing || apx_server_is_change_only_routing(self->server);
+   }
+   return false;
+}
+
+void apx_nodeInstance_get_routing_stats(apx_nodeInstance_t* self, apx_nodeInstanceRoutingStats_t* stats)
+{
+   if ( (self != NULL) && (stats != NULL) )
+   {
+      MUTEX_LOCK(self->lock);
+      memcpy(stats, &self->routing_stats, sizeof(apx_nodeInstanceRoutingStats_t));
+      MUTEX_UNLOCK(self->lock);
+   }
+}
+
+/**
+ * Returns number of queued elements that were dropped since the queue of a require port on this node was full.
+ */
+uint32_t apx_nodeInstance_get_num_queue_overflows(apx_nodeInstance_t* self)
+{
+   uint32_t retval = 0u;
+   if (self != NULL)
+   {
+      apx_size_t port_id;
+      for (port_id = 0u; port_id < self->num_require_ports; port_id++)
+      {
+         retval += apx_queuedPortRing_num_overflows(self->require_ports[port_id].queue_ring);
+      }
+   }
+   return retval;
+}
+
+/**
+ * Writes a routed value to a require port. Used by the rate limiter when a held back value is released.
+ */
+apx_error_t apx_nodeInstance_deliver_require_port_data(apx_portInstance_t* require_port, uint8_t const* data, apx_size_t size)
+{
+   if ( (require_port != NULL) && (require_port->parent != NULL) && (data != NULL) )
+   {
+      if (!is_valid_port_value(require_port, data, size))
+      {
+         return APX_VALUE_LENGTH_ERROR;
+      }
+      return post_require_port_data(require_port->parent, apx_portInstance_data_offset(require_port), data, size, require_port->is_high_priority);
+   }
+   return APX_INVALID_ARGUMENT_ERROR;
+}
+
 // ConnectorTable API
 apx_error_t apx_nodeInstance_build_connector_table(apx_nodeInstance_t* self)
 {
@@ -1027,6 +1180,27 @@ apx_error_t apx_nodeInstance_build_connector_table(apx_nodeInstance_t* self)
    return APX_INVALID_ARGUMENT_ERROR;
 }
 
+/**
+ * Creates the element rings of all queued require ports. Routed elements wait there until the connection of this node sends them.
+ */
+apx_error_t apx_nodeInstance_create_require_port_queues(apx_nodeInstance_t* self)
+{
+   if (self != NULL)
+   {
+      apx_size_t port_id;
+      for (port_id = 0u; port_id < self->num_require_ports; port_id++)
+      {
+         apx_error_t result = apx_portInstance_create_queue_ring(&self->require_ports[port_id]);
+         if (result != APX_NO_ERROR)
+         {
+            return result;
+         }
+      }
+      return APX_NO_ERROR;
+   }
+   return APX_INVALID_ARGUMENT_ERROR;
+}
+
 void apx_nodeInstance_lock_port_connector_table(apx_nodeInstance_t* self)
 {
    if (self != NULL)
@@ -1133,7 +1307,7 @@ static apx_error_t create_definition_file_info(apx_nodeInstance_t* self, rmf_fil
    uint8_t digest_data[RMF_SHA256_SIZE];
    uint32_t file_size = (uint32_t) apx_nodeData_definition_data_size(self->node_data);
    strcpy(file_name, self->name);
-   strcat(file_name, ".apx");
+   strcat(file_name, apx_nodeInstance_get_definition_file_extension(self));
 
    sha256_calc(&digest_data[0], apx_nodeInstance_get_definition_data(self), (size_t)apx_nodeInstance_get_definition_size(self));
    return rmf_fileInfo_create(file_info, RMF_INVALID_ADDRESS, file_size, file_name,
@@ -1147,7 +1321,7 @@ static apx_error_t create_provide_port_data_file_info(apx_nodeInstance_t* self,
    strcpy(file_name, self->name);
    strcat(file_name, APX_PROVIDE_PORT_DATA_EXT);
    return rmf_fileInfo_create(file_info, RMF_INVALID_ADDRESS, self->provide_port_init_data_size, file_name,
-      RMF_FILE_TYPE_FIXED, RMF_DIGEST_TYPE_NONE, NULL);
+      get_port_data_file_type(self->provide_ports, self->num_provide_ports), RMF_DIGEST_TYPE_NONE, NULL);
 }
 
 static apx_error_t create_require_port_data_file_info(apx_nodeInstance_t* self, rmf_fileInfo_t* file_info)
@@ -1157,7 +1331,36 @@ static apx_error_t create_require_port_data_file_info(apx_nodeInstance_t* self,
    strcpy(file_name, self->name);
    strcat(file_name, APX_REQUIRE_PORT_DATA_EXT);
    return rmf_fileInfo_create(file_info, RMF_INVALID_ADDRESS, self->require_port_init_data_size, file_name,
-      RMF_FILE_TYPE_FIXED, RMF_DIGEST_TYPE_NONE, NULL);
+      get_port_data_file_type(self->require_ports, self->num_require_ports), RMF_DIGEST_TYPE_NONE, NULL);
+}
+
+/**
+ * Port data files with dynamic array ports are published as dynamic files. Writes to such ports only carry the elements in use.
+ * The file type is selected by the widest array length header among the ports.
+ */
+static rmf_fileType_t get_port_data_file_type(apx_portInstance_t const* port_list, apx_size_t num_ports)
+{
+   uint32_t max_length_size = 0u;
+   apx_size_t i;
+   for (i = 0u; i < num_ports; i++)
+   {
+      uint32_t const length_size = apx_portInstance_dynamic_length_size(&port_list[i]);
+      if (length_size > max_length_size)
+      {
+         max_length_size = length_size;
+      }
+   }
+   switch (max_length_size)
+   {
+   case 0u:
+      return RMF_FILE_TYPE_FIXED;
+   case UINT8_SIZE:
+      return RMF_FILE_TYPE_DYNAMIC8;
+   case UINT16_SIZE:
+      return RMF_FILE_TYPE_DYNAMIC16;
+   default:
+      return RMF_FILE_TYPE_DYNAMIC32;
+   }
 }
 
 static apx_error_t file_open_notify(apx_nodeInstance_t* self, apx_file_t* file)
@@ -1225,7 +1428,7 @@ static apx_error_t send_provide_port_data_to_file_manager(apx_nodeInstance_t* se
    {
       return APX_MEM_ERROR;
    }
-   return apx_fileManager_send_local_data(file_manager, address, snapshot, provide_port_data_size);
+   return apx_fileManager_send_local_snapshot(file_manager, address, snapshot, provide_port_data_size);
 }
 
 static apx_error_t send_require_port_data_to_file_manager(apx_nodeInstance_t* self, apx_fileManager_t* file_manager, uint32_t address)
@@ -1236,7 +1439,7 @@ static apx_error_t send_require_port_data_to_file_manager(apx_nodeInstance_t* se
    {
       return APX_MEM_ERROR;
    }
-   return apx_fileManager_send_local_data(file_manager, address, snapshot, require_port_data_size);
+   return apx_fileManager_send_local_snapshot(file_manager, address, snapshot, require_port_data_size);
 }
 
 
@@ -1250,6 +1453,7 @@ static void set_file_notification_handler(apx_nodeInstance_t* self, apx_file_t*
    handler.open_notify = apx_nodeInstance_vfile_open_notify;
    handler.close_notify = apx_nodeInstance_vfile_close_notify;
    handler.write_notify = apx_nodeInstance_vfile_write_notify;
+   handler.local_write_notify = apx_nodeInstance_vfile_local_write_notify;
    apx_file_set_notification_handler(file, &handler);
 }
 
@@ -1280,6 +1484,18 @@ static apx_error_t file_write_notify(apx_nodeInstance_t* self, apx_file_t* file,
    return retval;
 }
 
+/**
+ * Called on the thread of the connection that owns the file, just before data routed to it is sent.
+ */
+static apx_error_t file_local_write_notify(apx_nodeInstance_t* self, apx_file_t* file, uint32_t offset, const uint8_t* data, apx_size_t size)
+{
+   if ( (self->mode == APX_SERVER_MODE) && (apx_file_get_apx_file_type(file) == APX_REQUIRE_PORT_DATA_FILE_TYPE) )
+   {
+      return apx_nodeData_write_require_port_data(self->node_data, offset, data, size);
+   }
+   return APX_UNSUPPORTED_ERROR;
+}
+
 static apx_error_t process_remote_write_definition_data(apx_nodeInstance_t* self, uint32_t offset, const uint8_t* data, apx_size_t size)
 {
    if (self->definition_data_state == APX_DATA_STATE_WAITING_FOR_FILE_DATA)
@@ -1358,10 +1574,18 @@ static apx_error_t process_remote_write_provide_port_data(apx_nodeInstance_t* se
    case APX_DATA_STATE_CONNECTED:
       if (self->server != NULL)
       {
-         retval = apx_nodeData_write_provide_port_data(node_data, offset, data, size);
-         if (retval == APX_NO_ERROR)
+         if (apx_nodeInstance_is_change_only_routing(self))
          {
-            retval = route_provide_port_data_change_to_receivers(self, offset, data, size);
+            //Each port value is compared and stored by the router, only values that changed are routed
+            retval = route_provide_port_data_change_to_receivers(self, offset, data, size, true);
+         }
+         else
+         {
+            retval = apx_nodeData_write_provide_port_data(node_data, offset, data, size);
+            if (retval == APX_NO_ERROR)
+            {
+               retval = route_provide_port_data_change_to_receivers(self, offset, data, size, false);
+            }
          }
       }
       break;
@@ -1518,13 +1742,26 @@ static apx_error_t connect_require_ports_to_server(apx_nodeInstance_t* self)
    return retval;
 }
 
-static apx_error_t route_provide_port_data_change_to_receivers(apx_nodeInstance_t* self, uint32_t provide_data_offset, const uint8_t* provide_data, apx_size_t provide_data_size)
+/*
+* When change_only is true the caller has not yet written the data to node_data. Each port value is then compared
+* against (and written to) node_data and values that did not change are not routed. Queued ports are always routed.
+* A write that starts or ends inside a port is a partial write, only the written byte range of that port is routed.
+*/
+static apx_error_t route_provide_port_data_change_to_receivers(apx_nodeInstance_t* self, uint32_t provide_data_offset, const uint8_t* provide_data, apx_size_t provide_data_size, bool change_only)
 {
    apx_error_t retval = APX_NO_ERROR;
    uint32_t end_offset = provide_data_offset + provide_data_size;
+   uint64_t num_routed_bytes = 0u;
+   uint64_t num_suppressed_bytes = 0u;
+   uint32_t num_suppressed_values = 0u;
+   //When routing is sharded each port value is handed over to the shard that owns its signature
+   apx_routingEngine_t* routing_engine = apx_server_get_routing_engine(self->server);
    assert(self->connector_table != NULL);
    assert(self->byte_port_map != NULL);
-   MUTEX_LOCK(self->lock);
+   if (routing_engine == NULL)
+   {
+      MUTEX_LOCK(self->lock);
+   }
    while (provide_data_offset < end_offset)
    {
       apx_portId_t provide_port_id;
@@ -1544,37 +1781,90 @@ static apx_error_t route_provide_port_data_change_to_receivers(apx_nodeInstance_
       provide_port = apx_nodeInstance_get_provide_port(self, provide_port_id);
       if (provide_port != NULL)
       {
-         apx_portConnectorList_t* port_connectors;
-         int32_t num_connectors;
-         int32_t connector_id;
          apx_size_t provide_port_data_size = apx_portInstance_data_size(provide_port);
+         apx_size_t const port_offset = apx_portInstance_data_offset(provide_port);
+         apx_size_t const port_end_offset = port_offset + provide_port_data_size;
+         apx_size_t const data_offset = provide_data_offset - port_offset;
+         apx_size_t write_size = provide_port_data_size;
+         apx_size_t value_size = provide_port_data_size;
+         bool const is_partial = (data_offset > 0u) || ( (end_offset < port_end_offset) && !apx_portInstance_is_dynamic_array(provide_port) );
+         bool is_changed = true;
          assert(provide_port_data_size > 0u);
-         port_connectors = &self->connector_table[provide_port_id];
-         num_connectors = apx_portConnectorList_length(port_connectors);
-         for (connector_id = 0; connector_id < num_connectors; connector_id++)
+         if (is_partial)
+         {
+            if (apx_portInstance_queue_length(provide_port) > 0u)
+            {
+               fprintf(stderr, "[APX_NODE_INSTANCE] blocked partial write to queued port on offset %u\n", provide_data_offset);
+               retval = APX_INVALID_WRITE_ERROR;
+               break;
+            }
+            write_size = ( (end_offset < port_end_offset) ? end_offset : port_end_offset) - provide_data_offset;
+            value_size = write_size;
+         }
+         else if (apx_portInstance_is_dynamic_array(provide_port))
+         {
+            //Only the elements in use are routed. The last value of a write can end right after its last element.
+            apx_size_t const remaining_size = end_offset - provide_data_offset;
+            if (remaining_size < provide_port_data_size)
+            {
+               write_size = remaining_size;
+            }
+            value_size = apx_portInstance_current_data_size(provide_port, provide_data, remaining_size);
+            if ( (value_size == 0u) || (value_size > write_size) || ( (write_size < provide_port_data_size) && (value_size != write_size) ) )
+            {
+               fprintf(stderr, "[APX_NODE_INSTANCE] blocked write with invalid array length on offset %u\n", provide_data_offset);
+               retval = APX_INVALID_WRITE_ERROR;
+               break;
+            }
+         }
+         if (change_only)
          {
-            apx_portInstance_t* require_port = apx_portConnectorList_get(port_connectors, connector_id);
-            assert( (require_port != NULL) && (require_port->parent != NULL));
             if (apx_portInstance_queue_length(provide_port) == 0u)
             {
-               apx_size_t require_port_data_size = apx_portInstance_data_size(require_port);
-               if (provide_port_data_size != require_port_data_size)
-               {
-                  retval = APX_VALUE_LENGTH_ERROR;
-               }
-               else
-               {
-                  apx_size_t require_data_offset = apx_portInstance_data_offset(require_port);
-                  retval = remote_route_require_port_data(require_port->parent, require_data_offset, provide_data, provide_port_data_size);
-               }
+               retval = apx_nodeData_update_provide_port_data(self->node_data, provide_data_offset, provide_data, write_size, &is_changed);
             }
             else
             {
-               retval = APX_NOT_IMPLEMENTED_ERROR;
+               retval = apx_nodeData_write_provide_port_data(self->node_data, provide_data_offset, provide_data, write_size);
+            }
+            if (retval != APX_NO_ERROR)
+            {
+               break;
             }
          }
-         provide_data_offset += provide_port_data_size;
-         provide_data += provide_port_data_size;
+         if (!is_changed)
+         {
+            num_suppressed_bytes += value_size;
+            num_suppressed_values++;
+         }
+         else if (routing_engine != NULL)
+         {
+            if (is_partial)
+            {
+               //Shards route complete port values, the written range has already been merged into node_data
+               retval = post_complete_provide_port_value(provide_port, routing_engine, NULL, NULL);
+            }
+            else
+            {
+               retval = apx_routingEngine_post(routing_engine, provide_port, provide_data, value_size);
+            }
+            num_routed_bytes += value_size;
+         }
+         else
+         {
+            retval = route_provide_port_data_to_connectors(self, provide_port, data_offset, provide_data, value_size);
+            num_routed_bytes += value_size;
+         }
+         if (is_partial)
+         {
+            provide_data_offset += write_size;
+            provide_data += write_size;
+         }
+         else
+         {
+            provide_data_offset += provide_port_data_size;
+            provide_data += provide_port_data_size;
+         }
       }
       else
       {
@@ -1582,10 +1872,151 @@ static apx_error_t route_provide_port_data_change_to_receivers(apx_nodeInstance_
          retval = APX_INTERNAL_ERROR;
       }
    }
+   if (routing_engine != NULL)
+   {
+      MUTEX_LOCK(self->lock);
+   }
+   self->routing_stats.num_routed_bytes += num_routed_bytes;
+   self->routing_stats.num_suppressed_bytes += num_suppressed_bytes;
+   self->routing_stats.num_suppressed_values += num_suppressed_values;
    MUTEX_UNLOCK(self->lock);
    return retval;
 }
 
+/*
+* Note: Caller must take self->lock before calling this function
+*/
+static apx_error_t route_provide_port_data_to_connectors(apx_nodeInstance_t* self, apx_portInstance_t* provide_port, apx_size_t data_offset, const uint8_t* provide_data, apx_size_t value_size)
+{
+   apx_connectorFanout_t fanout;
+   apx_fanoutPool_t* fanout_pool;
+   int32_t num_connectors;
+   fanout.port_connectors = &self->connector_table[apx_portInstance_port_id(provide_port)];
+   fanout.provide_port_data_size = apx_portInstance_data_size(provide_port);
+   fanout.value_size = value_size;
+   fanout.data_offset = data_offset;
+   fanout.is_partial = (data_offset > 0u) || ( (value_size < fanout.provide_port_data_size) && !apx_portInstance_is_dynamic_array(provide_port) );
+   fanout.provide_port = provide_port;
+   fanout.provide_data = provide_data;
+   fanout.rate_limiter = apx_server_get_rate_limiter(self->server);
+   num_connectors = apx_portConnectorList_length(fanout.port_connectors);
+   if (num_connectors == 0)
+   {
+      return APX_NO_ERROR;
+   }
+   //Large connector lists are split across the fan-out workers. The run returns when every slice is done so the
+   //next value of this port cannot overtake this one on any require port.
+   fanout_pool = apx_server_get_fanout_pool(self->server);
+   if (fanout_pool != NULL)
+   {
+      return apx_fanoutPool_run(fanout_pool, num_connectors, route_provide_port_data_to_connector_range, (void*)&fanout);
+   }
+   return route_provide_port_data_to_connector_range((void*)&fanout, 0, num_connectors);
+}
+
+/*
+* Note: Runs concurrently for disjoint ranges when fan-out is parallel. Only reads the connector list (protected by the provider lock).
+*/
+static apx_error_t route_provide_port_data_to_connector_range(void* arg, int32_t begin, int32_t end)
+{
+   apx_error_t retval = APX_NO_ERROR;
+   apx_connectorFanout_t const* fanout = (apx_connectorFanout_t const*)arg;
+   int32_t connector_id;
+   for (connector_id = begin; connector_id < end; connector_id++)
+   {
+      apx_error_t result;
+      apx_portInstance_t* require_port = apx_portConnectorList_get(fanout->port_connectors, connector_id);
+      assert( (require_port != NULL) && (require_port->parent != NULL));
+      if (fanout->provide_port_data_size != apx_portInstance_data_size(require_port))
+      {
+         result = APX_VALUE_LENGTH_ERROR;
+      }
+      else if (require_port->queue_ring != NULL)
+      {
+         //Queued elements are never rate limited since that would coalesce them
+         result = fanout->is_partial ? APX_INVALID_WRITE_ERROR : post_require_port_queued_data(require_port, fanout->provide_data, fanout->value_size);
+      }
+      else if ( (fanout->rate_limiter != NULL) && (apx_portInstance_min_update_interval(require_port) > 0u) )
+      {
+         if (fanout->is_partial)
+         {
+            //The rate limiter holds back complete values
+            result = post_complete_provide_port_value(fanout->provide_port, NULL, fanout->rate_limiter, require_port);
+         }
+         else
+         {
+            result = apx_rateLimiter_submit(fanout->rate_limiter, require_port, fanout->provide_data, fanout->value_size);
+         }
+      }
+      else if (fanout->is_partial && !is_partial_write_agreed(require_port->parent))
+      {
+         result = post_complete_provide_port_value(fanout->provide_port, NULL, NULL, require_port);
+      }
+      else
+      {
+         apx_size_t require_data_offset = apx_portInstance_data_offset(require_port) + fanout->data_offset;
+         result = post_require_port_data(require_port->parent, require_data_offset, fanout->provide_data, fanout->value_size, require_port->is_high_priority);
+      }
+      if (result != APX_NO_ERROR)
+      {
+         retval = result;
+      }
+   }
+   return retval;
+}
+
+/*
+* Reads the complete value of a provide port from node_data and hands it to the routing engine or, when require_port
+* is given, to the rate limiter (or straight to require_port when there is no rate limiter).
+* Used for partial writes where only a byte range of the value was written.
+*/
+static apx_error_t post_complete_provide_port_value(apx_portInstance_t* provide_port, apx_routingEngine_t* routing_engine, apx_rateLimiter_t* rate_limiter, apx_portInstance_t* require_port)
+{
+   apx_error_t retval;
+   uint8_t stack_data_buffer[STACK_DATA_BUF_SIZE];
+   apx_size_t const provide_port_data_size = apx_portInstance_data_size(provide_port);
+   apx_size_t value_size;
+   uint8_t* provide_port_data = &stack_data_buffer[0];
+   bool use_heap_data = provide_port_data_size > STACK_DATA_BUF_SIZE ? true : false;
+   if (use_heap_data)
+   {
+      provide_port_data = (uint8_t*)malloc(provide_port_data_size);
+      if (provide_port_data == NULL)
+      {
+         return APX_MEM_ERROR;
+      }
+   }
+   retval = apx_nodeData_read_provide_port_data(provide_port->parent->node_data, apx_portInstance_data_offset(provide_port), provide_port_data, provide_port_data_size);
+   if (retval == APX_NO_ERROR)
+   {
+      value_size = apx_portInstance_current_data_size(provide_port, provide_port_data, provide_port_data_size);
+      if (value_size == 0u)
+      {
+         retval = APX_INVALID_WRITE_ERROR;
+      }
+      else if (require_port != NULL)
+      {
+         if (rate_limiter != NULL)
+         {
+            retval = apx_rateLimiter_submit(rate_limiter, require_port, provide_port_data, value_size);
+         }
+         else
+         {
+            retval = post_require_port_data(require_port->parent, apx_portInstance_data_offset(require_port), provide_port_data, value_size, require_port->is_high_priority);
+         }
+      }
+      else
+      {
+         retval = apx_routingEngine_post(routing_engine, provide_port, provide_port_data, value_size);
+      }
+   }
+   if (use_heap_data)
+   {
+      free(provide_port_data);
+   }
+   return retval;
+}
+
 /*
 * Note: Caller must take self->lock before calling this function
 */
@@ -1636,7 +2067,16 @@ static apx_error_t route_provide_port_data_to_require_port(apx_portInstance_t* p
          {
             if (do_remote_routing)
             {
-               retval = remote_route_require_port_data(require_node, require_data_offset, provide_port_data, provide_port_data_size);
+               apx_size_t value_size = provide_port_data_size;
+               if (apx_file_is_dynamic(require_node->require_port_data_file))
+               {
+                  value_size = apx_portInstance_current_data_size(provide_port, provide_port_data, provide_port_data_size);
+                  if (value_size == 0u)
+                  {
+                     value_size = provide_port_data_size;
+                  }
+               }
+               retval = remote_route_require_port_data(require_node, require_data_offset, provide_port_data, value_size, require_port->is_high_priority);
             }
             else
             {
@@ -1653,20 +2093,146 @@ static apx_error_t route_provide_port_data_to_require_port(apx_portInstance_t* p
          retval = APX_VALUE_LENGTH_ERROR;
       }
    }
+   //Queued elements are events, a require port that connects later starts with an empty queue
+   return retval;
+}
+
+static apx_error_t remote_route_require_port_data(apx_nodeInstance_t* self, uint32_t offset, uint8_t const* data, apx_size_t size, bool is_high_priority)
+{
+   apx_file_t* file = self->require_port_data_file;
+   apx_error_t retval = apx_nodeData_write_require_port_data(self->node_data, offset, data, size);
+   if ((retval == APX_NO_ERROR) && (file != NULL))
+   {
+      retval = remote_route_data_to_file(file, offset, data, size, is_high_priority);
+   }
+   return retval;
+}
+
+/**
+ * Hands a copy of the data over to the connection of the require port node (its file manager worker acts as inbox).
+ * The copy is never touched again by the calling thread, the destination thread writes it into the node data
+ * and then transmits it. Nodes without an open require port data file are written directly since there is nothing to send.
+ */
+static apx_error_t post_require_port_data(apx_nodeInstance_t* self, uint32_t offset, uint8_t const* data, apx_size_t size, bool is_high_priority)
+{
+   apx_file_t* file = self->require_port_data_file;
+   apx_fileManager_t* file_manager = NULL;
+   uint8_t* update;
+   apx_size_t transmit_size;
+   apx_error_t retval;
+   if (file != NULL)
+   {
+      file_manager = apx_file_get_file_manager(file);
+   }
+   if ( (file_manager == NULL) || (!apx_file_is_open(file)) )
+   {
+      return apx_nodeData_write_require_port_data(self->node_data, offset, data, size);
+   }
+   transmit_size = require_port_transmit_size(self, file, offset, size);
+   //TODO: use small object allocator later on
+   update = (uint8_t*)malloc(transmit_size);
+   if (update == NULL)
+   {
+      return APX_MEM_ERROR;
+   }
+   memcpy(update, data, size);
+   if (transmit_size > size)
+   {
+      memset(update + size, 0, transmit_size - size);
+   }
+   if (is_high_priority)
+   {
+      retval = apx_fileManager_apply_priority_data(file_manager, apx_file_get_address_without_flags(file) + offset, update, transmit_size);
+   }
    else
    {
-      retval = APX_NOT_IMPLEMENTED_ERROR;
+      retval = apx_fileManager_apply_local_data(file_manager, apx_file_get_address_without_flags(file) + offset, update, transmit_size);
+   }
+   if (retval != APX_NO_ERROR)
+   {
+      free(update);
+      if (retval == APX_FILE_NOT_OPEN_ERROR)
+      {
+         //File was closed while the update was prepared
+         retval = apx_nodeData_write_require_port_data(self->node_data, offset, data, size);
+      }
    }
    return retval;
 }
 
-static apx_error_t remote_route_require_port_data(apx_nodeInstance_t* self, uint32_t offset, uint8_t const* data, apx_size_t size)
+/**
+ * Require port data files are fixed files for peers that did not agree to APX_CAPABILITY_DYNAMIC_FILE.
+ * Dynamic array values sent to such peers are extended to the complete port data size, the unused tail is zero-filled.
+ */
+static apx_size_t require_port_transmit_size(apx_nodeInstance_t* self, apx_file_t* file, uint32_t offset, apx_size_t size)
+{
+   apx_portInstance_t const* port;
+   if (apx_file_is_dynamic(file))
+   {
+      return size;
+   }
+   port = find_port_by_offset(self->require_ports, self->num_require_ports, offset);
+   if ( (port != NULL) && (offset == apx_portInstance_data_offset(port)) && (size < apx_portInstance_data_size(port)) &&
+      apx_portInstance_is_dynamic_array(port) )
+   {
+      return apx_portInstance_data_size(port);
+   }
+   return size;
+}
+
+/**
+ * Byte ranges inside a port are only sent to peers that agreed to APX_CAPABILITY_PARTIAL_WRITE,
+ * other peers are sent the complete port value.
+ */
+static bool is_partial_write_agreed(apx_nodeInstance_t* self)
 {
+   apx_capabilities_t capabilities;
+   apx_fileManager_t* file_manager = NULL;
+   if (self->require_port_data_file != NULL)
+   {
+      file_manager = apx_file_get_file_manager(self->require_port_data_file);
+   }
+   if (file_manager == NULL)
+   {
+      return true; //Nothing is transmitted, the range is only written to node_data
+   }
+   apx_fileManager_get_capabilities(file_manager, &capabilities);
+   return apx_capabilities_has(&capabilities, APX_CAPABILITY_PARTIAL_WRITE);
+}
+
+/**
+ * Appends the elements of a queued provide port value to the ring of the require port. The connection of the
+ * require port node drains the ring and sends the elements in batches. Elements are dropped (and counted) when the ring is full.
+ */
+static apx_error_t post_require_port_queued_data(apx_portInstance_t* require_port, uint8_t const* data, apx_size_t size)
+{
+   apx_nodeInstance_t* self = require_port->parent;
    apx_file_t* file = self->require_port_data_file;
-   apx_error_t retval = apx_nodeData_write_require_port_data(self->node_data, offset, data, size);
-   if ((retval == APX_NO_ERROR) && (file != NULL))
+   apx_fileManager_t* file_manager = NULL;
+   uint32_t num_dropped = 0u;
+   bool needs_drain = false;
+   apx_error_t retval;
+   if (file != NULL)
    {
-      retval = remote_route_data_to_file(file, offset, data, size);
+      file_manager = apx_file_get_file_manager(file);
+   }
+   if ( (file_manager == NULL) || (!apx_file_is_open(file)) )
+   {
+      return APX_NO_ERROR; //Nobody is listening yet, elements are not kept
+   }
+   retval = apx_queuedPortRing_push(require_port->queue_ring, data, size, &num_dropped, &needs_drain);
+   if ( (num_dropped > 0u) && (apx_queuedPortRing_num_overflows(require_port->queue_ring) == num_dropped) )
+   {
+      fprintf(stderr, "[APX_NODE_INSTANCE] Queue of %s.%s is full, elements are dropped\n", apx_nodeInstance_get_name(self), apx_portInstance_name(require_port));
+   }
+   if ( (retval == APX_NO_ERROR) && needs_drain)
+   {
+      uint32_t const address = apx_file_get_address_without_flags(file) + apx_portInstance_data_offset(require_port);
+      retval = apx_fileManager_drain_queued_data(file_manager, address, require_port->queue_ring);
+      if (retval != APX_NO_ERROR)
+      {
+         apx_queuedPortRing_cancel_drain(require_port->queue_ring);
+      }
    }
    return retval;
 }
@@ -1677,12 +2243,24 @@ static apx_error_t remote_route_provide_port_data(apx_nodeInstance_t* self, uint
    apx_error_t retval = apx_nodeData_write_provide_port_data(self->node_data, offset, data, size);
    if ((retval == APX_NO_ERROR) && (file != NULL))
    {
-      retval = remote_route_data_to_file(file, offset, data, size);
+      apx_portInstance_t const* provide_port = find_port_by_offset(self->provide_ports, self->num_provide_ports, offset);
+      bool const is_high_priority = (provide_port != NULL) ? provide_port->is_high_priority : false;
+      if ( (provide_port != NULL) && apx_portInstance_is_dynamic_array(provide_port) && apx_file_is_dynamic(file) &&
+         (offset == apx_portInstance_data_offset(provide_port)) && (size == apx_portInstance_data_size(provide_port)) )
+      {
+         //The unused tail of the array is never sent, the receiver keeps whatever it had there
+         apx_size_t const value_size = apx_portInstance_current_data_size(provide_port, data, size);
+         if (value_size > 0u)
+         {
+            size = value_size;
+         }
+      }
+      retval = remote_route_data_to_file(file, offset, data, size, is_high_priority);
    }
    return retval;
 }
 
-static apx_error_t remote_route_data_to_file(apx_file_t* file, uint32_t offset, uint8_t const* data, apx_size_t size)
+static apx_error_t remote_route_data_to_file(apx_file_t* file, uint32_t offset, uint8_t const* data, apx_size_t size, bool is_high_priority)
 {
    apx_error_t retval = APX_NO_ERROR;
    assert(file != NULL);
@@ -1712,12 +2290,53 @@ static apx_error_t remote_route_data_to_file(apx_file_t* file, uint32_t offset,
       else
       {
          memcpy(allocated_buffer, data, size);
-         retval = apx_fileManager_send_local_data(file_manager, address, allocated_buffer, size);
+         if (is_high_priority)
+         {
+            retval = apx_fileManager_send_priority_data(file_manager, address, allocated_buffer, size);
+         }
+         else
+         {
+            retval = apx_fileManager_send_local_data(file_manager, address, allocated_buffer, size);
+         }
       }
    }
    return retval;
 }
 
+/**
+ * Returns the port whose data contains offset. Ports are stored in ascending offset order and
+ * partial writes can start anywhere inside a port.
+ */
+static apx_portInstance_t* find_port_by_offset(apx_portInstance_t* port_list, apx_size_t num_ports, uint32_t offset)
+{
+   apx_size_t low = 0u;
+   apx_size_t high = num_ports;
+   apx_portInstance_t* candidate = NULL;
+   while ( (port_list != NULL) && (low < high) )
+   {
+      apx_size_t const mid = low + (high - low) / 2u;
+      uint32_t const port_offset = apx_portInstance_data_offset(&port_list[mid]);
+      if (port_offset == offset)
+      {
+         return &port_list[mid];
+      }
+      else if (port_offset < offset)
+      {
+         candidate = &port_list[mid];
+         low = mid + 1u;
+      }
+      else
+      {
+         high = mid;
+      }
+   }
+   if ( (candidate != NULL) && (offset < (apx_portInstance_data_offset(candidate) + apx_portInstance_data_size(candidate))) )
+   {
+      return candidate;
+   }
+   return NULL;
+}
+
 static apx_error_t trigger_require_port_write_callbacks(apx_nodeInstance_t* self, uint32_t offset, const uint8_t* data, apx_size_t size)
 {
    apx_error_t retval = APX_NO_ERROR;
@@ -1736,6 +2355,34 @@ static apx_error_t trigger_require_port_write_callbacks(apx_nodeInstance_t* self
          if (port_instance != NULL)
          {
             uint32_t const port_data_size = apx_portInstance_data_size(port_instance);
+            uint32_t const port_offset = apx_portInstance_data_offset(port_instance);
+            uint32_t const port_end_offset = port_offset + port_data_size;
+            if ( (offset == port_offset) && ((end_offset - offset) < port_data_size) && apx_portInstance_is_dynamic_array(port_instance) )
+            {
+               //Dynamic array value that ends after its last element, listeners are given the complete port data
+               if (!is_valid_port_value(port_instance, data, end_offset - offset))
+               {
+                  retval = APX_INVALID_WRITE_ERROR;
+               }
+               else
+               {
+                  retval = trigger_require_port_write_callback_from_node_data(self, port_instance);
+               }
+               break;
+            }
+            if ( (offset != port_offset) || (end_offset < port_end_offset) )
+            {
+               //Partial write, listeners are given the complete port data
+               uint32_t const range_end_offset = (end_offset < port_end_offset) ? end_offset : port_end_offset;
+               retval = trigger_require_port_write_callback_from_node_data(self, port_instance);
+               if (retval != APX_NO_ERROR)
+               {
+                  break;
+               }
+               data += range_end_offset - offset;
+               offset = range_end_offset;
+               continue;
+            }
             apx_nodeManager_on_require_port_written(self->parent, port_instance, data, port_data_size);
             offset += port_data_size;
             data += port_data_size;
@@ -1753,4 +2400,44 @@ static apx_error_t trigger_require_port_write_callbacks(apx_nodeInstance_t* self
       }
    }
    return retval;
+}
+
+static apx_error_t trigger_require_port_write_callback_from_node_data(apx_nodeInstance_t* self, apx_portInstance_t* port_instance)
+{
+   apx_error_t retval = APX_NO_ERROR;
+   uint8_t stack_data_buffer[STACK_DATA_BUF_SIZE];
+   apx_size_t const port_data_size = apx_portInstance_data_size(port_instance);
+   uint8_t* port_data = &stack_data_buffer[0];
+   bool use_heap_data = port_data_size > STACK_DATA_BUF_SIZE ? true : false;
+   if (use_heap_data)
+   {
+      port_data = (uint8_t*)malloc(port_data_size);
+      if (port_data == NULL)
+      {
+         return APX_MEM_ERROR;
+      }
+   }
+   retval = apx_nodeData_read_require_port_data(self->node_data, apx_portInstance_data_offset(port_instance), port_data, port_data_size);
+   if (retval == APX_NO_ERROR)
+   {
+      apx_nodeManager_on_require_port_written(self->parent, port_instance, port_data, port_data_size);
+   }
+   if (use_heap_data)
+   {
+      free(port_data);
+   }
+   return retval;
+}
+
+/**
+ * A port value is either the complete port data or, for dynamic array ports, the array length followed by the elements in use.
+ */
+static bool is_valid_port_value(apx_portInstance_t const* port, uint8_t const* data, apx_size_t size)
+{
+   apx_size_t const port_data_size = apx_portInstance_data_size(port);
+   if (size == port_data_size)
+   {
+      return true;
+   }
+   return (size < port_data_size) && apx_portInstance_is_dynamic_array(port) && (apx_portInstance_current_data_size(port, data, size) == size);
 }
\ No newline at end of file
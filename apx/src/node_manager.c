@@ -34,6 +34,8 @@
 #include "apx/node_manager.h"
 #include "apx/vm.h"
 #include "apx/connection_base.h"
+#include "apx/binary_definition.h"
+#include "apx/util.h"
 #ifdef MEM_LEAK_CHECK
 #include "CMemLeak.h"
 #endif
@@ -62,6 +64,19 @@ static apx_error_t update_computation_list_on_port(adt_ary_t* list, adt_hash_t*
    apx_portInstance_t* port_instance, apx_port_t const* parsed_port);
 static apx_error_t create_port_signatures_on_node_instance(apx_nodeInstance_t* node_instance);
 static apx_error_t init_node_instance_from_file_info(apx_nodeManager_t* self, rmf_fileInfo_t const* file_info, bool* file_open_request);
+static apx_error_t stream_definition_data(apx_nodeManager_t* self, apx_nodeInstance_t* node_instance, apx_nodeData_t* node_data, uint32_t offset, apx_size_t size, bool* is_complete);
+static apx_error_t build_node_instance_from_parser(apx_nodeManager_t* self, apx_nodeInstance_t* node_instance, apx_error_t parse_result, uint8_t const* definition_data, apx_size_t definition_size);
+static apx_error_t build_node_instance_from_binary_data(apx_nodeManager_t* self, apx_nodeInstance_t* node_instance, uint8_t const* definition_data, apx_size_t definition_size);
+static apx_error_t cache_or_discard_node_instance(apx_nodeManager_t* self, apx_nodeInstance_t* node_instance, apx_error_t build_result, uint8_t const* definition_data, apx_size_t definition_size);
+static apx_error_t build_node_instance_from_binary(apx_nodeManager_t* self, apx_nodeInstance_t* node_instance, apx_binaryDefinitionReader_t* reader);
+static apx_error_t create_port_from_binary(apx_nodeManager_t* self, apx_nodeInstance_t* node_instance, apx_portType_t port_type, apx_portId_t port_id,
+   apx_binaryDefinitionPort_t const* port, apx_size_t* data_offset);
+static apx_program_t* create_program_from_binary(uint8_t const* data, uint32_t size, apx_error_t* error_code);
+static apx_error_t verify_programs_from_binary(apx_nodeManager_t* self, apx_portType_t port_type, apx_binaryDefinitionPort_t const* port,
+   apx_program_t const* pack_program, apx_program_t const* unpack_program, adt_str_t** port_signature);
+static apx_error_t verify_program_element_size(apx_program_t const* expected, apx_program_t const* actual);
+static apx_error_t create_init_data_from_binary(apx_nodeInstance_t* node_instance, apx_binaryDefinitionReader_t const* reader);
+static apx_error_t finalize_node_instance(apx_nodeManager_t* self, apx_nodeInstance_t* node_instance);
 
 //////////////////////////////////////////////////////////////////////////////
 // PRIVATE VARIABLES
@@ -78,6 +93,9 @@ void apx_nodeManager_create(apx_nodeManager_t *self, apx_mode_t mode)
       self->mode = mode;
       self->last_attached = NULL;
       self->parent_connection = NULL;
+      self->node_cache = NULL;
+      self->streaming_node_instance = NULL;
+      self->streamed_size = 0u;
       apx_compiler_create(&self->compiler);
       apx_istream_create(&self->stream);
       apx_parser_create(&self->parser, &self->stream);
@@ -139,12 +157,53 @@ apx_error_t apx_nodeManager_build_node(apx_nodeManager_t* self, char const* defi
    return APX_INVALID_ARGUMENT_ERROR;
 }
 
+/**
+ * Builds node from a precompiled binary definition. The binary definition also becomes the definition data
+ * published to the server.
+ */
+apx_error_t apx_nodeManager_build_node_from_binary(apx_nodeManager_t* self, uint8_t const* definition_data, apx_size_t definition_size)
+{
+   if ((self != NULL) && (definition_data != NULL) && (definition_size > 0u))
+   {
+      apx_binaryDefinitionReader_t reader;
+      apx_nodeInstance_t* node_instance = NULL;
+      apx_error_t result = apx_binaryDefinitionReader_create(&reader, definition_data, definition_size);
+      if (result != APX_NO_ERROR)
+      {
+         return result;
+      }
+      node_instance = apx_nodeInstance_new(self->mode, reader.node_name);
+      if (node_instance == NULL)
+      {
+         apx_binaryDefinitionReader_destroy(&reader);
+         return APX_MEM_ERROR;
+      }
+      result = apx_nodeInstance_init_node_data(node_instance, definition_data, definition_size);
+      if (result == APX_NO_ERROR)
+      {
+         result = build_node_instance_from_binary(self, node_instance, &reader);
+      }
+      apx_binaryDefinitionReader_destroy(&reader);
+      if (result == APX_NO_ERROR)
+      {
+         attach_node(self, node_instance);
+      }
+      else
+      {
+         apx_nodeInstance_delete(node_instance);
+      }
+      return result;
+   }
+   return APX_INVALID_ARGUMENT_ERROR;
+}
+
 //Server-side API
 apx_error_t apx_nodeManager_init_node_from_file_info(apx_nodeManager_t* self, rmf_fileInfo_t const* file_info, bool* file_open_request)
 {
    if ( (self != NULL) && (file_info != NULL) && (file_open_request != NULL))
    {
-      if (rmf_fileInfo_name_ends_with(file_info, ".apx"))
+      if (rmf_fileInfo_name_ends_with(file_info, APX_DEFINITION_FILE_EXT) ||
+         rmf_fileInfo_name_ends_with(file_info, APX_BINARY_DEFINITION_FILE_EXT))
       {
          return init_node_instance_from_file_info(self, file_info, file_open_request);
       }
@@ -172,30 +231,41 @@ apx_error_t apx_nodeManager_build_node_from_data(apx_nodeManager_t* self, apx_no
       {
          return APX_MEM_ERROR;
       }
-      apx_error_t result = apx_parser_parse_bstr(&self->parser, definition_data, definition_data + definition_size);
-      apx_node_t* node = NULL;
-      free(definition_data);
-      if (result == APX_NO_ERROR)
+      apx_error_t result;
+      if (apx_binaryDefinition_is_binary(definition_data, (apx_size_t)definition_size))
       {
-         node = apx_parser_take_last_node(&self->parser);
-         assert(node != NULL);
-         result = build_node_instance(self, node_instance, node);
-         apx_node_delete(node);
+         result = build_node_instance_from_binary_data(self, node_instance, definition_data, (apx_size_t)definition_size);
       }
-      if (result != APX_NO_ERROR)
+      else
       {
-         char const* name = apx_nodeInstance_get_name(node_instance);
-         if (name != NULL)
-         {
-            adt_hash_remove(&self->instance_map, name);
-            apx_nodeInstance_delete(node_instance);
-         }
+         //The parser is shared, any definition being streamed falls back to parsing its complete file
+         self->streaming_node_instance = NULL;
+         result = apx_parser_parse_bstr(&self->parser, definition_data, definition_data + definition_size);
+         result = build_node_instance_from_parser(self, node_instance, result, definition_data, (apx_size_t)definition_size);
       }
+      free(definition_data);
       return result;
    }
    return APX_INVALID_ARGUMENT_ERROR;
 }
 
+void apx_nodeManager_set_node_cache(apx_nodeManager_t* self, apx_nodeCache_t* node_cache)
+{
+   if (self != NULL)
+   {
+      self->node_cache = node_cache;
+   }
+}
+
+apx_nodeCache_t* apx_nodeManager_get_node_cache(apx_nodeManager_t const* self)
+{
+   if (self != NULL)
+   {
+      return self->node_cache;
+   }
+   return NULL;
+}
+
 //Common API
 struct apx_nodeInstance_tag* apx_nodeManager_get_last_attached(apx_nodeManager_t const* self)
 {
@@ -262,23 +332,29 @@ apx_error_t apx_nodeManager_on_definition_data_written(apx_nodeManager_t* self,
    if (self != NULL && node_instance != NULL)
    {
       apx_error_t retval = APX_NO_ERROR;
+      bool is_complete = false;
       apx_nodeData_t* node_data = apx_nodeInstance_get_node_data(node_instance);
       if (node_data == NULL)
       {
-         retval = APX_NULL_PTR_ERROR;
+         return APX_NULL_PTR_ERROR;
       }
       if ((offset == 0u) && (size == apx_nodeData_definition_data_size(node_data)))
       {
          retval = apx_nodeManager_build_node_from_data(self, node_instance);
-         if (retval == APX_NO_ERROR)
+         is_complete = true;
+      }
+      else
+      {
+         retval = stream_definition_data(self, node_instance, node_data, offset, size, &is_complete);
+      }
+      if ( is_complete && (retval == APX_NO_ERROR) )
+      {
+         if (self->parent_connection != NULL)
          {
-            if (self->parent_connection != NULL)
+            apx_fileManager_t* file_manager = apx_connectionBase_get_file_manager(self->parent_connection);
+            if (file_manager != NULL)
             {
-               apx_fileManager_t* file_manager = apx_connectionBase_get_file_manager(self->parent_connection);
-               if (file_manager != NULL)
-               {
-                  apx_nodeInstance_attach_to_file_manager(node_instance, file_manager);
-               }
+               apx_nodeInstance_attach_to_file_manager(node_instance, file_manager);
             }
          }
       }
@@ -356,8 +432,17 @@ static apx_error_t build_node_instance(apx_nodeManager_t* self, apx_nodeInstance
    }
    if (result == APX_NO_ERROR)
    {
-      result = apx_nodeInstance_finalize_node_data(node_instance);
+      result = finalize_node_instance(self, node_instance);
    }
+   return result;
+}
+
+/**
+ * Last steps of building a node instance, shared by text and binary definitions
+ */
+static apx_error_t finalize_node_instance(apx_nodeManager_t* self, apx_nodeInstance_t* node_instance)
+{
+   apx_error_t result = apx_nodeInstance_finalize_node_data(node_instance);
    if (result == APX_NO_ERROR)
    {
       result = apx_nodeInstance_create_byte_port_map(node_instance);
@@ -366,6 +451,10 @@ static apx_error_t build_node_instance(apx_nodeManager_t* self, apx_nodeInstance
    {
       result = apx_nodeInstance_build_connector_table(node_instance);
    }
+   if ((result == APX_NO_ERROR) && (self->mode == APX_SERVER_MODE))
+   {
+      result = apx_nodeInstance_create_require_port_queues(node_instance);
+   }
    return result;
 }
 
@@ -409,6 +498,7 @@ static apx_error_t create_ports_on_node_instance(apx_nodeManager_t* self, apx_no
             result = apx_nodeInstance_create_provide_port(node_instance, port_id, port->name, pack_program, data_offset, &data_size);
             if (result == APX_NO_ERROR)
             {
+               apx_portInstance_set_high_priority(apx_nodeInstance_get_provide_port(node_instance, port_id), apx_port_is_high_priority(port));
                data_offset += data_size;
             }
             else
@@ -439,6 +529,9 @@ static apx_error_t create_ports_on_node_instance(apx_nodeManager_t* self, apx_no
                result = apx_nodeInstance_create_require_port(node_instance, port_id, port->name, pack_program, unpack_program, data_offset, &data_size);
                if (result == APX_NO_ERROR)
                {
+                  apx_portInstance_t* require_port = apx_nodeInstance_get_require_port(node_instance, port_id);
+                  apx_portInstance_set_min_update_interval(require_port, apx_port_get_min_update_interval(port));
+                  apx_portInstance_set_high_priority(require_port, apx_port_is_high_priority(port));
                   data_offset += data_size;
                }
                else
@@ -826,10 +919,15 @@ static apx_error_t init_node_instance_from_file_info(apx_nodeManager_t* self, rm
    else
    {
       apx_nodeInstance_t* node_instance = apx_nodeInstance_new(self->mode, base_name);
+      uint8_t* cached_definition = NULL;
       if (result == APX_NO_ERROR)
       {
          apx_size_t definition_size = (apx_size_t)rmf_fileInfo_size(file_info);
-         result = apx_nodeInstance_init_node_data(node_instance, NULL, definition_size);
+         if ((self->node_cache != NULL) && (rmf_fileInfo_digest_type(file_info) == RMF_DIGEST_TYPE_SHA256))
+         {
+            cached_definition = apx_nodeCache_take_definition_copy(self->node_cache, rmf_fileInfo_digest_data(file_info), definition_size);
+         }
+         result = apx_nodeInstance_init_node_data(node_instance, cached_definition, definition_size);
       }
       if (result == APX_NO_ERROR)
       {
@@ -845,8 +943,12 @@ static apx_error_t init_node_instance_from_file_info(apx_nodeManager_t* self, rm
       }
       if (result == APX_NO_ERROR)
       {
-         //TODO: Check node cache if we have a cached version of the node (level1 or level2 cache)
-         *file_open_request = true;
+         //A definition with known digest is already in node_data, no need to download it again
+         *file_open_request = (cached_definition == NULL);
+      }
+      if (cached_definition != NULL)
+      {
+         free(cached_definition);
       }
       if (result == APX_NO_ERROR)
       {
@@ -900,4 +1002,356 @@ static apx_error_t create_port_signatures_on_node_instance(apx_nodeInstance_t* n
       }
    }
    return retval;
-}
\ No newline at end of file
+}
+
+/**
+ * Definition data that arrives in fragments is parsed while the rest of the file is still in transit.
+ * All nodes on a connection share one parser so only one definition at a time is streamed.
+ * A write that does not continue the active stream makes the node fall back to parsing the complete file
+ * when its last byte has arrived.
+ * The node is finalized and built only after the end of file has been seen.
+ */
+static apx_error_t stream_definition_data(apx_nodeManager_t* self, apx_nodeInstance_t* node_instance, apx_nodeData_t* node_data, uint32_t offset, apx_size_t size, bool* is_complete)
+{
+   apx_error_t result;
+   apx_size_t const definition_size = apx_nodeData_definition_data_size(node_data);
+   uint8_t const* definition_data = apx_nodeData_get_definition_data(node_data);
+   if ( (definition_data == NULL) || (((apx_size_t)offset + size) > definition_size) )
+   {
+      return APX_INVALID_WRITE_ERROR;
+   }
+   if ( (offset == 0u) && !apx_binaryDefinition_is_binary(definition_data, size) )
+   {
+      //Binary definitions need no parsing and are built once complete
+      self->streaming_node_instance = node_instance;
+      self->streamed_size = 0u;
+      apx_parser_begin(&self->parser);
+   }
+   if ( (self->streaming_node_instance != node_instance) || ((apx_size_t)offset != self->streamed_size) )
+   {
+      if (self->streaming_node_instance == node_instance)
+      {
+         self->streaming_node_instance = NULL;
+      }
+      if (((apx_size_t)offset + size) == definition_size)
+      {
+         *is_complete = true;
+         return apx_nodeManager_build_node_from_data(self, node_instance);
+      }
+      return APX_NO_ERROR;
+   }
+   result = apx_parser_write(&self->parser, &definition_data[offset], &definition_data[offset + size]);
+   self->streamed_size += size;
+   if (result != APX_NO_ERROR)
+   {
+      //The connection is closed on error. The node instance is kept since its file can still receive writes.
+      self->streaming_node_instance = NULL;
+      return result;
+   }
+   if (self->streamed_size < definition_size)
+   {
+      return APX_NO_ERROR; //Wait for more data
+   }
+   self->streaming_node_instance = NULL;
+   *is_complete = true;
+   result = apx_parser_end(&self->parser);
+   return build_node_instance_from_parser(self, node_instance, result, definition_data, definition_size);
+}
+
+/**
+ * Builds node_instance from the node left in the parser. On failure the node instance is removed and deleted.
+ */
+static apx_error_t build_node_instance_from_parser(apx_nodeManager_t* self, apx_nodeInstance_t* node_instance, apx_error_t parse_result, uint8_t const* definition_data, apx_size_t definition_size)
+{
+   apx_error_t result = parse_result;
+   if (result == APX_NO_ERROR)
+   {
+      apx_node_t* node = apx_parser_take_last_node(&self->parser);
+      assert(node != NULL);
+      result = build_node_instance(self, node_instance, node);
+      apx_node_delete(node);
+   }
+   return cache_or_discard_node_instance(self, node_instance, result, definition_data, definition_size);
+}
+
+/**
+ * Builds node_instance from binary definition data. On failure the node instance is removed and deleted.
+ */
+static apx_error_t build_node_instance_from_binary_data(apx_nodeManager_t* self, apx_nodeInstance_t* node_instance, uint8_t const* definition_data, apx_size_t definition_size)
+{
+   apx_binaryDefinitionReader_t reader;
+   apx_error_t result = apx_binaryDefinitionReader_create(&reader, definition_data, definition_size);
+   if (result == APX_NO_ERROR)
+   {
+      char const* name = apx_nodeInstance_get_name(node_instance);
+      if ( (name == NULL) || (strcmp(name, reader.node_name) != 0) )
+      {
+         result = APX_INVALID_NAME_ERROR;
+      }
+      else
+      {
+         result = build_node_instance_from_binary(self, node_instance, &reader);
+      }
+      apx_binaryDefinitionReader_destroy(&reader);
+   }
+   return cache_or_discard_node_instance(self, node_instance, result, definition_data, definition_size);
+}
+
+static apx_error_t cache_or_discard_node_instance(apx_nodeManager_t* self, apx_nodeInstance_t* node_instance, apx_error_t build_result, uint8_t const* definition_data, apx_size_t definition_size)
+{
+   apx_error_t const result = build_result;
+   if ((result == APX_NO_ERROR) && (self->node_cache != NULL))
+   {
+      //Failing to cache only means the definition is downloaded again on next connect
+      (void)apx_nodeCache_insert(self->node_cache, definition_data, definition_size);
+   }
+   if (result != APX_NO_ERROR)
+   {
+      char const* name = apx_nodeInstance_get_name(node_instance);
+      if (name != NULL)
+      {
+         adt_hash_remove(&self->instance_map, name);
+         apx_nodeInstance_delete(node_instance);
+      }
+   }
+   return result;
+}
+
+/**
+ * Creates ports and init data directly from the port table, no definition text is parsed or compiled.
+ * Data elements and computation lists are not part of the binary format and are left empty.
+ */
+static apx_error_t build_node_instance_from_binary(apx_nodeManager_t* self, apx_nodeInstance_t* node_instance, apx_binaryDefinitionReader_t* reader)
+{
+   apx_size_t const num_provide_ports = (apx_size_t)reader->num_provide_ports;
+   apx_size_t const num_require_ports = (apx_size_t)reader->num_require_ports;
+   apx_size_t provide_port_data_offset = 0u;
+   apx_size_t require_port_data_offset = 0u;
+   apx_size_t port_index;
+   apx_error_t result = apx_nodeInstance_alloc_port_instance_memory(node_instance, num_provide_ports, num_require_ports);
+   for (port_index = 0u; (port_index < (num_provide_ports + num_require_ports)) && (result == APX_NO_ERROR); port_index++)
+   {
+      apx_binaryDefinitionPort_t port;
+      result = apx_binaryDefinitionReader_next_port(reader, &port);
+      if (result == APX_NO_ERROR)
+      {
+         if (port_index < num_provide_ports)
+         {
+            result = create_port_from_binary(self, node_instance, APX_PROVIDE_PORT, (apx_portId_t)port_index, &port, &provide_port_data_offset);
+         }
+         else
+         {
+            result = create_port_from_binary(self, node_instance, APX_REQUIRE_PORT, (apx_portId_t)(port_index - num_provide_ports), &port, &require_port_data_offset);
+         }
+      }
+   }
+   if (result == APX_NO_ERROR)
+   {
+      result = create_init_data_from_binary(node_instance, reader);
+   }
+   if (result == APX_NO_ERROR)
+   {
+      result = finalize_node_instance(self, node_instance);
+   }
+   return result;
+}
+
+static apx_error_t create_port_from_binary(apx_nodeManager_t* self, apx_nodeInstance_t* node_instance, apx_portType_t port_type, apx_portId_t port_id,
+   apx_binaryDefinitionPort_t const* port, apx_size_t* data_offset)
+{
+   apx_error_t result = APX_NO_ERROR;
+   apx_portInstance_t* port_instance = NULL;
+   apx_size_t data_size = 0u;
+   apx_program_t* unpack_program = NULL;
+   adt_str_t* port_signature = NULL;
+   apx_program_t* pack_program = create_program_from_binary(port->pack_program, port->pack_program_size, &result);
+   if (pack_program == NULL)
+   {
+      return result;
+   }
+   if (port_type == APX_REQUIRE_PORT)
+   {
+      unpack_program = create_program_from_binary(port->unpack_program, port->unpack_program_size, &result);
+      if (unpack_program == NULL)
+      {
+         APX_PROGRAM_DELETE(pack_program);
+         return result;
+      }
+   }
+   if (self->mode == APX_SERVER_MODE)
+   {
+      //Programs are trusted by the routing and must describe the data that the port is connected by
+      result = verify_programs_from_binary(self, port_type, port, pack_program, unpack_program, &port_signature);
+      if (result != APX_NO_ERROR)
+      {
+         APX_PROGRAM_DELETE(pack_program);
+         if (unpack_program != NULL)
+         {
+            APX_PROGRAM_DELETE(unpack_program);
+         }
+         return result;
+      }
+   }
+   //The port instance takes ownership of its programs
+   if (port_type == APX_PROVIDE_PORT)
+   {
+      result = apx_nodeInstance_create_provide_port(node_instance, port_id, port->name, pack_program, *data_offset, &data_size);
+      port_instance = apx_nodeInstance_get_provide_port(node_instance, port_id);
+   }
+   else
+   {
+      result = apx_nodeInstance_create_require_port(node_instance, port_id, port->name, pack_program, unpack_program, *data_offset, &data_size);
+      port_instance = apx_nodeInstance_get_require_port(node_instance, port_id);
+      apx_portInstance_set_min_update_interval(port_instance, port->min_update_interval);
+   }
+   if (result == APX_NO_ERROR)
+   {
+      apx_portInstance_set_high_priority(port_instance, port->is_high_priority);
+      *data_offset += data_size;
+      if (port_signature != NULL)
+      {
+         result = apx_portInstance_set_port_signature(port_instance, adt_str_cstr(port_signature));
+      }
+   }
+   if (port_signature != NULL)
+   {
+      adt_str_delete(port_signature);
+   }
+   return result;
+}
+
+static apx_program_t* create_program_from_binary(uint8_t const* data, uint32_t size, apx_error_t* error_code)
+{
+   apx_program_t* program;
+   if (size == 0u)
+   {
+      *error_code = APX_INVALID_PROGRAM_ERROR;
+      return NULL;
+   }
+   program = APX_PROGRAM_NEW();
+   if (program == NULL)
+   {
+      *error_code = APX_MEM_ERROR;
+      return NULL;
+   }
+   *error_code = convert_from_adt_to_apx_error(adt_bytearray_append(program, data, size));
+   if (*error_code != APX_NO_ERROR)
+   {
+      APX_PROGRAM_DELETE(program);
+      return NULL;
+   }
+   return program;
+}
+
+/**
+ * Compiles the data signature of a port from a binary definition and checks that the element size and dynamic data flag
+ * of the programs sent by the client agree with it. On success port_signature receives the normalized signature.
+ */
+static apx_error_t verify_programs_from_binary(apx_nodeManager_t* self, apx_portType_t port_type, apx_binaryDefinitionPort_t const* port,
+   apx_program_t const* pack_program, apx_program_t const* unpack_program, adt_str_t** port_signature)
+{
+   apx_signatureParser_t signature_parser;
+   apx_port_t signature_port;
+   apx_program_t* expected_program;
+   apx_dataElement_t* data_element = NULL;
+   uint8_t const* begin = (uint8_t const*)port->data_signature;
+   uint8_t const* end = begin + strlen(port->data_signature);
+   apx_error_t result = apx_signatureParser_create(&signature_parser);
+   if (result != APX_NO_ERROR)
+   {
+      return result;
+   }
+   if ( (begin < end) && (apx_signatureParser_parse_data_signature(&signature_parser, begin, end) == end) )
+   {
+      data_element = apx_signatureParser_take_data_element(&signature_parser);
+   }
+   apx_signatureParser_destroy(&signature_parser);
+   if (data_element == NULL)
+   {
+      return APX_DATA_SIGNATURE_ERROR;
+   }
+   apx_port_create(&signature_port, port_type, port->name, 0);
+   apx_dataSignature_set_effective_element(&signature_port.data_signature, data_element); //signature_port takes ownership
+   expected_program = apx_compiler_compile_port(&self->compiler, &signature_port, APX_PACK_PROGRAM, &result);
+   if (expected_program != NULL)
+   {
+      result = verify_program_element_size(expected_program, pack_program);
+      APX_PROGRAM_DELETE(expected_program);
+   }
+   if ( (result == APX_NO_ERROR) && (unpack_program != NULL) )
+   {
+      expected_program = apx_compiler_compile_port(&self->compiler, &signature_port, APX_UNPACK_PROGRAM, &result);
+      if (expected_program != NULL)
+      {
+         result = verify_program_element_size(expected_program, unpack_program);
+         APX_PROGRAM_DELETE(expected_program);
+      }
+   }
+   if (result == APX_NO_ERROR)
+   {
+      *port_signature = apx_dataElement_to_string(data_element, true);
+      if (*port_signature == NULL)
+      {
+         result = APX_MEM_ERROR;
+      }
+   }
+   apx_port_destroy(&signature_port);
+   return result;
+}
+
+/**
+ * expected is compiled without queue. The queue length of actual comes from the client and is allowed to differ.
+ */
+static apx_error_t verify_program_element_size(apx_program_t const* expected, apx_program_t const* actual)
+{
+   apx_programHeader_t expected_header;
+   apx_programHeader_t actual_header;
+   uint8_t const* next = NULL;
+   uint8_t const* begin = adt_bytearray_const_data(expected);
+   apx_error_t result = apx_program_decode_header(begin, begin + adt_bytearray_length(expected), &next, &expected_header);
+   if (result != APX_NO_ERROR)
+   {
+      return result;
+   }
+   begin = adt_bytearray_const_data(actual);
+   if (apx_program_decode_header(begin, begin + adt_bytearray_length(actual), &next, &actual_header) != APX_NO_ERROR)
+   {
+      return APX_INVALID_PROGRAM_ERROR;
+   }
+   if ( (actual_header.program_type != expected_header.program_type) ||
+      (actual_header.has_dynamic_data != expected_header.has_dynamic_data) ||
+      (((actual_header.queue_length > 0u) ? actual_header.element_size : actual_header.data_size) != expected_header.data_size) )
+   {
+      return APX_INVALID_PROGRAM_ERROR;
+   }
+   return APX_NO_ERROR;
+}
+
+static apx_error_t create_init_data_from_binary(apx_nodeInstance_t* node_instance, apx_binaryDefinitionReader_t const* reader)
+{
+   apx_size_t provide_port_data_size = 0u;
+   apx_size_t require_port_data_size = 0u;
+   uint8_t* provide_port_data = NULL;
+   uint8_t* require_port_data = NULL;
+   apx_error_t result = apx_nodeInstance_alloc_init_data_memory(node_instance, &provide_port_data, &provide_port_data_size,
+      &require_port_data, &require_port_data_size);
+   if (result != APX_NO_ERROR)
+   {
+      return result;
+   }
+   //Port data sizes are derived from the programs and must agree with the init data that was stored
+   if ((provide_port_data_size != (apx_size_t)reader->provide_port_init_data_size) ||
+      (require_port_data_size != (apx_size_t)reader->require_port_init_data_size))
+   {
+      return APX_LENGTH_ERROR;
+   }
+   if (provide_port_data_size > 0u)
+   {
+      memcpy(provide_port_data, reader->provide_port_init_data, provide_port_data_size);
+   }
+   if (require_port_data_size > 0u)
+   {
+      memcpy(require_port_data, reader->require_port_init_data, require_port_data_size);
+   }
+   return APX_NO_ERROR;
+}
@@ -161,15 +161,47 @@ apx_error_t apx_parser_parse_bstr(apx_parser_t* self, uint8_t const* begin, uint
 {
    if ((self != NULL) && (begin != NULL) && (end != NULL) && (begin <= end))
    {
-      size_t text_size = end - begin;
+      apx_parser_begin(self);
+      (void)apx_parser_write(self, begin, end);
+      return apx_parser_end(self);
+   }
+   return APX_INVALID_ARGUMENT_ERROR;
+}
+
+void apx_parser_begin(apx_parser_t* self)
+{
+   if (self != NULL)
+   {
       parser_reset(self);
+      //Clears partial lines and errors left by an earlier parse that was abandoned
+      apx_istream_reset(self->stream);
       apx_istream_open(self->stream);
-      if (text_size > 0u)
+   }
+}
+
+apx_error_t apx_parser_write(apx_parser_t* self, uint8_t const* begin, uint8_t const* end)
+{
+   if ((self != NULL) && (begin != NULL) && (end != NULL) && (begin <= end))
+   {
+      size_t const text_size = end - begin;
+      if ( (self->last_error == APX_NO_ERROR) && (text_size > 0u) )
       {
          apx_istream_write(self->stream, begin, (uint32_t)text_size);
       }
-      apx_istream_close(self->stream);
-      return apx_parser_get_last_error(self);
+      return self->last_error;
+   }
+   return APX_INVALID_ARGUMENT_ERROR;
+}
+
+apx_error_t apx_parser_end(apx_parser_t* self)
+{
+   if (self != NULL)
+   {
+      if (self->last_error == APX_NO_ERROR)
+      {
+         apx_istream_close(self->stream);
+      }
+      return self->last_error;
    }
    return APX_INVALID_ARGUMENT_ERROR;
 }
@@ -372,10 +404,7 @@ static apx_error_t parser_on_close(void* arg)
             parser_set_error(self, result, apx_node_get_last_error_line(node));
          }
       }
-      else
-      {
-         return self->last_error;
-      }
+      return self->last_error;
    }
    return APX_NULL_PTR_ERROR;
 }
@@ -245,6 +245,24 @@ uint32_t apx_port_get_queue_length(apx_port_t* self)
    return 0;
 }
 
+uint32_t apx_port_get_min_update_interval(apx_port_t* self)
+{
+   if ((self != NULL) && (self->attributes != NULL))
+   {
+      return apx_portAttributes_get_min_update_interval(self->attributes);
+   }
+   return 0u;
+}
+
+bool apx_port_is_high_priority(apx_port_t* self)
+{
+   if ((self != NULL) && (self->attributes != NULL))
+   {
+      return apx_portAttributes_is_high_priority(self->attributes);
+   }
+   return false;
+}
+
 apx_error_t apx_port_flatten_data_element(apx_port_t* self)
 {
    apx_error_t result;
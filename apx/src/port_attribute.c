@@ -57,6 +57,8 @@ void apx_portAttributes_create(apx_portAttributes_t *self)
    {
       self->is_parameter = false;
       self->queue_length = 0u;
+      self->min_update_interval = 0u;
+      self->is_high_priority = false;
       self->init_value = NULL;
    }
 }
@@ -140,6 +142,40 @@ uint32_t apx_portAttributes_get_queue_length(apx_portAttributes_t* self)
    return 0u;
 }
 
+void apx_portAttributes_set_min_update_interval(apx_portAttributes_t* self, uint32_t interval_ms)
+{
+   if (self != NULL)
+   {
+      self->min_update_interval = interval_ms;
+   }
+}
+
+uint32_t apx_portAttributes_get_min_update_interval(apx_portAttributes_t* self)
+{
+   if (self != NULL)
+   {
+      return self->min_update_interval;
+   }
+   return 0u;
+}
+
+void apx_portAttributes_set_high_priority(apx_portAttributes_t* self)
+{
+   if (self != NULL)
+   {
+      self->is_high_priority = true;
+   }
+}
+
+bool apx_portAttributes_is_high_priority(apx_portAttributes_t* self)
+{
+   if (self != NULL)
+   {
+      return self->is_high_priority;
+   }
+   return false;
+}
+
 bool apx_portAttributes_has_init_value(apx_portAttributes_t* self)
 {
    if (self != NULL)
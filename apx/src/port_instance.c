@@ -31,6 +31,7 @@
 #include <string.h>
 #include "apx/port_instance.h"
 #include "apx/util.h"
+#include "pack.h"
 
 //////////////////////////////////////////////////////////////////////////////
 // PRIVATE CONSTANTS AND DATA TYPES
@@ -41,6 +42,7 @@
 //////////////////////////////////////////////////////////////////////////////
 
 static apx_error_t process_info_from_program_header(apx_portInstance_t* self, apx_program_t const* program);
+static void process_dynamic_array_info(apx_portInstance_t* self, uint8_t const* next, uint8_t const* end);
 
 //////////////////////////////////////////////////////////////////////////////
 // PUBLIC FUNCTIONS
@@ -61,8 +63,15 @@ apx_error_t apx_portInstance_create(apx_portInstance_t* self, struct apx_nodeIns
       self->queue_length = 0u;
       self->element_size = 0u;
       self->has_dynamic_data = false;
+      self->dynamic_length_size = 0u;
+      self->dynamic_element_size = 0u;
       self->computation_list = NULL;
       self->port_signature = NULL;
+      self->routing_shard = 0u;
+      self->min_update_interval = 0u;
+      self->rate_limit = NULL;
+      self->is_high_priority = false;
+      self->queue_ring = NULL;
       if (name != NULL)
       {
          self->name = STRDUP(name);
@@ -96,6 +105,10 @@ void apx_portInstance_destroy(apx_portInstance_t* self)
       {
          free(self->port_signature);
       }
+      if (self->queue_ring != NULL)
+      {
+         apx_queuedPortRing_delete(self->queue_ring);
+      }
    }
 }
 
@@ -201,6 +214,69 @@ uint32_t apx_portInstance_element_size(apx_portInstance_t const* self)
    return 0u;
 }
 
+void apx_portInstance_set_min_update_interval(apx_portInstance_t* self, uint32_t interval_ms)
+{
+   if (self != NULL)
+   {
+      self->min_update_interval = interval_ms;
+   }
+}
+
+uint32_t apx_portInstance_min_update_interval(apx_portInstance_t const* self)
+{
+   if (self != NULL)
+   {
+      return self->min_update_interval;
+   }
+   return 0u;
+}
+
+void apx_portInstance_set_high_priority(apx_portInstance_t* self, bool is_high_priority)
+{
+   if (self != NULL)
+   {
+      self->is_high_priority = is_high_priority;
+   }
+}
+
+bool apx_portInstance_is_high_priority(apx_portInstance_t const* self)
+{
+   if (self != NULL)
+   {
+      return self->is_high_priority;
+   }
+   return false;
+}
+
+/**
+ * Creates the ring that buffers routed elements of a queued require port. Does nothing for ports without queue.
+ */
+apx_error_t apx_portInstance_create_queue_ring(apx_portInstance_t* self)
+{
+   if (self != NULL)
+   {
+      if ( (self->queue_length > 0u) && (self->queue_ring == NULL) )
+      {
+         self->queue_ring = apx_queuedPortRing_new(self->element_size, self->queue_length);
+         if (self->queue_ring == NULL)
+         {
+            return APX_MEM_ERROR;
+         }
+      }
+      return APX_NO_ERROR;
+   }
+   return APX_INVALID_ARGUMENT_ERROR;
+}
+
+apx_queuedPortRing_t* apx_portInstance_get_queue_ring(apx_portInstance_t const* self)
+{
+   if (self != NULL)
+   {
+      return self->queue_ring;
+   }
+   return NULL;
+}
+
 bool apx_portInstance_has_dynamic_data(apx_portInstance_t const* self)
 {
    if (self != NULL)
@@ -210,6 +286,54 @@ bool apx_portInstance_has_dynamic_data(apx_portInstance_t const* self)
    return false;
 }
 
+bool apx_portInstance_is_dynamic_array(apx_portInstance_t const* self)
+{
+   if (self != NULL)
+   {
+      return (self->dynamic_length_size > 0u);
+   }
+   return false;
+}
+
+uint32_t apx_portInstance_dynamic_length_size(apx_portInstance_t const* self)
+{
+   if (self != NULL)
+   {
+      return self->dynamic_length_size;
+   }
+   return 0u;
+}
+
+/**
+ * Returns number of bytes in use by the port value in data.
+ * For dynamic array ports this is the length header followed by the current number of elements, for all other ports it's the port data size.
+ * Returns 0 when data does not hold a valid value.
+ */
+apx_size_t apx_portInstance_current_data_size(apx_portInstance_t const* self, uint8_t const* data, apx_size_t size)
+{
+   if ( (self != NULL) && (data != NULL) )
+   {
+      uint32_t array_length;
+      apx_size_t used_size;
+      if (self->dynamic_length_size == 0u)
+      {
+         return self->data_size;
+      }
+      if (size < self->dynamic_length_size)
+      {
+         return 0u;
+      }
+      array_length = (uint32_t)unpackLE(data, (uint8_t)self->dynamic_length_size);
+      if (array_length > ((self->data_size - self->dynamic_length_size) / self->dynamic_element_size))
+      {
+         return 0u;
+      }
+      used_size = self->dynamic_length_size + array_length * self->dynamic_element_size;
+      return used_size;
+   }
+   return 0u;
+}
+
 apx_program_t const* apx_portInstance_pack_program(apx_portInstance_t* self)
 {
    if (self != NULL)
@@ -385,6 +509,34 @@ apx_error_t apx_port_instance_create_port_signature(apx_portInstance_t* self)
 
 }
 
+/**
+ * Sets port signature from a data signature that was already generated, for example by the definition compiler.
+ */
+apx_error_t apx_portInstance_set_port_signature(apx_portInstance_t* self, char const* data_signature)
+{
+   if ( (self != NULL) && (self->name != NULL) && (data_signature != NULL) )
+   {
+      size_t const name_size = strlen(self->name);
+      size_t const data_signature_size = strlen(data_signature);
+      char* port_signature = (char*)malloc(name_size + data_signature_size + 3u); //Add 3 for quotes and null-terminator
+      if (port_signature == NULL)
+      {
+         return APX_MEM_ERROR;
+      }
+      port_signature[0] = '"';
+      memcpy(&port_signature[1], self->name, name_size);
+      port_signature[name_size + 1u] = '"';
+      memcpy(&port_signature[name_size + 2u], data_signature, data_signature_size + 1u);
+      if (self->port_signature != NULL)
+      {
+         free(self->port_signature);
+      }
+      self->port_signature = port_signature;
+      return APX_NO_ERROR;
+   }
+   return APX_INVALID_ARGUMENT_ERROR;
+}
+
 char const* apx_portInstance_get_port_signature(apx_portInstance_t const* self, bool *has_dynamic_data)
 {
    if ( (self != NULL) && (has_dynamic_data != NULL) )
@@ -423,7 +575,52 @@ static apx_error_t process_info_from_program_header(apx_portInstance_t* self, ap
       self->has_dynamic_data = header.has_dynamic_data;
       self->queue_length = header.queue_length;
       self->element_size = header.element_size;
+      self->dynamic_length_size = 0u;
+      self->dynamic_element_size = 0u;
+      if (header.has_dynamic_data && (header.queue_length == 0u))
+      {
+         process_dynamic_array_info(self, next, end);
+      }
       return APX_NO_ERROR;
    }
    return APX_INVALID_ARGUMENT_ERROR;
+}
+
+/**
+ * Detects programs where the whole port value is one dynamic array of a scalar type, i.e. ports like C[8*] or S[100*].
+ * Dynamic arrays nested inside records are not detected, those ports are always transferred in full.
+ */
+static void process_dynamic_array_info(apx_portInstance_t* self, uint8_t const* next, uint8_t const* end)
+{
+   uint8_t opcode;
+   uint8_t variant;
+   bool flag;
+   uint32_t length_size;
+   uint32_t max_length;
+   if ((next == NULL) || ((next + 2u) > end))
+   {
+      return;
+   }
+   apx_program_decode_instruction(*next++, &opcode, &variant, &flag);
+   if ( ((opcode != APX_VM_OPCODE_PACK) && (opcode != APX_VM_OPCODE_UNPACK)) || (!flag) || (variant == APX_VM_VARIANT_RECORD) )
+   {
+      return;
+   }
+   apx_program_decode_instruction(*next++, &opcode, &variant, &flag);
+   if ((opcode != APX_VM_OPCODE_DATA_SIZE) || (!flag) || (variant > APX_VM_VARIANT_ARRAY_SIZE_LAST))
+   {
+      return;
+   }
+   length_size = (variant == APX_VM_VARIANT_ARRAY_SIZE_U8) ? UINT8_SIZE : ((variant == APX_VM_VARIANT_ARRAY_SIZE_U16) ? UINT16_SIZE : UINT32_SIZE);
+   if ((next + length_size) != end) //The array must be the last instruction of the program
+   {
+      return;
+   }
+   max_length = (uint32_t)unpackLE(next, (uint8_t)length_size);
+   if ((max_length == 0u) || (self->data_size <= length_size) || (((self->data_size - length_size) % max_length) != 0u))
+   {
+      return;
+   }
+   self->dynamic_length_size = length_size;
+   self->dynamic_element_size = (self->data_size - length_size) / max_length;
 }
\ No newline at end of file
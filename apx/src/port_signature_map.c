@@ -92,6 +92,19 @@ int32_t apx_portSignatureMap_length(apx_portSignatureMap_t *self)
    return -1;
 }
 
+/**
+ * Appends weak references to all map entries (apx_portSignatureMapEntry_t) to the array.
+ * The caller must hold the server global lock for as long as the references are used.
+ */
+int32_t apx_portSignatureMap_values(apx_portSignatureMap_t *self, adt_ary_t *entries)
+{
+   if ( (self != 0) && (entries != 0) )
+   {
+      return adt_hash_values(&self->internal_map, entries);
+   }
+   return -1;
+}
+
 apx_portSignatureMap_t *apx_portSignatureMap_new(void)
 {
    apx_portSignatureMap_t *self = (apx_portSignatureMap_t*) malloc(sizeof(apx_portSignatureMap_t));
@@ -0,0 +1,329 @@
+/*****************************************************************************
+* \file      queued_port_ring.c
+* \author    Conny Gustafsson
+* \date      2026-10-18
+* \brief     Ring buffer for queued port elements routed by the server
+*
+* Copyright (c) 2026 Conny Gustafsson
+* Permission is hereby granted, free of charge, to any person obtaining a copy of
+* this software and associated documentation files (the "Software"), to deal in
+* the Software without restriction, including without limitation the rights to
+* use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+* the Software, and to permit persons to whom the Software is furnished to do so,
+* subject to the following conditions:
+
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+* FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+* COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+* IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+* CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+******************************************************************************/
+//////////////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////////////
+#include <assert.h>
+#include <string.h>
+#include <malloc.h>
+#include "apx/queued_port_ring.h"
+#include "apx/vm_common.h"
+#include "pack.h"
+#ifdef _MSC_VER
+# ifndef WIN32_LEAN_AND_MEAN
+# define WIN32_LEAN_AND_MEAN
+# endif
+# include <Windows.h>
+#endif
+#ifdef MEM_LEAK_CHECK
+#include "CMemLeak.h"
+#endif
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE CONSTANTS AND DATA TYPES
+//////////////////////////////////////////////////////////////////////////////
+#define MAX_CAPACITY 0x80000000u
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////////////
+static uint32_t round_up_to_power_of_two(uint32_t value);
+static void copy_to_ring(apx_queuedPortRing_t* self, uint32_t pos, uint8_t const* src, uint32_t num_elements);
+static void copy_from_ring(apx_queuedPortRing_t const* self, uint32_t pos, uint8_t* dest, uint32_t num_elements);
+static uint32_t ring_load(volatile uint32_t* ptr);
+static void ring_store(volatile uint32_t* ptr, uint32_t value);
+static uint32_t ring_exchange(volatile uint32_t* ptr, uint32_t value);
+static void ring_add(volatile uint32_t* ptr, uint32_t value);
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE VARIABLES
+//////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////
+// PUBLIC FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+apx_error_t apx_queuedPortRing_create(apx_queuedPortRing_t* self, uint32_t element_size, uint32_t queue_length)
+{
+   if ( (self != NULL) && (element_size > 0u) && (queue_length > 0u) && (queue_length <= (MAX_CAPACITY / APX_QUEUED_PORT_RING_DEPTH)) )
+   {
+      uint32_t const capacity = round_up_to_power_of_two(queue_length * APX_QUEUED_PORT_RING_DEPTH);
+      uint64_t const alloc_size = ((uint64_t)capacity) * element_size;
+      if (alloc_size > UINT32_MAX)
+      {
+         return APX_INVALID_ARGUMENT_ERROR;
+      }
+      self->elements = (uint8_t*)malloc((size_t)alloc_size);
+      if (self->elements == NULL)
+      {
+         return APX_MEM_ERROR;
+      }
+      self->capacity = capacity;
+      self->element_size = element_size;
+      self->queue_length = queue_length;
+      self->length_size = apx_vm_size_type_to_size(apx_vm_size_to_size_type(queue_length));
+      self->write_pos = 0u;
+      self->read_pos = 0u;
+      self->num_overflows = 0u;
+      self->drain_pending = 0u;
+      return APX_NO_ERROR;
+   }
+   return APX_INVALID_ARGUMENT_ERROR;
+}
+
+void apx_queuedPortRing_destroy(apx_queuedPortRing_t* self)
+{
+   if (self != NULL)
+   {
+      free(self->elements);
+      self->elements = NULL;
+      self->capacity = 0u;
+   }
+}
+
+apx_queuedPortRing_t* apx_queuedPortRing_new(uint32_t element_size, uint32_t queue_length)
+{
+   apx_queuedPortRing_t* self = (apx_queuedPortRing_t*)malloc(sizeof(apx_queuedPortRing_t));
+   if (self != NULL)
+   {
+      apx_error_t result = apx_queuedPortRing_create(self, element_size, queue_length);
+      if (result != APX_NO_ERROR)
+      {
+         free(self);
+         self = NULL;
+      }
+   }
+   return self;
+}
+
+void apx_queuedPortRing_delete(apx_queuedPortRing_t* self)
+{
+   if (self != NULL)
+   {
+      apx_queuedPortRing_destroy(self);
+      free(self);
+   }
+}
+
+/**
+ * Size of one batch in the queued data encoding. This equals the data size of the require port.
+ */
+apx_size_t apx_queuedPortRing_batch_size(apx_queuedPortRing_t const* self)
+{
+   if (self != NULL)
+   {
+      return self->length_size + self->queue_length * self->element_size;
+   }
+   return 0u;
+}
+
+uint32_t apx_queuedPortRing_num_overflows(apx_queuedPortRing_t* self)
+{
+   if (self != NULL)
+   {
+      return ring_load(&self->num_overflows);
+   }
+   return 0u;
+}
+
+/**
+ * Appends the elements of a queued port value (length header followed by elements) to the ring.
+ * Elements that don't fit are dropped and reported in num_dropped.
+ * needs_drain is set when the caller must ask the consumer to drain the ring. It is only set once
+ * until the consumer calls apx_queuedPortRing_begin_drain.
+ */
+apx_error_t apx_queuedPortRing_push(apx_queuedPortRing_t* self, uint8_t const* data, apx_size_t size, uint32_t* num_dropped, bool* needs_drain)
+{
+   if ( (self != NULL) && (data != NULL) && (num_dropped != NULL) && (needs_drain != NULL) )
+   {
+      uint32_t num_elements;
+      uint32_t num_free;
+      uint32_t num_accepted;
+      uint32_t const write_pos = self->write_pos;
+      *num_dropped = 0u;
+      *needs_drain = false;
+      if (size < self->length_size)
+      {
+         return APX_VALUE_LENGTH_ERROR;
+      }
+      num_elements = unpackLE(data, (uint8_t)self->length_size);
+      if ( (num_elements > self->queue_length) || ( (self->length_size + num_elements * self->element_size) > size) )
+      {
+         return APX_VALUE_LENGTH_ERROR;
+      }
+      if (num_elements == 0u)
+      {
+         return APX_NO_ERROR;
+      }
+      num_free = self->capacity - (write_pos - ring_load(&self->read_pos));
+      num_accepted = (num_elements < num_free) ? num_elements : num_free;
+      if (num_accepted > 0u)
+      {
+         copy_to_ring(self, write_pos, data + self->length_size, num_accepted);
+         ring_store(&self->write_pos, write_pos + num_accepted);
+         *needs_drain = (ring_exchange(&self->drain_pending, 1u) == 0u);
+      }
+      if (num_accepted < num_elements)
+      {
+         *num_dropped = num_elements - num_accepted;
+         ring_add(&self->num_overflows, *num_dropped);
+      }
+      return APX_NO_ERROR;
+   }
+   return APX_INVALID_ARGUMENT_ERROR;
+}
+
+/**
+ * Used by the producer when the drain request could not be handed over to the consumer.
+ */
+void apx_queuedPortRing_cancel_drain(apx_queuedPortRing_t* self)
+{
+   if (self != NULL)
+   {
+      ring_store(&self->drain_pending, 0u);
+   }
+}
+
+/**
+ * Must be called by the consumer before it starts popping batches. Elements pushed after this call
+ * trigger a new drain request.
+ */
+void apx_queuedPortRing_begin_drain(apx_queuedPortRing_t* self)
+{
+   if (self != NULL)
+   {
+      ring_store(&self->drain_pending, 0u);
+   }
+}
+
+uint32_t apx_queuedPortRing_num_elements(apx_queuedPortRing_t* self)
+{
+   if (self != NULL)
+   {
+      return ring_load(&self->write_pos) - self->read_pos;
+   }
+   return 0u;
+}
+
+/**
+ * Moves up to queue_length elements from the ring into buffer using the queued data encoding.
+ * buffer must be at least apx_queuedPortRing_batch_size bytes long. Unused element space is zeroed.
+ * Returns number of elements in the batch.
+ */
+uint32_t apx_queuedPortRing_pop_batch(apx_queuedPortRing_t* self, uint8_t* buffer)
+{
+   if ( (self != NULL) && (buffer != NULL) )
+   {
+      uint32_t const read_pos = self->read_pos;
+      uint32_t const num_available = ring_load(&self->write_pos) - read_pos;
+      uint32_t const num_elements = (num_available < self->queue_length) ? num_available : self->queue_length;
+      uint8_t* const element_data = buffer + self->length_size;
+      packLE(buffer, num_elements, (uint8_t)self->length_size);
+      copy_from_ring(self, read_pos, element_data, num_elements);
+      memset(element_data + num_elements * self->element_size, 0, (self->queue_length - num_elements) * self->element_size);
+      ring_store(&self->read_pos, read_pos + num_elements);
+      return num_elements;
+   }
+   return 0u;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+static uint32_t round_up_to_power_of_two(uint32_t value)
+{
+   uint32_t result = 1u;
+   while (result < value)
+   {
+      result <<= 1u;
+   }
+   return result;
+}
+
+static void copy_to_ring(apx_queuedPortRing_t* self, uint32_t pos, uint8_t const* src, uint32_t num_elements)
+{
+   uint32_t const index = pos & (self->capacity - 1u);
+   uint32_t const first_part = ( (index + num_elements) > self->capacity) ? self->capacity - index : num_elements;
+   memcpy(self->elements + index * self->element_size, src, first_part * self->element_size);
+   if (first_part < num_elements)
+   {
+      memcpy(self->elements, src + first_part * self->element_size, (num_elements - first_part) * self->element_size);
+   }
+}
+
+static void copy_from_ring(apx_queuedPortRing_t const* self, uint32_t pos, uint8_t* dest, uint32_t num_elements)
+{
+   uint32_t const index = pos & (self->capacity - 1u);
+   uint32_t const first_part = ( (index + num_elements) > self->capacity) ? self->capacity - index : num_elements;
+   memcpy(dest, self->elements + index * self->element_size, first_part * self->element_size);
+   if (first_part < num_elements)
+   {
+      memcpy(dest + first_part * self->element_size, self->elements, (num_elements - first_part) * self->element_size);
+   }
+}
+
+#ifdef _MSC_VER
+static uint32_t ring_load(volatile uint32_t* ptr)
+{
+   uint32_t value = *ptr;
+   MemoryBarrier();
+   return value;
+}
+
+static void ring_store(volatile uint32_t* ptr, uint32_t value)
+{
+   InterlockedExchange((volatile LONG*)ptr, (LONG)value);
+}
+
+static uint32_t ring_exchange(volatile uint32_t* ptr, uint32_t value)
+{
+   return (uint32_t)InterlockedExchange((volatile LONG*)ptr, (LONG)value);
+}
+
+static void ring_add(volatile uint32_t* ptr, uint32_t value)
+{
+   (void)InterlockedExchangeAdd((volatile LONG*)ptr, (LONG)value);
+}
+#else
+static uint32_t ring_load(volatile uint32_t* ptr)
+{
+   return __atomic_load_n(ptr, __ATOMIC_SEQ_CST);
+}
+
+static void ring_store(volatile uint32_t* ptr, uint32_t value)
+{
+   __atomic_store_n(ptr, value, __ATOMIC_SEQ_CST);
+}
+
+static uint32_t ring_exchange(volatile uint32_t* ptr, uint32_t value)
+{
+   return __atomic_exchange_n(ptr, value, __ATOMIC_SEQ_CST);
+}
+
+static void ring_add(volatile uint32_t* ptr, uint32_t value)
+{
+   (void)__atomic_add_fetch(ptr, value, __ATOMIC_SEQ_CST);
+}
+#endif
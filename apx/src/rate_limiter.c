@@ -0,0 +1,437 @@
+/*****************************************************************************
+* \file      rate_limiter.c
+* \author    Conny Gustafsson
+* \date      2026-10-18
+* \brief     Per-require-port update rate limiter
+*
+* Copyright (c) 2026 Conny Gustafsson
+* Permission is hereby granted, free of charge, to any person obtaining a copy of
+* this software and associated documentation files (the "Software"), to deal in
+* the Software without restriction, including without limitation the rights to
+* use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+* the Software, and to permit persons to whom the Software is furnished to do so,
+* subject to the following conditions:
+
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+* FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+* COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+* IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+* CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+******************************************************************************/
+//////////////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////////////
+#include <assert.h>
+#include <string.h>
+#include <malloc.h>
+#ifdef _WIN32
+#include <process.h>
+#endif
+#include "apx/rate_limiter.h"
+#include "apx/node_instance.h"
+#include "apx/util.h"
+#ifdef MEM_LEAK_CHECK
+#include "CMemLeak.h"
+#endif
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE CONSTANTS AND DATA TYPES
+//////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////////////
+static uint64_t current_time_ms(apx_rateLimiter_t* self);
+static apx_rateLimitedPort_t* create_port_state(apx_rateLimiter_t* self, apx_portInstance_t* require_port, apx_size_t size);
+static void delete_port_state(apx_rateLimiter_t* self, apx_rateLimitedPort_t* port_state);
+static void schedule_pending_value(apx_rateLimiter_t* self, apx_rateLimitedPort_t* port_state, uint32_t interval_ms);
+static void deliver_expired_values(apx_rateLimiter_t* self);
+#ifndef UNIT_TEST
+static THREAD_PROTO(timer_task, arg);
+#endif
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE VARIABLES
+//////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////
+// PUBLIC FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+apx_error_t apx_rateLimiter_create(apx_rateLimiter_t* self, uint32_t tick_ms)
+{
+   if ( (self != NULL) && (tick_ms > 0u) )
+   {
+      apx_error_t result;
+      memset(self, 0, sizeof(apx_rateLimiter_t));
+      result = apx_timerWheel_create(&self->timer_wheel, APX_RATE_LIMITER_NUM_SLOTS);
+      if (result != APX_NO_ERROR)
+      {
+         return result;
+      }
+      self->tick_ms = tick_ms;
+      self->ports = NULL;
+      self->is_thread_valid = false;
+      self->exit_flag = false;
+      MUTEX_INIT(self->lock);
+      SEMAPHORE_CREATE(self->wakeup_semaphore);
+      return APX_NO_ERROR;
+   }
+   return APX_INVALID_ARGUMENT_ERROR;
+}
+
+void apx_rateLimiter_destroy(apx_rateLimiter_t* self)
+{
+   if (self != NULL)
+   {
+#ifndef UNIT_TEST
+      apx_rateLimiter_stop(self);
+#endif
+      MUTEX_LOCK(self->lock);
+      while (self->ports != NULL)
+      {
+         delete_port_state(self, self->ports);
+      }
+      MUTEX_UNLOCK(self->lock);
+      apx_timerWheel_destroy(&self->timer_wheel);
+      MUTEX_DESTROY(self->lock);
+      SEMAPHORE_DESTROY(self->wakeup_semaphore);
+   }
+}
+
+apx_rateLimiter_t* apx_rateLimiter_new(uint32_t tick_ms)
+{
+   apx_rateLimiter_t* self = (apx_rateLimiter_t*)malloc(sizeof(apx_rateLimiter_t));
+   if (self != NULL)
+   {
+      apx_error_t result = apx_rateLimiter_create(self, tick_ms);
+      if (result != APX_NO_ERROR)
+      {
+         free(self);
+         self = NULL;
+      }
+   }
+   return self;
+}
+
+void apx_rateLimiter_delete(apx_rateLimiter_t* self)
+{
+   if (self != NULL)
+   {
+      apx_rateLimiter_destroy(self);
+      free(self);
+   }
+}
+
+/**
+ * Delivers the value to require_port right away when its minimum update interval has expired since the previous delivery.
+ * Otherwise the value is stored (replacing any older pending value) and delivered by the timer when the interval expires.
+ * Delivery happens while the lock is held so a deferred value can never overtake a newer one.
+ */
+apx_error_t apx_rateLimiter_submit(apx_rateLimiter_t* self, apx_portInstance_t* require_port, uint8_t const* data, apx_size_t size)
+{
+   if ( (self != NULL) && (require_port != NULL) && (data != NULL) )
+   {
+      apx_error_t retval = APX_NO_ERROR;
+      apx_rateLimitedPort_t* port_state;
+      uint32_t const interval_ms = apx_portInstance_min_update_interval(require_port);
+      uint64_t now;
+      MUTEX_LOCK(self->lock);
+      now = current_time_ms(self);
+      port_state = require_port->rate_limit;
+      if (port_state == NULL)
+      {
+         port_state = create_port_state(self, require_port, apx_portInstance_data_size(require_port));
+         if (port_state == NULL)
+         {
+            MUTEX_UNLOCK(self->lock);
+            return APX_MEM_ERROR;
+         }
+      }
+      if ( (size > port_state->data_size) || ( (size < port_state->data_size) && (!apx_portInstance_is_dynamic_array(require_port)) ) )
+      {
+         retval = APX_VALUE_LENGTH_ERROR;
+      }
+      else if ( (!port_state->has_pending) &&
+         ( (!port_state->has_delivered) || ((now - port_state->last_delivery_ms) >= interval_ms) ) )
+      {
+         port_state->last_delivery_ms = now;
+         port_state->has_delivered = true;
+         self->stats.num_forwarded++;
+         retval = apx_nodeInstance_deliver_require_port_data(require_port, data, size);
+      }
+      else
+      {
+         if (port_state->has_pending)
+         {
+            self->stats.num_dropped++;
+         }
+         memcpy(port_state->pending_data, data, size);
+         port_state->pending_size = size;
+         port_state->has_pending = true;
+         if (!port_state->timer.is_scheduled)
+         {
+            schedule_pending_value(self, port_state, interval_ms);
+         }
+      }
+      MUTEX_UNLOCK(self->lock);
+      return retval;
+   }
+   return APX_INVALID_ARGUMENT_ERROR;
+}
+
+/**
+ * Forgets all require ports of node_instance. Pending values are discarded. Must be called before the node is deleted.
+ */
+void apx_rateLimiter_remove_node(apx_rateLimiter_t* self, struct apx_nodeInstance_tag* node_instance)
+{
+   if ( (self != NULL) && (node_instance != NULL) )
+   {
+      apx_size_t i;
+      MUTEX_LOCK(self->lock);
+      for (i = 0u; i < node_instance->num_require_ports; i++)
+      {
+         apx_portInstance_t* require_port = &node_instance->require_ports[i];
+         if (require_port->rate_limit != NULL)
+         {
+            delete_port_state(self, require_port->rate_limit);
+         }
+      }
+      MUTEX_UNLOCK(self->lock);
+   }
+}
+
+void apx_rateLimiter_get_stats(apx_rateLimiter_t* self, apx_rateLimiterStats_t* stats)
+{
+   if ( (self != NULL) && (stats != NULL) )
+   {
+      MUTEX_LOCK(self->lock);
+      memcpy(stats, &self->stats, sizeof(apx_rateLimiterStats_t));
+      MUTEX_UNLOCK(self->lock);
+   }
+}
+
+#ifdef UNIT_TEST
+void apx_rateLimiter_advance_time(apx_rateLimiter_t* self, uint32_t elapsed_ms)
+{
+   if (self != NULL)
+   {
+      MUTEX_LOCK(self->lock);
+      self->test_time_ms += elapsed_ms;
+      deliver_expired_values(self);
+      MUTEX_UNLOCK(self->lock);
+   }
+}
+#else
+apx_error_t apx_rateLimiter_start(apx_rateLimiter_t* self)
+{
+   if (self != NULL)
+   {
+      if (self->is_thread_valid == false)
+      {
+         self->exit_flag = false;
+         self->is_thread_valid = true;
+#ifdef _MSC_VER
+         THREAD_CREATE(self->thread, timer_task, self, self->thread_id);
+         if (self->thread == INVALID_HANDLE_VALUE)
+         {
+            self->is_thread_valid = false;
+            return APX_THREAD_CREATE_ERROR;
+         }
+#else
+         int rc = THREAD_CREATE(self->thread, timer_task, self);
+         if (rc != 0)
+         {
+            self->is_thread_valid = false;
+            return APX_THREAD_CREATE_ERROR;
+         }
+#endif
+      }
+      return APX_NO_ERROR;
+   }
+   return APX_INVALID_ARGUMENT_ERROR;
+}
+
+/**
+ * Stops the timer thread. Values still pending are not delivered.
+ */
+void apx_rateLimiter_stop(apx_rateLimiter_t* self)
+{
+   if ( (self != NULL) && (self->is_thread_valid) )
+   {
+      MUTEX_LOCK(self->lock);
+      self->exit_flag = true;
+      MUTEX_UNLOCK(self->lock);
+      SEMAPHORE_POST(self->wakeup_semaphore);
+#ifdef _MSC_VER
+      (void)WaitForSingleObject(self->thread, 5000);
+      CloseHandle(self->thread);
+      self->thread = INVALID_HANDLE_VALUE;
+#else
+      if (pthread_equal(pthread_self(), self->thread) == 0)
+      {
+         void* status;
+         (void)pthread_join(self->thread, &status);
+      }
+#endif
+      self->is_thread_valid = false;
+   }
+}
+#endif
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+static uint64_t current_time_ms(apx_rateLimiter_t* self)
+{
+#ifdef UNIT_TEST
+   return self->test_time_ms;
+#else
+   (void)self;
+   return apx_time_monotonic_ms();
+#endif
+}
+
+/*
+* Note: Caller must hold self->lock
+*/
+static apx_rateLimitedPort_t* create_port_state(apx_rateLimiter_t* self, apx_portInstance_t* require_port, apx_size_t size)
+{
+   apx_rateLimitedPort_t* port_state = (apx_rateLimitedPort_t*)malloc(sizeof(apx_rateLimitedPort_t));
+   if (port_state == NULL)
+   {
+      return NULL;
+   }
+   memset(port_state, 0, sizeof(apx_rateLimitedPort_t));
+   port_state->pending_data = (uint8_t*)malloc(size > 0u ? size : 1u);
+   if (port_state->pending_data == NULL)
+   {
+      free(port_state);
+      return NULL;
+   }
+   apx_timerWheelEntry_create(&port_state->timer);
+   port_state->require_port = require_port;
+   port_state->data_size = size;
+   port_state->next_port = self->ports;
+   port_state->prev_port = NULL;
+   if (self->ports != NULL)
+   {
+      self->ports->prev_port = port_state;
+   }
+   self->ports = port_state;
+   require_port->rate_limit = port_state;
+   return port_state;
+}
+
+/*
+* Note: Caller must hold self->lock
+*/
+static void delete_port_state(apx_rateLimiter_t* self, apx_rateLimitedPort_t* port_state)
+{
+   apx_timerWheel_cancel(&self->timer_wheel, &port_state->timer);
+   if (port_state->prev_port != NULL)
+   {
+      port_state->prev_port->next_port = port_state->next_port;
+   }
+   else
+   {
+      self->ports = port_state->next_port;
+   }
+   if (port_state->next_port != NULL)
+   {
+      port_state->next_port->prev_port = port_state->prev_port;
+   }
+   port_state->require_port->rate_limit = NULL;
+   free(port_state->pending_data);
+   free(port_state);
+}
+
+/*
+* Note: Caller must hold self->lock
+*/
+static void schedule_pending_value(apx_rateLimiter_t* self, apx_rateLimitedPort_t* port_state, uint32_t interval_ms)
+{
+   uint64_t const due_ms = port_state->last_delivery_ms + interval_ms;
+   uint64_t const due_tick = (due_ms + self->tick_ms - 1u) / self->tick_ms; //round up, never deliver early
+   bool const was_idle = (apx_timerWheel_num_scheduled(&self->timer_wheel) == 0u);
+   if (was_idle)
+   {
+      //The wheel does not move while it is empty, bring it up to date before scheduling
+      (void)apx_timerWheel_advance(&self->timer_wheel, current_time_ms(self) / self->tick_ms);
+   }
+   apx_timerWheel_schedule(&self->timer_wheel, &port_state->timer, due_tick);
+#ifndef UNIT_TEST
+   if (was_idle)
+   {
+      SEMAPHORE_POST(self->wakeup_semaphore);
+   }
+#endif
+}
+
+/*
+* Note: Caller must hold self->lock
+*/
+static void deliver_expired_values(apx_rateLimiter_t* self)
+{
+   uint64_t const now = current_time_ms(self);
+   apx_timerWheelEntry_t* expired = apx_timerWheel_advance(&self->timer_wheel, now / self->tick_ms);
+   while (expired != NULL)
+   {
+      apx_rateLimitedPort_t* port_state = (apx_rateLimitedPort_t*)expired; //timer is the first member
+      expired = expired->next;
+      if (port_state->has_pending)
+      {
+         port_state->has_pending = false;
+         port_state->last_delivery_ms = now;
+         self->stats.num_deferred++;
+         (void)apx_nodeInstance_deliver_require_port_data(port_state->require_port, port_state->pending_data, port_state->pending_size);
+      }
+   }
+}
+
+#ifndef UNIT_TEST
+static THREAD_PROTO(timer_task, arg)
+{
+   apx_rateLimiter_t* self = (apx_rateLimiter_t*)arg;
+   if (self != NULL)
+   {
+      for (;;)
+      {
+         bool exit_flag;
+         bool is_idle;
+         MUTEX_LOCK(self->lock);
+         exit_flag = self->exit_flag;
+         is_idle = (apx_timerWheel_num_scheduled(&self->timer_wheel) == 0u);
+         MUTEX_UNLOCK(self->lock);
+         if (exit_flag)
+         {
+            break;
+         }
+         if (is_idle)
+         {
+#ifdef _MSC_VER
+            (void)WaitForSingleObject(self->wakeup_semaphore, INFINITE);
+#else
+            (void)sem_wait(&self->wakeup_semaphore);
+#endif
+         }
+         else
+         {
+            SLEEP(self->tick_ms);
+         }
+         MUTEX_LOCK(self->lock);
+         if (!self->exit_flag)
+         {
+            deliver_expired_values(self);
+         }
+         MUTEX_UNLOCK(self->lock);
+      }
+   }
+   THREAD_RETURN(0);
+}
+#endif
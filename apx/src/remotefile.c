@@ -158,6 +158,55 @@ apx_size_t rmf_decode_cmd_type(uint8_t const* begin, uint8_t const* end, uint32_
    return 0u;
 }
 
+/**
+ * Header of a compressed message: command type, the address header of the original message and its uncompressed size.
+ * The LZ4 compressed data of the original message follows directly after the header.
+ */
+apx_size_t rmf_encode_compressed_msg_header(uint8_t* buf, apx_size_t buf_size, uint32_t address, bool more_bit, uint32_t uncompressed_size)
+{
+   apx_size_t const address_size = rmf_needed_encoding_size(address);
+   apx_size_t const required_size = RMF_CMD_TYPE_SIZE + address_size + UINT32_SIZE;
+   if ((buf == NULL) || (address > RMF_HIGH_ADDR_MAX) || (required_size > buf_size))
+   {
+      return 0u;
+   }
+   uint8_t* p = buf;
+   packLE(p, RMF_CMD_COMPRESSED_MSG, (uint8_t)UINT32_SIZE); p += UINT32_SIZE;
+   p += rmf_address_encode(p, address_size, address, more_bit);
+   packLE(p, uncompressed_size, (uint8_t)UINT32_SIZE);
+   return required_size;
+}
+
+apx_size_t rmf_decode_compressed_msg_header(uint8_t const* begin, uint8_t const* end, uint32_t* address, bool* more_bit, uint32_t* uncompressed_size)
+{
+   uint32_t cmd_type = 0u;
+   uint8_t const* p = begin;
+   apx_size_t decoded_size;
+   if ((address == NULL) || (more_bit == NULL) || (uncompressed_size == NULL))
+   {
+      return 0u;
+   }
+   decoded_size = rmf_decode_cmd_type(p, end, &cmd_type);
+   if ((decoded_size == 0u) || (cmd_type != RMF_CMD_COMPRESSED_MSG))
+   {
+      return 0u;
+   }
+   p += decoded_size;
+   decoded_size = rmf_address_decode(p, end, address, more_bit);
+   if (decoded_size == 0u)
+   {
+      return 0u;
+   }
+   p += decoded_size;
+   if (p + UINT32_SIZE > end)
+   {
+      return 0u;
+   }
+   *uncompressed_size = unpackLE(p, (uint8_t)UINT32_SIZE);
+   p += UINT32_SIZE;
+   return (apx_size_t)(p - begin);
+}
+
 
 
 
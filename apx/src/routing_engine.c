@@ -0,0 +1,568 @@
+/*****************************************************************************
+* \file      routing_engine.c
+* \author    Conny Gustafsson
+* \date      2026-10-18
+* \brief     Sharded data routing engine
+*
+* Copyright (c) 2026 Conny Gustafsson
+* Permission is hereby granted, free of charge, to any person obtaining a copy of
+* this software and associated documentation files (the "Software"), to deal in
+* the Software without restriction, including without limitation the rights to
+* use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+* the Software, and to permit persons to whom the Software is furnished to do so,
+* subject to the following conditions:
+
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+* FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+* COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+* IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+* CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+******************************************************************************/
+//////////////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////////////
+#include <assert.h>
+#include <string.h>
+#include <malloc.h>
+#include <stdio.h>
+#ifdef _WIN32
+#include <process.h>
+#endif
+#include "apx/routing_engine.h"
+#include "apx/node_instance.h"
+#ifdef MEM_LEAK_CHECK
+#include "CMemLeak.h"
+#endif
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE CONSTANTS AND DATA TYPES
+//////////////////////////////////////////////////////////////////////////////
+#define FNV1A_32_OFFSET_BASIS 2166136261u
+#define FNV1A_32_PRIME 16777619u
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////////////
+static void apx_routingShard_create(apx_routingShard_t* self, uint32_t shard_id);
+static void apx_routingShard_destroy(apx_routingShard_t* self);
+static bool apx_routingShard_append(apx_routingShard_t* self, apx_routingUpdate_t* update);
+static apx_routingUpdate_t* apx_routingShard_remove_all(apx_routingShard_t* self);
+static int32_t apx_routingShard_process_batch(apx_routingShard_t* self, apx_routingUpdate_t* batch);
+static apx_routingUpdate_t* apx_routingUpdate_new(apx_portInstance_t* provide_port, uint8_t const* data, apx_size_t size);
+static void apx_routingUpdate_delete_list(apx_routingUpdate_t* update);
+static uint32_t hash_port_signature(char const* port_signature);
+#ifndef UNIT_TEST
+static apx_error_t apx_routingShard_start_thread(apx_routingShard_t* self);
+static void apx_routingShard_stop_thread(apx_routingShard_t* self);
+static void apx_routingShard_flush(apx_routingShard_t* self);
+static THREAD_PROTO(shard_task, arg);
+#endif
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE VARIABLES
+//////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////
+// PUBLIC FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+apx_error_t apx_routingEngine_create(apx_routingEngine_t* self, uint32_t num_shards)
+{
+   if ( (self != NULL) && (num_shards > 0u) && (num_shards <= APX_ROUTING_ENGINE_MAX_SHARDS) )
+   {
+      uint32_t i;
+      self->shards = (apx_routingShard_t*)malloc(num_shards * sizeof(apx_routingShard_t));
+      if (self->shards == NULL)
+      {
+         return APX_MEM_ERROR;
+      }
+      self->num_shards = num_shards;
+      for (i = 0u; i < num_shards; i++)
+      {
+         apx_routingShard_create(&self->shards[i], i);
+      }
+      adt_hash_create(&self->pinned_signatures, NULL);
+      return APX_NO_ERROR;
+   }
+   return APX_INVALID_ARGUMENT_ERROR;
+}
+
+void apx_routingEngine_destroy(apx_routingEngine_t* self)
+{
+   if (self != NULL)
+   {
+      uint32_t i;
+#ifndef UNIT_TEST
+      apx_routingEngine_stop(self);
+#endif
+      for (i = 0u; i < self->num_shards; i++)
+      {
+         apx_routingShard_destroy(&self->shards[i]);
+      }
+      free(self->shards);
+      self->shards = NULL;
+      self->num_shards = 0u;
+      adt_hash_destroy(&self->pinned_signatures);
+   }
+}
+
+apx_routingEngine_t* apx_routingEngine_new(uint32_t num_shards)
+{
+   apx_routingEngine_t* self = (apx_routingEngine_t*)malloc(sizeof(apx_routingEngine_t));
+   if (self != NULL)
+   {
+      apx_error_t result = apx_routingEngine_create(self, num_shards);
+      if (result != APX_NO_ERROR)
+      {
+         free(self);
+         self = NULL;
+      }
+   }
+   return self;
+}
+
+void apx_routingEngine_delete(apx_routingEngine_t* self)
+{
+   if (self != NULL)
+   {
+      apx_routingEngine_destroy(self);
+      free(self);
+   }
+}
+
+uint32_t apx_routingEngine_num_shards(apx_routingEngine_t const* self)
+{
+   if (self != NULL)
+   {
+      return self->num_shards;
+   }
+   return 0u;
+}
+
+/**
+ * Overrides the hash based shard selection for one port signature.
+ * Must be called before any node using the signature is connected.
+ */
+apx_error_t apx_routingEngine_pin_signature(apx_routingEngine_t* self, char const* port_signature, uint32_t shard_id)
+{
+   if ( (self != NULL) && (port_signature != NULL) && (shard_id < self->num_shards) )
+   {
+      adt_error_t rc = adt_hash_set(&self->pinned_signatures, port_signature, (void*)(((uintptr_t)shard_id) + 1u));
+      return (rc == ADT_NO_ERROR) ? APX_NO_ERROR : APX_MEM_ERROR;
+   }
+   return APX_INVALID_ARGUMENT_ERROR;
+}
+
+uint32_t apx_routingEngine_shard_of(apx_routingEngine_t* self, char const* port_signature)
+{
+   if ( (self != NULL) && (port_signature != NULL) )
+   {
+      void** pinned = adt_hash_get(&self->pinned_signatures, port_signature);
+      if (pinned != NULL)
+      {
+         return (uint32_t)(((uintptr_t)*pinned) - 1u);
+      }
+      return hash_port_signature(port_signature) % self->num_shards;
+   }
+   return 0u;
+}
+
+/**
+ * Selects the shard of each provide port in the node. Called when the provide ports are connected to the server.
+ */
+void apx_routingEngine_assign_shards(apx_routingEngine_t* self, struct apx_nodeInstance_tag* node_instance)
+{
+   if ( (self != NULL) && (node_instance != NULL) )
+   {
+      apx_portId_t port_id;
+      apx_size_t const num_provide_ports = apx_nodeInstance_get_num_provide_ports(node_instance);
+      for (port_id = 0u; port_id < num_provide_ports; port_id++)
+      {
+         apx_portInstance_t* port_instance = apx_nodeInstance_get_provide_port(node_instance, port_id);
+         if (port_instance != NULL)
+         {
+            bool has_dynamic_data = false;
+            char const* port_signature = apx_portInstance_get_port_signature(port_instance, &has_dynamic_data);
+            port_instance->routing_shard = apx_routingEngine_shard_of(self, port_signature);
+         }
+      }
+   }
+}
+
+/**
+ * Queues a copy of a new provide port value on the shard of its port. The value is routed to all requesters
+ * connected to the port at the time the shard processes it.
+ */
+apx_error_t apx_routingEngine_post(apx_routingEngine_t* self, apx_portInstance_t* provide_port, uint8_t const* data, apx_size_t size)
+{
+   if ( (self != NULL) && (provide_port != NULL) && (data != NULL) && (size > 0u) )
+   {
+      apx_routingShard_t* shard = &self->shards[provide_port->routing_shard % self->num_shards];
+      apx_routingUpdate_t* update = apx_routingUpdate_new(provide_port, data, size);
+      bool wake_consumer;
+      if (update == NULL)
+      {
+         return APX_MEM_ERROR;
+      }
+      wake_consumer = apx_routingShard_append(shard, update);
+#ifndef UNIT_TEST
+      if (wake_consumer)
+      {
+         SEMAPHORE_POST(shard->semaphore);
+      }
+#else
+      (void)wake_consumer;
+#endif
+      return APX_NO_ERROR;
+   }
+   return APX_INVALID_ARGUMENT_ERROR;
+}
+
+/**
+ * Returns once every update posted before the call has been routed.
+ * Used before nodes are deleted since queued updates only keep weak references to their provide ports.
+ */
+void apx_routingEngine_flush(apx_routingEngine_t* self)
+{
+   if (self != NULL)
+   {
+      uint32_t i;
+      for (i = 0u; i < self->num_shards; i++)
+      {
+         apx_routingShard_t* shard = &self->shards[i];
+#ifndef UNIT_TEST
+         if (shard->is_thread_valid)
+         {
+            apx_routingShard_flush(shard);
+            continue;
+         }
+#endif
+         (void)apx_routingShard_process_batch(shard, apx_routingShard_remove_all(shard));
+      }
+   }
+}
+
+void apx_routingEngine_get_shard_stats(apx_routingEngine_t* self, uint32_t shard_id, apx_routingShardStats_t* stats)
+{
+   if ( (self != NULL) && (shard_id < self->num_shards) && (stats != NULL) )
+   {
+      apx_routingShard_t* shard = &self->shards[shard_id];
+      SPINLOCK_ENTER(shard->lock);
+      memcpy(stats, &shard->stats, sizeof(apx_routingShardStats_t));
+      SPINLOCK_LEAVE(shard->lock);
+   }
+}
+
+#ifdef UNIT_TEST
+/**
+ * Routes all queued updates on the calling thread. Returns number of updates routed.
+ */
+int32_t apx_routingEngine_run(apx_routingEngine_t* self)
+{
+   if (self != NULL)
+   {
+      int32_t total = 0;
+      uint32_t i;
+      for (i = 0u; i < self->num_shards; i++)
+      {
+         apx_routingShard_t* shard = &self->shards[i];
+         total += apx_routingShard_process_batch(shard, apx_routingShard_remove_all(shard));
+      }
+      return total;
+   }
+   return -1;
+}
+#else
+apx_error_t apx_routingEngine_start(apx_routingEngine_t* self)
+{
+   if (self != NULL)
+   {
+      uint32_t i;
+      for (i = 0u; i < self->num_shards; i++)
+      {
+         apx_error_t result = apx_routingShard_start_thread(&self->shards[i]);
+         if (result != APX_NO_ERROR)
+         {
+            apx_routingEngine_stop(self);
+            return result;
+         }
+      }
+      return APX_NO_ERROR;
+   }
+   return APX_INVALID_ARGUMENT_ERROR;
+}
+
+/**
+ * Stops all shard threads. Updates still in the queues are routed before the threads exit.
+ */
+void apx_routingEngine_stop(apx_routingEngine_t* self)
+{
+   if (self != NULL)
+   {
+      uint32_t i;
+      for (i = 0u; i < self->num_shards; i++)
+      {
+         apx_routingShard_stop_thread(&self->shards[i]);
+      }
+   }
+}
+#endif
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+static void apx_routingShard_create(apx_routingShard_t* self, uint32_t shard_id)
+{
+   assert(self != NULL);
+   memset(self, 0, sizeof(apx_routingShard_t));
+   self->shard_id = shard_id;
+   SPINLOCK_INIT(self->lock);
+   SEMAPHORE_CREATE(self->semaphore);
+}
+
+static void apx_routingShard_destroy(apx_routingShard_t* self)
+{
+   assert(self != NULL);
+   apx_routingUpdate_delete_list(self->head);
+   self->head = NULL;
+   self->tail = NULL;
+   SPINLOCK_DESTROY(self->lock);
+   SEMAPHORE_DESTROY(self->semaphore);
+}
+
+/**
+ * Appends update to the end of the queue. Returns true if the shard thread needs to be woken up.
+ */
+static bool apx_routingShard_append(apx_routingShard_t* self, apx_routingUpdate_t* update)
+{
+   bool wake_consumer = false;
+   SPINLOCK_ENTER(self->lock);
+   if (self->tail == NULL)
+   {
+      self->head = update;
+   }
+   else
+   {
+      self->tail->next = update;
+   }
+   self->tail = update;
+   if (self->is_consumer_waiting)
+   {
+      self->is_consumer_waiting = false;
+      wake_consumer = true;
+   }
+   SPINLOCK_LEAVE(self->lock);
+   return wake_consumer;
+}
+
+static apx_routingUpdate_t* apx_routingShard_remove_all(apx_routingShard_t* self)
+{
+   apx_routingUpdate_t* batch;
+   SPINLOCK_ENTER(self->lock);
+   batch = self->head;
+   self->head = NULL;
+   self->tail = NULL;
+   if (batch != NULL)
+   {
+      self->stats.num_batches++;
+   }
+   SPINLOCK_LEAVE(self->lock);
+   return batch;
+}
+
+/**
+ * Routes all updates in the batch (in the order they were posted) and frees them. Returns number of values routed.
+ */
+static int32_t apx_routingShard_process_batch(apx_routingShard_t* self, apx_routingUpdate_t* batch)
+{
+   int32_t num_routed = 0;
+   while (batch != NULL)
+   {
+      apx_routingUpdate_t* next = batch->next;
+      if (batch->provide_port != NULL)
+      {
+         apx_error_t result = apx_nodeInstance_route_provide_port_data(batch->provide_port, batch->data, batch->data_size);
+         if ( (result != APX_NO_ERROR) && (result != APX_FILE_NOT_OPEN_ERROR) )
+         {
+            fprintf(stderr, "[APX_ROUTING_ENGINE] Shard %u failed to route data (error %d)\n", (unsigned int)self->shard_id, (int)result);
+         }
+         num_routed++;
+      }
+      else if (batch->flush_semaphore != NULL)
+      {
+         SEMAPHORE_POST(*batch->flush_semaphore);
+      }
+      free(batch);
+      batch = next;
+   }
+   if (num_routed > 0)
+   {
+      SPINLOCK_ENTER(self->lock);
+      self->stats.num_updates += (uint32_t)num_routed;
+      SPINLOCK_LEAVE(self->lock);
+   }
+   return num_routed;
+}
+
+static apx_routingUpdate_t* apx_routingUpdate_new(apx_portInstance_t* provide_port, uint8_t const* data, apx_size_t size)
+{
+   apx_routingUpdate_t* self = (apx_routingUpdate_t*)malloc(sizeof(apx_routingUpdate_t) + size);
+   if (self != NULL)
+   {
+      self->next = NULL;
+      self->provide_port = provide_port;
+      self->data = (uint8_t*)(self + 1);
+      self->data_size = size;
+      self->flush_semaphore = NULL;
+      if (size > 0u)
+      {
+         memcpy(self->data, data, size);
+      }
+   }
+   return self;
+}
+
+static void apx_routingUpdate_delete_list(apx_routingUpdate_t* update)
+{
+   while (update != NULL)
+   {
+      apx_routingUpdate_t* next = update->next;
+      free(update);
+      update = next;
+   }
+}
+
+/**
+ * 32-bit FNV-1a
+ */
+static uint32_t hash_port_signature(char const* port_signature)
+{
+   uint32_t hash = FNV1A_32_OFFSET_BASIS;
+   uint8_t const* p = (uint8_t const*)port_signature;
+   while (*p != 0u)
+   {
+      hash ^= (uint32_t)*p++;
+      hash *= FNV1A_32_PRIME;
+   }
+   return hash;
+}
+
+#ifndef UNIT_TEST
+static apx_error_t apx_routingShard_start_thread(apx_routingShard_t* self)
+{
+   if (self->is_thread_valid == false)
+   {
+      self->exit_flag = false;
+      self->is_thread_valid = true;
+#ifdef _MSC_VER
+      THREAD_CREATE(self->thread, shard_task, self, self->thread_id);
+      if (self->thread == INVALID_HANDLE_VALUE)
+      {
+         self->is_thread_valid = false;
+         return APX_THREAD_CREATE_ERROR;
+      }
+#else
+      int rc = THREAD_CREATE(self->thread, shard_task, self);
+      if (rc != 0)
+      {
+         self->is_thread_valid = false;
+         return APX_THREAD_CREATE_ERROR;
+      }
+#endif
+   }
+   return APX_NO_ERROR;
+}
+
+static void apx_routingShard_stop_thread(apx_routingShard_t* self)
+{
+   if (self->is_thread_valid)
+   {
+      SPINLOCK_ENTER(self->lock);
+      self->exit_flag = true;
+      SPINLOCK_LEAVE(self->lock);
+      SEMAPHORE_POST(self->semaphore);
+#ifdef _MSC_VER
+      (void)WaitForSingleObject(self->thread, 5000);
+      CloseHandle(self->thread);
+      self->thread = INVALID_HANDLE_VALUE;
+#else
+      if (pthread_equal(pthread_self(), self->thread) == 0)
+      {
+         void* status;
+         (void)pthread_join(self->thread, &status);
+      }
+#endif
+      self->is_thread_valid = false;
+   }
+}
+
+/**
+ * Appends a marker to the queue and waits for the shard thread to reach it.
+ */
+static void apx_routingShard_flush(apx_routingShard_t* self)
+{
+   SEMAPHORE_T flush_semaphore;
+   apx_routingUpdate_t* marker = apx_routingUpdate_new(NULL, NULL, 0u);
+   if (marker == NULL)
+   {
+      return;
+   }
+   SEMAPHORE_CREATE(flush_semaphore);
+   marker->flush_semaphore = &flush_semaphore;
+   if (apx_routingShard_append(self, marker))
+   {
+      SEMAPHORE_POST(self->semaphore);
+   }
+#ifdef _MSC_VER
+   (void)WaitForSingleObject(flush_semaphore, INFINITE);
+#else
+   (void)sem_wait(&flush_semaphore);
+#endif
+   SEMAPHORE_DESTROY(flush_semaphore);
+}
+
+static THREAD_PROTO(shard_task, arg)
+{
+   apx_routingShard_t* self = (apx_routingShard_t*)arg;
+   if (self != NULL)
+   {
+      bool exit_flag = false;
+      while (exit_flag == false)
+      {
+         apx_routingUpdate_t* batch = NULL;
+         SPINLOCK_ENTER(self->lock);
+         exit_flag = self->exit_flag;
+         batch = self->head;
+         self->head = NULL;
+         self->tail = NULL;
+         if (batch != NULL)
+         {
+            self->stats.num_batches++;
+         }
+         else if (exit_flag == false)
+         {
+            self->is_consumer_waiting = true;
+            self->stats.num_wakeups++;
+         }
+         SPINLOCK_LEAVE(self->lock);
+         if (batch != NULL)
+         {
+            (void)apx_routingShard_process_batch(self, batch);
+         }
+         else if (exit_flag == false)
+         {
+#ifdef _MSC_VER
+            (void)WaitForSingleObject(self->semaphore, INFINITE);
+#else
+            (void)sem_wait(&self->semaphore);
+#endif
+         }
+      }
+   }
+   THREAD_RETURN(0);
+}
+#endif
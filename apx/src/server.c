@@ -90,6 +90,13 @@ void apx_server_create(apx_server_t *self)
       MUTEX_INIT(self->event_loop_lock);
       MUTEX_INIT(self->global_lock);
       MUTEX_INIT(self->event_listener_lock);
+      self->routing_engine = (apx_routingEngine_t*) 0;
+      self->fanout_pool = (apx_fanoutPool_t*) 0;
+      self->rate_limiter = apx_rateLimiter_new(APX_RATE_LIMITER_DEFAULT_TICK_MS);
+      self->change_only_routing = false;
+      self->compression_threshold = 0u;
+      apx_nodeCache_create(&self->node_cache, APX_SERVER_MODE);
+      self->is_node_cache_enabled = true;
 #ifdef _WIN32
       self->thread_id = 0u;
 #endif
@@ -111,7 +118,23 @@ void apx_server_destroy(apx_server_t *self)
       apx_connectionManager_destroy(&self->connection_manager);
       apx_portSignatureMap_destroy(&self->port_signature_map);
       MUTEX_UNLOCK(self->global_lock);
+      if (self->routing_engine != NULL)
+      {
+         apx_routingEngine_delete(self->routing_engine);
+         self->routing_engine = (apx_routingEngine_t*) 0;
+      }
+      if (self->fanout_pool != NULL)
+      {
+         apx_fanoutPool_delete(self->fanout_pool);
+         self->fanout_pool = (apx_fanoutPool_t*) 0;
+      }
+      if (self->rate_limiter != NULL)
+      {
+         apx_rateLimiter_delete(self->rate_limiter);
+         self->rate_limiter = (apx_rateLimiter_t*) 0;
+      }
       apx_eventLoop_destroy(&self->event_loop);
+      apx_nodeCache_destroy(&self->node_cache);
       MUTEX_DESTROY(self->event_loop_lock);
       MUTEX_DESTROY(self->global_lock);
       MUTEX_DESTROY(self->event_listener_lock);
@@ -144,6 +167,18 @@ void apx_server_start(apx_server_t *self)
    {
       apx_server_init_extensions(self);
 #ifndef UNIT_TEST
+      if (self->fanout_pool != NULL)
+      {
+         (void)apx_fanoutPool_start(self->fanout_pool);
+      }
+      if (self->rate_limiter != NULL)
+      {
+         (void)apx_rateLimiter_start(self->rate_limiter);
+      }
+      if (self->routing_engine != NULL)
+      {
+         (void)apx_routingEngine_start(self->routing_engine);
+      }
       apx_connectionManager_start(&self->connection_manager);
       if (self->is_event_thread_valid == false)
       {
@@ -160,6 +195,18 @@ void apx_server_stop(apx_server_t *self)
 
 #ifndef UNIT_TEST
       apx_connectionManager_stop(&self->connection_manager);
+      if (self->routing_engine != NULL)
+      {
+         apx_routingEngine_stop(self->routing_engine);
+      }
+      if (self->fanout_pool != NULL)
+      {
+         apx_fanoutPool_stop(self->fanout_pool);
+      }
+      if (self->rate_limiter != NULL)
+      {
+         apx_rateLimiter_stop(self->rate_limiter);
+      }
 #endif
       apx_server_shutdown_extensions(self);
 #ifndef UNIT_TEST
@@ -309,6 +356,10 @@ apx_error_t apx_server_connect_node_instance_provide_ports(apx_server_t* self, a
 {
    if ( (self != NULL) && (node_instance != 0) )
    {
+      if (self->routing_engine != NULL)
+      {
+         apx_routingEngine_assign_shards(self->routing_engine, node_instance);
+      }
       return apx_portSignatureMap_connect_provide_ports(&self->port_signature_map, node_instance);
    }
    return APX_INVALID_ARGUMENT_ERROR;
@@ -498,6 +549,187 @@ void apx_server_clear_port_connector_changes(apx_server_t* self)
    }
 }
 
+/**
+ * Partitions data routing into num_shards routing shards, each running on its own thread.
+ * Must be called before the server is started. Data is routed on the connection threads unless this is called.
+ */
+apx_error_t apx_server_enable_routing_shards(apx_server_t* self, uint32_t num_shards)
+{
+   if ( (self != NULL) && (num_shards > 0u) )
+   {
+      if (self->routing_engine != NULL)
+      {
+         return APX_INVALID_STATE_ERROR;
+      }
+      self->routing_engine = apx_routingEngine_new(num_shards);
+      if (self->routing_engine == NULL)
+      {
+         return (num_shards > APX_ROUTING_ENGINE_MAX_SHARDS) ? APX_INVALID_ARGUMENT_ERROR : APX_MEM_ERROR;
+      }
+      return APX_NO_ERROR;
+   }
+   return APX_INVALID_ARGUMENT_ERROR;
+}
+
+apx_error_t apx_server_pin_routing_signature(apx_server_t* self, const char* port_signature, uint32_t shard_id)
+{
+   if ( (self != NULL) && (port_signature != NULL) )
+   {
+      if (self->routing_engine == NULL)
+      {
+         return APX_INVALID_STATE_ERROR;
+      }
+      return apx_routingEngine_pin_signature(self->routing_engine, port_signature, shard_id);
+   }
+   return APX_INVALID_ARGUMENT_ERROR;
+}
+
+apx_routingEngine_t* apx_server_get_routing_engine(apx_server_t const* self)
+{
+   if (self != NULL)
+   {
+      return self->routing_engine;
+   }
+   return (apx_routingEngine_t*) 0;
+}
+
+/**
+ * Waits until all provide port data posted to the routing shards so far has been routed.
+ * Must not be called while holding the global lock or any node instance lock.
+ */
+void apx_server_flush_routing(apx_server_t* self)
+{
+   if ( (self != NULL) && (self->routing_engine != NULL) )
+   {
+      apx_routingEngine_flush(self->routing_engine);
+   }
+}
+
+/**
+ * Provide ports with at least threshold connected require ports have their connectors split across
+ * num_workers threads (plus the routing thread) each time a new value is routed.
+ * Must be called before the server is started.
+ */
+apx_error_t apx_server_enable_parallel_fanout(apx_server_t* self, uint32_t num_workers, int32_t threshold)
+{
+   if ( (self != NULL) && (num_workers > 0u) )
+   {
+      if (self->fanout_pool != NULL)
+      {
+         return APX_INVALID_STATE_ERROR;
+      }
+      self->fanout_pool = apx_fanoutPool_new(num_workers, threshold);
+      if (self->fanout_pool == NULL)
+      {
+         return ( (num_workers > APX_FANOUT_POOL_MAX_WORKERS) || (threshold < 2) ) ? APX_INVALID_ARGUMENT_ERROR : APX_MEM_ERROR;
+      }
+      return APX_NO_ERROR;
+   }
+   return APX_INVALID_ARGUMENT_ERROR;
+}
+
+apx_fanoutPool_t* apx_server_get_fanout_pool(apx_server_t const* self)
+{
+   if (self != NULL)
+   {
+      return self->fanout_pool;
+   }
+   return (apx_fanoutPool_t*) 0;
+}
+
+/**
+ * Sets the default routing mode for all nodes. Must be called before the server is started.
+ */
+void apx_server_set_change_only_routing(apx_server_t* self, bool enabled)
+{
+   if (self != NULL)
+   {
+      self->change_only_routing = enabled;
+   }
+}
+
+bool apx_server_is_change_only_routing(apx_server_t const* self)
+{
+   if (self != NULL)
+   {
+      return self->change_only_routing;
+   }
+   return false;
+}
+
+apx_rateLimiter_t* apx_server_get_rate_limiter(apx_server_t const* self)
+{
+   if (self != NULL)
+   {
+      return self->rate_limiter;
+   }
+   return (apx_rateLimiter_t*) 0;
+}
+
+/**
+ * Accepts message compression from clients that offer it in their greeting.
+ * Messages of at least threshold bytes are then compressed in both directions. 0 disables compression.
+ * Must be called before the server is started.
+ */
+void apx_server_enable_compression(apx_server_t* self, uint32_t threshold)
+{
+   if (self != NULL)
+   {
+      if ( (threshold > 0u) && (threshold < APX_COMPRESSION_MIN_THRESHOLD) )
+      {
+         threshold = APX_COMPRESSION_MIN_THRESHOLD;
+      }
+      self->compression_threshold = threshold;
+   }
+}
+
+uint32_t apx_server_get_compression_threshold(apx_server_t const* self)
+{
+   if (self != NULL)
+   {
+      return self->compression_threshold;
+   }
+   return 0u;
+}
+
+/**
+ * Sums the compression statistics of all active connections.
+ */
+void apx_server_get_compression_stats(apx_server_t* self, apx_compressionStats_t* stats)
+{
+   if ( (self != NULL) && (stats != NULL) )
+   {
+      apx_connectionManager_get_compression_stats(&self->connection_manager, stats);
+   }
+}
+
+/**
+ * Must be called before connections are accepted. A max_size of 0 keeps the current limit.
+ */
+void apx_server_configure_node_cache(apx_server_t* self, bool enabled, apx_size_t max_size)
+{
+   if (self != NULL)
+   {
+      self->is_node_cache_enabled = enabled;
+      if (max_size > 0u)
+      {
+         apx_nodeCache_set_max_size(&self->node_cache, max_size);
+      }
+   }
+}
+
+/**
+ * Returns NULL when the node cache is disabled
+ */
+apx_nodeCache_t* apx_server_get_node_cache(apx_server_t* self)
+{
+   if ( (self != NULL) && self->is_node_cache_enabled )
+   {
+      return &self->node_cache;
+   }
+   return NULL;
+}
+
 #ifdef UNIT_TEST
 void apx_server_run(apx_server_t *self)
 {
@@ -505,6 +737,10 @@ void apx_server_run(apx_server_t *self)
    {
       apx_eventLoop_runAll(&self->event_loop, apx_server_handle_event, (void*) self);
       apx_connectionManager_run(&self->connection_manager);
+      if (self->routing_engine != NULL)
+      {
+         (void)apx_routingEngine_run(self->routing_engine);
+      }
    }
 }
 
@@ -57,7 +57,8 @@ static apx_error_t process_new_provide_port_data_file(apx_serverConnection_t* se
 static apx_error_t create_new_node_instance(apx_serverConnection_t* self, apx_nodeManager_t* node_manager,  apx_file_t* definition_file);
 static apx_error_t remote_file_write_notification(apx_serverConnection_t* self, apx_file_t* file, uint32_t offset, uint8_t const* data, apx_size_t size);
 static uint8_t const* parse_message(apx_serverConnection_t* self, uint8_t const* begin, uint8_t const* end, apx_error_t* error_code);
-static bool process_greeting_message(uint8_t const* msg_data, apx_size_t msg_size, apx_error_t* error_code);
+static bool process_greeting_message(apx_serverConnection_t* self, uint8_t const* msg_data, apx_size_t msg_size, apx_error_t* error_code);
+static void apply_capabilities(apx_serverConnection_t* self, apx_capabilities_t const* peer_capabilities);
 static void apx_serverConnection_node_created_notification(apx_serverConnection_t* self, apx_nodeInstance_t* node_instance);
 static apx_error_t detach_all_nodes(apx_serverConnection_t* self);
 static void remove_nodes_from_signature_map(apx_serverConnection_t* self, adt_ary_t* node_instance_array);
@@ -264,6 +265,7 @@ void apx_serverConnection_set_server(apx_serverConnection_t* self, struct apx_se
    if (self != NULL)
    {
       self->parent = server;
+      apx_nodeManager_set_node_cache(apx_connectionBase_get_node_manager(&self->base), apx_server_get_node_cache(server));
    }
 }
 
@@ -406,9 +408,15 @@ static apx_error_t create_new_node_instance(apx_serverConnection_t* self, apx_no
             return apx_fileManager_send_open_file_request(file_manager, apx_file_get_address_without_flags(definition_file));
          }
       }
+      else if (node_instance != NULL)
+      {
+         //Definition data was taken from node cache, continue as if the client had just written it
+         apx_nodeInstance_set_definition_data_state(node_instance, APX_DATA_STATE_CONNECTED);
+         retval = apx_nodeManager_on_definition_data_written(node_manager, node_instance, 0u, (apx_size_t)rmf_fileInfo_size(file_info));
+      }
       else
       {
-         retval = APX_NOT_IMPLEMENTED_ERROR; //Retriving data from cache not yet implemented
+         retval = APX_NULL_PTR_ERROR;
       }
    }
    return retval;
@@ -459,7 +467,7 @@ static uint8_t const* parse_message(apx_serverConnection_t* self, uint8_t const*
             }
             else
             {
-               if (process_greeting_message(msg_data, msg_size, error_code))
+               if (process_greeting_message(self, msg_data, msg_size, error_code))
                {
                   apx_serverConnection_greeting_header_accepted_notification(self);
                }
@@ -484,11 +492,13 @@ static uint8_t const* parse_message(apx_serverConnection_t* self, uint8_t const*
    return msg_end;
 }
 
-static bool process_greeting_message(uint8_t const* msg_data, apx_size_t msg_size, apx_error_t* error_code)
+static bool process_greeting_message(apx_serverConnection_t* self, uint8_t const* msg_data, apx_size_t msg_size, apx_error_t* error_code)
 {
    const uint8_t* next = msg_data;
    const uint8_t* end = msg_data + msg_size;
+   apx_capabilities_t peer_capabilities;
    assert( (msg_data != NULL) && (error_code != NULL) );
+   apx_capabilities_create(&peer_capabilities, 0u, 0u, 0u);
    while (next < end)
    {
       const uint8_t* result;
@@ -503,17 +513,21 @@ static bool process_greeting_message(uint8_t const* msg_data, apx_size_t msg_siz
          if (length_of_line == 0)
          {
             //this ends the header
+            apply_capabilities(self, &peer_capabilities);
             return true;
          }
          else
          {
-            //TODO: parse greeting line
             if (length_of_line < MAX_HEADER_LEN)
             {
                char tmp[MAX_HEADER_LEN + 1];
                memcpy(tmp, mark, length_of_line);
                tmp[length_of_line] = 0;
                //printf("\tgreeting-line: '%s'\n",tmp);
+               if (!apx_capabilities_parse_header_line(&peer_capabilities, tmp, tmp + length_of_line))
+               {
+                  apx_connectionBase_greeting_header_notification(&self->base, tmp);
+               }
             }
          }
       }
@@ -526,6 +540,26 @@ static bool process_greeting_message(uint8_t const* msg_data, apx_size_t msg_siz
    return false;
 }
 
+/**
+ * Agrees on capabilities with what the client announced. The acknowledge tells the client what was agreed.
+ */
+static void apply_capabilities(apx_serverConnection_t* self, apx_capabilities_t const* peer_capabilities)
+{
+   apx_capabilities_t local_capabilities;
+   apx_capabilities_t capabilities;
+   uint32_t const threshold = apx_server_get_compression_threshold(self->parent);
+   apx_connectionBase_get_local_capabilities(&self->base, &local_capabilities);
+   //Early provide port data is buffered by the file manager, the server can always accept pipelined open
+   local_capabilities.flags |= APX_CAPABILITY_PIPELINED_OPEN;
+   if (threshold > 0u)
+   {
+      local_capabilities.flags |= APX_CAPABILITY_COMPRESSION;
+   }
+   apx_fileManager_set_capabilities(&self->base.file_manager, &local_capabilities, peer_capabilities);
+   apx_fileManager_get_capabilities(&self->base.file_manager, &capabilities);
+   apx_fileManager_set_compression_threshold(&self->base.file_manager, apx_capabilities_has(&capabilities, APX_CAPABILITY_COMPRESSION) ? threshold : 0u);
+}
+
 static void apx_serverConnection_node_created_notification(apx_serverConnection_t* self, apx_nodeInstance_t* node_instance)
 {
    if ( (self != NULL) && (node_instance != NULL))
@@ -572,6 +606,8 @@ static apx_error_t detach_all_nodes(apx_serverConnection_t* self)
       adt_ary_destroy(&node_instance_array);
       process_disconnected_provider_nodes(&provide_connector_change_array);
       process_disconnected_requester_nodes(&require_connector_change_array);
+      //Routing shards only hold weak references to provide ports, drain them before the nodes are deleted
+      apx_server_flush_routing(self->parent);
       adt_ary_destroy(&provide_connector_change_array);
       adt_ary_destroy(&require_connector_change_array);
       return result;
@@ -257,20 +257,40 @@ apx_nodeManager_t* apx_serverTestConnection_get_node_manager(apx_serverTestConne
 
 apx_error_t apx_serverTestConnection_send_greeting_header(apx_serverTestConnection_t* self)
 {
-   if (self != NULL)
+   return apx_serverTestConnection_send_greeting_header_with_lines(self, "");
+}
+
+/**
+ * header_lines are inserted before the empty line that ends the greeting. Each line must end with '\n'.
+ */
+apx_error_t apx_serverTestConnection_send_greeting_header_with_lines(apx_serverTestConnection_t* self, char const* header_lines)
+{
+   if ( (self != NULL) && (header_lines != NULL) )
    {
       apx_size_t greeting_size = 0u;
       apx_size_t parse_len = 0u;
+      int32_t header_size;
       int num_header_format = 32;
       char greeting[RMF_GREETING_MAX_LEN];
-      char* p = &greeting[1];
+      uint8_t buffer[NUMHEADER32_LONG_SIZE + RMF_GREETING_MAX_LEN];
+      char* p = &greeting[0];
       strcpy(greeting, RMF_GREETING_START);
       p += strlen(greeting);
-      p += sprintf(p, "%s%d\n\n", RMF_NUMHEADER_FORMAT_HDR, num_header_format);
-      greeting_size = (apx_size_t)(p - greeting - NUMHEADER32_SHORT_SIZE);
-      greeting[0] = (char)greeting_size;
-      int result = apx_serverConnection_on_data_received(&self->base, (uint8_t const*)greeting, greeting_size + NUMHEADER32_SHORT_SIZE, &parse_len);
-      if ( (result == 0) && (parse_len == greeting_size + NUMHEADER32_SHORT_SIZE) )
+      p += sprintf(p, "%s%d\n", RMF_NUMHEADER_FORMAT_HDR, num_header_format);
+      if (strlen(header_lines) + 2u > sizeof(greeting) - (size_t)(p - greeting))
+      {
+         return APX_LENGTH_ERROR;
+      }
+      p += sprintf(p, "%s\n", header_lines);
+      greeting_size = (apx_size_t)(p - greeting);
+      header_size = numheader_encode32(buffer, (int32_t)sizeof(buffer), (uint32_t)greeting_size);
+      if (header_size <= 0)
+      {
+         return APX_INTERNAL_ERROR;
+      }
+      memcpy(&buffer[header_size], greeting, greeting_size);
+      int result = apx_serverConnection_on_data_received(&self->base, buffer, greeting_size + (apx_size_t)header_size, &parse_len);
+      if ( (result == 0) && (parse_len == greeting_size + (apx_size_t)header_size) )
       {
          return APX_NO_ERROR;
       }
@@ -310,6 +330,14 @@ apx_error_t apx_serverTestConnection_request_open_local_file(apx_serverTestConne
 }
 
 apx_error_t apx_serverTestConnection_publish_remote_file(apx_serverTestConnection_t* self, uint32_t address, char const* file_name, apx_size_t file_size)
+{
+   return apx_serverTestConnection_publish_remote_file_with_digest(self, address, file_name, file_size, NULL);
+}
+
+/**
+ * Publishes a fixed file with SHA-256 digest. Passing NULL as digest_data publishes the file without digest.
+ */
+apx_error_t apx_serverTestConnection_publish_remote_file_with_digest(apx_serverTestConnection_t* self, uint32_t address, char const* file_name, apx_size_t file_size, uint8_t const* digest_data)
 {
    if (self != NULL && file_name != NULL)
    {
@@ -323,7 +351,12 @@ apx_error_t apx_serverTestConnection_publish_remote_file(apx_serverTestConnectio
       {
          return APX_INTERNAL_ERROR;
       }
-      file_info = rmf_fileInfo_make_fixed(file_name, file_size, address);
+      file_info = rmf_fileInfo_make_fixed_with_digest(file_name, file_size, address,
+         (digest_data != NULL) ? RMF_DIGEST_TYPE_SHA256 : RMF_DIGEST_TYPE_NONE, digest_data);
+      if (file_info == NULL)
+      {
+         return APX_MEM_ERROR;
+      }
       apx_size_t const max_cmd_size = sizeof(buffer) - RMF_HIGH_ADDR_SIZE;
       apx_size_t const cmd_size = rmf_encode_publish_file_cmd(buffer + RMF_HIGH_ADDR_SIZE, max_cmd_size, file_info);
       rmf_fileInfo_delete(file_info);
@@ -337,13 +370,18 @@ apx_error_t apx_serverTestConnection_publish_remote_file(apx_serverTestConnectio
 }
 
 apx_error_t apx_serverTestConnection_write_remote_data(apx_serverTestConnection_t* self, uint32_t address, uint8_t const* payload_data, apx_size_t payload_size)
+{
+   return apx_serverTestConnection_write_remote_fragment(self, address, payload_data, payload_size, false);
+}
+
+apx_error_t apx_serverTestConnection_write_remote_fragment(apx_serverTestConnection_t* self, uint32_t address, uint8_t const* payload_data, apx_size_t payload_size, bool more_bit)
 {
    if ((self != NULL) && (payload_size > 0))
    {
       uint8_t header[RMF_HIGH_ADDR_SIZE];
       apx_fileManager_t* file_manager = apx_serverConnection_get_file_manager(&self->base);
       assert(file_manager != NULL);
-      apx_size_t header_size = (apx_size_t)rmf_address_encode(header, sizeof(header), address, false);
+      apx_size_t header_size = (apx_size_t)rmf_address_encode(header, sizeof(header), address, more_bit);
       if (header_size == 0u)
       {
          return APX_INTERNAL_ERROR;
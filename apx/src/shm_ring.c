@@ -0,0 +1,545 @@
+/*****************************************************************************
+* \file      shm_ring.c
+* \author    Conny Gustafsson
+* \date      2026-10-18
+* \brief     Single-producer/single-consumer ring buffer placed in shared memory
+*
+* Copyright (c) 2026 Conny Gustafsson
+* Permission is hereby granted, free of charge, to any person obtaining a copy of
+* this software and associated documentation files (the "Software"), to deal in
+* the Software without restriction, including without limitation the rights to
+* use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+* the Software, and to permit persons to whom the Software is furnished to do so,
+* subject to the following conditions:
+
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+* FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+* COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+* IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+* CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+******************************************************************************/
+//////////////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////////////
+#include <string.h>
+#include <assert.h>
+#include <limits.h>
+#ifdef _MSC_VER
+# ifndef WIN32_LEAN_AND_MEAN
+# define WIN32_LEAN_AND_MEAN
+# endif
+#include <Windows.h>
+#endif
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <time.h>
+#endif
+#include "apx/shm_ring.h"
+#include "osmacro.h"
+#ifdef MEM_LEAK_CHECK
+#include "CMemLeak.h"
+#endif
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE CONSTANTS AND DATA TYPES
+//////////////////////////////////////////////////////////////////////////////
+#define WRAP_MARKER 0xFFFFFFFFu //Written in length field when the rest of the data area is unused
+#define ALIGN_SIZE(x) (((x) + (APX_SHM_RING_ALIGNMENT - 1u)) & ~(APX_SHM_RING_ALIGNMENT - 1u))
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////////////
+static bool is_power_of_two(uint32_t value);
+static bool is_valid_span(apx_shmRing_t const* self, uint32_t begin, uint32_t end);
+static void set_corrupt(apx_shmRing_t* self);
+static uint32_t bytes_free(apx_shmRing_t* self, uint32_t needed);
+static uint32_t required_space(apx_shmRing_t const* self, uint32_t size);
+static bool open_record(apx_shmRing_t* self, uint32_t size);
+static void close_record(apx_shmRing_t* self);
+static uint32_t shm_load(volatile uint32_t* ptr);
+static void shm_store(volatile uint32_t* ptr, uint32_t value);
+static void shm_increment(volatile uint32_t* ptr);
+static void futex_wait(volatile uint32_t* ptr, uint32_t expected, uint32_t timeout_ms);
+static void futex_wake(volatile uint32_t* ptr);
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE VARIABLES
+//////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////
+// PUBLIC FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+apx_size_t apx_shmRing_memory_size(uint32_t capacity)
+{
+   return (apx_size_t)(sizeof(apx_shmRingHeader_t) + capacity);
+}
+
+/**
+ * Initializes a new ring in memory. Memory must be at least apx_shmRing_memory_size(capacity) bytes.
+ */
+apx_error_t apx_shmRing_init(apx_shmRing_t* self, void* memory, uint32_t capacity)
+{
+   if ( (self != NULL) && (memory != NULL) )
+   {
+      if ( (capacity < APX_SHM_RING_MIN_CAPACITY) || (!is_power_of_two(capacity)) )
+      {
+         return APX_INVALID_ARGUMENT_ERROR;
+      }
+      memset(memory, 0, sizeof(apx_shmRingHeader_t));
+      self->header = (apx_shmRingHeader_t*)memory;
+      self->data = ((uint8_t*)memory) + sizeof(apx_shmRingHeader_t);
+      self->capacity = capacity;
+      self->tx_pos = 0u;
+      self->record_pos = 0u;
+      self->cached_read_pos = 0u;
+      self->is_record_open = false;
+      self->rx_pos = 0u;
+      self->rx_record_size = 0u;
+      self->is_corrupt = false;
+      self->header->capacity = capacity;
+      shm_store(&self->header->magic, APX_SHM_RING_MAGIC);
+      return APX_NO_ERROR;
+   }
+   return APX_INVALID_ARGUMENT_ERROR;
+}
+
+/**
+ * Attaches to a ring previously initialized by apx_shmRing_init (possibly in another process).
+ */
+apx_error_t apx_shmRing_attach(apx_shmRing_t* self, void* memory, apx_size_t memory_size)
+{
+   if ( (self != NULL) && (memory != NULL) )
+   {
+      apx_shmRingHeader_t* header = (apx_shmRingHeader_t*)memory;
+      uint32_t capacity;
+      if ( (memory_size < sizeof(apx_shmRingHeader_t)) || (shm_load(&header->magic) != APX_SHM_RING_MAGIC) )
+      {
+         return APX_INVALID_HEADER_ERROR;
+      }
+      capacity = header->capacity;
+      if ( (capacity < APX_SHM_RING_MIN_CAPACITY) || (!is_power_of_two(capacity)) ||
+         (apx_shmRing_memory_size(capacity) > memory_size) )
+      {
+         return APX_INVALID_HEADER_ERROR;
+      }
+      self->header = header;
+      self->data = ((uint8_t*)memory) + sizeof(apx_shmRingHeader_t);
+      self->capacity = capacity;
+      self->tx_pos = shm_load(&header->write_pos);
+      self->record_pos = self->tx_pos;
+      self->cached_read_pos = shm_load(&header->read_pos);
+      self->is_record_open = false;
+      self->rx_pos = self->cached_read_pos;
+      self->rx_record_size = 0u;
+      self->is_corrupt = false;
+      if (!is_valid_span(self, self->rx_pos, self->tx_pos))
+      {
+         return APX_INVALID_HEADER_ERROR;
+      }
+      return APX_NO_ERROR;
+   }
+   return APX_INVALID_ARGUMENT_ERROR;
+}
+
+/**
+ * Largest record that is guaranteed to fit once the consumer has caught up.
+ */
+uint32_t apx_shmRing_max_record_size(apx_shmRing_t const* self)
+{
+   if (self != NULL)
+   {
+      return (self->capacity / 2u) - APX_SHM_RING_RECORD_HEADER_SIZE;
+   }
+   return 0u;
+}
+
+/**
+ * Appends size bytes to the open record and returns where to write them.
+ * A new record is started when there is no open record or when the open record cannot grow without
+ * crossing the end of the data area.
+ * Returns NULL when the ring does not have enough free space. Nothing is visible to the consumer
+ * until apx_shmRing_commit is called.
+ */
+uint8_t* apx_shmRing_reserve(apx_shmRing_t* self, uint32_t size)
+{
+   if ( (self != NULL) && (size <= apx_shmRing_max_record_size(self)) )
+   {
+      uint32_t const mask = self->capacity - 1u;
+      if (self->is_record_open)
+      {
+         uint32_t const record_size = self->tx_pos - (self->record_pos + APX_SHM_RING_RECORD_HEADER_SIZE);
+         uint32_t const record_offset = self->record_pos & mask;
+         uint32_t const growth = (self->record_pos + APX_SHM_RING_RECORD_HEADER_SIZE + ALIGN_SIZE(record_size + size)) - self->tx_pos;
+         bool const is_contiguous = (record_offset + APX_SHM_RING_RECORD_HEADER_SIZE + record_size + size) <= self->capacity;
+         if ( is_contiguous && ( (record_size + size) <= apx_shmRing_max_record_size(self) ) &&
+            (bytes_free(self, growth) >= growth) )
+         {
+            uint8_t* ptr = self->data + (self->tx_pos & mask);
+            self->tx_pos += size;
+            return ptr;
+         }
+         close_record(self);
+      }
+      if (open_record(self, size))
+      {
+         uint8_t* ptr = self->data + (self->tx_pos & mask);
+         self->tx_pos += size;
+         return ptr;
+      }
+   }
+   return NULL;
+}
+
+/**
+ * Publishes all records written since last commit and wakes the consumer if it is waiting.
+ */
+void apx_shmRing_commit(apx_shmRing_t* self)
+{
+   if (self != NULL)
+   {
+      if (self->is_record_open)
+      {
+         close_record(self);
+      }
+      if (self->tx_pos != self->header->write_pos)
+      {
+         shm_store(&self->header->write_pos, self->tx_pos);
+         shm_increment(&self->header->data_seq);
+         if (shm_load(&self->header->consumer_waiting) != 0u)
+         {
+            futex_wake(&self->header->data_seq);
+         }
+      }
+   }
+}
+
+/**
+ * Waits until a record of size bytes can be reserved. Commit any open record before calling this.
+ * Returns false on timeout or when the ring has been closed.
+ */
+bool apx_shmRing_wait_writable(apx_shmRing_t* self, uint32_t size, uint32_t timeout_ms)
+{
+   if (self != NULL)
+   {
+      uint32_t seq;
+      uint32_t const needed = required_space(self, size);
+      if (shm_load(&self->header->is_closed) != 0u)
+      {
+         return false;
+      }
+      if (bytes_free(self, needed) >= needed)
+      {
+         return true;
+      }
+      shm_store(&self->header->producer_waiting, 1u);
+      seq = shm_load(&self->header->space_seq);
+      if ( (bytes_free(self, needed) < needed) && (shm_load(&self->header->is_closed) == 0u) )
+      {
+         futex_wait(&self->header->space_seq, seq, timeout_ms);
+      }
+      shm_store(&self->header->producer_waiting, 0u);
+      return (shm_load(&self->header->is_closed) == 0u) && (bytes_free(self, needed) >= needed);
+   }
+   return false;
+}
+
+/**
+ * Returns pointer to next unread record and its size, or NULL when the ring is empty.
+ * The record stays valid until apx_shmRing_release is called.
+ * Everything read from shared memory is validated since the producer may be another, untrusted, process.
+ * Invalid data marks the ring as corrupt (see apx_shmRing_is_corrupt) and NULL is returned from then on.
+ */
+uint8_t const* apx_shmRing_peek(apx_shmRing_t* self, uint32_t* size)
+{
+   if ( (self != NULL) && (size != NULL) && (!self->is_corrupt) )
+   {
+      uint32_t const mask = self->capacity - 1u;
+      uint32_t const write_pos = shm_load(&self->header->write_pos);
+      if (!is_valid_span(self, self->rx_pos, write_pos))
+      {
+         set_corrupt(self);
+         return NULL;
+      }
+      while (self->rx_pos != write_pos)
+      {
+         uint32_t const available = write_pos - self->rx_pos;
+         uint32_t const offset = self->rx_pos & mask;
+         uint32_t const length = shm_load((volatile uint32_t*)(self->data + offset));
+         if (length == WRAP_MARKER)
+         {
+            if ( (self->capacity - offset) > available )
+            {
+               set_corrupt(self);
+               return NULL;
+            }
+            self->rx_pos += (self->capacity - offset);
+            shm_store(&self->header->read_pos, self->rx_pos);
+         }
+         else
+         {
+            uint32_t record_size;
+            if (length > apx_shmRing_max_record_size(self))
+            {
+               set_corrupt(self);
+               return NULL;
+            }
+            record_size = APX_SHM_RING_RECORD_HEADER_SIZE + ALIGN_SIZE(length);
+            if ( (record_size > available) || ((offset + record_size) > self->capacity) )
+            {
+               set_corrupt(self);
+               return NULL;
+            }
+            self->rx_record_size = record_size;
+            *size = length;
+            return self->data + offset + APX_SHM_RING_RECORD_HEADER_SIZE;
+         }
+      }
+   }
+   return NULL;
+}
+
+/**
+ * Releases record returned by last call to apx_shmRing_peek and wakes the producer if it is waiting for space.
+ */
+void apx_shmRing_release(apx_shmRing_t* self)
+{
+   if ( (self != NULL) && (self->rx_record_size > 0u) )
+   {
+      self->rx_pos += self->rx_record_size;
+      shm_store(&self->header->read_pos, self->rx_pos);
+      self->rx_record_size = 0u;
+      shm_increment(&self->header->space_seq);
+      if (shm_load(&self->header->producer_waiting) != 0u)
+      {
+         futex_wake(&self->header->space_seq);
+      }
+   }
+}
+
+/**
+ * Waits until there is at least one record to read.
+ * Returns false on timeout or when the ring has been closed and all records have been read.
+ */
+bool apx_shmRing_wait_readable(apx_shmRing_t* self, uint32_t timeout_ms)
+{
+   if (self != NULL)
+   {
+      uint32_t seq;
+      if ( self->is_corrupt || (shm_load(&self->header->write_pos) != self->rx_pos) )
+      {
+         return true;
+      }
+      if (shm_load(&self->header->is_closed) != 0u)
+      {
+         return false;
+      }
+      shm_store(&self->header->consumer_waiting, 1u);
+      seq = shm_load(&self->header->data_seq);
+      if ( (shm_load(&self->header->write_pos) == self->rx_pos) && (shm_load(&self->header->is_closed) == 0u) )
+      {
+         futex_wait(&self->header->data_seq, seq, timeout_ms);
+      }
+      shm_store(&self->header->consumer_waiting, 0u);
+      return shm_load(&self->header->write_pos) != self->rx_pos;
+   }
+   return false;
+}
+
+/**
+ * Marks ring as closed and wakes both sides. Can be called from either process.
+ */
+void apx_shmRing_close(apx_shmRing_t* self)
+{
+   if ( (self != NULL) && (self->header != NULL) )
+   {
+      shm_store(&self->header->is_closed, 1u);
+      shm_increment(&self->header->data_seq);
+      shm_increment(&self->header->space_seq);
+      futex_wake(&self->header->data_seq);
+      futex_wake(&self->header->space_seq);
+   }
+}
+
+bool apx_shmRing_is_closed(apx_shmRing_t const* self)
+{
+   if ( (self != NULL) && (self->header != NULL) )
+   {
+      return shm_load(&self->header->is_closed) != 0u;
+   }
+   return true;
+}
+
+/**
+ * Returns true when the other process has written positions or record lengths that cannot be valid.
+ * The ring must not be used after that.
+ */
+bool apx_shmRing_is_corrupt(apx_shmRing_t const* self)
+{
+   if (self != NULL)
+   {
+      return self->is_corrupt;
+   }
+   return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+static bool is_power_of_two(uint32_t value)
+{
+   return (value != 0u) && ((value & (value - 1u)) == 0u);
+}
+
+/**
+ * Positions are free-running counters that always advance in aligned steps and never more than capacity apart.
+ */
+static bool is_valid_span(apx_shmRing_t const* self, uint32_t begin, uint32_t end)
+{
+   uint32_t const span = end - begin;
+   return (span <= self->capacity) && ((begin & (APX_SHM_RING_ALIGNMENT - 1u)) == 0u) && ((span & (APX_SHM_RING_ALIGNMENT - 1u)) == 0u);
+}
+
+static void set_corrupt(apx_shmRing_t* self)
+{
+   self->is_corrupt = true;
+   self->rx_record_size = 0u;
+}
+
+/**
+ * Free space as seen from the producer. The consumer position is only reloaded from shared memory
+ * when the cached value says there is less than needed bytes available.
+ */
+static uint32_t bytes_free(apx_shmRing_t* self, uint32_t needed)
+{
+   uint32_t free_space = self->capacity - (self->tx_pos - self->cached_read_pos);
+   if (free_space < needed)
+   {
+      uint32_t const read_pos = shm_load(&self->header->read_pos);
+      //A consumer position that is ahead of the producer or unaligned cannot be trusted, report the ring as full
+      if (!is_valid_span(self, read_pos, self->tx_pos))
+      {
+         return 0u;
+      }
+      self->cached_read_pos = read_pos;
+      free_space = self->capacity - (self->tx_pos - self->cached_read_pos);
+   }
+   return free_space;
+}
+
+/**
+ * Number of free bytes needed to start a new record of size bytes at tx_pos, including any wrap-around.
+ */
+static uint32_t required_space(apx_shmRing_t const* self, uint32_t size)
+{
+   uint32_t const contiguous = self->capacity - (self->tx_pos & (self->capacity - 1u));
+   uint32_t needed = APX_SHM_RING_RECORD_HEADER_SIZE + ALIGN_SIZE(size);
+   if (contiguous < needed)
+   {
+      needed += contiguous;
+   }
+   return needed;
+}
+
+static bool open_record(apx_shmRing_t* self, uint32_t size)
+{
+   uint32_t const mask = self->capacity - 1u;
+   uint32_t const contiguous = self->capacity - (self->tx_pos & mask);
+   uint32_t const needed = required_space(self, size);
+   assert(!self->is_record_open);
+   if (bytes_free(self, needed) < needed)
+   {
+      return false;
+   }
+   if (contiguous < (APX_SHM_RING_RECORD_HEADER_SIZE + ALIGN_SIZE(size)))
+   {
+      //Positions are always aligned so there is room for the marker
+      *((uint32_t*)(self->data + (self->tx_pos & mask))) = WRAP_MARKER;
+      self->tx_pos += contiguous;
+   }
+   self->record_pos = self->tx_pos;
+   self->tx_pos += APX_SHM_RING_RECORD_HEADER_SIZE;
+   self->is_record_open = true;
+   return true;
+}
+
+static void close_record(apx_shmRing_t* self)
+{
+   uint32_t const record_size = self->tx_pos - (self->record_pos + APX_SHM_RING_RECORD_HEADER_SIZE);
+   assert(self->is_record_open);
+   *((uint32_t*)(self->data + (self->record_pos & (self->capacity - 1u)))) = record_size;
+   self->tx_pos = self->record_pos + APX_SHM_RING_RECORD_HEADER_SIZE + ALIGN_SIZE(record_size);
+   self->is_record_open = false;
+}
+
+#ifdef _MSC_VER
+static uint32_t shm_load(volatile uint32_t* ptr)
+{
+   uint32_t value = *ptr;
+   MemoryBarrier();
+   return value;
+}
+
+static void shm_store(volatile uint32_t* ptr, uint32_t value)
+{
+   InterlockedExchange((volatile LONG*)ptr, (LONG)value);
+}
+
+static void shm_increment(volatile uint32_t* ptr)
+{
+   InterlockedIncrement((volatile LONG*)ptr);
+}
+#else
+static uint32_t shm_load(volatile uint32_t* ptr)
+{
+   return __atomic_load_n(ptr, __ATOMIC_SEQ_CST);
+}
+
+static void shm_store(volatile uint32_t* ptr, uint32_t value)
+{
+   __atomic_store_n(ptr, value, __ATOMIC_SEQ_CST);
+}
+
+static void shm_increment(volatile uint32_t* ptr)
+{
+   (void)__atomic_add_fetch(ptr, 1u, __ATOMIC_SEQ_CST);
+}
+#endif
+
+#ifdef __linux__
+//Futex operations without FUTEX_PRIVATE_FLAG since the words live in memory shared between processes
+static void futex_wait(volatile uint32_t* ptr, uint32_t expected, uint32_t timeout_ms)
+{
+   struct timespec timeout;
+   timeout.tv_sec = (time_t)(timeout_ms / 1000u);
+   timeout.tv_nsec = (long)(timeout_ms % 1000u) * 1000000L;
+   (void)syscall(SYS_futex, ptr, FUTEX_WAIT, expected, &timeout, NULL, 0);
+}
+
+static void futex_wake(volatile uint32_t* ptr)
+{
+   (void)syscall(SYS_futex, ptr, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+}
+#else
+//No cross-process wait primitive available, fall back to polling
+static void futex_wait(volatile uint32_t* ptr, uint32_t expected, uint32_t timeout_ms)
+{
+   if ( (timeout_ms > 0u) && (shm_load(ptr) == expected) )
+   {
+      SLEEP(1);
+   }
+}
+
+static void futex_wake(volatile uint32_t* ptr)
+{
+   (void)ptr;
+}
+#endif
@@ -0,0 +1,613 @@
+/*****************************************************************************
+* \file      shm_transport.c
+* \author    Conny Gustafsson
+* \date      2026-10-18
+* \brief     Shared-memory transport for connections between processes on the same host
+*
+* Copyright (c) 2026 Conny Gustafsson
+* Permission is hereby granted, free of charge, to any person obtaining a copy of
+* this software and associated documentation files (the "Software"), to deal in
+* the Software without restriction, including without limitation the rights to
+* use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+* the Software, and to permit persons to whom the Software is furnished to do so,
+* subject to the following conditions:
+
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+* FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+* COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+* IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+* CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+******************************************************************************/
+//////////////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////////////
+#include <malloc.h>
+#include <string.h>
+#include <assert.h>
+#include <stdio.h>
+#if defined(__linux__) && !defined(UNIT_TEST)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+#include "apx/shm_transport.h"
+#include "apx/numheader.h"
+#include "apx/remotefile.h"
+#ifdef MEM_LEAK_CHECK
+#include "CMemLeak.h"
+#endif
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE CONSTANTS AND DATA TYPES
+//////////////////////////////////////////////////////////////////////////////
+#define READER_WAIT_TIMEOUT_MS 100u
+#define WRITER_WAIT_TIMEOUT_MS 100u
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////////////
+static uint8_t* reserve_blocking(apx_shmTransport_t* self, uint32_t size);
+static apx_error_t process_next_record(apx_shmTransport_t* self, bool* has_record);
+#if APX_SHM_TRANSPORT_SUPPORTED
+static void unmap_region(apx_shmTransport_t* self);
+static THREAD_PROTO(reader_main, arg);
+#endif
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE VARIABLES
+//////////////////////////////////////////////////////////////////////////////
+#if APX_SHM_TRANSPORT_SUPPORTED
+static uint32_t m_region_counter = 0u;
+#endif
+
+//////////////////////////////////////////////////////////////////////////////
+// PUBLIC FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+void apx_shmTransport_create(apx_shmTransport_t* self)
+{
+   if (self != NULL)
+   {
+      memset(self, 0, sizeof(apx_shmTransport_t));
+      self->fd = -1;
+   }
+}
+
+void apx_shmTransport_destroy(apx_shmTransport_t* self)
+{
+   if (self != NULL)
+   {
+      apx_shmTransport_stop(self);
+#if APX_SHM_TRANSPORT_SUPPORTED
+      apx_shmTransport_unlink_region(self);
+      unmap_region(self);
+#endif
+   }
+}
+
+apx_shmTransport_t* apx_shmTransport_new(void)
+{
+   apx_shmTransport_t* self = (apx_shmTransport_t*)malloc(sizeof(apx_shmTransport_t));
+   if (self != NULL)
+   {
+      apx_shmTransport_create(self);
+   }
+   return self;
+}
+
+void apx_shmTransport_delete(apx_shmTransport_t* self)
+{
+   if (self != NULL)
+   {
+      apx_shmTransport_destroy(self);
+      free(self);
+   }
+}
+
+apx_size_t apx_shmTransport_memory_size(uint32_t ring_capacity)
+{
+   return 2u * apx_shmRing_memory_size(ring_capacity);
+}
+
+/**
+ * Region names are created by apx_shmTransport_create_region as APX_SHM_TRANSPORT_NAME_PREFIX followed by
+ * process id and region counter. Anything else is refused so a client cannot make the server map arbitrary objects.
+ */
+bool apx_shmTransport_is_valid_region_name(char const* name)
+{
+   if (name != NULL)
+   {
+      size_t const prefix_len = strlen(APX_SHM_TRANSPORT_NAME_PREFIX);
+      size_t const name_len = strlen(name);
+      size_t i;
+      if ( (name_len <= prefix_len) || (name_len >= APX_SHM_TRANSPORT_NAME_MAX_LEN) ||
+         (strncmp(name, APX_SHM_TRANSPORT_NAME_PREFIX, prefix_len) != 0) )
+      {
+         return false;
+      }
+      for (i = prefix_len; i < name_len; i++)
+      {
+         if ( ((name[i] < '0') || (name[i] > '9')) && (name[i] != '-') )
+         {
+            return false;
+         }
+      }
+      return true;
+   }
+   return false;
+}
+
+/**
+ * Returns true if memory_size is the size of a region holding two rings of a supported capacity.
+ */
+bool apx_shmTransport_is_valid_region_size(apx_size_t memory_size)
+{
+   uint32_t capacity;
+   for (capacity = APX_SHM_RING_MIN_CAPACITY; capacity <= APX_SHM_TRANSPORT_MAX_RING_SIZE; capacity *= 2u)
+   {
+      if (apx_shmTransport_memory_size(capacity) == memory_size)
+      {
+         return true;
+      }
+   }
+   return false;
+}
+
+/**
+ * Sets up both rings in memory. The side that creates the region initializes it, the other side attaches.
+ * In client mode the first ring is used for transmit, in server mode the second.
+ */
+apx_error_t apx_shmTransport_attach_memory(apx_shmTransport_t* self, void* memory, apx_size_t memory_size, apx_mode_t mode, bool initialize)
+{
+   if ( (self != NULL) && (memory != NULL) && ( (mode == APX_CLIENT_MODE) || (mode == APX_SERVER_MODE) ) )
+   {
+      apx_error_t retval;
+      apx_size_t const ring_memory_size = memory_size / 2u;
+      uint8_t* first = (uint8_t*)memory;
+      uint8_t* second = first + ring_memory_size;
+      apx_shmRing_t* upstream = (mode == APX_CLIENT_MODE) ? &self->tx_ring : &self->rx_ring;
+      apx_shmRing_t* downstream = (mode == APX_CLIENT_MODE) ? &self->rx_ring : &self->tx_ring;
+      if (initialize)
+      {
+         uint32_t const capacity = (uint32_t)(ring_memory_size - sizeof(apx_shmRingHeader_t));
+         retval = apx_shmRing_init(upstream, first, capacity);
+         if (retval == APX_NO_ERROR)
+         {
+            retval = apx_shmRing_init(downstream, second, capacity);
+         }
+      }
+      else
+      {
+         retval = apx_shmRing_attach(upstream, first, ring_memory_size);
+         if (retval == APX_NO_ERROR)
+         {
+            retval = apx_shmRing_attach(downstream, second, ring_memory_size);
+         }
+      }
+      if (retval == APX_NO_ERROR)
+      {
+         self->memory = first;
+         self->memory_size = memory_size;
+      }
+      return retval;
+   }
+   return APX_INVALID_ARGUMENT_ERROR;
+}
+
+#if APX_SHM_TRANSPORT_SUPPORTED
+/**
+ * Creates a new named shared memory object and initializes it for client use.
+ * The name is sent to the server in the greeting header.
+ */
+apx_error_t apx_shmTransport_create_region(apx_shmTransport_t* self, uint32_t ring_capacity)
+{
+   if ( (self != NULL) && (self->memory == NULL) )
+   {
+      apx_error_t retval;
+      apx_size_t const memory_size = apx_shmTransport_memory_size(ring_capacity);
+      uint32_t const region_id = __atomic_add_fetch(&m_region_counter, 1u, __ATOMIC_SEQ_CST);
+      void* memory;
+      snprintf(self->name, sizeof(self->name), "%s%d-%u", APX_SHM_TRANSPORT_NAME_PREFIX, (int)getpid(), (unsigned int)region_id);
+      self->fd = shm_open(self->name, O_CREAT | O_EXCL | O_RDWR, S_IRUSR | S_IWUSR);
+      if (self->fd < 0)
+      {
+         self->name[0] = '\0';
+         return APX_SHARED_MEMORY_ERROR;
+      }
+      self->is_name_linked = true;
+      if (ftruncate(self->fd, (off_t)memory_size) != 0)
+      {
+         apx_shmTransport_unlink_region(self);
+         unmap_region(self);
+         return APX_SHARED_MEMORY_ERROR;
+      }
+      memory = mmap(NULL, memory_size, PROT_READ | PROT_WRITE, MAP_SHARED, self->fd, 0);
+      if (memory == MAP_FAILED)
+      {
+         apx_shmTransport_unlink_region(self);
+         unmap_region(self);
+         return APX_SHARED_MEMORY_ERROR;
+      }
+      self->is_mapped = true;
+      retval = apx_shmTransport_attach_memory(self, memory, memory_size, APX_CLIENT_MODE, true);
+      if (retval != APX_NO_ERROR)
+      {
+         self->memory = (uint8_t*)memory;
+         self->memory_size = memory_size;
+         apx_shmTransport_unlink_region(self);
+         unmap_region(self);
+      }
+      return retval;
+   }
+   return APX_INVALID_ARGUMENT_ERROR;
+}
+
+/**
+ * Opens shared memory object created by client and attaches to it in server mode.
+ * The name comes from the client, so before mapping it is verified that the object follows the naming scheme
+ * of apx_shmTransport_create_region, is owned by the same user as this process and is not accessible to anyone else,
+ * and has the size of a valid region.
+ */
+apx_error_t apx_shmTransport_open_region(apx_shmTransport_t* self, char const* name)
+{
+   if ( (self != NULL) && (name != NULL) && (self->memory == NULL) )
+   {
+      apx_error_t retval;
+      struct stat info;
+      void* memory;
+      if (!apx_shmTransport_is_valid_region_name(name))
+      {
+         return APX_INVALID_NAME_ERROR;
+      }
+      self->fd = shm_open(name, O_RDWR, 0);
+      if (self->fd < 0)
+      {
+         return APX_SHARED_MEMORY_ERROR;
+      }
+      strcpy(self->name, name);
+      if ( (fstat(self->fd, &info) != 0) || (!S_ISREG(info.st_mode)) || (info.st_uid != geteuid()) ||
+         ((info.st_mode & (S_IRWXG | S_IRWXO)) != 0) || (info.st_size <= 0) ||
+         (!apx_shmTransport_is_valid_region_size((apx_size_t)info.st_size)) )
+      {
+         unmap_region(self);
+         return APX_SHARED_MEMORY_ERROR;
+      }
+      memory = mmap(NULL, (size_t)info.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, self->fd, 0);
+      if (memory == MAP_FAILED)
+      {
+         unmap_region(self);
+         return APX_SHARED_MEMORY_ERROR;
+      }
+      self->is_mapped = true;
+      retval = apx_shmTransport_attach_memory(self, memory, (apx_size_t)info.st_size, APX_SERVER_MODE, false);
+      if (retval != APX_NO_ERROR)
+      {
+         self->memory = (uint8_t*)memory;
+         self->memory_size = (apx_size_t)info.st_size;
+         unmap_region(self);
+      }
+      return retval;
+   }
+   return APX_INVALID_ARGUMENT_ERROR;
+}
+
+/**
+ * Removes the name of the shared memory object. Mappings stay valid until both sides have unmapped.
+ */
+void apx_shmTransport_unlink_region(apx_shmTransport_t* self)
+{
+   if ( (self != NULL) && (self->is_name_linked) )
+   {
+      (void)shm_unlink(self->name);
+      self->is_name_linked = false;
+   }
+}
+#endif
+
+char const* apx_shmTransport_get_name(apx_shmTransport_t const* self)
+{
+   if (self != NULL)
+   {
+      return self->name;
+   }
+   return NULL;
+}
+
+void apx_shmTransport_set_handler(apx_shmTransport_t* self, apx_shmTransportDataFunc* data_handler, void* arg)
+{
+   if (self != NULL)
+   {
+      self->data_handler = data_handler;
+      self->handler_arg = arg;
+   }
+}
+
+/**
+ * Starts the reader thread which delivers received records to the data handler.
+ */
+apx_error_t apx_shmTransport_start(apx_shmTransport_t* self)
+{
+   if ( (self != NULL) && (self->memory != NULL) )
+   {
+#if APX_SHM_TRANSPORT_SUPPORTED
+      if (!self->reader_thread_valid)
+      {
+         int rc = THREAD_CREATE(self->reader_thread, reader_main, self);
+         if (rc != 0)
+         {
+            return APX_THREAD_CREATE_ERROR;
+         }
+         self->reader_thread_valid = true;
+      }
+      return APX_NO_ERROR;
+#elif defined(UNIT_TEST)
+      return APX_NO_ERROR; //Use apx_shmTransport_run
+#else
+      return APX_NOT_IMPLEMENTED_ERROR;
+#endif
+   }
+   return APX_INVALID_ARGUMENT_ERROR;
+}
+
+/**
+ * Closes both rings, which wakes up any waiting reader or writer on either side, and joins the reader thread.
+ */
+void apx_shmTransport_stop(apx_shmTransport_t* self)
+{
+   if ( (self != NULL) && (self->memory != NULL) )
+   {
+      apx_shmRing_close(&self->tx_ring);
+      apx_shmRing_close(&self->rx_ring);
+#if APX_SHM_TRANSPORT_SUPPORTED
+      if (self->reader_thread_valid)
+      {
+         if (pthread_equal(pthread_self(), self->reader_thread) == 0)
+         {
+            void* status;
+            (void)pthread_join(self->reader_thread, &status);
+         }
+         else
+         {
+            (void)pthread_detach(self->reader_thread);
+         }
+         self->reader_thread_valid = false;
+      }
+#endif
+   }
+}
+
+int32_t apx_shmTransport_max_message_size(apx_shmTransport_t const* self)
+{
+   if ( (self != NULL) && (self->memory != NULL) )
+   {
+      return (int32_t)apx_shmRing_max_record_size(&self->tx_ring);
+   }
+   return 0;
+}
+
+/**
+ * Encodes message header, address and data directly into the transmit ring.
+ */
+apx_error_t apx_shmTransport_write_data_message(apx_shmTransport_t* self, uint32_t write_address, bool more_bit, uint8_t const* msg_data, int32_t msg_size)
+{
+   if ( (self != NULL) && (self->memory != NULL) && (msg_size >= 0) && ( (msg_data != NULL) || (msg_size == 0) ) )
+   {
+      uint8_t* buf;
+      apx_size_t const address_size = rmf_needed_encoding_size(write_address);
+      apx_size_t const payload_size = address_size + (apx_size_t)msg_size;
+      apx_size_t const header_size = (payload_size <= NUMHEADER32_MAX_NUM_SHORT) ? NUMHEADER32_SHORT_SIZE : NUMHEADER32_LONG_SIZE;
+      apx_size_t const total_size = header_size + payload_size;
+      if (total_size > (apx_size_t)apx_shmTransport_max_message_size(self))
+      {
+         return APX_MSG_TOO_LARGE_ERROR;
+      }
+      buf = reserve_blocking(self, total_size);
+      if (buf == NULL)
+      {
+         return apx_shmRing_is_closed(&self->tx_ring) ? APX_NOT_CONNECTED_ERROR : APX_BUFFER_FULL_ERROR;
+      }
+      (void)numheader_encode32(buf, (int32_t)header_size, payload_size);
+      (void)rmf_address_encode(buf + header_size, address_size, write_address, more_bit);
+      if (msg_size > 0)
+      {
+         memcpy(buf + header_size + address_size, msg_data, (size_t)msg_size);
+      }
+      self->total_bytes_written += total_size;
+      return APX_NO_ERROR;
+   }
+   return APX_INVALID_ARGUMENT_ERROR;
+}
+
+apx_error_t apx_shmTransport_write_direct_message(apx_shmTransport_t* self, uint8_t const* msg_data, int32_t msg_size)
+{
+   if ( (self != NULL) && (self->memory != NULL) && (msg_data != NULL) && (msg_size >= 0) )
+   {
+      uint8_t* buf;
+      apx_size_t const header_size = (((uint32_t)msg_size) <= NUMHEADER32_MAX_NUM_SHORT) ? NUMHEADER32_SHORT_SIZE : NUMHEADER32_LONG_SIZE;
+      apx_size_t const total_size = header_size + (apx_size_t)msg_size;
+      if (total_size > (apx_size_t)apx_shmTransport_max_message_size(self))
+      {
+         return APX_MSG_TOO_LARGE_ERROR;
+      }
+      buf = reserve_blocking(self, total_size);
+      if (buf == NULL)
+      {
+         return apx_shmRing_is_closed(&self->tx_ring) ? APX_NOT_CONNECTED_ERROR : APX_BUFFER_FULL_ERROR;
+      }
+      (void)numheader_encode32(buf, (int32_t)header_size, (uint32_t)msg_size);
+      memcpy(buf + header_size, msg_data, (size_t)msg_size);
+      self->total_bytes_written += total_size;
+      return APX_NO_ERROR;
+   }
+   return APX_INVALID_ARGUMENT_ERROR;
+}
+
+/**
+ * Makes all messages written since last flush visible to the receiver.
+ */
+void apx_shmTransport_flush(apx_shmTransport_t* self)
+{
+   if ( (self != NULL) && (self->memory != NULL) )
+   {
+      apx_shmRing_commit(&self->tx_ring);
+   }
+}
+
+uint64_t apx_shmTransport_get_total_bytes_written(apx_shmTransport_t const* self)
+{
+   if (self != NULL)
+   {
+      return self->total_bytes_written;
+   }
+   return 0u;
+}
+
+uint64_t apx_shmTransport_get_total_bytes_received(apx_shmTransport_t const* self)
+{
+   if (self != NULL)
+   {
+      return self->total_bytes_received;
+   }
+   return 0u;
+}
+
+#ifdef UNIT_TEST
+/**
+ * Delivers all pending records to the data handler.
+ */
+apx_error_t apx_shmTransport_run(apx_shmTransport_t* self)
+{
+   if ( (self != NULL) && (self->memory != NULL) )
+   {
+      bool has_record = true;
+      while (has_record)
+      {
+         apx_error_t retval = process_next_record(self, &has_record);
+         if (retval != APX_NO_ERROR)
+         {
+            return retval;
+         }
+      }
+      return APX_NO_ERROR;
+   }
+   return APX_INVALID_ARGUMENT_ERROR;
+}
+#endif
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Reserves space in transmit ring. When the ring is full, what has been written so far is published and
+ * the call waits until the receiver has made room. Returns NULL if the ring is closed.
+ * In unit test builds there is no reader thread so NULL is returned as soon as the ring is full.
+ */
+static uint8_t* reserve_blocking(apx_shmTransport_t* self, uint32_t size)
+{
+   for (;;)
+   {
+      uint8_t* buf;
+      if (apx_shmRing_is_closed(&self->tx_ring))
+      {
+         return NULL;
+      }
+      buf = apx_shmRing_reserve(&self->tx_ring, size);
+      if (buf != NULL)
+      {
+         return buf;
+      }
+      apx_shmRing_commit(&self->tx_ring);
+#ifdef UNIT_TEST
+      return NULL;
+#else
+      (void)apx_shmRing_wait_writable(&self->tx_ring, size, WRITER_WAIT_TIMEOUT_MS);
+#endif
+   }
+}
+
+/**
+ * Passes next record to the data handler. Records always contain complete messages so the handler
+ * is expected to parse all of it.
+ */
+static apx_error_t process_next_record(apx_shmTransport_t* self, bool* has_record)
+{
+   uint32_t size = 0u;
+   uint8_t const* data = apx_shmRing_peek(&self->rx_ring, &size);
+   *has_record = (data != NULL);
+   if (data != NULL)
+   {
+      apx_error_t retval = APX_NO_ERROR;
+      if ( (size > 0u) && (self->data_handler != NULL) )
+      {
+         uint32_t parse_size = 0u;
+         int8_t const result = self->data_handler(self->handler_arg, data, size, &parse_size);
+         if ( (result != 0) || (parse_size != size) )
+         {
+            retval = APX_PARSE_ERROR;
+         }
+      }
+      self->total_bytes_received += size;
+      apx_shmRing_release(&self->rx_ring);
+      return retval;
+   }
+   if (apx_shmRing_is_corrupt(&self->rx_ring))
+   {
+      return APX_INVALID_MSG_ERROR;
+   }
+   return APX_NO_ERROR;
+}
+
+#if APX_SHM_TRANSPORT_SUPPORTED
+static void unmap_region(apx_shmTransport_t* self)
+{
+   if (self->is_mapped)
+   {
+      (void)munmap(self->memory, self->memory_size);
+      self->is_mapped = false;
+   }
+   self->memory = NULL;
+   self->memory_size = 0u;
+   if (self->fd >= 0)
+   {
+      (void)close(self->fd);
+      self->fd = -1;
+   }
+}
+
+static THREAD_PROTO(reader_main, arg)
+{
+   apx_shmTransport_t* self = (apx_shmTransport_t*)arg;
+   bool is_running = true;
+   while (is_running)
+   {
+      bool has_record = false;
+      if (!apx_shmRing_wait_readable(&self->rx_ring, READER_WAIT_TIMEOUT_MS))
+      {
+         if (apx_shmRing_is_closed(&self->rx_ring))
+         {
+            break;
+         }
+         continue;
+      }
+      do
+      {
+         if (process_next_record(self, &has_record) != APX_NO_ERROR)
+         {
+            //Protocol error. Closing the rings makes both sides stop using the transport
+            apx_shmRing_close(&self->rx_ring);
+            apx_shmRing_close(&self->tx_ring);
+            is_running = false;
+            break;
+         }
+      } while (has_record);
+   }
+   THREAD_RETURN(0);
+}
+#endif
@@ -45,6 +45,7 @@
 //#include "apx/logging.h"
 #include "apx/file_manager.h"
 #include "apx/numheader.h"
+#include "apx/remotefile.h"
 #include "bstr.h"
 #ifdef MEM_LEAK_CHECK
 #include "CMemLeak.h"
@@ -84,6 +85,13 @@ static void create_connection_interface_vtable(apx_clientSocketConnection_t* sel
 static void on_socket_connected(void *arg, const char *addr, uint16_t port);
 static void on_socket_disconnected(void* arg);
 static int8_t on_socket_data(void* arg, const uint8_t* data, uint32_t data_size, uint32_t* parse_size);
+static int8_t on_shm_data(void* arg, const uint8_t* data, uint32_t data_size, uint32_t* parse_size);
+#if APX_SHM_TRANSPORT_SUPPORTED
+static void offer_shm_transport(apx_clientSocketConnection_t* self);
+#endif
+static void discard_shm_transport(apx_clientSocketConnection_t* self);
+static int32_t apx_clientSocketConnection_greeting_header_write(apx_clientSocketConnection_t* self, char* buf, int32_t buf_size);
+static int32_t apx_clientSocketConnection_vgreeting_header_write(void* arg, char* buf, int32_t buf_size);
 
 //APX BaseConnection API
 static void apx_clientSocketConnection_close(apx_clientSocketConnection_t *self);
@@ -116,10 +124,14 @@ apx_error_t apx_clientSocketConnection_create(apx_clientSocketConnection_t *self
       MUTEX_INIT(self->lock);
       self->default_buffer_size = SEND_BUFFER_GROW_SIZE;
       self->pending_bytes = 0u;
+      self->shm_transport = NULL;
+      self->is_shm_enabled = (APX_SHM_TRANSPORT_SUPPORTED != 0);
+      self->is_shm_active = false;
       apx_connectionBaseVTable_create(&base_connection_vtable,
             apx_clientSocketConnection_vdestroy,
             apx_clientSocketConnection_vstart,
             apx_clientSocketConnection_vclose);
+      base_connection_vtable.greeting_header_write = apx_clientSocketConnection_vgreeting_header_write;
       create_connection_interface_vtable(self, &connection_interface);
       apx_error_t result = apx_clientConnection_create(&self->base, &base_connection_vtable, &connection_interface);
       if (result != APX_NO_ERROR)
@@ -138,7 +150,12 @@ void apx_clientSocketConnection_destroy(apx_clientSocketConnection_t *self)
 {
    if (self != 0)
    {
+      if (self->shm_transport != NULL)
+      {
+         apx_shmTransport_stop(self->shm_transport);
+      }
       apx_clientConnection_destroy(&self->base);
+      discard_shm_transport(self);
       adt_bytearray_destroy(&self->send_buffer);
       SOCKET_DELETE(self->socket_object);
       MUTEX_DESTROY(self->lock);
@@ -165,8 +182,30 @@ apx_clientSocketConnection_t *apx_clientSocketConnection_new(SOCKET_TYPE *socket
    return self;
 }
 
+/**
+ * Controls whether shared memory is offered to the server in the greeting of the next UNIX socket connection.
+ * The server decides if it will be used.
+ */
+void apx_clientSocketConnection_enable_shm_transport(apx_clientSocketConnection_t *self, bool enable)
+{
+   if (self != NULL)
+   {
+      self->is_shm_enabled = enable;
+   }
+}
 
-
+bool apx_clientSocketConnection_is_shm_transport_active(apx_clientSocketConnection_t *self)
+{
+   if (self != NULL)
+   {
+      bool retval;
+      MUTEX_LOCK(self->lock);
+      retval = self->is_shm_active;
+      MUTEX_UNLOCK(self->lock);
+      return retval;
+   }
+   return false;
+}
 
 #ifndef UNIT_TEST
 apx_error_t apx_clientConnection_tcp_connect(apx_clientSocketConnection_t *self, const char *address, uint16_t port)
@@ -210,9 +249,16 @@ apx_error_t apx_clientConnection_unix_connect(apx_clientSocketConnection_t *self
       {
          int8_t result = 0;
          register_msocket_handler(self, socket_object);
+#if APX_SHM_TRANSPORT_SUPPORTED
+         if (self->is_shm_enabled)
+         {
+            offer_shm_transport(self);
+         }
+#endif
          result = msocket_unix_connect(socket_object, socket_path);
          if (result != 0)
          {
+            discard_shm_transport(self);
             msocket_delete(socket_object);
             self->socket_object = (SOCKET_TYPE*) 0;
             retval = APX_CONNECTION_ERROR;
@@ -355,19 +401,112 @@ static void on_socket_connected(void* arg, const char* addr, uint16_t port)
 static int8_t on_socket_data(void* arg, const uint8_t* data, uint32_t data_size, uint32_t* parse_size)
 {
    apx_clientSocketConnection_t *self = (apx_clientSocketConnection_t*) arg;
-   int8_t retval = (int8_t) apx_clientConnection_on_data_received(&self->base, data, data_size, parse_size);
+   int8_t retval;
+   if ( (self->shm_transport != NULL) && (!self->is_shm_active) )
+   {
+      //Server answered the greeting on the socket, meaning it did not accept the shared memory offer
+      discard_shm_transport(self);
+   }
+   retval = (int8_t) apx_clientConnection_on_data_received(&self->base, data, data_size, parse_size);
    return retval;
 }
 
+/**
+ * Called from the shared memory reader thread. The first data arriving here is the server's greeting acknowledge,
+ * from then on everything is transmitted through shared memory.
+ */
+static int8_t on_shm_data(void* arg, const uint8_t* data, uint32_t data_size, uint32_t* parse_size)
+{
+   apx_clientSocketConnection_t *self = (apx_clientSocketConnection_t*) arg;
+   if (!self->is_shm_active)
+   {
+      MUTEX_LOCK(self->lock);
+      self->is_shm_active = true;
+      MUTEX_UNLOCK(self->lock);
+#if APX_SHM_TRANSPORT_SUPPORTED
+      //Both sides have the region mapped, the name is no longer needed
+      apx_shmTransport_unlink_region(self->shm_transport);
+#endif
+#if APX_DEBUG_ENABLE
+      printf("[CLIENT-SOCKET] Using shared memory transport\n");
+#endif
+   }
+   return (int8_t) apx_clientConnection_on_data_received(&self->base, data, data_size, parse_size);
+}
+
 static void on_socket_disconnected(void* arg)
 {
    apx_clientSocketConnection_t *self = (apx_clientSocketConnection_t*) arg;
 #if APX_DEBUG_ENABLE
    printf("[CLIENT-SOCKET] Disconnected\n");
 #endif
+   if (self->shm_transport != NULL)
+   {
+      apx_shmTransport_stop(self->shm_transport);
+   }
    apx_clientConnection_disconnected_notification(&self->base);
 }
 
+#if APX_SHM_TRANSPORT_SUPPORTED
+/**
+ * Creates the shared memory region and starts listening on it before the greeting is sent.
+ * If anything fails the connection silently stays on the socket.
+ */
+static void offer_shm_transport(apx_clientSocketConnection_t* self)
+{
+   apx_shmTransport_t* transport;
+   discard_shm_transport(self);
+   transport = apx_shmTransport_new();
+   if (transport != NULL)
+   {
+      apx_error_t result = apx_shmTransport_create_region(transport, APX_SHM_TRANSPORT_DEFAULT_RING_SIZE);
+      if (result == APX_NO_ERROR)
+      {
+         apx_shmTransport_set_handler(transport, on_shm_data, (void*)self);
+         result = apx_shmTransport_start(transport);
+      }
+      if (result != APX_NO_ERROR)
+      {
+         apx_shmTransport_delete(transport);
+         return;
+      }
+      self->shm_transport = transport;
+   }
+}
+#endif
+
+static void discard_shm_transport(apx_clientSocketConnection_t* self)
+{
+   if (self->shm_transport != NULL)
+   {
+      apx_shmTransport_t* transport = self->shm_transport;
+      MUTEX_LOCK(self->lock);
+      self->shm_transport = NULL;
+      self->is_shm_active = false;
+      MUTEX_UNLOCK(self->lock);
+      apx_shmTransport_delete(transport);
+   }
+}
+
+static int32_t apx_clientSocketConnection_greeting_header_write(apx_clientSocketConnection_t* self, char* buf, int32_t buf_size)
+{
+   if ( (self->shm_transport != NULL) && (!self->is_shm_active) )
+   {
+      char const* name = apx_shmTransport_get_name(self->shm_transport);
+      int32_t const needed = (int32_t)(strlen(RMF_SHARED_MEMORY_HDR) + strlen(name) + 1u);
+      if ( (name[0] != '\0') && (needed < buf_size) )
+      {
+         return (int32_t)sprintf(buf, "%s%s\n", RMF_SHARED_MEMORY_HDR, name);
+      }
+   }
+   return 0;
+}
+
+static int32_t apx_clientSocketConnection_vgreeting_header_write(void* arg, char* buf, int32_t buf_size)
+{
+   return apx_clientSocketConnection_greeting_header_write((apx_clientSocketConnection_t*)arg, buf, buf_size);
+}
+
 static void apx_clientSocketConnection_close(apx_clientSocketConnection_t *self)
 {
    (void)self;
@@ -392,6 +531,10 @@ static int32_t apx_clientSocketConnection_transmit_max_bytes_avaiable(apx_client
 {
    if (self != NULL)
    {
+      if (self->is_shm_active)
+      {
+         return apx_shmTransport_max_message_size(self->shm_transport);
+      }
       return (int32_t)self->default_buffer_size;
    }
    return -1;
@@ -411,6 +554,10 @@ static void apx_clientSocketConnection_transmit_begin(apx_clientSocketConnection
    if (self != NULL)
    {
       MUTEX_LOCK(self->lock);
+      if (self->is_shm_active)
+      {
+         return;
+      }
       if (adt_bytearray_length(&self->send_buffer) < self->default_buffer_size)
       {
          adt_bytearray_resize(&self->send_buffer, self->default_buffer_size);
@@ -424,7 +571,11 @@ static void apx_clientSocketConnection_transmit_end(apx_clientSocketConnection_t
 {
    if (self != NULL)
    {
-      if (self->pending_bytes > 0u)
+      if (self->is_shm_active)
+      {
+         apx_shmTransport_flush(self->shm_transport);
+      }
+      else if (self->pending_bytes > 0u)
       {
          send_packet(self);
       }
@@ -438,6 +589,11 @@ static apx_error_t apx_clientSocketConnection_transmit_data_message(apx_clientSo
    {
       uint8_t header[NUMHEADER32_LONG_SIZE + RMF_HIGH_ADDR_SIZE];
       apx_size_t const address_size = rmf_needed_encoding_size(write_address);
+      if (self->is_shm_active)
+      {
+         *bytes_available = apx_shmTransport_max_message_size(self->shm_transport);
+         return apx_shmTransport_write_data_message(self->shm_transport, write_address, more_bit, msg_data, msg_size);
+      }
       apx_size_t const payload_size = address_size + msg_size;
       if (payload_size > self->default_buffer_size)
       {
@@ -469,6 +625,11 @@ static apx_error_t apx_clientSocketConnection_transmit_direct_message(apx_client
    if (self != NULL)
    {
       uint8_t  header[NUMHEADER32_LONG_SIZE];
+      if (self->is_shm_active)
+      {
+         *bytes_available = apx_shmTransport_max_message_size(self->shm_transport);
+         return apx_shmTransport_write_direct_message(self->shm_transport, msg_data, msg_size);
+      }
       if (msg_size > ((int32_t)self->default_buffer_size))
       {
          return APX_MSG_TOO_LARGE_ERROR;
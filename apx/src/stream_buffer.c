@@ -0,0 +1,195 @@
+/*****************************************************************************
+* \file      stream_buffer.c
+* \author    Conny Gustafsson
+* \date      2026-10-18
+* \brief     Retention buffer for records written to RMF stream files
+*
+* Copyright (c) 2026 Conny Gustafsson
+* Permission is hereby granted, free of charge, to any person obtaining a copy of
+* this software and associated documentation files (the "Software"), to deal in
+* the Software without restriction, including without limitation the rights to
+* use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+* the Software, and to permit persons to whom the Software is furnished to do so,
+* subject to the following conditions:
+
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+* FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+* COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+* IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+* CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+******************************************************************************/
+//////////////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////////////
+#include <assert.h>
+#include <string.h>
+#include <malloc.h>
+#include "apx/stream_buffer.h"
+#include "apx/remotefile.h"
+#include "pack.h"
+#ifdef MEM_LEAK_CHECK
+#include "CMemLeak.h"
+#endif
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE CONSTANTS AND DATA TYPES
+//////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE VARIABLES
+//////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////
+// PUBLIC FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+apx_error_t apx_streamBuffer_create(apx_streamBuffer_t* self, uint32_t retention)
+{
+   if ( (self != NULL) && (retention > 0u) )
+   {
+      memset(self, 0, sizeof(apx_streamBuffer_t));
+      self->records = (apx_streamRecord_t*)malloc(retention * sizeof(apx_streamRecord_t));
+      if (self->records == NULL)
+      {
+         return APX_MEM_ERROR;
+      }
+      memset(self->records, 0, retention * sizeof(apx_streamRecord_t));
+      self->retention = retention;
+      return APX_NO_ERROR;
+   }
+   return APX_INVALID_ARGUMENT_ERROR;
+}
+
+void apx_streamBuffer_destroy(apx_streamBuffer_t* self)
+{
+   if ( (self != NULL) && (self->records != NULL) )
+   {
+      uint32_t i;
+      for (i = 0u; i < self->num_records; i++)
+      {
+         free(self->records[(self->first_index + i) % self->retention].data);
+      }
+      free(self->records);
+      self->records = NULL;
+      self->num_records = 0u;
+   }
+}
+
+apx_streamBuffer_t* apx_streamBuffer_new(uint32_t retention)
+{
+   apx_streamBuffer_t* self = (apx_streamBuffer_t*)malloc(sizeof(apx_streamBuffer_t));
+   if (self != NULL)
+   {
+      apx_error_t result = apx_streamBuffer_create(self, retention);
+      if (result != APX_NO_ERROR)
+      {
+         free(self);
+         self = NULL;
+      }
+   }
+   return self;
+}
+
+void apx_streamBuffer_delete(apx_streamBuffer_t* self)
+{
+   if (self != NULL)
+   {
+      apx_streamBuffer_destroy(self);
+      free(self);
+   }
+}
+
+/**
+ * Takes ownership of record which must begin with RMF_STREAM_SEQUENCE_SIZE reserved bytes.
+ * The sequence number of the record is written into the reserved bytes and returned.
+ * The oldest record is evicted (and freed) when the buffer is full.
+ */
+uint32_t apx_streamBuffer_push(apx_streamBuffer_t* self, uint8_t* record, uint32_t size)
+{
+   uint32_t sequence;
+   uint32_t index;
+   assert( (self != NULL) && (record != NULL) && (size >= RMF_STREAM_SEQUENCE_SIZE) );
+   sequence = self->next_sequence++;
+   packLE(record, sequence, (uint8_t)RMF_STREAM_SEQUENCE_SIZE);
+   if (self->num_records == self->retention)
+   {
+      free(self->records[self->first_index].data);
+      self->first_index = (self->first_index + 1u) % self->retention;
+      self->num_records--;
+      self->num_evicted++;
+   }
+   index = (self->first_index + self->num_records) % self->retention;
+   self->records[index].data = record;
+   self->records[index].size = size;
+   self->num_records++;
+   return sequence;
+}
+
+uint32_t apx_streamBuffer_length(apx_streamBuffer_t const* self)
+{
+   if (self != NULL)
+   {
+      return self->num_records;
+   }
+   return 0u;
+}
+
+/**
+ * Returns retained record by age, index 0 is the oldest record.
+ */
+apx_streamRecord_t const* apx_streamBuffer_get(apx_streamBuffer_t const* self, uint32_t index)
+{
+   if ( (self != NULL) && (index < self->num_records) )
+   {
+      return &self->records[(self->first_index + index) % self->retention];
+   }
+   return NULL;
+}
+
+uint32_t apx_streamBuffer_next_sequence(apx_streamBuffer_t const* self)
+{
+   if (self != NULL)
+   {
+      return self->next_sequence;
+   }
+   return 0u;
+}
+
+uint32_t apx_streamBuffer_num_evicted(apx_streamBuffer_t const* self)
+{
+   if (self != NULL)
+   {
+      return self->num_evicted;
+   }
+   return 0u;
+}
+
+void apx_streamBuffer_set_active(apx_streamBuffer_t* self, bool is_active)
+{
+   if (self != NULL)
+   {
+      self->is_active = is_active;
+   }
+}
+
+bool apx_streamBuffer_is_active(apx_streamBuffer_t const* self)
+{
+   if (self != NULL)
+   {
+      return self->is_active;
+   }
+   return false;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
@@ -0,0 +1,230 @@
+/*****************************************************************************
+* \file      timer_wheel.c
+* \author    Conny Gustafsson
+* \date      2026-10-18
+* \brief     Hashed timer wheel
+*
+* Copyright (c) 2026 Conny Gustafsson
+* Permission is hereby granted, free of charge, to any person obtaining a copy of
+* this software and associated documentation files (the "Software"), to deal in
+* the Software without restriction, including without limitation the rights to
+* use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+* the Software, and to permit persons to whom the Software is furnished to do so,
+* subject to the following conditions:
+
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+* FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+* COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+* IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+* CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+******************************************************************************/
+//////////////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////////////
+#include <assert.h>
+#include <string.h>
+#include <malloc.h>
+#include "apx/timer_wheel.h"
+#ifdef MEM_LEAK_CHECK
+#include "CMemLeak.h"
+#endif
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE CONSTANTS AND DATA TYPES
+//////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////////////
+static void unlink_entry(apx_timerWheelEntry_t* entry);
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE VARIABLES
+//////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////
+// PUBLIC FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+apx_error_t apx_timerWheel_create(apx_timerWheel_t* self, uint32_t num_slots)
+{
+   if ( (self != NULL) && (num_slots > 0u) )
+   {
+      uint32_t i;
+      self->slots = (apx_timerWheelEntry_t*)malloc(num_slots * sizeof(apx_timerWheelEntry_t));
+      if (self->slots == NULL)
+      {
+         return APX_MEM_ERROR;
+      }
+      for (i = 0u; i < num_slots; i++)
+      {
+         apx_timerWheelEntry_t* sentinel = &self->slots[i];
+         sentinel->next = sentinel;
+         sentinel->prev = sentinel;
+         sentinel->expire_tick = 0u;
+         sentinel->is_scheduled = false;
+      }
+      self->num_slots = num_slots;
+      self->num_scheduled = 0u;
+      self->current_tick = 0u;
+      return APX_NO_ERROR;
+   }
+   return APX_INVALID_ARGUMENT_ERROR;
+}
+
+/**
+ * Entries still scheduled are left untouched, they are owned by the caller.
+ */
+void apx_timerWheel_destroy(apx_timerWheel_t* self)
+{
+   if (self != NULL)
+   {
+      free(self->slots);
+      self->slots = NULL;
+      self->num_slots = 0u;
+      self->num_scheduled = 0u;
+   }
+}
+
+apx_timerWheel_t* apx_timerWheel_new(uint32_t num_slots)
+{
+   apx_timerWheel_t* self = (apx_timerWheel_t*)malloc(sizeof(apx_timerWheel_t));
+   if (self != NULL)
+   {
+      apx_error_t result = apx_timerWheel_create(self, num_slots);
+      if (result != APX_NO_ERROR)
+      {
+         free(self);
+         self = NULL;
+      }
+   }
+   return self;
+}
+
+void apx_timerWheel_delete(apx_timerWheel_t* self)
+{
+   if (self != NULL)
+   {
+      apx_timerWheel_destroy(self);
+      free(self);
+   }
+}
+
+void apx_timerWheelEntry_create(apx_timerWheelEntry_t* entry)
+{
+   if (entry != NULL)
+   {
+      entry->next = NULL;
+      entry->prev = NULL;
+      entry->expire_tick = 0u;
+      entry->is_scheduled = false;
+   }
+}
+
+/**
+ * Schedules (or reschedules) entry to expire at expire_tick. Ticks that already passed expire on the next tick.
+ */
+void apx_timerWheel_schedule(apx_timerWheel_t* self, apx_timerWheelEntry_t* entry, uint64_t expire_tick)
+{
+   if ( (self != NULL) && (entry != NULL) )
+   {
+      apx_timerWheelEntry_t* sentinel;
+      if (entry->is_scheduled)
+      {
+         apx_timerWheel_cancel(self, entry);
+      }
+      if (expire_tick <= self->current_tick)
+      {
+         expire_tick = self->current_tick + 1u;
+      }
+      sentinel = &self->slots[expire_tick % self->num_slots];
+      entry->expire_tick = expire_tick;
+      entry->prev = sentinel->prev;
+      entry->next = sentinel;
+      sentinel->prev->next = entry;
+      sentinel->prev = entry;
+      entry->is_scheduled = true;
+      self->num_scheduled++;
+   }
+}
+
+void apx_timerWheel_cancel(apx_timerWheel_t* self, apx_timerWheelEntry_t* entry)
+{
+   if ( (self != NULL) && (entry != NULL) && (entry->is_scheduled) )
+   {
+      unlink_entry(entry);
+      assert(self->num_scheduled > 0u);
+      self->num_scheduled--;
+   }
+}
+
+/**
+ * Moves the wheel forward to now_tick and returns all entries that expired on the way.
+ * The returned entries are linked through their next member (NULL-terminated) and are no longer scheduled.
+ */
+apx_timerWheelEntry_t* apx_timerWheel_advance(apx_timerWheel_t* self, uint64_t now_tick)
+{
+   apx_timerWheelEntry_t* expired = NULL;
+   if ( (self != NULL) && (now_tick > self->current_tick) )
+   {
+      uint64_t num_steps = now_tick - self->current_tick;
+      uint64_t step;
+      if (num_steps > self->num_slots)
+      {
+         num_steps = self->num_slots; //every slot is visited once
+      }
+      for (step = 1u; (step <= num_steps) && (self->num_scheduled > 0u); step++)
+      {
+         apx_timerWheelEntry_t* sentinel = &self->slots[(self->current_tick + step) % self->num_slots];
+         apx_timerWheelEntry_t* entry = sentinel->next;
+         while (entry != sentinel)
+         {
+            apx_timerWheelEntry_t* next = entry->next;
+            if (entry->expire_tick <= now_tick)
+            {
+               unlink_entry(entry);
+               self->num_scheduled--;
+               entry->next = expired;
+               expired = entry;
+            }
+            entry = next;
+         }
+      }
+      self->current_tick = now_tick;
+   }
+   return expired;
+}
+
+uint64_t apx_timerWheel_current_tick(apx_timerWheel_t const* self)
+{
+   if (self != NULL)
+   {
+      return self->current_tick;
+   }
+   return 0u;
+}
+
+uint32_t apx_timerWheel_num_scheduled(apx_timerWheel_t const* self)
+{
+   if (self != NULL)
+   {
+      return self->num_scheduled;
+   }
+   return 0u;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+static void unlink_entry(apx_timerWheelEntry_t* entry)
+{
+   entry->prev->next = entry->next;
+   entry->next->prev = entry->prev;
+   entry->next = NULL;
+   entry->prev = NULL;
+   entry->is_scheduled = false;
+}
@@ -31,6 +31,14 @@
 #include <string.h>
 #include <assert.h>
 #include <stdlib.h>
+#ifdef _WIN32
+# ifndef WIN32_LEAN_AND_MEAN
+# define WIN32_LEAN_AND_MEAN
+# endif
+# include <Windows.h>
+#else
+# include <time.h>
+#endif
 #include "apx/util.h"
 
 //////////////////////////////////////////////////////////////////////////////
@@ -228,6 +236,31 @@ apx_error_t convert_from_adt_to_apx_error(adt_error_t error_code)
    return retval;
 }
 
+uint64_t apx_time_monotonic_us(void)
+{
+#ifdef _WIN32
+   LARGE_INTEGER frequency;
+   LARGE_INTEGER counter;
+   uint64_t seconds;
+   uint64_t remainder;
+   QueryPerformanceFrequency(&frequency);
+   QueryPerformanceCounter(&counter);
+   //Split to avoid overflow of counter * 1000000 after a few days of uptime
+   seconds = (uint64_t)counter.QuadPart / (uint64_t)frequency.QuadPart;
+   remainder = (uint64_t)counter.QuadPart % (uint64_t)frequency.QuadPart;
+   return (seconds * 1000000u) + ((remainder * 1000000u) / (uint64_t)frequency.QuadPart);
+#else
+   struct timespec now;
+   clock_gettime(CLOCK_MONOTONIC, &now);
+   return ((uint64_t)now.tv_sec * 1000000u) + ((uint64_t)now.tv_nsec / 1000u);
+#endif
+}
+
+uint64_t apx_time_monotonic_ms(void)
+{
+   return apx_time_monotonic_us() / 1000u;
+}
+
 //////////////////////////////////////////////////////////////////////////////
 // PRIVATE FUNCTIONS
 //////////////////////////////////////////////////////////////////////////////
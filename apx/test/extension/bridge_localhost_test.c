@@ -0,0 +1,238 @@
+//////////////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////////////
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "osmacro.h"
+#include "dtl_type.h"
+#include "apx/server.h"
+#include "apx/client.h"
+#include "apx/extension/socket_server.h"
+#include "apx/extension/bridge.h"
+#include "apx/util.h"
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE CONSTANTS AND DATA TYPES
+//////////////////////////////////////////////////////////////////////////////
+#define SERVER_A_PORT 5701u
+#define SERVER_B_PORT 5702u
+#define TIMEOUT_MS 10000u
+#define POLL_INTERVAL_MS 10u
+
+typedef struct test_server_tag
+{
+   apx_server_t *server;
+   apx_socketServer_t *socket_server;
+} test_server_t;
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////////////
+#ifdef _WIN32
+static int init_wsa(void);
+#endif
+static bool start_server(test_server_t *self, uint16_t tcp_port, const char *tag);
+static void stop_server(test_server_t *self);
+static apx_client_t *create_client(const char *definition, uint16_t tcp_port);
+static void delete_client(apx_client_t *client);
+static bool write_value(apx_client_t *provider, uint32_t value);
+static bool wait_for_value(apx_client_t *requester, uint32_t expected);
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE VARIABLES
+//////////////////////////////////////////////////////////////////////////////
+static const char *m_provider_definition =
+"APX/1.2\n"
+"N\"BridgeTestProvider\"\n"
+"P\"BridgeTest_Value\"S:=65535\n"
+"\n";
+static const char *m_requester_definition =
+"APX/1.2\n"
+"N\"BridgeTestRequester\"\n"
+"R\"BridgeTest_Value\"S:=65535\n"
+"\n";
+
+//////////////////////////////////////////////////////////////////////////////
+// PUBLIC FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Runs two servers on localhost with a bridge on server B that has server A as its peer.
+ * A value written by a provider on server A must reach a requester on server B.
+ */
+int main(void)
+{
+   int retval = 1;
+   test_server_t server_a;
+   test_server_t server_b;
+   apx_bridge_t *bridge = NULL;
+   apx_client_t *provider = NULL;
+   apx_client_t *requester = NULL;
+#ifdef _WIN32
+   if (init_wsa() != 0)
+   {
+      fprintf(stderr, "WSAStartup failed with error: %d\n", WSAGetLastError());
+      return 1;
+   }
+#endif
+   memset(&server_a, 0, sizeof(server_a));
+   memset(&server_b, 0, sizeof(server_b));
+   if (start_server(&server_a, SERVER_A_PORT, "A") && start_server(&server_b, SERVER_B_PORT, "B"))
+   {
+      bridge = apx_bridge_new(server_b.server, "B");
+   }
+   if (bridge != NULL)
+   {
+      apx_bridge_set_poll_interval(bridge, POLL_INTERVAL_MS);
+      if ( (apx_bridge_set_local_endpoint(bridge, "127.0.0.1", SERVER_B_PORT) == APX_NO_ERROR) &&
+           (apx_bridge_add_peer(bridge, "127.0.0.1", SERVER_A_PORT) != NULL) &&
+           (apx_bridge_start(bridge) == APX_NO_ERROR) )
+      {
+         provider = create_client(m_provider_definition, SERVER_A_PORT);
+         requester = create_client(m_requester_definition, SERVER_B_PORT);
+      }
+   }
+   if ( (provider != NULL) && (requester != NULL) )
+   {
+      //The first value reaches server B when the bridge imports the signature, the second one is forwarded
+      if (write_value(provider, 0x1234u) && wait_for_value(requester, 0x1234u) &&
+          write_value(provider, 0x5678u) && wait_for_value(requester, 0x5678u))
+      {
+         retval = 0;
+      }
+   }
+   printf("%s\n", (retval == 0) ? "OK" : "FAILED");
+   delete_client(requester);
+   delete_client(provider);
+   apx_bridge_delete(bridge);
+   stop_server(&server_b);
+   stop_server(&server_a);
+#ifdef _WIN32
+   WSACleanup();
+#endif
+   return retval;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+#ifdef _WIN32
+static int init_wsa(void)
+{
+   WORD wVersionRequested;
+   WSADATA wsaData;
+   int err;
+   wVersionRequested = MAKEWORD(2, 2);
+   err = WSAStartup(wVersionRequested, &wsaData);
+   return err;
+}
+#endif
+
+static bool start_server(test_server_t *self, uint16_t tcp_port, const char *tag)
+{
+   self->server = apx_server_new();
+   if (self->server == NULL)
+   {
+      return false;
+   }
+   apx_server_start(self->server);
+   self->socket_server = apx_socketServer_new(self->server);
+   if (self->socket_server == NULL)
+   {
+      return false;
+   }
+   apx_socketServer_start_tcp_server(self->socket_server, tcp_port, tag);
+   return self->socket_server->is_tcp_server_started;
+}
+
+static void stop_server(test_server_t *self)
+{
+   if (self->socket_server != NULL)
+   {
+      apx_socketServer_stop_all(self->socket_server);
+      apx_socketServer_delete(self->socket_server);
+   }
+   if (self->server != NULL)
+   {
+      apx_server_delete(self->server);
+   }
+}
+
+static apx_client_t *create_client(const char *definition, uint16_t tcp_port)
+{
+   apx_client_t *client = apx_client_new();
+   if (client != NULL)
+   {
+      apx_error_t result = apx_client_build_node(client, definition);
+      if (result == APX_NO_ERROR)
+      {
+         result = apx_client_connect_tcp(client, "127.0.0.1", tcp_port);
+      }
+      if (result != APX_NO_ERROR)
+      {
+         fprintf(stderr, "Failed to connect client to port %d (error %d)\n", (int) tcp_port, (int) result);
+         apx_client_delete(client);
+         client = NULL;
+      }
+   }
+   return client;
+}
+
+static void delete_client(apx_client_t *client)
+{
+   if (client != NULL)
+   {
+      apx_client_disconnect(client);
+      apx_client_delete(client);
+   }
+}
+
+static bool write_value(apx_client_t *provider, uint32_t value)
+{
+   apx_error_t result;
+   dtl_sv_t *sv = dtl_sv_new();
+   apx_portInstance_t *port = apx_client_get_port_instance_by_name(provider, "BridgeTestProvider", "BridgeTest_Value");
+   if ( (sv == NULL) || (port == NULL) )
+   {
+      if (sv != NULL) dtl_dec_ref(sv);
+      return false;
+   }
+   dtl_sv_set_u32(sv, value);
+   result = apx_client_write_port_data(provider, port, (dtl_dv_t*) sv);
+   dtl_dec_ref(sv);
+   if (result != APX_NO_ERROR)
+   {
+      fprintf(stderr, "apx_client_write_port_data failed with error %d\n", (int) result);
+      return false;
+   }
+   return true;
+}
+
+static bool wait_for_value(apx_client_t *requester, uint32_t expected)
+{
+   uint32_t last_value = 0u;
+   uint64_t start_time = apx_time_monotonic_ms();
+   apx_portInstance_t *port = apx_client_get_port_instance_by_name(requester, "BridgeTestRequester", "BridgeTest_Value");
+   if (port == NULL)
+   {
+      return false;
+   }
+   while ( (apx_time_monotonic_ms() - start_time) < TIMEOUT_MS )
+   {
+      dtl_dv_t *dv = NULL;
+      if ( (apx_client_read_port_data(requester, port, &dv) == APX_NO_ERROR) && (dv != NULL) )
+      {
+         bool ok = false;
+         last_value = dtl_sv_to_u32((dtl_sv_t*) dv, &ok);
+         dtl_dec_ref(dv);
+         if (ok && (last_value == expected))
+         {
+            return true;
+         }
+      }
+      SLEEP(POLL_INTERVAL_MS);
+   }
+   fprintf(stderr, "Timeout waiting for value 0x%04x on server B, last value was 0x%04x\n", (unsigned) expected, (unsigned) last_value);
+   return false;
+}
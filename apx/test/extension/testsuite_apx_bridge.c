@@ -0,0 +1,492 @@
+//////////////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////////////
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "CuTest.h"
+#include "apx/extension/bridge.h"
+#include "apx/server.h"
+#include "apx/node_manager.h"
+#include "apx/node_data.h"
+#ifdef MEM_LEAK_CHECK
+#include "CMemLeak.h"
+#endif
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE CONSTANTS AND DATA TYPES
+//////////////////////////////////////////////////////////////////////////////
+#define ENGINE_SPEED_SIGNATURE "\"EngineSpeed\"S"
+#define VEHICLE_SPEED_SIGNATURE "\"VehicleSpeed\"S"
+#define WHEEL_SPEED_SIGNATURE "\"WheelSpeed\"S"
+
+static const char *m_requester_text =
+      "APX/1.2\n"
+      "N\"Requester1\"\n"
+      "R\"EngineSpeed\"S:=65535\n"
+      "R\"VehicleSpeed\"S:=65535\n";
+
+static const char *m_provider_text =
+      "APX/1.2\n"
+      "N\"Provider1\"\n"
+      "P\"VehicleSpeed\"S:=65535\n";
+
+static const char *m_engine_provider_text =
+      "APX/1.2\n"
+      "N\"Provider2\"\n"
+      "P\"EngineSpeed\"S:=65535\n";
+
+static const char *m_bridge_requester_text =
+      "APX/1.2\n"
+      "N\"Bridge_B_Import1\"\n"
+      "R\"WheelSpeed\"S\n";
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////////////
+static void test_collect_unresolved_signatures(CuTest* tc);
+static void test_create_definition(CuTest* tc);
+static void test_import_only_new_signatures(CuTest* tc);
+static void test_import_splits_port_name_clash(CuTest* tc);
+static void test_received_value_is_exported_to_local_server(CuTest* tc);
+static void test_first_link_to_deliver_owns_export(CuTest* tc);
+static void test_run_imports_unresolved_signatures_from_server(CuTest* tc);
+static void test_unused_signatures_are_unsubscribed(CuTest* tc);
+static void test_dropped_link_is_reconnected(CuTest* tc);
+static void test_local_provider_replaces_export(CuTest* tc);
+static void push_signature(adt_ary_t *signatures, const char *signature);
+static void write_require_port(apx_bridgeLink_t *link, const char *node_name, const char *port_name, uint16_t value);
+static uint16_t read_export_value(CuTest* tc, apx_bridge_t *bridge, const char *node_name, const char *port_name);
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE VARIABLES
+//////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////
+// PUBLIC FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+CuSuite* testSuite_apx_bridge(void)
+{
+   CuSuite* suite = CuSuiteNew();
+
+   SUITE_ADD_TEST(suite, test_collect_unresolved_signatures);
+   SUITE_ADD_TEST(suite, test_create_definition);
+   SUITE_ADD_TEST(suite, test_import_only_new_signatures);
+   SUITE_ADD_TEST(suite, test_import_splits_port_name_clash);
+   SUITE_ADD_TEST(suite, test_received_value_is_exported_to_local_server);
+   SUITE_ADD_TEST(suite, test_first_link_to_deliver_owns_export);
+   SUITE_ADD_TEST(suite, test_run_imports_unresolved_signatures_from_server);
+   SUITE_ADD_TEST(suite, test_unused_signatures_are_unsubscribed);
+   SUITE_ADD_TEST(suite, test_dropped_link_is_reconnected);
+   SUITE_ADD_TEST(suite, test_local_provider_replaces_export);
+
+   return suite;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+static void test_collect_unresolved_signatures(CuTest* tc)
+{
+   apx_nodeManager_t *node_manager = apx_nodeManager_new(APX_SERVER_MODE);
+   apx_portSignatureMap_t *map = apx_portSignatureMap_new();
+   apx_nodeInstance_t *requester;
+   apx_nodeInstance_t *provider;
+   apx_nodeInstance_t *bridge_requester;
+   adt_ary_t signatures;
+   adt_ary_create(&signatures, free);
+
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_nodeManager_build_node(node_manager, m_requester_text));
+   requester = apx_nodeManager_get_last_attached(node_manager);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_nodeManager_build_node(node_manager, m_provider_text));
+   provider = apx_nodeManager_get_last_attached(node_manager);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_nodeManager_build_node(node_manager, m_bridge_requester_text));
+   bridge_requester = apx_nodeManager_get_last_attached(node_manager);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_portSignatureMap_connect_require_ports(map, requester));
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_portSignatureMap_connect_provide_ports(map, provider));
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_portSignatureMap_connect_require_ports(map, bridge_requester));
+   CuAssertIntEquals(tc, 3, apx_portSignatureMap_length(map));
+
+   //VehicleSpeed has a local provider and WheelSpeed is only requested by another bridge
+   CuAssertIntEquals(tc, 1, apx_bridge_collect_unresolved_signatures(map, &signatures));
+   CuAssertStrEquals(tc, ENGINE_SPEED_SIGNATURE, (const char*) adt_ary_value(&signatures, 0));
+
+   adt_ary_destroy(&signatures);
+   apx_portSignatureMap_delete(map);
+   apx_nodeManager_delete(node_manager);
+}
+
+static void test_create_definition(CuTest* tc)
+{
+   apx_server_t *server = apx_server_new();
+   apx_bridge_t *bridge = apx_bridge_new(server, "A");
+   apx_bridgeLink_t *link;
+   adt_ary_t signatures;
+   adt_ary_t ports;
+   adt_str_t *str;
+   adt_ary_create(&signatures, free);
+   adt_ary_create(&ports, NULL);
+   CuAssertPtrNotNull(tc, bridge);
+   link = apx_bridge_add_peer(bridge, "127.0.0.1", 5001u);
+   CuAssertPtrNotNull(tc, link);
+   push_signature(&signatures, ENGINE_SPEED_SIGNATURE);
+   push_signature(&signatures, VEHICLE_SPEED_SIGNATURE);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_bridgeLink_import_signatures(link, &signatures));
+   adt_ary_push(&ports, adt_hash_value(&link->ports, ENGINE_SPEED_SIGNATURE));
+   adt_ary_push(&ports, adt_hash_value(&link->ports, VEHICLE_SPEED_SIGNATURE));
+
+   str = apx_bridge_create_definition("Bridge_A_Import1", 'R', &ports);
+   CuAssertPtrNotNull(tc, str);
+   CuAssertStrEquals(tc, "APX/1.2\nN\"Bridge_A_Import1\"\nR\"EngineSpeed\"S\nR\"VehicleSpeed\"S\n", adt_str_cstr(str));
+   adt_str_delete(str);
+   str = apx_bridge_create_definition("Bridge_A_Export1", 'P', &ports);
+   CuAssertPtrNotNull(tc, str);
+   CuAssertStrEquals(tc, "APX/1.2\nN\"Bridge_A_Export1\"\nP\"EngineSpeed\"S\nP\"VehicleSpeed\"S\n", adt_str_cstr(str));
+   adt_str_delete(str);
+   CuAssertPtrEquals(tc, NULL, apx_bridge_create_definition("Bridge_A_Export1", 'X', &ports));
+
+   adt_ary_destroy(&ports);
+   adt_ary_destroy(&signatures);
+   apx_bridge_delete(bridge);
+   apx_server_delete(server);
+}
+
+static void test_import_only_new_signatures(CuTest* tc)
+{
+   apx_server_t *server = apx_server_new();
+   apx_bridge_t *bridge = apx_bridge_new(server, "A");
+   apx_bridgeLink_t *link = apx_bridge_add_peer(bridge, "127.0.0.1", 5001u);
+   apx_nodeManager_t *remote_node_manager;
+   apx_nodeInstance_t *node_instance;
+   adt_ary_t signatures;
+   adt_ary_create(&signatures, free);
+   CuAssertPtrNotNull(tc, link);
+   remote_node_manager = apx_client_get_node_manager(link->client);
+
+   push_signature(&signatures, ENGINE_SPEED_SIGNATURE);
+   push_signature(&signatures, VEHICLE_SPEED_SIGNATURE);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_bridgeLink_import_signatures(link, &signatures));
+   CuAssertIntEquals(tc, 2, apx_bridgeLink_num_imported_signatures(link));
+   node_instance = apx_nodeManager_find(remote_node_manager, "Bridge_A_Import1");
+   CuAssertPtrNotNull(tc, node_instance);
+   CuAssertUIntEquals(tc, 2u, apx_nodeInstance_get_num_require_ports(node_instance));
+   CuAssertUIntEquals(tc, 0u, apx_nodeInstance_get_num_provide_ports(node_instance));
+
+   //Signatures already imported are not requested a second time
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_bridgeLink_import_signatures(link, &signatures));
+   CuAssertIntEquals(tc, 1, adt_ary_length(&link->imports));
+
+   push_signature(&signatures, WHEEL_SPEED_SIGNATURE);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_bridgeLink_import_signatures(link, &signatures));
+   CuAssertIntEquals(tc, 3, apx_bridgeLink_num_imported_signatures(link));
+   node_instance = apx_nodeManager_find(remote_node_manager, "Bridge_A_Import2");
+   CuAssertPtrNotNull(tc, node_instance);
+   CuAssertUIntEquals(tc, 1u, apx_nodeInstance_get_num_require_ports(node_instance));
+
+   adt_ary_destroy(&signatures);
+   apx_bridge_delete(bridge);
+   apx_server_delete(server);
+}
+
+static void test_import_splits_port_name_clash(CuTest* tc)
+{
+   apx_server_t *server = apx_server_new();
+   apx_bridge_t *bridge = apx_bridge_new(server, "A");
+   apx_bridgeLink_t *link = apx_bridge_add_peer(bridge, "127.0.0.1", 5001u);
+   apx_nodeManager_t *remote_node_manager;
+   adt_ary_t signatures;
+   adt_ary_create(&signatures, free);
+   CuAssertPtrNotNull(tc, link);
+   remote_node_manager = apx_client_get_node_manager(link->client);
+
+   push_signature(&signatures, "\"Speed\"S");
+   push_signature(&signatures, "\"Speed\"L");
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_bridgeLink_import_signatures(link, &signatures));
+   CuAssertIntEquals(tc, 1, apx_bridgeLink_num_imported_signatures(link));
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_bridgeLink_import_signatures(link, &signatures));
+   CuAssertIntEquals(tc, 2, apx_bridgeLink_num_imported_signatures(link));
+   CuAssertPtrNotNull(tc, apx_nodeManager_find(remote_node_manager, "Bridge_A_Import1"));
+   CuAssertPtrNotNull(tc, apx_nodeManager_find(remote_node_manager, "Bridge_A_Import2"));
+
+   adt_ary_destroy(&signatures);
+   apx_bridge_delete(bridge);
+   apx_server_delete(server);
+}
+
+static void test_received_value_is_exported_to_local_server(CuTest* tc)
+{
+   apx_server_t *server = apx_server_new();
+   apx_bridge_t *bridge = apx_bridge_new(server, "A");
+   apx_bridgeLink_t *link = apx_bridge_add_peer(bridge, "127.0.0.1", 5001u);
+   apx_nodeManager_t *local_node_manager;
+   adt_ary_t signatures;
+   adt_ary_create(&signatures, free);
+   CuAssertPtrNotNull(tc, link);
+   local_node_manager = apx_client_get_node_manager(apx_bridge_get_local_client(bridge));
+
+   push_signature(&signatures, ENGINE_SPEED_SIGNATURE);
+   push_signature(&signatures, VEHICLE_SPEED_SIGNATURE);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_bridgeLink_import_signatures(link, &signatures));
+
+   //Nothing is exported before the peer has delivered a value
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_bridge_export_pending_ports(bridge));
+   CuAssertPtrEquals(tc, NULL, apx_nodeManager_find(local_node_manager, "Bridge_A_Export1"));
+
+   write_require_port(link, "Bridge_A_Import1", "EngineSpeed", 0x1234u);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_bridge_export_pending_ports(bridge));
+   CuAssertPtrNotNull(tc, apx_nodeManager_find(local_node_manager, "Bridge_A_Export1"));
+   CuAssertUIntEquals(tc, 1u, apx_nodeInstance_get_num_provide_ports(apx_nodeManager_find(local_node_manager, "Bridge_A_Export1")));
+   CuAssertUIntEquals(tc, 0x1234u, read_export_value(tc, bridge, "Bridge_A_Export1", "EngineSpeed"));
+
+   //Once exported, new values are forwarded right away
+   write_require_port(link, "Bridge_A_Import1", "EngineSpeed", 0x5678u);
+   CuAssertUIntEquals(tc, 0x5678u, read_export_value(tc, bridge, "Bridge_A_Export1", "EngineSpeed"));
+
+   write_require_port(link, "Bridge_A_Import1", "VehicleSpeed", 100u);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_bridge_export_pending_ports(bridge));
+   CuAssertUIntEquals(tc, 100u, read_export_value(tc, bridge, "Bridge_A_Export2", "VehicleSpeed"));
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_bridge_export_pending_ports(bridge));
+   CuAssertPtrEquals(tc, NULL, apx_nodeManager_find(local_node_manager, "Bridge_A_Export3"));
+
+   adt_ary_destroy(&signatures);
+   apx_bridge_delete(bridge);
+   apx_server_delete(server);
+}
+
+static void test_first_link_to_deliver_owns_export(CuTest* tc)
+{
+   apx_server_t *server = apx_server_new();
+   apx_bridge_t *bridge = apx_bridge_new(server, "A");
+   apx_bridgeLink_t *link1 = apx_bridge_add_peer(bridge, "127.0.0.1", 5001u);
+   apx_bridgeLink_t *link2 = apx_bridge_add_peer(bridge, "127.0.0.1", 5002u);
+   apx_nodeManager_t *local_node_manager;
+   adt_ary_t signatures;
+   adt_ary_create(&signatures, free);
+   CuAssertPtrNotNull(tc, link1);
+   CuAssertPtrNotNull(tc, link2);
+   CuAssertIntEquals(tc, 2, apx_bridge_num_links(bridge));
+   local_node_manager = apx_client_get_node_manager(apx_bridge_get_local_client(bridge));
+
+   push_signature(&signatures, ENGINE_SPEED_SIGNATURE);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_bridgeLink_import_signatures(link1, &signatures));
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_bridgeLink_import_signatures(link2, &signatures));
+
+   write_require_port(link1, "Bridge_A_Import1", "EngineSpeed", 1u);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_bridge_export_pending_ports(bridge));
+   write_require_port(link2, "Bridge_A_Import1", "EngineSpeed", 2u);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_bridge_export_pending_ports(bridge));
+   CuAssertIntEquals(tc, 1, apx_nodeManager_length(local_node_manager));
+   CuAssertUIntEquals(tc, 1u, apx_nodeInstance_get_num_provide_ports(apx_nodeManager_find(local_node_manager, "Bridge_A_Export1")));
+   CuAssertUIntEquals(tc, 1u, read_export_value(tc, bridge, "Bridge_A_Export1", "EngineSpeed"));
+
+   //Values from the link that does not own the export are dropped
+   write_require_port(link2, "Bridge_A_Import1", "EngineSpeed", 3u);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_bridge_export_pending_ports(bridge));
+   CuAssertIntEquals(tc, 1, apx_nodeManager_length(local_node_manager));
+   CuAssertUIntEquals(tc, 1u, read_export_value(tc, bridge, "Bridge_A_Export1", "EngineSpeed"));
+
+   adt_ary_destroy(&signatures);
+   apx_bridge_delete(bridge);
+   apx_server_delete(server);
+}
+
+static void test_run_imports_unresolved_signatures_from_server(CuTest* tc)
+{
+   apx_server_t *server = apx_server_new();
+   apx_bridge_t *bridge = apx_bridge_new(server, "A");
+   apx_bridgeLink_t *link = apx_bridge_add_peer(bridge, "127.0.0.1", 5001u);
+   apx_nodeManager_t *node_manager = apx_nodeManager_new(APX_SERVER_MODE);
+   apx_portSignatureMap_t *map = apx_server_get_port_signature_map(server);
+   apx_nodeInstance_t *requester;
+   apx_nodeInstance_t *provider;
+   apx_nodeInstance_t *import_node;
+   CuAssertPtrNotNull(tc, link);
+
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_nodeManager_build_node(node_manager, m_requester_text));
+   requester = apx_nodeManager_get_last_attached(node_manager);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_nodeManager_build_node(node_manager, m_provider_text));
+   provider = apx_nodeManager_get_last_attached(node_manager);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_portSignatureMap_connect_require_ports(map, requester));
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_portSignatureMap_connect_provide_ports(map, provider));
+
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_bridge_run(bridge));
+   CuAssertIntEquals(tc, 1, apx_bridgeLink_num_imported_signatures(link));
+   import_node = apx_nodeManager_find(apx_client_get_node_manager(link->client), "Bridge_A_Import1");
+   CuAssertPtrNotNull(tc, import_node);
+   CuAssertPtrNotNull(tc, apx_nodeInstance_find_port_by_name(import_node, "EngineSpeed"));
+   CuAssertPtrEquals(tc, NULL, apx_nodeInstance_find_port_by_name(import_node, "VehicleSpeed"));
+
+   write_require_port(link, "Bridge_A_Import1", "EngineSpeed", 3000u);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_bridge_run(bridge));
+   CuAssertUIntEquals(tc, 3000u, read_export_value(tc, bridge, "Bridge_A_Export1", "EngineSpeed"));
+
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_portSignatureMap_disconnect_provide_ports(map, provider));
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_portSignatureMap_disconnect_require_ports(map, requester));
+   apx_bridge_delete(bridge);
+   apx_server_delete(server);
+   apx_nodeManager_delete(node_manager);
+}
+
+static void test_unused_signatures_are_unsubscribed(CuTest* tc)
+{
+   apx_server_t *server = apx_server_new();
+   apx_bridge_t *bridge = apx_bridge_new(server, "A");
+   apx_bridgeLink_t *link = apx_bridge_add_peer(bridge, "127.0.0.1", 5001u);
+   apx_nodeManager_t *node_manager = apx_nodeManager_new(APX_SERVER_MODE);
+   apx_portSignatureMap_t *map = apx_server_get_port_signature_map(server);
+   apx_nodeInstance_t *requester;
+   apx_client_t *old_client;
+   CuAssertPtrNotNull(tc, link);
+
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_nodeManager_build_node(node_manager, m_requester_text));
+   requester = apx_nodeManager_get_last_attached(node_manager);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_portSignatureMap_connect_require_ports(map, requester));
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_bridge_run(bridge));
+   CuAssertIntEquals(tc, 2, apx_bridgeLink_num_imported_signatures(link));
+   old_client = link->client;
+
+   //Imports are kept for the unsubscribe delay after the last requester has left
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_portSignatureMap_disconnect_require_ports(map, requester));
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_bridge_run(bridge));
+   CuAssertPtrEquals(tc, old_client, link->client);
+   CuAssertIntEquals(tc, 2, apx_bridgeLink_num_imported_signatures(link));
+
+   apx_bridge_set_unsubscribe_delay(bridge, 0u);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_bridge_run(bridge));
+   CuAssertTrue(tc, link->client != old_client);
+   CuAssertIntEquals(tc, 0, apx_bridgeLink_num_imported_signatures(link));
+   CuAssertIntEquals(tc, 0, adt_ary_length(&link->imports));
+   CuAssertPtrEquals(tc, NULL, apx_nodeManager_find(apx_client_get_node_manager(link->client), "Bridge_A_Import1"));
+
+   //The signatures are imported again when a requester returns
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_portSignatureMap_connect_require_ports(map, requester));
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_bridge_run(bridge));
+   CuAssertIntEquals(tc, 2, apx_bridgeLink_num_imported_signatures(link));
+   CuAssertPtrNotNull(tc, apx_nodeManager_find(apx_client_get_node_manager(link->client), "Bridge_A_Import1"));
+
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_portSignatureMap_disconnect_require_ports(map, requester));
+   apx_bridge_delete(bridge);
+   apx_server_delete(server);
+   apx_nodeManager_delete(node_manager);
+}
+
+static void test_dropped_link_is_reconnected(CuTest* tc)
+{
+   apx_server_t *server = apx_server_new();
+   apx_bridge_t *bridge = apx_bridge_new(server, "A");
+   apx_bridgeLink_t *link = apx_bridge_add_peer(bridge, "127.0.0.1", 5001u);
+   apx_nodeManager_t *node_manager = apx_nodeManager_new(APX_SERVER_MODE);
+   apx_portSignatureMap_t *map = apx_server_get_port_signature_map(server);
+   apx_nodeInstance_t *requester;
+   apx_nodeInstance_t *provider;
+   apx_client_t *old_client;
+   CuAssertPtrNotNull(tc, link);
+
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_nodeManager_build_node(node_manager, m_requester_text));
+   requester = apx_nodeManager_get_last_attached(node_manager);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_nodeManager_build_node(node_manager, m_provider_text));
+   provider = apx_nodeManager_get_last_attached(node_manager);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_portSignatureMap_connect_require_ports(map, requester));
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_portSignatureMap_connect_provide_ports(map, provider));
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_bridge_run(bridge));
+   write_require_port(link, "Bridge_A_Import1", "EngineSpeed", 1000u);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_bridge_run(bridge));
+   CuAssertUIntEquals(tc, 1000u, read_export_value(tc, bridge, "Bridge_A_Export1", "EngineSpeed"));
+   old_client = link->client;
+
+   apx_bridgeLink_disconnected(link);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_bridge_run(bridge));
+   CuAssertTrue(tc, link->client != old_client);
+   CuAssertIntEquals(tc, 1, apx_bridgeLink_num_imported_signatures(link));
+   CuAssertPtrNotNull(tc, apx_nodeManager_find(apx_client_get_node_manager(link->client), "Bridge_A_Import1"));
+
+   //The export made before the link dropped carries the values from the new connection
+   write_require_port(link, "Bridge_A_Import1", "EngineSpeed", 2000u);
+   CuAssertUIntEquals(tc, 2000u, read_export_value(tc, bridge, "Bridge_A_Export1", "EngineSpeed"));
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_bridge_run(bridge));
+   CuAssertIntEquals(tc, 1, apx_nodeManager_length(apx_client_get_node_manager(apx_bridge_get_local_client(bridge))));
+
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_portSignatureMap_disconnect_provide_ports(map, provider));
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_portSignatureMap_disconnect_require_ports(map, requester));
+   apx_bridge_delete(bridge);
+   apx_server_delete(server);
+   apx_nodeManager_delete(node_manager);
+}
+
+static void test_local_provider_replaces_export(CuTest* tc)
+{
+   apx_server_t *server = apx_server_new();
+   apx_bridge_t *bridge = apx_bridge_new(server, "A");
+   apx_bridgeLink_t *link = apx_bridge_add_peer(bridge, "127.0.0.1", 5001u);
+   apx_nodeManager_t *node_manager = apx_nodeManager_new(APX_SERVER_MODE);
+   apx_portSignatureMap_t *map = apx_server_get_port_signature_map(server);
+   apx_nodeInstance_t *requester;
+   apx_nodeInstance_t *provider;
+   apx_nodeInstance_t *engine_provider;
+   apx_client_t *old_local_client;
+   CuAssertPtrNotNull(tc, link);
+
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_nodeManager_build_node(node_manager, m_requester_text));
+   requester = apx_nodeManager_get_last_attached(node_manager);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_nodeManager_build_node(node_manager, m_provider_text));
+   provider = apx_nodeManager_get_last_attached(node_manager);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_nodeManager_build_node(node_manager, m_engine_provider_text));
+   engine_provider = apx_nodeManager_get_last_attached(node_manager);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_portSignatureMap_connect_require_ports(map, requester));
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_portSignatureMap_connect_provide_ports(map, provider));
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_bridge_run(bridge));
+   write_require_port(link, "Bridge_A_Import1", "EngineSpeed", 1000u);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_bridge_run(bridge));
+   CuAssertUIntEquals(tc, 1000u, read_export_value(tc, bridge, "Bridge_A_Export1", "EngineSpeed"));
+   old_local_client = apx_bridge_get_local_client(bridge);
+
+   //A local provider appears, the bridge withdraws its own provider of the same signature
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_portSignatureMap_connect_provide_ports(map, engine_provider));
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_bridge_run(bridge));
+   CuAssertTrue(tc, apx_bridge_get_local_client(bridge) != old_local_client);
+   CuAssertIntEquals(tc, 0, apx_nodeManager_length(apx_client_get_node_manager(apx_bridge_get_local_client(bridge))));
+   write_require_port(link, "Bridge_A_Import1", "EngineSpeed", 2000u);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_bridge_run(bridge));
+   CuAssertIntEquals(tc, 0, apx_nodeManager_length(apx_client_get_node_manager(apx_bridge_get_local_client(bridge))));
+
+   //When the local provider leaves, the last value from the peer is provided again
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_portSignatureMap_disconnect_provide_ports(map, engine_provider));
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_bridge_run(bridge));
+   CuAssertUIntEquals(tc, 2000u, read_export_value(tc, bridge, "Bridge_A_Export2", "EngineSpeed"));
+
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_portSignatureMap_disconnect_provide_ports(map, provider));
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_portSignatureMap_disconnect_require_ports(map, requester));
+   apx_bridge_delete(bridge);
+   apx_server_delete(server);
+   apx_nodeManager_delete(node_manager);
+}
+
+static void push_signature(adt_ary_t *signatures, const char *signature)
+{
+   adt_ary_push(signatures, STRDUP(signature));
+}
+
+static void write_require_port(apx_bridgeLink_t *link, const char *node_name, const char *port_name, uint16_t value)
+{
+   uint8_t data[UINT16_SIZE];
+   apx_portInstance_t *port_instance = apx_client_get_port_instance_by_name(link->client, node_name, port_name);
+   data[0] = (uint8_t) (value & 0xffu);
+   data[1] = (uint8_t) (value >> 8);
+   apx_bridgeLink_require_port_written(link, port_instance, &data[0], UINT16_SIZE);
+}
+
+static uint16_t read_export_value(CuTest* tc, apx_bridge_t *bridge, const char *node_name, const char *port_name)
+{
+   uint8_t data[UINT16_SIZE] = {0u, 0u};
+   apx_client_t *local_client = apx_bridge_get_local_client(bridge);
+   apx_portInstance_t *port_instance = apx_client_get_port_instance_by_name(local_client, node_name, port_name);
+   apx_nodeData_t *node_data;
+   CuAssertPtrNotNull(tc, port_instance);
+   CuAssertIntEquals(tc, APX_PROVIDE_PORT, apx_portInstance_port_type(port_instance));
+   node_data = apx_nodeInstance_get_node_data(apx_portInstance_parent(port_instance));
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_nodeData_read_provide_port_data(node_data, apx_portInstance_data_offset(port_instance), &data[0], UINT16_SIZE));
+   return (uint16_t) (data[0] | (data[1] << 8));
+}
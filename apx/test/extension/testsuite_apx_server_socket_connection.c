@@ -44,6 +44,11 @@ static void test_each_connection_get_unique_id(CuTest* tc);
 static void test_server_sends_acknowledge_after_accepting_header(CuTest* tc);
 static void test_server_opens_definition_file_after_publication(CuTest *tc);
 static void test_server_parses_definition_data_after_transmission(CuTest *tc);
+static void test_send_buffer_is_kept_after_flush(CuTest *tc);
+static void test_large_message_is_sent_without_copy(CuTest *tc);
+static void test_batching_flushes_when_max_pending_bytes_reached(CuTest *tc);
+static void test_batching_holds_data_until_deadline(CuTest *tc);
+static void test_data_not_accepted_by_socket_is_sent_later_in_order(CuTest *tc);
 static void send_header(testsocket_t *sock);
 static void send_file_info_no_checksum(CuTest* tc, testsocket_t *sock, const char *name, uint32_t startAddress, uint32_t length);
 static void verify_acknowledge(CuTest* tc, testsocket_t *sock);
@@ -76,6 +81,11 @@ CuSuite* testSuite_apx_socketServerConnection(void)
    SUITE_ADD_TEST(suite, test_server_sends_acknowledge_after_accepting_header);
    SUITE_ADD_TEST(suite, test_server_opens_definition_file_after_publication);
    SUITE_ADD_TEST(suite, test_server_parses_definition_data_after_transmission);
+   SUITE_ADD_TEST(suite, test_send_buffer_is_kept_after_flush);
+   SUITE_ADD_TEST(suite, test_large_message_is_sent_without_copy);
+   SUITE_ADD_TEST(suite, test_batching_flushes_when_max_pending_bytes_reached);
+   SUITE_ADD_TEST(suite, test_batching_holds_data_until_deadline);
+   SUITE_ADD_TEST(suite, test_data_not_accepted_by_socket_is_sent_later_in_order);
    return suite;
 }
 
@@ -199,6 +209,218 @@ static void test_server_parses_definition_data_after_transmission(CuTest *tc)
    testsocket_spy_destroy();
 }
 
+static void test_send_buffer_is_kept_after_flush(CuTest *tc)
+{
+   apx_server_t server;
+   testsocket_t *sock;
+   apx_socketServerConnection_t *connection;
+   testsocket_spy_create();
+   sock = testsocket_spy_client();
+   apx_server_create(&server);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_socketServerExtension_register(&server, NULL));
+   apx_server_start(&server);
+   apx_socketServerExtension_accept_testsocket(sock);
+   connection = (apx_socketServerConnection_t*) apx_server_get_last_connection(&server);
+   CuAssertPtrNotNull(tc, connection);
+   testsocket_onConnect(sock);
+   send_header(sock);
+   SERVER_RUN(&server, sock);
+   verify_acknowledge(tc, sock);
+   CuAssertUIntEquals(tc, connection->default_buffer_size, adt_bytearray_length(&connection->send_buffer));
+   CuAssertUIntEquals(tc, 0u, connection->pending_bytes);
+   CuAssertULIntEquals(tc, 9u, apx_socketServerConnection_get_total_bytes_copied(connection));
+   CuAssertULIntEquals(tc, 9u, apx_socketServerConnection_get_total_bytes_written(connection));
+   apx_server_destroy(&server);
+   testsocket_spy_destroy();
+}
+
+static void test_large_message_is_sent_without_copy(CuTest *tc)
+{
+   apx_server_t server;
+   testsocket_t *sock;
+   apx_socketServerConnection_t *connection;
+   uint8_t payload[1000];
+   uint32_t const write_address = 0x1000;
+   int32_t bytes_available = 0;
+   uint32_t len;
+   uint8_t const *data;
+   testsocket_spy_create();
+   sock = testsocket_spy_client();
+   apx_server_create(&server);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_socketServerExtension_register(&server, NULL));
+   apx_server_start(&server);
+   apx_socketServerExtension_accept_testsocket(sock);
+   connection = (apx_socketServerConnection_t*) apx_server_get_last_connection(&server);
+   CuAssertPtrNotNull(tc, connection);
+   testsocket_onConnect(sock);
+   memset(payload, 0x55, sizeof(payload));
+   apx_socketServerConnection_vtransmit_begin((void*) connection);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_socketServerConnection_vtransmit_data_message((void*)connection, write_address, false, payload, (int32_t) sizeof(payload), &bytes_available));
+   apx_socketServerConnection_vtransmit_end((void*) connection);
+   testsocket_run(sock);
+   data = testsocket_spy_getReceivedData(&len);
+   CuAssertPtrNotNull(tc, data);
+   //4-byte numheader + 2-byte address + payload
+   CuAssertUIntEquals(tc, NUMHEADER32_LONG_SIZE + RMF_LOW_ADDR_SIZE + sizeof(payload), len);
+   CuAssertUIntEquals(tc, 0x55, data[len - 1]);
+   CuAssertULIntEquals(tc, 0u, apx_socketServerConnection_get_total_bytes_copied(connection));
+   CuAssertULIntEquals(tc, len, apx_socketServerConnection_get_total_bytes_written(connection));
+   testsocket_spy_clearReceivedData();
+   apx_server_destroy(&server);
+   testsocket_spy_destroy();
+}
+
+static void test_batching_flushes_when_max_pending_bytes_reached(CuTest *tc)
+{
+   apx_server_t server;
+   testsocket_t *sock;
+   apx_socketServerConnection_t *connection;
+   apx_socketBatchingCfg_t batching;
+   uint8_t payload[10];
+   int32_t bytes_available = 0;
+   uint32_t len;
+   testsocket_spy_create();
+   sock = testsocket_spy_client();
+   apx_server_create(&server);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_socketServerExtension_register(&server, NULL));
+   apx_server_start(&server);
+   apx_socketServerExtension_accept_testsocket(sock);
+   connection = (apx_socketServerConnection_t*) apx_server_get_last_connection(&server);
+   CuAssertPtrNotNull(tc, connection);
+   testsocket_onConnect(sock);
+   apx_socketBatchingCfg_set_defaults(&batching);
+   batching.max_pending_bytes = 16u;
+   apx_socketServerConnection_set_batching(connection, &batching);
+   memset(payload, 0, sizeof(payload));
+   //Each message is 1 byte numheader + 2 byte address + 10 byte payload
+   apx_socketServerConnection_vtransmit_begin((void*) connection);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_socketServerConnection_vtransmit_data_message((void*)connection, 0x1000, false, payload, (int32_t) sizeof(payload), &bytes_available));
+   testsocket_run(sock);
+   CuAssertPtrEquals(tc, NULL, (void*) testsocket_spy_getReceivedData(&len));
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_socketServerConnection_vtransmit_data_message((void*)connection, 0x1000, false, payload, (int32_t) sizeof(payload), &bytes_available));
+   testsocket_run(sock);
+   CuAssertPtrNotNull(tc, testsocket_spy_getReceivedData(&len));
+   CuAssertUIntEquals(tc, 26u, len);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_socketServerConnection_vtransmit_data_message((void*)connection, 0x1000, false, payload, (int32_t) sizeof(payload), &bytes_available));
+   apx_socketServerConnection_vtransmit_end((void*) connection);
+   testsocket_run(sock);
+   CuAssertPtrNotNull(tc, testsocket_spy_getReceivedData(&len));
+   CuAssertUIntEquals(tc, 39u, len);
+   testsocket_spy_clearReceivedData();
+   apx_server_destroy(&server);
+   testsocket_spy_destroy();
+}
+
+static void test_batching_holds_data_until_deadline(CuTest *tc)
+{
+   apx_server_t server;
+   testsocket_t *sock;
+   apx_socketServerConnection_t *connection;
+   apx_socketBatchingCfg_t batching;
+   uint8_t payload[10];
+   int32_t bytes_available = 0;
+   uint32_t len;
+   testsocket_spy_create();
+   sock = testsocket_spy_client();
+   apx_server_create(&server);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_socketServerExtension_register(&server, NULL));
+   apx_server_start(&server);
+   apx_socketServerExtension_accept_testsocket(sock);
+   connection = (apx_socketServerConnection_t*) apx_server_get_last_connection(&server);
+   CuAssertPtrNotNull(tc, connection);
+   testsocket_onConnect(sock);
+   apx_socketBatchingCfg_set_defaults(&batching);
+   batching.max_pending_us = 20000u;
+   apx_socketServerConnection_set_batching(connection, &batching);
+   memset(payload, 0, sizeof(payload));
+   CuAssertIntEquals(tc, -1, apx_socketServerConnection_vtransmit_flush_deadline((void*) connection));
+   apx_socketServerConnection_vtransmit_begin((void*) connection);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_socketServerConnection_vtransmit_data_message((void*)connection, 0x1000, false, payload, (int32_t) sizeof(payload), &bytes_available));
+   apx_socketServerConnection_vtransmit_end((void*) connection);
+   testsocket_run(sock);
+   CuAssertPtrEquals(tc, NULL, (void*) testsocket_spy_getReceivedData(&len));
+   CuAssertTrue(tc, apx_socketServerConnection_vtransmit_flush_deadline((void*) connection) > 0);
+   SLEEP(30);
+   CuAssertIntEquals(tc, 0, apx_socketServerConnection_vtransmit_flush_deadline((void*) connection));
+   //This is what the file manager worker does when the deadline expires
+   apx_socketServerConnection_vtransmit_begin((void*) connection);
+   apx_socketServerConnection_vtransmit_end((void*) connection);
+   testsocket_run(sock);
+   CuAssertPtrNotNull(tc, testsocket_spy_getReceivedData(&len));
+   CuAssertUIntEquals(tc, 13u, len);
+   CuAssertIntEquals(tc, -1, apx_socketServerConnection_vtransmit_flush_deadline((void*) connection));
+   testsocket_spy_clearReceivedData();
+   apx_server_destroy(&server);
+   testsocket_spy_destroy();
+}
+
+static void test_data_not_accepted_by_socket_is_sent_later_in_order(CuTest *tc)
+{
+   apx_server_t server;
+   testsocket_t *sock;
+   apx_socketServerConnection_t *connection;
+   uint8_t small_payload[10];
+   uint8_t large_payload[1000];
+   int32_t bytes_available = 0;
+   uint32_t len;
+   uint8_t const *data;
+   testsocket_spy_create();
+   sock = testsocket_spy_client();
+   apx_server_create(&server);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_socketServerExtension_register(&server, NULL));
+   apx_server_start(&server);
+   apx_socketServerExtension_accept_testsocket(sock);
+   connection = (apx_socketServerConnection_t*) apx_server_get_last_connection(&server);
+   CuAssertPtrNotNull(tc, connection);
+   testsocket_onConnect(sock);
+   memset(large_payload, 0x22, sizeof(large_payload));
+
+   //Socket buffer is full (EAGAIN). Message A is batched, message B is sent zero-copy
+   apx_socketServerConnection_set_write_limit(connection, 0);
+   memset(small_payload, 0x11, sizeof(small_payload));
+   apx_socketServerConnection_vtransmit_begin((void*) connection);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_socketServerConnection_vtransmit_data_message((void*)connection, 0x1000, false, small_payload, (int32_t) sizeof(small_payload), &bytes_available));
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_socketServerConnection_vtransmit_data_message((void*)connection, 0x1000, false, large_payload, (int32_t) sizeof(large_payload), &bytes_available));
+   apx_socketServerConnection_vtransmit_end((void*) connection);
+   testsocket_run(sock);
+   CuAssertPtrEquals(tc, NULL, (void*) testsocket_spy_getReceivedData(&len));
+   //1+2+10 bytes for A and 4+2+1000 bytes for B
+   CuAssertUIntEquals(tc, 1019u, apx_socketServerConnection_get_unsent_bytes(connection));
+   CuAssertTrue(tc, apx_socketServerConnection_vtransmit_flush_deadline((void*) connection) > 0);
+
+   //Short write when the worker retries
+   apx_socketServerConnection_set_write_limit(connection, 7);
+   apx_socketServerConnection_vtransmit_begin((void*) connection);
+   apx_socketServerConnection_vtransmit_end((void*) connection);
+   testsocket_run(sock);
+   CuAssertPtrNotNull(tc, testsocket_spy_getReceivedData(&len));
+   CuAssertUIntEquals(tc, 7u, len);
+   CuAssertUIntEquals(tc, 1012u, apx_socketServerConnection_get_unsent_bytes(connection));
+
+   //Message C must not overtake what is still unsent
+   apx_socketServerConnection_set_write_limit(connection, -1);
+   memset(small_payload, 0x33, sizeof(small_payload));
+   apx_socketServerConnection_vtransmit_begin((void*) connection);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_socketServerConnection_vtransmit_data_message((void*)connection, 0x1000, false, small_payload, (int32_t) sizeof(small_payload), &bytes_available));
+   apx_socketServerConnection_vtransmit_end((void*) connection);
+   testsocket_run(sock);
+   data = testsocket_spy_getReceivedData(&len);
+   CuAssertPtrNotNull(tc, data);
+   CuAssertUIntEquals(tc, 1032u, len);
+   CuAssertUIntEquals(tc, 0x11, data[3]);
+   CuAssertUIntEquals(tc, 0x11, data[12]);
+   CuAssertUIntEquals(tc, 0x22, data[19]);
+   CuAssertUIntEquals(tc, 0x22, data[1018]);
+   CuAssertUIntEquals(tc, 0x33, data[1022]);
+   CuAssertUIntEquals(tc, 0x33, data[1031]);
+   CuAssertUIntEquals(tc, 0u, apx_socketServerConnection_get_unsent_bytes(connection));
+   CuAssertIntEquals(tc, -1, apx_socketServerConnection_vtransmit_flush_deadline((void*) connection));
+   CuAssertULIntEquals(tc, 1032u, apx_socketServerConnection_get_total_bytes_written(connection));
+   testsocket_spy_clearReceivedData();
+   apx_server_destroy(&server);
+   testsocket_spy_destroy();
+}
+
 static void send_header(testsocket_t *sock)
 {
    const char *greeting = "RMFP/1.0\nNumHeader-Format:32\n\n";
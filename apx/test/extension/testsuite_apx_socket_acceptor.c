@@ -0,0 +1,215 @@
+//////////////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////////////
+#include <string.h>
+#include "CuTest.h"
+#include "apx/extension/socket_acceptor.h"
+#if APX_SOCKET_ACCEPTOR_SUPPORTED
+#include <unistd.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#endif
+#ifdef MEM_LEAK_CHECK
+#include "CMemLeak.h"
+#endif
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE CONSTANTS AND DATA TYPES
+//////////////////////////////////////////////////////////////////////////////
+#define NUM_CLIENTS 32
+#define WAIT_TIMEOUT_MS 2000
+
+#if APX_SOCKET_ACCEPTOR_SUPPORTED
+typedef struct acceptSpy_tag
+{
+   apx_socketAcceptor_t* acceptor;
+   MUTEX_T lock;
+   int num_calls;
+   bool setup_on_accept_thread;
+} acceptSpy_t;
+#endif
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////////////
+#if APX_SOCKET_ACCEPTOR_SUPPORTED
+static void test_start_rejects_invalid_thread_count(CuTest* tc);
+static void test_listeners_share_ephemeral_port(CuTest* tc);
+static void test_accepted_sockets_are_given_to_handler(CuTest* tc);
+static void test_stop_closes_listeners(CuTest* tc);
+static void acceptSpy_create(acceptSpy_t* self, apx_socketAcceptor_t* acceptor);
+static void acceptSpy_destroy(acceptSpy_t* self);
+static void acceptSpy_handler(void* arg, int fd);
+static int acceptSpy_wait_for_calls(acceptSpy_t* self, int num_calls);
+static int connect_to_port(uint16_t port);
+#endif
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE VARIABLES
+//////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////
+// PUBLIC FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+CuSuite* testSuite_apx_socketAcceptor(void)
+{
+   CuSuite* suite = CuSuiteNew();
+#if APX_SOCKET_ACCEPTOR_SUPPORTED
+   SUITE_ADD_TEST(suite, test_start_rejects_invalid_thread_count);
+   SUITE_ADD_TEST(suite, test_listeners_share_ephemeral_port);
+   SUITE_ADD_TEST(suite, test_accepted_sockets_are_given_to_handler);
+   SUITE_ADD_TEST(suite, test_stop_closes_listeners);
+#endif
+   return suite;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+#if APX_SOCKET_ACCEPTOR_SUPPORTED
+static void test_start_rejects_invalid_thread_count(CuTest* tc)
+{
+   acceptSpy_t spy;
+   apx_socketAcceptor_t acceptor;
+   acceptSpy_create(&spy, &acceptor);
+   apx_socketAcceptor_create(&acceptor, acceptSpy_handler, &spy);
+   CuAssertIntEquals(tc, APX_INVALID_ARGUMENT_ERROR, apx_socketAcceptor_start(&acceptor, 0u, 0u));
+   CuAssertIntEquals(tc, APX_INVALID_ARGUMENT_ERROR, apx_socketAcceptor_start(&acceptor, 0u, APX_SOCKET_ACCEPTOR_MAX_THREADS + 1u));
+   apx_socketAcceptor_destroy(&acceptor);
+   acceptSpy_destroy(&spy);
+}
+
+static void test_listeners_share_ephemeral_port(CuTest* tc)
+{
+   acceptSpy_t spy;
+   apx_socketAcceptor_t acceptor;
+   uint32_t i;
+   acceptSpy_create(&spy, &acceptor);
+   apx_socketAcceptor_create(&acceptor, acceptSpy_handler, &spy);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_socketAcceptor_start(&acceptor, 0u, 4u));
+   CuAssertTrue(tc, apx_socketAcceptor_get_port(&acceptor) != 0u);
+   for (i = 0u; i < 4u; i++)
+   {
+      struct sockaddr_in addr;
+      socklen_t addr_len = (socklen_t)sizeof(addr);
+      CuAssertIntEquals(tc, 0, getsockname(acceptor.threads[i].listen_fd, (struct sockaddr*) &addr, &addr_len));
+      CuAssertUIntEquals(tc, apx_socketAcceptor_get_port(&acceptor), ntohs(addr.sin_port));
+   }
+   apx_socketAcceptor_destroy(&acceptor);
+   acceptSpy_destroy(&spy);
+}
+
+static void test_accepted_sockets_are_given_to_handler(CuTest* tc)
+{
+   acceptSpy_t spy;
+   apx_socketAcceptor_t acceptor;
+   int clients[NUM_CLIENTS];
+   int i;
+   acceptSpy_create(&spy, &acceptor);
+   apx_socketAcceptor_create(&acceptor, acceptSpy_handler, &spy);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_socketAcceptor_start(&acceptor, 0u, 4u));
+   for (i = 0; i < NUM_CLIENTS; i++)
+   {
+      clients[i] = connect_to_port(apx_socketAcceptor_get_port(&acceptor));
+      CuAssertTrue(tc, clients[i] >= 0);
+   }
+   CuAssertIntEquals(tc, NUM_CLIENTS, acceptSpy_wait_for_calls(&spy, NUM_CLIENTS));
+   CuAssertUIntEquals(tc, NUM_CLIENTS, apx_socketAcceptor_get_num_accepted(&acceptor));
+   CuAssertTrue(tc, !spy.setup_on_accept_thread);
+   for (i = 0; i < NUM_CLIENTS; i++)
+   {
+      char c;
+      //Handler closed its end of the connection
+      CuAssertIntEquals(tc, 0, (int) read(clients[i], &c, 1u));
+      close(clients[i]);
+   }
+   apx_socketAcceptor_destroy(&acceptor);
+   acceptSpy_destroy(&spy);
+}
+
+static void test_stop_closes_listeners(CuTest* tc)
+{
+   acceptSpy_t spy;
+   apx_socketAcceptor_t acceptor;
+   uint16_t port;
+   int fd;
+   acceptSpy_create(&spy, &acceptor);
+   apx_socketAcceptor_create(&acceptor, acceptSpy_handler, &spy);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_socketAcceptor_start(&acceptor, 0u, 2u));
+   port = apx_socketAcceptor_get_port(&acceptor);
+   apx_socketAcceptor_stop(&acceptor);
+   fd = connect_to_port(port);
+   CuAssertTrue(tc, fd < 0);
+   apx_socketAcceptor_destroy(&acceptor);
+   acceptSpy_destroy(&spy);
+}
+
+static void acceptSpy_create(acceptSpy_t* self, apx_socketAcceptor_t* acceptor)
+{
+   self->acceptor = acceptor;
+   MUTEX_INIT(self->lock);
+   self->num_calls = 0;
+   self->setup_on_accept_thread = false;
+}
+
+static void acceptSpy_destroy(acceptSpy_t* self)
+{
+   MUTEX_DESTROY(self->lock);
+}
+
+static void acceptSpy_handler(void* arg, int fd)
+{
+   acceptSpy_t* self = (acceptSpy_t*) arg;
+   uint32_t i;
+   MUTEX_LOCK(self->lock);
+   for (i = 0u; i < self->acceptor->num_threads; i++)
+   {
+      if (pthread_equal(pthread_self(), self->acceptor->threads[i].accept_thread) != 0)
+      {
+         self->setup_on_accept_thread = true;
+      }
+   }
+   self->num_calls++;
+   MUTEX_UNLOCK(self->lock);
+   close(fd);
+}
+
+static int acceptSpy_wait_for_calls(acceptSpy_t* self, int num_calls)
+{
+   int elapsed_ms;
+   int retval = 0;
+   for (elapsed_ms = 0; elapsed_ms < WAIT_TIMEOUT_MS; elapsed_ms++)
+   {
+      MUTEX_LOCK(self->lock);
+      retval = self->num_calls;
+      MUTEX_UNLOCK(self->lock);
+      if (retval >= num_calls)
+      {
+         break;
+      }
+      SLEEP(1);
+   }
+   return retval;
+}
+
+static int connect_to_port(uint16_t port)
+{
+   struct sockaddr_in addr;
+   int fd = socket(AF_INET, SOCK_STREAM, 0);
+   if (fd < 0)
+   {
+      return -1;
+   }
+   memset(&addr, 0, sizeof(addr));
+   addr.sin_family = AF_INET;
+   addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+   addr.sin_port = htons(port);
+   if (connect(fd, (struct sockaddr*) &addr, (socklen_t)sizeof(addr)) != 0)
+   {
+      close(fd);
+      return -1;
+   }
+   return fd;
+}
+#endif
@@ -0,0 +1,206 @@
+//////////////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////////////
+#include <string.h>
+#include "CuTest.h"
+#include "apx/extension/uring.h"
+#if APX_URING_SUPPORTED
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#endif
+#ifdef MEM_LEAK_CHECK
+#include "CMemLeak.h"
+#endif
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE CONSTANTS AND DATA TYPES
+//////////////////////////////////////////////////////////////////////////////
+#define RING_ENTRIES 16u
+#define MAX_COMPLETIONS 16u
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////////////
+static void test_probe(CuTest* tc);
+#if APX_URING_SUPPORTED
+static void test_multishot_recv_uses_provided_buffers(CuTest* tc);
+static void test_linked_sends_arrive_in_order(CuTest* tc);
+static void test_multishot_accept(CuTest* tc);
+static uint32_t wait_completions(apx_uring_t* ring, apx_uringCompletion_t* completions, uint32_t count);
+#endif
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE VARIABLES
+//////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////
+// PUBLIC FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+CuSuite* testSuite_apx_uring(void)
+{
+   CuSuite* suite = CuSuiteNew();
+   SUITE_ADD_TEST(suite, test_probe);
+#if APX_URING_SUPPORTED
+   SUITE_ADD_TEST(suite, test_multishot_recv_uses_provided_buffers);
+   SUITE_ADD_TEST(suite, test_linked_sends_arrive_in_order);
+   SUITE_ADD_TEST(suite, test_multishot_accept);
+#endif
+   return suite;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+static void test_probe(CuTest* tc)
+{
+   apx_error_t result = apx_uring_probe();
+#if APX_URING_SUPPORTED
+   //Depends on the running kernel, remaining tests are skipped when not supported
+   CuAssertTrue(tc, (result == APX_NO_ERROR) || (result == APX_NOT_IMPLEMENTED_ERROR));
+#else
+   CuAssertIntEquals(tc, APX_NOT_IMPLEMENTED_ERROR, result);
+#endif
+}
+
+#if APX_URING_SUPPORTED
+static void test_multishot_recv_uses_provided_buffers(CuTest* tc)
+{
+   apx_uring_t ring;
+   apx_uringCompletion_t completions[MAX_COMPLETIONS];
+   uint8_t sent[40];
+   uint8_t received[40];
+   uint32_t received_size = 0u;
+   uint32_t i;
+   int sv[2];
+   if (apx_uring_probe() != APX_NO_ERROR)
+   {
+      return;
+   }
+   for (i = 0u; i < sizeof(sent); i++)
+   {
+      sent[i] = (uint8_t) i;
+   }
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_uring_create(&ring, RING_ENTRIES));
+   CuAssertIntEquals(tc, APX_INVALID_ARGUMENT_ERROR, apx_uring_register_buffers(&ring, 0u, 3u, 16u));
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_uring_register_buffers(&ring, 0u, 4u, 16u));
+   CuAssertIntEquals(tc, 0, socketpair(AF_UNIX, SOCK_STREAM, 0, sv));
+   CuAssertTrue(tc, apx_uring_prep_multishot_recv(&ring, sv[0], 7u));
+   CuAssertIntEquals(tc, 1, apx_uring_submit(&ring));
+   CuAssertIntEquals(tc, (int) sizeof(sent), (int) write(sv[1], sent, sizeof(sent)));
+   while (received_size < sizeof(sent))
+   {
+      uint32_t num_completions = wait_completions(&ring, &completions[0], 1u);
+      for (i = 0u; i < num_completions; i++)
+      {
+         uint16_t buffer_id = 0u;
+         CuAssertTrue(tc, completions[i].user_data == 7u);
+         CuAssertTrue(tc, completions[i].res > 0);
+         CuAssertTrue(tc, completions[i].res <= 16);
+         CuAssertTrue(tc, apx_uringCompletion_has_more(&completions[i]));
+         CuAssertTrue(tc, apx_uringCompletion_get_buffer_id(&completions[i], &buffer_id));
+         CuAssertTrue(tc, received_size + (uint32_t) completions[i].res <= sizeof(received));
+         memcpy(&received[received_size], apx_uring_get_buffer(&ring, buffer_id), (size_t) completions[i].res);
+         received_size += (uint32_t) completions[i].res;
+         apx_uring_recycle_buffer(&ring, buffer_id);
+      }
+   }
+   CuAssertIntEquals(tc, 0, memcmp(sent, received, sizeof(sent)));
+   //Peer closing the socket ends the multishot request
+   close(sv[1]);
+   CuAssertUIntEquals(tc, 1u, wait_completions(&ring, &completions[0], 1u));
+   CuAssertIntEquals(tc, 0, completions[0].res);
+   CuAssertTrue(tc, !apx_uringCompletion_has_more(&completions[0]));
+   close(sv[0]);
+   apx_uring_destroy(&ring);
+}
+
+static void test_linked_sends_arrive_in_order(CuTest* tc)
+{
+   apx_uring_t ring;
+   apx_uringCompletion_t completions[MAX_COMPLETIONS];
+   char received[16];
+   int sv[2];
+   if (apx_uring_probe() != APX_NO_ERROR)
+   {
+      return;
+   }
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_uring_create(&ring, RING_ENTRIES));
+   CuAssertIntEquals(tc, 0, socketpair(AF_UNIX, SOCK_STREAM, 0, sv));
+   CuAssertTrue(tc, apx_uring_prep_send(&ring, sv[0], (uint8_t const*) "abc", 3u, 1u, true));
+   CuAssertTrue(tc, apx_uring_prep_send(&ring, sv[0], (uint8_t const*) "de", 2u, 2u, true));
+   CuAssertTrue(tc, apx_uring_prep_send(&ring, sv[0], (uint8_t const*) "fgh", 3u, 3u, false));
+   CuAssertUIntEquals(tc, RING_ENTRIES - 3u, apx_uring_sq_space_left(&ring));
+   CuAssertIntEquals(tc, 3, apx_uring_submit(&ring));
+   CuAssertUIntEquals(tc, 3u, wait_completions(&ring, &completions[0], 3u));
+   CuAssertTrue(tc, completions[0].user_data == 1u);
+   CuAssertIntEquals(tc, 3, completions[0].res);
+   CuAssertTrue(tc, completions[1].user_data == 2u);
+   CuAssertIntEquals(tc, 2, completions[1].res);
+   CuAssertTrue(tc, completions[2].user_data == 3u);
+   CuAssertIntEquals(tc, 3, completions[2].res);
+   memset(received, 0, sizeof(received));
+   CuAssertIntEquals(tc, 8, (int) read(sv[1], received, sizeof(received)));
+   CuAssertStrEquals(tc, "abcdefgh", received);
+   close(sv[0]);
+   close(sv[1]);
+   apx_uring_destroy(&ring);
+}
+
+static void test_multishot_accept(CuTest* tc)
+{
+   apx_uring_t ring;
+   apx_uringCompletion_t completions[MAX_COMPLETIONS];
+   struct sockaddr_in addr;
+   socklen_t addr_len = (socklen_t) sizeof(addr);
+   int listen_fd;
+   int client_fd[2];
+   int i;
+   if (apx_uring_probe() != APX_NO_ERROR)
+   {
+      return;
+   }
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_uring_create(&ring, RING_ENTRIES));
+   listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+   CuAssertTrue(tc, listen_fd >= 0);
+   memset(&addr, 0, sizeof(addr));
+   addr.sin_family = AF_INET;
+   addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+   addr.sin_port = 0u; //any free port
+   CuAssertIntEquals(tc, 0, bind(listen_fd, (struct sockaddr*) &addr, (socklen_t) sizeof(addr)));
+   CuAssertIntEquals(tc, 0, listen(listen_fd, 4));
+   CuAssertIntEquals(tc, 0, getsockname(listen_fd, (struct sockaddr*) &addr, &addr_len));
+   CuAssertTrue(tc, apx_uring_prep_multishot_accept(&ring, listen_fd, 5u));
+   CuAssertIntEquals(tc, 1, apx_uring_submit(&ring));
+   for (i = 0; i < 2; i++)
+   {
+      client_fd[i] = socket(AF_INET, SOCK_STREAM, 0);
+      CuAssertIntEquals(tc, 0, connect(client_fd[i], (struct sockaddr*) &addr, (socklen_t) sizeof(addr)));
+      CuAssertUIntEquals(tc, 1u, wait_completions(&ring, &completions[0], 1u));
+      CuAssertTrue(tc, completions[0].user_data == 5u);
+      CuAssertTrue(tc, completions[0].res >= 0);
+      CuAssertTrue(tc, apx_uringCompletion_has_more(&completions[0]));
+      close(completions[0].res);
+   }
+   close(client_fd[0]);
+   close(client_fd[1]);
+   close(listen_fd);
+   apx_uring_destroy(&ring);
+}
+
+static uint32_t wait_completions(apx_uring_t* ring, apx_uringCompletion_t* completions, uint32_t count)
+{
+   uint32_t num_completions = 0u;
+   while (num_completions < count)
+   {
+      if (apx_uring_submit_and_wait(ring, 1u) < 0)
+      {
+         break;
+      }
+      num_completions += apx_uring_peek_completions(ring, &completions[num_completions], count - num_completions);
+   }
+   return num_completions;
+}
+#endif
@@ -16,6 +16,7 @@ CuSuite* testSuite_file_info(void);
 
 /** APX Common **/
 CuSuite* testSuite_apx_allocator(void);
+CuSuite* testSuite_apx_eventLoop(void);
 CuSuite* testsuite_apx_attributesParser(void);
 CuSuite* testSuite_apx_computation(void);
 CuSuite* testSuite_apx_dataElement(void);
@@ -36,10 +37,13 @@ CuSuite* testSuite_apx_nodeManager_server_mode(void);
 CuSuite* testSuite_apx_file(void);
 CuSuite* testSuite_apx_fileMap(void);
 CuSuite* testSuite_apx_fileManagerReceiver(void);
+CuSuite* testSuite_apx_fileManagerWorker(void);
 CuSuite* testSuite_apx_util(void);
 CuSuite* testSuite_apx_portConnectorChangeEntry(void);
 CuSuite* testSuite_apx_portConnectorChangeTable(void);
 CuSuite* testSuite_apx_portSignatureMap(void);
+CuSuite* testSuite_apx_shmRing(void);
+CuSuite* testSuite_apx_shmTransport(void);
 
 //Client
 CuSuite* testSuite_apx_clientTestConnection(void);
@@ -49,10 +53,23 @@ CuSuite* testSuite_apx_client(void);
 //Server
 CuSuite* testSuite_apx_serverConnection(void);
 CuSuite* testSuite_apx_server(void);
+CuSuite* testSuite_apx_routingEngine(void);
+CuSuite* testSuite_apx_fanoutPool(void);
+CuSuite* testSuite_apx_timerWheel(void);
+CuSuite* testSuite_apx_latencyHistogram(void);
+CuSuite* testSuite_apx_queuedPortRing(void);
+CuSuite* testSuite_apx_streamBuffer(void);
+CuSuite* testSuite_apx_compression(void);
+CuSuite* testSuite_apx_capabilities(void);
+CuSuite* testSuite_apx_nodeCache(void);
+CuSuite* testSuite_apx_binaryDefinition(void);
 
 //Server extensions
 CuSuite* testsuite_apx_socketServerExtension(void);
 CuSuite* testSuite_apx_socketServerConnection(void);
+CuSuite* testSuite_apx_uring(void);
+CuSuite* testSuite_apx_socketAcceptor(void);
+CuSuite* testSuite_apx_bridge(void);
 
 void RunAllTests(void)
 {
@@ -62,6 +79,7 @@ void RunAllTests(void)
 // APX Common
 
    CuSuiteAddSuite(suite, testSuite_apx_allocator());
+   CuSuiteAddSuite(suite, testSuite_apx_eventLoop());
    CuSuiteAddSuite(suite, testsuite_apx_attributesParser());
    CuSuiteAddSuite(suite, testSuite_apx_dataElement());
    CuSuiteAddSuite(suite, testSuite_apx_signatureParser());
@@ -82,9 +100,12 @@ void RunAllTests(void)
    CuSuiteAddSuite(suite, testSuite_apx_file());
    CuSuiteAddSuite(suite, testSuite_apx_fileMap());
    CuSuiteAddSuite(suite, testSuite_apx_fileManagerReceiver());
+   CuSuiteAddSuite(suite, testSuite_apx_fileManagerWorker());
    CuSuiteAddSuite(suite, testSuite_apx_portConnectorChangeEntry());
    CuSuiteAddSuite(suite, testSuite_apx_portConnectorChangeTable());
    CuSuiteAddSuite(suite, testSuite_apx_portSignatureMap());
+   CuSuiteAddSuite(suite, testSuite_apx_shmRing());
+   CuSuiteAddSuite(suite, testSuite_apx_shmTransport());
 
    //Client
    CuSuiteAddSuite(suite, testSuite_apx_clientTestConnection());
@@ -94,10 +115,23 @@ void RunAllTests(void)
    //Server
    CuSuiteAddSuite(suite, testSuite_apx_serverConnection());
    CuSuiteAddSuite(suite, testSuite_apx_server());
+   CuSuiteAddSuite(suite, testSuite_apx_routingEngine());
+   CuSuiteAddSuite(suite, testSuite_apx_fanoutPool());
+   CuSuiteAddSuite(suite, testSuite_apx_timerWheel());
+   CuSuiteAddSuite(suite, testSuite_apx_latencyHistogram());
+   CuSuiteAddSuite(suite, testSuite_apx_queuedPortRing());
+   CuSuiteAddSuite(suite, testSuite_apx_streamBuffer());
+   CuSuiteAddSuite(suite, testSuite_apx_compression());
+   CuSuiteAddSuite(suite, testSuite_apx_capabilities());
+   CuSuiteAddSuite(suite, testSuite_apx_nodeCache());
+   CuSuiteAddSuite(suite, testSuite_apx_binaryDefinition());
 
    //Server extensions
    CuSuiteAddSuite(suite, testsuite_apx_socketServerExtension());
    CuSuiteAddSuite(suite, testSuite_apx_socketServerConnection());
+   CuSuiteAddSuite(suite, testSuite_apx_uring());
+   CuSuiteAddSuite(suite, testSuite_apx_socketAcceptor());
+   CuSuiteAddSuite(suite, testSuite_apx_bridge());
 
    // RemoteFile
    CuSuiteAddSuite(suite, testSuite_remotefile());
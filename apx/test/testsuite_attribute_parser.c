@@ -41,6 +41,8 @@ static void test_parse_type_attribute_rational_scaling_vehicle_speed(CuTest* tc)
 static void test_parse_combined_type_attributes(CuTest* tc);
 static void test_parse_port_attribute_queue_length(CuTest* tc);
 static void test_parse_port_attribute_parameter(CuTest* tc);
+static void test_parse_port_attribute_update_interval(CuTest* tc);
+static void test_parse_port_attribute_high_priority(CuTest* tc);
 
 //////////////////////////////////////////////////////////////////////////////
 // GLOBAL VARIABLES
@@ -79,6 +81,8 @@ CuSuite* testsuite_apx_attributesParser(void)
    SUITE_ADD_TEST(suite, test_parse_combined_type_attributes);
    SUITE_ADD_TEST(suite, test_parse_port_attribute_queue_length);
    SUITE_ADD_TEST(suite, test_parse_port_attribute_parameter);
+   SUITE_ADD_TEST(suite, test_parse_port_attribute_update_interval);
+   SUITE_ADD_TEST(suite, test_parse_port_attribute_high_priority);
 
    return suite;
 }
@@ -638,4 +642,53 @@ static void test_parse_port_attribute_parameter(CuTest* tc)
    apx_portAttributes_destroy(&attr);
    apx_attributeParser_destroy(&parser);
 
+}
+
+static void test_parse_port_attribute_update_interval(CuTest* tc)
+{
+
+   const char* attribute_string = "Q[10],I[100]";
+   const uint8_t* begin = (const uint8_t*)attribute_string;
+   const uint8_t* end = begin + strlen(attribute_string);
+   apx_attributeParser_t parser;
+   apx_portAttributes_t attr;
+   uint8_t const* result = NULL;
+
+   apx_attributeParser_create(&parser);
+   apx_portAttributes_create(&attr);
+   CuAssertUIntEquals(tc, 0u, attr.min_update_interval);
+
+   result = apx_attributeParser_parse_port_attributes(&parser, begin, end, &attr);
+   CuAssertConstPtrEquals(tc, end, result);
+   CuAssertUIntEquals(tc, 10u, attr.queue_length);
+   CuAssertUIntEquals(tc, 100u, attr.min_update_interval);
+
+   apx_portAttributes_destroy(&attr);
+   apx_attributeParser_destroy(&parser);
+
+}
+
+static void test_parse_port_attribute_high_priority(CuTest* tc)
+{
+
+   const char* attribute_string = "H,I[20]";
+   const uint8_t* begin = (const uint8_t*)attribute_string;
+   const uint8_t* end = begin + strlen(attribute_string);
+   apx_attributeParser_t parser;
+   apx_portAttributes_t attr;
+   uint8_t const* result = NULL;
+
+   apx_attributeParser_create(&parser);
+   apx_portAttributes_create(&attr);
+   CuAssertFalse(tc, attr.is_high_priority);
+
+   result = apx_attributeParser_parse_port_attributes(&parser, begin, end, &attr);
+   CuAssertConstPtrEquals(tc, end, result);
+   CuAssertTrue(tc, attr.is_high_priority);
+   CuAssertFalse(tc, attr.is_parameter);
+   CuAssertUIntEquals(tc, 20u, attr.min_update_interval);
+
+   apx_portAttributes_destroy(&attr);
+   apx_attributeParser_destroy(&parser);
+
 }
\ No newline at end of file
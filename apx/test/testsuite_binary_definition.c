@@ -0,0 +1,343 @@
+//////////////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////////////
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "CuTest.h"
+#include "apx/binary_definition.h"
+#include "apx/node_manager.h"
+#include "apx/node_data.h"
+#ifdef MEM_LEAK_CHECK
+#include "CMemLeak.h"
+#endif
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE CONSTANTS AND DATA TYPES
+//////////////////////////////////////////////////////////////////////////////
+#define BINARY_GROW_SIZE 256u
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////////////
+static void test_text_definition_is_not_binary(CuTest* tc);
+static void test_ports_with_same_data_signature_share_type(CuTest* tc);
+static void test_server_node_built_from_binary_matches_text(CuTest* tc);
+static void test_client_publishes_binary_definition_with_own_extension(CuTest* tc);
+static void test_server_builds_node_from_published_binary_definition(CuTest* tc);
+static void test_reader_rejects_invalid_data(CuTest* tc);
+static void test_server_rejects_programs_not_matching_signature(CuTest* tc);
+static void compile_definition(CuTest* tc, char const* apx_text, adt_bytearray_t* output);
+static void verify_same_port(CuTest* tc, apx_portInstance_t* expected, apx_portInstance_t* actual);
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE VARIABLES
+//////////////////////////////////////////////////////////////////////////////
+static const char* m_apx_text =
+   "APX/1.3\n"
+   "N\"TestNode\"\n"
+   "P\"VehicleSpeed\"S:=65535\n"
+   "P\"EngineSpeed\"S:=1000,H\n"
+   "P\"GearSelect\"C(0,7):=3\n"
+   "P\"Message\"C[100*]:={}\n"
+   "R\"FuelLevel\"C:=255,I[100]\n"
+   "R\"Odometer\"L:=0\n";
+
+//////////////////////////////////////////////////////////////////////////////
+// PUBLIC FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+CuSuite* testSuite_apx_binaryDefinition(void)
+{
+   CuSuite* suite = CuSuiteNew();
+
+   SUITE_ADD_TEST(suite, test_text_definition_is_not_binary);
+   SUITE_ADD_TEST(suite, test_ports_with_same_data_signature_share_type);
+   SUITE_ADD_TEST(suite, test_server_node_built_from_binary_matches_text);
+   SUITE_ADD_TEST(suite, test_client_publishes_binary_definition_with_own_extension);
+   SUITE_ADD_TEST(suite, test_server_builds_node_from_published_binary_definition);
+   SUITE_ADD_TEST(suite, test_reader_rejects_invalid_data);
+   SUITE_ADD_TEST(suite, test_server_rejects_programs_not_matching_signature);
+
+   return suite;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+static void test_text_definition_is_not_binary(CuTest* tc)
+{
+   adt_bytearray_t binary;
+   adt_bytearray_create(&binary, BINARY_GROW_SIZE);
+   compile_definition(tc, m_apx_text, &binary);
+
+   CuAssertFalse(tc, apx_binaryDefinition_is_binary((uint8_t const*)m_apx_text, (apx_size_t)strlen(m_apx_text)));
+   CuAssertFalse(tc, apx_binaryDefinition_is_binary((uint8_t const*)m_apx_text, 1u));
+   CuAssertTrue(tc, apx_binaryDefinition_is_binary(adt_bytearray_const_data(&binary), adt_bytearray_length(&binary)));
+   //First byte is enough to tell the formats apart
+   CuAssertTrue(tc, apx_binaryDefinition_is_binary(adt_bytearray_const_data(&binary), 1u));
+   CuAssertFalse(tc, apx_binaryDefinition_is_binary(NULL, 0u));
+
+   adt_bytearray_destroy(&binary);
+}
+
+static void test_ports_with_same_data_signature_share_type(CuTest* tc)
+{
+   adt_bytearray_t binary;
+   apx_binaryDefinitionReader_t reader;
+   apx_binaryDefinitionPort_t port;
+   adt_bytearray_create(&binary, BINARY_GROW_SIZE);
+   compile_definition(tc, m_apx_text, &binary);
+
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_binaryDefinitionReader_create(&reader, adt_bytearray_const_data(&binary), adt_bytearray_length(&binary)));
+   CuAssertStrEquals(tc, "TestNode", reader.node_name);
+   CuAssertUIntEquals(tc, 4u, reader.num_provide_ports);
+   CuAssertUIntEquals(tc, 2u, reader.num_require_ports);
+   CuAssertUIntEquals(tc, 5u, reader.num_types);
+   CuAssertUIntEquals(tc, 2u + 2u + 1u + (1u + 100u), reader.provide_port_init_data_size);
+   CuAssertUIntEquals(tc, 1u + 4u, reader.require_port_init_data_size);
+
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_binaryDefinitionReader_next_port(&reader, &port));
+   CuAssertStrEquals(tc, "VehicleSpeed", port.name);
+   CuAssertStrEquals(tc, "S", port.data_signature);
+   CuAssertFalse(tc, port.is_high_priority);
+   CuAssertUIntEquals(tc, 0u, port.unpack_program_size);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_binaryDefinitionReader_next_port(&reader, &port));
+   CuAssertStrEquals(tc, "EngineSpeed", port.name);
+   CuAssertPtrEquals(tc, (void*)reader.types[0], (void*)port.data_signature);
+   CuAssertTrue(tc, port.is_high_priority);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_binaryDefinitionReader_next_port(&reader, &port));
+   CuAssertStrEquals(tc, "C(0,7)", port.data_signature);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_binaryDefinitionReader_next_port(&reader, &port));
+   CuAssertStrEquals(tc, "C[100*]", port.data_signature);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_binaryDefinitionReader_next_port(&reader, &port));
+   CuAssertStrEquals(tc, "FuelLevel", port.name);
+   CuAssertStrEquals(tc, "C", port.data_signature);
+   CuAssertUIntEquals(tc, 100u, port.min_update_interval);
+   CuAssertTrue(tc, port.unpack_program_size > 0u);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_binaryDefinitionReader_next_port(&reader, &port));
+   CuAssertStrEquals(tc, "Odometer", port.name);
+   CuAssertIntEquals(tc, APX_INDEX_ERROR, apx_binaryDefinitionReader_next_port(&reader, &port));
+
+   apx_binaryDefinitionReader_destroy(&reader);
+   adt_bytearray_destroy(&binary);
+}
+
+static void test_server_node_built_from_binary_matches_text(CuTest* tc)
+{
+   adt_bytearray_t binary;
+   apx_nodeManager_t* text_manager = apx_nodeManager_new(APX_SERVER_MODE);
+   apx_nodeManager_t* binary_manager = apx_nodeManager_new(APX_SERVER_MODE);
+   apx_nodeInstance_t* expected;
+   apx_nodeInstance_t* actual;
+   apx_size_t port_id;
+   adt_bytearray_create(&binary, BINARY_GROW_SIZE);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_nodeManager_build_node(text_manager, m_apx_text));
+   expected = apx_nodeManager_get_last_attached(text_manager);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_binaryDefinition_write(expected, &binary));
+
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_nodeManager_build_node_from_binary(binary_manager, adt_bytearray_const_data(&binary), adt_bytearray_length(&binary)));
+   actual = apx_nodeManager_get_last_attached(binary_manager);
+   CuAssertPtrNotNull(tc, actual);
+   CuAssertStrEquals(tc, "TestNode", apx_nodeInstance_get_name(actual));
+   CuAssertUIntEquals(tc, apx_nodeInstance_get_num_provide_ports(expected), apx_nodeInstance_get_num_provide_ports(actual));
+   CuAssertUIntEquals(tc, apx_nodeInstance_get_num_require_ports(expected), apx_nodeInstance_get_num_require_ports(actual));
+   for (port_id = 0u; port_id < apx_nodeInstance_get_num_provide_ports(expected); port_id++)
+   {
+      verify_same_port(tc, apx_nodeInstance_get_provide_port(expected, port_id), apx_nodeInstance_get_provide_port(actual, port_id));
+   }
+   for (port_id = 0u; port_id < apx_nodeInstance_get_num_require_ports(expected); port_id++)
+   {
+      verify_same_port(tc, apx_nodeInstance_get_require_port(expected, port_id), apx_nodeInstance_get_require_port(actual, port_id));
+   }
+   CuAssertUIntEquals(tc, apx_nodeInstance_get_provide_port_init_data_size(expected), apx_nodeInstance_get_provide_port_init_data_size(actual));
+   CuAssertTrue(tc, memcmp(apx_nodeInstance_get_provide_port_init_data(expected), apx_nodeInstance_get_provide_port_init_data(actual),
+      apx_nodeInstance_get_provide_port_init_data_size(expected)) == 0);
+   CuAssertUIntEquals(tc, apx_nodeInstance_get_require_port_init_data_size(expected), apx_nodeInstance_get_require_port_init_data_size(actual));
+   CuAssertTrue(tc, memcmp(apx_nodeInstance_get_require_port_init_data(expected), apx_nodeInstance_get_require_port_init_data(actual),
+      apx_nodeInstance_get_require_port_init_data_size(expected)) == 0);
+   //Data elements are not part of the binary format
+   CuAssertUIntEquals(tc, 0u, apx_nodeInstance_get_num_data_elements(actual));
+
+   apx_nodeManager_delete(text_manager);
+   apx_nodeManager_delete(binary_manager);
+   adt_bytearray_destroy(&binary);
+}
+
+static void test_client_publishes_binary_definition_with_own_extension(CuTest* tc)
+{
+   adt_bytearray_t binary;
+   apx_nodeManager_t* manager = apx_nodeManager_new(APX_CLIENT_MODE);
+   apx_nodeInstance_t* node_instance;
+   adt_bytearray_create(&binary, BINARY_GROW_SIZE);
+   compile_definition(tc, m_apx_text, &binary);
+
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_nodeManager_build_node_from_binary(manager, adt_bytearray_const_data(&binary), adt_bytearray_length(&binary)));
+   node_instance = apx_nodeManager_get_last_attached(manager);
+   CuAssertPtrNotNull(tc, node_instance);
+   CuAssertStrEquals(tc, APX_BINARY_DEFINITION_FILE_EXT, apx_nodeInstance_get_definition_file_extension(node_instance));
+   CuAssertUIntEquals(tc, adt_bytearray_length(&binary), apx_nodeInstance_get_definition_size(node_instance));
+   CuAssertTrue(tc, memcmp(adt_bytearray_const_data(&binary), apx_nodeInstance_get_definition_data(node_instance), adt_bytearray_length(&binary)) == 0);
+   CuAssertUIntEquals(tc, 106u, apx_nodeData_provide_port_data_size(apx_nodeInstance_get_node_data(node_instance)));
+
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_nodeManager_build_node(manager, "APX/1.3\nN\"TextNode\"\nP\"Signal\"C:=0\n"));
+   CuAssertStrEquals(tc, APX_DEFINITION_FILE_EXT, apx_nodeInstance_get_definition_file_extension(apx_nodeManager_get_last_attached(manager)));
+
+   apx_nodeManager_delete(manager);
+   adt_bytearray_destroy(&binary);
+}
+
+static void test_server_builds_node_from_published_binary_definition(CuTest* tc)
+{
+   adt_bytearray_t binary;
+   apx_nodeManager_t* manager = apx_nodeManager_new(APX_SERVER_MODE);
+   apx_nodeInstance_t* node_instance;
+   apx_nodeData_t* node_data;
+   rmf_fileInfo_t* file_info;
+   bool file_open_request = false;
+   uint8_t const* data;
+   apx_size_t size;
+   apx_size_t const first_size = 10u;
+   bool has_dynamic_data = false;
+   adt_bytearray_create(&binary, BINARY_GROW_SIZE);
+   compile_definition(tc, m_apx_text, &binary);
+   data = adt_bytearray_const_data(&binary);
+   size = adt_bytearray_length(&binary);
+
+   file_info = rmf_fileInfo_make_fixed("TestNode" APX_BINARY_DEFINITION_FILE_EXT, (uint32_t)size, APX_DEFINITION_ADDRESS_START);
+   CuAssertPtrNotNull(tc, file_info);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_nodeManager_init_node_from_file_info(manager, file_info, &file_open_request));
+   CuAssertTrue(tc, file_open_request);
+   rmf_fileInfo_delete(file_info);
+   node_instance = apx_nodeManager_get_last_attached(manager);
+   CuAssertPtrNotNull(tc, node_instance);
+   node_data = apx_nodeInstance_get_node_data(node_instance);
+
+   //Binary definitions arriving in fragments are not given to the text parser
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_nodeData_write_definition_data(node_data, 0u, data, first_size));
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_nodeManager_on_definition_data_written(manager, node_instance, 0u, first_size));
+   CuAssertPtrEquals(tc, NULL, manager->streaming_node_instance);
+   CuAssertUIntEquals(tc, 0u, apx_nodeData_num_provide_ports(node_data));
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_nodeData_write_definition_data(node_data, first_size, &data[first_size], size - first_size));
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_nodeManager_on_definition_data_written(manager, node_instance, (uint32_t)first_size, size - first_size));
+
+   CuAssertUIntEquals(tc, 4u, apx_nodeData_num_provide_ports(node_data));
+   CuAssertUIntEquals(tc, 2u, apx_nodeData_num_require_ports(node_data));
+   CuAssertStrEquals(tc, "\"GearSelect\"C(0,7)", apx_portInstance_get_port_signature(apx_nodeInstance_get_provide_port(node_instance, 2), &has_dynamic_data));
+   CuAssertFalse(tc, has_dynamic_data);
+   CuAssertStrEquals(tc, "\"Message\"C[*]", apx_portInstance_get_port_signature(apx_nodeInstance_get_provide_port(node_instance, 3), &has_dynamic_data));
+   CuAssertTrue(tc, has_dynamic_data);
+
+   apx_nodeManager_delete(manager);
+   adt_bytearray_destroy(&binary);
+}
+
+static void test_reader_rejects_invalid_data(CuTest* tc)
+{
+   adt_bytearray_t binary;
+   apx_binaryDefinitionReader_t reader;
+   apx_binaryDefinitionPort_t port;
+   uint8_t* copy;
+   apx_size_t size;
+   int i;
+   adt_bytearray_create(&binary, BINARY_GROW_SIZE);
+   compile_definition(tc, m_apx_text, &binary);
+   size = adt_bytearray_length(&binary);
+   copy = (uint8_t*)malloc(size + 1u);
+   CuAssertPtrNotNull(tc, copy);
+
+   memcpy(copy, adt_bytearray_const_data(&binary), size);
+   copy[0] = 'A';
+   CuAssertIntEquals(tc, APX_INVALID_HEADER_ERROR, apx_binaryDefinitionReader_create(&reader, copy, size));
+   memcpy(copy, adt_bytearray_const_data(&binary), size);
+   copy[APX_BINARY_DEFINITION_MAGIC_SIZE] = APX_BINARY_DEFINITION_MAJOR_VERSION + 1u;
+   CuAssertIntEquals(tc, APX_VERSION_ERROR, apx_binaryDefinitionReader_create(&reader, copy, size));
+   memcpy(copy, adt_bytearray_const_data(&binary), size);
+   CuAssertIntEquals(tc, APX_UNEXPECTED_END_ERROR, apx_binaryDefinitionReader_create(&reader, copy, APX_BINARY_DEFINITION_HEADER_SIZE - 1u));
+   CuAssertIntEquals(tc, APX_UNEXPECTED_END_ERROR, apx_binaryDefinitionReader_create(&reader, copy, APX_BINARY_DEFINITION_HEADER_SIZE + 4u));
+
+   //Truncated port table
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_binaryDefinitionReader_create(&reader, copy, size - 1u));
+   for (i = 0; i < 5; i++)
+   {
+      CuAssertIntEquals(tc, APX_NO_ERROR, apx_binaryDefinitionReader_next_port(&reader, &port));
+   }
+   CuAssertIntEquals(tc, APX_UNEXPECTED_END_ERROR, apx_binaryDefinitionReader_next_port(&reader, &port));
+   apx_binaryDefinitionReader_destroy(&reader);
+
+   //Trailing data
+   copy[size] = 0u;
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_binaryDefinitionReader_create(&reader, copy, size + 1u));
+   for (i = 0; i < 5; i++)
+   {
+      CuAssertIntEquals(tc, APX_NO_ERROR, apx_binaryDefinitionReader_next_port(&reader, &port));
+   }
+   CuAssertIntEquals(tc, APX_STRAY_CHARACTERS_AFTER_PARSE_ERROR, apx_binaryDefinitionReader_next_port(&reader, &port));
+   apx_binaryDefinitionReader_destroy(&reader);
+
+   free(copy);
+   adt_bytearray_destroy(&binary);
+}
+
+static void test_server_rejects_programs_not_matching_signature(CuTest* tc)
+{
+   adt_bytearray_t binary;
+   apx_binaryDefinitionReader_t reader;
+   apx_nodeManager_t* manager = apx_nodeManager_new(APX_SERVER_MODE);
+   uint8_t* copy;
+   apx_size_t size;
+   apx_size_t type_offset;
+   CuAssertPtrNotNull(tc, manager);
+   adt_bytearray_create(&binary, BINARY_GROW_SIZE);
+   compile_definition(tc, m_apx_text, &binary);
+   size = adt_bytearray_length(&binary);
+   copy = (uint8_t*)malloc(size);
+   CuAssertPtrNotNull(tc, copy);
+   memcpy(copy, adt_bytearray_const_data(&binary), size);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_binaryDefinitionReader_create(&reader, copy, size));
+   CuAssertStrEquals(tc, "S", reader.types[0]);
+   type_offset = (apx_size_t)((uint8_t const*)reader.types[0] - copy);
+   apx_binaryDefinitionReader_destroy(&reader);
+
+   //VehicleSpeed and EngineSpeed now claim to be 32-bit while their programs still pack 16 bits
+   copy[type_offset] = 'L';
+   CuAssertIntEquals(tc, APX_INVALID_PROGRAM_ERROR, apx_nodeManager_build_node_from_binary(manager, copy, size));
+   CuAssertPtrEquals(tc, NULL, apx_nodeManager_find(manager, "TestNode"));
+   //Not a valid data signature
+   copy[type_offset] = '?';
+   CuAssertIntEquals(tc, APX_DATA_SIGNATURE_ERROR, apx_nodeManager_build_node_from_binary(manager, copy, size));
+
+   free(copy);
+   apx_nodeManager_delete(manager);
+   adt_bytearray_destroy(&binary);
+}
+
+static void compile_definition(CuTest* tc, char const* apx_text, adt_bytearray_t* output)
+{
+   apx_nodeManager_t* manager = apx_nodeManager_new(APX_SERVER_MODE);
+   CuAssertPtrNotNull(tc, manager);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_nodeManager_build_node(manager, apx_text));
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_binaryDefinition_write(apx_nodeManager_get_last_attached(manager), output));
+   apx_nodeManager_delete(manager);
+}
+
+static void verify_same_port(CuTest* tc, apx_portInstance_t* expected, apx_portInstance_t* actual)
+{
+   bool expected_dynamic_data = false;
+   bool actual_dynamic_data = false;
+   CuAssertPtrNotNull(tc, actual);
+   CuAssertStrEquals(tc, apx_portInstance_name(expected), apx_portInstance_name(actual));
+   CuAssertUIntEquals(tc, apx_portInstance_data_offset(expected), apx_portInstance_data_offset(actual));
+   CuAssertUIntEquals(tc, apx_portInstance_data_size(expected), apx_portInstance_data_size(actual));
+   CuAssertUIntEquals(tc, apx_portInstance_min_update_interval(expected), apx_portInstance_min_update_interval(actual));
+   CuAssertTrue(tc, apx_portInstance_is_high_priority(expected) == apx_portInstance_is_high_priority(actual));
+   CuAssertStrEquals(tc, apx_portInstance_get_port_signature(expected, &expected_dynamic_data), apx_portInstance_get_port_signature(actual, &actual_dynamic_data));
+   CuAssertTrue(tc, expected_dynamic_data == actual_dynamic_data);
+   CuAssertTrue(tc, adt_bytearray_equals(apx_portInstance_pack_program(expected), apx_portInstance_pack_program(actual)));
+   if (apx_portInstance_unpack_program(expected) != NULL)
+   {
+      CuAssertTrue(tc, adt_bytearray_equals(apx_portInstance_unpack_program(expected), apx_portInstance_unpack_program(actual)));
+   }
+}
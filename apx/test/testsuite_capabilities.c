@@ -0,0 +1,167 @@
+//////////////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////////////
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "CuTest.h"
+#include "apx/capabilities.h"
+#ifdef MEM_LEAK_CHECK
+#include "CMemLeak.h"
+#endif
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE CONSTANTS AND DATA TYPES
+//////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////////////
+static void test_write_header(CuTest* tc);
+static void test_write_header_without_flags(CuTest* tc);
+static void test_write_header_fails_when_buffer_is_too_small(CuTest* tc);
+static void test_parse_header_lines(CuTest* tc);
+static void test_parse_ignores_unknown_feature_names(CuTest* tc);
+static void test_parse_rejects_invalid_numbers(CuTest* tc);
+static void test_agree_with_peer(CuTest* tc);
+static void test_agree_with_legacy_peer(CuTest* tc);
+static bool parse_line(apx_capabilities_t* self, char const* line);
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE VARIABLES
+//////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////
+// PUBLIC FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+CuSuite* testSuite_apx_capabilities(void)
+{
+   CuSuite* suite = CuSuiteNew();
+
+   SUITE_ADD_TEST(suite, test_write_header);
+   SUITE_ADD_TEST(suite, test_write_header_without_flags);
+   SUITE_ADD_TEST(suite, test_write_header_fails_when_buffer_is_too_small);
+   SUITE_ADD_TEST(suite, test_parse_header_lines);
+   SUITE_ADD_TEST(suite, test_parse_ignores_unknown_feature_names);
+   SUITE_ADD_TEST(suite, test_parse_rejects_invalid_numbers);
+   SUITE_ADD_TEST(suite, test_agree_with_peer);
+   SUITE_ADD_TEST(suite, test_agree_with_legacy_peer);
+
+   return suite;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+static void test_write_header(CuTest* tc)
+{
+   apx_capabilities_t capabilities;
+   char buf[128];
+   char const* expected = "Capabilities:lz4,dynamic-file,stream-file,partial-write\nMax-Message-Size:65536\nReceive-Buffer-Size:262144\n";
+   apx_capabilities_create(&capabilities, APX_CAPABILITY_COMPRESSION | APX_CAPABILITY_DEFAULT_FLAGS, 65536u, 262144u);
+   CuAssertIntEquals(tc, (int)strlen(expected), apx_capabilities_write_header(&capabilities, buf, (int32_t)sizeof(buf)));
+   CuAssertStrEquals(tc, expected, buf);
+}
+
+static void test_write_header_without_flags(CuTest* tc)
+{
+   apx_capabilities_t capabilities;
+   char buf[128];
+   char const* expected = "Capabilities:\n";
+   apx_capabilities_create(&capabilities, 0u, 0u, 0u);
+   CuAssertIntEquals(tc, (int)strlen(expected), apx_capabilities_write_header(&capabilities, buf, (int32_t)sizeof(buf)));
+   CuAssertStrEquals(tc, expected, buf);
+}
+
+static void test_write_header_fails_when_buffer_is_too_small(CuTest* tc)
+{
+   apx_capabilities_t capabilities;
+   char buf[32];
+   apx_capabilities_create(&capabilities, APX_CAPABILITY_DEFAULT_FLAGS, 65536u, 0u);
+   CuAssertIntEquals(tc, 0, apx_capabilities_write_header(&capabilities, buf, (int32_t)sizeof(buf)));
+   //Room is also needed for the null-terminator
+   apx_capabilities_create(&capabilities, 0u, 0u, 0u);
+   CuAssertIntEquals(tc, 0, apx_capabilities_write_header(&capabilities, buf, 14));
+   CuAssertIntEquals(tc, 14, apx_capabilities_write_header(&capabilities, buf, 15));
+}
+
+static void test_parse_header_lines(CuTest* tc)
+{
+   apx_capabilities_t capabilities;
+   apx_capabilities_create(&capabilities, 0u, 0u, 0u);
+   CuAssertFalse(tc, parse_line(&capabilities, "NumHeader-Format:32"));
+   CuAssertFalse(tc, capabilities.is_announced);
+   CuAssertTrue(tc, parse_line(&capabilities, "Capabilities:stream-file,lz4,pipelined-open"));
+   CuAssertTrue(tc, capabilities.is_announced);
+   CuAssertUIntEquals(tc, APX_CAPABILITY_COMPRESSION | APX_CAPABILITY_STREAM_FILE | APX_CAPABILITY_PIPELINED_OPEN, capabilities.flags);
+   CuAssertTrue(tc, parse_line(&capabilities, "Max-Message-Size:4096"));
+   CuAssertUIntEquals(tc, 4096u, capabilities.max_message_size);
+   CuAssertTrue(tc, parse_line(&capabilities, "Receive-Buffer-Size:4294967295"));
+   CuAssertUIntEquals(tc, 4294967295u, capabilities.receive_buffer_size);
+}
+
+static void test_parse_ignores_unknown_feature_names(CuTest* tc)
+{
+   apx_capabilities_t capabilities;
+   apx_capabilities_create(&capabilities, 0u, 0u, 0u);
+   CuAssertTrue(tc, parse_line(&capabilities, "Capabilities:future-feature,dynamic-file,,lz4x"));
+   CuAssertTrue(tc, capabilities.is_announced);
+   CuAssertUIntEquals(tc, APX_CAPABILITY_DYNAMIC_FILE, capabilities.flags);
+}
+
+static void test_parse_rejects_invalid_numbers(CuTest* tc)
+{
+   apx_capabilities_t capabilities;
+   apx_capabilities_create(&capabilities, 0u, 1000u, 0u);
+   CuAssertTrue(tc, parse_line(&capabilities, "Max-Message-Size:4294967296"));
+   CuAssertTrue(tc, parse_line(&capabilities, "Max-Message-Size:"));
+   CuAssertTrue(tc, parse_line(&capabilities, "Max-Message-Size:-1"));
+   CuAssertTrue(tc, parse_line(&capabilities, "Max-Message-Size:12a"));
+   CuAssertUIntEquals(tc, 1000u, capabilities.max_message_size);
+   CuAssertFalse(tc, capabilities.is_announced);
+}
+
+static void test_agree_with_peer(CuTest* tc)
+{
+   apx_capabilities_t local;
+   apx_capabilities_t peer;
+   apx_capabilities_t agreed;
+   apx_capabilities_create(&local, APX_CAPABILITY_COMPRESSION | APX_CAPABILITY_STREAM_FILE, 0u, 8192u);
+   apx_capabilities_create(&peer, 0u, 0u, 0u);
+   CuAssertTrue(tc, parse_line(&peer, "Capabilities:lz4,dynamic-file"));
+   CuAssertTrue(tc, parse_line(&peer, "Max-Message-Size:2048"));
+   CuAssertTrue(tc, parse_line(&peer, "Receive-Buffer-Size:4096"));
+   apx_capabilities_agree(&agreed, &local, &peer);
+   CuAssertTrue(tc, agreed.is_announced);
+   CuAssertUIntEquals(tc, APX_CAPABILITY_COMPRESSION, agreed.flags);
+   CuAssertTrue(tc, apx_capabilities_has(&agreed, APX_CAPABILITY_COMPRESSION));
+   CuAssertFalse(tc, apx_capabilities_has(&agreed, APX_CAPABILITY_COMPRESSION | APX_CAPABILITY_STREAM_FILE));
+   CuAssertUIntEquals(tc, 2048u, agreed.max_message_size);
+   CuAssertUIntEquals(tc, 4096u, agreed.receive_buffer_size);
+
+   local.max_message_size = 1024u;
+   apx_capabilities_agree(&agreed, &local, &peer);
+   CuAssertUIntEquals(tc, 1024u, agreed.max_message_size);
+}
+
+static void test_agree_with_legacy_peer(CuTest* tc)
+{
+   apx_capabilities_t local;
+   apx_capabilities_t peer;
+   apx_capabilities_t agreed;
+   apx_capabilities_create(&local, APX_CAPABILITY_COMPRESSION | APX_CAPABILITY_DEFAULT_FLAGS, 4096u, 8192u);
+   apx_capabilities_create(&peer, APX_CAPABILITY_DEFAULT_FLAGS, 0u, 0u);
+   apx_capabilities_agree(&agreed, &local, &peer);
+   CuAssertFalse(tc, agreed.is_announced);
+   CuAssertUIntEquals(tc, 0u, agreed.flags);
+   CuAssertUIntEquals(tc, 0u, agreed.max_message_size);
+   CuAssertUIntEquals(tc, 0u, agreed.receive_buffer_size);
+}
+
+static bool parse_line(apx_capabilities_t* self, char const* line)
+{
+   return apx_capabilities_parse_header_line(self, line, line + strlen(line));
+}
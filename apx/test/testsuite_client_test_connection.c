@@ -28,6 +28,7 @@ static void test_definition_file_is_sent_when_file_open_is_requested(CuTest* tc)
 static void test_provide_port_file_is_sent_when_file_open_requested(CuTest* tc);
 static void test_require_port_file_is_requested_when_published_by_server(CuTest* tc);
 static void test_node_data_is_updated_when_require_port_is_written(CuTest* tc);
+static void test_node_data_is_sent_after_publish_when_pipelined_open_is_agreed(CuTest* tc);
 
 
 //////////////////////////////////////////////////////////////////////////////
@@ -50,6 +51,7 @@ CuSuite* testSuite_apx_clientTestConnection(void)
    SUITE_ADD_TEST(suite, test_provide_port_file_is_sent_when_file_open_requested);
    SUITE_ADD_TEST(suite, test_require_port_file_is_requested_when_published_by_server);
    SUITE_ADD_TEST(suite, test_node_data_is_updated_when_require_port_is_written);
+   SUITE_ADD_TEST(suite, test_node_data_is_sent_after_publish_when_pipelined_open_is_agreed);
 
    return suite;
 }
@@ -313,4 +315,52 @@ static void test_node_data_is_updated_when_require_port_is_written(CuTest* tc)
    CuAssertUIntEquals(tc, data[1], buffer[1]);
 
    apx_clientTestConnection_delete(connection);
-}
\ No newline at end of file
+}
+
+static void test_node_data_is_sent_after_publish_when_pipelined_open_is_agreed(CuTest* tc)
+{
+   apx_clientTestConnection_t* connection;
+   apx_capabilities_t capabilities;
+   uint8_t buffer[256];
+   int32_t i;
+   int32_t buffer_size = 0;
+   int32_t offset;
+   bool more_bit = false;
+   uint32_t address = RMF_INVALID_ADDRESS;
+   char const* apx_text =
+      "APX/1.2\n"
+      "N\"TestNode1\"\n"
+      "P\"ProvidePort1\"C(0,3):=3\n"
+      "P\"ProvidePort2\"C(0,7):=7\n";
+   int32_t const definition_size = (int32_t)strlen(apx_text);
+
+   connection = apx_clientTestConnection_new();
+   CuAssertPtrNotNull(tc, connection);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_clientTestConnection_build_node(connection, apx_text));
+   apx_capabilities_create(&capabilities, APX_CAPABILITY_DEFAULT_FLAGS | APX_CAPABILITY_PIPELINED_OPEN, 0u, 0u);
+   apx_fileManager_set_capabilities(apx_clientTestConnection_get_file_manager(connection), &capabilities, &capabilities);
+   apx_clientTestConnection_greeting_header_accepted_notification(connection);
+   apx_clientTestConnection_run(connection);
+   for (i = 0; i < apx_clientTestConnection_log_length(connection); i++)
+   {
+      adt_bytearray_t* packet = apx_clientTestConnection_get_log_packet(connection, i);
+      CuAssertPtrNotNull(tc, packet);
+      CuAssertTrue(tc, buffer_size + adt_bytearray_length(packet) <= (int32_t)sizeof(buffer));
+      memcpy(&buffer[buffer_size], adt_bytearray_const_data(packet), (size_t)adt_bytearray_length(packet));
+      buffer_size += adt_bytearray_length(packet);
+   }
+   //Two published files followed by definition data and provide port data, without waiting for open requests
+   CuAssertIntEquals(tc, 67 * 2 + NUMHEADER32_SHORT_SIZE + RMF_HIGH_ADDR_SIZE + definition_size + NUMHEADER32_SHORT_SIZE + RMF_LOW_ADDR_SIZE + UINT8_SIZE * 2, buffer_size);
+   offset = 67 * 2;
+   CuAssertUIntEquals(tc, RMF_HIGH_ADDR_SIZE + definition_size, buffer[offset]);
+   CuAssertUIntEquals(tc, RMF_HIGH_ADDR_SIZE, rmf_address_decode(&buffer[offset + 1], &buffer[offset + 1] + RMF_HIGH_ADDR_SIZE, &address, &more_bit));
+   CuAssertUIntEquals(tc, APX_DEFINITION_ADDRESS_START, address);
+   CuAssertIntEquals(tc, 0, memcmp(apx_text, &buffer[offset + 1 + RMF_HIGH_ADDR_SIZE], (size_t)definition_size));
+   offset += NUMHEADER32_SHORT_SIZE + RMF_HIGH_ADDR_SIZE + definition_size;
+   CuAssertUIntEquals(tc, RMF_LOW_ADDR_SIZE + UINT8_SIZE * 2, buffer[offset]);
+   CuAssertUIntEquals(tc, RMF_LOW_ADDR_SIZE, rmf_address_decode(&buffer[offset + 1], &buffer[offset + 1] + RMF_LOW_ADDR_SIZE, &address, &more_bit));
+   CuAssertUIntEquals(tc, APX_PORT_DATA_ADDRESS_START, address);
+   CuAssertUIntEquals(tc, 3u, buffer[offset + 1 + RMF_LOW_ADDR_SIZE]);
+   CuAssertUIntEquals(tc, 7u, buffer[offset + 2 + RMF_LOW_ADDR_SIZE]);
+   apx_clientTestConnection_delete(connection);
+}
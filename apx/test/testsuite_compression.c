@@ -0,0 +1,192 @@
+//////////////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////////////
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "CuTest.h"
+#include "apx/compression.h"
+#ifdef MEM_LEAK_CHECK
+#include "CMemLeak.h"
+#endif
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE CONSTANTS AND DATA TYPES
+//////////////////////////////////////////////////////////////////////////////
+#define DATA_SIZE 4096u
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////////////
+static void test_repetitive_data_round_trip(CuTest* tc);
+static void test_short_data_round_trip(CuTest* tc);
+static void test_incompressible_data_is_rejected(CuTest* tc);
+static void test_compress_fails_when_destination_is_too_small(CuTest* tc);
+static void test_decompress_rejects_corrupt_data(CuTest* tc);
+static void test_stats_are_accumulated(CuTest* tc);
+static void fill_pseudo_random(uint8_t* data, apx_size_t size);
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE VARIABLES
+//////////////////////////////////////////////////////////////////////////////
+static const char* m_definition_line = "R\"SensorValue\"S:=65535\n";
+
+//////////////////////////////////////////////////////////////////////////////
+// PUBLIC FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+CuSuite* testSuite_apx_compression(void)
+{
+   CuSuite* suite = CuSuiteNew();
+
+   SUITE_ADD_TEST(suite, test_repetitive_data_round_trip);
+   SUITE_ADD_TEST(suite, test_short_data_round_trip);
+   SUITE_ADD_TEST(suite, test_incompressible_data_is_rejected);
+   SUITE_ADD_TEST(suite, test_compress_fails_when_destination_is_too_small);
+   SUITE_ADD_TEST(suite, test_decompress_rejects_corrupt_data);
+   SUITE_ADD_TEST(suite, test_stats_are_accumulated);
+
+   return suite;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+static void test_repetitive_data_round_trip(CuTest* tc)
+{
+   uint8_t* data = (uint8_t*)malloc(DATA_SIZE);
+   uint8_t* compressed = (uint8_t*)malloc(DATA_SIZE);
+   uint8_t* decompressed = (uint8_t*)malloc(DATA_SIZE);
+   apx_size_t const line_len = (apx_size_t)strlen(m_definition_line);
+   apx_size_t compressed_size;
+   apx_size_t i;
+   CuAssertPtrNotNull(tc, data);
+   CuAssertPtrNotNull(tc, compressed);
+   CuAssertPtrNotNull(tc, decompressed);
+   for (i = 0u; i < DATA_SIZE; i++)
+   {
+      data[i] = (uint8_t)m_definition_line[i % line_len];
+   }
+
+   compressed_size = apx_compression_compress(compressed, DATA_SIZE - 1u, data, DATA_SIZE, NULL);
+   CuAssertTrue(tc, compressed_size > 0u);
+   CuAssertTrue(tc, compressed_size < DATA_SIZE / 10u);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_compression_decompress(decompressed, DATA_SIZE, compressed, compressed_size, NULL));
+   CuAssertTrue(tc, memcmp(data, decompressed, DATA_SIZE) == 0);
+
+   free(data);
+   free(compressed);
+   free(decompressed);
+}
+
+static void test_short_data_round_trip(CuTest* tc)
+{
+   uint8_t const data[5] = { 'A', 'B', 'A', 'B', 'A' };
+   uint8_t compressed[16];
+   uint8_t decompressed[5];
+   apx_size_t compressed_size;
+
+   //Blocks shorter than the match limit are stored as literals
+   compressed_size = apx_compression_compress(compressed, (apx_size_t)sizeof(compressed), data, (apx_size_t)sizeof(data), NULL);
+   CuAssertUIntEquals(tc, 1u + sizeof(data), compressed_size);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_compression_decompress(decompressed, (apx_size_t)sizeof(decompressed), compressed, compressed_size, NULL));
+   CuAssertTrue(tc, memcmp(data, decompressed, sizeof(data)) == 0);
+}
+
+static void test_incompressible_data_is_rejected(CuTest* tc)
+{
+   uint8_t* data = (uint8_t*)malloc(DATA_SIZE);
+   uint8_t* compressed = (uint8_t*)malloc(DATA_SIZE + 64u);
+   uint8_t* decompressed = (uint8_t*)malloc(DATA_SIZE);
+   apx_size_t compressed_size;
+   CuAssertPtrNotNull(tc, data);
+   CuAssertPtrNotNull(tc, compressed);
+   CuAssertPtrNotNull(tc, decompressed);
+   fill_pseudo_random(data, DATA_SIZE);
+
+   CuAssertUIntEquals(tc, 0u, apx_compression_compress(compressed, DATA_SIZE - 1u, data, DATA_SIZE, NULL));
+   //Given enough room the output is still a valid block
+   compressed_size = apx_compression_compress(compressed, DATA_SIZE + 64u, data, DATA_SIZE, NULL);
+   CuAssertTrue(tc, compressed_size >= DATA_SIZE);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_compression_decompress(decompressed, DATA_SIZE, compressed, compressed_size, NULL));
+   CuAssertTrue(tc, memcmp(data, decompressed, DATA_SIZE) == 0);
+
+   free(data);
+   free(compressed);
+   free(decompressed);
+}
+
+static void test_compress_fails_when_destination_is_too_small(CuTest* tc)
+{
+   uint8_t data[256];
+   uint8_t compressed[4];
+   memset(data, 0x55, sizeof(data));
+   CuAssertUIntEquals(tc, 0u, apx_compression_compress(compressed, (apx_size_t)sizeof(compressed), data, (apx_size_t)sizeof(data), NULL));
+}
+
+static void test_decompress_rejects_corrupt_data(CuTest* tc)
+{
+   uint8_t data[256];
+   uint8_t compressed[64];
+   uint8_t decompressed[256];
+   apx_size_t compressed_size;
+   memset(data, 0x55, sizeof(data));
+   compressed_size = apx_compression_compress(compressed, (apx_size_t)sizeof(compressed), data, (apx_size_t)sizeof(data), NULL);
+   CuAssertTrue(tc, compressed_size > 0u);
+
+   //Wrong uncompressed size
+   CuAssertIntEquals(tc, APX_COMPRESSION_ERROR, apx_compression_decompress(decompressed, 255u, compressed, compressed_size, NULL));
+   //Truncated block
+   CuAssertIntEquals(tc, APX_COMPRESSION_ERROR, apx_compression_decompress(decompressed, (apx_size_t)sizeof(decompressed), compressed, compressed_size - 1u, NULL));
+   //Match offset pointing before start of output
+   compressed[2] = 0xFFu;
+   compressed[3] = 0x00u;
+   CuAssertIntEquals(tc, APX_COMPRESSION_ERROR, apx_compression_decompress(decompressed, (apx_size_t)sizeof(decompressed), compressed, compressed_size, NULL));
+}
+
+static void test_stats_are_accumulated(CuTest* tc)
+{
+   uint8_t repetitive[512];
+   uint8_t random_data[512];
+   uint8_t compressed[512];
+   uint8_t decompressed[512];
+   apx_compressionStats_t stats;
+   apx_compressionStats_t total;
+   apx_size_t compressed_size;
+   apx_compressionStats_create(&stats);
+   apx_compressionStats_create(&total);
+   memset(repetitive, 0xAA, sizeof(repetitive));
+   fill_pseudo_random(random_data, (apx_size_t)sizeof(random_data));
+
+   compressed_size = apx_compression_compress(compressed, (apx_size_t)sizeof(compressed) - 1u, repetitive, (apx_size_t)sizeof(repetitive), &stats);
+   CuAssertTrue(tc, compressed_size > 0u);
+   CuAssertUIntEquals(tc, 0u, apx_compression_compress(compressed, (apx_size_t)sizeof(compressed) - 1u, random_data, (apx_size_t)sizeof(random_data), &stats));
+   CuAssertUIntEquals(tc, 1u, (uint32_t)stats.num_compressed);
+   CuAssertUIntEquals(tc, 1u, (uint32_t)stats.num_incompressible);
+   CuAssertUIntEquals(tc, 1024u, (uint32_t)stats.bytes_before_compression);
+   CuAssertUIntEquals(tc, 512u + compressed_size, (uint32_t)stats.bytes_after_compression);
+
+   compressed_size = apx_compression_compress(compressed, (apx_size_t)sizeof(compressed), repetitive, (apx_size_t)sizeof(repetitive), NULL);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_compression_decompress(decompressed, (apx_size_t)sizeof(decompressed), compressed, compressed_size, &stats));
+   CuAssertUIntEquals(tc, 1u, (uint32_t)stats.num_decompressed);
+   CuAssertUIntEquals(tc, 512u, (uint32_t)stats.bytes_decompressed);
+
+   apx_compressionStats_add(&total, &stats);
+   apx_compressionStats_add(&total, &stats);
+   CuAssertUIntEquals(tc, 2u, (uint32_t)total.num_compressed);
+   CuAssertUIntEquals(tc, 2048u, (uint32_t)total.bytes_before_compression);
+   CuAssertUIntEquals(tc, 1024u, (uint32_t)total.bytes_decompressed);
+}
+
+static void fill_pseudo_random(uint8_t* data, apx_size_t size)
+{
+   uint32_t state = 0x12345678u;
+   apx_size_t i;
+   for (i = 0u; i < size; i++)
+   {
+      state = state * 1103515245u + 12345u;
+      data[i] = (uint8_t)(state >> 16);
+   }
+}
@@ -0,0 +1,134 @@
+//////////////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////////////
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include "CuTest.h"
+#include "apx/event_loop.h"
+#ifdef MEM_LEAK_CHECK
+#include "CMemLeak.h"
+#endif
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE CONSTANTS AND DATA TYPES
+//////////////////////////////////////////////////////////////////////////////
+#define NUM_TEST_EVENTS 100
+
+typedef struct event_counter_tag
+{
+   uint32_t num_events;
+   uint32_t num_out_of_order;
+} event_counter_t;
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////////////
+static void test_event_loop_process_events_in_order(CuTest* tc);
+static void test_event_loop_batch_statistics(CuTest* tc);
+static void test_event_loop_append_during_processing(CuTest* tc);
+static void event_counter_handler(void *arg, apx_event_t *event);
+static void append_event(apx_eventLoop_t *event_loop, uint16_t id);
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE VARIABLES
+//////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////
+// PUBLIC FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+CuSuite* testSuite_apx_eventLoop(void)
+{
+   CuSuite* suite = CuSuiteNew();
+
+   SUITE_ADD_TEST(suite, test_event_loop_process_events_in_order);
+   SUITE_ADD_TEST(suite, test_event_loop_batch_statistics);
+   SUITE_ADD_TEST(suite, test_event_loop_append_during_processing);
+
+   return suite;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+static void test_event_loop_process_events_in_order(CuTest* tc)
+{
+   apx_eventLoop_t event_loop;
+   event_counter_t counter;
+   uint16_t i;
+   memset(&counter, 0, sizeof(counter));
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_eventLoop_create(&event_loop));
+   for (i = 0u; i < NUM_TEST_EVENTS; i++)
+   {
+      append_event(&event_loop, i);
+   }
+   CuAssertUIntEquals(tc, NUM_TEST_EVENTS, apx_eventLoop_numPendingEvents(&event_loop));
+   apx_eventLoop_runAll(&event_loop, event_counter_handler, (void*) &counter);
+   CuAssertUIntEquals(tc, 0u, apx_eventLoop_numPendingEvents(&event_loop));
+   CuAssertUIntEquals(tc, NUM_TEST_EVENTS, counter.num_events);
+   CuAssertUIntEquals(tc, 0u, counter.num_out_of_order);
+   apx_eventLoop_destroy(&event_loop);
+}
+
+static void test_event_loop_batch_statistics(CuTest* tc)
+{
+   apx_eventLoop_t event_loop;
+   apx_eventLoopStats_t stats;
+   event_counter_t counter;
+   uint16_t i;
+   memset(&counter, 0, sizeof(counter));
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_eventLoop_create(&event_loop));
+   apx_eventLoop_getStats(&event_loop, &stats);
+   CuAssertUIntEquals(tc, 0u, stats.numEventsProcessed);
+   CuAssertUIntEquals(tc, 0u, stats.numBatches);
+   CuAssertUIntEquals(tc, 0u, stats.numWakeups);
+   for (i = 0u; i < NUM_TEST_EVENTS; i++)
+   {
+      append_event(&event_loop, i);
+   }
+   apx_eventLoop_runAll(&event_loop, event_counter_handler, (void*) &counter);
+   apx_eventLoop_getStats(&event_loop, &stats);
+   CuAssertUIntEquals(tc, NUM_TEST_EVENTS, stats.numEventsProcessed);
+   CuAssertUIntEquals(tc, (NUM_TEST_EVENTS + APX_EVENT_LOOP_BATCH_SIZE - 1) / APX_EVENT_LOOP_BATCH_SIZE, stats.numBatches);
+   apx_eventLoop_destroy(&event_loop);
+}
+
+static void test_event_loop_append_during_processing(CuTest* tc)
+{
+   apx_eventLoop_t event_loop;
+   apx_eventLoopStats_t stats;
+   event_counter_t counter;
+   memset(&counter, 0, sizeof(counter));
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_eventLoop_create(&event_loop));
+   append_event(&event_loop, 0u);
+   apx_eventLoop_runAll(&event_loop, event_counter_handler, (void*) &counter);
+   append_event(&event_loop, 1u);
+   append_event(&event_loop, 2u);
+   apx_eventLoop_runAll(&event_loop, event_counter_handler, (void*) &counter);
+   apx_eventLoop_getStats(&event_loop, &stats);
+   CuAssertUIntEquals(tc, 3u, counter.num_events);
+   CuAssertUIntEquals(tc, 0u, counter.num_out_of_order);
+   CuAssertUIntEquals(tc, 3u, stats.numEventsProcessed);
+   CuAssertUIntEquals(tc, 2u, stats.numBatches);
+   apx_eventLoop_destroy(&event_loop);
+}
+
+static void event_counter_handler(void *arg, apx_event_t *event)
+{
+   event_counter_t *counter = (event_counter_t*) arg;
+   if (event->evFlags != (uint16_t) counter->num_events)
+   {
+      counter->num_out_of_order++;
+   }
+   counter->num_events++;
+}
+
+static void append_event(apx_eventLoop_t *event_loop, uint16_t id)
+{
+   apx_event_t event;
+   memset(&event, 0, sizeof(event));
+   event.evFlags = id;
+   apx_eventLoop_append(event_loop, &event);
+}
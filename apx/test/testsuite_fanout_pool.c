@@ -0,0 +1,177 @@
+//////////////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////////////
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "CuTest.h"
+#include "apx/fanout_pool.h"
+#ifdef MEM_LEAK_CHECK
+#include "CMemLeak.h"
+#endif
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE CONSTANTS AND DATA TYPES
+//////////////////////////////////////////////////////////////////////////////
+#define MAX_ITEMS 100
+#define MAX_CALLS 16
+
+typedef struct fanout_spy_tag
+{
+   int32_t visit_count[MAX_ITEMS];
+   int32_t num_calls;
+   int32_t call_begin[MAX_CALLS];
+   int32_t call_end[MAX_CALLS];
+   int32_t failing_item; //-1 when no item fails
+} fanout_spy_t;
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////////////
+static void test_create_rejects_invalid_arguments(CuTest* tc);
+static void test_run_below_threshold_uses_single_call(CuTest* tc);
+static void test_run_above_threshold_splits_range(CuTest* tc);
+static void test_run_with_fewer_items_than_slices(CuTest* tc);
+static void test_run_returns_error_from_any_slice(CuTest* tc);
+static void fanout_spy_init(fanout_spy_t* spy);
+static apx_error_t fanout_spy_func(void* arg, int32_t begin, int32_t end);
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE VARIABLES
+//////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////
+// PUBLIC FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+CuSuite* testSuite_apx_fanoutPool(void)
+{
+   CuSuite* suite = CuSuiteNew();
+
+   SUITE_ADD_TEST(suite, test_create_rejects_invalid_arguments);
+   SUITE_ADD_TEST(suite, test_run_below_threshold_uses_single_call);
+   SUITE_ADD_TEST(suite, test_run_above_threshold_splits_range);
+   SUITE_ADD_TEST(suite, test_run_with_fewer_items_than_slices);
+   SUITE_ADD_TEST(suite, test_run_returns_error_from_any_slice);
+
+   return suite;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+static void test_create_rejects_invalid_arguments(CuTest* tc)
+{
+   apx_fanoutPool_t pool;
+   CuAssertIntEquals(tc, APX_INVALID_ARGUMENT_ERROR, apx_fanoutPool_create(&pool, 0u, 10));
+   CuAssertIntEquals(tc, APX_INVALID_ARGUMENT_ERROR, apx_fanoutPool_create(&pool, APX_FANOUT_POOL_MAX_WORKERS + 1u, 10));
+   CuAssertIntEquals(tc, APX_INVALID_ARGUMENT_ERROR, apx_fanoutPool_create(&pool, 2u, 1));
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_fanoutPool_create(&pool, 2u, 10));
+   CuAssertUIntEquals(tc, 2u, apx_fanoutPool_num_workers(&pool));
+   CuAssertIntEquals(tc, 10, apx_fanoutPool_get_threshold(&pool));
+   apx_fanoutPool_destroy(&pool);
+}
+
+static void test_run_below_threshold_uses_single_call(CuTest* tc)
+{
+   fanout_spy_t spy;
+   apx_fanoutPoolStats_t stats;
+   apx_fanoutPool_t* pool = apx_fanoutPool_new(3u, 10);
+   CuAssertPtrNotNull(tc, pool);
+   fanout_spy_init(&spy);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_fanoutPool_run(pool, 9, fanout_spy_func, &spy));
+   CuAssertIntEquals(tc, 1, spy.num_calls);
+   CuAssertIntEquals(tc, 0, spy.call_begin[0]);
+   CuAssertIntEquals(tc, 9, spy.call_end[0]);
+   apx_fanoutPool_get_stats(pool, &stats);
+   CuAssertUIntEquals(tc, 1u, stats.num_sequential_runs);
+   CuAssertUIntEquals(tc, 0u, stats.num_parallel_runs);
+   apx_fanoutPool_delete(pool);
+}
+
+static void test_run_above_threshold_splits_range(CuTest* tc)
+{
+   fanout_spy_t spy;
+   apx_fanoutPoolStats_t stats;
+   int32_t i;
+   apx_fanoutPool_t* pool = apx_fanoutPool_new(3u, 10);
+   CuAssertPtrNotNull(tc, pool);
+   fanout_spy_init(&spy);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_fanoutPool_run(pool, 10, fanout_spy_func, &spy));
+   CuAssertIntEquals(tc, 4, spy.num_calls);
+   for (i = 0; i < 10; i++)
+   {
+      CuAssertIntEquals(tc, 1, spy.visit_count[i]);
+   }
+   for (i = 0; i < spy.num_calls; i++)
+   {
+      int32_t length = spy.call_end[i] - spy.call_begin[i];
+      CuAssertTrue(tc, (length == 2) || (length == 3));
+   }
+   apx_fanoutPool_get_stats(pool, &stats);
+   CuAssertUIntEquals(tc, 0u, stats.num_sequential_runs);
+   CuAssertUIntEquals(tc, 1u, stats.num_parallel_runs);
+   apx_fanoutPool_delete(pool);
+}
+
+static void test_run_with_fewer_items_than_slices(CuTest* tc)
+{
+   fanout_spy_t spy;
+   int32_t i;
+   apx_fanoutPool_t* pool = apx_fanoutPool_new(8u, 2);
+   CuAssertPtrNotNull(tc, pool);
+   fanout_spy_init(&spy);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_fanoutPool_run(pool, 3, fanout_spy_func, &spy));
+   CuAssertIntEquals(tc, 3, spy.num_calls);
+   for (i = 0; i < 3; i++)
+   {
+      CuAssertIntEquals(tc, 1, spy.visit_count[i]);
+      CuAssertIntEquals(tc, 1, spy.call_end[i] - spy.call_begin[i]);
+   }
+   apx_fanoutPool_delete(pool);
+}
+
+static void test_run_returns_error_from_any_slice(CuTest* tc)
+{
+   fanout_spy_t spy;
+   apx_fanoutPool_t* pool = apx_fanoutPool_new(3u, 4);
+   CuAssertPtrNotNull(tc, pool);
+   fanout_spy_init(&spy);
+   spy.failing_item = 7;
+   CuAssertIntEquals(tc, APX_VALUE_LENGTH_ERROR, apx_fanoutPool_run(pool, 12, fanout_spy_func, &spy));
+   CuAssertIntEquals(tc, 1, spy.visit_count[11]);
+   fanout_spy_init(&spy);
+   spy.failing_item = 0;
+   CuAssertIntEquals(tc, APX_VALUE_LENGTH_ERROR, apx_fanoutPool_run(pool, 12, fanout_spy_func, &spy));
+   apx_fanoutPool_delete(pool);
+}
+
+static void fanout_spy_init(fanout_spy_t* spy)
+{
+   memset(spy, 0, sizeof(fanout_spy_t));
+   spy->failing_item = -1;
+}
+
+static apx_error_t fanout_spy_func(void* arg, int32_t begin, int32_t end)
+{
+   apx_error_t retval = APX_NO_ERROR;
+   fanout_spy_t* spy = (fanout_spy_t*)arg;
+   int32_t i;
+   if (spy->num_calls < MAX_CALLS)
+   {
+      spy->call_begin[spy->num_calls] = begin;
+      spy->call_end[spy->num_calls] = end;
+   }
+   spy->num_calls++;
+   for (i = begin; i < end; i++)
+   {
+      spy->visit_count[i]++;
+      if (i == spy->failing_item)
+      {
+         retval = APX_VALUE_LENGTH_ERROR;
+      }
+   }
+   return retval;
+}
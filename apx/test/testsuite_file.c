@@ -22,11 +22,17 @@ static void test_detect_file_type_from_name(CuTest* tc);
 static void test_determine_local_or_remote_file(CuTest* tc);
 static void test_digest_data_is_copied_between_files(CuTest* tc);
 static void test_less_than_function(CuTest* tc);
+static void test_stream_records_are_delivered_in_sequence(CuTest* tc);
+static void test_early_writes_are_buffered_until_taken(CuTest* tc);
+static apx_error_t stream_write_spy(void* arg, apx_file_t* file, uint32_t offset, const uint8_t* src, uint32_t len);
 
 
 //////////////////////////////////////////////////////////////////////////////
 // PRIVATE VARIABLES
 //////////////////////////////////////////////////////////////////////////////
+static uint32_t m_stream_sequences[4];
+static uint8_t m_stream_values[4];
+static int m_num_stream_writes;
 
 //////////////////////////////////////////////////////////////////////////////
 // PUBLIC FUNCTIONS
@@ -40,6 +46,8 @@ CuSuite* testSuite_apx_file(void)
    SUITE_ADD_TEST(suite, test_determine_local_or_remote_file);
    SUITE_ADD_TEST(suite, test_digest_data_is_copied_between_files);
    SUITE_ADD_TEST(suite, test_less_than_function);
+   SUITE_ADD_TEST(suite, test_stream_records_are_delivered_in_sequence);
+   SUITE_ADD_TEST(suite, test_early_writes_are_buffered_until_taken);
 
    return suite;
 }
@@ -163,3 +171,113 @@ static void test_less_than_function(CuTest* tc)
    apx_file_destroy(&file1);
    apx_file_destroy(&file2);
 }
+
+static void test_stream_records_are_delivered_in_sequence(CuTest* tc)
+{
+   rmf_fileInfo_t* file_info = rmf_fileInfo_new(0x1000u | RMF_REMOTE_ADDRESS_BIT, 32u, "Trace.log", RMF_FILE_TYPE_STREAM, RMF_DIGEST_TYPE_NONE, NULL);
+   apx_fileNotificationHandler_t handler;
+   apx_file_t file;
+   uint8_t record[RMF_STREAM_SEQUENCE_SIZE + 1u];
+   uint32_t const sequences[5] = { 7u, 8u, 10u, 9u, 11u };
+   int i;
+   CuAssertPtrNotNull(tc, file_info);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_file_create(&file, file_info));
+   CuAssertTrue(tc, apx_file_is_stream(&file));
+   memset(&handler, 0, sizeof(handler));
+   handler.write_notify = stream_write_spy;
+   apx_file_set_notification_handler(&file, &handler);
+   m_num_stream_writes = 0;
+
+   for (i = 0; i < 5; i++)
+   {
+      record[0] = (uint8_t)sequences[i];
+      record[1] = 0u;
+      record[2] = 0u;
+      record[3] = 0u;
+      record[RMF_STREAM_SEQUENCE_SIZE] = (uint8_t)(0xA0 + i);
+      CuAssertIntEquals(tc, APX_NO_ERROR, apx_file_write_notify(&file, 0u, record, (uint32_t)sizeof(record)));
+   }
+   //Record 9 arrived after record 10 and is dropped, it was counted as lost
+   CuAssertIntEquals(tc, 4, m_num_stream_writes);
+   CuAssertUIntEquals(tc, 7u, m_stream_sequences[0]);
+   CuAssertUIntEquals(tc, 8u, m_stream_sequences[1]);
+   CuAssertUIntEquals(tc, 10u, m_stream_sequences[2]);
+   CuAssertUIntEquals(tc, 11u, m_stream_sequences[3]);
+   CuAssertUIntEquals(tc, 0xA4u, m_stream_values[3]);
+   CuAssertUIntEquals(tc, 1u, apx_file_get_num_lost_stream_records(&file));
+   CuAssertIntEquals(tc, APX_INVALID_WRITE_ERROR, apx_file_write_notify(&file, 0u, record, RMF_STREAM_SEQUENCE_SIZE - 1u));
+
+   rmf_fileInfo_delete(file_info);
+   apx_file_destroy(&file);
+}
+
+static void test_early_writes_are_buffered_until_taken(CuTest* tc)
+{
+   rmf_fileInfo_t* file_info = rmf_fileInfo_make_fixed("TestNode.out", 8u, 0x1000u | RMF_REMOTE_ADDRESS_BIT);
+   rmf_fileInfo_t* stream_info = rmf_fileInfo_new(0x2000u | RMF_REMOTE_ADDRESS_BIT, 32u, "Trace.log", RMF_FILE_TYPE_STREAM, RMF_DIGEST_TYPE_NONE, NULL);
+   apx_file_t file;
+   apx_file_t stream_file;
+   uint8_t const first[2] = { 0x12u, 0x34u };
+   uint8_t const second[3] = { 0x56u, 0x78u, 0x9Au };
+   uint8_t* data;
+   uint32_t offset = 0u;
+   uint32_t len = 0u;
+   CuAssertPtrNotNull(tc, file_info);
+   CuAssertPtrNotNull(tc, stream_info);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_file_create(&file, file_info));
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_file_create(&stream_file, stream_info));
+   CuAssertFalse(tc, apx_file_has_early_data(&file));
+
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_file_buffer_early_write(&file, 4u, second, (uint32_t)sizeof(second)));
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_file_buffer_early_write(&file, 1u, first, (uint32_t)sizeof(first)));
+   CuAssertIntEquals(tc, APX_INVALID_WRITE_ERROR, apx_file_buffer_early_write(&file, 7u, first, (uint32_t)sizeof(first)));
+   CuAssertIntEquals(tc, APX_INVALID_WRITE_ERROR, apx_file_buffer_early_write(&stream_file, 0u, first, (uint32_t)sizeof(first)));
+   CuAssertTrue(tc, apx_file_has_early_data(&file));
+   data = apx_file_take_early_data(&file);
+   CuAssertPtrNotNull(tc, data);
+   //Byte 3 was never written and is not part of any range
+   len = apx_file_next_early_data_range(&file, data, &offset);
+   CuAssertUIntEquals(tc, 1u, offset);
+   CuAssertUIntEquals(tc, 2u, len);
+   CuAssertIntEquals(tc, 0, memcmp(first, &data[offset], len));
+   offset += len;
+   len = apx_file_next_early_data_range(&file, data, &offset);
+   CuAssertUIntEquals(tc, 4u, offset);
+   CuAssertUIntEquals(tc, 3u, len);
+   CuAssertIntEquals(tc, 0, memcmp(second, &data[offset], len));
+   offset += len;
+   CuAssertUIntEquals(tc, 0u, apx_file_next_early_data_range(&file, data, &offset));
+   free(data);
+   CuAssertFalse(tc, apx_file_has_early_data(&file));
+   CuAssertPtrEquals(tc, NULL, apx_file_take_early_data(&file));
+
+   //Overlapping writes are merged into one range
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_file_buffer_early_write(&file, 5u, second, (uint32_t)sizeof(second)));
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_file_buffer_early_write(&file, 4u, first, (uint32_t)sizeof(first)));
+   data = apx_file_take_early_data(&file);
+   CuAssertPtrNotNull(tc, data);
+   offset = 0u;
+   CuAssertUIntEquals(tc, 4u, apx_file_next_early_data_range(&file, data, &offset));
+   CuAssertUIntEquals(tc, 4u, offset);
+   free(data);
+
+   //Data still buffered is released with the file
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_file_buffer_early_write(&file, 0u, first, (uint32_t)sizeof(first)));
+   rmf_fileInfo_delete(file_info);
+   rmf_fileInfo_delete(stream_info);
+   apx_file_destroy(&file);
+   apx_file_destroy(&stream_file);
+}
+
+static apx_error_t stream_write_spy(void* arg, apx_file_t* file, uint32_t offset, const uint8_t* src, uint32_t len)
+{
+   (void)arg;
+   (void)file;
+   if ( (m_num_stream_writes < 4) && (len == 1u) )
+   {
+      m_stream_sequences[m_num_stream_writes] = offset;
+      m_stream_values[m_num_stream_writes] = src[0];
+      m_num_stream_writes++;
+   }
+   return APX_NO_ERROR;
+}
@@ -28,6 +28,10 @@ static void test_medium_size_write(CuTest* tc);
 static void test_one_byte_fragmented_write(CuTest* tc);
 static void test_three_piece_message_followed_by_two_piece_message(CuTest* tc);
 static void test_fragmented_write_at_wrong_address(CuTest* tc);
+static void test_fragmented_write_larger_than_buffer(CuTest* tc);
+static void test_unfragmented_write_between_fragments(CuTest* tc);
+static void test_unfragmented_write_is_not_copied(CuTest* tc);
+static void test_unfragmented_write_inside_received_fragments(CuTest* tc);
 
 //////////////////////////////////////////////////////////////////////////////
 // PUBLIC VARIABLES
@@ -43,6 +47,10 @@ CuSuite* testSuite_apx_fileManagerReceiver(void)
    SUITE_ADD_TEST(suite, test_one_byte_fragmented_write);
    SUITE_ADD_TEST(suite, test_three_piece_message_followed_by_two_piece_message);
    SUITE_ADD_TEST(suite, test_fragmented_write_at_wrong_address);
+   SUITE_ADD_TEST(suite, test_fragmented_write_larger_than_buffer);
+   SUITE_ADD_TEST(suite, test_unfragmented_write_between_fragments);
+   SUITE_ADD_TEST(suite, test_unfragmented_write_is_not_copied);
+   SUITE_ADD_TEST(suite, test_unfragmented_write_inside_received_fragments);
 
    return suite;
 }
@@ -213,9 +221,147 @@ static void test_fragmented_write_at_wrong_address(CuTest* tc)
    CuAssertFalse(tc, result.is_complete);
    write_offset += write_size1;
 
-   //Write to same address again
-   CuAssertIntEquals(tc, APX_INVALID_ADDRESS_ERROR, apx_fileManagerReceiver_write(&recvr, &result, write_address, msg + write_offset, write_size2, false));
+   //Next fragment written to same address again
+   CuAssertIntEquals(tc, APX_INVALID_ADDRESS_ERROR, apx_fileManagerReceiver_write(&recvr, &result, write_address, msg + write_offset, write_size2, true));
    CuAssertFalse(tc, result.is_complete);
 
    apx_fileManagerReceiver_destroy(&recvr);
-}
\ No newline at end of file
+}
+
+static void test_fragmented_write_larger_than_buffer(CuTest* tc)
+{
+   uint32_t i;
+   uint32_t const write_address = 0x10000;
+   apx_size_t const fragment_size = RMF_CMD_AREA_SIZE;
+   apx_fileManagerReceiver_t recvr;
+   apx_fileManagerReceptionResult_t result;
+   uint8_t* msg = (uint8_t*)malloc(fragment_size * 3);
+   CuAssertPtrNotNull(tc, msg);
+   for (i = 0; i < fragment_size * 3; i++)
+   {
+      msg[i] = (uint8_t)i;
+   }
+
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_fileManagerReceiver_create(&recvr));
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_fileManagerReceiver_write(&recvr, &result, write_address, msg, fragment_size, true));
+   CuAssertFalse(tc, result.is_complete);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_fileManagerReceiver_write(&recvr, &result, write_address + fragment_size, msg + fragment_size, fragment_size, true));
+   CuAssertFalse(tc, result.is_complete);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_fileManagerReceiver_write(&recvr, &result, write_address + fragment_size * 2, msg + fragment_size * 2, fragment_size, false));
+   CuAssertTrue(tc, result.is_complete);
+   CuAssertUIntEquals(tc, write_address, result.address);
+   CuAssertUIntEquals(tc, fragment_size * 3, result.size);
+   CuAssertIntEquals(tc, 0, memcmp(msg, result.data, result.size));
+   CuAssertTrue(tc, apx_fileManagerReceiver_buffer_size(&recvr) >= fragment_size * 3);
+
+   apx_fileManagerReceiver_destroy(&recvr);
+   free(msg);
+}
+
+static void test_unfragmented_write_between_fragments(CuTest* tc)
+{
+   uint32_t i;
+   uint32_t const write_address = 0x10000;
+   apx_size_t const write_size1 = 15;
+   apx_size_t const write_size2 = 15;
+   apx_fileManagerReceiver_t recvr;
+   apx_fileManagerReceptionResult_t result;
+   uint8_t msg[15 + 15];
+   uint8_t const small_msg[2] = { 0x12, 0x34 };
+
+   for (i = 0; i < sizeof(msg); i++)
+   {
+      msg[i] = (uint8_t)i;
+   }
+
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_fileManagerReceiver_create(&recvr));
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_fileManagerReceiver_write(&recvr, &result, write_address, msg, write_size1, true));
+   CuAssertFalse(tc, result.is_complete);
+
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_fileManagerReceiver_write(&recvr, &result, 0x20000, small_msg, sizeof(small_msg), false));
+   CuAssertTrue(tc, result.is_complete);
+   CuAssertUIntEquals(tc, 0x20000, result.address);
+   CuAssertUIntEquals(tc, sizeof(small_msg), result.size);
+   CuAssertConstPtrEquals(tc, small_msg, result.data);
+
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_fileManagerReceiver_write(&recvr, &result, write_address + write_size1, msg + write_size1, write_size2, false));
+   CuAssertTrue(tc, result.is_complete);
+   CuAssertUIntEquals(tc, write_address, result.address);
+   CuAssertUIntEquals(tc, (apx_size_t)sizeof(msg), result.size);
+   CuAssertIntEquals(tc, 0, memcmp(msg, result.data, result.size));
+
+   apx_fileManagerReceiver_destroy(&recvr);
+}
+
+static void test_unfragmented_write_is_not_copied(CuTest* tc)
+{
+   uint8_t msg[4] = { 0x12, 0x034, 0x56, 0x78 };
+   uint8_t* large_msg = (uint8_t*)malloc(LARGE_BUFFER_SIZE);
+   apx_fileManagerReceiver_t recvr;
+   apx_fileManagerReceptionResult_t result;
+   CuAssertPtrNotNull(tc, large_msg);
+   memset(large_msg, 0xAA, LARGE_BUFFER_SIZE);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_fileManagerReceiver_create(&recvr));
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_fileManagerReceiver_write(&recvr, &result, 0x10000, msg, (apx_size_t)sizeof(msg), false));
+   CuAssertTrue(tc, result.is_complete);
+   CuAssertConstPtrEquals(tc, msg, result.data);
+   //Unfragmented messages do not need to fit in the reassembly buffer
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_fileManagerReceiver_write(&recvr, &result, 0x20000, large_msg, LARGE_BUFFER_SIZE, false));
+   CuAssertTrue(tc, result.is_complete);
+   CuAssertConstPtrEquals(tc, large_msg, result.data);
+   CuAssertUIntEquals(tc, LARGE_BUFFER_SIZE, result.size);
+   CuAssertUIntEquals(tc, RMF_CMD_AREA_SIZE, apx_fileManagerReceiver_buffer_size(&recvr));
+   CuAssertULIntEquals(tc, sizeof(msg) + LARGE_BUFFER_SIZE, apx_fileManagerReceiver_get_total_bytes_direct(&recvr));
+   CuAssertULIntEquals(tc, 0u, apx_fileManagerReceiver_get_total_bytes_copied(&recvr));
+   //Fragmented messages are still copied
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_fileManagerReceiver_write(&recvr, &result, 0x30000, msg, 2, true));
+   CuAssertFalse(tc, result.is_complete);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_fileManagerReceiver_write(&recvr, &result, 0x30002, msg + 2, 2, false));
+   CuAssertTrue(tc, result.is_complete);
+   CuAssertIntEquals(tc, 0, memcmp(msg, result.data, result.size));
+   CuAssertULIntEquals(tc, sizeof(msg), apx_fileManagerReceiver_get_total_bytes_copied(&recvr));
+   apx_fileManagerReceiver_destroy(&recvr);
+   free(large_msg);
+}
+
+static void test_unfragmented_write_inside_received_fragments(CuTest* tc)
+{
+   uint32_t i;
+   uint32_t const write_address = 0x10000;
+   apx_size_t const write_size1 = 15;
+   apx_size_t const write_size2 = 15;
+   apx_fileManagerReceiver_t recvr;
+   apx_fileManagerReceptionResult_t result;
+   uint8_t msg[15 + 15];
+   uint8_t const small_msg[2] = { 0x12, 0x34 };
+
+   for (i = 0; i < sizeof(msg); i++)
+   {
+      msg[i] = (uint8_t)i;
+   }
+
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_fileManagerReceiver_create(&recvr));
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_fileManagerReceiver_write(&recvr, &result, write_address, msg, write_size1, true));
+   CuAssertFalse(tc, result.is_complete);
+
+   //Port inside the part already received
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_fileManagerReceiver_write(&recvr, &result, write_address + 4u, small_msg, sizeof(small_msg), false));
+   CuAssertTrue(tc, result.is_complete);
+   CuAssertUIntEquals(tc, write_address + 4u, result.address);
+   CuAssertUIntEquals(tc, sizeof(small_msg), result.size);
+   CuAssertConstPtrEquals(tc, small_msg, result.data);
+
+   //Port at the start address
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_fileManagerReceiver_write(&recvr, &result, write_address, small_msg, sizeof(small_msg), false));
+   CuAssertTrue(tc, result.is_complete);
+   CuAssertUIntEquals(tc, write_address, result.address);
+   CuAssertConstPtrEquals(tc, small_msg, result.data);
+
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_fileManagerReceiver_write(&recvr, &result, write_address + write_size1, msg + write_size1, write_size2, false));
+   CuAssertTrue(tc, result.is_complete);
+   CuAssertUIntEquals(tc, write_address, result.address);
+   CuAssertUIntEquals(tc, (apx_size_t)sizeof(msg), result.size);
+   CuAssertIntEquals(tc, 0, memcmp(msg, result.data, result.size));
+
+   apx_fileManagerReceiver_destroy(&recvr);
+}
@@ -0,0 +1,580 @@
+//////////////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////////////
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "CuTest.h"
+#include "apx/file_manager_worker.h"
+#include "apx/file_manager_shared.h"
+#include "apx/compression.h"
+#include "apx/remotefile.h"
+#include "pack.h"
+#ifdef MEM_LEAK_CHECK
+#include "CMemLeak.h"
+#endif
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE CONSTANTS AND DATA TYPES
+//////////////////////////////////////////////////////////////////////////////
+#define SPY_MAX_BUFFER_SIZE 108 //gives 100 bytes of data per fragment
+#define SPY_MAX_MESSAGES 20
+#define LARGE_WRITE_SIZE 250
+
+typedef struct transmit_spy_message_tag
+{
+   uint32_t address;
+   bool more_bit;
+   int32_t size;
+} transmit_spy_message_t;
+
+typedef struct transmit_spy_tag
+{
+   transmit_spy_message_t messages[SPY_MAX_MESSAGES];
+   int32_t num_messages;
+   uint8_t received[LARGE_WRITE_SIZE];
+   apx_fileManagerWorker_t* inject_worker; //When set, priority data is queued while message number inject_at_message is transmitted
+   int32_t inject_at_message;
+   uint8_t command[SPY_MAX_BUFFER_SIZE]; //last message written to command area
+   int32_t command_size;
+} transmit_spy_t;
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////////////
+static void test_small_write_is_sent_in_one_message(CuTest* tc);
+static void test_large_write_is_sent_as_fragments(CuTest* tc);
+static void test_small_writes_interleave_with_fragments(CuTest* tc);
+static void test_overlapping_small_write_patches_owned_fragmented_write(CuTest* tc);
+static void test_overlapping_small_write_waits_for_const_fragmented_write(CuTest* tc);
+static void test_priority_data_is_sent_before_queued_normal_data(CuTest* tc);
+static void test_priority_data_preempts_fragments(CuTest* tc);
+static void test_priority_data_does_not_overtake_snapshot(CuTest* tc);
+static void test_latency_is_measured_per_lane(CuTest* tc);
+static void test_stream_records_are_retained_until_file_is_opened(CuTest* tc);
+static void test_acknowledge_contains_agreed_capabilities(CuTest* tc);
+static void test_fragments_are_compressed_when_negotiated(CuTest* tc);
+static void test_agreed_max_message_size_limits_fragments(CuTest* tc);
+static uint8_t* create_stream_record(uint8_t value);
+static uint8_t* create_small_data(uint8_t value);
+static void create_transmit_spy_interface(transmit_spy_t* spy, apx_connectionInterface_t* interface);
+static int32_t transmit_spy_max_buffer_size(void* arg);
+static void transmit_spy_begin(void* arg);
+static void transmit_spy_end(void* arg);
+static apx_error_t transmit_spy_data_message(void* arg, uint32_t write_address, bool more_bit, uint8_t const* data, int32_t size, int32_t* bytes_available);
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE VARIABLES
+//////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////
+// PUBLIC FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+CuSuite* testSuite_apx_fileManagerWorker(void)
+{
+   CuSuite* suite = CuSuiteNew();
+
+   SUITE_ADD_TEST(suite, test_small_write_is_sent_in_one_message);
+   SUITE_ADD_TEST(suite, test_large_write_is_sent_as_fragments);
+   SUITE_ADD_TEST(suite, test_small_writes_interleave_with_fragments);
+   SUITE_ADD_TEST(suite, test_overlapping_small_write_patches_owned_fragmented_write);
+   SUITE_ADD_TEST(suite, test_overlapping_small_write_waits_for_const_fragmented_write);
+   SUITE_ADD_TEST(suite, test_priority_data_is_sent_before_queued_normal_data);
+   SUITE_ADD_TEST(suite, test_priority_data_preempts_fragments);
+   SUITE_ADD_TEST(suite, test_priority_data_does_not_overtake_snapshot);
+   SUITE_ADD_TEST(suite, test_latency_is_measured_per_lane);
+   SUITE_ADD_TEST(suite, test_stream_records_are_retained_until_file_is_opened);
+   SUITE_ADD_TEST(suite, test_acknowledge_contains_agreed_capabilities);
+   SUITE_ADD_TEST(suite, test_fragments_are_compressed_when_negotiated);
+   SUITE_ADD_TEST(suite, test_agreed_max_message_size_limits_fragments);
+
+   return suite;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+static void test_small_write_is_sent_in_one_message(CuTest* tc)
+{
+   transmit_spy_t spy;
+   apx_connectionInterface_t interface;
+   apx_fileManagerShared_t shared;
+   apx_fileManagerWorker_t worker;
+   uint8_t* data = (uint8_t*)malloc(100);
+   CuAssertPtrNotNull(tc, data);
+   memset(data, 0x11, 100);
+   create_transmit_spy_interface(&spy, &interface);
+   apx_fileManagerShared_create(&shared, &interface, NULL);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_fileManagerWorker_create(&worker, &shared, APX_SERVER_MODE));
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_fileManagerWorker_prepare_send_local_data(&worker, 0x10000, data, 100));
+   CuAssertTrue(tc, apx_fileManagerWorker_run(&worker));
+   CuAssertIntEquals(tc, 1, spy.num_messages);
+   CuAssertUIntEquals(tc, 0x10000, spy.messages[0].address);
+   CuAssertFalse(tc, spy.messages[0].more_bit);
+   CuAssertIntEquals(tc, 100, spy.messages[0].size);
+   apx_fileManagerWorker_destroy(&worker);
+   apx_fileManagerShared_destroy(&shared);
+}
+
+static void test_large_write_is_sent_as_fragments(CuTest* tc)
+{
+   transmit_spy_t spy;
+   apx_connectionInterface_t interface;
+   apx_fileManagerShared_t shared;
+   apx_fileManagerWorker_t worker;
+   uint8_t data[LARGE_WRITE_SIZE];
+   int i;
+   for (i = 0; i < LARGE_WRITE_SIZE; i++)
+   {
+      data[i] = (uint8_t)i;
+   }
+   create_transmit_spy_interface(&spy, &interface);
+   apx_fileManagerShared_create(&shared, &interface, NULL);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_fileManagerWorker_create(&worker, &shared, APX_SERVER_MODE));
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_fileManagerWorker_prepare_send_local_const_data(&worker, 0x10000, data, LARGE_WRITE_SIZE));
+   CuAssertTrue(tc, apx_fileManagerWorker_run(&worker));
+   CuAssertIntEquals(tc, 3, spy.num_messages);
+   CuAssertUIntEquals(tc, 0x10000, spy.messages[0].address);
+   CuAssertTrue(tc, spy.messages[0].more_bit);
+   CuAssertIntEquals(tc, 100, spy.messages[0].size);
+   CuAssertUIntEquals(tc, 0x10000 + 100, spy.messages[1].address);
+   CuAssertTrue(tc, spy.messages[1].more_bit);
+   CuAssertIntEquals(tc, 100, spy.messages[1].size);
+   CuAssertUIntEquals(tc, 0x10000 + 200, spy.messages[2].address);
+   CuAssertFalse(tc, spy.messages[2].more_bit);
+   CuAssertIntEquals(tc, 50, spy.messages[2].size);
+   CuAssertIntEquals(tc, 0, memcmp(data, spy.received, LARGE_WRITE_SIZE));
+   apx_fileManagerWorker_destroy(&worker);
+   apx_fileManagerShared_destroy(&shared);
+}
+
+static void test_small_writes_interleave_with_fragments(CuTest* tc)
+{
+   transmit_spy_t spy;
+   apx_connectionInterface_t interface;
+   apx_fileManagerShared_t shared;
+   apx_fileManagerWorker_t worker;
+   uint8_t* large_data = (uint8_t*)malloc(LARGE_WRITE_SIZE);
+   uint8_t small_data[2] = { 0x12, 0x34 };
+   CuAssertPtrNotNull(tc, large_data);
+   memset(large_data, 0, LARGE_WRITE_SIZE);
+   create_transmit_spy_interface(&spy, &interface);
+   apx_fileManagerShared_create(&shared, &interface, NULL);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_fileManagerWorker_create(&worker, &shared, APX_SERVER_MODE));
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_fileManagerWorker_prepare_send_local_data(&worker, 0x10000, large_data, LARGE_WRITE_SIZE));
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_fileManagerWorker_prepare_send_local_const_data(&worker, 0x20000, small_data, 2));
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_fileManagerWorker_prepare_send_local_const_data(&worker, 0x30000, small_data, 2));
+   CuAssertTrue(tc, apx_fileManagerWorker_run(&worker));
+   CuAssertIntEquals(tc, 5, spy.num_messages);
+   CuAssertUIntEquals(tc, 0x10000, spy.messages[0].address);
+   CuAssertTrue(tc, spy.messages[0].more_bit);
+   CuAssertUIntEquals(tc, 0x20000, spy.messages[1].address);
+   CuAssertFalse(tc, spy.messages[1].more_bit);
+   CuAssertUIntEquals(tc, 0x10000 + 100, spy.messages[2].address);
+   CuAssertTrue(tc, spy.messages[2].more_bit);
+   CuAssertUIntEquals(tc, 0x30000, spy.messages[3].address);
+   CuAssertFalse(tc, spy.messages[3].more_bit);
+   CuAssertUIntEquals(tc, 0x10000 + 200, spy.messages[4].address);
+   CuAssertFalse(tc, spy.messages[4].more_bit);
+   apx_fileManagerWorker_destroy(&worker);
+   apx_fileManagerShared_destroy(&shared);
+}
+
+static void test_overlapping_small_write_patches_owned_fragmented_write(CuTest* tc)
+{
+   transmit_spy_t spy;
+   apx_connectionInterface_t interface;
+   apx_fileManagerShared_t shared;
+   apx_fileManagerWorker_t worker;
+   uint8_t* large_data = (uint8_t*)malloc(LARGE_WRITE_SIZE);
+   uint8_t small_data[2] = { 0x12, 0x34 };
+   CuAssertPtrNotNull(tc, large_data);
+   memset(large_data, 0, LARGE_WRITE_SIZE);
+   create_transmit_spy_interface(&spy, &interface);
+   apx_fileManagerShared_create(&shared, &interface, NULL);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_fileManagerWorker_create(&worker, &shared, APX_SERVER_MODE));
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_fileManagerWorker_prepare_send_local_data(&worker, 0x10000, large_data, LARGE_WRITE_SIZE));
+   //Overlaps the second fragment which has not been sent when the small write is processed
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_fileManagerWorker_prepare_send_local_const_data(&worker, 0x10000 + 150, small_data, 2));
+   CuAssertTrue(tc, apx_fileManagerWorker_run(&worker));
+   CuAssertIntEquals(tc, 4, spy.num_messages);
+   CuAssertUIntEquals(tc, 0x10000, spy.messages[0].address);
+   CuAssertUIntEquals(tc, 0x10000 + 150, spy.messages[1].address);
+   CuAssertFalse(tc, spy.messages[1].more_bit);
+   CuAssertUIntEquals(tc, 0x10000 + 100, spy.messages[2].address);
+   CuAssertUIntEquals(tc, 0x10000 + 200, spy.messages[3].address);
+   CuAssertUIntEquals(tc, 0x12, spy.received[150]);
+   CuAssertUIntEquals(tc, 0x34, spy.received[151]);
+   apx_fileManagerWorker_destroy(&worker);
+   apx_fileManagerShared_destroy(&shared);
+}
+
+static void test_overlapping_small_write_waits_for_const_fragmented_write(CuTest* tc)
+{
+   transmit_spy_t spy;
+   apx_connectionInterface_t interface;
+   apx_fileManagerShared_t shared;
+   apx_fileManagerWorker_t worker;
+   uint8_t large_data[LARGE_WRITE_SIZE];
+   uint8_t small_data[2] = { 0x12, 0x34 };
+   memset(large_data, 0, LARGE_WRITE_SIZE);
+   create_transmit_spy_interface(&spy, &interface);
+   apx_fileManagerShared_create(&shared, &interface, NULL);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_fileManagerWorker_create(&worker, &shared, APX_SERVER_MODE));
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_fileManagerWorker_prepare_send_local_const_data(&worker, 0x10000, large_data, LARGE_WRITE_SIZE));
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_fileManagerWorker_prepare_send_local_const_data(&worker, 0x10000 + 150, small_data, 2));
+   CuAssertTrue(tc, apx_fileManagerWorker_run(&worker));
+   CuAssertIntEquals(tc, 4, spy.num_messages);
+   CuAssertUIntEquals(tc, 0x10000, spy.messages[0].address);
+   CuAssertUIntEquals(tc, 0x10000 + 100, spy.messages[1].address);
+   CuAssertUIntEquals(tc, 0x10000 + 200, spy.messages[2].address);
+   CuAssertFalse(tc, spy.messages[2].more_bit);
+   CuAssertUIntEquals(tc, 0x10000 + 150, spy.messages[3].address);
+   CuAssertUIntEquals(tc, 0x12, spy.received[150]);
+   CuAssertUIntEquals(tc, 0x34, spy.received[151]);
+   CuAssertUIntEquals(tc, 0, large_data[150]);
+   apx_fileManagerWorker_destroy(&worker);
+   apx_fileManagerShared_destroy(&shared);
+}
+
+static void test_priority_data_is_sent_before_queued_normal_data(CuTest* tc)
+{
+   transmit_spy_t spy;
+   apx_connectionInterface_t interface;
+   apx_fileManagerShared_t shared;
+   apx_fileManagerWorker_t worker;
+   uint8_t small_data[2] = { 0x12, 0x34 };
+   create_transmit_spy_interface(&spy, &interface);
+   apx_fileManagerShared_create(&shared, &interface, NULL);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_fileManagerWorker_create(&worker, &shared, APX_SERVER_MODE));
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_fileManagerWorker_prepare_send_local_const_data(&worker, 0x20000, small_data, 2));
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_fileManagerWorker_prepare_send_priority_data(&worker, 0x30000, create_small_data(0x56), 2));
+   CuAssertUIntEquals(tc, 2u, apx_fileManagerWorker_num_pending_commands(&worker));
+   CuAssertTrue(tc, apx_fileManagerWorker_run(&worker));
+   CuAssertIntEquals(tc, 2, spy.num_messages);
+   CuAssertUIntEquals(tc, 0x30000, spy.messages[0].address);
+   CuAssertUIntEquals(tc, 0x20000, spy.messages[1].address);
+   apx_fileManagerWorker_destroy(&worker);
+   apx_fileManagerShared_destroy(&shared);
+}
+
+static void test_priority_data_preempts_fragments(CuTest* tc)
+{
+   transmit_spy_t spy;
+   apx_connectionInterface_t interface;
+   apx_fileManagerShared_t shared;
+   apx_fileManagerWorker_t worker;
+   uint8_t* large_data = (uint8_t*)malloc(LARGE_WRITE_SIZE);
+   uint8_t small_data[2] = { 0x12, 0x34 };
+   CuAssertPtrNotNull(tc, large_data);
+   memset(large_data, 0, LARGE_WRITE_SIZE);
+   create_transmit_spy_interface(&spy, &interface);
+   apx_fileManagerShared_create(&shared, &interface, NULL);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_fileManagerWorker_create(&worker, &shared, APX_SERVER_MODE));
+   //Priority data arrives while the small write (second message) is being transmitted
+   spy.inject_worker = &worker;
+   spy.inject_at_message = 1;
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_fileManagerWorker_prepare_send_local_data(&worker, 0x10000, large_data, LARGE_WRITE_SIZE));
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_fileManagerWorker_prepare_send_local_const_data(&worker, 0x20000, small_data, 2));
+   CuAssertTrue(tc, apx_fileManagerWorker_run(&worker));
+   CuAssertIntEquals(tc, 5, spy.num_messages);
+   CuAssertUIntEquals(tc, 0x10000, spy.messages[0].address);
+   CuAssertUIntEquals(tc, 0x20000, spy.messages[1].address);
+   CuAssertUIntEquals(tc, 0x30000, spy.messages[2].address);
+   CuAssertFalse(tc, spy.messages[2].more_bit);
+   CuAssertUIntEquals(tc, 0x10000 + 100, spy.messages[3].address);
+   CuAssertTrue(tc, spy.messages[3].more_bit);
+   CuAssertUIntEquals(tc, 0x10000 + 200, spy.messages[4].address);
+   CuAssertFalse(tc, spy.messages[4].more_bit);
+   apx_fileManagerWorker_destroy(&worker);
+   apx_fileManagerShared_destroy(&shared);
+}
+
+static void test_priority_data_does_not_overtake_snapshot(CuTest* tc)
+{
+   transmit_spy_t spy;
+   apx_connectionInterface_t interface;
+   apx_fileManagerShared_t shared;
+   apx_fileManagerWorker_t worker;
+   uint8_t small_data[2] = { 0x12, 0x34 };
+   create_transmit_spy_interface(&spy, &interface);
+   apx_fileManagerShared_create(&shared, &interface, NULL);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_fileManagerWorker_create(&worker, &shared, APX_SERVER_MODE));
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_fileManagerWorker_prepare_send_priority_data(&worker, 0x10000, create_small_data(0x01), 2));
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_fileManagerWorker_prepare_send_local_snapshot(&worker, 0x10000, create_small_data(0x02), 2));
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_fileManagerWorker_prepare_send_priority_data(&worker, 0x10000, create_small_data(0x03), 2));
+   CuAssertTrue(tc, apx_fileManagerWorker_run(&worker));
+   CuAssertIntEquals(tc, 3, spy.num_messages);
+   CuAssertUIntEquals(tc, 0x03, spy.received[0]);
+   //Once the snapshot is sent priority data bypasses the normal lane again
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_fileManagerWorker_prepare_send_local_const_data(&worker, 0x20000, small_data, 2));
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_fileManagerWorker_prepare_send_priority_data(&worker, 0x10000, create_small_data(0x04), 2));
+   CuAssertTrue(tc, apx_fileManagerWorker_run(&worker));
+   CuAssertIntEquals(tc, 5, spy.num_messages);
+   CuAssertUIntEquals(tc, 0x10000, spy.messages[3].address);
+   CuAssertUIntEquals(tc, 0x20000, spy.messages[4].address);
+   apx_fileManagerWorker_destroy(&worker);
+   apx_fileManagerShared_destroy(&shared);
+}
+
+static void test_latency_is_measured_per_lane(CuTest* tc)
+{
+   transmit_spy_t spy;
+   apx_connectionInterface_t interface;
+   apx_fileManagerShared_t shared;
+   apx_fileManagerWorker_t worker;
+   apx_latencyHistogram_t histogram;
+   uint8_t small_data[2] = { 0x12, 0x34 };
+   create_transmit_spy_interface(&spy, &interface);
+   apx_fileManagerShared_create(&shared, &interface, NULL);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_fileManagerWorker_create(&worker, &shared, APX_SERVER_MODE));
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_fileManagerWorker_prepare_send_local_const_data(&worker, 0x20000, small_data, 2));
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_fileManagerWorker_prepare_send_local_const_data(&worker, 0x20000, small_data, 2));
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_fileManagerWorker_prepare_send_priority_data(&worker, 0x30000, create_small_data(0x56), 2));
+   CuAssertTrue(tc, apx_fileManagerWorker_run(&worker));
+   apx_fileManagerWorker_get_latency(&worker, APX_TRANSMIT_LANE_NORMAL, &histogram);
+   CuAssertUIntEquals(tc, 2u, apx_latencyHistogram_num_samples(&histogram));
+   apx_fileManagerWorker_get_latency(&worker, APX_TRANSMIT_LANE_HIGH, &histogram);
+   CuAssertUIntEquals(tc, 1u, apx_latencyHistogram_num_samples(&histogram));
+   apx_fileManagerWorker_destroy(&worker);
+   apx_fileManagerShared_destroy(&shared);
+}
+
+static void test_stream_records_are_retained_until_file_is_opened(CuTest* tc)
+{
+   transmit_spy_t spy;
+   apx_connectionInterface_t interface;
+   apx_fileManagerShared_t shared;
+   apx_fileManagerWorker_t worker;
+   apx_file_t* file;
+   rmf_fileInfo_t* file_info = rmf_fileInfo_new(0x10000, 64u, "Trace.log", RMF_FILE_TYPE_STREAM, RMF_DIGEST_TYPE_NONE, NULL);
+   CuAssertPtrNotNull(tc, file_info);
+   create_transmit_spy_interface(&spy, &interface);
+   apx_fileManagerShared_create(&shared, &interface, NULL);
+   file = apx_fileManagerShared_create_local_file(&shared, file_info);
+   CuAssertPtrNotNull(tc, file);
+   apx_file_set_stream_retention(file, 2u);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_fileManagerWorker_create(&worker, &shared, APX_SERVER_MODE));
+
+   //Oldest record is evicted while nobody reads the stream
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_fileManagerWorker_prepare_send_stream_record(&worker, 0x10000, create_stream_record(0x01), RMF_STREAM_SEQUENCE_SIZE + 1u));
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_fileManagerWorker_prepare_send_stream_record(&worker, 0x10000, create_stream_record(0x02), RMF_STREAM_SEQUENCE_SIZE + 1u));
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_fileManagerWorker_prepare_send_stream_record(&worker, 0x10000, create_stream_record(0x03), RMF_STREAM_SEQUENCE_SIZE + 1u));
+   CuAssertTrue(tc, apx_fileManagerWorker_run(&worker));
+   CuAssertIntEquals(tc, 0, spy.num_messages);
+   CuAssertUIntEquals(tc, 1u, apx_streamBuffer_num_evicted(apx_file_get_stream_buffer(file)));
+
+   //Retained records are replayed in order when the file is opened
+   apx_file_open(file);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_fileManagerWorker_prepare_open_stream(&worker, 0x10000));
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_fileManagerWorker_prepare_send_stream_record(&worker, 0x10000, create_stream_record(0x04), RMF_STREAM_SEQUENCE_SIZE + 1u));
+   CuAssertTrue(tc, apx_fileManagerWorker_run(&worker));
+   CuAssertIntEquals(tc, 3, spy.num_messages);
+   CuAssertUIntEquals(tc, 0x10000, spy.messages[0].address);
+   CuAssertIntEquals(tc, RMF_STREAM_SEQUENCE_SIZE + 1, spy.messages[0].size);
+   //Last received record
+   CuAssertUIntEquals(tc, 3u, spy.received[0]);
+   CuAssertUIntEquals(tc, 0x04, spy.received[RMF_STREAM_SEQUENCE_SIZE]);
+
+   apx_fileManagerWorker_destroy(&worker);
+   apx_fileManagerShared_destroy(&shared);
+   rmf_fileInfo_delete(file_info);
+}
+
+static void test_acknowledge_contains_agreed_capabilities(CuTest* tc)
+{
+   transmit_spy_t spy;
+   apx_connectionInterface_t interface;
+   apx_fileManagerShared_t shared;
+   apx_fileManagerWorker_t worker;
+   apx_capabilities_t local_capabilities;
+   apx_capabilities_t peer_capabilities;
+   char const* expected_header = "Capabilities:lz4,stream-file\nMax-Message-Size:1000\nReceive-Buffer-Size:4096\n";
+   create_transmit_spy_interface(&spy, &interface);
+   apx_fileManagerShared_create(&shared, &interface, NULL);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_fileManagerWorker_create(&worker, &shared, APX_SERVER_MODE));
+
+   //Client did not announce anything
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_fileManagerWorker_preare_acknowledge(&worker));
+   CuAssertTrue(tc, apx_fileManagerWorker_run(&worker));
+   CuAssertIntEquals(tc, RMF_CMD_TYPE_SIZE, spy.command_size);
+
+   apx_capabilities_create(&local_capabilities, APX_CAPABILITY_COMPRESSION | APX_CAPABILITY_STREAM_FILE, 0u, 4096u);
+   apx_capabilities_create(&peer_capabilities, APX_CAPABILITY_COMPRESSION | APX_CAPABILITY_DYNAMIC_FILE | APX_CAPABILITY_STREAM_FILE, 1000u, 0u);
+   peer_capabilities.is_announced = true;
+   apx_fileManagerShared_set_capabilities(&shared, &local_capabilities, &peer_capabilities);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_fileManagerWorker_preare_acknowledge(&worker));
+   CuAssertTrue(tc, apx_fileManagerWorker_run(&worker));
+   CuAssertIntEquals(tc, RMF_CMD_TYPE_SIZE + (int32_t)strlen(expected_header), spy.command_size);
+   CuAssertUIntEquals(tc, RMF_CMD_ACK_MSG, unpackLE(spy.command, RMF_CMD_TYPE_SIZE));
+   CuAssertIntEquals(tc, 0, memcmp(expected_header, &spy.command[RMF_CMD_TYPE_SIZE], strlen(expected_header)));
+
+   apx_fileManagerWorker_destroy(&worker);
+   apx_fileManagerShared_destroy(&shared);
+}
+
+static void test_fragments_are_compressed_when_negotiated(CuTest* tc)
+{
+   transmit_spy_t spy;
+   apx_connectionInterface_t interface;
+   apx_fileManagerShared_t shared;
+   apx_fileManagerWorker_t worker;
+   apx_compressionStats_t stats;
+   uint8_t data[LARGE_WRITE_SIZE];
+   uint8_t decompressed[100];
+   uint32_t address = 0u;
+   uint32_t uncompressed_size = 0u;
+   bool more_bit = false;
+   apx_size_t header_size;
+   memset(data, 0x22, sizeof(data));
+   create_transmit_spy_interface(&spy, &interface);
+   apx_fileManagerShared_create(&shared, &interface, NULL);
+   apx_fileManagerShared_set_compression_threshold(&shared, 64u);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_fileManagerWorker_create(&worker, &shared, APX_SERVER_MODE));
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_fileManagerWorker_prepare_send_local_const_data(&worker, 0x10000, data, LARGE_WRITE_SIZE));
+   CuAssertTrue(tc, apx_fileManagerWorker_run(&worker));
+
+   //Full fragments are compressed, the last fragment is below the threshold
+   CuAssertIntEquals(tc, 3, spy.num_messages);
+   CuAssertUIntEquals(tc, RMF_CMD_AREA_START_ADDRESS, spy.messages[0].address);
+   CuAssertFalse(tc, spy.messages[0].more_bit);
+   CuAssertTrue(tc, spy.messages[0].size < 100);
+   CuAssertUIntEquals(tc, RMF_CMD_AREA_START_ADDRESS, spy.messages[1].address);
+   CuAssertUIntEquals(tc, 0x10000 + 200, spy.messages[2].address);
+   CuAssertIntEquals(tc, 50, spy.messages[2].size);
+
+   header_size = rmf_decode_compressed_msg_header(spy.command, spy.command + spy.command_size, &address, &more_bit, &uncompressed_size);
+   CuAssertTrue(tc, header_size > 0u);
+   CuAssertUIntEquals(tc, 0x10000 + 100, address);
+   CuAssertTrue(tc, more_bit);
+   CuAssertUIntEquals(tc, 100u, uncompressed_size);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_compression_decompress(decompressed, (apx_size_t)sizeof(decompressed), spy.command + header_size, (apx_size_t)spy.command_size - header_size, NULL));
+   CuAssertIntEquals(tc, 0, memcmp(&data[100], decompressed, sizeof(decompressed)));
+
+   apx_fileManagerShared_get_compression_stats(&shared, &stats);
+   CuAssertUIntEquals(tc, 2u, (uint32_t)stats.num_compressed);
+   CuAssertUIntEquals(tc, 200u, (uint32_t)stats.bytes_before_compression);
+   CuAssertUIntEquals(tc, (uint32_t)(spy.messages[0].size + spy.messages[1].size) - 2u * (RMF_CMD_TYPE_SIZE + RMF_HIGH_ADDR_SIZE + UINT32_SIZE), (uint32_t)stats.bytes_after_compression);
+
+   apx_fileManagerWorker_destroy(&worker);
+   apx_fileManagerShared_destroy(&shared);
+}
+
+static void test_agreed_max_message_size_limits_fragments(CuTest* tc)
+{
+   transmit_spy_t spy;
+   apx_connectionInterface_t interface;
+   apx_fileManagerShared_t shared;
+   apx_fileManagerWorker_t worker;
+   apx_capabilities_t local_capabilities;
+   apx_capabilities_t peer_capabilities;
+   uint8_t data[LARGE_WRITE_SIZE];
+   int i;
+   for (i = 0; i < LARGE_WRITE_SIZE; i++)
+   {
+      data[i] = (uint8_t)i;
+   }
+   create_transmit_spy_interface(&spy, &interface);
+   apx_fileManagerShared_create(&shared, &interface, NULL);
+   apx_capabilities_create(&local_capabilities, APX_CAPABILITY_DEFAULT_FLAGS, 0u, 0u);
+   apx_capabilities_create(&peer_capabilities, APX_CAPABILITY_DEFAULT_FLAGS, 64u + RMF_HIGH_ADDR_SIZE, 0u);
+   peer_capabilities.is_announced = true;
+   apx_fileManagerShared_set_capabilities(&shared, &local_capabilities, &peer_capabilities);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_fileManagerWorker_create(&worker, &shared, APX_SERVER_MODE));
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_fileManagerWorker_prepare_send_local_const_data(&worker, 0x10000, data, LARGE_WRITE_SIZE));
+   CuAssertTrue(tc, apx_fileManagerWorker_run(&worker));
+
+   //Peer limit is smaller than the transmit buffer
+   CuAssertIntEquals(tc, 4, spy.num_messages);
+   CuAssertUIntEquals(tc, 0x10000, spy.messages[0].address);
+   CuAssertIntEquals(tc, 64, spy.messages[0].size);
+   CuAssertTrue(tc, spy.messages[0].more_bit);
+   CuAssertUIntEquals(tc, 0x10000 + 192, spy.messages[3].address);
+   CuAssertIntEquals(tc, 58, spy.messages[3].size);
+   CuAssertFalse(tc, spy.messages[3].more_bit);
+   CuAssertIntEquals(tc, 0, memcmp(data, spy.received, LARGE_WRITE_SIZE));
+
+   apx_fileManagerWorker_destroy(&worker);
+   apx_fileManagerShared_destroy(&shared);
+}
+
+static uint8_t* create_stream_record(uint8_t value)
+{
+   uint8_t* data = (uint8_t*)malloc(RMF_STREAM_SEQUENCE_SIZE + 1u);
+   if (data != NULL)
+   {
+      memset(data, 0, RMF_STREAM_SEQUENCE_SIZE);
+      data[RMF_STREAM_SEQUENCE_SIZE] = value;
+   }
+   return data;
+}
+
+static uint8_t* create_small_data(uint8_t value)
+{
+   uint8_t* data = (uint8_t*)malloc(2);
+   if (data != NULL)
+   {
+      data[0] = value;
+      data[1] = value;
+   }
+   return data;
+}
+
+static void create_transmit_spy_interface(transmit_spy_t* spy, apx_connectionInterface_t* interface)
+{
+   memset(spy, 0, sizeof(transmit_spy_t));
+   memset(interface, 0, sizeof(apx_connectionInterface_t));
+   interface->arg = (void*)spy;
+   interface->transmit_max_buffer_size = transmit_spy_max_buffer_size;
+   interface->transmit_begin = transmit_spy_begin;
+   interface->transmit_end = transmit_spy_end;
+   interface->transmit_data_message = transmit_spy_data_message;
+}
+
+static int32_t transmit_spy_max_buffer_size(void* arg)
+{
+   (void)arg;
+   return SPY_MAX_BUFFER_SIZE;
+}
+
+static void transmit_spy_begin(void* arg)
+{
+   (void)arg;
+}
+
+static void transmit_spy_end(void* arg)
+{
+   (void)arg;
+}
+
+static apx_error_t transmit_spy_data_message(void* arg, uint32_t write_address, bool more_bit, uint8_t const* data, int32_t size, int32_t* bytes_available)
+{
+   transmit_spy_t* spy = (transmit_spy_t*)arg;
+   if (spy->num_messages >= SPY_MAX_MESSAGES)
+   {
+      return APX_BUFFER_FULL_ERROR;
+   }
+   spy->messages[spy->num_messages].address = write_address;
+   spy->messages[spy->num_messages].more_bit = more_bit;
+   spy->messages[spy->num_messages].size = size;
+   spy->num_messages++;
+   if ( (spy->inject_worker != NULL) && (spy->num_messages == (spy->inject_at_message + 1)) )
+   {
+      (void)apx_fileManagerWorker_prepare_send_priority_data(spy->inject_worker, 0x30000, create_small_data(0x56), 2);
+      spy->inject_worker = NULL;
+   }
+   if ( (write_address == RMF_CMD_AREA_START_ADDRESS) && (size <= SPY_MAX_BUFFER_SIZE) )
+   {
+      memcpy(spy->command, data, (size_t)size);
+      spy->command_size = size;
+   }
+   if ( (write_address >= 0x10000) && ((write_address - 0x10000 + (uint32_t)size) <= LARGE_WRITE_SIZE) )
+   {
+      memcpy(&spy->received[write_address - 0x10000], data, (size_t)size);
+   }
+   *bytes_available = SPY_MAX_BUFFER_SIZE;
+   return APX_NO_ERROR;
+}
@@ -0,0 +1,96 @@
+//////////////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////////////
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "CuTest.h"
+#include "apx/latency_histogram.h"
+#ifdef MEM_LEAK_CHECK
+#include "CMemLeak.h"
+#endif
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE CONSTANTS AND DATA TYPES
+//////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////////////
+static void test_empty_histogram(CuTest* tc);
+static void test_percentile_is_clamped_to_max(CuTest* tc);
+static void test_percentiles_of_skewed_distribution(CuTest* tc);
+static void test_zero_and_very_large_latencies(CuTest* tc);
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE VARIABLES
+//////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////
+// PUBLIC FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+CuSuite* testSuite_apx_latencyHistogram(void)
+{
+   CuSuite* suite = CuSuiteNew();
+
+   SUITE_ADD_TEST(suite, test_empty_histogram);
+   SUITE_ADD_TEST(suite, test_percentile_is_clamped_to_max);
+   SUITE_ADD_TEST(suite, test_percentiles_of_skewed_distribution);
+   SUITE_ADD_TEST(suite, test_zero_and_very_large_latencies);
+
+   return suite;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+static void test_empty_histogram(CuTest* tc)
+{
+   apx_latencyHistogram_t histogram;
+   apx_latencyHistogram_create(&histogram);
+   CuAssertUIntEquals(tc, 0u, apx_latencyHistogram_num_samples(&histogram));
+   CuAssertUIntEquals(tc, 0u, apx_latencyHistogram_max(&histogram));
+   CuAssertUIntEquals(tc, 0u, apx_latencyHistogram_percentile(&histogram, 50u));
+}
+
+static void test_percentile_is_clamped_to_max(CuTest* tc)
+{
+   apx_latencyHistogram_t histogram;
+   apx_latencyHistogram_create(&histogram);
+   apx_latencyHistogram_add(&histogram, 100u); //bucket [64, 127]
+   CuAssertUIntEquals(tc, 1u, apx_latencyHistogram_num_samples(&histogram));
+   CuAssertUIntEquals(tc, 100u, apx_latencyHistogram_max(&histogram));
+   CuAssertUIntEquals(tc, 100u, apx_latencyHistogram_percentile(&histogram, 50u));
+   CuAssertUIntEquals(tc, 100u, apx_latencyHistogram_percentile(&histogram, 100u));
+}
+
+static void test_percentiles_of_skewed_distribution(CuTest* tc)
+{
+   apx_latencyHistogram_t histogram;
+   int i;
+   apx_latencyHistogram_create(&histogram);
+   for (i = 0; i < 98; i++)
+   {
+      apx_latencyHistogram_add(&histogram, 10u); //bucket [8, 15]
+   }
+   apx_latencyHistogram_add(&histogram, 1000u); //bucket [512, 1023]
+   apx_latencyHistogram_add(&histogram, 5000u); //bucket [4096, 8191]
+   CuAssertUIntEquals(tc, 100u, apx_latencyHistogram_num_samples(&histogram));
+   CuAssertUIntEquals(tc, 15u, apx_latencyHistogram_percentile(&histogram, 50u));
+   CuAssertUIntEquals(tc, 15u, apx_latencyHistogram_percentile(&histogram, 98u));
+   CuAssertUIntEquals(tc, 1023u, apx_latencyHistogram_percentile(&histogram, 99u));
+   CuAssertUIntEquals(tc, 5000u, apx_latencyHistogram_percentile(&histogram, 100u));
+}
+
+static void test_zero_and_very_large_latencies(CuTest* tc)
+{
+   apx_latencyHistogram_t histogram;
+   apx_latencyHistogram_create(&histogram);
+   apx_latencyHistogram_add(&histogram, 0u);
+   apx_latencyHistogram_add(&histogram, UINT32_MAX);
+   CuAssertUIntEquals(tc, 0u, apx_latencyHistogram_percentile(&histogram, 50u));
+   CuAssertUIntEquals(tc, UINT32_MAX, apx_latencyHistogram_percentile(&histogram, 100u));
+}
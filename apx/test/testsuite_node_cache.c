@@ -0,0 +1,163 @@
+//////////////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////////////
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "CuTest.h"
+#include "apx/node_cache.h"
+#include "sha256.h"
+#ifdef MEM_LEAK_CHECK
+#include "CMemLeak.h"
+#endif
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE CONSTANTS AND DATA TYPES
+//////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////////////
+static void test_inserted_definition_is_found_by_digest(CuTest* tc);
+static void test_lookup_requires_matching_size(CuTest* tc);
+static void test_same_definition_is_stored_once(CuTest* tc);
+static void test_least_recently_used_definition_is_evicted(CuTest* tc);
+static void test_definition_larger_than_cache_is_not_stored(CuTest* tc);
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE VARIABLES
+//////////////////////////////////////////////////////////////////////////////
+static const char* m_node1_text =
+   "APX/1.2\n"
+   "N\"TestNode1\"\n"
+   "P\"ProvidePort1\"C(0,3):=3\n";
+static const char* m_node2_text =
+   "APX/1.2\n"
+   "N\"TestNode2\"\n"
+   "R\"RequirePort1\"C(0,3):=3\n";
+static const char* m_node3_text =
+   "APX/1.2\n"
+   "N\"TestNode3\"\n"
+   "R\"RequirePort2\"C(0,3):=3\n";
+
+//////////////////////////////////////////////////////////////////////////////
+// PUBLIC FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+CuSuite* testSuite_apx_nodeCache(void)
+{
+   CuSuite* suite = CuSuiteNew();
+
+   SUITE_ADD_TEST(suite, test_inserted_definition_is_found_by_digest);
+   SUITE_ADD_TEST(suite, test_lookup_requires_matching_size);
+   SUITE_ADD_TEST(suite, test_same_definition_is_stored_once);
+   SUITE_ADD_TEST(suite, test_least_recently_used_definition_is_evicted);
+   SUITE_ADD_TEST(suite, test_definition_larger_than_cache_is_not_stored);
+
+   return suite;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+static void test_inserted_definition_is_found_by_digest(CuTest* tc)
+{
+   apx_nodeCache_t cache;
+   uint8_t digest[RMF_SHA256_SIZE];
+   uint8_t* data;
+   apx_size_t const size = (apx_size_t)strlen(m_node1_text);
+   sha256_calc(&digest[0], m_node1_text, (size_t)size);
+   apx_nodeCache_create(&cache, APX_SERVER_MODE);
+
+   CuAssertFalse(tc, apx_nodeCache_contains(&cache, &digest[0], size));
+   CuAssertPtrEquals(tc, NULL, apx_nodeCache_take_definition_copy(&cache, &digest[0], size));
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_nodeCache_insert(&cache, (uint8_t const*)m_node1_text, size));
+   CuAssertTrue(tc, apx_nodeCache_contains(&cache, &digest[0], size));
+   data = apx_nodeCache_take_definition_copy(&cache, &digest[0], size);
+   CuAssertPtrNotNull(tc, data);
+   CuAssertTrue(tc, memcmp(data, m_node1_text, size) == 0);
+   free(data);
+
+   apx_nodeCache_destroy(&cache);
+}
+
+static void test_lookup_requires_matching_size(CuTest* tc)
+{
+   apx_nodeCache_t cache;
+   uint8_t digest[RMF_SHA256_SIZE];
+   apx_size_t const size = (apx_size_t)strlen(m_node1_text);
+   sha256_calc(&digest[0], m_node1_text, (size_t)size);
+   apx_nodeCache_create(&cache, APX_SERVER_MODE);
+
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_nodeCache_insert(&cache, (uint8_t const*)m_node1_text, size));
+   CuAssertFalse(tc, apx_nodeCache_contains(&cache, &digest[0], size + 1u));
+   CuAssertPtrEquals(tc, NULL, apx_nodeCache_take_definition_copy(&cache, &digest[0], size - 1u));
+
+   apx_nodeCache_destroy(&cache);
+}
+
+static void test_same_definition_is_stored_once(CuTest* tc)
+{
+   apx_nodeCache_t cache;
+   apx_size_t const size = (apx_size_t)strlen(m_node1_text);
+   apx_nodeCache_create(&cache, APX_SERVER_MODE);
+
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_nodeCache_insert(&cache, (uint8_t const*)m_node1_text, size));
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_nodeCache_insert(&cache, (uint8_t const*)m_node1_text, size));
+   CuAssertUIntEquals(tc, 1u, apx_nodeCache_length(&cache));
+   CuAssertUIntEquals(tc, size, cache.total_size);
+
+   apx_nodeCache_destroy(&cache);
+}
+
+static void test_least_recently_used_definition_is_evicted(CuTest* tc)
+{
+   apx_nodeCache_t cache;
+   uint8_t digest1[RMF_SHA256_SIZE];
+   uint8_t digest2[RMF_SHA256_SIZE];
+   uint8_t digest3[RMF_SHA256_SIZE];
+   uint8_t* data;
+   apx_size_t const size1 = (apx_size_t)strlen(m_node1_text);
+   apx_size_t const size2 = (apx_size_t)strlen(m_node2_text);
+   apx_size_t const size3 = (apx_size_t)strlen(m_node3_text);
+   sha256_calc(&digest1[0], m_node1_text, (size_t)size1);
+   sha256_calc(&digest2[0], m_node2_text, (size_t)size2);
+   sha256_calc(&digest3[0], m_node3_text, (size_t)size3);
+   apx_nodeCache_create(&cache, APX_SERVER_MODE);
+   apx_nodeCache_set_max_size(&cache, size1 + size2);
+
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_nodeCache_insert(&cache, (uint8_t const*)m_node1_text, size1));
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_nodeCache_insert(&cache, (uint8_t const*)m_node2_text, size2));
+   //Reading node1 makes node2 the least recently used entry
+   data = apx_nodeCache_take_definition_copy(&cache, &digest1[0], size1);
+   CuAssertPtrNotNull(tc, data);
+   free(data);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_nodeCache_insert(&cache, (uint8_t const*)m_node3_text, size3));
+   CuAssertUIntEquals(tc, 2u, apx_nodeCache_length(&cache));
+   CuAssertTrue(tc, apx_nodeCache_contains(&cache, &digest1[0], size1));
+   CuAssertFalse(tc, apx_nodeCache_contains(&cache, &digest2[0], size2));
+   CuAssertTrue(tc, apx_nodeCache_contains(&cache, &digest3[0], size3));
+
+   //Shrinking the cache evicts immediately
+   apx_nodeCache_set_max_size(&cache, size3);
+   CuAssertUIntEquals(tc, 1u, apx_nodeCache_length(&cache));
+   CuAssertTrue(tc, apx_nodeCache_contains(&cache, &digest3[0], size3));
+
+   apx_nodeCache_destroy(&cache);
+}
+
+static void test_definition_larger_than_cache_is_not_stored(CuTest* tc)
+{
+   apx_nodeCache_t* cache = apx_nodeCache_new(APX_SERVER_MODE);
+   apx_size_t const size = (apx_size_t)strlen(m_node1_text);
+   CuAssertPtrNotNull(tc, cache);
+   apx_nodeCache_set_max_size(cache, size - 1u);
+
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_nodeCache_insert(cache, (uint8_t const*)m_node1_text, size));
+   CuAssertUIntEquals(tc, 0u, apx_nodeCache_length(cache));
+   CuAssertIntEquals(tc, APX_INVALID_ARGUMENT_ERROR, apx_nodeCache_insert(cache, NULL, size));
+
+   apx_nodeCache_delete(cache);
+}
@@ -21,6 +21,7 @@
 static void test_create_empty_node_data(CuTest *tc);
 static void test_write_provide_port_data_uint8(CuTest* tc);
 static void test_write_provide_port_data_uint16(CuTest* tc);
+static void test_update_provide_port_data_detects_changes(CuTest* tc);
 static void test_write_require_port_data_uint8(CuTest* tc);
 static void test_write_require_port_data_uint16(CuTest* tc);
 static void test_take_provide_port_data_snapshot(CuTest* tc);
@@ -40,6 +41,7 @@ CuSuite* testSuite_apx_nodeData(void)
    SUITE_ADD_TEST(suite, test_create_empty_node_data);
    SUITE_ADD_TEST(suite, test_write_provide_port_data_uint8);
    SUITE_ADD_TEST(suite, test_write_provide_port_data_uint16);
+   SUITE_ADD_TEST(suite, test_update_provide_port_data_detects_changes);
    SUITE_ADD_TEST(suite, test_write_require_port_data_uint8);
    SUITE_ADD_TEST(suite, test_write_require_port_data_uint16);
    SUITE_ADD_TEST(suite, test_take_provide_port_data_snapshot);
@@ -99,6 +101,31 @@ static void test_write_provide_port_data_uint16(CuTest* tc)
    apx_nodeData_delete(node_data);
 }
 
+static void test_update_provide_port_data_detects_changes(CuTest* tc)
+{
+   apx_nodeData_t* node_data;
+   uint8_t const init_data[UINT16_SIZE * 2] = { 0xffu, 0xffu, 0x00u, 0x00u };
+   uint8_t buf[sizeof(init_data)];
+   uint8_t new_value[UINT16_SIZE] = { 0x34u, 0x12u };
+   bool is_changed = false;
+   node_data = apx_nodeData_new();
+   memset(buf, 0, sizeof(buf));
+   CuAssertPtrNotNull(tc, node_data);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_nodeData_create_provide_port_data(node_data, 2u, init_data, sizeof(init_data)));
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_nodeData_update_provide_port_data(node_data, UINT16_SIZE, &init_data[UINT16_SIZE], UINT16_SIZE, &is_changed));
+   CuAssertFalse(tc, is_changed);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_nodeData_update_provide_port_data(node_data, 0u, new_value, sizeof(new_value), &is_changed));
+   CuAssertTrue(tc, is_changed);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_nodeData_read_provide_port_data(node_data, 0u, buf, sizeof(buf)));
+   CuAssertUIntEquals(tc, 0x34, buf[0]);
+   CuAssertUIntEquals(tc, 0x12, buf[1]);
+   CuAssertUIntEquals(tc, 0x00, buf[2]);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_nodeData_update_provide_port_data(node_data, 0u, new_value, sizeof(new_value), &is_changed));
+   CuAssertFalse(tc, is_changed);
+   CuAssertIntEquals(tc, APX_INVALID_ARGUMENT_ERROR, apx_nodeData_update_provide_port_data(node_data, UINT16_SIZE + 1u, new_value, sizeof(new_value), &is_changed));
+   apx_nodeData_delete(node_data);
+}
+
 static void test_write_require_port_data_uint8(CuTest* tc)
 {
    apx_nodeData_t* node_data;
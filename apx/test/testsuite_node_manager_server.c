@@ -26,6 +26,11 @@ static void test_port_signature_uint8(CuTest* tc);
 static void test_port_signature_uint8_with_limits(CuTest* tc);
 static void test_port_signature_uint8_array(CuTest* tc);
 static void test_port_signature_dynamic_uint8_array(CuTest* tc);
+static void test_dynamic_array_port_current_data_size(CuTest* tc);
+static void test_definition_written_in_fragments_is_parsed_while_it_arrives(CuTest* tc);
+static void test_interrupted_definition_stream_is_parsed_when_complete(CuTest* tc);
+static apx_nodeInstance_t* init_node_instance(CuTest* tc, apx_nodeManager_t* manager, char const* file_name, apx_size_t definition_size);
+static void write_definition_fragment(CuTest* tc, apx_nodeManager_t* manager, apx_nodeInstance_t* node_instance, char const* apx_text, uint32_t offset, apx_size_t size);
 
 //////////////////////////////////////////////////////////////////////////////
 // PRIVATE VARIABLES
@@ -45,6 +50,9 @@ CuSuite* testSuite_apx_nodeManager_server_mode(void)
    SUITE_ADD_TEST(suite, test_port_signature_uint8_with_limits);
    SUITE_ADD_TEST(suite, test_port_signature_uint8_array);
    SUITE_ADD_TEST(suite, test_port_signature_dynamic_uint8_array);
+   SUITE_ADD_TEST(suite, test_dynamic_array_port_current_data_size);
+   SUITE_ADD_TEST(suite, test_definition_written_in_fragments_is_parsed_while_it_arrives);
+   SUITE_ADD_TEST(suite, test_interrupted_definition_stream_is_parsed_when_complete);
 
    return suite;
 }
@@ -241,3 +249,127 @@ static void test_port_signature_dynamic_uint8_array(CuTest* tc)
    CuAssertStrEquals(tc, "\"TestPort\"C[*]", apx_portInstance_get_port_signature(port, &has_dynamic_data));
    apx_nodeManager_delete(manager);
 }
+
+static void test_dynamic_array_port_current_data_size(CuTest* tc)
+{
+   const char* apx_text =
+      "APX/1.3\n"
+      "N\"TestNode\"\n"
+      "P\"FixedPort\"S:=0\n"
+      "P\"U8ArrayPort\"C[100*]:={}\n"
+      "P\"U16ArrayPort\"S[300*]:={}\n";
+   uint8_t const u8_array_data[] = { 3u, 1u, 2u, 3u };
+   uint8_t const u16_array_data[] = { 2u, 0u, 1u, 0u, 2u, 0u };
+   uint8_t const too_long_data[] = { 101u };
+
+   apx_nodeManager_t* manager = apx_nodeManager_new(APX_SERVER_MODE);
+   CuAssertPtrNotNull(tc, manager);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_nodeManager_build_node(manager, apx_text));
+   apx_nodeInstance_t* node_instance = apx_nodeManager_get_last_attached(manager);
+   apx_portInstance_t* fixed_port = apx_nodeInstance_get_provide_port(node_instance, 0);
+   apx_portInstance_t* u8_array_port = apx_nodeInstance_get_provide_port(node_instance, 1);
+   apx_portInstance_t* u16_array_port = apx_nodeInstance_get_provide_port(node_instance, 2);
+   CuAssertPtrNotNull(tc, fixed_port);
+   CuAssertPtrNotNull(tc, u8_array_port);
+   CuAssertPtrNotNull(tc, u16_array_port);
+
+   CuAssertFalse(tc, apx_portInstance_is_dynamic_array(fixed_port));
+   CuAssertUIntEquals(tc, UINT16_SIZE, apx_portInstance_current_data_size(fixed_port, u8_array_data, sizeof(u8_array_data)));
+   CuAssertTrue(tc, apx_portInstance_is_dynamic_array(u8_array_port));
+   CuAssertUIntEquals(tc, UINT8_SIZE, apx_portInstance_dynamic_length_size(u8_array_port));
+   CuAssertUIntEquals(tc, sizeof(u8_array_data), apx_portInstance_current_data_size(u8_array_port, u8_array_data, sizeof(u8_array_data)));
+   CuAssertUIntEquals(tc, 0u, apx_portInstance_current_data_size(u8_array_port, too_long_data, sizeof(too_long_data)));
+   CuAssertTrue(tc, apx_portInstance_is_dynamic_array(u16_array_port));
+   CuAssertUIntEquals(tc, UINT16_SIZE, apx_portInstance_dynamic_length_size(u16_array_port));
+   CuAssertUIntEquals(tc, sizeof(u16_array_data), apx_portInstance_current_data_size(u16_array_port, u16_array_data, sizeof(u16_array_data)));
+   apx_nodeManager_delete(manager);
+}
+
+static void test_definition_written_in_fragments_is_parsed_while_it_arrives(CuTest* tc)
+{
+   const char* apx_text =
+      "APX/1.2\n"
+      "N\"TestNode\"\n"
+      "P\"U16Signal\"S:=65535\n"
+      "P\"U8Signal1\"C:=7\n"
+      "R\"U32Signal\"L:=0\n";
+   apx_size_t const definition_size = (apx_size_t)strlen(apx_text);
+   apx_size_t const first_size = 25u; //Ends in the middle of the first port line
+   apx_size_t const second_size = 17u;
+   apx_nodeManager_t* manager = apx_nodeManager_new(APX_SERVER_MODE);
+   apx_nodeInstance_t* node_instance = init_node_instance(tc, manager, "TestNode.apx", definition_size);
+   apx_nodeData_t* node_data = apx_nodeInstance_get_node_data(node_instance);
+
+   write_definition_fragment(tc, manager, node_instance, apx_text, 0u, first_size);
+   CuAssertPtrEquals(tc, node_instance, manager->streaming_node_instance);
+   CuAssertUIntEquals(tc, first_size, manager->streamed_size);
+   CuAssertIntEquals(tc, 2, (int)manager->parser.state.lineno); //The partial line waits in the stream
+   CuAssertUIntEquals(tc, 0u, apx_nodeData_num_provide_ports(node_data));
+
+   write_definition_fragment(tc, manager, node_instance, apx_text, (uint32_t)first_size, second_size);
+   CuAssertUIntEquals(tc, first_size + second_size, manager->streamed_size);
+   CuAssertIntEquals(tc, 3, (int)manager->parser.state.lineno);
+   CuAssertUIntEquals(tc, 0u, apx_nodeData_num_provide_ports(node_data));
+
+   write_definition_fragment(tc, manager, node_instance, apx_text, (uint32_t)(first_size + second_size), definition_size - first_size - second_size);
+   CuAssertPtrEquals(tc, NULL, manager->streaming_node_instance);
+   CuAssertUIntEquals(tc, 2u, apx_nodeData_num_provide_ports(node_data));
+   CuAssertUIntEquals(tc, 1u, apx_nodeData_num_require_ports(node_data));
+   CuAssertUIntEquals(tc, UINT16_SIZE + UINT8_SIZE, apx_nodeData_provide_port_data_size(node_data));
+   CuAssertUIntEquals(tc, UINT32_SIZE, apx_nodeData_require_port_data_size(node_data));
+   apx_nodeManager_delete(manager);
+}
+
+static void test_interrupted_definition_stream_is_parsed_when_complete(CuTest* tc)
+{
+   const char* apx_text1 =
+      "APX/1.2\n"
+      "N\"TestNode1\"\n"
+      "P\"U8Signal1\"C:=7\n"
+      "P\"U8Signal2\"C:=15\n";
+   const char* apx_text2 =
+      "APX/1.2\n"
+      "N\"TestNode2\"\n"
+      "R\"U8Signal1\"C:=7\n";
+   apx_size_t const definition_size1 = (apx_size_t)strlen(apx_text1);
+   apx_size_t const definition_size2 = (apx_size_t)strlen(apx_text2);
+   apx_size_t const first_size = 30u;
+   apx_nodeManager_t* manager = apx_nodeManager_new(APX_SERVER_MODE);
+   apx_nodeInstance_t* node_instance1 = init_node_instance(tc, manager, "TestNode1.apx", definition_size1);
+   apx_nodeInstance_t* node_instance2 = init_node_instance(tc, manager, "TestNode2.apx", definition_size2);
+
+   write_definition_fragment(tc, manager, node_instance1, apx_text1, 0u, first_size);
+   CuAssertPtrEquals(tc, node_instance1, manager->streaming_node_instance);
+   //A complete write of another definition takes over the parser
+   write_definition_fragment(tc, manager, node_instance2, apx_text2, 0u, definition_size2);
+   CuAssertPtrEquals(tc, NULL, manager->streaming_node_instance);
+   CuAssertUIntEquals(tc, 1u, apx_nodeData_num_require_ports(apx_nodeInstance_get_node_data(node_instance2)));
+
+   write_definition_fragment(tc, manager, node_instance1, apx_text1, (uint32_t)first_size, definition_size1 - first_size);
+   CuAssertPtrEquals(tc, NULL, manager->streaming_node_instance);
+   CuAssertUIntEquals(tc, 2u, apx_nodeData_num_provide_ports(apx_nodeInstance_get_node_data(node_instance1)));
+   CuAssertUIntEquals(tc, 2u, apx_nodeManager_length(manager));
+   apx_nodeManager_delete(manager);
+}
+
+static apx_nodeInstance_t* init_node_instance(CuTest* tc, apx_nodeManager_t* manager, char const* file_name, apx_size_t definition_size)
+{
+   bool file_open_request = false;
+   apx_nodeInstance_t* node_instance;
+   rmf_fileInfo_t* file_info = rmf_fileInfo_make_fixed(file_name, (uint32_t)definition_size, APX_DEFINITION_ADDRESS_START);
+   CuAssertPtrNotNull(tc, file_info);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_nodeManager_init_node_from_file_info(manager, file_info, &file_open_request));
+   CuAssertTrue(tc, file_open_request);
+   rmf_fileInfo_delete(file_info);
+   node_instance = apx_nodeManager_get_last_attached(manager);
+   CuAssertPtrNotNull(tc, node_instance);
+   return node_instance;
+}
+
+static void write_definition_fragment(CuTest* tc, apx_nodeManager_t* manager, apx_nodeInstance_t* node_instance, char const* apx_text, uint32_t offset, apx_size_t size)
+{
+   apx_nodeData_t* node_data = apx_nodeInstance_get_node_data(node_instance);
+   CuAssertPtrNotNull(tc, node_data);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_nodeData_write_definition_data(node_data, offset, (uint8_t const*)&apx_text[offset], size));
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_nodeManager_on_definition_data_written(manager, node_instance, offset, size));
+}
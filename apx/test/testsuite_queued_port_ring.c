@@ -0,0 +1,186 @@
+//////////////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////////////
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "CuTest.h"
+#include "apx/queued_port_ring.h"
+#ifdef MEM_LEAK_CHECK
+#include "CMemLeak.h"
+#endif
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE CONSTANTS AND DATA TYPES
+//////////////////////////////////////////////////////////////////////////////
+#define ELEMENT_SIZE 2u
+#define QUEUE_LENGTH 3u
+#define BATCH_SIZE (UINT8_SIZE + QUEUE_LENGTH * ELEMENT_SIZE)
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////////////
+static void test_create_rejects_invalid_arguments(CuTest* tc);
+static void test_batch_size_matches_queued_data_encoding(CuTest* tc);
+static void test_elements_are_delivered_in_order_in_batches(CuTest* tc);
+static void test_drain_is_requested_once_until_consumer_begins_drain(CuTest* tc);
+static void test_full_ring_drops_and_counts_new_elements(CuTest* tc);
+static void test_push_rejects_invalid_length(CuTest* tc);
+static void push_elements(CuTest* tc, apx_queuedPortRing_t* ring, uint16_t first_value, uint8_t num_elements, uint32_t expected_dropped);
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE VARIABLES
+//////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////
+// PUBLIC FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+CuSuite* testSuite_apx_queuedPortRing(void)
+{
+   CuSuite* suite = CuSuiteNew();
+
+   SUITE_ADD_TEST(suite, test_create_rejects_invalid_arguments);
+   SUITE_ADD_TEST(suite, test_batch_size_matches_queued_data_encoding);
+   SUITE_ADD_TEST(suite, test_elements_are_delivered_in_order_in_batches);
+   SUITE_ADD_TEST(suite, test_drain_is_requested_once_until_consumer_begins_drain);
+   SUITE_ADD_TEST(suite, test_full_ring_drops_and_counts_new_elements);
+   SUITE_ADD_TEST(suite, test_push_rejects_invalid_length);
+
+   return suite;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+static void test_create_rejects_invalid_arguments(CuTest* tc)
+{
+   apx_queuedPortRing_t ring;
+   CuAssertIntEquals(tc, APX_INVALID_ARGUMENT_ERROR, apx_queuedPortRing_create(&ring, 0u, QUEUE_LENGTH));
+   CuAssertIntEquals(tc, APX_INVALID_ARGUMENT_ERROR, apx_queuedPortRing_create(&ring, ELEMENT_SIZE, 0u));
+   CuAssertPtrEquals(tc, NULL, apx_queuedPortRing_new(ELEMENT_SIZE, 0u));
+}
+
+static void test_batch_size_matches_queued_data_encoding(CuTest* tc)
+{
+   apx_queuedPortRing_t* ring = apx_queuedPortRing_new(ELEMENT_SIZE, QUEUE_LENGTH);
+   CuAssertPtrNotNull(tc, ring);
+   CuAssertUIntEquals(tc, BATCH_SIZE, apx_queuedPortRing_batch_size(ring));
+   CuAssertUIntEquals(tc, 16u, ring->capacity);
+   apx_queuedPortRing_delete(ring);
+
+   ring = apx_queuedPortRing_new(1u, 300u);
+   CuAssertPtrNotNull(tc, ring);
+   CuAssertUIntEquals(tc, UINT16_SIZE + 300u, apx_queuedPortRing_batch_size(ring));
+   apx_queuedPortRing_delete(ring);
+}
+
+static void test_elements_are_delivered_in_order_in_batches(CuTest* tc)
+{
+   apx_queuedPortRing_t* ring = apx_queuedPortRing_new(ELEMENT_SIZE, QUEUE_LENGTH);
+   uint8_t batch[BATCH_SIZE];
+   uint8_t const expected_first[BATCH_SIZE] = { 3u, 0x01u, 0x10u, 0x02u, 0x10u, 0x03u, 0x10u };
+   uint8_t const expected_second[BATCH_SIZE] = { 2u, 0x04u, 0x10u, 0x05u, 0x10u, 0u, 0u };
+   CuAssertPtrNotNull(tc, ring);
+
+   push_elements(tc, ring, 0x1001u, 2u, 0u);
+   push_elements(tc, ring, 0x1003u, 3u, 0u);
+   CuAssertUIntEquals(tc, 5u, apx_queuedPortRing_num_elements(ring));
+
+   apx_queuedPortRing_begin_drain(ring);
+   CuAssertUIntEquals(tc, 3u, apx_queuedPortRing_pop_batch(ring, batch));
+   CuAssertTrue(tc, memcmp(expected_first, batch, BATCH_SIZE) == 0);
+   CuAssertUIntEquals(tc, 2u, apx_queuedPortRing_pop_batch(ring, batch));
+   CuAssertTrue(tc, memcmp(expected_second, batch, BATCH_SIZE) == 0);
+   CuAssertUIntEquals(tc, 0u, apx_queuedPortRing_num_elements(ring));
+   CuAssertUIntEquals(tc, 0u, apx_queuedPortRing_pop_batch(ring, batch));
+   CuAssertUIntEquals(tc, 0u, batch[0]);
+
+   apx_queuedPortRing_delete(ring);
+}
+
+static void test_drain_is_requested_once_until_consumer_begins_drain(CuTest* tc)
+{
+   apx_queuedPortRing_t* ring = apx_queuedPortRing_new(ELEMENT_SIZE, QUEUE_LENGTH);
+   uint8_t data[BATCH_SIZE] = { 1u, 0x01u, 0x00u, 0u, 0u, 0u, 0u };
+   uint8_t const empty[BATCH_SIZE] = { 0u, 0u, 0u, 0u, 0u, 0u, 0u };
+   uint8_t batch[BATCH_SIZE];
+   uint32_t num_dropped = 0u;
+   bool needs_drain = false;
+   CuAssertPtrNotNull(tc, ring);
+
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_queuedPortRing_push(ring, empty, BATCH_SIZE, &num_dropped, &needs_drain));
+   CuAssertFalse(tc, needs_drain);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_queuedPortRing_push(ring, data, BATCH_SIZE, &num_dropped, &needs_drain));
+   CuAssertTrue(tc, needs_drain);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_queuedPortRing_push(ring, data, BATCH_SIZE, &num_dropped, &needs_drain));
+   CuAssertFalse(tc, needs_drain);
+
+   apx_queuedPortRing_begin_drain(ring);
+   CuAssertUIntEquals(tc, 2u, apx_queuedPortRing_pop_batch(ring, batch));
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_queuedPortRing_push(ring, data, BATCH_SIZE, &num_dropped, &needs_drain));
+   CuAssertTrue(tc, needs_drain);
+
+   apx_queuedPortRing_delete(ring);
+}
+
+static void test_full_ring_drops_and_counts_new_elements(CuTest* tc)
+{
+   apx_queuedPortRing_t* ring = apx_queuedPortRing_new(ELEMENT_SIZE, QUEUE_LENGTH);
+   uint8_t batch[BATCH_SIZE];
+   int i;
+   CuAssertPtrNotNull(tc, ring);
+
+   for (i = 0; i < 5; i++)
+   {
+      push_elements(tc, ring, (uint16_t)(i * 3), 3u, 0u);
+   }
+   push_elements(tc, ring, 15u, 3u, 2u);
+   CuAssertUIntEquals(tc, 16u, apx_queuedPortRing_num_elements(ring));
+   CuAssertUIntEquals(tc, 2u, apx_queuedPortRing_num_overflows(ring));
+
+   //Oldest elements are kept
+   apx_queuedPortRing_begin_drain(ring);
+   CuAssertUIntEquals(tc, 3u, apx_queuedPortRing_pop_batch(ring, batch));
+   CuAssertUIntEquals(tc, 0u, batch[1]);
+   push_elements(tc, ring, 100u, 3u, 0u);
+   CuAssertUIntEquals(tc, 2u, apx_queuedPortRing_num_overflows(ring));
+
+   apx_queuedPortRing_delete(ring);
+}
+
+static void test_push_rejects_invalid_length(CuTest* tc)
+{
+   apx_queuedPortRing_t* ring = apx_queuedPortRing_new(ELEMENT_SIZE, QUEUE_LENGTH);
+   uint8_t data[BATCH_SIZE] = { 4u, 0u, 0u, 0u, 0u, 0u, 0u };
+   uint32_t num_dropped = 0u;
+   bool needs_drain = false;
+   CuAssertPtrNotNull(tc, ring);
+
+   CuAssertIntEquals(tc, APX_VALUE_LENGTH_ERROR, apx_queuedPortRing_push(ring, data, BATCH_SIZE, &num_dropped, &needs_drain));
+   data[0] = 3u;
+   CuAssertIntEquals(tc, APX_VALUE_LENGTH_ERROR, apx_queuedPortRing_push(ring, data, BATCH_SIZE - 1u, &num_dropped, &needs_drain));
+   CuAssertUIntEquals(tc, 0u, apx_queuedPortRing_num_elements(ring));
+
+   apx_queuedPortRing_delete(ring);
+}
+
+static void push_elements(CuTest* tc, apx_queuedPortRing_t* ring, uint16_t first_value, uint8_t num_elements, uint32_t expected_dropped)
+{
+   uint8_t data[BATCH_SIZE];
+   uint32_t num_dropped = 0u;
+   bool needs_drain = false;
+   uint8_t i;
+   memset(data, 0, sizeof(data));
+   data[0] = num_elements;
+   for (i = 0u; i < num_elements; i++)
+   {
+      uint16_t const value = (uint16_t)(first_value + i);
+      data[UINT8_SIZE + i * ELEMENT_SIZE] = (uint8_t)value;
+      data[UINT8_SIZE + i * ELEMENT_SIZE + 1u] = (uint8_t)(value >> 8);
+   }
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_queuedPortRing_push(ring, data, BATCH_SIZE, &num_dropped, &needs_drain));
+   CuAssertUIntEquals(tc, expected_dropped, num_dropped);
+}
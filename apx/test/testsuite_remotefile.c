@@ -25,6 +25,7 @@ static void test_low_address_encode(CuTest* tc);
 static void test_low_address_decode(CuTest* tc);
 static void test_high_address_encode(CuTest* tc);
 static void test_high_address_decode(CuTest* tc);
+static void test_compressed_msg_header_encode_decode(CuTest* tc);
 
 
 //////////////////////////////////////////////////////////////////////////////
@@ -49,6 +50,7 @@ CuSuite* testSuite_remotefile(void)
    SUITE_ADD_TEST(suite, test_low_address_decode);
    SUITE_ADD_TEST(suite, test_high_address_encode);
    SUITE_ADD_TEST(suite, test_high_address_decode);
+   SUITE_ADD_TEST(suite, test_compressed_msg_header_encode_decode);
 
    return suite;
 }
@@ -145,3 +147,27 @@ static void test_high_address_decode(CuTest* tc)
    CuAssertUIntEquals(tc, RMF_HIGH_ADDR_MAX, address);
    CuAssertTrue(tc, more_bit);
 }
+
+static void test_compressed_msg_header_encode_decode(CuTest* tc)
+{
+   uint8_t buffer[RMF_COMPRESSED_MSG_HEADER_MAX_SIZE];
+   uint8_t const expected_low[RMF_CMD_TYPE_SIZE + UINT16_SIZE + UINT32_SIZE] = { 12u, 0u, 0u, 0u, 0x40u, 0x10u, 0x00u, 0x01u, 0u, 0u };
+   uint32_t address = 0u;
+   uint32_t uncompressed_size = 0u;
+   bool more_bit = false;
+   CuAssertUIntEquals(tc, sizeof(expected_low), rmf_encode_compressed_msg_header(buffer, (apx_size_t)sizeof(buffer), 0x10u, true, 256u));
+   CuAssertTrue(tc, memcmp(expected_low, buffer, sizeof(expected_low)) == 0);
+   CuAssertUIntEquals(tc, sizeof(expected_low), rmf_decode_compressed_msg_header(buffer, buffer + sizeof(expected_low), &address, &more_bit, &uncompressed_size));
+   CuAssertUIntEquals(tc, 0x10u, address);
+   CuAssertTrue(tc, more_bit);
+   CuAssertUIntEquals(tc, 256u, uncompressed_size);
+
+   CuAssertUIntEquals(tc, RMF_COMPRESSED_MSG_HEADER_MAX_SIZE, rmf_encode_compressed_msg_header(buffer, (apx_size_t)sizeof(buffer), RMF_HIGH_ADDR_MIN, false, 100000u));
+   CuAssertUIntEquals(tc, RMF_COMPRESSED_MSG_HEADER_MAX_SIZE, rmf_decode_compressed_msg_header(buffer, buffer + sizeof(buffer), &address, &more_bit, &uncompressed_size));
+   CuAssertUIntEquals(tc, RMF_HIGH_ADDR_MIN, address);
+   CuAssertFalse(tc, more_bit);
+   CuAssertUIntEquals(tc, 100000u, uncompressed_size);
+   //Truncated header
+   CuAssertUIntEquals(tc, 0u, rmf_decode_compressed_msg_header(buffer, buffer + sizeof(buffer) - 1u, &address, &more_bit, &uncompressed_size));
+   CuAssertUIntEquals(tc, 0u, rmf_encode_compressed_msg_header(buffer, (apx_size_t)sizeof(buffer) - 1u, RMF_HIGH_ADDR_MIN, false, 0u));
+}
@@ -0,0 +1,234 @@
+//////////////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////////////
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "CuTest.h"
+#include "apx/routing_engine.h"
+#include "apx/server.h"
+#include "apx/server_test_connection.h"
+#ifdef MEM_LEAK_CHECK
+#include "CMemLeak.h"
+#endif
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE CONSTANTS AND DATA TYPES
+//////////////////////////////////////////////////////////////////////////////
+#define VEHICLE_SPEED_SIGNATURE "\"VehicleSpeed\"S"
+#define ENGINE_SPEED_SIGNATURE "\"EngineSpeed\"S"
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////////////
+static void test_create_rejects_invalid_number_of_shards(CuTest* tc);
+static void test_shard_of_is_stable_and_in_range(CuTest* tc);
+static void test_pinned_signature_overrides_hash(CuTest* tc);
+static void test_server_routing_shard_configuration(CuTest* tc);
+static void test_provide_port_data_is_routed_by_shard(CuTest* tc);
+static void test_flush_routes_queued_data(CuTest* tc);
+static apx_serverTestConnection_t* connect_provider(CuTest* tc, apx_server_t* server);
+static apx_serverTestConnection_t* connect_requester(CuTest* tc, apx_server_t* server);
+static uint16_t read_requester_value(apx_serverTestConnection_t* connection);
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE VARIABLES
+//////////////////////////////////////////////////////////////////////////////
+static const char* m_provider_definition = "APX/1.2\n"
+"N\"Provider1\"\n"
+"P\"VehicleSpeed\"S:=65535\n"
+"\n";
+
+static const char* m_requester_definition = "APX/1.2\n"
+"N\"Requester1\"\n"
+"R\"VehicleSpeed\"S:=65535\n"
+"\n";
+
+//////////////////////////////////////////////////////////////////////////////
+// PUBLIC FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+CuSuite* testSuite_apx_routingEngine(void)
+{
+   CuSuite* suite = CuSuiteNew();
+
+   SUITE_ADD_TEST(suite, test_create_rejects_invalid_number_of_shards);
+   SUITE_ADD_TEST(suite, test_shard_of_is_stable_and_in_range);
+   SUITE_ADD_TEST(suite, test_pinned_signature_overrides_hash);
+   SUITE_ADD_TEST(suite, test_server_routing_shard_configuration);
+   SUITE_ADD_TEST(suite, test_provide_port_data_is_routed_by_shard);
+   SUITE_ADD_TEST(suite, test_flush_routes_queued_data);
+
+   return suite;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+static void test_create_rejects_invalid_number_of_shards(CuTest* tc)
+{
+   apx_routingEngine_t engine;
+   CuAssertIntEquals(tc, APX_INVALID_ARGUMENT_ERROR, apx_routingEngine_create(&engine, 0u));
+   CuAssertIntEquals(tc, APX_INVALID_ARGUMENT_ERROR, apx_routingEngine_create(&engine, APX_ROUTING_ENGINE_MAX_SHARDS + 1u));
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_routingEngine_create(&engine, 4u));
+   CuAssertUIntEquals(tc, 4u, apx_routingEngine_num_shards(&engine));
+   apx_routingEngine_destroy(&engine);
+}
+
+static void test_shard_of_is_stable_and_in_range(CuTest* tc)
+{
+   apx_routingEngine_t* engine = apx_routingEngine_new(3u);
+   uint32_t shard_id;
+   CuAssertPtrNotNull(tc, engine);
+   shard_id = apx_routingEngine_shard_of(engine, VEHICLE_SPEED_SIGNATURE);
+   CuAssertTrue(tc, shard_id < 3u);
+   CuAssertUIntEquals(tc, shard_id, apx_routingEngine_shard_of(engine, VEHICLE_SPEED_SIGNATURE));
+   CuAssertTrue(tc, apx_routingEngine_shard_of(engine, ENGINE_SPEED_SIGNATURE) < 3u);
+   apx_routingEngine_delete(engine);
+}
+
+static void test_pinned_signature_overrides_hash(CuTest* tc)
+{
+   apx_routingEngine_t* engine = apx_routingEngine_new(8u);
+   uint32_t hashed_shard_id;
+   uint32_t pinned_shard_id;
+   CuAssertPtrNotNull(tc, engine);
+   hashed_shard_id = apx_routingEngine_shard_of(engine, VEHICLE_SPEED_SIGNATURE);
+   pinned_shard_id = (hashed_shard_id + 1u) % 8u;
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_routingEngine_pin_signature(engine, VEHICLE_SPEED_SIGNATURE, pinned_shard_id));
+   CuAssertUIntEquals(tc, pinned_shard_id, apx_routingEngine_shard_of(engine, VEHICLE_SPEED_SIGNATURE));
+   CuAssertIntEquals(tc, APX_INVALID_ARGUMENT_ERROR, apx_routingEngine_pin_signature(engine, ENGINE_SPEED_SIGNATURE, 8u));
+   apx_routingEngine_delete(engine);
+}
+
+static void test_server_routing_shard_configuration(CuTest* tc)
+{
+   apx_server_t* server = apx_server_new();
+   CuAssertPtrNotNull(tc, server);
+   CuAssertPtrEquals(tc, NULL, apx_server_get_routing_engine(server));
+   CuAssertIntEquals(tc, APX_INVALID_STATE_ERROR, apx_server_pin_routing_signature(server, VEHICLE_SPEED_SIGNATURE, 0u));
+   CuAssertIntEquals(tc, APX_INVALID_ARGUMENT_ERROR, apx_server_enable_routing_shards(server, APX_ROUTING_ENGINE_MAX_SHARDS + 1u));
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_server_enable_routing_shards(server, 2u));
+   CuAssertPtrNotNull(tc, apx_server_get_routing_engine(server));
+   CuAssertIntEquals(tc, APX_INVALID_STATE_ERROR, apx_server_enable_routing_shards(server, 2u));
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_server_pin_routing_signature(server, VEHICLE_SPEED_SIGNATURE, 1u));
+   CuAssertIntEquals(tc, APX_INVALID_ARGUMENT_ERROR, apx_server_pin_routing_signature(server, VEHICLE_SPEED_SIGNATURE, 2u));
+   apx_server_delete(server);
+}
+
+static void test_provide_port_data_is_routed_by_shard(CuTest* tc)
+{
+   apx_server_t* server;
+   apx_serverTestConnection_t* provider_connection;
+   apx_serverTestConnection_t* requester_connection;
+   apx_routingEngine_t* engine;
+   apx_routingShardStats_t stats;
+   uint32_t num_updates;
+   uint8_t const provide_port_data[UINT16_SIZE] = { 0x78u, 0x56u };
+
+   server = apx_server_new();
+   CuAssertPtrNotNull(tc, server);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_server_enable_routing_shards(server, 2u));
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_server_pin_routing_signature(server, VEHICLE_SPEED_SIGNATURE, 1u));
+   engine = apx_server_get_routing_engine(server);
+   provider_connection = connect_provider(tc, server);
+   requester_connection = connect_requester(tc, server);
+   CuAssertUIntEquals(tc, 0x1234u, read_requester_value(requester_connection));
+   (void)apx_routingEngine_run(engine);
+   memset(&stats, 0, sizeof(stats));
+   apx_routingEngine_get_shard_stats(engine, 1u, &stats);
+   num_updates = stats.num_updates;
+
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_serverTestConnection_write_remote_data(provider_connection, APX_PORT_DATA_ADDRESS_START, provide_port_data, UINT16_SIZE));
+   CuAssertUIntEquals(tc, 0x1234u, read_requester_value(requester_connection)); //Not routed until the shard runs
+   CuAssertIntEquals(tc, 1, apx_routingEngine_run(engine));
+   CuAssertUIntEquals(tc, 0x1234u, read_requester_value(requester_connection)); //Not applied until the requester connection runs
+   apx_serverTestConnection_run(requester_connection);
+   CuAssertUIntEquals(tc, 0x5678u, read_requester_value(requester_connection));
+   CuAssertIntEquals(tc, 1, apx_serverTestConnection_log_length(requester_connection));
+   apx_routingEngine_get_shard_stats(engine, 1u, &stats);
+   CuAssertUIntEquals(tc, num_updates + 1u, stats.num_updates);
+   apx_routingEngine_get_shard_stats(engine, 0u, &stats);
+   CuAssertUIntEquals(tc, 0u, stats.num_updates);
+   apx_server_delete(server);
+}
+
+static void test_flush_routes_queued_data(CuTest* tc)
+{
+   apx_server_t* server;
+   apx_serverTestConnection_t* provider_connection;
+   apx_serverTestConnection_t* requester_connection;
+   apx_routingEngine_t* engine;
+   uint8_t const first_data[UINT16_SIZE] = { 0x01u, 0x00u };
+   uint8_t const second_data[UINT16_SIZE] = { 0x02u, 0x00u };
+
+   server = apx_server_new();
+   CuAssertPtrNotNull(tc, server);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_server_enable_routing_shards(server, 4u));
+   engine = apx_server_get_routing_engine(server);
+   provider_connection = connect_provider(tc, server);
+   requester_connection = connect_requester(tc, server);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_serverTestConnection_write_remote_data(provider_connection, APX_PORT_DATA_ADDRESS_START, first_data, UINT16_SIZE));
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_serverTestConnection_write_remote_data(provider_connection, APX_PORT_DATA_ADDRESS_START, second_data, UINT16_SIZE));
+   apx_server_flush_routing(server);
+   apx_serverTestConnection_run(requester_connection);
+   CuAssertUIntEquals(tc, 0x0002u, read_requester_value(requester_connection));
+   CuAssertIntEquals(tc, 0, apx_routingEngine_run(engine));
+   apx_server_delete(server);
+}
+
+static apx_serverTestConnection_t* connect_provider(CuTest* tc, apx_server_t* server)
+{
+   uint8_t const provide_port_data[UINT16_SIZE] = { 0x34u, 0x12u };
+   apx_size_t const definition_size = (apx_size_t)strlen(m_provider_definition);
+   apx_serverTestConnection_t* connection = apx_serverTestConnection_new();
+   CuAssertPtrNotNull(tc, connection);
+   apx_server_accept_connection(server, (apx_serverConnection_t*)connection);
+   CuAssertUIntEquals(tc, APX_NO_ERROR, apx_serverTestConnection_send_greeting_header(connection));
+   apx_serverTestConnection_run(connection);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_serverTestConnection_publish_remote_file(connection, APX_PORT_DATA_ADDRESS_START, "Provider1.out", UINT16_SIZE));
+   apx_serverTestConnection_run(connection);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_serverTestConnection_publish_remote_file(connection, APX_DEFINITION_ADDRESS_START, "Provider1.apx", definition_size));
+   apx_serverTestConnection_run(connection);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_serverTestConnection_write_remote_data(connection, APX_DEFINITION_ADDRESS_START, (uint8_t const*)m_provider_definition, definition_size));
+   apx_serverTestConnection_run(connection);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_serverTestConnection_write_remote_data(connection, APX_PORT_DATA_ADDRESS_START, provide_port_data, UINT16_SIZE));
+   apx_serverTestConnection_run(connection);
+   apx_serverTestConnection_clear_log(connection);
+   return connection;
+}
+
+static apx_serverTestConnection_t* connect_requester(CuTest* tc, apx_server_t* server)
+{
+   apx_size_t const definition_size = (apx_size_t)strlen(m_requester_definition);
+   apx_serverTestConnection_t* connection = apx_serverTestConnection_new();
+   CuAssertPtrNotNull(tc, connection);
+   apx_server_accept_connection(server, (apx_serverConnection_t*)connection);
+   CuAssertUIntEquals(tc, APX_NO_ERROR, apx_serverTestConnection_send_greeting_header(connection));
+   apx_serverTestConnection_run(connection);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_serverTestConnection_publish_remote_file(connection, APX_DEFINITION_ADDRESS_START, "Requester1.apx", definition_size));
+   apx_serverTestConnection_run(connection);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_serverTestConnection_write_remote_data(connection, APX_DEFINITION_ADDRESS_START, (uint8_t const*)m_requester_definition, definition_size));
+   apx_serverTestConnection_run(connection);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_serverTestConnection_request_open_local_file(connection, "Requester1.in"));
+   apx_serverTestConnection_run(connection);
+   apx_serverTestConnection_clear_log(connection);
+   return connection;
+}
+
+static uint16_t read_requester_value(apx_serverTestConnection_t* connection)
+{
+   uint16_t value = 0u;
+   apx_nodeManager_t* node_manager = apx_serverTestConnection_get_node_manager(connection);
+   apx_nodeInstance_t* node_instance = apx_nodeManager_find(node_manager, "Requester1");
+   apx_nodeData_t* node_data = apx_nodeInstance_get_node_data(node_instance);
+   uint8_t* snapshot = apx_nodeData_take_require_port_data_snapshot(node_data);
+   if (snapshot != NULL)
+   {
+      value = (uint16_t)snapshot[0] | ((uint16_t)snapshot[1] << 8);
+      free(snapshot);
+   }
+   return value;
+}
@@ -26,6 +26,19 @@ static void test_connectors_connect_disconnect_node_with_only_require_ports(CuTe
 static void test_connectors_connect_disconnect_node_with_only_provide_ports(CuTest* tc);
 static void test_connectors_node_with_require_port_is_connected_after_node_with_provide_port(CuTest* tc);
 static void test_connectors_node_with_provide_port_is_connected_when_multiple_nodes_with_require_ports_are_waiting(CuTest* tc);
+static void test_routed_data_is_applied_by_requester_connection(CuTest* tc);
+static void test_parallel_fanout_routes_data_to_all_requesters(CuTest* tc);
+static void test_change_only_routing_suppresses_identical_values(CuTest* tc);
+static void test_rate_limited_require_port_receives_latest_value_when_interval_expires(CuTest* tc);
+static void test_queued_elements_are_delivered_in_batches(CuTest* tc);
+static void test_queued_elements_that_overflow_are_counted(CuTest* tc);
+static void test_dynamic_array_value_is_routed_without_unused_elements(CuTest* tc);
+static void test_dynamic_array_value_is_zero_filled_for_peer_without_dynamic_files(CuTest* tc);
+static void test_partial_write_is_routed_as_byte_range(CuTest* tc);
+static void test_partial_write_is_routed_as_complete_value_to_peer_without_partial_writes(CuTest* tc);
+static void test_node_cache_can_be_disabled(CuTest* tc);
+static apx_serverTestConnection_t* connect_node(CuTest* tc, apx_server_t* server, const char* node_name, const char* definition, apx_size_t provide_port_data_size);
+static apx_serverTestConnection_t* connect_node_with_greeting_lines(CuTest* tc, apx_server_t* server, const char* node_name, const char* definition, apx_size_t provide_port_data_size, char const* header_lines);
 
 //////////////////////////////////////////////////////////////////////////////
 // GLOBAL VARIABLES
@@ -44,6 +57,44 @@ static const char* m_requester1_definition = "APX/1.2\n"
 "R\"VehicleSpeed\"S:=65535\n"
 "\n";
 
+static const char* m_rate_limited_requester_definition = "APX/1.2\n"
+"N\"Requester1\"\n"
+"R\"VehicleSpeed\"S:=65535,I[100]\n"
+"\n";
+
+static const char* m_queued_provider_definition = "APX/1.2\n"
+"N\"Provider1\"\n"
+"P\"VehicleSpeed\"S:=65535\n"
+"P\"ButtonEvent\"C:Q[4]\n"
+"\n";
+
+static const char* m_queued_requester_definition = "APX/1.2\n"
+"N\"Requester1\"\n"
+"R\"ButtonEvent\"C:Q[4]\n"
+"\n";
+
+static const char* m_dynamic_provider_definition = "APX/1.2\n"
+"N\"Provider1\"\n"
+"P\"VehicleSpeed\"S:=65535\n"
+"P\"Payload\"C[8*]:={}\n"
+"\n";
+
+static const char* m_dynamic_requester_definition = "APX/1.2\n"
+"N\"Requester1\"\n"
+"R\"Payload\"C[8*]:={}\n"
+"\n";
+
+static const char* m_array_provider_definition = "APX/1.2\n"
+"N\"Provider1\"\n"
+"P\"VehicleSpeed\"S:=65535\n"
+"P\"Samples\"C[16]\n"
+"\n";
+
+static const char* m_array_requester_definition = "APX/1.2\n"
+"N\"Requester1\"\n"
+"R\"Samples\"C[16]\n"
+"\n";
+
 static const char* m_requester2_definition = "APX/1.2\n"
 "N\"Requester2\"\n"
 "R\"EngineSpeed\"S:=65535\n"
@@ -64,6 +115,17 @@ CuSuite* testSuite_apx_server(void)
    SUITE_ADD_TEST(suite, test_connectors_connect_disconnect_node_with_only_provide_ports);
    SUITE_ADD_TEST(suite, test_connectors_node_with_require_port_is_connected_after_node_with_provide_port);
    SUITE_ADD_TEST(suite, test_connectors_node_with_provide_port_is_connected_when_multiple_nodes_with_require_ports_are_waiting);
+   SUITE_ADD_TEST(suite, test_routed_data_is_applied_by_requester_connection);
+   SUITE_ADD_TEST(suite, test_parallel_fanout_routes_data_to_all_requesters);
+   SUITE_ADD_TEST(suite, test_change_only_routing_suppresses_identical_values);
+   SUITE_ADD_TEST(suite, test_rate_limited_require_port_receives_latest_value_when_interval_expires);
+   SUITE_ADD_TEST(suite, test_queued_elements_are_delivered_in_batches);
+   SUITE_ADD_TEST(suite, test_queued_elements_that_overflow_are_counted);
+   SUITE_ADD_TEST(suite, test_dynamic_array_value_is_routed_without_unused_elements);
+   SUITE_ADD_TEST(suite, test_dynamic_array_value_is_zero_filled_for_peer_without_dynamic_files);
+   SUITE_ADD_TEST(suite, test_partial_write_is_routed_as_byte_range);
+   SUITE_ADD_TEST(suite, test_partial_write_is_routed_as_complete_value_to_peer_without_partial_writes);
+   SUITE_ADD_TEST(suite, test_node_cache_can_be_disabled);
 
    return suite;
 }
@@ -607,4 +669,461 @@ static void test_connectors_node_with_provide_port_is_connected_when_multiple_no
    apx_serverTestConnection_clear_log(requester2_connection);
 
    apx_server_delete(server);
-}
\ No newline at end of file
+}
+
+static void test_routed_data_is_applied_by_requester_connection(CuTest* tc)
+{
+   apx_server_t* server;
+   apx_serverTestConnection_t* provider_connection;
+   apx_serverTestConnection_t* requester_connection;
+   apx_nodeData_t* requester_node_data;
+   adt_bytearray_t* packet;
+   uint8_t* snapshot;
+   uint8_t provide_port_data[UINT16_SIZE] = { 0x78u, 0x56u };
+   uint8_t data_message[5];
+
+   server = apx_server_new();
+   CuAssertPtrNotNull(tc, server);
+   provider_connection = connect_node(tc, server, "Provider1", m_provider1_definition, UINT16_SIZE);
+   requester_connection = connect_node(tc, server, "Requester1", m_requester1_definition, 0u);
+   requester_node_data = apx_nodeInstance_get_node_data(apx_nodeManager_find(apx_serverTestConnection_get_node_manager(requester_connection), "Requester1"));
+   CuAssertPtrNotNull(tc, requester_node_data);
+
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_serverTestConnection_write_remote_data(provider_connection, APX_PORT_DATA_ADDRESS_START, provide_port_data, UINT16_SIZE));
+   //The provider connection only posts the update, the requester connection applies and sends it
+   snapshot = apx_nodeData_take_require_port_data_snapshot(requester_node_data);
+   CuAssertPtrNotNull(tc, snapshot);
+   CuAssertUIntEquals(tc, 0x34, snapshot[0]);
+   CuAssertUIntEquals(tc, 0x12, snapshot[1]);
+   free(snapshot);
+   CuAssertIntEquals(tc, 0u, apx_serverTestConnection_log_length(requester_connection));
+   apx_serverTestConnection_run(requester_connection);
+   snapshot = apx_nodeData_take_require_port_data_snapshot(requester_node_data);
+   CuAssertPtrNotNull(tc, snapshot);
+   CuAssertUIntEquals(tc, 0x78, snapshot[0]);
+   CuAssertUIntEquals(tc, 0x56, snapshot[1]);
+   free(snapshot);
+   CuAssertIntEquals(tc, 1u, apx_serverTestConnection_log_length(requester_connection));
+   packet = apx_serverTestConnection_get_log_packet(requester_connection, 0);
+   CuAssertPtrNotNull(tc, packet);
+   CuAssertIntEquals(tc, 5, adt_bytearray_length(packet));
+   memcpy(data_message, adt_bytearray_data(packet), sizeof(data_message));
+   CuAssertUIntEquals(tc, 4u, data_message[0]);
+   CuAssertUIntEquals(tc, 0x78, data_message[3]);
+   CuAssertUIntEquals(tc, 0x56, data_message[4]);
+
+   apx_server_delete(server);
+}
+
+static void test_parallel_fanout_routes_data_to_all_requesters(CuTest* tc)
+{
+   apx_server_t* server;
+   apx_serverTestConnection_t* provider_connection;
+   apx_serverTestConnection_t* requester1_connection;
+   apx_serverTestConnection_t* requester2_connection;
+   apx_nodeData_t* requester1_node_data;
+   apx_nodeData_t* requester2_node_data;
+   apx_fanoutPoolStats_t stats;
+   uint8_t* snapshot;
+   uint8_t provide_port_data[UINT16_SIZE] = { 0x78u, 0x56u };
+
+   server = apx_server_new();
+   CuAssertPtrNotNull(tc, server);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_server_enable_parallel_fanout(server, 1u, 2));
+   CuAssertIntEquals(tc, APX_INVALID_STATE_ERROR, apx_server_enable_parallel_fanout(server, 1u, 2));
+   provider_connection = connect_node(tc, server, "Provider1", m_provider1_definition, UINT16_SIZE);
+   requester1_connection = connect_node(tc, server, "Requester1", m_requester1_definition, 0u);
+   requester2_connection = connect_node(tc, server, "Requester2", m_requester2_definition, 0u);
+   requester1_node_data = apx_nodeInstance_get_node_data(apx_nodeManager_find(apx_serverTestConnection_get_node_manager(requester1_connection), "Requester1"));
+   requester2_node_data = apx_nodeInstance_get_node_data(apx_nodeManager_find(apx_serverTestConnection_get_node_manager(requester2_connection), "Requester2"));
+   CuAssertPtrNotNull(tc, requester1_node_data);
+   CuAssertPtrNotNull(tc, requester2_node_data);
+
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_serverTestConnection_write_remote_data(provider_connection, APX_PORT_DATA_ADDRESS_START, provide_port_data, UINT16_SIZE));
+   apx_fanoutPool_get_stats(apx_server_get_fanout_pool(server), &stats);
+   CuAssertUIntEquals(tc, 1u, stats.num_parallel_runs);
+   apx_serverTestConnection_run(requester1_connection);
+   apx_serverTestConnection_run(requester2_connection);
+   snapshot = apx_nodeData_take_require_port_data_snapshot(requester1_node_data);
+   CuAssertPtrNotNull(tc, snapshot);
+   CuAssertUIntEquals(tc, 0x78, snapshot[0]);
+   CuAssertUIntEquals(tc, 0x56, snapshot[1]);
+   free(snapshot);
+   snapshot = apx_nodeData_take_require_port_data_snapshot(requester2_node_data);
+   CuAssertPtrNotNull(tc, snapshot);
+   CuAssertUIntEquals(tc, 0x78, snapshot[2]); //VehicleSpeed is the second port of Requester2
+   CuAssertUIntEquals(tc, 0x56, snapshot[3]);
+   free(snapshot);
+
+   apx_server_delete(server);
+}
+
+static void test_change_only_routing_suppresses_identical_values(CuTest* tc)
+{
+   apx_server_t* server;
+   apx_serverTestConnection_t* provider_connection;
+   apx_serverTestConnection_t* requester_connection;
+   apx_nodeInstance_t* provider_node_instance;
+   apx_nodeInstanceRoutingStats_t stats;
+   uint8_t same_value[UINT16_SIZE] = { 0x34u, 0x12u };
+   uint8_t new_value[UINT16_SIZE] = { 0x78u, 0x56u };
+
+   server = apx_server_new();
+   CuAssertPtrNotNull(tc, server);
+   apx_server_set_change_only_routing(server, true);
+   provider_connection = connect_node(tc, server, "Provider1", m_provider1_definition, UINT16_SIZE);
+   requester_connection = connect_node(tc, server, "Requester1", m_requester1_definition, 0u);
+   provider_node_instance = apx_nodeManager_find(apx_serverTestConnection_get_node_manager(provider_connection), "Provider1");
+   CuAssertPtrNotNull(tc, provider_node_instance);
+   CuAssertTrue(tc, apx_nodeInstance_is_change_only_routing(provider_node_instance));
+
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_serverTestConnection_write_remote_data(provider_connection, APX_PORT_DATA_ADDRESS_START, same_value, UINT16_SIZE));
+   apx_serverTestConnection_run(requester_connection);
+   CuAssertIntEquals(tc, 0u, apx_serverTestConnection_log_length(requester_connection));
+   apx_nodeInstance_get_routing_stats(provider_node_instance, &stats);
+   CuAssertUIntEquals(tc, 1u, stats.num_suppressed_values);
+   CuAssertUIntEquals(tc, UINT16_SIZE, (uint32_t)stats.num_suppressed_bytes);
+   CuAssertUIntEquals(tc, 0u, (uint32_t)stats.num_routed_bytes);
+
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_serverTestConnection_write_remote_data(provider_connection, APX_PORT_DATA_ADDRESS_START, new_value, UINT16_SIZE));
+   apx_serverTestConnection_run(requester_connection);
+   CuAssertIntEquals(tc, 1u, apx_serverTestConnection_log_length(requester_connection));
+   apx_nodeInstance_get_routing_stats(provider_node_instance, &stats);
+   CuAssertUIntEquals(tc, 1u, stats.num_suppressed_values);
+   CuAssertUIntEquals(tc, UINT16_SIZE, (uint32_t)stats.num_routed_bytes);
+
+   apx_server_delete(server);
+}
+
+static void test_rate_limited_require_port_receives_latest_value_when_interval_expires(CuTest* tc)
+{
+   apx_server_t* server;
+   apx_serverTestConnection_t* provider_connection;
+   apx_serverTestConnection_t* requester_connection;
+   apx_rateLimiter_t* rate_limiter;
+   apx_rateLimiterStats_t stats;
+   adt_bytearray_t* packet;
+   uint8_t data_message[5];
+   uint8_t first_value[UINT16_SIZE] = { 0x78u, 0x56u };
+   uint8_t second_value[UINT16_SIZE] = { 0xBCu, 0x9Au };
+   uint8_t third_value[UINT16_SIZE] = { 0xF0u, 0xDEu };
+
+   server = apx_server_new();
+   CuAssertPtrNotNull(tc, server);
+   rate_limiter = apx_server_get_rate_limiter(server);
+   CuAssertPtrNotNull(tc, rate_limiter);
+   provider_connection = connect_node(tc, server, "Provider1", m_provider1_definition, UINT16_SIZE);
+   requester_connection = connect_node(tc, server, "Requester1", m_rate_limited_requester_definition, 0u);
+
+   //First value is delivered right away
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_serverTestConnection_write_remote_data(provider_connection, APX_PORT_DATA_ADDRESS_START, first_value, UINT16_SIZE));
+   apx_serverTestConnection_run(requester_connection);
+   CuAssertIntEquals(tc, 1u, apx_serverTestConnection_log_length(requester_connection));
+   apx_serverTestConnection_clear_log(requester_connection);
+
+   //Values written within the interval are held back, only the latest is kept
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_serverTestConnection_write_remote_data(provider_connection, APX_PORT_DATA_ADDRESS_START, second_value, UINT16_SIZE));
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_serverTestConnection_write_remote_data(provider_connection, APX_PORT_DATA_ADDRESS_START, third_value, UINT16_SIZE));
+   apx_serverTestConnection_run(requester_connection);
+   CuAssertIntEquals(tc, 0u, apx_serverTestConnection_log_length(requester_connection));
+
+   apx_rateLimiter_advance_time(rate_limiter, 50u);
+   apx_serverTestConnection_run(requester_connection);
+   CuAssertIntEquals(tc, 0u, apx_serverTestConnection_log_length(requester_connection));
+
+   apx_rateLimiter_advance_time(rate_limiter, 50u);
+   apx_serverTestConnection_run(requester_connection);
+   CuAssertIntEquals(tc, 1u, apx_serverTestConnection_log_length(requester_connection));
+   packet = apx_serverTestConnection_get_log_packet(requester_connection, 0);
+   CuAssertPtrNotNull(tc, packet);
+   CuAssertIntEquals(tc, 5, adt_bytearray_length(packet));
+   memcpy(data_message, adt_bytearray_data(packet), sizeof(data_message));
+   CuAssertUIntEquals(tc, 0xF0, data_message[3]);
+   CuAssertUIntEquals(tc, 0xDE, data_message[4]);
+
+   apx_rateLimiter_get_stats(rate_limiter, &stats);
+   CuAssertUIntEquals(tc, 1u, stats.num_forwarded);
+   CuAssertUIntEquals(tc, 1u, stats.num_deferred);
+   CuAssertUIntEquals(tc, 1u, stats.num_dropped);
+
+   apx_server_delete(server);
+}
+
+static void test_queued_elements_are_delivered_in_batches(CuTest* tc)
+{
+   apx_server_t* server;
+   apx_serverTestConnection_t* provider_connection;
+   apx_serverTestConnection_t* requester_connection;
+   adt_bytearray_t* packet;
+   uint8_t data_message[8];
+   uint8_t first_value[5] = { 2u, 0x11u, 0x22u, 0u, 0u };
+   uint8_t second_value[5] = { 1u, 0x33u, 0u, 0u, 0u };
+   uint32_t const queued_port_address = APX_PORT_DATA_ADDRESS_START + UINT16_SIZE;
+
+   server = apx_server_new();
+   CuAssertPtrNotNull(tc, server);
+   provider_connection = connect_node(tc, server, "Provider1", m_queued_provider_definition, UINT16_SIZE + 5u);
+   requester_connection = connect_node(tc, server, "Requester1", m_queued_requester_definition, 0u);
+
+   //Elements written before the requester connection runs are sent together in one batch
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_serverTestConnection_write_remote_data(provider_connection, queued_port_address, first_value, sizeof(first_value)));
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_serverTestConnection_write_remote_data(provider_connection, queued_port_address, second_value, sizeof(second_value)));
+   apx_serverTestConnection_run(requester_connection);
+   CuAssertIntEquals(tc, 1u, apx_serverTestConnection_log_length(requester_connection));
+   packet = apx_serverTestConnection_get_log_packet(requester_connection, 0);
+   CuAssertPtrNotNull(tc, packet);
+   CuAssertIntEquals(tc, 8, adt_bytearray_length(packet));
+   memcpy(data_message, adt_bytearray_data(packet), sizeof(data_message));
+   CuAssertUIntEquals(tc, 3u, data_message[3]);
+   CuAssertUIntEquals(tc, 0x11u, data_message[4]);
+   CuAssertUIntEquals(tc, 0x22u, data_message[5]);
+   CuAssertUIntEquals(tc, 0x33u, data_message[6]);
+   CuAssertUIntEquals(tc, 0u, data_message[7]);
+
+   apx_server_delete(server);
+}
+
+static void test_queued_elements_that_overflow_are_counted(CuTest* tc)
+{
+   apx_server_t* server;
+   apx_serverTestConnection_t* provider_connection;
+   apx_serverTestConnection_t* requester_connection;
+   apx_nodeInstance_t* requester_node;
+   uint8_t value[5] = { 4u, 1u, 2u, 3u, 4u };
+   uint32_t const queued_port_address = APX_PORT_DATA_ADDRESS_START + UINT16_SIZE;
+   int i;
+
+   server = apx_server_new();
+   CuAssertPtrNotNull(tc, server);
+   provider_connection = connect_node(tc, server, "Provider1", m_queued_provider_definition, UINT16_SIZE + 5u);
+   requester_connection = connect_node(tc, server, "Requester1", m_queued_requester_definition, 0u);
+   requester_node = apx_nodeManager_find(apx_serverTestConnection_get_node_manager(requester_connection), "Requester1");
+   CuAssertPtrNotNull(tc, requester_node);
+
+   //The ring holds 16 elements, the last write does not fit
+   for (i = 0; i < 5; i++)
+   {
+      CuAssertIntEquals(tc, APX_NO_ERROR, apx_serverTestConnection_write_remote_data(provider_connection, queued_port_address, value, sizeof(value)));
+   }
+   CuAssertUIntEquals(tc, 4u, apx_nodeInstance_get_num_queue_overflows(requester_node));
+   apx_serverTestConnection_run(requester_connection);
+   CuAssertIntEquals(tc, 4u, apx_serverTestConnection_log_length(requester_connection));
+
+   apx_server_delete(server);
+}
+
+static void test_dynamic_array_value_is_routed_without_unused_elements(CuTest* tc)
+{
+   apx_server_t* server;
+   apx_serverTestConnection_t* provider_connection;
+   apx_serverTestConnection_t* requester_connection;
+   apx_file_t* require_port_data_file;
+   adt_bytearray_t* packet;
+   uint8_t value[4] = { 3u, 0x11u, 0x22u, 0x33u };
+   uint8_t invalid_value[3] = { 5u, 0x11u, 0x22u };
+   uint32_t const dynamic_port_address = APX_PORT_DATA_ADDRESS_START + UINT16_SIZE;
+
+   server = apx_server_new();
+   CuAssertPtrNotNull(tc, server);
+   provider_connection = connect_node(tc, server, "Provider1", m_dynamic_provider_definition, UINT16_SIZE + UINT8_SIZE + 8u);
+   requester_connection = connect_node_with_greeting_lines(tc, server, "Requester1", m_dynamic_requester_definition, 0u, "Capabilities:dynamic-file\n");
+   require_port_data_file = apx_fileManager_find_local_file_by_name(apx_serverTestConnection_get_file_manager(requester_connection), "Requester1.in");
+   CuAssertPtrNotNull(tc, require_port_data_file);
+   CuAssertUIntEquals(tc, RMF_FILE_TYPE_DYNAMIC8, apx_file_get_rmf_file_type(require_port_data_file));
+
+   //Only the array length and the three elements in use are written and routed
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_serverTestConnection_write_remote_data(provider_connection, dynamic_port_address, value, sizeof(value)));
+   apx_serverTestConnection_run(requester_connection);
+   CuAssertIntEquals(tc, 1, apx_serverTestConnection_log_length(requester_connection));
+   packet = apx_serverTestConnection_get_log_packet(requester_connection, 0);
+   CuAssertPtrNotNull(tc, packet);
+   CuAssertIntEquals(tc, 3 + (int)sizeof(value), adt_bytearray_length(packet));
+   CuAssertTrue(tc, memcmp(value, adt_bytearray_data(packet) + 3, sizeof(value)) == 0);
+   apx_serverTestConnection_clear_log(requester_connection);
+
+   //Array length does not match the number of bytes written
+   (void)apx_serverTestConnection_write_remote_data(provider_connection, dynamic_port_address, invalid_value, sizeof(invalid_value));
+   apx_serverTestConnection_run(requester_connection);
+   CuAssertIntEquals(tc, 0, apx_serverTestConnection_log_length(requester_connection));
+
+   apx_server_delete(server);
+}
+
+static void test_dynamic_array_value_is_zero_filled_for_peer_without_dynamic_files(CuTest* tc)
+{
+   apx_server_t* server;
+   apx_serverTestConnection_t* provider_connection;
+   apx_serverTestConnection_t* requester_connection;
+   apx_file_t* require_port_data_file;
+   adt_bytearray_t* packet;
+   uint8_t const* packet_data;
+   uint8_t value[4] = { 3u, 0x11u, 0x22u, 0x33u };
+   uint8_t const unused_tail[5] = { 0u, 0u, 0u, 0u, 0u };
+   uint32_t const dynamic_port_address = APX_PORT_DATA_ADDRESS_START + UINT16_SIZE;
+   uint32_t const dynamic_port_size = UINT8_SIZE + 8u;
+
+   server = apx_server_new();
+   CuAssertPtrNotNull(tc, server);
+   provider_connection = connect_node(tc, server, "Provider1", m_dynamic_provider_definition, UINT16_SIZE + dynamic_port_size);
+   requester_connection = connect_node(tc, server, "Requester1", m_dynamic_requester_definition, 0u);
+   require_port_data_file = apx_fileManager_find_local_file_by_name(apx_serverTestConnection_get_file_manager(requester_connection), "Requester1.in");
+   CuAssertPtrNotNull(tc, require_port_data_file);
+   CuAssertUIntEquals(tc, RMF_FILE_TYPE_FIXED, apx_file_get_rmf_file_type(require_port_data_file));
+
+   //Requester did not agree to dynamic files and gets the complete port value
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_serverTestConnection_write_remote_data(provider_connection, dynamic_port_address, value, sizeof(value)));
+   apx_serverTestConnection_run(requester_connection);
+   CuAssertIntEquals(tc, 1, apx_serverTestConnection_log_length(requester_connection));
+   packet = apx_serverTestConnection_get_log_packet(requester_connection, 0);
+   CuAssertPtrNotNull(tc, packet);
+   CuAssertIntEquals(tc, 3 + (int)dynamic_port_size, adt_bytearray_length(packet));
+   packet_data = adt_bytearray_data(packet);
+   CuAssertTrue(tc, memcmp(value, packet_data + 3, sizeof(value)) == 0);
+   CuAssertTrue(tc, memcmp(unused_tail, packet_data + 3 + sizeof(value), sizeof(unused_tail)) == 0);
+
+   apx_server_delete(server);
+}
+
+static void test_partial_write_is_routed_as_byte_range(CuTest* tc)
+{
+   apx_server_t* server;
+   apx_serverTestConnection_t* provider_connection;
+   apx_serverTestConnection_t* requester_connection;
+   apx_file_t* require_port_data_file;
+   adt_bytearray_t* packet;
+   uint8_t const* packet_data;
+   uint32_t address = 0u;
+   bool more_bit = false;
+   uint8_t value[2] = { 0x55u, 0x66u };
+   uint32_t const element_offset = 5u;
+   uint32_t const samples_port_address = APX_PORT_DATA_ADDRESS_START + UINT16_SIZE;
+
+   server = apx_server_new();
+   CuAssertPtrNotNull(tc, server);
+   provider_connection = connect_node(tc, server, "Provider1", m_array_provider_definition, UINT16_SIZE + 16u);
+   requester_connection = connect_node_with_greeting_lines(tc, server, "Requester1", m_array_requester_definition, 0u, "Capabilities:partial-write\n");
+   require_port_data_file = apx_fileManager_find_local_file_by_name(apx_serverTestConnection_get_file_manager(requester_connection), "Requester1.in");
+   CuAssertPtrNotNull(tc, require_port_data_file);
+
+   //Only the two written elements are routed, to the same position within the require port
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_serverTestConnection_write_remote_data(provider_connection, samples_port_address + element_offset, value, sizeof(value)));
+   apx_serverTestConnection_run(requester_connection);
+   CuAssertIntEquals(tc, 1, apx_serverTestConnection_log_length(requester_connection));
+   packet = apx_serverTestConnection_get_log_packet(requester_connection, 0);
+   CuAssertPtrNotNull(tc, packet);
+   CuAssertIntEquals(tc, 3 + (int)sizeof(value), adt_bytearray_length(packet));
+   packet_data = adt_bytearray_data(packet);
+   CuAssertUIntEquals(tc, RMF_LOW_ADDR_SIZE, rmf_address_decode(packet_data + 1, packet_data + 3, &address, &more_bit));
+   CuAssertUIntEquals(tc, apx_file_get_address_without_flags(require_port_data_file) + element_offset, address);
+   CuAssertTrue(tc, memcmp(value, packet_data + 3, sizeof(value)) == 0);
+
+   apx_server_delete(server);
+}
+
+static void test_partial_write_is_routed_as_complete_value_to_peer_without_partial_writes(CuTest* tc)
+{
+   apx_server_t* server;
+   apx_serverTestConnection_t* provider_connection;
+   apx_serverTestConnection_t* requester_connection;
+   apx_file_t* require_port_data_file;
+   adt_bytearray_t* packet;
+   uint8_t const* packet_data;
+   uint32_t address = 0u;
+   bool more_bit = false;
+   uint8_t value[2] = { 0x55u, 0x66u };
+   uint8_t expected[16];
+   uint32_t const element_offset = 5u;
+   uint32_t const samples_port_address = APX_PORT_DATA_ADDRESS_START + UINT16_SIZE;
+
+   server = apx_server_new();
+   CuAssertPtrNotNull(tc, server);
+   provider_connection = connect_node(tc, server, "Provider1", m_array_provider_definition, UINT16_SIZE + 16u);
+   requester_connection = connect_node(tc, server, "Requester1", m_array_requester_definition, 0u);
+   require_port_data_file = apx_fileManager_find_local_file_by_name(apx_serverTestConnection_get_file_manager(requester_connection), "Requester1.in");
+   CuAssertPtrNotNull(tc, require_port_data_file);
+
+   //The requester did not agree to partial writes and is sent the complete Samples value
+   memset(expected, 0, sizeof(expected));
+   memcpy(&expected[element_offset], value, sizeof(value));
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_serverTestConnection_write_remote_data(provider_connection, samples_port_address + element_offset, value, sizeof(value)));
+   apx_serverTestConnection_run(requester_connection);
+   CuAssertIntEquals(tc, 1, apx_serverTestConnection_log_length(requester_connection));
+   packet = apx_serverTestConnection_get_log_packet(requester_connection, 0);
+   CuAssertPtrNotNull(tc, packet);
+   CuAssertIntEquals(tc, 3 + (int)sizeof(expected), adt_bytearray_length(packet));
+   packet_data = adt_bytearray_data(packet);
+   CuAssertUIntEquals(tc, RMF_LOW_ADDR_SIZE, rmf_address_decode(packet_data + 1, packet_data + 3, &address, &more_bit));
+   CuAssertUIntEquals(tc, apx_file_get_address_without_flags(require_port_data_file), address);
+   CuAssertTrue(tc, memcmp(expected, packet_data + 3, sizeof(expected)) == 0);
+
+   apx_server_delete(server);
+}
+
+/**
+ * Connects a node and opens all of its files. Provider nodes get the initial value 0x1234 in their first port.
+ */
+static apx_serverTestConnection_t* connect_node(CuTest* tc, apx_server_t* server, const char* node_name, const char* definition, apx_size_t provide_port_data_size)
+{
+   return connect_node_with_greeting_lines(tc, server, node_name, definition, provide_port_data_size, "");
+}
+
+/**
+ * Same as connect_node but header_lines (e.g. capabilities) are sent in the greeting.
+ */
+static apx_serverTestConnection_t* connect_node_with_greeting_lines(CuTest* tc, apx_server_t* server, const char* node_name, const char* definition, apx_size_t provide_port_data_size, char const* header_lines)
+{
+   char file_name[RMF_FILE_NAME_MAX_SIZE];
+   uint8_t provide_port_data[UINT16_SIZE] = { 0x34u, 0x12u };
+   apx_size_t const definition_size = (apx_size_t)strlen(definition);
+   apx_serverTestConnection_t* connection = apx_serverTestConnection_new();
+   CuAssertPtrNotNull(tc, connection);
+   apx_server_accept_connection(server, (apx_serverConnection_t*)connection);
+   CuAssertUIntEquals(tc, APX_NO_ERROR, apx_serverTestConnection_send_greeting_header_with_lines(connection, header_lines));
+   apx_serverTestConnection_run(connection);
+   if (provide_port_data_size > 0u)
+   {
+      sprintf(file_name, "%s.out", node_name);
+      CuAssertIntEquals(tc, APX_NO_ERROR, apx_serverTestConnection_publish_remote_file(connection, APX_PORT_DATA_ADDRESS_START, file_name, provide_port_data_size));
+      apx_serverTestConnection_run(connection);
+   }
+   sprintf(file_name, "%s.apx", node_name);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_serverTestConnection_publish_remote_file(connection, APX_DEFINITION_ADDRESS_START, file_name, definition_size));
+   apx_serverTestConnection_run(connection);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_serverTestConnection_write_remote_data(connection, APX_DEFINITION_ADDRESS_START, (uint8_t const*)definition, definition_size));
+   apx_serverTestConnection_run(connection);
+   if (provide_port_data_size > 0u)
+   {
+      CuAssertIntEquals(tc, APX_NO_ERROR, apx_serverTestConnection_write_remote_data(connection, APX_PORT_DATA_ADDRESS_START, provide_port_data, UINT16_SIZE));
+   }
+   else
+   {
+      sprintf(file_name, "%s.in", node_name);
+      CuAssertIntEquals(tc, APX_NO_ERROR, apx_serverTestConnection_request_open_local_file(connection, file_name));
+   }
+   apx_serverTestConnection_run(connection);
+   apx_serverTestConnection_clear_log(connection);
+   return connection;
+}
+
+static void test_node_cache_can_be_disabled(CuTest* tc)
+{
+   apx_server_t* server;
+   apx_serverTestConnection_t* connection;
+   apx_nodeCache_t* node_cache;
+
+   server = apx_server_new();
+   CuAssertPtrNotNull(tc, server);
+   node_cache = apx_server_get_node_cache(server);
+   CuAssertPtrNotNull(tc, node_cache);
+   CuAssertUIntEquals(tc, APX_NODE_CACHE_DEFAULT_MAX_SIZE, node_cache->max_size);
+   apx_server_configure_node_cache(server, true, 1024u);
+   CuAssertUIntEquals(tc, 1024u, node_cache->max_size);
+
+   apx_server_configure_node_cache(server, false, 0u);
+   CuAssertPtrEquals(tc, NULL, apx_server_get_node_cache(server));
+   CuAssertUIntEquals(tc, 1024u, node_cache->max_size);
+   connection = connect_node(tc, server, "Requester1", m_requester1_definition, 0u);
+   CuAssertPtrEquals(tc, NULL, apx_nodeManager_get_node_cache(apx_serverTestConnection_get_node_manager(connection)));
+
+   apx_server_delete(server);
+}
@@ -30,6 +30,13 @@ static void test_provide_port_data_is_requested_after_definition_file_has_been_p
 static void test_provide_port_data_is_received_after_request(CuTest* tc);
 static void test_require_port_data_is_published_after_definition_has_been_parsed(CuTest* tc);
 static void test_require_port_data_is_sent_after_file_open_request_received(CuTest* tc);
+static void test_compressed_definition_is_parsed(CuTest* tc);
+static void test_acknowledge_contains_agreed_capabilities(CuTest* tc);
+static void test_definition_in_node_cache_is_not_downloaded_again(CuTest* tc);
+static void test_provide_port_data_published_after_cached_definition_is_requested(CuTest* tc);
+static void test_pipelined_provide_port_data_is_applied_after_definition_is_parsed(CuTest* tc);
+static void test_pipelined_provide_port_data_keeps_init_values_between_writes(CuTest* tc);
+static void test_fragmented_definition_is_parsed_while_it_arrives(CuTest* tc);
 
 
 
@@ -52,6 +59,13 @@ CuSuite* testSuite_apx_serverConnection(void)
    SUITE_ADD_TEST(suite, test_provide_port_data_is_received_after_request);
    SUITE_ADD_TEST(suite, test_require_port_data_is_published_after_definition_has_been_parsed);
    SUITE_ADD_TEST(suite, test_require_port_data_is_sent_after_file_open_request_received);
+   SUITE_ADD_TEST(suite, test_compressed_definition_is_parsed);
+   SUITE_ADD_TEST(suite, test_acknowledge_contains_agreed_capabilities);
+   SUITE_ADD_TEST(suite, test_definition_in_node_cache_is_not_downloaded_again);
+   SUITE_ADD_TEST(suite, test_provide_port_data_published_after_cached_definition_is_requested);
+   SUITE_ADD_TEST(suite, test_pipelined_provide_port_data_is_applied_after_definition_is_parsed);
+   SUITE_ADD_TEST(suite, test_pipelined_provide_port_data_keeps_init_values_between_writes);
+   SUITE_ADD_TEST(suite, test_fragmented_definition_is_parsed_while_it_arrives);
 
    return suite;
 }
@@ -94,6 +108,39 @@ static void test_acknowledge_is_sent_when_greeting_is_seen(CuTest* tc)
    apx_serverTestConnection_delete(connection);
 }
 
+static void test_acknowledge_contains_agreed_capabilities(CuTest* tc)
+{
+   apx_serverTestConnection_t* connection;
+   adt_bytearray_t* packet;
+   apx_capabilities_t capabilities;
+   char const* expected_lines = "Capabilities:stream-file\nMax-Message-Size:1000\n";
+   apx_size_t const expected_size = NUMHEADER32_SHORT_SIZE + RMF_HIGH_ADDR_SIZE + RMF_CMD_TYPE_SIZE + (apx_size_t)strlen(expected_lines);
+   uint8_t const* data;
+   connection = apx_serverTestConnection_new();
+   CuAssertPtrNotNull(tc, connection);
+
+   //Unknown feature names are ignored, compression is not enabled on the server
+   CuAssertUIntEquals(tc, APX_NO_ERROR, apx_serverTestConnection_send_greeting_header_with_lines(connection,
+      "Capabilities:stream-file,lz4,future-feature\nMax-Message-Size:1000\nReceive-Buffer-Size:8192\n"));
+   apx_serverTestConnection_run(connection);
+   CuAssertIntEquals(tc, 1u, apx_serverTestConnection_log_length(connection));
+   packet = apx_serverTestConnection_get_log_packet(connection, 0);
+   CuAssertPtrNotNull(tc, packet);
+   CuAssertIntEquals(tc, (int)expected_size, adt_bytearray_length(packet));
+   data = adt_bytearray_data(packet);
+   CuAssertUIntEquals(tc, RMF_CMD_ACK_MSG, unpackLE(&data[NUMHEADER32_SHORT_SIZE + RMF_HIGH_ADDR_SIZE], RMF_CMD_TYPE_SIZE));
+   CuAssertIntEquals(tc, 0, memcmp(expected_lines, &data[NUMHEADER32_SHORT_SIZE + RMF_HIGH_ADDR_SIZE + RMF_CMD_TYPE_SIZE], strlen(expected_lines)));
+
+   apx_connectionBase_get_capabilities(&connection->base.base, &capabilities);
+   CuAssertTrue(tc, capabilities.is_announced);
+   CuAssertUIntEquals(tc, APX_CAPABILITY_STREAM_FILE, capabilities.flags);
+   CuAssertUIntEquals(tc, 1000u, capabilities.max_message_size);
+   CuAssertUIntEquals(tc, 8192u, capabilities.receive_buffer_size);
+   CuAssertUIntEquals(tc, 0u, apx_fileManager_get_compression_threshold(&connection->base.base.file_manager));
+
+   apx_serverTestConnection_delete(connection);
+}
+
 static void test_node_instance_is_created_when_definition_file_is_seen(CuTest* tc)
 {
    apx_serverTestConnection_t* connection;
@@ -541,3 +588,313 @@ static void test_require_port_data_is_sent_after_file_open_request_received(CuTe
    CuAssertIntEquals(tc, 0, memcmp(actual, expected, data_write_size));
    apx_serverTestConnection_delete(connection);
 }
+
+static void test_compressed_definition_is_parsed(CuTest* tc)
+{
+   apx_serverTestConnection_t* connection;
+   apx_fileManager_t* file_manager;
+   apx_compressionStats_t stats;
+   uint8_t msg[512];
+   uint8_t* p = &msg[0];
+   apx_size_t compressed_size;
+   char const* apx_text =
+      "APX/1.2\n"
+      "N\"TestNode1\"\n"
+      "R\"RequirePort1\"C(0,3):=3\n"
+      "R\"RequirePort2\"C(0,3):=3\n"
+      "R\"RequirePort3\"C(0,3):=3\n"
+      "R\"RequirePort4\"C(0,3):=3\n"
+      "R\"RequirePort5\"C(0,3):=3\n"
+      "R\"RequirePort6\"C(0,3):=3\n";
+
+   apx_size_t definition_size = (apx_size_t)strlen(apx_text);
+   connection = apx_serverTestConnection_new();
+   CuAssertPtrNotNull(tc, connection);
+   CuAssertUIntEquals(tc, APX_NO_ERROR, apx_serverTestConnection_send_greeting_header(connection));
+   apx_serverTestConnection_run(connection);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_serverTestConnection_publish_remote_file(connection, APX_DEFINITION_ADDRESS_START, "TestNode1.apx", definition_size));
+   apx_serverTestConnection_run(connection);
+   apx_nodeInstance_t* node_instance = apx_serverTestConnection_find_node(connection, "TestNode1");
+   CuAssertPtrNotNull(tc, node_instance);
+   CuAssertIntEquals(tc, APX_DATA_STATE_WAITING_FOR_FILE_DATA, apx_nodeInstance_get_definition_data_state(node_instance));
+
+   //Compressed message as sent by the client: command area address, compressed message header, LZ4 block
+   p += rmf_address_encode(p, RMF_HIGH_ADDR_SIZE, RMF_CMD_AREA_START_ADDRESS, false);
+   p += rmf_encode_compressed_msg_header(p, RMF_COMPRESSED_MSG_HEADER_MAX_SIZE, APX_DEFINITION_ADDRESS_START, false, definition_size);
+   compressed_size = apx_compression_compress(p, definition_size - 1u, (uint8_t const*)apx_text, definition_size, NULL);
+   CuAssertTrue(tc, compressed_size > 0u);
+   p += compressed_size;
+   file_manager = apx_serverTestConnection_get_file_manager(connection);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_fileManager_message_received(file_manager, msg, (apx_size_t)(p - msg)));
+   CuAssertIntEquals(tc, APX_DATA_STATE_CONNECTED, apx_nodeInstance_get_definition_data_state(node_instance));
+   apx_fileManager_get_compression_stats(file_manager, &stats);
+   CuAssertUIntEquals(tc, 1u, (uint32_t)stats.num_decompressed);
+   CuAssertUIntEquals(tc, definition_size, (uint32_t)stats.bytes_decompressed);
+
+   //Block that does not decode to the announced size is rejected
+   msg[RMF_HIGH_ADDR_SIZE + RMF_CMD_TYPE_SIZE + RMF_HIGH_ADDR_SIZE] ^= 0x01u;
+   CuAssertIntEquals(tc, APX_COMPRESSION_ERROR, apx_fileManager_message_received(file_manager, msg, (apx_size_t)(p - msg)));
+
+   //Announced size is checked against the target file and the block size before anything is allocated
+   p = &msg[RMF_HIGH_ADDR_SIZE];
+   p += rmf_encode_compressed_msg_header(p, RMF_COMPRESSED_MSG_HEADER_MAX_SIZE, APX_DEFINITION_ADDRESS_START, false, definition_size + 1u);
+   p += compressed_size;
+   CuAssertIntEquals(tc, APX_INVALID_MSG_ERROR, apx_fileManager_message_received(file_manager, msg, (apx_size_t)(p - msg)));
+   //Header without a block
+   p = &msg[RMF_HIGH_ADDR_SIZE];
+   p += rmf_encode_compressed_msg_header(p, RMF_COMPRESSED_MSG_HEADER_MAX_SIZE, APX_DEFINITION_ADDRESS_START, false, definition_size);
+   CuAssertIntEquals(tc, APX_INVALID_MSG_ERROR, apx_fileManager_message_received(file_manager, msg, (apx_size_t)(p - msg)));
+   apx_serverTestConnection_run(connection);
+   apx_serverTestConnection_delete(connection);
+}
+
+static void test_definition_in_node_cache_is_not_downloaded_again(CuTest* tc)
+{
+   apx_serverTestConnection_t* connection;
+   apx_nodeCache_t* node_cache;
+   apx_nodeInstance_t* node_instance;
+   adt_bytearray_t* packet;
+   int const open_request_size = 13;
+   apx_size_t const provide_port_data_size = 2u;
+   uint8_t digest[RMF_SHA256_SIZE];
+   uint8_t const expected[13] = {
+      //message size
+      12,
+      //write address
+      0xBFu,
+      0xFFu,
+      0xFCu,
+      0x00u,
+      //command type
+      (uint8_t)RMF_CMD_OPEN_FILE_MSG,
+      0u,
+      0u,
+      0u,
+      //address of TestNode1.out
+      0u,
+      0u,
+      0u,
+      0u,
+   };
+   char const* apx_text =
+      "APX/1.2\n"
+      "N\"TestNode1\"\n"
+      "P\"ProvidePort1\"C(0,3):=3\n"
+      "P\"ProvidePort2\"C(0,7):=7\n";
+
+   apx_size_t definition_size = (apx_size_t)strlen(apx_text);
+   sha256_calc(&digest[0], apx_text, (size_t)definition_size);
+   node_cache = apx_nodeCache_new(APX_SERVER_MODE);
+   CuAssertPtrNotNull(tc, node_cache);
+
+   //First connection downloads the definition
+   connection = apx_serverTestConnection_new();
+   CuAssertPtrNotNull(tc, connection);
+   apx_nodeManager_set_node_cache(apx_serverTestConnection_get_node_manager(connection), node_cache);
+   CuAssertUIntEquals(tc, APX_NO_ERROR, apx_serverTestConnection_send_greeting_header(connection));
+   apx_serverTestConnection_run(connection);
+   apx_serverTestConnection_clear_log(connection);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_serverTestConnection_publish_remote_file_with_digest(connection, APX_DEFINITION_ADDRESS_START, "TestNode1.apx", definition_size, &digest[0]));
+   apx_serverTestConnection_run(connection);
+   CuAssertIntEquals(tc, 1, apx_serverTestConnection_log_length(connection));
+   apx_serverTestConnection_clear_log(connection);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_serverTestConnection_write_remote_data(connection, APX_DEFINITION_ADDRESS_START, (uint8_t const*)apx_text, definition_size));
+   apx_serverTestConnection_run(connection);
+   CuAssertUIntEquals(tc, 1u, apx_nodeCache_length(node_cache));
+   apx_serverTestConnection_delete(connection);
+
+   //On reconnect, the definition is taken from cache and the provide port data is requested directly
+   connection = apx_serverTestConnection_new();
+   CuAssertPtrNotNull(tc, connection);
+   apx_nodeManager_set_node_cache(apx_serverTestConnection_get_node_manager(connection), node_cache);
+   CuAssertUIntEquals(tc, APX_NO_ERROR, apx_serverTestConnection_send_greeting_header(connection));
+   apx_serverTestConnection_run(connection);
+   apx_serverTestConnection_clear_log(connection);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_serverTestConnection_publish_remote_file(connection, APX_PORT_DATA_ADDRESS_START, "TestNode1.out", provide_port_data_size));
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_serverTestConnection_publish_remote_file_with_digest(connection, APX_DEFINITION_ADDRESS_START, "TestNode1.apx", definition_size, &digest[0]));
+   apx_serverTestConnection_run(connection);
+   node_instance = apx_serverTestConnection_find_node(connection, "TestNode1");
+   CuAssertPtrNotNull(tc, node_instance);
+   CuAssertIntEquals(tc, APX_DATA_STATE_CONNECTED, apx_nodeInstance_get_definition_data_state(node_instance));
+   CuAssertIntEquals(tc, APX_DATA_STATE_WAITING_FOR_FILE_DATA, apx_nodeInstance_get_provide_port_data_state(node_instance));
+   CuAssertUIntEquals(tc, 2u, apx_nodeInstance_get_num_provide_ports(node_instance));
+   CuAssertIntEquals(tc, 1, apx_serverTestConnection_log_length(connection));
+   packet = apx_serverTestConnection_get_log_packet(connection, 0);
+   CuAssertPtrNotNull(tc, packet);
+   CuAssertIntEquals(tc, open_request_size, adt_bytearray_length(packet));
+   CuAssertIntEquals(tc, 0, memcmp(adt_bytearray_data(packet), expected, open_request_size));
+   apx_serverTestConnection_delete(connection);
+
+   //A different digest with same size is downloaded as before
+   digest[0] ^= 0xFFu;
+   connection = apx_serverTestConnection_new();
+   CuAssertPtrNotNull(tc, connection);
+   apx_nodeManager_set_node_cache(apx_serverTestConnection_get_node_manager(connection), node_cache);
+   CuAssertUIntEquals(tc, APX_NO_ERROR, apx_serverTestConnection_send_greeting_header(connection));
+   apx_serverTestConnection_run(connection);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_serverTestConnection_publish_remote_file_with_digest(connection, APX_DEFINITION_ADDRESS_START, "TestNode1.apx", definition_size, &digest[0]));
+   apx_serverTestConnection_run(connection);
+   node_instance = apx_serverTestConnection_find_node(connection, "TestNode1");
+   CuAssertPtrNotNull(tc, node_instance);
+   CuAssertIntEquals(tc, APX_DATA_STATE_WAITING_FOR_FILE_DATA, apx_nodeInstance_get_definition_data_state(node_instance));
+   apx_serverTestConnection_delete(connection);
+   apx_nodeCache_delete(node_cache);
+}
+
+static void test_provide_port_data_published_after_cached_definition_is_requested(CuTest* tc)
+{
+   apx_serverTestConnection_t* connection;
+   apx_nodeCache_t* node_cache;
+   apx_nodeInstance_t* node_instance;
+   uint8_t digest[RMF_SHA256_SIZE];
+   char const* apx_text =
+      "APX/1.2\n"
+      "N\"TestNode1\"\n"
+      "P\"ProvidePort1\"C(0,3):=3\n";
+
+   apx_size_t definition_size = (apx_size_t)strlen(apx_text);
+   sha256_calc(&digest[0], apx_text, (size_t)definition_size);
+   node_cache = apx_nodeCache_new(APX_SERVER_MODE);
+   CuAssertPtrNotNull(tc, node_cache);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_nodeCache_insert(node_cache, (uint8_t const*)apx_text, definition_size));
+   connection = apx_serverTestConnection_new();
+   CuAssertPtrNotNull(tc, connection);
+   apx_nodeManager_set_node_cache(apx_serverTestConnection_get_node_manager(connection), node_cache);
+   CuAssertUIntEquals(tc, APX_NO_ERROR, apx_serverTestConnection_send_greeting_header(connection));
+   apx_serverTestConnection_run(connection);
+   apx_serverTestConnection_clear_log(connection);
+
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_serverTestConnection_publish_remote_file_with_digest(connection, APX_DEFINITION_ADDRESS_START, "TestNode1.apx", definition_size, &digest[0]));
+   apx_serverTestConnection_run(connection);
+   CuAssertIntEquals(tc, 0, apx_serverTestConnection_log_length(connection));
+   node_instance = apx_serverTestConnection_find_node(connection, "TestNode1");
+   CuAssertPtrNotNull(tc, node_instance);
+   CuAssertIntEquals(tc, APX_DATA_STATE_CONNECTED, apx_nodeInstance_get_definition_data_state(node_instance));
+   CuAssertIntEquals(tc, APX_DATA_STATE_WAITING_FILE_INFO, apx_nodeInstance_get_provide_port_data_state(node_instance));
+
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_serverTestConnection_publish_remote_file(connection, APX_PORT_DATA_ADDRESS_START, "TestNode1.out", UINT8_SIZE));
+   apx_serverTestConnection_run(connection);
+   CuAssertIntEquals(tc, APX_DATA_STATE_WAITING_FOR_FILE_DATA, apx_nodeInstance_get_provide_port_data_state(node_instance));
+   CuAssertIntEquals(tc, 1, apx_serverTestConnection_log_length(connection));
+   apx_serverTestConnection_delete(connection);
+   apx_nodeCache_delete(node_cache);
+}
+
+static void test_pipelined_provide_port_data_is_applied_after_definition_is_parsed(CuTest* tc)
+{
+   apx_serverTestConnection_t* connection;
+   apx_nodeInstance_t* node_instance;
+   uint8_t const provide_port_data[2] = { 1u, 2u };
+   uint8_t actual[2] = { 0u, 0u };
+   char const* apx_text =
+      "APX/1.2\n"
+      "N\"TestNode1\"\n"
+      "P\"ProvidePort1\"C(0,3):=3\n"
+      "P\"ProvidePort2\"C(0,7):=7\n";
+
+   apx_size_t definition_size = (apx_size_t)strlen(apx_text);
+   connection = apx_serverTestConnection_new();
+   CuAssertPtrNotNull(tc, connection);
+   CuAssertUIntEquals(tc, APX_NO_ERROR, apx_serverTestConnection_send_greeting_header_with_lines(connection, "Capabilities:pipelined-open\n"));
+   apx_serverTestConnection_run(connection);
+   apx_serverTestConnection_clear_log(connection);
+
+   //Provide port data arrives before the node exists, it is kept by the file manager
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_serverTestConnection_publish_remote_file(connection, APX_PORT_DATA_ADDRESS_START, "TestNode1.out", (apx_size_t)sizeof(provide_port_data)));
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_serverTestConnection_write_remote_data(connection, APX_PORT_DATA_ADDRESS_START, &provide_port_data[0], (apx_size_t)sizeof(provide_port_data)));
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_serverTestConnection_publish_remote_file(connection, APX_DEFINITION_ADDRESS_START, "TestNode1.apx", definition_size));
+   apx_serverTestConnection_run(connection);
+   //No file open requests are sent when pipelined open is agreed
+   CuAssertIntEquals(tc, 0, apx_serverTestConnection_log_length(connection));
+   node_instance = apx_serverTestConnection_find_node(connection, "TestNode1");
+   CuAssertPtrNotNull(tc, node_instance);
+   CuAssertIntEquals(tc, APX_DATA_STATE_WAITING_FOR_FILE_DATA, apx_nodeInstance_get_definition_data_state(node_instance));
+
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_serverTestConnection_write_remote_data(connection, APX_DEFINITION_ADDRESS_START, (uint8_t const*)apx_text, definition_size));
+   apx_serverTestConnection_run(connection);
+   CuAssertIntEquals(tc, 0, apx_serverTestConnection_log_length(connection));
+   CuAssertIntEquals(tc, APX_DATA_STATE_CONNECTED, apx_nodeInstance_get_definition_data_state(node_instance));
+   CuAssertIntEquals(tc, APX_DATA_STATE_CONNECTED, apx_nodeInstance_get_provide_port_data_state(node_instance));
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_nodeData_read_provide_port_data(apx_nodeInstance_get_node_data(node_instance), 0u, &actual[0], (apx_size_t)sizeof(actual)));
+   CuAssertIntEquals(tc, 0, memcmp(&provide_port_data[0], &actual[0], sizeof(actual)));
+   apx_serverTestConnection_delete(connection);
+}
+
+static void test_pipelined_provide_port_data_keeps_init_values_between_writes(CuTest* tc)
+{
+   apx_serverTestConnection_t* connection;
+   apx_nodeInstance_t* node_instance;
+   uint8_t const first_value = 1u;
+   uint8_t const third_value = 5u;
+   uint8_t const expected[3] = { 1u, 7u, 5u };
+   uint8_t actual[3] = { 0u, 0u, 0u };
+   char const* apx_text =
+      "APX/1.2\n"
+      "N\"TestNode1\"\n"
+      "P\"ProvidePort1\"C(0,3):=3\n"
+      "P\"ProvidePort2\"C(0,7):=7\n"
+      "P\"ProvidePort3\"C(0,7):=6\n";
+
+   apx_size_t definition_size = (apx_size_t)strlen(apx_text);
+   connection = apx_serverTestConnection_new();
+   CuAssertPtrNotNull(tc, connection);
+   CuAssertUIntEquals(tc, APX_NO_ERROR, apx_serverTestConnection_send_greeting_header_with_lines(connection, "Capabilities:pipelined-open\n"));
+   apx_serverTestConnection_run(connection);
+   apx_serverTestConnection_clear_log(connection);
+
+   //ProvidePort2 is not written before the node exists and must keep its init value
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_serverTestConnection_publish_remote_file(connection, APX_PORT_DATA_ADDRESS_START, "TestNode1.out", (apx_size_t)sizeof(expected)));
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_serverTestConnection_write_remote_data(connection, APX_PORT_DATA_ADDRESS_START, &first_value, 1u));
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_serverTestConnection_write_remote_data(connection, APX_PORT_DATA_ADDRESS_START + 2u, &third_value, 1u));
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_serverTestConnection_publish_remote_file(connection, APX_DEFINITION_ADDRESS_START, "TestNode1.apx", definition_size));
+   apx_serverTestConnection_run(connection);
+   node_instance = apx_serverTestConnection_find_node(connection, "TestNode1");
+   CuAssertPtrNotNull(tc, node_instance);
+
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_serverTestConnection_write_remote_data(connection, APX_DEFINITION_ADDRESS_START, (uint8_t const*)apx_text, definition_size));
+   apx_serverTestConnection_run(connection);
+   CuAssertIntEquals(tc, APX_DATA_STATE_CONNECTED, apx_nodeInstance_get_provide_port_data_state(node_instance));
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_nodeData_read_provide_port_data(apx_nodeInstance_get_node_data(node_instance), 0u, &actual[0], (apx_size_t)sizeof(actual)));
+   CuAssertIntEquals(tc, 0, memcmp(&expected[0], &actual[0], sizeof(actual)));
+   apx_serverTestConnection_delete(connection);
+}
+
+static void test_fragmented_definition_is_parsed_while_it_arrives(CuTest* tc)
+{
+   apx_serverTestConnection_t* connection;
+   apx_nodeManager_t* node_manager;
+   apx_nodeInstance_t* node_instance;
+   apx_fileManager_t* file_manager;
+   apx_size_t const first_size = 30u;
+   char const* apx_text =
+      "APX/1.2\n"
+      "N\"TestNode1\"\n"
+      "P\"ProvidePort1\"C(0,3):=3\n"
+      "P\"ProvidePort2\"C(0,7):=7\n";
+
+   apx_size_t definition_size = (apx_size_t)strlen(apx_text);
+   connection = apx_serverTestConnection_new();
+   CuAssertPtrNotNull(tc, connection);
+   CuAssertUIntEquals(tc, APX_NO_ERROR, apx_serverTestConnection_send_greeting_header(connection));
+   apx_serverTestConnection_run(connection);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_serverTestConnection_publish_remote_file(connection, APX_DEFINITION_ADDRESS_START, "TestNode1.apx", definition_size));
+   apx_serverTestConnection_run(connection);
+   node_manager = apx_serverTestConnection_get_node_manager(connection);
+   node_instance = apx_serverTestConnection_find_node(connection, "TestNode1");
+   CuAssertPtrNotNull(tc, node_instance);
+   file_manager = apx_serverConnection_get_file_manager(&connection->base);
+
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_serverTestConnection_write_remote_fragment(connection, APX_DEFINITION_ADDRESS_START, (uint8_t const*)apx_text, first_size, true));
+   //Fragment was passed to the parser instead of being reassembled
+   CuAssertUIntEquals(tc, RMF_INVALID_ADDRESS, file_manager->receiver.start_address);
+   CuAssertPtrEquals(tc, node_instance, node_manager->streaming_node_instance);
+   CuAssertUIntEquals(tc, first_size, node_manager->streamed_size);
+   CuAssertUIntEquals(tc, 0u, apx_nodeData_num_provide_ports(apx_nodeInstance_get_node_data(node_instance)));
+
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_serverTestConnection_write_remote_fragment(connection, APX_DEFINITION_ADDRESS_START + (uint32_t)first_size, (uint8_t const*)&apx_text[first_size], definition_size - first_size, false));
+   apx_serverTestConnection_run(connection);
+   CuAssertPtrEquals(tc, NULL, node_manager->streaming_node_instance);
+   CuAssertIntEquals(tc, APX_DATA_STATE_CONNECTED, apx_nodeInstance_get_definition_data_state(node_instance));
+   CuAssertUIntEquals(tc, 2u, apx_nodeData_num_provide_ports(apx_nodeInstance_get_node_data(node_instance)));
+   apx_serverTestConnection_delete(connection);
+}
@@ -0,0 +1,286 @@
+//////////////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////////////
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "CuTest.h"
+#include "apx/shm_ring.h"
+#ifdef MEM_LEAK_CHECK
+#include "CMemLeak.h"
+#endif
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE CONSTANTS AND DATA TYPES
+//////////////////////////////////////////////////////////////////////////////
+#define RING_CAPACITY 1024u
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////////////
+static void test_init_rejects_invalid_capacity(CuTest* tc);
+static void test_attach_to_initialized_ring(CuTest* tc);
+static void test_reserve_is_invisible_until_commit(CuTest* tc);
+static void test_reservations_are_merged_into_one_record(CuTest* tc);
+static void test_reserve_fails_when_ring_is_full(CuTest* tc);
+static void test_record_wraps_around_end_of_ring(CuTest* tc);
+static void test_close_is_seen_by_both_sides(CuTest* tc);
+static void test_attach_rejects_invalid_positions(CuTest* tc);
+static void test_peek_rejects_invalid_record_length(CuTest* tc);
+static void test_peek_rejects_write_position_beyond_capacity(CuTest* tc);
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE VARIABLES
+//////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////
+// PUBLIC FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+CuSuite* testSuite_apx_shmRing(void)
+{
+   CuSuite* suite = CuSuiteNew();
+
+   SUITE_ADD_TEST(suite, test_init_rejects_invalid_capacity);
+   SUITE_ADD_TEST(suite, test_attach_to_initialized_ring);
+   SUITE_ADD_TEST(suite, test_reserve_is_invisible_until_commit);
+   SUITE_ADD_TEST(suite, test_reservations_are_merged_into_one_record);
+   SUITE_ADD_TEST(suite, test_reserve_fails_when_ring_is_full);
+   SUITE_ADD_TEST(suite, test_record_wraps_around_end_of_ring);
+   SUITE_ADD_TEST(suite, test_close_is_seen_by_both_sides);
+   SUITE_ADD_TEST(suite, test_attach_rejects_invalid_positions);
+   SUITE_ADD_TEST(suite, test_peek_rejects_invalid_record_length);
+   SUITE_ADD_TEST(suite, test_peek_rejects_write_position_beyond_capacity);
+
+   return suite;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+static void test_init_rejects_invalid_capacity(CuTest* tc)
+{
+   apx_shmRing_t ring;
+   void* memory = malloc(apx_shmRing_memory_size(2 * RING_CAPACITY));
+   CuAssertPtrNotNull(tc, memory);
+   CuAssertIntEquals(tc, APX_INVALID_ARGUMENT_ERROR, apx_shmRing_init(&ring, memory, RING_CAPACITY + 8u));
+   CuAssertIntEquals(tc, APX_INVALID_ARGUMENT_ERROR, apx_shmRing_init(&ring, memory, RING_CAPACITY / 2u));
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_shmRing_init(&ring, memory, RING_CAPACITY));
+   CuAssertUIntEquals(tc, RING_CAPACITY / 2u - APX_SHM_RING_RECORD_HEADER_SIZE, apx_shmRing_max_record_size(&ring));
+   free(memory);
+}
+
+static void test_attach_to_initialized_ring(CuTest* tc)
+{
+   apx_shmRing_t producer;
+   apx_shmRing_t consumer;
+   apx_size_t const memory_size = apx_shmRing_memory_size(RING_CAPACITY);
+   void* memory = malloc(memory_size);
+   CuAssertPtrNotNull(tc, memory);
+   memset(memory, 0, memory_size);
+   CuAssertIntEquals(tc, APX_INVALID_HEADER_ERROR, apx_shmRing_attach(&consumer, memory, memory_size));
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_shmRing_init(&producer, memory, RING_CAPACITY));
+   CuAssertIntEquals(tc, APX_INVALID_HEADER_ERROR, apx_shmRing_attach(&consumer, memory, memory_size - 1u));
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_shmRing_attach(&consumer, memory, memory_size));
+   CuAssertUIntEquals(tc, RING_CAPACITY, consumer.capacity);
+   free(memory);
+}
+
+static void test_reserve_is_invisible_until_commit(CuTest* tc)
+{
+   apx_shmRing_t producer;
+   apx_shmRing_t consumer;
+   apx_size_t const memory_size = apx_shmRing_memory_size(RING_CAPACITY);
+   void* memory = malloc(memory_size);
+   uint8_t* buf;
+   uint8_t const* data;
+   uint32_t size = 0u;
+   CuAssertPtrNotNull(tc, memory);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_shmRing_init(&producer, memory, RING_CAPACITY));
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_shmRing_attach(&consumer, memory, memory_size));
+   buf = apx_shmRing_reserve(&producer, 3u);
+   CuAssertPtrNotNull(tc, buf);
+   memcpy(buf, "abc", 3u);
+   CuAssertPtrEquals(tc, NULL, (void*)apx_shmRing_peek(&consumer, &size));
+   apx_shmRing_commit(&producer);
+   data = apx_shmRing_peek(&consumer, &size);
+   CuAssertPtrNotNull(tc, data);
+   CuAssertUIntEquals(tc, 3u, size);
+   CuAssertIntEquals(tc, 0, memcmp(data, "abc", 3u));
+   apx_shmRing_release(&consumer);
+   CuAssertPtrEquals(tc, NULL, (void*)apx_shmRing_peek(&consumer, &size));
+   free(memory);
+}
+
+static void test_reservations_are_merged_into_one_record(CuTest* tc)
+{
+   apx_shmRing_t producer;
+   apx_shmRing_t consumer;
+   apx_size_t const memory_size = apx_shmRing_memory_size(RING_CAPACITY);
+   void* memory = malloc(memory_size);
+   uint8_t const* data;
+   uint32_t size = 0u;
+   CuAssertPtrNotNull(tc, memory);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_shmRing_init(&producer, memory, RING_CAPACITY));
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_shmRing_attach(&consumer, memory, memory_size));
+   memcpy(apx_shmRing_reserve(&producer, 2u), "ab", 2u);
+   memcpy(apx_shmRing_reserve(&producer, 3u), "cde", 3u);
+   memcpy(apx_shmRing_reserve(&producer, 1u), "f", 1u);
+   apx_shmRing_commit(&producer);
+   data = apx_shmRing_peek(&consumer, &size);
+   CuAssertPtrNotNull(tc, data);
+   CuAssertUIntEquals(tc, 6u, size);
+   CuAssertIntEquals(tc, 0, memcmp(data, "abcdef", 6u));
+   apx_shmRing_release(&consumer);
+   CuAssertPtrEquals(tc, NULL, (void*)apx_shmRing_peek(&consumer, &size));
+   free(memory);
+}
+
+static void test_reserve_fails_when_ring_is_full(CuTest* tc)
+{
+   apx_shmRing_t producer;
+   apx_shmRing_t consumer;
+   apx_size_t const memory_size = apx_shmRing_memory_size(RING_CAPACITY);
+   void* memory = malloc(memory_size);
+   uint32_t size = 0u;
+   CuAssertPtrNotNull(tc, memory);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_shmRing_init(&producer, memory, RING_CAPACITY));
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_shmRing_attach(&consumer, memory, memory_size));
+   CuAssertPtrEquals(tc, NULL, apx_shmRing_reserve(&producer, apx_shmRing_max_record_size(&producer) + 1u));
+   CuAssertPtrNotNull(tc, apx_shmRing_reserve(&producer, apx_shmRing_max_record_size(&producer)));
+   CuAssertPtrNotNull(tc, apx_shmRing_reserve(&producer, apx_shmRing_max_record_size(&producer)));
+   CuAssertPtrEquals(tc, NULL, apx_shmRing_reserve(&producer, 1u));
+   apx_shmRing_commit(&producer);
+   CuAssertTrue(tc, !apx_shmRing_wait_writable(&producer, 1u, 0u));
+   CuAssertPtrNotNull(tc, apx_shmRing_peek(&consumer, &size));
+   apx_shmRing_release(&consumer);
+   CuAssertTrue(tc, apx_shmRing_wait_writable(&producer, 1u, 0u));
+   CuAssertPtrNotNull(tc, apx_shmRing_reserve(&producer, 1u));
+   free(memory);
+}
+
+static void test_record_wraps_around_end_of_ring(CuTest* tc)
+{
+   apx_shmRing_t producer;
+   apx_shmRing_t consumer;
+   apx_size_t const memory_size = apx_shmRing_memory_size(RING_CAPACITY);
+   void* memory = malloc(memory_size);
+   uint8_t* buf;
+   uint8_t const* data;
+   uint32_t size = 0u;
+   int i;
+   CuAssertPtrNotNull(tc, memory);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_shmRing_init(&producer, memory, RING_CAPACITY));
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_shmRing_attach(&consumer, memory, memory_size));
+   //Two records of 308 bytes move write position to 616, leaving 408 contiguous bytes before the end
+   for (i = 0; i < 2; i++)
+   {
+      CuAssertPtrNotNull(tc, apx_shmRing_reserve(&producer, 300u));
+      apx_shmRing_commit(&producer);
+      CuAssertPtrNotNull(tc, apx_shmRing_peek(&consumer, &size));
+      CuAssertUIntEquals(tc, 300u, size);
+      apx_shmRing_release(&consumer);
+   }
+   buf = apx_shmRing_reserve(&producer, 432u);
+   CuAssertPtrNotNull(tc, buf);
+   for (i = 0; i < 432; i++)
+   {
+      buf[i] = (uint8_t)i;
+   }
+   apx_shmRing_commit(&producer);
+   data = apx_shmRing_peek(&consumer, &size);
+   CuAssertPtrNotNull(tc, data);
+   CuAssertUIntEquals(tc, 432u, size);
+   CuAssertPtrEquals(tc, consumer.data + APX_SHM_RING_RECORD_HEADER_SIZE, (void*)data);
+   for (i = 0; i < 432; i++)
+   {
+      CuAssertUIntEquals(tc, (uint8_t)i, data[i]);
+   }
+   apx_shmRing_release(&consumer);
+   CuAssertPtrEquals(tc, NULL, (void*)apx_shmRing_peek(&consumer, &size));
+   free(memory);
+}
+
+static void test_close_is_seen_by_both_sides(CuTest* tc)
+{
+   apx_shmRing_t producer;
+   apx_shmRing_t consumer;
+   apx_size_t const memory_size = apx_shmRing_memory_size(RING_CAPACITY);
+   void* memory = malloc(memory_size);
+   uint32_t size = 0u;
+   CuAssertPtrNotNull(tc, memory);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_shmRing_init(&producer, memory, RING_CAPACITY));
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_shmRing_attach(&consumer, memory, memory_size));
+   CuAssertTrue(tc, !apx_shmRing_is_closed(&producer));
+   memcpy(apx_shmRing_reserve(&producer, 2u), "ab", 2u);
+   apx_shmRing_commit(&producer);
+   apx_shmRing_close(&consumer);
+   CuAssertTrue(tc, apx_shmRing_is_closed(&producer));
+   CuAssertTrue(tc, !apx_shmRing_wait_writable(&producer, 1u, 0u));
+   //Data published before close can still be read
+   CuAssertTrue(tc, apx_shmRing_wait_readable(&consumer, 0u));
+   CuAssertPtrNotNull(tc, apx_shmRing_peek(&consumer, &size));
+   apx_shmRing_release(&consumer);
+   CuAssertTrue(tc, !apx_shmRing_wait_readable(&consumer, 0u));
+   free(memory);
+}
+
+static void test_attach_rejects_invalid_positions(CuTest* tc)
+{
+   apx_shmRing_t producer;
+   apx_shmRing_t consumer;
+   apx_size_t const memory_size = apx_shmRing_memory_size(RING_CAPACITY);
+   void* memory = malloc(memory_size);
+   CuAssertPtrNotNull(tc, memory);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_shmRing_init(&producer, memory, RING_CAPACITY));
+   producer.header->write_pos = RING_CAPACITY + APX_SHM_RING_ALIGNMENT;
+   CuAssertIntEquals(tc, APX_INVALID_HEADER_ERROR, apx_shmRing_attach(&consumer, memory, memory_size));
+   producer.header->write_pos = 3u;
+   CuAssertIntEquals(tc, APX_INVALID_HEADER_ERROR, apx_shmRing_attach(&consumer, memory, memory_size));
+   producer.header->write_pos = 0u;
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_shmRing_attach(&consumer, memory, memory_size));
+   free(memory);
+}
+
+static void test_peek_rejects_invalid_record_length(CuTest* tc)
+{
+   apx_shmRing_t producer;
+   apx_shmRing_t consumer;
+   apx_size_t const memory_size = apx_shmRing_memory_size(RING_CAPACITY);
+   void* memory = malloc(memory_size);
+   uint32_t size = 0u;
+   CuAssertPtrNotNull(tc, memory);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_shmRing_init(&producer, memory, RING_CAPACITY));
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_shmRing_attach(&consumer, memory, memory_size));
+   memcpy(apx_shmRing_reserve(&producer, 4u), "abcd", 4u);
+   apx_shmRing_commit(&producer);
+   //Record length larger than what has been published
+   *(uint32_t*)consumer.data = 64u;
+   CuAssertTrue(tc, !apx_shmRing_is_corrupt(&consumer));
+   CuAssertPtrEquals(tc, NULL, (void*)apx_shmRing_peek(&consumer, &size));
+   CuAssertTrue(tc, apx_shmRing_is_corrupt(&consumer));
+   //The ring stays unusable even if the length is restored
+   *(uint32_t*)consumer.data = 4u;
+   CuAssertPtrEquals(tc, NULL, (void*)apx_shmRing_peek(&consumer, &size));
+   CuAssertTrue(tc, apx_shmRing_wait_readable(&consumer, 0u));
+   free(memory);
+}
+
+static void test_peek_rejects_write_position_beyond_capacity(CuTest* tc)
+{
+   apx_shmRing_t producer;
+   apx_shmRing_t consumer;
+   apx_size_t const memory_size = apx_shmRing_memory_size(RING_CAPACITY);
+   void* memory = malloc(memory_size);
+   uint32_t size = 0u;
+   CuAssertPtrNotNull(tc, memory);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_shmRing_init(&producer, memory, RING_CAPACITY));
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_shmRing_attach(&consumer, memory, memory_size));
+   *(uint32_t*)consumer.data = 8u;
+   producer.header->write_pos = 2u * RING_CAPACITY;
+   CuAssertPtrEquals(tc, NULL, (void*)apx_shmRing_peek(&consumer, &size));
+   CuAssertTrue(tc, apx_shmRing_is_corrupt(&consumer));
+   free(memory);
+}
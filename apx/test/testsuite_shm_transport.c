@@ -0,0 +1,286 @@
+//////////////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////////////
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "CuTest.h"
+#include "apx/shm_transport.h"
+#include "apx/numheader.h"
+#include "apx/remotefile.h"
+#ifdef MEM_LEAK_CHECK
+#include "CMemLeak.h"
+#endif
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE CONSTANTS AND DATA TYPES
+//////////////////////////////////////////////////////////////////////////////
+#define RING_CAPACITY 4096u
+#define SPY_BUFFER_SIZE 8192
+
+typedef struct receive_spy_tag
+{
+   uint8_t data[SPY_BUFFER_SIZE];
+   uint32_t size;
+   int32_t num_calls;
+} receive_spy_t;
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////////////
+static void test_client_and_server_use_opposite_rings(CuTest* tc);
+static void test_direct_message_is_received_with_header(CuTest* tc);
+static void test_data_message_is_received_with_address(CuTest* tc);
+static void test_messages_before_flush_are_received_together(CuTest* tc);
+static void test_write_fails_when_ring_is_full(CuTest* tc);
+static void test_write_fails_after_stop(CuTest* tc);
+static void test_run_fails_on_invalid_record_length(CuTest* tc);
+static void test_region_name_must_follow_naming_scheme(CuTest* tc);
+static void test_region_size_must_match_ring_capacity(CuTest* tc);
+static apx_size_t create_transport_pair(apx_shmTransport_t* client, apx_shmTransport_t* server, void** memory);
+static int8_t receive_spy_handler(void* arg, const uint8_t* data, uint32_t data_size, uint32_t* parse_size);
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE VARIABLES
+//////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////
+// PUBLIC FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+CuSuite* testSuite_apx_shmTransport(void)
+{
+   CuSuite* suite = CuSuiteNew();
+
+   SUITE_ADD_TEST(suite, test_client_and_server_use_opposite_rings);
+   SUITE_ADD_TEST(suite, test_direct_message_is_received_with_header);
+   SUITE_ADD_TEST(suite, test_data_message_is_received_with_address);
+   SUITE_ADD_TEST(suite, test_messages_before_flush_are_received_together);
+   SUITE_ADD_TEST(suite, test_write_fails_when_ring_is_full);
+   SUITE_ADD_TEST(suite, test_write_fails_after_stop);
+   SUITE_ADD_TEST(suite, test_run_fails_on_invalid_record_length);
+   SUITE_ADD_TEST(suite, test_region_name_must_follow_naming_scheme);
+   SUITE_ADD_TEST(suite, test_region_size_must_match_ring_capacity);
+
+   return suite;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+static void test_client_and_server_use_opposite_rings(CuTest* tc)
+{
+   apx_shmTransport_t client;
+   apx_shmTransport_t server;
+   void* memory = NULL;
+   CuAssertTrue(tc, create_transport_pair(&client, &server, &memory) > 0u);
+   CuAssertPtrEquals(tc, client.tx_ring.header, server.rx_ring.header);
+   CuAssertPtrEquals(tc, client.rx_ring.header, server.tx_ring.header);
+   CuAssertTrue(tc, client.tx_ring.header != client.rx_ring.header);
+   CuAssertIntEquals(tc, (int)(RING_CAPACITY / 2u - APX_SHM_RING_RECORD_HEADER_SIZE), apx_shmTransport_max_message_size(&client));
+   apx_shmTransport_destroy(&client);
+   apx_shmTransport_destroy(&server);
+   free(memory);
+}
+
+static void test_direct_message_is_received_with_header(CuTest* tc)
+{
+   apx_shmTransport_t client;
+   apx_shmTransport_t server;
+   receive_spy_t spy;
+   void* memory = NULL;
+   uint8_t const greeting[] = "RMFP/1.0\n\n";
+   apx_size_t const greeting_size = (apx_size_t)strlen((char const*)greeting);
+   memset(&spy, 0, sizeof(spy));
+   CuAssertTrue(tc, create_transport_pair(&client, &server, &memory) > 0u);
+   apx_shmTransport_set_handler(&server, receive_spy_handler, &spy);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_shmTransport_write_direct_message(&client, greeting, (int32_t)greeting_size));
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_shmTransport_run(&server));
+   CuAssertIntEquals(tc, 0, spy.num_calls);
+   apx_shmTransport_flush(&client);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_shmTransport_run(&server));
+   CuAssertIntEquals(tc, 1, spy.num_calls);
+   CuAssertUIntEquals(tc, NUMHEADER32_SHORT_SIZE + greeting_size, spy.size);
+   CuAssertUIntEquals(tc, greeting_size, spy.data[0]);
+   CuAssertIntEquals(tc, 0, memcmp(&spy.data[1], greeting, greeting_size));
+   CuAssertUIntEquals(tc, NUMHEADER32_SHORT_SIZE + greeting_size, (uint32_t)apx_shmTransport_get_total_bytes_written(&client));
+   CuAssertUIntEquals(tc, NUMHEADER32_SHORT_SIZE + greeting_size, (uint32_t)apx_shmTransport_get_total_bytes_received(&server));
+   apx_shmTransport_destroy(&client);
+   apx_shmTransport_destroy(&server);
+   free(memory);
+}
+
+static void test_data_message_is_received_with_address(CuTest* tc)
+{
+   apx_shmTransport_t client;
+   apx_shmTransport_t server;
+   receive_spy_t spy;
+   void* memory = NULL;
+   uint8_t payload[200];
+   uint32_t address = 0u;
+   bool more_bit = false;
+   uint32_t value = 0u;
+   uint8_t const* next;
+   memset(&spy, 0, sizeof(spy));
+   memset(payload, 0x5A, sizeof(payload));
+   CuAssertTrue(tc, create_transport_pair(&client, &server, &memory) > 0u);
+   apx_shmTransport_set_handler(&client, receive_spy_handler, &spy);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_shmTransport_write_data_message(&server, 0x10000, true, payload, (int32_t)sizeof(payload)));
+   apx_shmTransport_flush(&server);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_shmTransport_run(&client));
+   CuAssertIntEquals(tc, 1, spy.num_calls);
+   CuAssertUIntEquals(tc, NUMHEADER32_LONG_SIZE + RMF_HIGH_ADDR_SIZE + sizeof(payload), spy.size);
+   next = numheader_decode32(&spy.data[0], &spy.data[spy.size], &value);
+   CuAssertPtrEquals(tc, &spy.data[NUMHEADER32_LONG_SIZE], (void*)next);
+   CuAssertUIntEquals(tc, RMF_HIGH_ADDR_SIZE + sizeof(payload), value);
+   CuAssertUIntEquals(tc, RMF_HIGH_ADDR_SIZE, rmf_address_decode(next, &spy.data[spy.size], &address, &more_bit));
+   CuAssertUIntEquals(tc, 0x10000, address);
+   CuAssertTrue(tc, more_bit);
+   CuAssertIntEquals(tc, 0, memcmp(next + RMF_HIGH_ADDR_SIZE, payload, sizeof(payload)));
+   apx_shmTransport_destroy(&client);
+   apx_shmTransport_destroy(&server);
+   free(memory);
+}
+
+static void test_messages_before_flush_are_received_together(CuTest* tc)
+{
+   apx_shmTransport_t client;
+   apx_shmTransport_t server;
+   receive_spy_t spy;
+   void* memory = NULL;
+   uint8_t const data1[] = { 1, 2, 3 };
+   uint8_t const data2[] = { 4, 5 };
+   memset(&spy, 0, sizeof(spy));
+   CuAssertTrue(tc, create_transport_pair(&client, &server, &memory) > 0u);
+   apx_shmTransport_set_handler(&server, receive_spy_handler, &spy);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_shmTransport_write_data_message(&client, 0x0, false, data1, (int32_t)sizeof(data1)));
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_shmTransport_write_data_message(&client, 0x100, false, data2, (int32_t)sizeof(data2)));
+   apx_shmTransport_flush(&client);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_shmTransport_run(&server));
+   CuAssertIntEquals(tc, 1, spy.num_calls);
+   CuAssertUIntEquals(tc, (1u + RMF_LOW_ADDR_SIZE + 3u) + (1u + RMF_LOW_ADDR_SIZE + 2u), spy.size);
+   CuAssertUIntEquals(tc, RMF_LOW_ADDR_SIZE + 3u, spy.data[0]);
+   CuAssertUIntEquals(tc, RMF_LOW_ADDR_SIZE + 2u, spy.data[1u + RMF_LOW_ADDR_SIZE + 3u]);
+   apx_shmTransport_destroy(&client);
+   apx_shmTransport_destroy(&server);
+   free(memory);
+}
+
+static void test_write_fails_when_ring_is_full(CuTest* tc)
+{
+   apx_shmTransport_t client;
+   apx_shmTransport_t server;
+   receive_spy_t spy;
+   void* memory = NULL;
+   uint8_t* payload;
+   int32_t const max_size = (int32_t)(RING_CAPACITY / 2u - APX_SHM_RING_RECORD_HEADER_SIZE);
+   int32_t const payload_size = max_size - (int32_t)NUMHEADER32_LONG_SIZE;
+   memset(&spy, 0, sizeof(spy));
+   payload = (uint8_t*)malloc((size_t)max_size);
+   CuAssertPtrNotNull(tc, payload);
+   memset(payload, 0, (size_t)max_size);
+   CuAssertTrue(tc, create_transport_pair(&client, &server, &memory) > 0u);
+   apx_shmTransport_set_handler(&server, receive_spy_handler, &spy);
+   CuAssertIntEquals(tc, APX_MSG_TOO_LARGE_ERROR, apx_shmTransport_write_direct_message(&client, payload, max_size));
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_shmTransport_write_direct_message(&client, payload, payload_size));
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_shmTransport_write_direct_message(&client, payload, payload_size));
+   CuAssertIntEquals(tc, APX_BUFFER_FULL_ERROR, apx_shmTransport_write_direct_message(&client, payload, 1));
+   //Writer made what it had visible before giving up
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_shmTransport_run(&server));
+   CuAssertIntEquals(tc, 2, spy.num_calls);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_shmTransport_write_direct_message(&client, payload, 1));
+   apx_shmTransport_destroy(&client);
+   apx_shmTransport_destroy(&server);
+   free(payload);
+   free(memory);
+}
+
+static void test_write_fails_after_stop(CuTest* tc)
+{
+   apx_shmTransport_t client;
+   apx_shmTransport_t server;
+   void* memory = NULL;
+   uint8_t const data[] = { 1, 2, 3 };
+   CuAssertTrue(tc, create_transport_pair(&client, &server, &memory) > 0u);
+   apx_shmTransport_stop(&server);
+   CuAssertIntEquals(tc, APX_NOT_CONNECTED_ERROR, apx_shmTransport_write_direct_message(&client, data, (int32_t)sizeof(data)));
+   CuAssertIntEquals(tc, APX_NOT_CONNECTED_ERROR, apx_shmTransport_write_direct_message(&server, data, (int32_t)sizeof(data)));
+   apx_shmTransport_destroy(&client);
+   apx_shmTransport_destroy(&server);
+   free(memory);
+}
+
+static void test_run_fails_on_invalid_record_length(CuTest* tc)
+{
+   apx_shmTransport_t client;
+   apx_shmTransport_t server;
+   receive_spy_t spy;
+   void* memory = NULL;
+   uint8_t const data[] = { 1, 2, 3 };
+   memset(&spy, 0, sizeof(spy));
+   CuAssertTrue(tc, create_transport_pair(&client, &server, &memory) > 0u);
+   apx_shmTransport_set_handler(&server, receive_spy_handler, &spy);
+   CuAssertIntEquals(tc, APX_NO_ERROR, apx_shmTransport_write_direct_message(&client, data, (int32_t)sizeof(data)));
+   apx_shmTransport_flush(&client);
+   //Client overwrites the published record length with a value that points outside the ring
+   *(uint32_t*)server.rx_ring.data = RING_CAPACITY;
+   CuAssertIntEquals(tc, APX_INVALID_MSG_ERROR, apx_shmTransport_run(&server));
+   CuAssertIntEquals(tc, 0, spy.num_calls);
+   apx_shmTransport_destroy(&client);
+   apx_shmTransport_destroy(&server);
+   free(memory);
+}
+
+static void test_region_name_must_follow_naming_scheme(CuTest* tc)
+{
+   CuAssertTrue(tc, apx_shmTransport_is_valid_region_name("/apx-1234-1"));
+   CuAssertTrue(tc, !apx_shmTransport_is_valid_region_name("/apx-"));
+   CuAssertTrue(tc, !apx_shmTransport_is_valid_region_name("/other-1234-1"));
+   CuAssertTrue(tc, !apx_shmTransport_is_valid_region_name("/apx-1234/../x"));
+   CuAssertTrue(tc, !apx_shmTransport_is_valid_region_name("apx-1234-1"));
+   CuAssertTrue(tc, !apx_shmTransport_is_valid_region_name("/apx-1234567890123456789012345678901234567890123456789012345678901"));
+   CuAssertTrue(tc, !apx_shmTransport_is_valid_region_name(NULL));
+}
+
+static void test_region_size_must_match_ring_capacity(CuTest* tc)
+{
+   CuAssertTrue(tc, apx_shmTransport_is_valid_region_size(apx_shmTransport_memory_size(APX_SHM_RING_MIN_CAPACITY)));
+   CuAssertTrue(tc, apx_shmTransport_is_valid_region_size(apx_shmTransport_memory_size(APX_SHM_TRANSPORT_DEFAULT_RING_SIZE)));
+   CuAssertTrue(tc, apx_shmTransport_is_valid_region_size(apx_shmTransport_memory_size(APX_SHM_TRANSPORT_MAX_RING_SIZE)));
+   CuAssertTrue(tc, !apx_shmTransport_is_valid_region_size(apx_shmTransport_memory_size(2u * APX_SHM_TRANSPORT_MAX_RING_SIZE)));
+   CuAssertTrue(tc, !apx_shmTransport_is_valid_region_size(apx_shmTransport_memory_size(APX_SHM_TRANSPORT_DEFAULT_RING_SIZE) + 1u));
+   CuAssertTrue(tc, !apx_shmTransport_is_valid_region_size(0u));
+}
+
+static apx_size_t create_transport_pair(apx_shmTransport_t* client, apx_shmTransport_t* server, void** memory)
+{
+   apx_size_t const memory_size = apx_shmTransport_memory_size(RING_CAPACITY);
+   *memory = malloc(memory_size);
+   if (*memory == NULL)
+   {
+      return 0u;
+   }
+   apx_shmTransport_create(client);
+   apx_shmTransport_create(server);
+   if ( (apx_shmTransport_attach_memory(client, *memory, memory_size, APX_CLIENT_MODE, true) != APX_NO_ERROR) ||
+        (apx_shmTransport_attach_memory(server, *memory, memory_size, APX_SERVER_MODE, false) != APX_NO_ERROR) )
+   {
+      return 0u;
+   }
+   return memory_size;
+}
+
+static int8_t receive_spy_handler(void* arg, const uint8_t* data, uint32_t data_size, uint32_t* parse_size)
+{
+   receive_spy_t* spy = (receive_spy_t*)arg;
+   if ( (spy->size + data_size) <= SPY_BUFFER_SIZE )
+   {
+      memcpy(&spy->data[spy->size], data, data_size);
+      spy->size += data_size;
+   }
+   spy->num_calls++;
+   *parse_size = data_size;
+   return 0;
+}
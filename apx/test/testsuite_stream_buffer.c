@@ -0,0 +1,113 @@
+//////////////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////////////
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "CuTest.h"
+#include "apx/stream_buffer.h"
+#include "apx/remotefile.h"
+#ifdef MEM_LEAK_CHECK
+#include "CMemLeak.h"
+#endif
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE CONSTANTS AND DATA TYPES
+//////////////////////////////////////////////////////////////////////////////
+#define RETENTION 3u
+#define RECORD_SIZE (RMF_STREAM_SEQUENCE_SIZE + 2u)
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////////////
+static void test_create_rejects_zero_retention(CuTest* tc);
+static void test_push_stamps_sequence_number(CuTest* tc);
+static void test_full_buffer_evicts_oldest_record(CuTest* tc);
+static uint8_t* create_record(uint8_t value);
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE VARIABLES
+//////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////
+// PUBLIC FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+CuSuite* testSuite_apx_streamBuffer(void)
+{
+   CuSuite* suite = CuSuiteNew();
+
+   SUITE_ADD_TEST(suite, test_create_rejects_zero_retention);
+   SUITE_ADD_TEST(suite, test_push_stamps_sequence_number);
+   SUITE_ADD_TEST(suite, test_full_buffer_evicts_oldest_record);
+
+   return suite;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+static void test_create_rejects_zero_retention(CuTest* tc)
+{
+   apx_streamBuffer_t buffer;
+   CuAssertIntEquals(tc, APX_INVALID_ARGUMENT_ERROR, apx_streamBuffer_create(&buffer, 0u));
+   CuAssertPtrEquals(tc, NULL, apx_streamBuffer_new(0u));
+}
+
+static void test_push_stamps_sequence_number(CuTest* tc)
+{
+   apx_streamBuffer_t* buffer = apx_streamBuffer_new(RETENTION);
+   apx_streamRecord_t const* record;
+   uint8_t const expected[RECORD_SIZE] = { 1u, 0u, 0u, 0u, 0x22u, 0x22u };
+   CuAssertPtrNotNull(tc, buffer);
+   CuAssertFalse(tc, apx_streamBuffer_is_active(buffer));
+
+   CuAssertUIntEquals(tc, 0u, apx_streamBuffer_push(buffer, create_record(0x11u), RECORD_SIZE));
+   CuAssertUIntEquals(tc, 1u, apx_streamBuffer_push(buffer, create_record(0x22u), RECORD_SIZE));
+   CuAssertUIntEquals(tc, 2u, apx_streamBuffer_length(buffer));
+   CuAssertUIntEquals(tc, 2u, apx_streamBuffer_next_sequence(buffer));
+   record = apx_streamBuffer_get(buffer, 1u);
+   CuAssertPtrNotNull(tc, record);
+   CuAssertUIntEquals(tc, RECORD_SIZE, record->size);
+   CuAssertTrue(tc, memcmp(expected, record->data, RECORD_SIZE) == 0);
+   CuAssertPtrEquals(tc, NULL, (void*)apx_streamBuffer_get(buffer, 2u));
+
+   apx_streamBuffer_delete(buffer);
+}
+
+static void test_full_buffer_evicts_oldest_record(CuTest* tc)
+{
+   apx_streamBuffer_t* buffer = apx_streamBuffer_new(RETENTION);
+   uint8_t i;
+   CuAssertPtrNotNull(tc, buffer);
+
+   for (i = 0u; i < 5u; i++)
+   {
+      CuAssertUIntEquals(tc, i, apx_streamBuffer_push(buffer, create_record(i), RECORD_SIZE));
+   }
+   CuAssertUIntEquals(tc, RETENTION, apx_streamBuffer_length(buffer));
+   CuAssertUIntEquals(tc, 2u, apx_streamBuffer_num_evicted(buffer));
+   //Records are kept oldest first
+   for (i = 0u; i < RETENTION; i++)
+   {
+      apx_streamRecord_t const* record = apx_streamBuffer_get(buffer, i);
+      CuAssertPtrNotNull(tc, record);
+      CuAssertUIntEquals(tc, 2u + i, record->data[0]);
+      CuAssertUIntEquals(tc, 2u + i, record->data[RMF_STREAM_SEQUENCE_SIZE]);
+   }
+
+   apx_streamBuffer_delete(buffer);
+}
+
+static uint8_t* create_record(uint8_t value)
+{
+   uint8_t* data = (uint8_t*)malloc(RECORD_SIZE);
+   if (data != NULL)
+   {
+      memset(data, 0, RMF_STREAM_SEQUENCE_SIZE);
+      memset(&data[RMF_STREAM_SEQUENCE_SIZE], value, RECORD_SIZE - RMF_STREAM_SEQUENCE_SIZE);
+   }
+   return data;
+}
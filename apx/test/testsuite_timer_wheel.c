@@ -0,0 +1,170 @@
+//////////////////////////////////////////////////////////////////////////////
+// INCLUDES
+//////////////////////////////////////////////////////////////////////////////
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "CuTest.h"
+#include "apx/timer_wheel.h"
+#ifdef MEM_LEAK_CHECK
+#include "CMemLeak.h"
+#endif
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE CONSTANTS AND DATA TYPES
+//////////////////////////////////////////////////////////////////////////////
+#define NUM_SLOTS 8u
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTION PROTOTYPES
+//////////////////////////////////////////////////////////////////////////////
+static void test_create_rejects_zero_slots(CuTest* tc);
+static void test_entry_expires_at_scheduled_tick(CuTest* tc);
+static void test_cancelled_entry_never_expires(CuTest* tc);
+static void test_past_tick_expires_on_next_tick(CuTest* tc);
+static void test_entry_beyond_one_revolution_waits_for_its_tick(CuTest* tc);
+static void test_advance_beyond_one_revolution_expires_all_due_entries(CuTest* tc);
+static int count_entries(apx_timerWheelEntry_t* list);
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE VARIABLES
+//////////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////////
+// PUBLIC FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+CuSuite* testSuite_apx_timerWheel(void)
+{
+   CuSuite* suite = CuSuiteNew();
+
+   SUITE_ADD_TEST(suite, test_create_rejects_zero_slots);
+   SUITE_ADD_TEST(suite, test_entry_expires_at_scheduled_tick);
+   SUITE_ADD_TEST(suite, test_cancelled_entry_never_expires);
+   SUITE_ADD_TEST(suite, test_past_tick_expires_on_next_tick);
+   SUITE_ADD_TEST(suite, test_entry_beyond_one_revolution_waits_for_its_tick);
+   SUITE_ADD_TEST(suite, test_advance_beyond_one_revolution_expires_all_due_entries);
+
+   return suite;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// PRIVATE FUNCTIONS
+//////////////////////////////////////////////////////////////////////////////
+
+static void test_create_rejects_zero_slots(CuTest* tc)
+{
+   apx_timerWheel_t wheel;
+   CuAssertIntEquals(tc, APX_INVALID_ARGUMENT_ERROR, apx_timerWheel_create(&wheel, 0u));
+   CuAssertPtrEquals(tc, NULL, apx_timerWheel_new(0u));
+}
+
+static void test_entry_expires_at_scheduled_tick(CuTest* tc)
+{
+   apx_timerWheel_t* wheel = apx_timerWheel_new(NUM_SLOTS);
+   apx_timerWheelEntry_t entry;
+   CuAssertPtrNotNull(tc, wheel);
+   apx_timerWheelEntry_create(&entry);
+
+   apx_timerWheel_schedule(wheel, &entry, 3u);
+   CuAssertTrue(tc, entry.is_scheduled);
+   CuAssertUIntEquals(tc, 1u, apx_timerWheel_num_scheduled(wheel));
+   CuAssertPtrEquals(tc, NULL, apx_timerWheel_advance(wheel, 2u));
+   CuAssertPtrEquals(tc, &entry, apx_timerWheel_advance(wheel, 3u));
+   CuAssertPtrEquals(tc, NULL, entry.next);
+   CuAssertFalse(tc, entry.is_scheduled);
+   CuAssertUIntEquals(tc, 0u, apx_timerWheel_num_scheduled(wheel));
+   CuAssertUIntEquals(tc, 3u, (uint32_t)apx_timerWheel_current_tick(wheel));
+
+   apx_timerWheel_delete(wheel);
+}
+
+static void test_cancelled_entry_never_expires(CuTest* tc)
+{
+   apx_timerWheel_t* wheel = apx_timerWheel_new(NUM_SLOTS);
+   apx_timerWheelEntry_t entry1;
+   apx_timerWheelEntry_t entry2;
+   apx_timerWheelEntry_t* expired;
+   CuAssertPtrNotNull(tc, wheel);
+   apx_timerWheelEntry_create(&entry1);
+   apx_timerWheelEntry_create(&entry2);
+
+   apx_timerWheel_schedule(wheel, &entry1, 2u);
+   apx_timerWheel_schedule(wheel, &entry2, 2u);
+   apx_timerWheel_cancel(wheel, &entry1);
+   CuAssertFalse(tc, entry1.is_scheduled);
+   CuAssertUIntEquals(tc, 1u, apx_timerWheel_num_scheduled(wheel));
+   expired = apx_timerWheel_advance(wheel, 4u);
+   CuAssertPtrEquals(tc, &entry2, expired);
+   CuAssertIntEquals(tc, 1, count_entries(expired));
+
+   apx_timerWheel_delete(wheel);
+}
+
+static void test_past_tick_expires_on_next_tick(CuTest* tc)
+{
+   apx_timerWheel_t* wheel = apx_timerWheel_new(NUM_SLOTS);
+   apx_timerWheelEntry_t entry;
+   CuAssertPtrNotNull(tc, wheel);
+   apx_timerWheelEntry_create(&entry);
+
+   CuAssertPtrEquals(tc, NULL, apx_timerWheel_advance(wheel, 10u));
+   apx_timerWheel_schedule(wheel, &entry, 5u);
+   CuAssertUIntEquals(tc, 11u, (uint32_t)entry.expire_tick);
+   CuAssertPtrEquals(tc, &entry, apx_timerWheel_advance(wheel, 11u));
+
+   apx_timerWheel_delete(wheel);
+}
+
+static void test_entry_beyond_one_revolution_waits_for_its_tick(CuTest* tc)
+{
+   apx_timerWheel_t* wheel = apx_timerWheel_new(NUM_SLOTS);
+   apx_timerWheelEntry_t entry;
+   CuAssertPtrNotNull(tc, wheel);
+   apx_timerWheelEntry_create(&entry);
+
+   //Tick 10 shares slot 2 with tick 2
+   apx_timerWheel_schedule(wheel, &entry, 10u);
+   CuAssertPtrEquals(tc, NULL, apx_timerWheel_advance(wheel, 2u));
+   CuAssertPtrEquals(tc, NULL, apx_timerWheel_advance(wheel, 9u));
+   CuAssertPtrEquals(tc, &entry, apx_timerWheel_advance(wheel, 10u));
+
+   apx_timerWheel_delete(wheel);
+}
+
+static void test_advance_beyond_one_revolution_expires_all_due_entries(CuTest* tc)
+{
+   apx_timerWheel_t* wheel = apx_timerWheel_new(NUM_SLOTS);
+   apx_timerWheelEntry_t entries[4];
+   apx_timerWheelEntry_t* expired;
+   int i;
+   CuAssertPtrNotNull(tc, wheel);
+   for (i = 0; i < 4; i++)
+   {
+      apx_timerWheelEntry_create(&entries[i]);
+   }
+   apx_timerWheel_schedule(wheel, &entries[0], 1u);
+   apx_timerWheel_schedule(wheel, &entries[1], 7u);
+   apx_timerWheel_schedule(wheel, &entries[2], 20u);
+   apx_timerWheel_schedule(wheel, &entries[3], 100u);
+
+   expired = apx_timerWheel_advance(wheel, 50u);
+   CuAssertIntEquals(tc, 3, count_entries(expired));
+   CuAssertTrue(tc, entries[3].is_scheduled);
+   CuAssertUIntEquals(tc, 1u, apx_timerWheel_num_scheduled(wheel));
+   CuAssertPtrEquals(tc, &entries[3], apx_timerWheel_advance(wheel, 100u));
+
+   apx_timerWheel_delete(wheel);
+}
+
+static int count_entries(apx_timerWheelEntry_t* list)
+{
+   int count = 0;
+   while (list != NULL)
+   {
+      count++;
+      list = list->next;
+   }
+   return count;
+}